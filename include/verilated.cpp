@@ -25,7 +25,30 @@
 
 #define _VERILATED_CPP_
 #include "verilated_imp.h"
+#include "verilated_prof.h"
 #include <cctype>
+#include <algorithm>
+#if defined(__linux__) && !defined(VL_NO_LAZY_RESET)
+# include <sys/mman.h>
+# include <unistd.h>
+# define VL_LAZY_RESET 1
+#endif
+#if (defined(__linux__) || defined(__APPLE__)) && !defined(VL_NO_READMEM_MMAP)
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+# define VL_READMEM_MMAP 1
+#endif
+#include <signal.h>
+#include <sys/time.h>
+#if !defined(_WIN32) || defined(__CYGWIN__)
+# include <unistd.h>
+#endif
+#ifdef VL_THREADED
+# include <chrono>
+# include <thread>
+#endif
 
 #define VL_VALUE_STRING_MAX_WIDTH 8192	///< Max static char array for VL_VALUE_STRING
 
@@ -34,13 +57,16 @@
 
 // Slow path variables
 VerilatedVoidCb Verilated::s_flushCb = NULL;
+VerilatedWatchCb Verilated::s_watchCb = NULL;
+void* Verilated::s_watchUserp = NULL;
+
+VerilatedContext Verilated::s_defaultContext;
+VL_THREAD VerilatedContext* Verilated::t_contextp = &Verilated::s_defaultContext;
 
 // Keep below together in one cache line
-Verilated::Serialized Verilated::s_s;
 VL_THREAD const VerilatedScope* Verilated::t_dpiScopep = NULL;
 VL_THREAD const char* Verilated::t_dpiFilename = "";
 VL_THREAD int Verilated::t_dpiLineno = 0;
-struct Verilated::CommandArgValues Verilated::s_args = {0, NULL};
 
 VerilatedImp  VerilatedImp::s_s;
 
@@ -51,6 +77,7 @@ VerilatedImp  VerilatedImp::s_s;
 void vl_finish (const char* filename, int linenum, const char* hier) {
     if (0 && hier) {}
     VL_PRINTF("- %s:%d: Verilog $finish\n", filename, linenum);
+    if (Verilated::outputBuffer()) Verilated::flushCall();
     if (Verilated::gotFinish()) {
 	VL_PRINTF("- %s:%d: Second verilog $finish, exiting\n", filename, linenum);
 	Verilated::flushCall();
@@ -84,7 +111,7 @@ void vl_fatal (const char* filename, int linenum, const char* hier, const char*
 //===========================================================================
 // Overall class init
 
-Verilated::Serialized::Serialized() {
+VerilatedContext::Serialized::Serialized() {
     s_randReset = 0;
     s_debug = 0;
     s_calcUnusedSigs = false;
@@ -93,16 +120,124 @@ Verilated::Serialized::Serialized() {
     s_fatalOnVpiError = true; // retains old default behaviour
 }
 
+VerilatedContext::VerilatedContext()
+    : m_time(0), m_impp(NULL) {
+    m_args.argc = 0;
+    m_args.argv = NULL;
+    randSeed(0);
+}
+
+VerilatedContext::~VerilatedContext() {
+    delete m_impp; m_impp=NULL;
+}
+
+VerilatedContextImp* VerilatedContext::impp() {
+    if (VL_UNLIKELY(!m_impp)) m_impp = new VerilatedContextImp;
+    return m_impp;
+}
+
+void VerilatedContext::commandArgs(int argc, const char** argv) {
+    m_args.argc = argc;
+    m_args.argv = argv;
+    impp()->commandArgs(argc,argv);
+    commandArgsRuntime(argc, argv);
+}
+
+void VerilatedContext::commandArgsAdd(int argc, const char** argv) {
+    impp()->commandArgsAdd(argc,argv);
+    commandArgsRuntime(argc, argv);
+}
+
+void VerilatedContext::commandArgsRuntime(int argc, const char** argv) {
+    // Options for the runtime itself, the Verilog still sees them as plusargs
+    for (int i=0; i<argc; ++i) {
+	const char* argp = argv[i];
+	static const char seedPrefix[] = "+verilator+seed+";
+	static const char resetPrefix[] = "+verilator+rand+reset+";
+	static const char outbufPrefix[] = "+verilator+outbuf+";
+	static const char profFilePrefix[] = "+verilator+prof+file+";
+	static const char profBranchPrefix[] = "+verilator+prof+branch+file+";
+	static const char profActivityPrefix[] = "+verilator+prof+activity+file+";
+	static const char profConvergePrefix[] = "+verilator+prof+converge+file+";
+	static const char affinityPrefix[] = "+verilator+threads+affinity+";
+	if (0 == strncmp(argp, seedPrefix, sizeof(seedPrefix)-1)) {
+	    randSeed(strtoull(argp+sizeof(seedPrefix)-1, NULL, 0));
+	} else if (0 == strncmp(argp, resetPrefix, sizeof(resetPrefix)-1)) {
+	    randReset(atoi(argp+sizeof(resetPrefix)-1));
+	} else if (0 == strncmp(argp, outbufPrefix, sizeof(outbufPrefix)-1)) {
+	    Verilated::outputBuffer(strtoul(argp+sizeof(outbufPrefix)-1, NULL, 0));
+	} else if (0 == strncmp(argp, profFilePrefix, sizeof(profFilePrefix)-1)) {
+	    VerilatedProfCFunc::filename(argp+sizeof(profFilePrefix)-1);
+	} else if (0 == strncmp(argp, profBranchPrefix, sizeof(profBranchPrefix)-1)) {
+	    VerilatedProfBranch::filename(argp+sizeof(profBranchPrefix)-1);
+	} else if (0 == strncmp(argp, profActivityPrefix, sizeof(profActivityPrefix)-1)) {
+	    VerilatedProfActivity::filename(argp+sizeof(profActivityPrefix)-1);
+	} else if (0 == strncmp(argp, profConvergePrefix, sizeof(profConvergePrefix)-1)) {
+	    VerilatedProfConverge::filename(argp+sizeof(profConvergePrefix)-1);
+	} else if (0 == strncmp(argp, affinityPrefix, sizeof(affinityPrefix)-1)) {
+	    Verilated::threadsAffinity(argp+sizeof(affinityPrefix)-1);
+	}
+    }
+}
+
+//===========================================================================
+// Random generator -- xoshiro256** seeded through splitmix64, so any seed
+// including 0 gives a good state.  Much faster than lrand48/rand, and as
+// each context has its own state, models on other threads don't contend.
+// The lock only matters when --threads tasks share the context.
+
+static inline vluint64_t vl_rand_rotl(vluint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+static inline vluint64_t vl_rand_next(vluint64_t* statep) {
+    vluint64_t result = vl_rand_rotl(statep[1] * 5, 7) * 9;
+    vluint64_t t = statep[1] << 17;
+    statep[2] ^= statep[0];
+    statep[3] ^= statep[1];
+    statep[1] ^= statep[2];
+    statep[0] ^= statep[3];
+    statep[2] ^= t;
+    statep[3] = vl_rand_rotl(statep[3], 45);
+    return result;
+}
+
+void VerilatedContext::randSeed(vluint64_t seed) {
+    m_randMutex.lock();
+    for (int i=0; i<4; ++i) {  // splitmix64
+	seed += VL_ULL(0x9e3779b97f4a7c15);
+	vluint64_t z = seed;
+	z = (z ^ (z >> 30)) * VL_ULL(0xbf58476d1ce4e5b9);
+	z = (z ^ (z >> 27)) * VL_ULL(0x94d049bb133111eb);
+	m_randState[i] = z ^ (z >> 31);
+    }
+    m_randMutex.unlock();
+}
+
+QData VerilatedContext::rand64() {
+    m_randMutex.lock();
+    vluint64_t result = vl_rand_next(m_randState);
+    m_randMutex.unlock();
+    return result;
+}
+
+void VerilatedContext::randFill(WDataOutP outwp, int words) {
+    m_randMutex.lock();
+    int i = 0;
+    for (; i+1<words; i+=2) {
+	vluint64_t result = vl_rand_next(m_randState);
+	outwp[i] = (IData)result;
+	outwp[i+1] = (IData)(result >> VL_ULL(32));
+    }
+    if (i<words) outwp[i] = (IData)(vl_rand_next(m_randState) >> VL_ULL(32));
+    m_randMutex.unlock();
+}
+
 //===========================================================================
 // Random reset -- Only called at init time, so don't inline.
 
 IData VL_RAND32() {
-#if defined(_WIN32) && !defined(__CYGWIN__)
-    // Windows doesn't have lrand48(), although Cygwin does.
-    return (rand()<<16) ^ rand();
-#else
-    return (lrand48()<<16) ^ lrand48();
-#endif
+    return Verilated::threadContextp()->rand32();
 }
 
 IData VL_RANDOM_I(int obits) {
@@ -110,18 +245,14 @@ IData VL_RANDOM_I(int obits) {
 }
 
 QData VL_RANDOM_Q(int obits) {
-    QData data = ((QData)VL_RAND32()<<VL_ULL(32)) | (QData)VL_RAND32();
+    QData data = Verilated::threadContextp()->rand64();
     return data & VL_MASK_Q(obits);
 }
 
 WDataOutP VL_RANDOM_W(int obits, WDataOutP outwp) {
-    for (int i=0; i<VL_WORDS_I(obits); ++i) {
-	if (i<(VL_WORDS_I(obits)-1)) {
-	    outwp[i] = VL_RAND32();
-	} else {
-	    outwp[i] = VL_RAND32() & VL_MASK_I(obits);
-	}
-    }
+    int words = VL_WORDS_I(obits);
+    Verilated::threadContextp()->randFill(outwp, words);
+    outwp[words-1] &= VL_MASK_I(obits);
     return outwp;
 }
 
@@ -146,16 +277,37 @@ QData VL_RAND_RESET_Q(int obits) {
 }
 
 WDataOutP VL_RAND_RESET_W(int obits, WDataOutP outwp) {
-    for (int i=0; i<VL_WORDS_I(obits); ++i) {
-	if (i<(VL_WORDS_I(obits)-1)) {
-	    outwp[i] = VL_RAND_RESET_I(32);
-	} else {
-	    outwp[i] = VL_RAND_RESET_I(32) & VL_MASK_I(obits);
-	}
-    }
+    int randReset = Verilated::randReset();
+    if (randReset==0) return VL_ZERO_RESET_W(obits, outwp);
+    if (randReset!=1) return VL_RANDOM_W(obits, outwp);  // if 2, randomize
+    int words = VL_WORDS_I(obits);
+    for (int i=0; i<words; ++i) outwp[i] = ~0;
+    outwp[words-1] &= VL_MASK_I(obits);
     return outwp;
 }
 
+bool VL_RAND_RESET_MEM(void* datap, size_t bytes) {
+    if (Verilated::randReset()!=0) return false;
+    char* startp = (char*)datap;
+    char* endp = startp + bytes;
+#ifdef VL_LAZY_RESET
+    // Return the whole pages to the kernel; each reads back as zero when
+    // first touched, so a large memory that's never used costs nothing.
+    // The model's memory is private and anonymous (heap, stack or bss).
+    static uintptr_t s_pageSize = (uintptr_t)sysconf(_SC_PAGESIZE);
+    char* pstartp = (char*)(((uintptr_t)startp + s_pageSize - 1) & ~(s_pageSize - 1));
+    char* pendp = (char*)((uintptr_t)endp & ~(s_pageSize - 1));
+    if (pstartp < pendp
+	&& 0 == madvise(pstartp, pendp - pstartp, MADV_DONTNEED)) {
+	memset(startp, 0, pstartp - startp);
+	memset(pendp, 0, endp - pendp);
+	return true;
+    }
+#endif
+    memset(startp, 0, endp - startp);
+    return true;
+}
+
 WDataOutP VL_ZERO_RESET_W(int obits, WDataOutP outwp) {
     for (int i=0; i<VL_WORDS_I(obits); ++i) outwp[i] = 0;
     return outwp;
@@ -204,6 +356,24 @@ WDataOutP _vl_moddiv_w(int lbits, WDataOutP owp, WDataInP lwp, WDataInP rwp, boo
 	}
 	return owp;
     }
+#ifdef VL_HAVE_INT128
+    if (vw == 2) {  // Divisor fits in 64 bits; short division, about twice as fast as below
+	vluint64_t v = ((vluint64_t)(rwp[1])<<VL_ULL(32)) | (vluint64_t)(rwp[0]);
+	vluint64_t k = 0;  // Remainder, always < v so each quotient digit fits in a word
+	for (int j = uw-1; j >= 0; --j) {
+	    vluint128_t unw96 = ((vluint128_t)(k)<<32) | (vluint128_t)(lwp[j]);
+	    vluint64_t qhat = (vluint64_t)(unw96 / v);
+	    owp[j] = (IData)qhat;
+	    k = (vluint64_t)(unw96 - (vluint128_t)(qhat)*v);
+	}
+	if (is_modulus) {
+	    owp[0] = (IData)k;
+	    owp[1] = (IData)(k>>VL_ULL(32));
+	    for (int i=2; i<words; ++i) owp[i]=0;
+	}
+	return owp;
+    }
+#endif
 
     // +1 word as we may shift during normalization
     vluint32_t un[VL_MULS_MAX_WORDS+1]; // Fixed size, as MSVC++ doesn't allow [words] here
@@ -364,6 +534,138 @@ QData VL_POWSS_QQW(int obits, int, int rbits, QData lhs, WDataInP rwp, bool lsig
 // Do a va_arg returning a quad, assuming input argument is anything less than wide
 #define _VL_VA_ARG_Q(ap, bits) (((bits) <= VL_WORDSIZE) ? va_arg(ap,IData) : va_arg(ap,QData))
 
+static inline int _vl_vsformat_udec(char* destp, QData ld) {
+    // Unsigned decimal into destp, returning digit count; faster than sprintf
+    char digits[24];
+    int n = 0;
+    do { digits[n++] = (char)('0' + (ld % 10)); ld /= 10; } while (ld);
+    for (int i=0; i<n; ++i) destp[i] = digits[n-1-i];
+    destp[n] = '\0';
+    return n;
+}
+
+template <class T_Output>
+static void _vl_vsformat_num(T_Output& output, char fmt, bool widthSet, int width, bool zeroPad,
+			     int lbits, QData ld, WDataInP lwp) {
+    // Format one integral argument; output may be a string or VerilatedFmtBuf
+    char tmp[64];  // Largest is 64-bit decimal or time
+    if (lbits > VL_QUADSIZE && (fmt == 'd' || fmt == '#')) fmt = 'x';  // Not supported, but show something
+    int lsb=lbits-1;
+    if (widthSet && width==0) while (lsb && !VL_BITISSET_W(lwp,lsb)) --lsb;
+    switch (fmt) {
+    case 'c': {
+	IData charval = ld & 0xff;
+	output += charval;
+	break;
+    }
+    case 's':
+	for (; lsb>=0; --lsb) {
+	    lsb = (lsb / 8) * 8; // Next digit
+	    IData charval = (lwp[VL_BITWORD_I(lsb)]>>VL_BITBIT_I(lsb)) & 0xff;
+	    output += (charval==0)?' ':charval;
+	}
+	break;
+    case 'd': { // Signed decimal
+	vlsint64_t sd = (vlsint64_t)(VL_EXTENDS_QQ(lbits,lbits,ld));
+	int digits = ((sd < 0) ? (tmp[0] = '-', 1 + _vl_vsformat_udec(tmp+1, (QData)(0)-(QData)(sd)))
+		      : _vl_vsformat_udec(tmp, (QData)(sd)));
+	int needmore = width-digits;
+	if (needmore>0) {
+	    if (zeroPad) { //%0
+		output.append(needmore,'0'); // Pre-pad zero
+	    } else {
+		output.append(needmore,' '); // Pre-pad spaces
+	    }
+	}
+	output += tmp;
+	break;
+    }
+    case '#': { // Unsigned decimal
+	int digits=_vl_vsformat_udec(tmp,ld);
+	int needmore = width-digits;
+	if (needmore>0) {
+	    if (zeroPad) { //%0
+		output.append(needmore,'0'); // Pre-pad zero
+	    } else {
+		output.append(needmore,' '); // Pre-pad spaces
+	    }
+	}
+	output += tmp;
+	break;
+    }
+    case 't': { // Time
+	int digits;
+	if (VL_TIME_MULTIPLIER==1) {
+	    digits=_vl_vsformat_udec(tmp,ld);
+	} else if (VL_TIME_MULTIPLIER==1000) {
+	    digits=sprintf(tmp,"%" VL_PRI64 "u.%03" VL_PRI64 "u",
+			   (QData)(ld/VL_TIME_MULTIPLIER),
+			   (QData)(ld%VL_TIME_MULTIPLIER));
+	} else {
+	    vl_fatal(__FILE__,__LINE__,"","Unsupported VL_TIME_MULTIPLIER");
+	}
+	int needmore = width-digits;
+	if (needmore>0) output.append(needmore,' '); // Pre-pad spaces
+	output += tmp;
+	break;
+    }
+    case 'b':
+	for (; lsb>=0; --lsb) {
+	    output += ((lwp[VL_BITWORD_I(lsb)]>>VL_BITBIT_I(lsb)) & 1) + '0';
+	}
+	break;
+	break;
+    case 'o':
+	for (; lsb>=0; --lsb) {
+	    lsb = (lsb / 3) * 3; // Next digit
+	    // Octal numbers may span more than one wide word,
+	    // so we need to grab each bit separately and check for overrun
+	    // Octal is rare, so we'll do it a slow simple way
+	    output += ('0'
+		       + ((VL_BITISSETLIMIT_W(lwp, lbits, lsb+0)) ? 1 : 0)
+		       + ((VL_BITISSETLIMIT_W(lwp, lbits, lsb+1)) ? 2 : 0)
+		       + ((VL_BITISSETLIMIT_W(lwp, lbits, lsb+2)) ? 4 : 0));
+	}
+	break;
+    case 'u':  // Packed 2-state
+	output.reserve(output.size() + 4*VL_WORDS_I(lbits));
+	for (int i=0; i<VL_WORDS_I(lbits); ++i) {
+	    output += (char)((lwp[i]     ) & 0xff);
+	    output += (char)((lwp[i] >> 8) & 0xff);
+	    output += (char)((lwp[i] >> 16) & 0xff);
+	    output += (char)((lwp[i] >> 24) & 0xff);
+	}
+	break;
+    case 'z':  // Packed 4-state
+	output.reserve(output.size() + 8*VL_WORDS_I(lbits));
+	for (int i=0; i<VL_WORDS_I(lbits); ++i) {
+	    output += (char)((lwp[i]     ) & 0xff);
+	    output += (char)((lwp[i] >> 8) & 0xff);
+	    output += (char)((lwp[i] >> 16) & 0xff);
+	    output += (char)((lwp[i] >> 24) & 0xff);
+	    output += "\0\0\0\0"; // No tristate
+	}
+	break;
+    case 'v': // Strength; assume always strong
+	for (lsb=lbits-1; lsb>=0; --lsb) {
+	    if ((lwp[VL_BITWORD_I(lsb)]>>VL_BITBIT_I(lsb)) & 1) output += "St1 ";
+	    else output += "St0 ";
+	}
+	break;
+    case 'x':
+	for (; lsb>=0; --lsb) {
+	    lsb = (lsb / 4) * 4; // Next digit
+	    IData charval = (lwp[VL_BITWORD_I(lsb)]>>VL_BITBIT_I(lsb)) & 0xf;
+	    output += "0123456789abcdef"[charval];
+	}
+	break;
+    default:
+	string msg = string("Unknown _vl_vsformat code: ")+fmt;
+	vl_fatal(__FILE__,__LINE__,"",msg.c_str());
+	break;
+    } // switch
+}
+
 void _vl_vsformat(string& output, const char* formatp, va_list ap) {
     // Format a Verilog $write style format into the output list
     // The format must be pre-processed (and lower cased) by Verilator
@@ -449,141 +751,36 @@ void _vl_vsformat(string& output, const char* formatp, va_list ap) {
 		} else {
 		    lwp = va_arg(ap,WDataInP);
 		    ld = lwp[0];
-		    if (fmt == 'd' || fmt == '#') fmt = 'x';  // Not supported, but show something
-		}
-		int lsb=lbits-1;
-		if (widthSet && width==0) while (lsb && !VL_BITISSET_W(lwp,lsb)) --lsb;
-		switch (fmt) {
-		case 'c': {
-		    IData charval = ld & 0xff;
-		    output += charval;
-		    break;
-		}
-		case 's':
-		    for (; lsb>=0; --lsb) {
-			lsb = (lsb / 8) * 8; // Next digit
-			IData charval = (lwp[VL_BITWORD_I(lsb)]>>VL_BITBIT_I(lsb)) & 0xff;
-			output += (charval==0)?' ':charval;
-		    }
-		    break;
-		case 'd': { // Signed decimal
-		    int digits=sprintf(tmp,"%" VL_PRI64 "d",(vlsint64_t)(VL_EXTENDS_QQ(lbits,lbits,ld)));
-		    int needmore = width-digits;
-		    if (needmore>0) {
-			if (pctp && pctp[0] && pctp[1]=='0') { //%0
-			    output.append(needmore,'0'); // Pre-pad zero
-			} else {
-			    output.append(needmore,' '); // Pre-pad spaces
-			}
-		    }
-		    output += tmp;
-		    break;
 		}
-		case '#': { // Unsigned decimal
-		    int digits=sprintf(tmp,"%" VL_PRI64 "u",ld);
-		    int needmore = width-digits;
-		    if (needmore>0) {
-			if (pctp && pctp[0] && pctp[1]=='0') { //%0
-			    output.append(needmore,'0'); // Pre-pad zero
-			} else {
-			    output.append(needmore,' '); // Pre-pad spaces
-			}
-		    }
-		    output += tmp;
-		    break;
-		}
-		case 't': { // Time
-		    int digits;
-		    if (VL_TIME_MULTIPLIER==1) {
-			digits=sprintf(tmp,"%" VL_PRI64 "u",ld);
-		    } else if (VL_TIME_MULTIPLIER==1000) {
-			digits=sprintf(tmp,"%" VL_PRI64 "u.%03" VL_PRI64 "u",
-				       (QData)(ld/VL_TIME_MULTIPLIER),
-				       (QData)(ld%VL_TIME_MULTIPLIER));
-		    } else {
-			vl_fatal(__FILE__,__LINE__,"","Unsupported VL_TIME_MULTIPLIER");
-		    }
-		    int needmore = width-digits;
-		    if (needmore>0) output.append(needmore,' '); // Pre-pad spaces
-		    output += tmp;
-		    break;
-		}
-		case 'b':
-		    for (; lsb>=0; --lsb) {
-			output += ((lwp[VL_BITWORD_I(lsb)]>>VL_BITBIT_I(lsb)) & 1) + '0';
-		    }
-		    break;
-		    break;
-		case 'o':
-		    for (; lsb>=0; --lsb) {
-			lsb = (lsb / 3) * 3; // Next digit
-			// Octal numbers may span more than one wide word,
-			// so we need to grab each bit separately and check for overrun
-			// Octal is rare, so we'll do it a slow simple way
-			output += ('0'
-				   + ((VL_BITISSETLIMIT_W(lwp, lbits, lsb+0)) ? 1 : 0)
-				   + ((VL_BITISSETLIMIT_W(lwp, lbits, lsb+1)) ? 2 : 0)
-				   + ((VL_BITISSETLIMIT_W(lwp, lbits, lsb+2)) ? 4 : 0));
-		    }
-		    break;
-		case 'u':  // Packed 2-state
-		    output.reserve(output.size() + 4*VL_WORDS_I(lbits));
-		    for (int i=0; i<VL_WORDS_I(lbits); ++i) {
-			output += (char)((lwp[i]     ) & 0xff);
-			output += (char)((lwp[i] >> 8) & 0xff);
-			output += (char)((lwp[i] >> 16) & 0xff);
-			output += (char)((lwp[i] >> 24) & 0xff);
-		    }
-		    break;
-		case 'z':  // Packed 4-state
-		    output.reserve(output.size() + 8*VL_WORDS_I(lbits));
-		    for (int i=0; i<VL_WORDS_I(lbits); ++i) {
-			output += (char)((lwp[i]     ) & 0xff);
-			output += (char)((lwp[i] >> 8) & 0xff);
-			output += (char)((lwp[i] >> 16) & 0xff);
-			output += (char)((lwp[i] >> 24) & 0xff);
-			output += "\0\0\0\0"; // No tristate
-		    }
-		    break;
-		case 'v': // Strength; assume always strong
-		    for (lsb=lbits-1; lsb>=0; --lsb) {
-			if ((lwp[VL_BITWORD_I(lsb)]>>VL_BITBIT_I(lsb)) & 1) output += "St1 ";
-			else output += "St0 ";
-		    }
-		    break;
-		case 'x':
-		    for (; lsb>=0; --lsb) {
-			lsb = (lsb / 4) * 4; // Next digit
-			IData charval = (lwp[VL_BITWORD_I(lsb)]>>VL_BITBIT_I(lsb)) & 0xf;
-			output += "0123456789abcdef"[charval];
-		    }
-		    break;
-		default:
-		    string msg = string("Unknown _vl_vsformat code: ")+pos[0];
-		    vl_fatal(__FILE__,__LINE__,"",msg.c_str());
-		    break;
-		} // switch
+		_vl_vsformat_num(output, fmt, widthSet, width, (pctp[1]=='0'), lbits, ld, lwp);
 	    }
 	    } // switch
 	}
     }
 }
 
+// For a $fscanf, floc holds the character read ahead, or VL_VSSS_NONE
+#define VL_VSSS_NONE (-2)
+
 static inline bool _vl_vsss_eof(FILE* fp, int& floc) {
-    if (fp) return feof(fp) ? 1 : 0;  // 1:0 to prevent MSVC++ warning
+    if (fp) {
+	if (floc != VL_VSSS_NONE) return floc == EOF;
+	return feof(fp) ? 1 : 0;  // 1:0 to prevent MSVC++ warning
+    }
     else return (floc<0);
 }
 static inline void _vl_vsss_advance(FILE* fp, int& floc) {
-    if (fp) fgetc(fp);
+    if (fp) {
+	if (floc != VL_VSSS_NONE) floc = VL_VSSS_NONE;
+	else VL_GETC_UNLOCKED(fp);
+    }
     else floc -= 8;
 }
 static inline int  _vl_vsss_peek(FILE* fp, int& floc, WDataInP fromp, const string& fstr) {
     // Get a character without advancing
     if (fp) {
-	int data = fgetc(fp);
-	if (data == EOF) return EOF;
-	ungetc(data,fp);
-	return data;
+	if (floc == VL_VSSS_NONE) floc = VL_GETC_UNLOCKED(fp);
+	return floc;
     } else {
 	if (floc < 0) return EOF;
 	floc = floc & ~7;	// Align to closest character
@@ -624,29 +821,52 @@ static inline void _vl_vsss_setbit(WDataOutP owp, int obits, int lsb, int nbits,
 }
 static inline void _vl_vsss_based(WDataOutP owp, int obits, int baseLog2, const char* strp, int posstart, int posend) {
     // Read in base "2^^baseLog2" digits from strp[posstart..posend-1] into owp of size obits.
+    // owp is zero, so each digit is ORed into place.
     int lsb = 0;
-    for (int i=0, pos=posend-1; i<obits && pos>=posstart; --pos) {
-	switch (tolower (strp[pos])) {
-	case 'x': case 'z': case '?': //FALLTHRU
-	case '0': lsb += baseLog2; break;
-	case '1': _vl_vsss_setbit(owp,obits,lsb, baseLog2,  1); lsb+=baseLog2; break;
-	case '2': _vl_vsss_setbit(owp,obits,lsb, baseLog2,  2); lsb+=baseLog2; break;
-	case '3': _vl_vsss_setbit(owp,obits,lsb, baseLog2,  3); lsb+=baseLog2; break;
-	case '4': _vl_vsss_setbit(owp,obits,lsb, baseLog2,  4); lsb+=baseLog2; break;
-	case '5': _vl_vsss_setbit(owp,obits,lsb, baseLog2,  5); lsb+=baseLog2; break;
-	case '6': _vl_vsss_setbit(owp,obits,lsb, baseLog2,  6); lsb+=baseLog2; break;
-	case '7': _vl_vsss_setbit(owp,obits,lsb, baseLog2,  7); lsb+=baseLog2; break;
-	case '8': _vl_vsss_setbit(owp,obits,lsb, baseLog2,  8); lsb+=baseLog2; break;
-	case '9': _vl_vsss_setbit(owp,obits,lsb, baseLog2,  9); lsb+=baseLog2; break;
-	case 'a': _vl_vsss_setbit(owp,obits,lsb, baseLog2, 10); lsb+=baseLog2; break;
-	case 'b': _vl_vsss_setbit(owp,obits,lsb, baseLog2, 11); lsb+=baseLog2; break;
-	case 'c': _vl_vsss_setbit(owp,obits,lsb, baseLog2, 12); lsb+=baseLog2; break;
-	case 'd': _vl_vsss_setbit(owp,obits,lsb, baseLog2, 13); lsb+=baseLog2; break;
-	case 'e': _vl_vsss_setbit(owp,obits,lsb, baseLog2, 14); lsb+=baseLog2; break;
-	case 'f': _vl_vsss_setbit(owp,obits,lsb, baseLog2, 15); lsb+=baseLog2; break;
-	case '_': break;
+    for (int pos=posend-1; lsb<obits && pos>=posstart; --pos) {
+	IData digit;
+	char c = tolower(strp[pos]);
+	if (c>='0' && c<='9') digit = c - '0';
+	else if (c>='a' && c<='f') digit = c - 'a' + 10;
+	else if (c=='_') continue;
+	else digit = 0;  // x, z, ?
+	if (digit) {
+	    if (lsb + baseLog2 > obits) digit &= VL_MASK_I(obits - lsb);
+	    int bit = VL_BITBIT_I(lsb);
+	    owp[VL_BITWORD_I(lsb)] |= digit << bit;
+	    if (bit + baseLog2 > VL_WORDSIZE && (digit >> (VL_WORDSIZE - bit))) {
+		owp[VL_BITWORD_I(lsb)+1] |= digit >> (VL_WORDSIZE - bit);
+	    }
+	}
+	lsb += baseLog2;
+    }
+}
+static inline void _vl_vsss_decimal(WDataOutP owp, int obits, const char* strp) {
+    // Read in optionally signed decimal digits from strp into owp of size obits.
+    // owp is zero, and at least two words, as used for non-wide results.
+    int words = VL_WORDS_I(obits) > 2 ? VL_WORDS_I(obits) : 2;
+    bool neg = false;
+    if (*strp=='-' || *strp=='+') neg = (*strp++ == '-');
+    for (; *strp>='0' && *strp<='9'; ++strp) {
+	QData carry = *strp - '0';
+	for (int i=0; i<words; ++i) {
+	    QData prod = (QData)owp[i] * 10 + carry;
+	    owp[i] = (IData)prod;
+	    carry = prod >> VL_WORDSIZE;
+	}
+    }
+    if (neg) {
+	QData carry = 1;
+	for (int i=0; i<words; ++i) {
+	    QData sum = (QData)(IData)~owp[i] + carry;
+	    owp[i] = (IData)sum;
+	    carry = sum >> VL_WORDSIZE;
 	}
     }
+    if (obits < words*VL_WORDSIZE) {
+	owp[VL_WORDS_I(obits)-1] &= VL_MASK_I(obits);
+	for (int i=VL_WORDS_I(obits); i<words; ++i) owp[i] = 0;
+    }
 }
 
 IData _vl_vsscanf(FILE* fp,  // If a fscanf
@@ -659,6 +879,10 @@ IData _vl_vsscanf(FILE* fp,  // If a fscanf
     static VL_THREAD char tmp[VL_VALUE_STRING_MAX_WIDTH];
     int floc = fbits - 1;
     IData got = 0;
+    if (fp) {
+	floc = VL_VSSS_NONE;
+	VL_FLOCKFILE(fp);
+    }
     bool inPct = false;
     const char* pos = formatp;
     for (; *pos && !_vl_vsss_eof(fp,floc); ++pos) {
@@ -717,9 +941,7 @@ IData _vl_vsscanf(FILE* fp,  // If a fscanf
 		    _vl_vsss_skipspace(fp,floc,fromp,fstr);
 		    _vl_vsss_read(fp,floc,fromp,fstr, tmp, "0123456789+-xXzZ?_");
 		    if (!tmp[0]) goto done;
-		    vlsint64_t ld;
-		    sscanf(tmp,"%30" VL_PRI64 "d",&ld);
-		    VL_SET_WQ(owp,ld);
+		    _vl_vsss_decimal(owp,obits, tmp);
 		    break;
 		}
 		case 'f':
@@ -739,9 +961,7 @@ IData _vl_vsscanf(FILE* fp,  // If a fscanf
 		    _vl_vsss_skipspace(fp,floc,fromp,fstr);
 		    _vl_vsss_read(fp,floc,fromp,fstr, tmp, "0123456789+-xXzZ?_");
 		    if (!tmp[0]) goto done;
-		    QData ld;
-		    sscanf(tmp,"%30" VL_PRI64 "u",&ld);
-		    VL_SET_WQ(owp,ld);
+		    _vl_vsss_decimal(owp,obits, tmp);
 		    break;
 		}
 		case 'b': {
@@ -787,9 +1007,436 @@ IData _vl_vsscanf(FILE* fp,  // If a fscanf
 	}
     }
   done:
+    if (fp) {
+	if (floc >= 0) ungetc(floc, fp);  // Leave the read-ahead for the next read
+	VL_FUNLOCKFILE(fp);
+    }
     return got;
 }
 
+//===========================================================================
+// Output buffering -- after Verilated::outputBuffer, stdout and each $fopen'ed
+// file get a large stdio buffer, so a $display no longer costs a write per
+// line.  Under VL_THREADED a background thread flushes every
+// VL_OUTBUF_FLUSH_MS so logs stay current; the buffers are also drained by
+// Verilated::flushCall (so on $finish and vl_fatal), at exit, and on
+// crashing signals.
+
+#ifndef VL_OUTBUF_FLUSH_MS
+# define VL_OUTBUF_FLUSH_MS 100	///< Background flush interval, in milliseconds
+#endif
+
+static size_t s_outBufSize = 0;		///< Verilated::outputBuffer bytes, 0 = stdio default
+static map<FILE*,char*> s_outBufs;	///< Buffers given to setvbuf, freed on close
+
+static VerilatedMutex s_outBufMutex;	///< Protects s_outBufs
+#ifdef VL_THREADED
+static volatile bool s_outBufStop = false;	///< Tell flusher thread to exit
+#endif
+
+static void vl_outbuf_flush() {
+    fflush(NULL);
+}
+
+static void vl_outbuf_attach(FILE* fp) {
+    if (!s_outBufSize || !fp) return;
+    char* bufp = (char*)malloc(s_outBufSize);
+    if (VL_UNLIKELY(!bufp)) return;  // Keep stdio's buffer
+    fflush(fp);
+    if (setvbuf(fp, bufp, _IOFBF, s_outBufSize)) { free(bufp); return; }
+    s_outBufMutex.lock();
+    char*& oldp = s_outBufs[fp];
+    if (oldp) free(oldp);  // No longer used by the stream
+    oldp = bufp;
+    s_outBufMutex.unlock();
+}
+
+static char* vl_outbuf_detach(FILE* fp) {
+    // Returns buffer to free once fp is closed
+    s_outBufMutex.lock();
+    char* bufp = NULL;
+    map<FILE*,char*>::iterator it = s_outBufs.find(fp);
+    if (it != s_outBufs.end()) { bufp = it->second; s_outBufs.erase(it); }
+    s_outBufMutex.unlock();
+    return bufp;
+}
+
+static void vl_outbuf_signal(int sig) {
+    // Not async-signal safe, but the process is dying and the log matters more
+    fflush(NULL);
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+static void vl_outbuf_signals() {
+    static const int sigs[] = {
+	SIGABRT, SIGFPE, SIGILL, SIGINT, SIGSEGV, SIGTERM,
+#ifdef SIGBUS
+	SIGBUS,
+#endif
+    };
+    for (size_t i=0; i<sizeof(sigs)/sizeof(sigs[0]); ++i) {
+	// Leave alone any handler the application installed
+	void (*oldp)(int) = signal(sigs[i], &vl_outbuf_signal);
+	if (oldp != SIG_DFL) signal(sigs[i], oldp);
+    }
+}
+
+#ifdef VL_THREADED
+static void vl_outbuf_thread() {
+    while (!s_outBufStop) {
+	std::this_thread::sleep_for(std::chrono::milliseconds(VL_OUTBUF_FLUSH_MS));
+	fflush(NULL);
+    }
+}
+static void vl_outbuf_exit() {
+    s_outBufStop = true;
+}
+#endif
+
+void Verilated::outputBuffer(size_t bytes) {
+    static bool s_started = false;
+    s_outBufSize = bytes;
+    if (!bytes) return;  // Later files get stdio's default; open ones keep theirs
+    vl_outbuf_attach(stdout);
+    if (s_started) return;
+    s_started = true;
+    flushCb(&vl_outbuf_flush);
+    vl_outbuf_signals();
+#ifdef VL_THREADED
+    atexit(&vl_outbuf_exit);
+    std::thread(&vl_outbuf_thread).detach();
+#endif
+}
+
+size_t Verilated::outputBuffer() {
+    return s_outBufSize;
+}
+
+static string s_threadsAffinity;	///< CPUs for --threads pools, "" = not pinned
+
+void Verilated::threadsAffinity(const char* cpusp) {
+    s_threadsAffinity = cpusp;
+}
+
+const char* Verilated::threadsAffinity() {
+    return s_threadsAffinity.c_str();
+}
+
+//===========================================================================
+// Function profiling, for --profile-counters.  Each generated function
+// registers here on its first call; at exit the counts are written along
+// with the tick rate, found by timing the tick counter against the OS clock
+// over the run.
+
+static VerilatedProfCFunc* s_profFuncsp = NULL;	///< Registered functions, newest first
+static string s_profFilename = "profile_counters.dat";	///< Written at exit
+static vluint64_t s_profStartTicks = 0;	///< Tick counter at first registration
+static vluint64_t s_profStartClock = 0;	///< OS clock at first registration
+
+static VerilatedMutex s_profMutex;	///< Protects s_profFuncsp
+
+VL_THREAD VerilatedProfScope* VerilatedProfScope::t_currentp = NULL;
+
+static void vl_prof_exit() {
+    VerilatedProfCFunc::write(s_profFilename.c_str());
+}
+
+VerilatedProfCFunc::VerilatedProfCFunc(const char* namep)
+    : m_namep(namep), m_nextp(NULL), m_calls(0), m_selfTicks(0), m_totalTicks(0) {
+    s_profMutex.lock();
+    if (!s_profFuncsp) {
+	VL_RDTSC(s_profStartTicks);
+	s_profStartClock = clockTicks();
+	atexit(&vl_prof_exit);
+    }
+    m_nextp = s_profFuncsp;
+    s_profFuncsp = this;
+    s_profMutex.unlock();
+}
+
+vluint64_t VerilatedProfCFunc::clockTicks() {
+    // Microseconds
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (vluint64_t)tv.tv_sec * VL_ULL(1000000) + (vluint64_t)tv.tv_usec;
+}
+
+void VerilatedProfCFunc::filename(const char* filenamep) {
+    s_profFilename = filenamep;
+}
+
+const char* VerilatedProfCFunc::filename() {
+    return s_profFilename.c_str();
+}
+
+void VerilatedProfCFunc::write(const char* filenamep) {
+    vluint64_t endTicks;
+    VL_RDTSC(endTicks);
+    vluint64_t endClock = clockTicks();
+    FILE* fp = fopen(filenamep, "w");
+    if (VL_UNLIKELY(!fp)) {
+	// Usually called at exit, so just warn
+	VL_PRINTF("%%Warning: Can't write '%s'\n", filenamep);
+	return;
+    }
+    double secs = (double)(endClock - s_profStartClock) / 1.0e6;
+    double ticksPerSec = (secs > 0) ? ((double)(endTicks - s_profStartTicks) / secs) : 1.0;
+    fprintf(fp, "# Verilator --profile-counters output; see verilator_profcfunc\n");
+    fprintf(fp, "VLPROF 1\n");
+    fprintf(fp, "ticks_per_sec %.0f\n", ticksPerSec);
+    fprintf(fp, "total_ticks %" VL_PRI64 "u\n", endTicks - s_profStartTicks);
+    s_profMutex.lock();
+    for (VerilatedProfCFunc* funcp = s_profFuncsp; funcp; funcp = funcp->m_nextp) {
+	fprintf(fp, "cfunc %" VL_PRI64 "u %" VL_PRI64 "u %" VL_PRI64 "u %s\n",
+		funcp->m_calls, funcp->m_selfTicks, funcp->m_totalTicks, funcp->m_namep);
+    }
+    s_profMutex.unlock();
+    fclose(fp);
+}
+
+//===========================================================================
+// Branch profiling, for --profile-branches.  Each generated if registers
+// here on its first use; at exit the counts are written.
+
+static VerilatedProfBranch* s_profBranchesp = NULL;	///< Registered branches, newest first
+static string s_profBranchFilename = "profile_branches.dat";	///< Written at exit
+
+static void vl_prof_branch_exit() {
+    VerilatedProfBranch::write(s_profBranchFilename.c_str());
+}
+
+VerilatedProfBranch::VerilatedProfBranch(const char* namep)
+    : m_namep(namep), m_nextp(NULL), m_taken(0), m_notTaken(0) {
+    s_profMutex.lock();
+    if (!s_profBranchesp) atexit(&vl_prof_branch_exit);
+    m_nextp = s_profBranchesp;
+    s_profBranchesp = this;
+    s_profMutex.unlock();
+}
+
+void VerilatedProfBranch::filename(const char* filenamep) {
+    s_profBranchFilename = filenamep;
+}
+
+const char* VerilatedProfBranch::filename() {
+    return s_profBranchFilename.c_str();
+}
+
+void VerilatedProfBranch::write(const char* filenamep) {
+    FILE* fp = fopen(filenamep, "w");
+    if (VL_UNLIKELY(!fp)) {
+	// Usually called at exit, so just warn
+	VL_PRINTF("%%Warning: Can't write '%s'\n", filenamep);
+	return;
+    }
+    fprintf(fp, "# Verilator --profile-branches output; see --branch-profile\n");
+    fprintf(fp, "VLPROFBRANCH 1\n");
+    s_profMutex.lock();
+    for (VerilatedProfBranch* branchp = s_profBranchesp; branchp; branchp = branchp->m_nextp) {
+	fprintf(fp, "branch %" VL_PRI64 "u %" VL_PRI64 "u %s\n",
+		branchp->m_taken, branchp->m_notTaken, branchp->m_namep);
+    }
+    s_profMutex.unlock();
+    fclose(fp);
+}
+
+//===========================================================================
+// Block activity profiling, for --profile-activity.  Each model registers
+// its counter table when constructed; at exit the counts are written.
+
+struct VerilatedProfActivityTable {
+    const vluint64_t*	m_countsp;	///< Model's counters, or m_saved once deleted
+    const char* const*	m_namesp;	///< Name of each counter
+    int			m_count;	///< Number of counters
+    vector<vluint64_t>	m_saved;	///< Counts of a deleted model
+};
+static vector<VerilatedProfActivityTable*> s_profActivityTables;	///< Registered models
+static string s_profActivityFilename = "profile_activity.dat";	///< Written at exit
+
+static void vl_prof_activity_exit() {
+    VerilatedProfActivity::write(s_profActivityFilename.c_str());
+}
+
+void VerilatedProfActivity::insert(vluint64_t* countsp, const char* const* namesp, int count) {
+    memset(countsp, 0, count * sizeof(vluint64_t));
+    VerilatedProfActivityTable* tablep = new VerilatedProfActivityTable;
+    tablep->m_countsp = countsp;
+    tablep->m_namesp = namesp;
+    tablep->m_count = count;
+    s_profMutex.lock();
+    if (s_profActivityTables.empty()) atexit(&vl_prof_activity_exit);
+    s_profActivityTables.push_back(tablep);
+    s_profMutex.unlock();
+}
+
+void VerilatedProfActivity::remove(const vluint64_t* countsp) {
+    s_profMutex.lock();
+    for (size_t i=0; i<s_profActivityTables.size(); ++i) {
+	VerilatedProfActivityTable* tablep = s_profActivityTables[i];
+	if (tablep->m_countsp == countsp) {
+	    tablep->m_saved.assign(countsp, countsp + tablep->m_count);
+	    tablep->m_countsp = &tablep->m_saved[0];
+	}
+    }
+    s_profMutex.unlock();
+}
+
+void VerilatedProfActivity::filename(const char* filenamep) {
+    s_profActivityFilename = filenamep;
+}
+
+const char* VerilatedProfActivity::filename() {
+    return s_profActivityFilename.c_str();
+}
+
+void VerilatedProfActivity::write(const char* filenamep) {
+    FILE* fp = fopen(filenamep, "w");
+    if (VL_UNLIKELY(!fp)) {
+	// Usually called at exit, so just warn
+	VL_PRINTF("%%Warning: Can't write '%s'\n", filenamep);
+	return;
+    }
+    fprintf(fp, "# Verilator --profile-activity output\n");
+    fprintf(fp, "# block <entries> <module> <scope> <filename:lineno>\n");
+    fprintf(fp, "# module <entries of its blocks> <module>\n");
+    fprintf(fp, "VLPROFACTIVITY 1\n");
+    map<string,vluint64_t> modCounts;
+    s_profMutex.lock();
+    for (size_t i=0; i<s_profActivityTables.size(); ++i) {
+	const VerilatedProfActivityTable* tablep = s_profActivityTables[i];
+	for (int b=0; b<tablep->m_count; ++b) {
+	    const char* namep = tablep->m_namesp[b];
+	    fprintf(fp, "block %" VL_PRI64 "u %s\n", tablep->m_countsp[b], namep);
+	    const char* endp = strchr(namep, ' ');
+	    modCounts[endp ? string(namep, endp-namep) : string(namep)] += tablep->m_countsp[b];
+	}
+    }
+    s_profMutex.unlock();
+    for (map<string,vluint64_t>::iterator it = modCounts.begin(); it != modCounts.end(); ++it) {
+	fprintf(fp, "module %" VL_PRI64 "u %s\n", it->second, it->first.c_str());
+    }
+    fclose(fp);
+}
+
+//===========================================================================
+// Eval convergence profiling, for --profile-converge.  Registered as with
+// block activity; the saved counts hold the loops then the changes.
+
+struct VerilatedProfConvergeTable {
+    const vluint64_t*	m_loopsp;	///< Model's iteration histogram, or in m_saved once deleted
+    const vluint64_t*	m_changesp;	///< Model's change counters, or in m_saved once deleted
+    const char* const*	m_namesp;	///< Name of each change counter
+    int			m_count;	///< Number of change counters
+    vector<vluint64_t>	m_saved;	///< Counts of a deleted model
+};
+static vector<VerilatedProfConvergeTable*> s_profConvergeTables;	///< Registered models
+static string s_profConvergeFilename = "profile_converge.dat";	///< Written at exit
+
+static void vl_prof_converge_exit() {
+    VerilatedProfConverge::write(s_profConvergeFilename.c_str());
+}
+
+void VerilatedProfConverge::insert(vluint64_t* loopsp, vluint64_t* changesp,
+				   const char* const* namesp, int count) {
+    memset(loopsp, 0, VL_PROF_CONVERGE_LOOPS * sizeof(vluint64_t));
+    if (count) memset(changesp, 0, count * sizeof(vluint64_t));
+    VerilatedProfConvergeTable* tablep = new VerilatedProfConvergeTable;
+    tablep->m_loopsp = loopsp;
+    tablep->m_changesp = changesp;
+    tablep->m_namesp = namesp;
+    tablep->m_count = count;
+    s_profMutex.lock();
+    if (s_profConvergeTables.empty()) atexit(&vl_prof_converge_exit);
+    s_profConvergeTables.push_back(tablep);
+    s_profMutex.unlock();
+}
+
+void VerilatedProfConverge::remove(const vluint64_t* loopsp) {
+    s_profMutex.lock();
+    for (size_t i=0; i<s_profConvergeTables.size(); ++i) {
+	VerilatedProfConvergeTable* tablep = s_profConvergeTables[i];
+	if (tablep->m_loopsp == loopsp) {
+	    tablep->m_saved.assign(loopsp, loopsp + VL_PROF_CONVERGE_LOOPS);
+	    tablep->m_saved.insert(tablep->m_saved.end(),
+				   tablep->m_changesp, tablep->m_changesp + tablep->m_count);
+	    tablep->m_loopsp = &tablep->m_saved[0];
+	    tablep->m_changesp = &tablep->m_saved[VL_PROF_CONVERGE_LOOPS];
+	}
+    }
+    s_profMutex.unlock();
+}
+
+vluint64_t VerilatedProfConverge::evals(int iterations) {
+    if (iterations < 1) return 0;
+    int bucket = (iterations < VL_PROF_CONVERGE_LOOPS) ? iterations-1 : VL_PROF_CONVERGE_LOOPS-1;
+    vluint64_t total = 0;
+    s_profMutex.lock();
+    for (size_t i=0; i<s_profConvergeTables.size(); ++i) {
+	total += s_profConvergeTables[i]->m_loopsp[bucket];
+    }
+    s_profMutex.unlock();
+    return total;
+}
+
+vluint64_t VerilatedProfConverge::changes(const char* namep) {
+    size_t len = strlen(namep);
+    vluint64_t total = 0;
+    s_profMutex.lock();
+    for (size_t i=0; i<s_profConvergeTables.size(); ++i) {
+	const VerilatedProfConvergeTable* tablep = s_profConvergeTables[i];
+	for (int c=0; c<tablep->m_count; ++c) {
+	    // Match the full name, or just the variable before the location
+	    const char* cnamep = tablep->m_namesp[c];
+	    if (0 == strncmp(cnamep, namep, len) && (!cnamep[len] || cnamep[len] == ' ')) {
+		total += tablep->m_changesp[c];
+	    }
+	}
+    }
+    s_profMutex.unlock();
+    return total;
+}
+
+void VerilatedProfConverge::filename(const char* filenamep) {
+    s_profConvergeFilename = filenamep;
+}
+
+const char* VerilatedProfConverge::filename() {
+    return s_profConvergeFilename.c_str();
+}
+
+void VerilatedProfConverge::write(const char* filenamep) {
+    FILE* fp = fopen(filenamep, "w");
+    if (VL_UNLIKELY(!fp)) {
+	// Usually called at exit, so just warn
+	VL_PRINTF("%%Warning: Can't write '%s'\n", filenamep);
+	return;
+    }
+    fprintf(fp, "# Verilator --profile-converge output\n");
+    fprintf(fp, "# loops <iterations> <evals>\n");
+    fprintf(fp, "# change <extra iterations requested> <variable> <filename:lineno>\n");
+    fprintf(fp, "VLPROFCONVERGE 1\n");
+    vluint64_t loops[VL_PROF_CONVERGE_LOOPS];
+    memset(loops, 0, sizeof(loops));
+    s_profMutex.lock();
+    for (size_t i=0; i<s_profConvergeTables.size(); ++i) {
+	for (int l=0; l<VL_PROF_CONVERGE_LOOPS; ++l) loops[l] += s_profConvergeTables[i]->m_loopsp[l];
+    }
+    for (int l=0; l<VL_PROF_CONVERGE_LOOPS; ++l) {
+	if (!loops[l]) continue;
+	fprintf(fp, "loops %d%s %" VL_PRI64 "u\n", l+1,
+		(l == VL_PROF_CONVERGE_LOOPS-1) ? "+" : "", loops[l]);
+    }
+    for (size_t i=0; i<s_profConvergeTables.size(); ++i) {
+	const VerilatedProfConvergeTable* tablep = s_profConvergeTables[i];
+	for (int c=0; c<tablep->m_count; ++c) {
+	    fprintf(fp, "change %" VL_PRI64 "u %s\n", tablep->m_changesp[c], tablep->m_namesp[c]);
+	}
+    }
+    s_profMutex.unlock();
+    fclose(fp);
+}
+
 //===========================================================================
 // File I/O
 
@@ -841,12 +1488,14 @@ IData VL_FGETS_IXI(int obits, void* destp, IData fpi) {
     // We don't use fgets, as we must read \0s.
     IData got = 0;
     char* cp = buffer;
+    VL_FLOCKFILE(fp);
     while (got < bytes) {
-	int c = getc(fp);
+	int c = VL_GETC_UNLOCKED(fp);
 	if (c==EOF) break;
 	*cp++ = c;  got++;
 	if (c=='\n') break;
     }
+    VL_FUNLOCKFILE(fp);
 
     _VL_STRING_TO_VINT(obits, destp, got, buffer);
     return got;
@@ -869,13 +1518,17 @@ IData VL_FOPEN_WI(int fnwords, WDataInP filenamep, IData mode) {
     return VL_FOPEN_S(filenamez,modez);
 }
 IData VL_FOPEN_S(const char* filenamep, const char* modep) {
-    return VerilatedImp::fdNew(fopen(filenamep,modep));
+    FILE* fp = fopen(filenamep,modep);
+    vl_outbuf_attach(fp);
+    return VerilatedImp::fdNew(fp);
 }
 
 void VL_FCLOSE_I(IData fdi) {
     FILE* fp = VL_CVT_I_FP(fdi);
     if (VL_UNLIKELY(!fp)) return;
+    char* bufp = vl_outbuf_detach(fp);
     fclose(fp);
+    if (bufp) free(bufp);
     VerilatedImp::fdDelete(fdi);
 }
 
@@ -980,6 +1633,57 @@ void VL_FWRITEF(IData fpi, const char* formatp, ...) {
     fputs(output.c_str(), fp);
 }
 
+void VerilatedFmtBuf::grow(size_t len) {
+    size_t size = m_size * 2;
+    while (size <= m_len + len) size *= 2;
+    if (m_bufp == m_inline) {
+	m_bufp = (char*)malloc(size);
+	memcpy(m_bufp, m_inline, m_len);
+    } else {
+	m_bufp = (char*)realloc(m_bufp, size);
+    }
+    if (VL_UNLIKELY(!m_bufp)) vl_fatal(__FILE__,__LINE__,"","Out of memory for $display");
+    m_size = size;
+}
+
+void VerilatedFmtBuf::num(char fmt, int width, bool zeroPad, int lbits, QData ld) {
+    WData lwp[2];  VL_SET_WQ(lwp, ld);
+    _vl_vsformat_num(*this, fmt, (width>=0), width, zeroPad, lbits, ld, lwp);
+}
+void VerilatedFmtBuf::num(char fmt, int width, bool zeroPad, int lbits, WDataInP lwp) {
+    _vl_vsformat_num(*this, fmt, (width>=0), width, zeroPad, lbits, (QData)(lwp[0]), lwp);
+}
+void VerilatedFmtBuf::real(const char* specp, double d) {
+    static VL_THREAD char tmp[VL_VALUE_STRING_MAX_WIDTH];
+    sprintf(tmp, specp, d);
+    cstr(tmp);
+}
+
+void VerilatedFmtBuf::writef() {
+    // Users can redefine VL_PRINTF if they wish.
+    VL_PRINTF("%s", c_str());
+}
+void VerilatedFmtBuf::fwritef(IData fpi) {
+    FILE* fp = VL_CVT_I_FP(fpi);
+    if (VL_UNLIKELY(!fp)) return;
+    fputs(c_str(), fp);
+}
+void VerilatedFmtBuf::sformat(int obits, CData& destr) {
+    _VL_STRING_TO_VINT(obits, &destr, (int)m_len, c_str());
+}
+void VerilatedFmtBuf::sformat(int obits, SData& destr) {
+    _VL_STRING_TO_VINT(obits, &destr, (int)m_len, c_str());
+}
+void VerilatedFmtBuf::sformat(int obits, IData& destr) {
+    _VL_STRING_TO_VINT(obits, &destr, (int)m_len, c_str());
+}
+void VerilatedFmtBuf::sformat(int obits, QData& destr) {
+    _VL_STRING_TO_VINT(obits, &destr, (int)m_len, c_str());
+}
+void VerilatedFmtBuf::sformat(int obits, void* destp) {
+    _VL_STRING_TO_VINT(obits, destp, (int)m_len, c_str());
+}
+
 IData VL_FSCANF_IX(IData fpi, const char* formatp, ...) {
     FILE* fp = VL_CVT_I_FP(fpi);
     if (VL_UNLIKELY(!fp)) return 0;
@@ -1038,106 +1742,376 @@ void VL_READMEM_W(bool hex, int width, int depth, int array_lsb, int fnwords,
     return VL_READMEM_N(hex,width,depth,array_lsb,fnwords,ofilenames,memp,start,end);
 }
 
-void VL_READMEM_N(bool hex, int width, int depth, int array_lsb, int fnwords,
-		  const string& ofilenamep, void* memp, IData start, IData end) {
-    if (fnwords) {}
-    FILE* fp = fopen(ofilenamep.c_str(), "r");
-    if (VL_UNLIKELY(!fp)) {
+void VL_READMEM_Q(bool hex, int width, int depth, int array_lsb, int,
+		  QData ofilename, VerilatedSparseMem* memp, IData start, IData end) {
+    WData fnw[2];  VL_SET_WQ(fnw, ofilename);
+    return VL_READMEM_W(hex,width,depth,array_lsb,2, fnw,memp,start,end);
+}
+
+void VL_READMEM_W(bool hex, int width, int depth, int array_lsb, int fnwords,
+		  WDataInP ofilenamep, VerilatedSparseMem* memp, IData start, IData end) {
+    char ofilenamez[VL_TO_STRING_MAX_WORDS*VL_WORDSIZE+1];
+    _VL_VINT_TO_STRING(fnwords*VL_WORDSIZE, ofilenamez, ofilenamep);
+    string ofilenames(ofilenamez);
+    return VL_READMEM_N(hex,width,depth,array_lsb,fnwords,ofilenames,memp,start,end);
+}
+
+//===========================================================================
+// $readmem loading
+//
+// The whole file is mapped (or read) into memory and parsed from there,
+// rather than with a locked fgetc per character, and the digits of each
+// number are collected and stored once rather than shifted into the entry
+// digit by digit.  Under VL_THREADED, large files that are a plain run of
+// values, without @addresses or block comments, are split at line
+// boundaries and parsed on several threads.
+
+#define VL_READMEM_THREAD_MIN_BYTES (16*1024*1024)	///< Smallest file parsed on multiple threads
+#define VL_READMEM_THREADS_MAX 8	///< Most threads used to parse one file
+
+class VlReadMemFile {
+    // Contents of a $readmem file
+    const char*		m_datap;	///< File contents
+    size_t		m_size;		///< Bytes in file
+    bool		m_mapped;	///< m_datap is mmap'ed
+    vector<char>	m_buf;		///< File contents, if not mapped
+public:
+    VlReadMemFile() : m_datap(NULL), m_size(0), m_mapped(false) {}
+    ~VlReadMemFile() {
+#ifdef VL_READMEM_MMAP
+	if (m_mapped) munmap((void*)m_datap, m_size);
+#endif
+    }
+    const char* datap() const { return m_datap; }
+    size_t size() const { return m_size; }
+    bool open(const char* filenamep) {
+#ifdef VL_READMEM_MMAP
+	int fd = ::open(filenamep, O_RDONLY);
+	if (fd < 0) return false;
+	struct stat st;
+	if (0 == fstat(fd, &st) && S_ISREG(st.st_mode) && st.st_size > 0) {
+	    void* mapp = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	    if (mapp != MAP_FAILED) {
+		madvise(mapp, (size_t)st.st_size, MADV_SEQUENTIAL);
+		m_datap = (const char*)mapp;
+		m_size = (size_t)st.st_size;
+		m_mapped = true;
+		::close(fd);
+		return true;
+	    }
+	}
+	::close(fd);
+#endif
+	// Not mappable (pipe, empty, other OS), so read it
+	FILE* fp = fopen(filenamep, "r");
+	if (!fp) return false;
+	char buf[65536];
+	size_t got;
+	while (0 < (got = fread(buf, 1, sizeof(buf), fp))) m_buf.insert(m_buf.end(), buf, buf+got);
+	fclose(fp);
+	m_datap = m_buf.empty() ? "" : &m_buf[0];
+	m_size = m_buf.size();
+	return true;
+    }
+};
+
+class VlReadMem {
+    // Parser for a $readmem file, or a piece of one
+    // MEMBERS - what to load
+    bool		m_hex;		///< $readmemh, else $readmemb
+    int			m_width;	///< Entry width in bits
+    int			m_depth;	///< Entries in array
+    int			m_array_lsb;	///< Address of entry 0
+    void*		m_memp;		///< Dense storage, or NULL
+    VerilatedSparseMem*	m_sparsep;	///< Sparse storage, or NULL; if both NULL only count
+    size_t		m_entryBytes;	///< Bytes per dense entry
+    // MEMBERS - parse state
+    IData		m_addr;		///< Address of current/next entry
+    int			m_linenum;	///< Line number
+    bool		m_innum;	///< Inside a number
+    bool		m_ignore_to_eol;  ///< Inside // comment
+    bool		m_ignore_to_cmt;  ///< Inside /* comment
+    bool		m_needinc;	///< Increment m_addr before next number
+    bool		m_reading_addr;	///< Number is an @address
+    int			m_lastc;	///< Previous character
+    QData		m_value;	///< Current number, if not wide
+    vector<vluint8_t>	m_digits;	///< Current number's digits, if wide
+    IData		m_entries;	///< Numbers stored
+    // MEMBERS - errors
+    const char*		m_errMsgp;	///< First error, or NULL
+    int			m_errLinenum;	///< Line number of first error
+public:
+    // CONSTRUCTORS
+    VlReadMem(bool hex, int width, int depth, int array_lsb,
+	      void* memp, VerilatedSparseMem* sparsep, IData start, int linenum)
+	: m_hex(hex), m_width(width), m_depth(depth), m_array_lsb(array_lsb)
+	, m_memp(memp), m_sparsep(sparsep)
+	, m_addr(start), m_linenum(linenum), m_innum(false), m_ignore_to_eol(false)
+	, m_ignore_to_cmt(false), m_needinc(false), m_reading_addr(false), m_lastc(' ')
+	, m_value(0), m_entries(0), m_errMsgp(NULL), m_errLinenum(0) {
+	m_entryBytes = (width<=8 ? sizeof(CData) : width<=16 ? sizeof(SData)
+			: width<=VL_WORDSIZE ? sizeof(IData) : width<=VL_QUADSIZE ? sizeof(QData)
+			: VL_WORDS_I(width)*sizeof(WData));
+    }
+    // ACCESSORS
+    IData addr() const { return m_addr; }
+    int linenum() const { return m_linenum; }
+    IData entries() const { return m_entries; }
+    const char* errMsgp() const { return m_errMsgp; }
+    int errLinenum() const { return m_errLinenum; }
+private:
+    static inline int digitValue(int c) {
+	// Value of hex digit, 16 for x/X, else -1
+	if (c >= '0' && c <= '9') return c - '0';
+	c |= 0x20;  // Lower case
+	if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+	if (c == 'x') return 16;
+	return -1;
+    }
+    void error(const char* msgp) {
+	if (!m_errMsgp) { m_errMsgp = msgp; m_errLinenum = m_linenum; }
+    }
+    void store() {
+	// Write completed number to the array
+	if (VL_UNLIKELY(m_errMsgp)) return;
+	++m_entries;
+	if (!m_memp && !m_sparsep) return;  // Counting only
+	int entry = m_addr - m_array_lsb;
+	void* entryp = (m_sparsep ? m_sparsep->entryp(entry)
+			: (void*)((char*)(m_memp) + entry * m_entryBytes));
+	if (m_width<=8) {
+	    *((CData*)(entryp)) = (CData)(m_value);
+	} else if (m_width<=16) {
+	    *((SData*)(entryp)) = (SData)(m_value);
+	} else if (m_width<=VL_WORDSIZE) {
+	    *((IData*)(entryp)) = (IData)(m_value);
+	} else if (m_width<=VL_QUADSIZE) {
+	    *((QData*)(entryp)) = m_value;
+	} else {
+	    WDataOutP datap = (WDataOutP)(entryp);
+	    VL_ZERO_RESET_W(m_width, datap);
+	    int shift = m_hex ? 4 : 1;
+	    int bit = 0;
+	    // Digits never straddle a word as 4 and 1 divide VL_WORDSIZE
+	    for (size_t i=m_digits.size(); i-- && bit < m_width; bit += shift) {
+		datap[VL_BITWORD_I(bit)] |= ((IData)(m_digits[i]) << VL_BITBIT_I(bit));
+	    }
+	    datap[VL_WORDS_I(m_width)-1] &= VL_MASK_I(m_width);
+	}
+    }
+    void endNum() {
+	if (m_innum) {
+	    if (!m_reading_addr) store();
+	    m_reading_addr = false;
+	}
+	m_innum = false;
+    }
+    inline void digit(int value) {
+	if (!m_innum) {  // Prep for next number
+	    if (m_needinc) { m_addr++; m_needinc=false; }
+	}
+	if (m_reading_addr) {
+	    // Decode @ addresses
+	    if (!m_innum) m_addr=0;
+	    m_addr = (m_addr<<4) + value;
+	} else {
+	    m_needinc = true;
+	    if (!m_innum) {
+		if (VL_UNLIKELY(m_addr >= (IData)(m_depth+m_array_lsb) || m_addr < (IData)(m_array_lsb))
+		    && (m_memp || m_sparsep)) {
+		    error("$readmem file address beyond bounds of array");
+		}
+		m_value = 0;
+		m_digits.clear();
+	    }
+	    if (m_hex) {
+		if (m_width<=VL_QUADSIZE) m_value = ((m_value << VL_ULL(4)) + (QData)(value)) & VL_MASK_Q(m_width);
+		else m_digits.push_back((vluint8_t)value);
+	    } else {
+		if (VL_UNLIKELY(value>=2)) {
+		    error("$readmemb (binary) file contains hex characters");
+		}
+		if (m_width<=VL_QUADSIZE) m_value = ((m_value << VL_ULL(1)) + (QData)(value)) & VL_MASK_Q(m_width);
+		else m_digits.push_back((vluint8_t)value);
+	    }
+	}
+	m_innum = true;
+    }
+public:
+    // METHODS
+    void parse(const char* cp, const char* endp) {
+	// Parse characters, stopping at the first error
+	while (cp < endp && VL_LIKELY(!m_errMsgp)) {
+	    int c = (unsigned char)(*cp++);
+	    if (c=='\n') { m_linenum++; m_ignore_to_eol=false; endNum(); }
+	    else if (c=='\t' || c==' ' || c=='\r' || c=='\f') { endNum(); }
+	    // Skip // comments and detect /* comments
+	    else if (m_ignore_to_cmt && m_lastc=='*' && c=='/') {
+		m_ignore_to_cmt = false; endNum();
+	    } else if (!m_ignore_to_eol && !m_ignore_to_cmt) {
+		int value;
+		if (m_lastc=='/' && c=='*') { m_ignore_to_cmt = true; }
+		else if (m_lastc=='/' && c=='/') { m_ignore_to_eol = true; }
+		else if (c=='/') {}  // Part of /* or //
+		else if (c=='_') {}
+		else if (c=='@') { endNum(); m_reading_addr = true; m_needinc=false; }
+		// Check for hex or binary digits as file format requests
+		else if ((value = digitValue(c)) >= 0 && !(m_reading_addr && value == 16)) {
+		    if (value == 16) value = VL_RAND_RESET_I(4);
+		    digit(value);
+		    // Fast path for the rest of a data number; bits shifted
+		    // out the top are dropped, so masking once at the end suffices
+		    if (!m_reading_addr && m_width<=VL_QUADSIZE) {
+			int shift = m_hex ? 4 : 1;
+			QData accum = m_value;
+			while (cp < endp && ((value = digitValue((unsigned char)(*cp))) >= 0 || *cp=='_')) {
+			    c = (unsigned char)(*cp++);
+			    if (value < 0) continue;  // '_'
+			    if (value == 16) value = VL_RAND_RESET_I(4);
+			    if (VL_UNLIKELY(value >= (1<<shift))) {
+				error("$readmemb (binary) file contains hex characters");
+				break;
+			    }
+			    accum = (accum << shift) + (QData)(value);
+			}
+			m_value = accum & VL_MASK_Q(m_width);
+		    } else if (!m_reading_addr) {
+			while (cp < endp && ((value = digitValue((unsigned char)(*cp))) >= 0 || *cp=='_')) {
+			    c = (unsigned char)(*cp++);
+			    if (value < 0) continue;  // '_'
+			    if (value == 16) value = VL_RAND_RESET_I(4);
+			    digit(value);
+			}
+		    }
+		}
+		else {
+		    error("$readmem file syntax error");
+		}
+	    }
+	    m_lastc = c;
+	}
+    }
+    void finish() {
+	// End of file
+	endNum();
+	if (m_needinc) { m_addr++; m_needinc=false; }
+    }
+};
+
+#ifdef VL_THREADED
+static bool _vl_readmem_threaded(VlReadMem& parser, const VlReadMemFile& file,
+				 bool hex, int width, int depth, int array_lsb,
+				 void* memp, IData start) {
+    // Load a large plain run of values on multiple threads; return false if not suitable
+    const char* datap = file.datap();
+    size_t size = file.size();
+    unsigned threads = std::thread::hardware_concurrency();
+    if (threads > VL_READMEM_THREADS_MAX) threads = VL_READMEM_THREADS_MAX;
+    if (size < VL_READMEM_THREAD_MIN_BYTES || threads < 2) return false;
+    // Addresses of a piece depend on everything before it, which is only
+    // known without parsing if there are no @addresses, and pieces only
+    // start in a known state if no comment spans lines
+    if (memchr(datap, '@', size)) return false;
+    for (const char* cp = datap; (cp = (const char*)memchr(cp, '/', datap + size - cp)); ++cp) {
+	if (cp + 1 < datap + size && cp[1] == '*') return false;
+    }
+    // Split after newlines
+    vector<const char*> bounds;
+    bounds.push_back(datap);
+    for (unsigned i=1; i<threads; ++i) {
+	const char* cp = datap + (size / threads) * i;
+	if (cp < bounds.back()) continue;
+	const char* nlp = (const char*)memchr(cp, '\n', datap + size - cp);
+	if (!nlp) break;
+	bounds.push_back(nlp + 1);
+    }
+    bounds.push_back(datap + size);
+    size_t pieces = bounds.size() - 1;
+    VerilatedContext* contextp = Verilated::threadContextp();
+    // Pass 1: count values and lines in each piece
+    vector<VlReadMem> counts (pieces, VlReadMem(hex, width, depth, array_lsb, NULL, NULL, 0, 0));
+    {
+	vector<std::thread> workers;
+	for (size_t i=0; i<pieces; ++i) {
+	    workers.push_back(std::thread([&, i] {
+			Verilated::threadContextp(contextp);
+			counts[i].parse(bounds[i], bounds[i+1]);
+			counts[i].finish();
+		    }));
+	}
+	for (size_t i=0; i<pieces; ++i) workers[i].join();
+    }
+    // Pass 2: store each piece from its starting address
+    vector<VlReadMem> loads;
+    IData addr = start;
+    int linenum = 1;
+    for (size_t i=0; i<pieces; ++i) {
+	loads.push_back(VlReadMem(hex, width, depth, array_lsb, memp, NULL, addr, linenum));
+	addr += counts[i].entries();
+	linenum += counts[i].linenum();
+    }
+    {
+	vector<std::thread> workers;
+	for (size_t i=0; i<pieces; ++i) {
+	    workers.push_back(std::thread([&, i] {
+			Verilated::threadContextp(contextp);
+			loads[i].parse(bounds[i], bounds[i+1]);
+			loads[i].finish();
+		    }));
+	}
+	for (size_t i=0; i<pieces; ++i) workers[i].join();
+    }
+    // Result is as if one parser saw it all, reporting the first error
+    for (size_t i=0; i<pieces; ++i) {
+	if (loads[i].errMsgp()) { parser = loads[i]; return true; }
+    }
+    parser = loads.back();
+    return true;
+}
+#endif
+
+static void _vl_readmem(bool hex, int width, int depth, int array_lsb,
+			const string& ofilenamep, void* memp, VerilatedSparseMem* sparsep,
+			IData start, IData end) {
+    // Exactly one of memp (dense C array) or sparsep (VlSparseArray) is non-NULL
+    VlReadMemFile file;
+    if (VL_UNLIKELY(!file.open(ofilenamep.c_str()))) {
         // We don't report the Verilog source filename as it slow to have to pass it down
         vl_fatal (ofilenamep.c_str(), 0, "", "$readmem file not found");
         return;
     }
-    // Prep for reading
-    IData addr = start;
-    int linenum = 1;
-    bool innum = false;
-    bool ignore_to_eol = false;
-    bool ignore_to_cmt = false;
-    bool needinc = false;
-    bool reading_addr = false;
-    int lastc = ' ';
-    // Read the data
-    // We process a character at a time, as then we don't need to deal
-    // with changing buffer sizes dynamically, etc.
-    while (1) {
-        int c = fgetc(fp);
-        if (VL_UNLIKELY(c==EOF)) break;
-        //printf("%d: Got '%c' Addr%x IN%d IgE%d IgC%d ninc%d\n", linenum, c, addr, innum, ignore_to_eol, ignore_to_cmt, needinc);
-        if (c=='\n') { linenum++; ignore_to_eol=false; if (innum) reading_addr=false; innum=false; }
-        else if (c=='\t' || c==' ' || c=='\r' || c=='\f') { if (innum) reading_addr=false; innum=false; }
-        // Skip // comments and detect /* comments
-        else if (ignore_to_cmt && lastc=='*' && c=='/') {
-            ignore_to_cmt = false; if (innum) reading_addr=false; innum=false;
-        } else if (!ignore_to_eol && !ignore_to_cmt) {
-            if (lastc=='/' && c=='*') { ignore_to_cmt = true; }
-            else if (lastc=='/' && c=='/') { ignore_to_eol = true; }
-            else if (c=='/') {}  // Part of /* or //
-            else if (c=='_') {}
-            else if (c=='@') { reading_addr = true; innum=false; needinc=false; }
-            // Check for hex or binary digits as file format requests
-            else if (isxdigit(c) || (!reading_addr && (c=='x' || c=='X'))) {
-                c = tolower(c);
-                int value = (c >= 'a' ? (c=='x' ? VL_RAND_RESET_I(4) : (c-'a'+10)) : (c-'0'));
-                if (!innum) {  // Prep for next number
-                    if (needinc) { addr++; needinc=false; }
-                }
-                if (reading_addr) {
-                    // Decode @ addresses
-                    if (!innum) addr=0;
-                    addr = (addr<<4) + value;
-                } else {
-                    needinc = true;
-                    //printf(" Value width=%d  @%x = %c\n", width, addr, c);
-                    if (VL_UNLIKELY(addr >= (IData)(depth+array_lsb) || addr < (IData)(array_lsb))) {
-                        vl_fatal (ofilenamep.c_str(), linenum, "", "$readmem file address beyond bounds of array");
-                    } else {
-                        int entry = addr - array_lsb;
-                        QData shift = hex ? VL_ULL(4) : VL_ULL(1);
-                        // Shift value in
-                        if (width<=8) {
-                            CData* datap = &((CData*)(memp))[entry];
-                            if (!innum) { *datap = 0; }
-                            *datap = ((*datap << shift) + value) & VL_MASK_I(width);
-                        } else if (width<=16) {
-                            SData* datap = &((SData*)(memp))[entry];
-                            if (!innum) { *datap = 0; }
-                            *datap = ((*datap << shift) + value) & VL_MASK_I(width);
-                        } else if (width<=VL_WORDSIZE) {
-                            IData* datap = &((IData*)(memp))[entry];
-                            if (!innum) { *datap = 0; }
-                            *datap = ((*datap << shift) + value) & VL_MASK_I(width);
-                        } else if (width<=VL_QUADSIZE) {
-                            QData* datap = &((QData*)(memp))[entry];
-                            if (!innum) { *datap = 0; }
-                            *datap = ((*datap << (QData)(shift)) + (QData)(value)) & VL_MASK_Q(width);
-                        } else {
-                            WDataOutP datap = &((WDataOutP)(memp))[ entry*VL_WORDS_I(width) ];
-                            if (!innum) { VL_ZERO_RESET_W(width, datap); }
-                            _VL_SHIFTL_INPLACE_W(width, datap, (IData)shift);
-                            datap[0] |= value;
-                        }
-                        if (VL_UNLIKELY(value>=(1<<shift))) {
-                            vl_fatal (ofilenamep.c_str(), linenum, "", "$readmemb (binary) file contains hex characters");
-                        }
-                    }
-                }
-                innum = true;
-            }
-            else {
-                vl_fatal (ofilenamep.c_str(), linenum, "", "$readmem file syntax error");
-            }
-        }
-        lastc = c;
-    }
-    if (needinc) { addr++; }
+    VlReadMem parser (hex, width, depth, array_lsb, memp, sparsep, start, 1);
+#ifdef VL_THREADED
+    // Sparse pages are allocated on access, which isn't thread safe
+    if (sparsep || !_vl_readmem_threaded(parser, file, hex, width, depth, array_lsb, memp, start))
+#endif
+    {
+	parser.parse(file.datap(), file.datap() + file.size());
+	parser.finish();
+    }
+    if (VL_UNLIKELY(parser.errMsgp())) {
+	vl_fatal (ofilenamep.c_str(), parser.errLinenum(), "", parser.errMsgp());
+	return;
+    }
 
     // Final checks
-    fclose(fp);
-    if (VL_UNLIKELY(end != VL_UL(0xffffffff) && addr != (end+1))) {
-        vl_fatal (ofilenamep.c_str(), linenum, "", "$readmem file ended before specified ending-address");
+    if (VL_UNLIKELY(end != VL_UL(0xffffffff) && parser.addr() != (end+1))) {
+        vl_fatal (ofilenamep.c_str(), parser.linenum(), "", "$readmem file ended before specified ending-address");
     }
 }
 
+void VL_READMEM_N(bool hex, int width, int depth, int array_lsb, int fnwords,
+		  const string& ofilenamep, void* memp, IData start, IData end) {
+    if (fnwords) {}
+    _vl_readmem(hex, width, depth, array_lsb, ofilenamep, memp, NULL, start, end);
+}
+
+void VL_READMEM_N(bool hex, int width, int depth, int array_lsb, int fnwords,
+		  const string& ofilenamep, VerilatedSparseMem* memp, IData start, IData end) {
+    if (fnwords) {}
+    _vl_readmem(hex, width, depth, array_lsb, ofilenamep, NULL, memp, start, end);
+}
+
 IData VL_SYSTEM_IQ(QData lhs) {
     WData lhsw[2];  VL_SET_WQ(lhsw, lhs);
     return VL_SYSTEM_IW(2, lhsw);
@@ -1150,7 +2124,7 @@ IData VL_SYSTEM_IW(int lhswords, WDataInP filenamep) {
 }
 
 IData VL_TESTPLUSARGS_I(const char* formatp) {
-    const string& match = VerilatedImp::argPlusMatch(formatp);
+    const string match = VerilatedImp::argPlusMatch(formatp);
     if (match == "") return 0;
     else return 1;
 }
@@ -1179,7 +2153,7 @@ IData VL_VALUEPLUSARGS_INW(int rbits, const string& ld, WDataOutP rwp) {
 	}
     }
 
-    const string& match = VerilatedImp::argPlusMatch(prefix.c_str());
+    const string match = VerilatedImp::argPlusMatch(prefix.c_str());
     const char* dp = match.c_str() + 1 /*leading + */ + prefix.length();
     if (match == "") return 0;
 
@@ -1235,7 +2209,7 @@ IData VL_VALUEPLUSARGS_INN(int, const string& ld, string& rdr) {
 	    }
 	}
     }
-    const string& match = VerilatedImp::argPlusMatch(prefix.c_str());
+    const string match = VerilatedImp::argPlusMatch(prefix.c_str());
     const char* dp = match.c_str() + 1 /*leading + */ + prefix.length();
     if (match == "") return 0;
     rdr = string(dp);
@@ -1243,7 +2217,7 @@ IData VL_VALUEPLUSARGS_INN(int, const string& ld, string& rdr) {
 }
 
 const char* vl_mc_scan_plusargs(const char* prefixp) {
-    const string& match = VerilatedImp::argPlusMatch(prefixp);
+    const string match = VerilatedImp::argPlusMatch(prefixp);
     static VL_THREAD char outstr[VL_VALUE_STRING_MAX_WIDTH];
     if (match == "") return NULL;
     strncpy(outstr, match.c_str()+strlen(prefixp)+1, // +1 to skip the "+"
@@ -1295,23 +2269,91 @@ const char* Verilated::catName(const char* n1, const char* n2) {
     return strp;
 }
 
+static vector<VerilatedVoidCb> s_flushCbs;	///< Flush callbacks, when more than one
+
+static VerilatedMutex s_callbackMutex;	///< Protects s_flushCbs and s_forkCbs, as traces open on any thread
+
+static void flushCbsCall() {
+    // Call a copy, so callbacks may register more without holding the lock
+    s_callbackMutex.lock();
+    vector<VerilatedVoidCb> cbs = s_flushCbs;
+    s_callbackMutex.unlock();
+    for (vector<VerilatedVoidCb>::iterator it = cbs.begin(); it != cbs.end(); ++it) {
+	(**it)();
+    }
+}
+
 void Verilated::flushCb(VerilatedVoidCb cb) {
+    s_callbackMutex.lock();
     if (s_flushCb == cb) {}  // Ok - don't duplicate
     else if (!s_flushCb) { s_flushCb=cb; }
     else {
-	// Someday we may allow multiple callbacks ala atexit(), but until then
-	vl_fatal("unknown",0,"", "Verilated::flushCb called twice with different callbacks");
+	// Multiple callbacks ala atexit(); s_flushCb becomes a caller of each
+	if (s_flushCb != &flushCbsCall) {
+	    s_flushCbs.push_back(s_flushCb);
+	    s_flushCb = &flushCbsCall;
+	}
+	if (find(s_flushCbs.begin(), s_flushCbs.end(), cb) == s_flushCbs.end()) {
+	    s_flushCbs.push_back(cb);
+	}
+    }
+    s_callbackMutex.unlock();
+}
+
+//===========================================================================
+// Forking -- children continue from the parent's state, with their own
+// outputs.  Buffers are flushed first, else both processes write them.
+
+static int s_forkIndex = -1;			///< Verilated::forkChild index, in a child
+static vector<VerilatedVoidCb> s_forkCbs;	///< Called in each child
+
+int Verilated::forkChild(int index) {
+#if defined(_WIN32) && !defined(__CYGWIN__)
+    vl_fatal(__FILE__,__LINE__,"","Verilated::forkChild() requires fork()");
+    return -1;
+#else
+    flushCall();
+    fflush(NULL);
+    pid_t pid = ::fork();
+    if (pid == 0) {
+	s_forkIndex = index;
+	for (vector<VerilatedVoidCb>::iterator it = s_forkCbs.begin(); it != s_forkCbs.end(); ++it) {
+	    (**it)();
+	}
     }
+    return pid;
+#endif
+}
+
+int Verilated::forkIndex() {
+    return s_forkIndex;
+}
+
+const char* Verilated::forkFilename(const char* filenamep) {
+    if (s_forkIndex < 0) return filenamep;
+    string filename = filenamep;
+    string::size_type slash = filename.rfind('/');
+    string::size_type pos = filename.rfind('.');
+    if (pos == string::npos || (slash != string::npos && pos < slash)) pos = filename.length();
+    char suffix[32];
+    sprintf(suffix, "_fork%d", s_forkIndex);
+    filename.insert(pos, suffix);
+    static VL_THREAD char outstr[VL_VALUE_STRING_MAX_WIDTH];
+    strncpy(outstr, filename.c_str(), VL_VALUE_STRING_MAX_WIDTH);
+    outstr[VL_VALUE_STRING_MAX_WIDTH-1] = '\0';
+    return outstr;
 }
 
-void Verilated::commandArgs(int argc, const char** argv) {
-    s_args.argc = argc;
-    s_args.argv = argv;
-    VerilatedImp::commandArgs(argc,argv);
+void Verilated::forkCb(VerilatedVoidCb cb) {
+    s_callbackMutex.lock();
+    if (find(s_forkCbs.begin(), s_forkCbs.end(), cb) == s_forkCbs.end()) {
+	s_forkCbs.push_back(cb);
+    }
+    s_callbackMutex.unlock();
 }
 
 const char* Verilated::commandArgsPlusMatch(const char* prefixp) {
-    const string& match = VerilatedImp::argPlusMatch(prefixp);
+    const string match = VerilatedImp::argPlusMatch(prefixp);
     static VL_THREAD char outstr[VL_VALUE_STRING_MAX_WIDTH];
     if (match == "") return "";
     strncpy(outstr, match.c_str(), VL_VALUE_STRING_MAX_WIDTH);
@@ -1350,6 +2392,53 @@ VerilatedModule::~VerilatedModule() {
     if (m_namep) { free((void*)m_namep); m_namep=NULL; }
 }
 
+//======================================================================
+// VerilatedMemoryReport:: Methods
+
+static const char* const vl_memkind_names[VL_MEMKIND__COUNT] = {
+    "signals", "arrays", "sparse arrays", "shadow copies", "trace old values" };
+
+VerilatedMemoryReport::VerilatedMemoryReport()
+    : m_totalBytes(0), m_instances(0) {
+    for (int i=0; i<VL_MEMKIND__COUNT; ++i) m_kindBytes[i] = 0;
+}
+
+void VerilatedMemoryReport::instance(const char* namep, size_t classBytes, const VerilatedMemoryVar* varsp) {
+    double kindBytes[VL_MEMKIND__COUNT];
+    for (int i=0; i<VL_MEMKIND__COUNT; ++i) kindBytes[i] = 0;
+    for (const VerilatedMemoryVar* vp = varsp; vp->m_namep; ++vp) kindBytes[vp->m_kind] += vp->m_bytes;
+    VL_PRINTF("- Memory: %-40s %12.0f bytes  (arrays %.0f, shadows %.0f)\n", namep,
+	      (double)classBytes, kindBytes[VL_MEMKIND_ARRAY] + kindBytes[VL_MEMKIND_SPARSE],
+	      kindBytes[VL_MEMKIND_SHADOW]);
+    for (const VerilatedMemoryVar* vp = varsp; vp->m_namep; ++vp) {
+	if (vp->m_kind == VL_MEMKIND_ARRAY) {
+	    VL_PRINTF("- Memory:   array %-34s %12.0f bytes\n", vp->m_namep, (double)vp->m_bytes);
+	}
+    }
+    for (int i=0; i<VL_MEMKIND__COUNT; ++i) m_kindBytes[i] += kindBytes[i];
+    m_totalBytes += classBytes;
+    ++m_instances;
+}
+
+void VerilatedMemoryReport::sparse(const char* namep, size_t bytes) {
+    VL_PRINTF("- Memory:   sparse %-33s %12.0f bytes allocated\n", namep, (double)bytes);
+    m_kindBytes[VL_MEMKIND_SPARSE] += bytes;
+    m_totalBytes += bytes;
+}
+
+void VerilatedMemoryReport::trace(size_t bytes) {
+    m_kindBytes[VL_MEMKIND_TRACE] += bytes;
+    m_totalBytes += bytes;
+}
+
+void VerilatedMemoryReport::totals() {
+    VL_PRINTF("- Memory: %-40s %12.0f bytes  (%d instances)\n", "TOTAL",
+	      m_totalBytes, (int)m_instances);
+    for (int i=0; i<VL_MEMKIND__COUNT; ++i) {
+	if (m_kindBytes[i]) VL_PRINTF("- Memory:   %-38s %12.0f bytes\n", vl_memkind_names[i], m_kindBytes[i]);
+    }
+}
+
 //======================================================================
 // VerilatedVar:: Methods
 
@@ -1377,6 +2466,8 @@ VerilatedScope::VerilatedScope() {
     m_funcnumMax = 0;
     m_symsp = NULL;
     m_varsp = NULL;
+    m_varsCb = NULL;
+    m_contextp = NULL;
 }
 
 VerilatedScope::~VerilatedScope() {
@@ -1396,6 +2487,7 @@ void VerilatedScope::configure(VerilatedSyms* symsp, const char* prefixp, const
     if (*prefixp && *suffixp) strcat(namep,".");
     strcat(namep, suffixp);
     m_namep = namep;
+    m_contextp = Verilated::threadContextp();
     VerilatedImp::scopeInsert(this);
 }
 
@@ -1447,17 +2539,39 @@ void VerilatedScope::varInsert(int finalize, const char* namep, void* datap,
     }
     va_end(ap);
 
-    m_varsp->insert(make_pair(namep,var));
+    m_varsp->insertIndexed(namep, var);
+}
+
+void VerilatedScope::varChgInsert(int finalize, const char* namep, CData* chgp) {
+    // Called after varInsert, for variables whose writes are marked for VPI
+    if (!finalize) return;
+    if (VerilatedVar* varp = varFind(namep)) varp->m_chgp = chgp;
+}
+
+void VerilatedScope::varsInsert(const VerilatedVarDesc* descsp, int num) {
+    // Slowpath - called once/scope on first lookup, with the table emitted for the scope
+    if (!m_varsp) m_varsp = new VerilatedVarNameMap();
+    for (const VerilatedVarDesc* descp = descsp; descp < descsp+num; ++descp) {
+	VerilatedVar var (descp->m_namep, descp->m_datap, descp->m_vltype,
+			  (VerilatedVarFlags)descp->m_vlflags, descp->m_dims);
+	if (descp->m_dims >= 1) var.m_range.sets(descp->m_bounds[0], descp->m_bounds[1]);
+	if (descp->m_dims >= 2) var.m_array.sets(descp->m_bounds[2], descp->m_bounds[3]);
+	var.m_chgp = descp->m_chgp;
+	m_varsp->insertIndexed(descp->m_namep, var);
+    }
+}
+
+void VerilatedScope::varsBuild() const {
+    // Slowpath - the Syms constructor only registers the callback, so startup
+    // doesn't scale with the number of public variables
+    VerilatedVarsCb cb = m_varsCb;
+    m_varsCb = NULL;
+    cb(const_cast<VerilatedScope*>(this));
 }
 
 // cppcheck-suppress unusedFunction  // Used by applications
 VerilatedVar* VerilatedScope::varFind(const char* namep) const {
-    if (VL_LIKELY(m_varsp)) {
-	VerilatedVarNameMap::iterator it = m_varsp->find(namep);
-	if (VL_LIKELY(it != m_varsp->end())) {	
-	    return &(it->second);
-	}
-    }
+    if (VerilatedVarNameMap* varsp = this->varsp()) return varsp->findp(namep);
     return NULL;
 }
 
@@ -1480,6 +2594,11 @@ void* VerilatedScope::exportFindError(int funcnum) const {
     return NULL;
 }
 
+VerilatedDpiExport::VerilatedDpiExport(const VerilatedScope* scopep, const char* namep) {
+    m_scopep = scopep;
+    m_cbp = VerilatedScope::exportFind(scopep, Verilated::exportFuncNum(namep));
+}
+
 void VerilatedScope::scopeDump() const {
     VL_PRINTF("    SCOPE %p: %s\n", this, name());
     for (int i=0; i<m_funcnumMax; ++i) {
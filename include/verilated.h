@@ -49,6 +49,26 @@ using namespace std;
 # define WAVES 1	// Set backward compatibility flag
 #endif
 
+// Vector instructions for wide (WData) operators; define VL_NO_SIMD to disable
+#ifndef VL_NO_SIMD
+# if defined(__AVX2__)
+#  define VL_SIMD_AVX2 1	///< Wide operators use AVX2, 256 bits at a time
+#  include <immintrin.h>
+# elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define VL_SIMD_SSE2 1	///< Wide operators use SSE2, 128 bits at a time
+#  include <emmintrin.h>
+# elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#  define VL_SIMD_NEON 1	///< Wide operators use NEON, 128 bits at a time
+#  include <arm_neon.h>
+# endif
+#endif
+
+// Bit manipulation instructions (e.g. -mbmi2); define VL_NO_BUILTINS to disable
+#if defined(__GNUC__) && defined(__BMI2__) && !defined(VL_NO_BUILTINS)
+# define VL_HAVE_BMI2 1		///< Bit gathers use PEXT
+# include <immintrin.h>
+#endif
+
 //=========================================================================
 // Basic types
 
@@ -62,18 +82,30 @@ typedef vluint32_t   WData;	///< Verilated pack data, >64 bits, as an array
 //	double	     D		// No typedef needed; Verilator uses double
 //	string	     N		// No typedef needed; Verilator uses string
 
+#ifdef VL_RESTRICT_WIDE
+// Generated with --restrict-wide, so an output array never overlaps an input
+typedef const WData* __restrict WDataInP;	///< Array input to a function
+typedef       WData* __restrict WDataOutP;	///< Array output from a function
+#else
 typedef const WData* WDataInP;	///< Array input to a function
 typedef       WData* WDataOutP;	///< Array output from a function
+#endif
 
 typedef void (*VerilatedVoidCb)(void);
+typedef void (*VerilatedWatchCb)(const char* namep, void* userp);
+typedef void* VlThrSymTab;	///< Symbol table passed to macro-task functions (--threads)
 
 class SpTraceVcd;
 class SpTraceVcdCFile;
+class VerilatedContext;
+class VerilatedScope;
 class VerilatedScopeNameMap;
 class VerilatedVar;
 class VerilatedVarNameMap;
 class VerilatedVcd;
 class VerilatedVcdC;
+class VerilatedBin;
+class VerilatedBinC;
 
 enum VerilatedVarType {
     VLVT_UNKNOWN=0,
@@ -111,6 +143,46 @@ public:
     const char* name() const { return m_namep; }	///< Return name of module
 };
 
+//=========================================================================
+/// Memory footprint of Verilated module classes
+/// Each module class has a generated __Vmemory table of its members'
+/// sizes; the model's memoryReport() gives it to VerilatedMemoryReport
+/// for every instance.
+
+enum VerilatedMemoryKind {
+    VL_MEMKIND_SIGNAL,	///< Signal or variable
+    VL_MEMKIND_ARRAY,	///< Unpacked array
+    VL_MEMKIND_SPARSE,	///< Sparse array; its pages are added per instance
+    VL_MEMKIND_SHADOW,	///< Copy for delayed assignment or change detection
+    VL_MEMKIND_TRACE,	///< Old values kept by the trace file
+    VL_MEMKIND__COUNT
+};
+
+struct VerilatedMemoryVar {
+    const char*	m_namep;	///< Member name, NULL at end of table
+    size_t	m_bytes;	///< Size of member
+    int		m_kind;		///< VerilatedMemoryKind
+};
+
+class VerilatedMemoryReport {
+    // MEMBERS
+    double	m_kindBytes[VL_MEMKIND__COUNT];	///< Bytes by kind, all instances
+    double	m_totalBytes;	///< Bytes of all instances, and trace
+    size_t	m_instances;	///< Number of instances
+public:
+    // CREATORS
+    VerilatedMemoryReport();
+    // METHODS
+    /// Print one instance, with its class size and arrays, and add to the totals
+    void instance(const char* namep, size_t classBytes, const VerilatedMemoryVar* varsp);
+    /// Print and add the pages allocated by a sparse array of the last instance
+    void sparse(const char* namep, size_t bytes);
+    /// Add the old values the trace file keeps, if tracing
+    void trace(size_t bytes);
+    /// Print the totals
+    void totals();
+};
+
 //=========================================================================
 // Declare nets
 
@@ -177,6 +249,22 @@ class VerilatedSyms {
     // VerilatedSyms base class exists just so symbol tables have a common pointer type
 };
 
+//===========================================================================
+/// Descriptor of a public variable, as emitted in each scope's table
+
+struct VerilatedVarDesc {
+    const char*		m_namep;	///< Name, under scope
+    void*		m_datap;	///< Location of data
+    CData*		m_chgp;		///< Set when written, see VL_VPI_CHG; NULL if not marked
+    VerilatedVarType	m_vltype;	///< Data type
+    int			m_vlflags;	///< Direction and public flags
+    int			m_dims;		///< Dimensions
+    int			m_bounds[4];	///< Msb and lsb of range, then of array
+};
+
+/// Called on first lookup of a scope's variables, to insert them
+typedef void (*VerilatedVarsCb)(VerilatedScope* scopep);
+
 //===========================================================================
 /// Verilator global static information class
 
@@ -186,8 +274,11 @@ class VerilatedScope {
     void**		m_callbacksp;	///< Callback table pointer (Fastpath)
     int			m_funcnumMax;	///< Maxium function number stored (Fastpath)
     // 4 bytes padding (on -m64), for rent.
-    VerilatedVarNameMap* m_varsp;	///< Variable map
+    mutable VerilatedVarNameMap* m_varsp;	///< Variable map
+    mutable VerilatedVarsCb m_varsCb;	///< Inserts variables on first lookup (Slowpath)
     const char* 	m_namep;	///< Scope name (Slowpath)
+    VerilatedContext*	m_contextp;	///< Context registered with (Slowpath)
+    void varsBuild() const;
 
 public:  // But internals only - called from VerilatedModule's
     VerilatedScope();
@@ -196,11 +287,18 @@ public:  // But internals only - called from VerilatedModule's
     void exportInsert(int finalize, const char* namep, void* cb);
     void varInsert(int finalize, const char* namep, void* datap,
 		   VerilatedVarType vltype, int vlflags, int dims, ...);
+    void varChgInsert(int finalize, const char* namep, CData* chgp);
+    void varsLazy(VerilatedVarsCb cb) { m_varsCb = cb; }
+    void varsInsert(const VerilatedVarDesc* descsp, int num);
     // ACCESSORS
     const char* name() const { return m_namep; }
+    VerilatedContext* contextp() const { return m_contextp; }
     inline VerilatedSyms* symsp() const { return m_symsp; }
     VerilatedVar* varFind(const char* namep) const;
-    VerilatedVarNameMap* varsp() const { return m_varsp; }
+    VerilatedVarNameMap* varsp() const {
+	if (VL_UNLIKELY(m_varsCb)) varsBuild();
+	return m_varsp;
+    }
     void scopeDump() const;
     void* exportFindError(int funcnum) const;
     static void* exportFindNullError(int funcnum);
@@ -216,14 +314,37 @@ public:  // But internals only - called from VerilatedModule's
 };
 
 //===========================================================================
-/// Verilator global static information class
+/// DPI export function resolved once for a given scope, so the
+/// {prefix}::{export}__Vbound functions skip svSetScope and the lookup
 
-class Verilated {
-    // MEMBERS
-    // Slow path variables
-    static VerilatedVoidCb  s_flushCb;		///< Flush callback function
+class VerilatedDpiExport {
+    const VerilatedScope* m_scopep;	///< Scope to call the function in
+    void*		m_cbp;		///< Function's callback in that scope
+public:
+    /// Scope as from svGetScopeFromName; fatal if the export isn't in that scope
+    VerilatedDpiExport(const VerilatedScope* scopep, const char* namep);
+    // ACCESSORS
+    const VerilatedScope* scopep() const { return m_scopep; }
+    void* cbp() const { return m_cbp; }
+};
 
-    static struct Serialized {   // All these members serialized/deserialized
+//===========================================================================
+/// Verilator simulation context
+///
+/// Holds the state that would otherwise be shared by every model in the
+/// process: $finish, the run-time options below, command line arguments,
+/// random state, scopes and file descriptors.  Each thread evaluates
+/// models under its Verilated::threadContextp(), initially the default
+/// context, so independent models may run on separate threads each under
+/// their own context.  A thread must select the context before
+/// constructing the models it will evaluate, as models register their
+/// scopes with the constructing thread's context.
+
+class VerilatedContextImp;
+
+class VerilatedContext {
+public:
+    struct Serialized {   // All these members serialized/deserialized
 	// Slow path
 	int		s_randReset;		///< Random reset: 0=all 0s, 1=all 1s, 2=random
 	// Fast path
@@ -233,63 +354,165 @@ class Verilated {
 	bool		s_assertOn;		///< Assertions are enabled
         bool		s_fatalOnVpiError;	///< Stop on vpi error/unsupported
 	Serialized();
-    } s_s;
-
-    static VL_THREAD const VerilatedScope* t_dpiScopep;	///< DPI context scope
-    static VL_THREAD const char*	t_dpiFilename;	///< DPI context filename
-    static VL_THREAD int		t_dpiLineno;	///< DPI context line number
-
+    };
     // no need to be save-restored (serialized) the
     // assumption is that the restore is allowed to pass different arguments
-    static struct CommandArgValues {
+    struct CommandArgValues {
 	int          argc;
 	const char** argv;
-    } s_args;
+    };
+private:
+    // MEMBERS
+    Serialized		m_s;
+    CommandArgValues	m_args;
+    vluint64_t		m_time;		///< Simulation time, if the application keeps it here
+    vluint64_t		m_randState[4];	///< Random generator state (xoshiro256**)
+    VerilatedMutex	m_randMutex;	///< Guards m_randState, as --threads tasks share the context
+    VerilatedContextImp* m_impp;	///< Heavier state, created when needed
+
+    void commandArgsRuntime(int argc, const char** argv);
+
+    VerilatedContext(const VerilatedContext&);	///< N/A, no copy constructor
+    VerilatedContext& operator=(const VerilatedContext&);	///< N/A, no assignment
+public:
+    // CREATORS
+    VerilatedContext();
+    ~VerilatedContext();
+    // METHODS - User called; see the Verilated methods of the same names
+    void randReset(int val) { m_s.s_randReset=val; }
+    int  randReset() const { return m_s.s_randReset; }
+    void debug(int level) { m_s.s_debug = level; }
+    int  debug() const { return m_s.s_debug; }
+    void calcUnusedSigs(bool flag) { m_s.s_calcUnusedSigs=flag; }
+    bool calcUnusedSigs() const { return m_s.s_calcUnusedSigs; }
+    void gotFinish(bool flag) { m_s.s_gotFinish=flag; }
+    bool gotFinish() const { return m_s.s_gotFinish; }
+    void assertOn(bool flag) { m_s.s_assertOn=flag; }
+    bool assertOn() const { return m_s.s_assertOn; }
+    void fatalOnVpiError(bool flag) { m_s.s_fatalOnVpiError=flag; }
+    bool fatalOnVpiError() const { return m_s.s_fatalOnVpiError; }
+    void commandArgs(int argc, const char** argv);
+    void commandArgsAdd(int argc, const char** argv);
+    CommandArgValues* getCommandArgs() { return &m_args; }
+    /// Simulation time.  Verilated code reads the time from sc_time_stamp(),
+    /// so with several contexts, that may return Verilated::threadContextp()->time().
+    /// With --time-context, Verilated code reads this directly instead.
+    vluint64_t time() const { return m_time; }
+    void time(vluint64_t value) { m_time = value; }
+    void timeInc(vluint64_t add) { m_time += add; }
+    /// Seed the random generator used for random resets and $random.
+    /// Also set by +verilator+seed+<value> in commandArgs.
+    void randSeed(vluint64_t seed);
+    // METHODS - Internal
+    IData rand32() { return (IData)(rand64() >> VL_ULL(32)); }
+    QData rand64();
+    void randFill(WDataOutP outwp, int words);	///< Fill words with random values
+    VerilatedContextImp* impp();
+    size_t serializedSize() const { return sizeof(m_s); }
+    void* serializedPtr() { return &m_s; }
+};
+
+//===========================================================================
+/// Verilator global static information class
+
+class Verilated {
+    // MEMBERS
+    // Slow path variables
+    static VerilatedVoidCb  s_flushCb;		///< Flush callback function
+    static VerilatedWatchCb s_watchCb;		///< Watch point callback function
+    static void*	    s_watchUserp;	///< Watch point callback user data
+
+    static VerilatedContext	s_defaultContext;	///< Context of threads that don't select one
+    static VL_THREAD VerilatedContext* t_contextp;	///< Calling thread's context
+
+    static VL_THREAD const VerilatedScope* t_dpiScopep;	///< DPI context scope
+    static VL_THREAD const char*	t_dpiFilename;	///< DPI context filename
+    static VL_THREAD int		t_dpiLineno;	///< DPI context line number
 
 public:
+    typedef VerilatedContext::CommandArgValues CommandArgValues;
 
     // METHODS - User called
 
+    /// Select the simulation context of the calling thread; NULL selects the default.
+    /// The context must outlive any models constructed or evaluated under it.
+    static void threadContextp(VerilatedContext* contextp) {
+	t_contextp = contextp ? contextp : &s_defaultContext; }
+    static VerilatedContext* threadContextp() { return t_contextp; }	///< Return calling thread's context
+    static VerilatedContext* defaultContextp() { return &s_defaultContext; }	///< Return the default context
+
     /// Select initial value of otherwise uninitialized signals.
     ////
     /// 0 = Set to zeros
     /// 1 = Set all bits to one
     /// 2 = Randomize all bits
-    static void randReset(int val) { s_s.s_randReset=val; }
-    static int  randReset() { return s_s.s_randReset; }	///< Return randReset value
+    static void randReset(int val) { t_contextp->randReset(val); }
+    static int  randReset() { return t_contextp->randReset(); }	///< Return randReset value
+    /// Seed the random generator for reproducible resets and $random
+    static void randSeed(vluint64_t seed) { t_contextp->randSeed(seed); }
 
     /// Enable debug of internal verilated code
-    static inline void debug(int level) { s_s.s_debug = level; }
+    static inline void debug(int level) { t_contextp->debug(level); }
 #ifdef VL_DEBUG
-    static inline int  debug() { return s_s.s_debug; }	///< Return debug value
+    static inline int  debug() { return t_contextp->debug(); }	///< Return debug value
 #else
     static inline int  debug() { return 0; }		///< Constant 0 debug, so C++'s optimizer rips up
 #endif
     /// Enable calculation of unused signals
-    static void calcUnusedSigs(bool flag) { s_s.s_calcUnusedSigs=flag; }
-    static bool calcUnusedSigs() { return s_s.s_calcUnusedSigs; }	///< Return calcUnusedSigs value
+    static void calcUnusedSigs(bool flag) { t_contextp->calcUnusedSigs(flag); }
+    static bool calcUnusedSigs() { return t_contextp->calcUnusedSigs(); }	///< Return calcUnusedSigs value
     /// Did the simulation $finish?
-    static void gotFinish(bool flag) { s_s.s_gotFinish=flag; }
-    static bool gotFinish() { return s_s.s_gotFinish; }	///< Return if got a $finish
+    static void gotFinish(bool flag) { t_contextp->gotFinish(flag); }
+    static bool gotFinish() { return t_contextp->gotFinish(); }	///< Return if got a $finish
     /// Allow traces to at some point be enabled (disables some optimizations)
     static void traceEverOn(bool flag) {
 	if (flag) { calcUnusedSigs(flag); }
     }
     /// Enable/disable assertions
-    static void assertOn(bool flag) { s_s.s_assertOn=flag; }
-    static bool assertOn() { return s_s.s_assertOn; }
+    static void assertOn(bool flag) { t_contextp->assertOn(flag); }
+    static bool assertOn() { return t_contextp->assertOn(); }
     /// Enable/disable vpi fatal
-    static void fatalOnVpiError(bool flag) { s_s.s_fatalOnVpiError=flag; }
-    static bool fatalOnVpiError() { return s_s.s_fatalOnVpiError; }
+    static void fatalOnVpiError(bool flag) { t_contextp->fatalOnVpiError(flag); }
+    static bool fatalOnVpiError() { return t_contextp->fatalOnVpiError(); }
     /// Flush callback for VCD waves
     static void flushCb(VerilatedVoidCb cb);
     static void flushCall() { if (s_flushCb) (*s_flushCb)(); }
+    /// Callback for configuration file watch points, called with the
+    /// watch's "module.signal" name when the signal has the watched value
+    static void watchCb(VerilatedWatchCb cb, void* userp) { s_watchCb=cb; s_watchUserp=userp; }
+    static void watchCall(const char* namep) { if (s_watchCb) (*s_watchCb)(namep, s_watchUserp); }
+    /// Give stdout and later $fopen'ed files an output buffer of the given
+    /// bytes, flushed by flushCall, at exit, on crashes and, under
+    /// VL_THREADED, periodically from a background thread.
+    /// Also set by +verilator+outbuf+<bytes> in commandArgs.
+    static void outputBuffer(size_t bytes);
+    static size_t outputBuffer();	///< Return output buffer size, 0 = stdio default
+    /// With --threads, CPUs to pin the model's threads to, as a list such
+    /// as "0,2,4-7", applied when a model is constructed.  The constructing
+    /// thread takes the first, and each pool worker the next in turn.
+    /// Also set by +verilator+threads+affinity+<cpus> in commandArgs.
+    static void threadsAffinity(const char* cpusp);
+    static const char* threadsAffinity();	///< Return CPU list, "" = not pinned
+    /// Fork a child process continuing from the current state, sharing the
+    /// model's memory copy-on-write.  Flushes output first, so it is not
+    /// written by both processes.  In the child, forkIndex() returns index,
+    /// and open VCD traces are reopened, and coverage written, under
+    /// forkFilename() names.  Returns as fork(): the child's pid in the
+    /// parent, 0 in the child, or -1 on error.  Only the calling thread
+    /// continues in the child, so not for models using --threads.
+    static int forkChild(int index);
+    static int forkIndex();	///< In a forkChild() child, its index, else -1
+    /// In a forkChild() child, filename with "_fork<index>" before the extension.
+    /// Returns static char* valid only for a single call
+    static const char* forkFilename(const char* filenamep);
+    /// Callback in each forkChild() child, to reopen outputs
+    static void forkCb(VerilatedVoidCb cb);
 
     /// Record command line arguments, for retrieval by $test$plusargs/$value$plusargs
-    static void commandArgs(int argc, const char** argv);
+    static void commandArgs(int argc, const char** argv) { t_contextp->commandArgs(argc, argv); }
     static void commandArgs(int argc, char** argv) { commandArgs(argc,(const char**)argv); }
-    static void commandArgsAdd(int argc, const char** argv);
-    static CommandArgValues* getCommandArgs() {return &s_args;}
+    static void commandArgsAdd(int argc, const char** argv) { t_contextp->commandArgsAdd(argc, argv); }
+    static CommandArgValues* getCommandArgs() { return t_contextp->getCommandArgs(); }
     /// Match plusargs with a given prefix. Returns static char* valid only for a single call
     static const char* commandArgsPlusMatch(const char* prefixp);
 
@@ -323,10 +546,16 @@ public:
     static const char* dpiFilenamep() { return t_dpiFilename; }
     static int dpiLineno() { return t_dpiLineno; }
     static int exportFuncNum(const char* namep);
-    static size_t serializedSize() { return sizeof(s_s); }
-    static void* serializedPtr() { return &s_s; }
+    static size_t serializedSize() { return t_contextp->serializedSize(); }
+    static void* serializedPtr() { return t_contextp->serializedPtr(); }
+    // Internal: Record the first write to a signal since its VPI value change check.
+    // Defined in verilated_vpi.cpp, as only models Verilated with --vpi call it.
+    static void vpiChanged(CData* chgp);
 };
 
+/// Mark a public signal as written, for VerilatedVpi::callValueCbs; the result is still the signal
+#define VL_VPI_CHG(chg, var) ((VL_UNLIKELY(!(chg)) ? Verilated::vpiChanged(&(chg)) : (void)0), var)
+
 //=========================================================================
 // Extern functions -- User may override -- See verilated.cpp
 
@@ -350,6 +579,86 @@ extern IData  VL_RAND_RESET_I(int obits);	///< Random reset a signal
 extern QData  VL_RAND_RESET_Q(int obits);	///< Random reset a signal
 extern WDataOutP VL_RAND_RESET_W(int obits, WDataOutP outwp);	///< Random reset a signal
 extern WDataOutP VL_ZERO_RESET_W(int obits, WDataOutP outwp);	///< Zero reset a signal (slow - else use VL_ZERO_W)
+/// Reset a large memory, if reset is to zero, without touching its pages.
+/// Returns false if instead the caller must reset each element.
+extern bool VL_RAND_RESET_MEM(void* datap, size_t bytes);
+
+//=========================================================================
+/// Sparse memory base class
+/// Type-independent access to a VlSparseArray, for $readmem
+
+class VerilatedSparseMem {
+public:
+    virtual ~VerilatedSparseMem() {}
+    /// Return pointer to storage for given entry, allocating its page if needed
+    virtual void* entryp(vluint64_t index) = 0;
+    /// Return bytes of the page table and allocated pages
+    virtual size_t memoryBytes() const = 0;
+protected:
+    // Reset one entry, as VL_RAND_RESET_* would for a dense array
+    static inline void resetEntry(int obits, CData& entry) { entry = (CData)VL_RAND_RESET_I(obits); }
+    static inline void resetEntry(int obits, SData& entry) { entry = (SData)VL_RAND_RESET_I(obits); }
+    static inline void resetEntry(int obits, IData& entry) { entry = VL_RAND_RESET_I(obits); }
+    static inline void resetEntry(int obits, QData& entry) { entry = VL_RAND_RESET_Q(obits); }
+    template <size_t T_Words> static inline void resetEntry(int obits, WData (&entry)[T_Words]) {
+	VL_RAND_RESET_W(obits, entry); }
+};
+
+//=========================================================================
+/// Sparse memory
+/// Storage for a huge unpacked array that is only sparsely used.  Entries
+/// are kept in pages that are allocated and reset on first access, so
+/// untouched parts of the array cost only a page table pointer.
+
+template <class T_Entry, int T_Width, vluint64_t T_Depth>
+class VlSparseArray : public VerilatedSparseMem {
+public:
+    // TYPES
+    enum { PAGE_BITS = 12, PAGE_ENTRIES = (1<<PAGE_BITS) };
+    struct Page { T_Entry m_entries[PAGE_ENTRIES]; };
+private:
+    // MEMBERS
+    Page**	m_pagesp;	///< Page table, NULL for pages never accessed
+    // Not copyable
+    VlSparseArray(const VlSparseArray&);
+    VlSparseArray& operator=(const VlSparseArray&);
+public:
+    // CONSTRUCTORS
+    VlSparseArray() { m_pagesp = (Page**)calloc(pages(), sizeof(Page*)); }
+    virtual ~VlSparseArray() { clear(); free(m_pagesp); }
+    // METHODS
+    static inline size_t pages() { return (size_t)((T_Depth + PAGE_ENTRIES - 1) >> PAGE_BITS); }
+    inline T_Entry& operator[](vluint64_t index) {
+	Page* pagep = m_pagesp[index >> PAGE_BITS];
+	if (VL_UNLIKELY(!pagep)) pagep = pageNewp(index >> PAGE_BITS);
+	return pagep->m_entries[index & (PAGE_ENTRIES-1)];
+    }
+    virtual void* entryp(vluint64_t index) { return &((*this)[index]); }
+    virtual size_t memoryBytes() const {
+	size_t bytes = pages() * sizeof(Page*);
+	for (size_t pg=0; pg<pages(); ++pg) if (m_pagesp[pg]) bytes += sizeof(Page);
+	return bytes;
+    }
+    /// Return page, or NULL if never accessed
+    Page* pagep(size_t pg) const { return m_pagesp[pg]; }
+    /// Return page, allocating and resetting it if never accessed
+    Page* pageNewp(size_t pg) {
+	if (m_pagesp[pg]) return m_pagesp[pg];
+	Page* pagep = new Page;
+	if (Verilated::randReset()==0) {
+	    memset(pagep, 0, sizeof(Page));
+	} else {
+	    for (int i=0; i<PAGE_ENTRIES; ++i) resetEntry(T_Width, pagep->m_entries[i]);
+	}
+	return m_pagesp[pg] = pagep;
+    }
+    /// Release all pages, so every entry reads back as newly reset
+    void clear() {
+	for (size_t pg=0; pg<pages(); ++pg) {
+	    if (m_pagesp[pg]) { delete m_pagesp[pg]; m_pagesp[pg] = NULL; }
+	}
+    }
+};
 
 /// Math
 extern WDataOutP _vl_moddiv_w(int lbits, WDataOutP owp, WDataInP lwp, WDataInP rwp, bool is_modulus);
@@ -372,10 +681,77 @@ extern void VL_READMEM_Q(bool hex, int width, int depth, int array_lsb, int fnwo
 inline void VL_READMEM_I(bool hex, int width, int depth, int array_lsb, int fnwords,
 			 IData ofilename,    void* memp, IData start, IData end) {
     VL_READMEM_Q(hex, width,depth,array_lsb,fnwords, ofilename,memp,start,end); }
+extern void VL_READMEM_W(bool hex, int width, int depth, int array_lsb, int fnwords,
+			 WDataInP ofilename, VerilatedSparseMem* memp, IData start, IData end);
+extern void VL_READMEM_Q(bool hex, int width, int depth, int array_lsb, int fnwords,
+			 QData ofilename,    VerilatedSparseMem* memp, IData start, IData end);
+inline void VL_READMEM_I(bool hex, int width, int depth, int array_lsb, int fnwords,
+			 IData ofilename,    VerilatedSparseMem* memp, IData start, IData end) {
+    VL_READMEM_Q(hex, width,depth,array_lsb,fnwords, ofilename,memp,start,end); }
 
 extern void VL_WRITEF(const char* formatp, ...);
 extern void VL_FWRITEF(IData fpi, const char* formatp, ...);
 
+//=========================================================================
+/// Compiled $display formats
+/// For a constant format, rather than VL_WRITEF parsing the format on
+/// every call, V3EmitC emits one call here per piece of the format, then
+/// one to output the result.  Typical lines need no allocation.
+
+class VerilatedFmtBuf {
+    // MEMBERS
+    char*	m_bufp;		///< Output; m_inline until that is outgrown
+    size_t	m_len;		///< Characters of output
+    size_t	m_size;		///< Allocated size of m_bufp, including terminating null
+    char	m_inline[256];	///< Storage for typical lines
+    // METHODS
+    void grow(size_t len);	///< Make room for len more characters
+    // Not copyable
+    VerilatedFmtBuf(const VerilatedFmtBuf&);
+    VerilatedFmtBuf& operator=(const VerilatedFmtBuf&);
+public:
+    // CONSTRUCTORS
+    VerilatedFmtBuf() : m_bufp(m_inline), m_len(0), m_size(sizeof(m_inline)) {}
+    ~VerilatedFmtBuf() { if (m_bufp != m_inline) free(m_bufp); }
+    // METHODS - format pieces
+    inline void text(const char* textp, size_t len) {	///< Literal text
+	if (VL_UNLIKELY(m_len + len >= m_size)) grow(len);
+	memcpy(m_bufp + m_len, textp, len);
+	m_len += len;
+    }
+    void cstr(const char* cstrp) { text(cstrp, strlen(cstrp)); }	///< %S
+    void name(const char* namep) { if (*namep) { cstr(namep); text(".", 1); } }	///< %N
+    /// Integral argument; width is -1 if the format has none
+    void num(char fmt, int width, bool zeroPad, int lbits, QData ld);
+    void num(char fmt, int width, bool zeroPad, int lbits, WDataInP lwp);
+    /// Real argument, with the printf format for it
+    void real(const char* specp, double d);
+    // METHODS - output
+    void writef();			///< $display/$write
+    void fwritef(IData fpi);		///< $fdisplay/$fwrite
+    void sformat(int obits, CData& destr);	///< $sformat/$swrite
+    void sformat(int obits, SData& destr);
+    void sformat(int obits, IData& destr);
+    void sformat(int obits, QData& destr);
+    void sformat(int obits, void* destp);
+    // METHODS - std::string like, for the runtime's formatter
+    size_t length() const { return m_len; }
+    size_t size() const { return m_len; }
+    const char* c_str() { m_bufp[m_len] = '\0'; return m_bufp; }
+    void reserve(size_t len) { if (len >= m_size) grow(len - m_len); }
+    void append(size_t count, char c) {
+	if (VL_UNLIKELY(m_len + count >= m_size)) grow(count);
+	memset(m_bufp + m_len, c, count);
+	m_len += count;
+    }
+    inline VerilatedFmtBuf& operator+=(char c) {
+	if (VL_UNLIKELY(m_len + 1 >= m_size)) grow(1);
+	m_bufp[m_len++] = c;
+	return *this;
+    }
+    VerilatedFmtBuf& operator+=(const char* cstrp) { cstr(cstrp); return *this; }
+};
+
 extern IData VL_FSCANF_IX(IData fpi, const char* formatp, ...);
 extern IData VL_SSCANF_IIX(int lbits, IData ld, const char* formatp, ...);
 extern IData VL_SSCANF_IQX(int lbits, QData ld, const char* formatp, ...);
@@ -454,8 +830,14 @@ void _VL_DEBUG_PRINT_W(int lbits, WDataInP iwp);
 # define VL_TIME_MULTIPLIER 1
 #endif
 
-/// Return current simulation time
-#if defined(SYSTEMC_VERSION) && (SYSTEMC_VERSION>20011000)
+/// Return current simulation time.  With VL_TIME_CONTEXT (from --time-context)
+/// it's the calling thread's VerilatedContext::time(), which the application
+/// sets before each eval(), so reading it is a load rather than a call.
+#if defined(VL_TIME_CONTEXT)
+# define VL_TIME_I() ((IData)(Verilated::threadContextp()->time()*VL_TIME_MULTIPLIER))
+# define VL_TIME_Q() ((QData)(Verilated::threadContextp()->time()*VL_TIME_MULTIPLIER))
+# define VL_TIME_D() ((double)(Verilated::threadContextp()->time()*VL_TIME_MULTIPLIER))
+#elif defined(SYSTEMC_VERSION) && (SYSTEMC_VERSION>20011000)
 # define VL_TIME_I() ((IData)(sc_time_stamp().to_default_time_units()*VL_TIME_MULTIPLIER))
 # define VL_TIME_Q() ((QData)(sc_time_stamp().to_default_time_units()*VL_TIME_MULTIPLIER))
 # define VL_TIME_D() ((double)(sc_time_stamp().to_default_time_units()*VL_TIME_MULTIPLIER))
@@ -779,20 +1161,37 @@ static inline IData VL_REDXOR_W(int words, WDataInP lwp) {
 }
 
 // EMIT_RULE: VL_COUNTONES_II:  oclean = false; lhs clean
+// With a hardware population count instruction (e.g. -mpopcnt) use it,
+// otherwise the builtin is a library call, and the bit tricks are faster
+#if defined(__GNUC__) && defined(__POPCNT__) && !defined(VL_NO_BUILTINS)
+# define VL_HAVE_POPCNT 1
+#endif
 static inline IData VL_COUNTONES_I(IData lhs) {
+#ifdef VL_HAVE_POPCNT
+    return __builtin_popcount(lhs);
+#else
     // This is faster than __builtin_popcountl
     IData r = lhs - ((lhs >> 1) & 033333333333) - ((lhs >> 2) & 011111111111);
     r = (r + (r>>3)) & 030707070707;
     r = (r + (r>>6));
     r = (r + (r>>12) + (r>>24)) & 077;
     return r;
+#endif
 }
 static inline IData VL_COUNTONES_Q(QData lhs) {
+#ifdef VL_HAVE_POPCNT
+    return __builtin_popcountll(lhs);
+#else
     return VL_COUNTONES_I((IData)lhs) + VL_COUNTONES_I((IData)(lhs>>32));
+#endif
 }
 static inline IData VL_COUNTONES_W(int words, WDataInP lwp) {
     IData r = 0;
-    for (int i=0; (i < words); ++i) r+=VL_COUNTONES_I(lwp[i]);
+    int i=0;
+#ifdef VL_HAVE_POPCNT
+    for (; i+1 < words; i+=2) r+=VL_COUNTONES_Q(((QData)lwp[i+1]<<VL_ULL(32)) | lwp[i]);
+#endif
+    for (; (i < words); ++i) r+=VL_COUNTONES_I(lwp[i]);
     return r;
 }
 
@@ -832,83 +1231,201 @@ static inline IData VL_ONEHOT0_W(int words, WDataInP lwp) {
     return 1;
 }
 
-static inline IData VL_CLOG2_I(IData lhs) {
-    // There are faster algorithms, or fls GCC4 builtins, but rarely used
-    if (VL_UNLIKELY(!lhs)) return 0;
-    lhs--;
+static inline IData VL_MOSTSETBITP1_I(IData lhs) {
+    // MSB set bit plus one; similar to FLS.  0=value is zero
+#if defined(__GNUC__) && (__GNUC__ >= 4) && !defined(VL_NO_BUILTINS)
+    return lhs ? (VL_WORDSIZE - __builtin_clz(lhs)) : 0;
+#else
     int shifts=0;
     for (; lhs!=0; ++shifts) lhs = lhs >> 1;
     return shifts;
+#endif
 }
-static inline IData VL_CLOG2_Q(QData lhs) {
-    if (VL_UNLIKELY(!lhs)) return 0;
-    lhs--;
-    int shifts=0;
-    for (; lhs!=0; ++shifts) lhs = lhs >> VL_ULL(1);
-    return shifts;
+static inline IData VL_MOSTSETBITP1_Q(QData lhs) {
+    return ((lhs >> VL_ULL(32)) ? (VL_WORDSIZE + VL_MOSTSETBITP1_I((IData)(lhs >> VL_ULL(32))))
+	    : VL_MOSTSETBITP1_I((IData)lhs));
 }
-static inline IData VL_CLOG2_W(int words, WDataInP lwp) {
-    IData adjust = (VL_COUNTONES_W(words,lwp)==1) ? 0 : 1;
+static inline IData VL_MOSTSETBITP1_W(int words, WDataInP lwp) {
+    // MSB set bit plus one; similar to FLS.  0=value is zero
     for (int i=words-1; i>=0; --i) {
 	if (VL_UNLIKELY(lwp[i])) {  // Shorter worst case if predict not taken
-	    for (int bit=31; bit>=0; --bit) {
-		if (VL_UNLIKELY(VL_BITISSET_I(lwp[i],bit))) {
-		    return i*VL_WORDSIZE + bit + adjust;
-		}
-	    }
-	    // Can't get here - one bit must be set
+	    return i*VL_WORDSIZE + VL_MOSTSETBITP1_I(lwp[i]);
 	}
     }
     return 0;
 }
 
-static inline IData VL_MOSTSETBITP1_W(int words, WDataInP lwp) {
-    // MSB set bit plus one; similar to FLS.  0=value is zero
-    for (int i=words-1; i>=0; --i) {
-	if (VL_UNLIKELY(lwp[i])) {  // Shorter worst case if predict not taken
-	    for (int bit=31; bit>=0; --bit) {
-		if (VL_UNLIKELY(VL_BITISSET_I(lwp[i],bit))) {
-		    return i*VL_WORDSIZE + bit + 1;
-		}
-	    }
-	    // Can't get here - one bit must be set
-	}
+static inline IData VL_CLOG2_I(IData lhs) {
+    if (VL_UNLIKELY(!lhs)) return 0;
+    return VL_MOSTSETBITP1_I(lhs-1);
+}
+static inline IData VL_CLOG2_Q(QData lhs) {
+    if (VL_UNLIKELY(!lhs)) return 0;
+    return VL_MOSTSETBITP1_Q(lhs-1);
+}
+static inline IData VL_CLOG2_W(int words, WDataInP lwp) {
+    IData adjust = VL_ONEHOT_W(words,lwp) ? 0 : 1;
+    IData msbp1 = VL_MOSTSETBITP1_W(words,lwp);
+    return msbp1 ? (msbp1 - 1 + adjust) : 0;
+}
+
+// EMIT_RULE: VL_PEXT:  oclean = clean; rhs clean
+// Gather the bits of lhs under the constant mask rhs into the LSBs
+static inline QData VL_PEXT_QQQ(QData lhs, QData rhs) {
+#ifdef VL_HAVE_BMI2
+    return _pext_u64(lhs, rhs);
+#else
+    // One shift per contiguous run of mask bits
+    QData out = 0;
+    int obit = 0;
+    while (rhs) {
+	QData lowbit = rhs & (~rhs + 1);
+	QData runp1 = rhs + lowbit;  // Clears the lowest run, carries past it
+	QData run = rhs & ~runp1;
+	int lsb = VL_MOSTSETBITP1_Q(lowbit) - 1;
+	out |= (lhs & run) >> (lsb - obit);
+	obit += VL_MOSTSETBITP1_Q(run) - lsb;
+	rhs &= runp1;
     }
-    return 0;
+    return out;
+#endif
+}
+static inline IData VL_PEXT_IQQ(QData lhs, QData rhs) {
+    return (IData)VL_PEXT_QQQ(lhs, rhs);
 }
+static inline IData VL_PEXT_III(IData lhs, IData rhs) {
+#ifdef VL_HAVE_BMI2
+    return _pext_u32(lhs, rhs);
+#else
+    return (IData)VL_PEXT_QQQ(lhs, rhs);
+#endif
+}
+
+//===================================================================
+// SIMD abstraction for wide operators
+// Each operator handles _VL_SIMD_WORDS words per step, then finishes any
+// remaining words with the scalar loop.  Loads and stores are unaligned,
+// as WData arrays are only word aligned.
+
+#if defined(VL_SIMD_AVX2)
+# define _VL_SIMD_WORDS			8
+typedef __m256i VlSimdW;
+# define _VL_SIMD_LOAD(p)		_mm256_loadu_si256((const __m256i*)(p))
+# define _VL_SIMD_STORE(p,v)		_mm256_storeu_si256((__m256i*)(p),(v))
+# define _VL_SIMD_AND(a,b)		_mm256_and_si256((a),(b))
+# define _VL_SIMD_OR(a,b)		_mm256_or_si256((a),(b))
+# define _VL_SIMD_XOR(a,b)		_mm256_xor_si256((a),(b))
+# define _VL_SIMD_ONES()		_mm256_set1_epi32(-1)
+# define _VL_SIMD_ZERO()		_mm256_setzero_si256()
+# define _VL_SIMD_ISZERO(v)		_mm256_testz_si256((v),(v))
+#elif defined(VL_SIMD_SSE2)
+# define _VL_SIMD_WORDS			4
+typedef __m128i VlSimdW;
+# define _VL_SIMD_LOAD(p)		_mm_loadu_si128((const __m128i*)(p))
+# define _VL_SIMD_STORE(p,v)		_mm_storeu_si128((__m128i*)(p),(v))
+# define _VL_SIMD_AND(a,b)		_mm_and_si128((a),(b))
+# define _VL_SIMD_OR(a,b)		_mm_or_si128((a),(b))
+# define _VL_SIMD_XOR(a,b)		_mm_xor_si128((a),(b))
+# define _VL_SIMD_ONES()		_mm_set1_epi32(-1)
+# define _VL_SIMD_ZERO()		_mm_setzero_si128()
+# define _VL_SIMD_ISZERO(v)		(_mm_movemask_epi8(_mm_cmpeq_epi8((v),_mm_setzero_si128()))==0xffff)
+#elif defined(VL_SIMD_NEON)
+# define _VL_SIMD_WORDS			4
+typedef uint32x4_t VlSimdW;
+# define _VL_SIMD_LOAD(p)		vld1q_u32((const uint32_t*)(p))
+# define _VL_SIMD_STORE(p,v)		vst1q_u32((uint32_t*)(p),(v))
+# define _VL_SIMD_AND(a,b)		vandq_u32((a),(b))
+# define _VL_SIMD_OR(a,b)		vorrq_u32((a),(b))
+# define _VL_SIMD_XOR(a,b)		veorq_u32((a),(b))
+# define _VL_SIMD_ONES()		vdupq_n_u32(0xffffffff)
+# define _VL_SIMD_ZERO()		vdupq_n_u32(0)
+# define _VL_SIMD_ISZERO(v)		(_vl_simd_reduce_or(v)==0)
+#endif
+
+#ifdef _VL_SIMD_WORDS
+// Internal usage: OR of all words in a vector
+static inline IData _vl_simd_reduce_or(VlSimdW v) {
+    WData words[_VL_SIMD_WORDS];
+    _VL_SIMD_STORE(words, v);
+    IData od = 0;
+    for (int i=0; i < _VL_SIMD_WORDS; ++i) od |= words[i];
+    return od;
+}
+#endif
 
 //===================================================================
 // SIMPLE LOGICAL OPERATORS
 
 // EMIT_RULE: VL_AND:  oclean=lclean||rclean; obits=lbits; lbits==rbits;
 static inline WDataOutP VL_AND_W(int words, WDataOutP owp,WDataInP lwp,WDataInP rwp){
-    for (int i=0; (i < words); ++i) owp[i] = (lwp[i] & rwp[i]);
+    int i=0;
+#ifdef _VL_SIMD_WORDS
+    for (; i+_VL_SIMD_WORDS <= words; i+=_VL_SIMD_WORDS) {
+	_VL_SIMD_STORE(owp+i, _VL_SIMD_AND(_VL_SIMD_LOAD(lwp+i), _VL_SIMD_LOAD(rwp+i)));
+    }
+#endif
+    for (; (i < words); ++i) owp[i] = (lwp[i] & rwp[i]);
     return(owp);
 }
 // EMIT_RULE: VL_OR:   oclean=lclean&&rclean; obits=lbits; lbits==rbits;
 static inline WDataOutP VL_OR_W(int words, WDataOutP owp,WDataInP lwp,WDataInP rwp){
-    for (int i=0; (i < words); ++i) owp[i] = (lwp[i] | rwp[i]);
+    int i=0;
+#ifdef _VL_SIMD_WORDS
+    for (; i+_VL_SIMD_WORDS <= words; i+=_VL_SIMD_WORDS) {
+	_VL_SIMD_STORE(owp+i, _VL_SIMD_OR(_VL_SIMD_LOAD(lwp+i), _VL_SIMD_LOAD(rwp+i)));
+    }
+#endif
+    for (; (i < words); ++i) owp[i] = (lwp[i] | rwp[i]);
     return(owp);
 }
 // EMIT_RULE: VL_CHANGEXOR:  oclean=1; obits=32; lbits==rbits;
 static inline IData VL_CHANGEXOR_W(int words, WDataInP lwp,WDataInP rwp){
     IData od = 0;
-    for (int i=0; (i < words); ++i) od |= (lwp[i] ^ rwp[i]);
+    int i=0;
+#ifdef _VL_SIMD_WORDS
+    if (words >= _VL_SIMD_WORDS) {
+	VlSimdW vod = _VL_SIMD_ZERO();
+	for (; i+_VL_SIMD_WORDS <= words; i+=_VL_SIMD_WORDS) {
+	    vod = _VL_SIMD_OR(vod, _VL_SIMD_XOR(_VL_SIMD_LOAD(lwp+i), _VL_SIMD_LOAD(rwp+i)));
+	}
+	od = _vl_simd_reduce_or(vod);
+    }
+#endif
+    for (; (i < words); ++i) od |= (lwp[i] ^ rwp[i]);
     return(od);
 }
 // EMIT_RULE: VL_XOR:  oclean=lclean&&rclean; obits=lbits; lbits==rbits;
 static inline WDataOutP VL_XOR_W(int words, WDataOutP owp,WDataInP lwp,WDataInP rwp){
-    for (int i=0; (i < words); ++i) owp[i] = (lwp[i] ^ rwp[i]);
+    int i=0;
+#ifdef _VL_SIMD_WORDS
+    for (; i+_VL_SIMD_WORDS <= words; i+=_VL_SIMD_WORDS) {
+	_VL_SIMD_STORE(owp+i, _VL_SIMD_XOR(_VL_SIMD_LOAD(lwp+i), _VL_SIMD_LOAD(rwp+i)));
+    }
+#endif
+    for (; (i < words); ++i) owp[i] = (lwp[i] ^ rwp[i]);
     return(owp);
 }
 // EMIT_RULE: VL_XNOR:  oclean=dirty; obits=lbits; lbits==rbits;
 static inline WDataOutP VL_XNOR_W(int words, WDataOutP owp,WDataInP lwp,WDataInP rwp){
-    for (int i=0; (i < words); ++i) owp[i] = (lwp[i] ^ ~rwp[i]);
+    int i=0;
+#ifdef _VL_SIMD_WORDS
+    for (; i+_VL_SIMD_WORDS <= words; i+=_VL_SIMD_WORDS) {
+	_VL_SIMD_STORE(owp+i, _VL_SIMD_XOR(_VL_SIMD_XOR(_VL_SIMD_LOAD(lwp+i), _VL_SIMD_LOAD(rwp+i)),
+					   _VL_SIMD_ONES()));
+    }
+#endif
+    for (; (i < words); ++i) owp[i] = (lwp[i] ^ ~rwp[i]);
     return(owp);
 }
 // EMIT_RULE: VL_NOT:  oclean=dirty; obits=lbits;
 static inline WDataOutP VL_NOT_W(int words, WDataOutP owp,WDataInP lwp) {
-    for (int i=0; i < words; ++i) owp[i] = ~(lwp[i]);
+    int i=0;
+#ifdef _VL_SIMD_WORDS
+    for (; i+_VL_SIMD_WORDS <= words; i+=_VL_SIMD_WORDS) {
+	_VL_SIMD_STORE(owp+i, _VL_SIMD_XOR(_VL_SIMD_LOAD(lwp+i), _VL_SIMD_ONES()));
+    }
+#endif
+    for (; i < words; ++i) owp[i] = ~(lwp[i]);
     return(owp);
 }
 
@@ -930,15 +1447,32 @@ static inline WDataOutP VL_NOT_W(int words, WDataOutP owp,WDataInP lwp) {
 // Output clean, <lhs> AND <rhs> MUST BE CLEAN
 static inline IData VL_EQ_W(int words, WDataInP lwp, WDataInP rwp) {
     int nequal=0;
-    for (int i=0; (i < words); ++i) nequal |= (lwp[i] ^ rwp[i]);
+    int i=0;
+#ifdef _VL_SIMD_WORDS
+    if (words >= _VL_SIMD_WORDS) {
+	VlSimdW vneq = _VL_SIMD_ZERO();
+	for (; i+_VL_SIMD_WORDS <= words; i+=_VL_SIMD_WORDS) {
+	    vneq = _VL_SIMD_OR(vneq, _VL_SIMD_XOR(_VL_SIMD_LOAD(lwp+i), _VL_SIMD_LOAD(rwp+i)));
+	}
+	if (!_VL_SIMD_ISZERO(vneq)) return 0;
+    }
+#endif
+    for (; (i < words); ++i) nequal |= (lwp[i] ^ rwp[i]);
     return(nequal==0);
 }
 
 // Internal usage
 static inline int _VL_CMP_W(int words, WDataInP lwp, WDataInP rwp) {
-    for (int i=words-1; i>=0; --i) {
-	if (lwp[i] > rwp[i]) return 1;
-	if (lwp[i] < rwp[i]) return -1;
+    // Compare 64 bits (two words) at a time, from the top
+    int i=words-1;
+    for (; i>=1; i-=2) {
+	QData lq = VL_SET_QW((lwp+i-1));
+	QData rq = VL_SET_QW((rwp+i-1));
+	if (lq != rq) return (lq > rq) ? 1 : -1;
+    }
+    if (i==0) {
+	if (lwp[0] > rwp[0]) return 1;
+	if (lwp[0] < rwp[0]) return -1;
     }
     return(0); // ==
 }
@@ -1022,9 +1556,49 @@ static inline int _VL_CMPS_W(int lbits, WDataInP lwp, WDataInP rwp) {
 #define VL_MODDIV_QQQ(lbits,lhs,rhs)	(((rhs)==0)?0:(lhs)%(rhs))
 #define VL_MODDIV_WWW(lbits,owp,lwp,rwp) (_vl_moddiv_w(lbits,owp,lwp,rwp,1))
 
+// Wide division by a divisor that fits in a word; V3EmitC uses these with
+// a constant divisor, which the C++ compiler reduces to multiplies
+static inline WDataOutP VL_DIV_WWI(int lbits, WDataOutP owp, WDataInP lwp, IData rd) {
+    int words = VL_WORDS_I(lbits);
+    if (VL_UNLIKELY(rd==0)) {
+	for (int i=0; i<words; ++i) owp[i] = 0;
+	return owp;
+    }
+    vluint64_t k = 0;
+    for (int j=words-1; j>=0; --j) {
+	vluint64_t unw64 = (k<<VL_ULL(32)) | (vluint64_t)(lwp[j]);
+	owp[j] = (IData)(unw64 / rd);
+	k = unw64 % rd;
+    }
+    return owp;
+}
+static inline WDataOutP VL_MODDIV_WWI(int lbits, WDataOutP owp, WDataInP lwp, IData rd) {
+    int words = VL_WORDS_I(lbits);
+    vluint64_t k = 0;
+    if (VL_LIKELY(rd!=0)) {
+	for (int j=words-1; j>=0; --j) {
+	    k = ((k<<VL_ULL(32)) | (vluint64_t)(lwp[j])) % rd;
+	}
+    }
+    owp[0] = (IData)k;
+    for (int i=1; i<words; ++i) owp[i] = 0;
+    return owp;
+}
+
 static inline WDataOutP VL_ADD_W(int words, WDataOutP owp,WDataInP lwp,WDataInP rwp){
+    // Add 64 bits (two words) at a time, carry out is detected by wraparound
     QData carry = 0;
-    for (int i=0; i<words; ++i) {
+    int i=0;
+    for (; i+1<words; i+=2) {
+	QData lq = VL_SET_QW((lwp+i));
+	QData sum = lq + VL_SET_QW((rwp+i));
+	QData cout = (sum < lq);
+	sum += carry;
+	cout |= (sum < carry);
+	carry = cout;
+	VL_SET_WQ((owp+i), sum);
+    }
+    for (; i<words; ++i) {
 	carry = carry + (QData)(lwp[i]) + (QData)(rwp[i]);
 	owp[i] = (carry & VL_ULL(0xffffffff));
 	carry = (carry >> VL_ULL(32)) & VL_ULL(0xffffffff);
@@ -1033,12 +1607,23 @@ static inline WDataOutP VL_ADD_W(int words, WDataOutP owp,WDataInP lwp,WDataInP
 }
 
 static inline WDataOutP VL_SUB_W(int words, WDataOutP owp,WDataInP lwp,WDataInP rwp){
-    QData carry = 0;
-    for (int i=0; i<words; ++i) {
-	carry = carry + (QData)(lwp[i]) + (QData)(IData)(~rwp[i]);
-	if (i==0) carry++;  // Negation of temp2
-	owp[i] = (carry & VL_ULL(0xffffffff));
-	carry = (carry >> VL_ULL(32)) & VL_ULL(0xffffffff);
+    // Subtract 64 bits (two words) at a time, borrow out is detected by wraparound
+    QData borrow = 0;
+    int i=0;
+    for (; i+1<words; i+=2) {
+	QData lq = VL_SET_QW((lwp+i));
+	QData rq = VL_SET_QW((rwp+i));
+	QData diff = lq - rq;
+	QData bout = (lq < rq);
+	bout |= (diff < borrow);
+	diff -= borrow;
+	borrow = bout;
+	VL_SET_WQ((owp+i), diff);
+    }
+    for (; i<words; ++i) {
+	QData diff = (QData)(lwp[i]) - (QData)(rwp[i]) - borrow;
+	owp[i] = (diff & VL_ULL(0xffffffff));
+	borrow = (diff >> VL_ULL(32)) & 1;
     }
     return(owp);
 }
@@ -1061,16 +1646,44 @@ static inline WDataOutP VL_NEGATE_W(int words, WDataOutP owp,WDataInP lwp){
 }
 
 static inline WDataOutP VL_MUL_W(int words, WDataOutP owp,WDataInP lwp,WDataInP rwp){
+    // Schoolbook multiply truncated to the output width; each row carries
+    // only into the next word, and partial products past the width are skipped
     for (int i=0; i<words; ++i) owp[i] = 0;
-    for (int lword=0; lword<words; ++lword) {
-	for (int rword=0; rword<words; ++rword) {
-	    QData mul = (QData)(lwp[lword]) * (QData)(rwp[rword]);
-	    for (int qword=lword+rword; qword<words; ++qword) {
-		mul += (QData)(owp[qword]);
-		owp[qword] = (mul & VL_ULL(0xffffffff));
-		mul = (mul >> VL_ULL(32)) & VL_ULL(0xffffffff);
+#ifdef VL_HAVE_INT128
+    if (words > 2) {
+	// 64x64->128 multiplies on two-word limbs.  The upper half of an odd
+	// top limb is past the output width, so it is read as zero and not stored.
+	int limbs = (words+1)/2;
+	for (int llimb=0; llimb<limbs; ++llimb) {
+	    int lword = 2*llimb;
+	    QData lhs = ((QData)(lwp[lword])
+			 | ((lword+1<words) ? ((QData)(lwp[lword+1])<<VL_ULL(32)) : 0));
+	    vluint128_t carry = 0;
+	    for (int rlimb=0; llimb+rlimb<limbs; ++rlimb) {
+		int rword = 2*rlimb;
+		int qword = lword+rword;
+		QData rhs = ((QData)(rwp[rword])
+			     | ((rword+1<words) ? ((QData)(rwp[rword+1])<<VL_ULL(32)) : 0));
+		QData out = ((QData)(owp[qword])
+			     | ((qword+1<words) ? ((QData)(owp[qword+1])<<VL_ULL(32)) : 0));
+		vluint128_t mul = (vluint128_t)(lhs) * rhs + out + carry;
+		owp[qword] = (IData)(mul);
+		if (qword+1<words) owp[qword+1] = (IData)(mul>>32);
+		carry = mul >> 64;
 	    }
 	}
+	// Last output word is dirty
+	return(owp);
+    }
+#endif
+    for (int lword=0; lword<words; ++lword) {
+	QData carry = 0;
+	for (int qword=lword; qword<words; ++qword) {
+	    // Fits: (2^32-1)^2 + 2*(2^32-1) == 2^64-1
+	    QData mul = (QData)(lwp[lword]) * (QData)(rwp[qword-lword]) + (QData)(owp[qword]) + carry;
+	    owp[qword] = (mul & VL_ULL(0xffffffff));
+	    carry = (mul >> VL_ULL(32)) & VL_ULL(0xffffffff);
+	}
     }
     // Last output word is dirty
     return(owp);
@@ -1604,8 +2217,14 @@ static inline WDataOutP VL_SHIFTL_WWI(int obits,int,int,WDataOutP owp,WDataInP l
 	for (int i=0; i < word_shift; ++i) owp[i] = 0;
 	for (int i=word_shift; i < VL_WORDS_I(obits); ++i) owp[i] = lwp[i-word_shift];
     } else {
-	for (int i=0; i < VL_WORDS_I(obits); ++i) owp[i] = 0;
-	_VL_INSERT_WW(obits,owp,lwp,obits-1,rd);
+	// Each output word is funnel shifted from two input words
+	int nbitsonleft = 32-bit_shift;
+	for (int i=0; i < word_shift; ++i) owp[i] = 0;
+	owp[word_shift] = lwp[0] << bit_shift;
+	for (int i=word_shift+1; i < VL_WORDS_I(obits); ++i) {
+	    owp[i] = (lwp[i-word_shift] << bit_shift) | (lwp[i-word_shift-1] >> nbitsonleft);
+	}
+	owp[VL_WORDS_I(obits)-1] &= VL_MASK_I(obits);
     }
     return(owp);
 }
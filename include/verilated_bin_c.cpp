@@ -0,0 +1,360 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//=============================================================================
+//
+// THIS MODULE IS PUBLICLY LICENSED
+//
+// Copyright 2017-2017 by Wilson Snyder.  This program is free software;
+// you can redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License Version 2.0.
+//
+// This is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+//=============================================================================
+///
+/// \file
+/// \brief C++ Tracing in compact binary format (--trace-bin)
+///
+/// File layout, all integers are LEB128 varints unless noted:
+///	"VLTBIN1\n"
+///	number of signals; then for each: code, bits, kind
+///	length of VCD header text; then the text
+///	records: (code<<2 | op) [value bytes], or code 0 then
+///		TIME_DELTA delta, or TIME_ABS time (first in each block)
+///
+//=============================================================================
+
+#include "verilatedos.h"
+#include "verilated.h"
+#include "verilated_bin_c.h"
+
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+
+//=============================================================================
+// Global
+
+vector<VerilatedBin*>	VerilatedBin::s_binVecp;	///< List of all created traces
+
+static VerilatedMutex s_binVecMutex;	///< Protects s_binVecp, as models may trace on several threads
+
+//=============================================================================
+// VerilatedBinCallInfo
+/// Internal callback routines for each module being traced.
+
+class VerilatedBinCallInfo {
+protected:
+    friend class VerilatedBin;
+    VerilatedBinCallback_t	m_initcb;	///< Initialization Callback function
+    VerilatedBinCallback_t	m_fullcb;	///< Full Dumping Callback function
+    VerilatedBinCallback_t	m_changecb;	///< Incremental Dumping Callback function
+    void*		m_userthis;	///< Fake "this" for caller
+    vluint32_t		m_code;		///< Starting code number
+    // CREATORS
+    VerilatedBinCallInfo (VerilatedBinCallback_t icb, VerilatedBinCallback_t fcb,
+			  VerilatedBinCallback_t changecb, void* ut)
+	: m_initcb(icb), m_fullcb(fcb), m_changecb(changecb), m_userthis(ut), m_code(0) {};
+};
+
+//=============================================================================
+// VerilatedBinHeaderFile
+/// Captures the VCD header text built by the internal VerilatedVcd
+
+class VerilatedBinHeaderFile : public VerilatedVcdFile {
+public:
+    string	m_text;
+    virtual bool open(const string&) { m_text = ""; return true; }
+    virtual void close() {}
+    virtual ssize_t write(const char* bufp, ssize_t len) { m_text.append(bufp, len); return len; }
+};
+
+//=============================================================================
+// Opening/Closing
+
+VerilatedBin::VerilatedBin(VerilatedVcdFile* filep)
+    : m_hdrFilep(new VerilatedBinHeaderFile), m_vcd(m_hdrFilep), m_isOpen(false) {
+    m_fileNewed = (filep == NULL);
+    m_filep = m_fileNewed ? new VerilatedVcdFile : filep;
+    m_fullDump = true;
+    m_windowStart = 0;
+    m_windowLength = ~VL_ULL(0);
+    m_dumpIdle = true;
+    m_blockStart = true;
+    m_timeLastDump = 0;
+    m_sigs_oldvalp = NULL;
+    m_sigs_packedp = NULL;
+    m_fullGen = 0;
+    m_wrChunkSize = 8*1024;
+    m_wrBufp = new vluint8_t [m_wrChunkSize*8];
+    m_wrFlushp = m_wrBufp + m_wrChunkSize * 6;
+    m_writep = m_wrBufp;
+    m_vcd.addCallback(&vcdInitCb, &vcdNullCb, &vcdNullCb, this);
+}
+
+VerilatedBin::~VerilatedBin() {
+    close();
+    if (m_wrBufp) { delete[] m_wrBufp; m_wrBufp=NULL; }
+    if (m_sigs_oldvalp) { delete[] m_sigs_oldvalp; m_sigs_oldvalp=NULL; }
+    if (m_sigs_packedp) { delete[] m_sigs_packedp; m_sigs_packedp=NULL; }
+    if (m_filep && m_fileNewed) { delete m_filep; m_filep = NULL; }
+    m_vcd.close();
+    if (m_hdrFilep) { delete m_hdrFilep; m_hdrFilep = NULL; }
+    for (vector<VerilatedBinCallInfo*>::iterator it = m_callbacks.begin(); it != m_callbacks.end(); ++it) {
+	delete *it;
+    }
+    // Remove from list of traces
+    s_binVecMutex.lock();
+    vector<VerilatedBin*>::iterator pos = find(s_binVecp.begin(), s_binVecp.end(), this);
+    if (pos != s_binVecp.end()) { s_binVecp.erase(pos); }
+    s_binVecMutex.unlock();
+}
+
+void VerilatedBin::vcdInitCb(VerilatedVcd* vcdp, void* userthis, vluint32_t) {
+    // Callback from the internal VCD's open; call our users' init routines,
+    // whose declarations we forward to it
+    VerilatedBin* binp = (VerilatedBin*)userthis;
+    for (vluint32_t ent = 0; ent< binp->m_callbacks.size(); ent++) {
+	VerilatedBinCallInfo* cip = binp->m_callbacks[ent];
+	cip->m_code = vcdp->nextCode();
+	(cip->m_initcb) (binp, cip->m_userthis, cip->m_code);
+    }
+}
+
+void VerilatedBin::vcdNullCb(VerilatedVcd*, void*, vluint32_t) {
+}
+
+void VerilatedBin::open (const char* filename) {
+    if (isOpen()) return;
+
+    m_filename = filename;
+    s_binVecMutex.lock();
+    s_binVecp.push_back(this);
+    s_binVecMutex.unlock();
+    Verilated::flushCb(&flush_all);
+
+    if (!m_filep->open(m_filename)) {
+	// User code can check isOpen()
+	m_isOpen = false;
+	return;
+    }
+    m_isOpen = true;
+    m_fullDump = true;	// First dump must be full
+    m_blockStart = true;
+
+    // Build declarations and the text header
+    m_sigs.clear();
+    m_vcd.open("header");
+    m_vcd.flush();
+    string header = m_hdrFilep->m_text;
+    m_vcd.close();
+
+    // Allocate space now we know the number of codes
+    if (!m_sigs_oldvalp) {
+	m_sigs_oldvalp = new vluint32_t [nextCode()+10];
+	m_sigs_packedp = new vluint64_t [nextCode()+10]();
+    }
+    dumpHeader(header);
+}
+
+void VerilatedBin::closeErr () {
+    // Close due to an error.  No buffer flush, just close
+    if (!isOpen()) return;
+    m_isOpen = false;
+    m_filep->close();  // May get error, just ignore it
+}
+
+void VerilatedBin::close() {
+    if (!isOpen()) return;
+    bufferFlush();
+    m_isOpen = false;
+    m_filep->close();
+}
+
+void VerilatedBin::bufferResize(size_t minsize) {
+    // minsize is size of largest write.  We buffer at least 8 times as much data,
+    // writing when we are 3/4 full (with thus 2*minsize remaining free)
+    if (VL_UNLIKELY(minsize > m_wrChunkSize)) {
+	vluint8_t* oldbufp = m_wrBufp;
+	m_wrChunkSize = minsize*2;
+	m_wrBufp = new vluint8_t [m_wrChunkSize * 8];
+	memcpy(m_wrBufp, oldbufp, m_writep - oldbufp);
+        m_writep = m_wrBufp + (m_writep - oldbufp);
+	m_wrFlushp = m_wrBufp + m_wrChunkSize * 6;
+	delete[] oldbufp; oldbufp=NULL;
+    }
+}
+
+void VerilatedBin::bufferFlush () {
+    // Each flush ends a block; the next time record will be absolute
+    if (VL_UNLIKELY(!isOpen())) return;
+    const char* wp = (const char*)m_wrBufp;
+    while (1) {
+	ssize_t remaining = ((const char*)m_writep - wp);
+	if (remaining==0) break;
+	errno = 0;
+	ssize_t got = m_filep->write(wp, remaining);
+	if (got>0) {
+	    wp += got;
+	} else if (got < 0) {
+	    if (errno != EAGAIN && errno != EINTR) {
+		// write failed, presume error (perhaps out of disk space)
+		string msg = (string)"VerilatedBin::bufferFlush: "+strerror(errno);
+		vl_fatal("",0,"",msg.c_str());
+		closeErr();
+		break;
+	    }
+	}
+    }
+    // Reset buffer
+    m_writep = m_wrBufp;
+    m_blockStart = true;
+}
+
+//=============================================================================
+// Definitions
+
+void VerilatedBin::declare (vluint32_t code, int bits, int kind) {
+    m_sigs.push_back(SigInfo(code, bits, kind));
+    // Make sure write buffer is large enough (value and tristate bytes), plus header
+    bufferResize(2*(bits/8+1)+1024);
+}
+
+void VerilatedBin::declBit      (vluint32_t code, const char* name, int arraynum)
+{  declare(code, 1, KIND_BIT);  m_vcd.declBit(code, name, arraynum); }
+void VerilatedBin::declBus      (vluint32_t code, const char* name, int arraynum, int msb, int lsb)
+{  declare(code, ((msb>lsb)?(msb-lsb):(lsb-msb))+1, KIND_BUS);  m_vcd.declBus(code, name, arraynum, msb, lsb); }
+void VerilatedBin::declQuad     (vluint32_t code, const char* name, int arraynum, int msb, int lsb)
+{  declare(code, ((msb>lsb)?(msb-lsb):(lsb-msb))+1, KIND_BUS);  m_vcd.declQuad(code, name, arraynum, msb, lsb); }
+void VerilatedBin::declArray    (vluint32_t code, const char* name, int arraynum, int msb, int lsb)
+{  declare(code, ((msb>lsb)?(msb-lsb):(lsb-msb))+1, KIND_BUS);  m_vcd.declArray(code, name, arraynum, msb, lsb); }
+void VerilatedBin::declTriBit   (vluint32_t code, const char* name, int arraynum)
+{  declare(code, 1, KIND_TRIBIT);  m_vcd.declTriBit(code, name, arraynum); }
+void VerilatedBin::declTriBus   (vluint32_t code, const char* name, int arraynum, int msb, int lsb)
+{  declare(code, ((msb>lsb)?(msb-lsb):(lsb-msb))+1, KIND_TRIBUS);  m_vcd.declTriBus(code, name, arraynum, msb, lsb); }
+void VerilatedBin::declTriQuad  (vluint32_t code, const char* name, int arraynum, int msb, int lsb)
+{  declare(code, ((msb>lsb)?(msb-lsb):(lsb-msb))+1, KIND_TRIBUS);  m_vcd.declTriQuad(code, name, arraynum, msb, lsb); }
+void VerilatedBin::declTriArray (vluint32_t code, const char* name, int arraynum, int msb, int lsb)
+{  declare(code, ((msb>lsb)?(msb-lsb):(lsb-msb))+1, KIND_TRIBUS);  m_vcd.declTriArray(code, name, arraynum, msb, lsb); }
+void VerilatedBin::declFloat    (vluint32_t code, const char* name, int arraynum)
+{  declare(code, 64, KIND_REAL);  m_vcd.declFloat(code, name, arraynum); }
+void VerilatedBin::declDouble   (vluint32_t code, const char* name, int arraynum)
+{  declare(code, 64, KIND_REAL);  m_vcd.declDouble(code, name, arraynum); }
+
+void VerilatedBin::dumpHeader (const string& vcdHeader) {
+    bufferResize(vcdHeader.length() + 16);
+    const char* magicp = "VLTBIN1\n";
+    while (*magicp) *m_writep++ = *magicp++;
+    printVarint(m_sigs.size());
+    bufferCheck();
+    for (vector<SigInfo>::iterator it = m_sigs.begin(); it != m_sigs.end(); ++it) {
+	printVarint(it->m_code);
+	printVarint(it->m_bits);
+	*m_writep++ = (vluint8_t)it->m_kind;
+	bufferCheck();
+    }
+    printVarint(vcdHeader.length());
+    memcpy(m_writep, vcdHeader.data(), vcdHeader.length());
+    m_writep += vcdHeader.length();
+    bufferFlush();
+}
+
+//=============================================================================
+
+void VerilatedBin::fullDouble (vluint32_t code, const double newval) {
+    // cppcheck-suppress invalidPointerCast
+    (*((double*)&m_sigs_oldvalp[code])) = newval;
+    printRecord(code, OP_VALUE);
+    vluint32_t words[2];
+    memcpy(words, &newval, sizeof(words));
+    printBytes(words, 64);
+    bufferCheck();
+}
+void VerilatedBin::fullFloat (vluint32_t code, const float newval) {
+    // cppcheck-suppress invalidPointerCast
+    (*((float*)&m_sigs_oldvalp[code])) = newval;
+    double dval = newval;
+    printRecord(code, OP_VALUE);
+    vluint32_t words[2];
+    memcpy(words, &dval, sizeof(words));
+    printBytes(words, 64);
+    bufferCheck();
+}
+
+//=============================================================================
+// Callbacks
+
+void VerilatedBin::addCallback (
+    VerilatedBinCallback_t initcb, VerilatedBinCallback_t fullcb, VerilatedBinCallback_t changecb,
+    void* userthis)
+{
+    if (VL_UNLIKELY(isOpen())) {
+	string msg = (string)"Internal: "+__FILE__+"::"+__FUNCTION__+" called with already open file";
+	vl_fatal(__FILE__,__LINE__,"",msg.c_str());
+    }
+    VerilatedBinCallInfo* vci = new VerilatedBinCallInfo(initcb, fullcb, changecb, userthis);
+    m_callbacks.push_back(vci);
+}
+
+//=============================================================================
+// Dumping
+
+void VerilatedBin::dumpFull (vluint64_t timeui) {
+    dumpPrep (timeui);
+    ++m_fullGen;  // Values now written here, not seen by chgBits
+    for (vluint32_t ent = 0; ent< m_callbacks.size(); ent++) {
+	VerilatedBinCallInfo *cip = m_callbacks[ent];
+	(cip->m_fullcb) (this, cip->m_userthis, cip->m_code);
+    }
+}
+
+void VerilatedBin::dumpInWindow (vluint64_t timeui) {
+    if (!isOpen()) return;
+    if (VL_UNLIKELY(m_fullDump)) {
+	m_fullDump = false;	// No need for more full dumps
+	dumpFull(timeui);
+	// Covers all activity so far
+	for (vector<bool*>::iterator it = m_activityps.begin(); it != m_activityps.end(); ++it) **it = false;
+	return;
+    }
+    if (VL_UNLIKELY(!m_dumpIdle) && !activity()) return;
+    dumpPrep (timeui);
+    for (vluint32_t ent = 0; ent< m_callbacks.size(); ent++) {
+	VerilatedBinCallInfo *cip = m_callbacks[ent];
+	(cip->m_changecb) (this, cip->m_userthis, cip->m_code);
+    }
+}
+
+void VerilatedBin::dumpPrep (vluint64_t timeui) {
+    if (VL_UNLIKELY(timeui < m_timeLastDump)) {
+	timeui = m_timeLastDump;
+	static bool backTime = false;
+	if (!backTime) {
+	    backTime = true;
+	    VL_PRINTF("Binary trace time is moving backwards, wave file may be incorrect.\n");
+	}
+    }
+    printVarint(0);
+    if (m_blockStart) {
+	m_blockStart = false;
+	printVarint(TIME_ABS); printVarint(timeui);
+    } else {
+	printVarint(TIME_DELTA); printVarint(timeui - m_timeLastDump);
+    }
+    m_timeLastDump = timeui;
+    bufferCheck();
+}
+
+//======================================================================
+// Static members
+
+void VerilatedBin::flush_all() {
+    s_binVecMutex.lock();
+    for (vluint32_t ent = 0; ent< s_binVecp.size(); ent++) {
+	VerilatedBin* binp = s_binVecp[ent];
+	binp->flush();
+    }
+    s_binVecMutex.unlock();
+}
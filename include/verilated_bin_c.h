@@ -0,0 +1,399 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//=============================================================================
+//
+// THIS MODULE IS PUBLICLY LICENSED
+//
+// Copyright 2017-2017 by Wilson Snyder.  This program is free software;
+// you can redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License Version 2.0.
+//
+// This is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+//=============================================================================
+///
+/// \file
+/// \brief C++ Tracing in compact binary format (--trace-bin)
+///
+/// The file starts with a signal table and the VCD text header, followed
+/// by blocks of value changes, each block starting with an absolute time.
+/// Values are stored as packed little-endian bytes rather than one
+/// character per bit.  Convert to VCD with verilator_bin2vcd.
+///
+//=============================================================================
+
+#ifndef _VERILATED_BIN_C_H_
+#define _VERILATED_BIN_C_H_ 1
+
+#include "verilatedos.h"
+#include "verilated_vcd_c.h"
+
+#include <string>
+#include <vector>
+using namespace std;
+
+class VerilatedBin;
+class VerilatedBinCallInfo;
+class VerilatedBinHeaderFile;
+
+//=============================================================================
+
+typedef void (*VerilatedBinCallback_t)(VerilatedBin* binp, void* userthis, vluint32_t code);
+
+//=============================================================================
+// VerilatedBin
+/// Base class to create a Verilator binary trace dump
+/// This is an internally used class - see VerilatedBinC for what to call from applications
+
+class VerilatedBin {
+public:
+    // Record opcodes, in the low bits of each value record's code
+    enum { OP_VALUE = 0, OP_X = 1, OP_BIT0 = 2, OP_BIT1 = 3, OP_BITS = 2 };
+    // Records with code 0 are times
+    enum { TIME_DELTA = 0, TIME_ABS = 1 };
+    // Signal kinds in the signal table
+    enum { KIND_BIT = 0, KIND_BUS = 1, KIND_TRIBIT = 2, KIND_TRIBUS = 3, KIND_REAL = 4 };
+private:
+    VerilatedBinHeaderFile*	m_hdrFilep;	///< Captures m_vcd's output
+    VerilatedVcd	m_vcd;		///< Builds the declarations and header text
+    VerilatedVcdFile*	m_filep;	///< File we're writing to
+    bool		m_fileNewed;	///< m_filep needs destruction
+    bool		m_isOpen;	///< True indicates open file
+    string		m_filename;	///< Filename we're writing to (if open)
+    bool		m_fullDump;	///< True indicates dump ignoring if changed
+    vluint64_t		m_windowStart;	///< Dump only at times from this...
+    vluint64_t		m_windowLength;	///< ...for this long; 0 when dumping is off
+    bool		m_dumpIdle;	///< Dump even when no traced model was evaluated
+    vector<bool*>	m_activityps;	///< Each traced model's activity flag
+    bool		m_blockStart;	///< Next time is first in a block, so absolute
+    vluint64_t		m_timeLastDump;	///< Last time we did a dump
+
+    vluint8_t*		m_wrBufp;	///< Output buffer
+    vluint8_t*		m_wrFlushp;	///< Output buffer flush trigger location
+    vluint8_t*		m_writep;	///< Write pointer into output buffer
+    size_t		m_wrChunkSize;	///< Output buffer size
+
+    vluint32_t*			m_sigs_oldvalp;	///< Pointer to old signal values
+    vluint64_t*			m_sigs_packedp;	///< Per code starting a chgBits group, last values and m_fullGen
+    vluint32_t			m_fullGen;	///< Full dumps made, so chgBits groups differ after one
+    vector<VerilatedBinCallInfo*>	m_callbacks;	///< Routines to perform dumping
+    struct SigInfo {
+	vluint32_t	m_code;
+	int		m_bits;
+	int		m_kind;
+	SigInfo(vluint32_t code, int bits, int kind) : m_code(code), m_bits(bits), m_kind(kind) {}
+    };
+    vector<SigInfo>		m_sigs;		///< Declared signals
+    static vector<VerilatedBin*>	s_binVecp;	///< List of all created traces
+
+    void bufferResize(size_t minsize);
+    void bufferFlush();
+    inline void bufferCheck() {
+	// Flush the write buffer if there's not enough space left for a widest record
+	if (VL_UNLIKELY(m_writep > m_wrFlushp)) {
+	    bufferFlush();
+	}
+    }
+    inline void printVarint(vluint64_t n) {
+	while (n >= 0x80) { *m_writep++ = (vluint8_t)(n | 0x80); n >>= 7; }
+	*m_writep++ = (vluint8_t)n;
+    }
+    inline void printBytes(const vluint32_t* wordsp, int bits) {
+	int bytes = (bits+7)/8;
+	for (int i=0; i<bytes; ++i) *m_writep++ = (vluint8_t)(wordsp[i/4] >> ((i&3)*8));
+    }
+    inline void printRecord(vluint32_t code, int op) {
+	printVarint(((vluint64_t)code<<OP_BITS) | op);
+    }
+    void declare(vluint32_t code, int bits, int kind);
+    static void vcdInitCb(VerilatedVcd* vcdp, void* userthis, vluint32_t code);
+    static void vcdNullCb(VerilatedVcd* vcdp, void* userthis, vluint32_t code);
+    void dumpHeader(const string& vcdHeader);
+    void dumpFull(vluint64_t timeui);
+    void dumpPrep(vluint64_t timeui);
+    void closeErr();
+
+    VerilatedBin(const VerilatedBin& );	///< N/A, no copy constructor
+
+public:
+    // CREATORS
+    explicit VerilatedBin(VerilatedVcdFile* filep=NULL);
+    ~VerilatedBin();
+
+    // ACCESSORS
+    /// Inside dumping routines, return next signal code
+    vluint32_t nextCode() const { return m_vcd.nextCode(); }
+    /// Is file open?
+    bool isOpen() const { return m_isOpen; }
+    /// Change character that splits scopes.  Note whitespace are ALWAYS escapes.
+    void scopeEscape(char flag) { m_vcd.scopeEscape(flag); }
+
+    // METHODS
+    void open (const char* filename);	///< Open the file; call isOpen() to see if errors
+    void flush() { bufferFlush(); }	///< Flush any remaining data
+    static void flush_all();		///< Flush any remaining data from all files
+    void close ();			///< Close the file
+
+    void set_time_unit (const char* unit) { m_vcd.set_time_unit(unit); }
+    void set_time_unit (const string& unit) { set_time_unit(unit.c_str()); }
+    void set_time_resolution (const char* unit) { m_vcd.set_time_resolution(unit); }
+    void set_time_resolution (const string& unit) { set_time_resolution(unit.c_str()); }
+
+    /// Inside dumping routines, called each cycle to make the dump
+    void dump (vluint64_t timeui) {
+	// Outside the window this test is the only cost; the next dump inside is full
+	if (VL_UNLIKELY((timeui - m_windowStart) >= m_windowLength)) { m_fullDump = true; return; }
+	dumpInWindow(timeui);
+    }
+    void dumpInWindow (vluint64_t timeui);
+    bool activity () const {
+	for (vector<bool*>::const_iterator it = m_activityps.begin(); it != m_activityps.end(); ++it) {
+	    if (**it) return true;
+	}
+	return m_activityps.empty();
+    }
+    /// Dump only at times startTime <= time < stopTime, e.g. around a failure
+    void dumpWindow (vluint64_t startTime, vluint64_t stopTime) {
+	m_windowStart = startTime;
+	m_windowLength = (stopTime > startTime) ? (stopTime - startTime) : 0;
+    }
+    /// Start dumping at all times (the default), e.g. from a DPI trigger
+    void dumpOn () { m_windowStart = 0; m_windowLength = ~VL_ULL(0); }
+    /// Stop dumping until dumpOn() or dumpWindow()
+    void dumpOff () { m_windowLength = 0; }
+    /// Skip dumps, including their time, when no traced model was
+    /// evaluated since the last dump; false suits SystemC, which calls
+    /// dump at every time step of the whole simulation
+    void dumpIdle (bool flag) { m_dumpIdle = flag; }
+
+    /// Inside dumping routines, declare callbacks for tracings
+    void addCallback (VerilatedBinCallback_t init, VerilatedBinCallback_t full,
+		      VerilatedBinCallback_t change,
+		      void* userthis);
+    /// Inside dumping routines, declare a model's flag set when it is evaluated
+    void addActivity (bool* activityp) { m_activityps.push_back(activityp); }
+
+    /// Inside dumping routines, declare a module
+    void module (const string& name) { m_vcd.module(name); }
+    /// Inside dumping routines, declare a signal
+    void declBit      (vluint32_t code, const char* name, int arraynum);
+    void declBus      (vluint32_t code, const char* name, int arraynum, int msb, int lsb);
+    void declQuad     (vluint32_t code, const char* name, int arraynum, int msb, int lsb);
+    void declArray    (vluint32_t code, const char* name, int arraynum, int msb, int lsb);
+    void declTriBit   (vluint32_t code, const char* name, int arraynum);
+    void declTriBus   (vluint32_t code, const char* name, int arraynum, int msb, int lsb);
+    void declTriQuad  (vluint32_t code, const char* name, int arraynum, int msb, int lsb);
+    void declTriArray (vluint32_t code, const char* name, int arraynum, int msb, int lsb);
+    void declDouble   (vluint32_t code, const char* name, int arraynum);
+    void declFloat    (vluint32_t code, const char* name, int arraynum);
+
+    /// Inside dumping routines, dump one signal
+    void fullBit (vluint32_t code, const vluint32_t newval) {
+	m_sigs_oldvalp[code] = newval;
+	printRecord(code, (newval&1) ? OP_BIT1 : OP_BIT0);
+	bufferCheck();
+    }
+    void fullBus (vluint32_t code, const vluint32_t newval, int bits) {
+	m_sigs_oldvalp[code] = newval;
+	printRecord(code, OP_VALUE); printBytes(&m_sigs_oldvalp[code], bits);
+	bufferCheck();
+    }
+    void fullQuad (vluint32_t code, const vluint64_t newval, int bits) {
+	(*((vluint64_t*)&m_sigs_oldvalp[code])) = newval;
+	printRecord(code, OP_VALUE); printBytes(&m_sigs_oldvalp[code], bits);
+	bufferCheck();
+    }
+    void fullArray (vluint32_t code, const vluint32_t* newval, int bits) {
+	for (int word=0; word<(((bits-1)/32)+1); ++word) {
+	    m_sigs_oldvalp[code+word] = newval[word];
+	}
+	printRecord(code, OP_VALUE); printBytes(newval, bits);
+	bufferCheck();
+    }
+    void fullTriBit (vluint32_t code, const vluint32_t newval, const vluint32_t newtri) {
+	m_sigs_oldvalp[code]   = newval;
+	m_sigs_oldvalp[code+1] = newtri;
+	printRecord(code, OP_VALUE);
+	*m_writep++ = (vluint8_t)((newval&1) | ((newtri&1)<<1));
+	bufferCheck();
+    }
+    void fullTriBus (vluint32_t code, const vluint32_t newval, const vluint32_t newtri, int bits) {
+	m_sigs_oldvalp[code] = newval;
+	m_sigs_oldvalp[code+1] = newtri;
+	printRecord(code, OP_VALUE);
+	printBytes(&m_sigs_oldvalp[code], bits); printBytes(&m_sigs_oldvalp[code+1], bits);
+	bufferCheck();
+    }
+    void fullTriQuad (vluint32_t code, const vluint64_t newval, const vluint32_t newtri, int bits) {
+	(*((vluint64_t*)&m_sigs_oldvalp[code])) = newval;
+	(*((vluint64_t*)&m_sigs_oldvalp[code+1])) = newtri;
+	vluint32_t words[4] = { (vluint32_t)newval, (vluint32_t)(newval>>32ULL), newtri, 0 };
+	printRecord(code, OP_VALUE);
+	printBytes(&words[0], bits); printBytes(&words[2], bits);
+	bufferCheck();
+    }
+    void fullTriArray (vluint32_t code, const vluint32_t* newvalp, const vluint32_t* newtrip, int bits) {
+	for (int word=0; word<(((bits-1)/32)+1); ++word) {
+	    m_sigs_oldvalp[code+word*2]   = newvalp[word];
+	    m_sigs_oldvalp[code+word*2+1] = newtrip[word];
+	}
+	printRecord(code, OP_VALUE);
+	printBytes(newvalp, bits); printBytes(newtrip, bits);
+	bufferCheck();
+    }
+    void fullDouble (vluint32_t code, const double newval);
+    void fullFloat (vluint32_t code, const float newval);
+
+    /// Inside dumping routines, dump one signal as unknowns
+    /// Presently this code doesn't change the oldval vector.
+    inline void fullBitX (vluint32_t code) {
+	printRecord(code, OP_X);
+	bufferCheck();
+    }
+    inline void fullBusX (vluint32_t code, int) { fullBitX(code); }
+    inline void fullQuadX (vluint32_t code, int bits) { fullBusX (code, bits); }
+    inline void fullArrayX (vluint32_t code, int bits) { fullBusX (code, bits); }
+
+    /// Inside dumping routines, dump one signal if it has changed
+    inline void chgBit (vluint32_t code, const vluint32_t newval) {
+	vluint32_t diff = m_sigs_oldvalp[code] ^ newval;
+	if (VL_UNLIKELY(diff)) {
+	    if (VL_UNLIKELY(diff & 1)) {   // Change after clean?
+		fullBit (code, newval);
+	    }
+	}
+    }
+    /// Inside dumping routines, dump 1-bit signals with consecutive codes if
+    /// any changed; bit i of newvals is code+i.  Compares all of them at once
+    /// against their last values, which a full dump invalidates.
+    inline void chgBits (vluint32_t code, const vluint32_t newvals, int count) {
+	vluint64_t packed = (((vluint64_t)m_fullGen)<<32ULL) | newvals;
+	if (VL_UNLIKELY(m_sigs_packedp[code] != packed)) {
+	    m_sigs_packedp[code] = packed;
+	    for (int i=0; i<count; ++i) chgBit(code+i, (newvals>>i) & 1);
+	}
+    }
+    inline void chgBus (vluint32_t code, const vluint32_t newval, int bits) {
+	vluint32_t diff = m_sigs_oldvalp[code] ^ newval;
+	if (VL_UNLIKELY(diff)) {
+	    if (VL_UNLIKELY(bits==32 || (diff & ((1U<<bits)-1) ))) {
+		fullBus (code, newval, bits);
+	    }
+	}
+    }
+    inline void chgQuad (vluint32_t code, const vluint64_t newval, int bits) {
+	vluint64_t diff = (*((vluint64_t*)&m_sigs_oldvalp[code])) ^ newval;
+	if (VL_UNLIKELY(diff)) {
+	    if (VL_UNLIKELY(bits==64 || (diff & ((1ULL<<bits)-1) ))) {
+		fullQuad(code, newval, bits);
+	    }
+	}
+    }
+    inline void chgArray (vluint32_t code, const vluint32_t* newval, int bits) {
+	for (int word=0; word<(((bits-1)/32)+1); ++word) {
+	    if (VL_UNLIKELY(m_sigs_oldvalp[code+word] ^ newval[word])) {
+		fullArray (code,newval,bits);
+		return;
+	    }
+	}
+    }
+    inline void chgTriBit (vluint32_t code, const vluint32_t newval, const vluint32_t newtri) {
+	vluint32_t diff = ((m_sigs_oldvalp[code] ^ newval)
+			 | (m_sigs_oldvalp[code+1] ^ newtri));
+	if (VL_UNLIKELY(diff)) {
+	    if (VL_UNLIKELY(diff & 1)) {   // Change after clean?
+		fullTriBit (code, newval, newtri);
+	    }
+	}
+    }
+    inline void chgTriBus (vluint32_t code, const vluint32_t newval, const vluint32_t newtri, int bits) {
+	vluint32_t diff = ((m_sigs_oldvalp[code] ^ newval)
+			 | (m_sigs_oldvalp[code+1] ^ newtri));
+	if (VL_UNLIKELY(diff)) {
+	    if (VL_UNLIKELY(bits==32 || (diff & ((1U<<bits)-1) ))) {
+		fullTriBus (code, newval, newtri, bits);
+	    }
+	}
+    }
+    inline void chgTriQuad (vluint32_t code, const vluint64_t newval, const vluint32_t newtri, int bits) {
+	vluint64_t diff = ( ((*((vluint64_t*)&m_sigs_oldvalp[code])) ^ newval)
+			  | ((*((vluint64_t*)&m_sigs_oldvalp[code+1])) ^ newtri));
+	if (VL_UNLIKELY(diff)) {
+	    if (VL_UNLIKELY(bits==64 || (diff & ((1ULL<<bits)-1) ))) {
+		fullTriQuad(code, newval, newtri, bits);
+	    }
+	}
+    }
+    inline void chgTriArray (vluint32_t code, const vluint32_t* newvalp, const vluint32_t* newtrip, int bits) {
+	for (int word=0; word<(((bits-1)/32)+1); ++word) {
+	    if (VL_UNLIKELY((m_sigs_oldvalp[code+word*2] ^ newvalp[word])
+			    | (m_sigs_oldvalp[code+word*2+1] ^ newtrip[word]))) {
+		fullTriArray (code,newvalp,newtrip,bits);
+		return;
+	    }
+	}
+    }
+    inline void chgDouble (vluint32_t code, const double newval) {
+	// cppcheck-suppress invalidPointerCast
+	if (VL_UNLIKELY((*((double*)&m_sigs_oldvalp[code])) != newval)) {
+	    fullDouble (code, newval);
+	}
+    }
+    inline void chgFloat (vluint32_t code, const float newval) {
+	// cppcheck-suppress invalidPointerCast
+	if (VL_UNLIKELY((*((float*)&m_sigs_oldvalp[code])) != newval)) {
+	    fullFloat (code, newval);
+	}
+    }
+};
+
+//=============================================================================
+// VerilatedBinC
+/// Create a binary trace file in C standalone (no SystemC) simulations.
+
+class VerilatedBinC {
+    VerilatedBin		m_sptrace;	///< Trace file being created
+public:
+    // CONSTRUCTORS
+    explicit VerilatedBinC(VerilatedVcdFile* filep=NULL) : m_sptrace(filep) {}
+    ~VerilatedBinC() {}
+    // ACCESSORS
+    /// Is file open?
+    bool isOpen() const { return m_sptrace.isOpen(); }
+    // METHODS
+    /// Open a new binary trace file
+    void open (const char* filename) { m_sptrace.open(filename); }
+    /// Close dump
+    void close() { m_sptrace.close(); }
+    /// Flush dump
+    void flush() { m_sptrace.flush(); }
+    /// Write one cycle of dump data
+    void dump (vluint64_t timeui) { m_sptrace.dump(timeui); }
+    /// Write one cycle of dump data - backward compatible and to reduce
+    /// conversion warnings.  It's better to use a vluint64_t time instead.
+    void dump (double timestamp) { dump((vluint64_t)timestamp); }
+    void dump (vluint32_t timestamp) { dump((vluint64_t)timestamp); }
+    void dump (int timestamp) { dump((vluint64_t)timestamp); }
+    /// Dump only at times startTime <= time < stopTime; the first dump
+    /// in the window writes all values.  Outside it dump() just returns.
+    void dumpWindow (vluint64_t startTime, vluint64_t stopTime) { m_sptrace.dumpWindow(startTime, stopTime); }
+    /// Dump at all times (the default)
+    void dumpOn () { m_sptrace.dumpOn(); }
+    /// Stop dumping until dumpOn() or dumpWindow()
+    void dumpOff () { m_sptrace.dumpOff(); }
+    /// Skip dumps when no traced model was evaluated; see VerilatedBin::dumpIdle
+    void dumpIdle (bool flag) { m_sptrace.dumpIdle(flag); }
+    /// Set time units (s/ms, defaults to ns)
+    void set_time_unit (const char* unit) { m_sptrace.set_time_unit(unit); }
+    void set_time_unit (const string& unit) { set_time_unit(unit.c_str()); }
+    /// Set time resolution (s/ms, defaults to ns)
+    void set_time_resolution (const char* unit) { m_sptrace.set_time_resolution(unit); }
+    void set_time_resolution (const string& unit) { set_time_resolution(unit.c_str()); }
+
+    /// Internal class access
+    inline VerilatedBin* spTrace () { return &m_sptrace; };
+};
+
+#endif // guard
@@ -0,0 +1,49 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//=============================================================================
+//
+// THIS MODULE IS PUBLICLY LICENSED
+//
+// Copyright 2017 by Wilson Snyder.  This program is free software;
+// you can redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License Version 2.0.
+//
+// This is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+//=============================================================================
+///
+/// \file
+/// \brief Verilator tracing in binary format, from SystemC
+///
+///	Requires verilated_vcd_sc.cpp and verilated_bin_c.cpp to be linked in.
+///
+//=============================================================================
+
+#ifndef _VERILATED_BIN_SC_H_
+#define _VERILATED_BIN_SC_H_ 1
+
+#include "verilated_vcd_sc.h"
+#include "verilated_bin_c.h"
+
+//=============================================================================
+// VerilatedBinSc
+///
+/// This class is passed to the SystemC simulation kernel, just like a
+/// documented SystemC trace format, for models Verilated with --trace-bin.
+
+class VerilatedBinSc
+    : VerilatedScTraceFile
+    , public VerilatedBinC
+{
+public:
+    VerilatedBinSc() {
+	scSetup(spTrace());
+    }
+    virtual ~VerilatedBinSc() {}
+protected:
+    virtual void scDump(double timestamp) { this->dump(timestamp); }
+};
+
+#endif // guard
@@ -0,0 +1,162 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//=============================================================================
+//
+// THIS MODULE IS PUBLICLY LICENSED
+//
+// Copyright 2017 by Wilson Snyder.  This program is free software;
+// you can redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License Version 2.0.
+//
+// This is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+//=============================================================================
+///
+/// \file
+/// \brief Evaluation of several interconnected models in one process
+///
+//=============================================================================
+
+#include "verilatedos.h"
+#include "verilated.h"
+#include "verilated_board.h"
+
+#include <algorithm>
+#include <cstring>
+
+//=============================================================================
+// VerilatedBoard
+
+int VerilatedBoard::modelIndex(const void* modelp) const {
+    for (size_t i = 0; i < m_models.size(); ++i) {
+	if (m_models[i].m_modelp == modelp) return i;
+    }
+    return -1;
+}
+
+int VerilatedBoard::addModelCb(void* modelp, EvalCb evalCb) {
+    int model = modelIndex(modelp);
+    if (model >= 0) return model;
+    Model m;
+    m.m_modelp = modelp;
+    m.m_evalCb = evalCb;
+    m_models.push_back(m);
+    m_ordered = false;
+    return m_models.size() - 1;
+}
+
+void VerilatedBoard::connect(const void* fromModelp, const void* fromp,
+			     const void* toModelp, void* top, size_t bytes) {
+    int from = modelIndex(fromModelp);
+    int to = modelIndex(toModelp);
+    if (VL_UNLIKELY(from < 0 || to < 0)) {
+	vl_fatal(__FILE__,__LINE__,"","VerilatedBoard::connect of a model not added");
+    }
+    Conn c;
+    c.m_from = from;
+    c.m_fromp = fromp;
+    c.m_top = top;
+    c.m_bytes = bytes;
+    m_conns.push_back(c);
+    m_models[to].m_conns.push_back(m_conns.size() - 1);
+    m_ordered = false;
+}
+
+int VerilatedBoard::orderVisit(int model, vector<int>& indexes, vector<int>& lows,
+			       vector<int>& stack, vector<bool>& stacked, int& next) {
+    // Tarjan's strongly connected components, over edges from each model
+    // to the models driving it, so each group completes after its drivers
+    indexes[model] = lows[model] = next++;
+    stack.push_back(model);
+    stacked[model] = true;
+    const vector<int>& conns = m_models[model].m_conns;
+    for (size_t i = 0; i < conns.size(); ++i) {
+	int from = m_conns[conns[i]].m_from;
+	if (indexes[from] < 0) {
+	    lows[model] = min(lows[model], orderVisit(from, indexes, lows, stack, stacked, next));
+	} else if (stacked[from]) {
+	    lows[model] = min(lows[model], indexes[from]);
+	}
+    }
+    if (lows[model] == indexes[model]) {
+	vector<int> group;
+	int member;
+	do {
+	    member = stack.back();
+	    stack.pop_back();
+	    stacked[member] = false;
+	    group.push_back(member);
+	} while (member != model);
+	sort(group.begin(), group.end());  // Loops evaluate in the order added
+	bool loops = group.size() > 1;
+	for (size_t i = 0; i < conns.size(); ++i) {
+	    if (m_conns[conns[i]].m_from == model) loops = true;  // Drives itself
+	}
+	m_groups.push_back(group);
+	m_groupLoops.push_back(loops);
+    }
+    return lows[model];
+}
+
+void VerilatedBoard::order() {
+    m_groups.clear();
+    m_groupLoops.clear();
+    vector<int> indexes (m_models.size(), -1);
+    vector<int> lows (m_models.size(), -1);
+    vector<int> stack;
+    vector<bool> stacked (m_models.size(), false);
+    int next = 0;
+    for (size_t model = 0; model < m_models.size(); ++model) {
+	if (indexes[model] < 0) orderVisit(model, indexes, lows, stack, stacked, next);
+    }
+    m_ordered = true;
+}
+
+void VerilatedBoard::copyInputs(int model) {
+    const vector<int>& conns = m_models[model].m_conns;
+    for (size_t i = 0; i < conns.size(); ++i) {
+	const Conn& c = m_conns[conns[i]];
+	memcpy(c.m_top, c.m_fromp, c.m_bytes);
+    }
+}
+
+bool VerilatedBoard::inputsDiffer(const vector<int>& group) const {
+    for (size_t g = 0; g < group.size(); ++g) {
+	const vector<int>& conns = m_models[group[g]].m_conns;
+	for (size_t i = 0; i < conns.size(); ++i) {
+	    const Conn& c = m_conns[conns[i]];
+	    if (memcmp(c.m_top, c.m_fromp, c.m_bytes)) return true;
+	}
+    }
+    return false;
+}
+
+void VerilatedBoard::eval() {
+    if (VL_UNLIKELY(!m_ordered)) order();
+    // Every model first sees the connections as they were before this
+    // eval, so flops on a clock shared between models all sample their
+    // inputs from before the edge, rather than a driver's new outputs
+    for (size_t model = 0; model < m_models.size(); ++model) copyInputs(model);
+    for (size_t g = 0; g < m_groups.size(); ++g) {
+	const vector<int>& group = m_groups[g];
+	for (size_t i = 0; i < group.size(); ++i) {
+	    m_models[group[i]].m_evalCb(m_models[group[i]].m_modelp);
+	}
+    }
+    // Then propagate the outputs that changed, in order, until loops are stable
+    for (size_t g = 0; g < m_groups.size(); ++g) {
+	const vector<int>& group = m_groups[g];
+	int passes = 0;
+	while (inputsDiffer(group)) {
+	    if (VL_UNLIKELY(++passes > m_loopLimit)) {
+		vl_fatal(__FILE__,__LINE__,"","VerilatedBoard models connected in a loop didn't converge");
+	    }
+	    for (size_t i = 0; i < group.size(); ++i) {
+		copyInputs(group[i]);
+		m_models[group[i]].m_evalCb(m_models[group[i]].m_modelp);
+	    }
+	}
+    }
+}
@@ -0,0 +1,107 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//=============================================================================
+//
+// THIS MODULE IS PUBLICLY LICENSED
+//
+// Copyright 2017 by Wilson Snyder.  This program is free software;
+// you can redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License Version 2.0.
+//
+// This is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+//=============================================================================
+///
+/// \file
+/// \brief Evaluation of several interconnected models in one process
+///
+///	A VerilatedBoard holds models, possibly of different Verilated
+///	classes, and the connections from each model's outputs to other
+///	models' inputs.  From the connections it computes, once, the order
+///	to evaluate the models in, so each model is evaluated after the
+///	models driving it.  eval() first evaluates every model on its
+///	connections from before the eval, so flops clocked together across
+///	models see values from before the edge.  It then copies the
+///	connections that changed and reevaluates the models reading them,
+///	in order, so combinational paths settle in one more ordered pass.
+///
+///	Models connected in a loop, for example through combinational
+///	paths both ways, are evaluated together, repeating until the
+///	connections between them are stable.
+///
+//=============================================================================
+
+#ifndef _VERILATED_BOARD_H_
+#define _VERILATED_BOARD_H_ 1
+
+#include "verilatedos.h"
+#include "verilated.h"
+
+#include <vector>
+using namespace std;
+
+//=============================================================================
+// VerilatedBoard - models evaluated together in connection order
+
+class VerilatedBoard {
+    // TYPES
+    typedef void (*EvalCb)(void* modelp);
+    struct Model {
+	void*		m_modelp;	///< Model
+	EvalCb		m_evalCb;	///< Calls the model's eval()
+	vector<int>	m_conns;	///< Connections into the model
+    };
+    struct Conn {
+	int		m_from;		///< Model driving it
+	const void*	m_fromp;	///< Output of that model
+	void*		m_top;		///< Input of the model reading it
+	size_t		m_bytes;	///< Size of signal
+    };
+    template <class T> static void evalCb(void* modelp) { static_cast<T*>(modelp)->eval(); }
+
+    // MEMBERS
+    vector<Model>	m_models;	///< Models, in order added
+    vector<Conn>	m_conns;	///< Connections, in order added
+    vector<vector<int> > m_groups;	///< Models evaluated together, in evaluation order
+    vector<bool>	m_groupLoops;	///< Each group is connected in a loop
+    bool		m_ordered;	///< m_groups is up to date
+    int			m_loopLimit;	///< Most passes over a loop before giving up
+
+    // METHODS
+    int modelIndex(const void* modelp) const;
+    int addModelCb(void* modelp, EvalCb evalCb);
+    void order();
+    int orderVisit(int model, vector<int>& indexes, vector<int>& lows,
+		   vector<int>& stack, vector<bool>& stacked, int& next);
+    void copyInputs(int model);
+    bool inputsDiffer(const vector<int>& group) const;
+private:
+    VerilatedBoard(const VerilatedBoard&);	///< N/A, no copy constructor
+    VerilatedBoard& operator=(const VerilatedBoard&);	///< N/A, no assignment
+public:
+    // CREATORS
+    VerilatedBoard() : m_ordered(false), m_loopLimit(100) {}
+    ~VerilatedBoard() {}
+    // METHODS
+    /// Add a model, which the board evaluates but doesn't own.  Returns its index
+    template <class T> int addModel(T* modelp) { return addModelCb(modelp, &evalCb<T>); }
+    /// Connect an output of one added model to an input of another
+    void connect(const void* fromModelp, const void* fromp,
+		 const void* toModelp, void* top, size_t bytes);
+    /// Evaluate every model, then propagate changes in connection order, and any loops until stable
+    void eval();
+    /// Most passes over models connected in a loop, before it's a fatal error
+    void loopLimit(int limit) { m_loopLimit = limit; }
+    /// Number of groups of models evaluated together; fewer than models when there are loops
+    size_t groups() { if (!m_ordered) order(); return m_groups.size(); }
+};
+
+/// Connect a port of one model to the port of the same size of another,
+/// for example VL_BOARD_CONNECT(board, cpup, mem_addr, memp, addr)
+#define VL_BOARD_CONNECT(board, fromModelp, fromPort, toModelp, toPort) \
+    (board).connect((fromModelp), &(fromModelp)->fromPort, \
+		    (toModelp), &(toModelp)->toPort, sizeof((toModelp)->toPort))
+
+#endif  // guard
@@ -26,8 +26,20 @@
 
 #include <map>
 #include <deque>
+#include <vector>
 #include <fstream>
 
+//=============================================================================
+// Locking
+//
+//   Models insert their points when constructed, perhaps on several threads
+//   at once, so the tables are locked.  A point is inserted by a _inserti,
+//   _insertf, _insertp sequence, so the lock is held from the first to the
+//   last.  Counters are incremented by the models directly, never locked;
+//   points of identically named instances are summed as they're written.
+
+static VerilatedMutex s_covMutex;	///< Protects VerilatedCovImp
+
 //=============================================================================
 // VerilatedCovImpBase
 /// Implementation base class for constants
@@ -40,45 +52,28 @@ struct VerilatedCovImpBase {
 
 //=============================================================================
 // VerilatedCovImpItem
-/// Implementation class for a VerilatedCov item
+/// Implementation class for a VerilatedCov item.
+/// Items are held by value, with their value numbers packed into one shared
+/// vector and their keys in a shared key table, as there may be millions of them.
 
 class VerilatedCovImpItem : VerilatedCovImpBase {
 public:  // But only local to this file
     // MEMBERS
-    int	m_keys[MAX_KEYS];		///< Key
-    int	m_vals[MAX_KEYS];		///< Value for specified key
+    void*	m_countp;		///< Count value, vluint32_t or vluint64_t
+    bool	m_wide;			///< Count is vluint64_t
+    vluint32_t	m_keyTable;		///< Index of keys in VerilatedCovImp::m_keyTables
+    size_t	m_valStart;		///< First value in VerilatedCovImp::m_vals
     // CONSTRUCTORS
-    // Derived classes should call zero() in their constructor
-    VerilatedCovImpItem() {
-	for (int i=0; i<MAX_KEYS; ++i) {
-	    m_keys[i]=KEY_UNDEF;
-	    m_vals[i]=0;
-	}
-    }
-    virtual ~VerilatedCovImpItem() {}
-    virtual vluint64_t count() const = 0;
-    virtual void zero() const = 0;
-};
-
-//=============================================================================
-/// VerilatedCoverItem templated for a specific class
-/// Creates a new coverage item for the specified type.
-/// This isn't in the header file for auto-magic conversion because it
-/// inlines to too much code and makes compilation too slow.
-
-template <class T> class VerilatedCoverItemSpec : public VerilatedCovImpItem {
-private:
-    // MEMBERS
-    T*	m_countp;	///< Count value
-public:
+    VerilatedCovImpItem(void* countp, bool wide)
+	: m_countp(countp), m_wide(wide), m_keyTable(0), m_valStart(0) {}
     // METHODS
-    // cppcheck-suppress truncLongCastReturn
-    virtual vluint64_t count() const { return *m_countp; }
-    virtual void zero() const { *m_countp = 0; }
-    // CONSTRUCTORS
-    // cppcheck-suppress noExplicitConstructor
-    VerilatedCoverItemSpec(T* countp) : m_countp(countp) { zero(); }
-    virtual ~VerilatedCoverItemSpec() {}
+    vluint64_t count() const {
+	return m_wide ? *((vluint64_t*)m_countp) : *((vluint32_t*)m_countp); }
+    void zero() const {
+	if (m_wide) *((vluint64_t*)m_countp) = 0;
+	else *((vluint32_t*)m_countp) = 0;
+    }
+    size_t countBytes() const { return m_wide ? sizeof(vluint64_t) : sizeof(vluint32_t); }
 };
 
 //=============================================================================
@@ -90,25 +85,35 @@ public:
 class VerilatedCovImp : VerilatedCovImpBase {
 private:
     // TYPES
-    typedef map<string,int> ValueIndexMap;
-    typedef map<int,string> IndexValueMap;
-    typedef deque<VerilatedCovImpItem*> ItemList;
+    typedef vector<string> IndexValueList;
+    typedef vector<vluint32_t> KeyList;
+    typedef map<KeyList,vluint32_t> KeyTableMap;
+    typedef deque<VerilatedCovImpItem> ItemList;
 
 private:
     // MEMBERS
-    ValueIndexMap	m_valueIndexes;		///< For each key/value a unique arbitrary index value
-    IndexValueMap	m_indexValues;		///< For each key/value a unique arbitrary index value
+    IndexValueList	m_indexValues;		///< For each key/value number, its string
+    vector<vluint32_t>	m_valueHash;		///< Open hash of m_indexValues numbers, 0=empty
+    vector<KeyList>	m_keyTables;		///< Distinct lists of key numbers
+    KeyTableMap		m_keyTableIndexes;	///< Index of each m_keyTables entry
+    KeyList		m_insertKeys;		///< Keys of item about to insert
+    vector<vluint32_t>	m_vals;			///< Value numbers of all items, in key order
     ItemList		m_items;		///< List of all items
 
-    VerilatedCovImpItem*	m_insertp;	///< Item about to insert
+    VerilatedCovImpItem	m_insert;		///< Item about to insert
+    bool		m_inserting;		///< m_insert is set
     const char*		m_insertFilenamep;	///< Filename about to insert
     int			m_insertLineno;		///< Line number about to insert
+    const char*		m_pageFilenamep;	///< Filename m_pageDefault is for
+    string		m_pageDefault;		///< Default page of m_pageFilenamep
 
     // CONSTRUCTORS
-    VerilatedCovImp() {
-	m_insertp = NULL;
+    VerilatedCovImp() : m_insert(NULL, false) {
+	m_inserting = false;
 	m_insertFilenamep = NULL;
 	m_insertLineno = 0;
+	m_pageFilenamep = NULL;
+	clear();
     }
 public:
     ~VerilatedCovImp() { clear(); }
@@ -119,140 +124,129 @@ public:
 
 private:
     // PRIVATE METHODS
-    int valueIndex(const string& value) {
-	static int nextIndex = KEY_UNDEF+1;
-	ValueIndexMap::iterator iter = m_valueIndexes.find(value);
-	if (iter != m_valueIndexes.end()) return iter->second;
-	nextIndex++;  assert(nextIndex>0);
-	m_valueIndexes.insert(make_pair(value, nextIndex));
-	m_indexValues.insert(make_pair(nextIndex, value));
-	return nextIndex;
+    static vluint32_t valueHash(const char* valuep) {
+	vluint32_t hash = 2166136261UL;  // FNV-1a
+	for (const char* cp = valuep; *cp; ++cp) hash = (hash ^ (vluint8_t)(*cp)) * 16777619UL;
+	return hash;
     }
-    string dequote(const string& text) {
-	// Quote any special characters
-	string rtn;
-	for (const char* pos = text.c_str(); *pos; ++pos) {
-	    if (!isprint(*pos) || *pos=='%' || *pos=='"') {
-		char hex[10]; sprintf(hex,"%%%02X",pos[0]);
-		rtn += hex;
-	    } else {
-		rtn += *pos;
-	    }
+    void valueHashInsert(vluint32_t index) {
+	size_t mask = m_valueHash.size()-1;
+	size_t slot = valueHash(m_indexValues[index].c_str()) & mask;
+	while (m_valueHash[slot] != KEY_UNDEF) slot = (slot+1) & mask;
+	m_valueHash[slot] = index;
+    }
+    int valueIndex(const char* valuep) {
+	// Called for every key and value of every point, so no string is built to look up
+	size_t mask = m_valueHash.size()-1;
+	for (size_t slot = valueHash(valuep) & mask; ; slot = (slot+1) & mask) {
+	    vluint32_t index = m_valueHash[slot];
+	    if (index == KEY_UNDEF) break;
+	    if (0==strcmp(m_indexValues[index].c_str(), valuep)) return index;
 	}
-	return rtn;
+	vluint32_t index = m_indexValues.size();
+	m_indexValues.push_back(valuep);
+	if (m_indexValues.size()*2 > m_valueHash.size()) {
+	    m_valueHash.assign(m_valueHash.size()*2, KEY_UNDEF);
+	    for (vluint32_t i=KEY_UNDEF+1; i<m_indexValues.size(); ++i) valueHashInsert(i);
+	} else {
+	    valueHashInsert(index);
+	}
+	return index;
     }
-    bool legalKey(const string& key) {
+    bool legalKey(const char* keyp) {
 	// Because we compress long keys to a single letter, and
 	// don't want applications to either get confused if they use
 	// a letter differently, nor want them to rely on our compression...
 	// (Considered using numeric keys, but will remain back compatible.)
-	if (key.length()<2) return false;
-	if (key.length()==2 && isdigit(key[1])) return false;
+	size_t len = strlen(keyp);
+	if (len<2) return false;
+	if (len==2 && isdigit(keyp[1])) return false;
 	return true;
     }
-    string keyValueFormatter (const string& key, const string& value) {
-	string name;
-	if (key.length()==1 && isalpha(key[0])) {
-	    name += string("\001")+key;
-	} else {
-	    name += string("\001")+dequote(key);
-	}
-	name += string("\002")+dequote(value);
-	return name;
-    }
-    string combineHier (const string& old, const string& add) {
-	// (foo.a.x, foo.b.x) => foo.*.x
-	// (foo.a.x, foo.b.y) => foo.*
-	// (foo.a.x, foo.b)   => foo.*
-	if (old == add) return add;
-	if (old == "") return add;
-	if (add == "") return old;
-
-	const char* a = old.c_str();
-	const char* b = add.c_str();
-
-	// Scan forward to first mismatch
-	const char* apre = a;
-	const char* bpre = b;
-	while (*apre == *bpre) { apre++; bpre++; }
-
-	// We used to backup and split on only .'s but it seems better to be verbose
-	// and not assume . is the separator
-	string prefix = string(a,apre-a);
-
-	// Scan backward to last mismatch
-	const char* apost = a+strlen(a)-1;
-	const char* bpost = b+strlen(b)-1;
-	while (*apost == *bpost
-	       && apost>apre && bpost>bpre) { apost--; bpost--; }
-
-	// Forward to . so we have a whole word
-	string suffix = *bpost ? string(bpost+1) : "";
-
-	string out = prefix+"*"+suffix;
-
-	//cout << "\nch pre="<<prefix<<"  s="<<suffix<<"\nch a="<<old<<"\nch b="<<add<<"\nch o="<<out<<endl;
-	return out;
-    }
-    bool itemMatchesString(VerilatedCovImpItem* itemp, const string& match) {
-	for (int i=0; i<MAX_KEYS; ++i) {
-	    if (itemp->m_keys[i] != KEY_UNDEF) {
-		// We don't compare keys, only values
-		string val = m_indexValues[itemp->m_vals[i]];
-		if (string::npos != val.find(match)) {  // Found
-		    return true;
-		}
+    bool itemMatchesString(const VerilatedCovImpItem& item, const string& match) {
+	for (size_t i=0; i<m_keyTables[item.m_keyTable].size(); ++i) {
+	    // We don't compare keys, only values
+	    const string& val = m_indexValues[m_vals[item.m_valStart + i]];
+	    if (string::npos != val.find(match)) {  // Found
+		return true;
 	    }
 	}
 	return false;
     }
     void selftest() {
 	// Little selftest
-	if (combineHier ("a.b.c","a.b.c")	!="a.b.c") vl_fatal(__FILE__,__LINE__,"","%Error: selftest\n");
-	if (combineHier ("a.b.c","a.b")		!="a.b*") vl_fatal(__FILE__,__LINE__,"","%Error: selftest\n");
-	if (combineHier ("a.x.c","a.y.c")	!="a.*.c") vl_fatal(__FILE__,__LINE__,"","%Error: selftest\n");
-	if (combineHier ("a.z.z.z.c","a.b.c")	!="a.*.c") vl_fatal(__FILE__,__LINE__,"","%Error: selftest\n");
-	if (combineHier ("z","a")		!="*") vl_fatal(__FILE__,__LINE__,"","%Error: selftest\n");
-	if (combineHier ("q.a","q.b")		!="q.*") vl_fatal(__FILE__,__LINE__,"","%Error: selftest\n");
-	if (combineHier ("q.za","q.zb")		!="q.z*") vl_fatal(__FILE__,__LINE__,"","%Error: selftest\n");
-	if (combineHier ("1.2.3.a","9.8.7.a")	!="*.a") vl_fatal(__FILE__,__LINE__,"","%Error: selftest\n");
+	if (VerilatedCovKey::combineHier ("a.b.c","a.b.c")	!="a.b.c") vl_fatal(__FILE__,__LINE__,"","%Error: selftest\n");
+	if (VerilatedCovKey::combineHier ("a.b.c","a.b")	!="a.b*") vl_fatal(__FILE__,__LINE__,"","%Error: selftest\n");
+	if (VerilatedCovKey::combineHier ("a.x.c","a.y.c")	!="a.*.c") vl_fatal(__FILE__,__LINE__,"","%Error: selftest\n");
+	if (VerilatedCovKey::combineHier ("a.z.z.z.c","a.b.c")	!="a.*.c") vl_fatal(__FILE__,__LINE__,"","%Error: selftest\n");
+	if (VerilatedCovKey::combineHier ("z","a")		!="*") vl_fatal(__FILE__,__LINE__,"","%Error: selftest\n");
+	if (VerilatedCovKey::combineHier ("q.a","q.b")		!="q.*") vl_fatal(__FILE__,__LINE__,"","%Error: selftest\n");
+	if (VerilatedCovKey::combineHier ("q.za","q.zb")	!="q.z*") vl_fatal(__FILE__,__LINE__,"","%Error: selftest\n");
+	if (VerilatedCovKey::combineHier ("1.2.3.a","9.8.7.a")	!="*.a") vl_fatal(__FILE__,__LINE__,"","%Error: selftest\n");
+    }
+    vluint32_t keyTableIndex(const KeyList& keys) {
+	// Consecutive points nearly always have the same keys
+	if (!m_keyTables.empty() && m_keyTables.back() == keys) return m_keyTables.size()-1;
+	KeyTableMap::iterator it = m_keyTableIndexes.find(keys);
+	if (it != m_keyTableIndexes.end()) return it->second;
+	vluint32_t index = m_keyTables.size();
+	m_keyTables.push_back(keys);
+	m_keyTableIndexes.insert(make_pair(keys, index));
+	return index;
+    }
+    void writeU32(ofstream& os, vluint32_t value) {
+	os.write((const char*)&value, sizeof(value));
+    }
+    void writeVarU32(ofstream& os, vluint32_t value) {
+	// 7 bits per byte, high bit set on all but the last
+	while (value >= 0x80) { os.put((char)(value | 0x80)); value >>= 7; }
+	os.put((char)value);
     }
 
 public:
     // PUBLIC METHODS
     void clear() {
-	for (ItemList::iterator it=m_items.begin(); it!=m_items.end(); ++it) {
-	    VerilatedCovImpItem* itemp = *(it);
-	    delete itemp;
-	}
+	m_inserting = false;
 	m_items.clear();
+	m_keyTables.clear();
+	m_keyTableIndexes.clear();
+	m_vals.clear();
 	m_indexValues.clear();
-	m_valueIndexes.clear();
+	m_indexValues.push_back("");  // KEY_UNDEF
+	m_valueHash.assign(1024, KEY_UNDEF);
     }
     void clearNonMatch (const char* matchp) {
 	if (matchp && matchp[0]) {
 	    ItemList newlist;
 	    for (ItemList::iterator it=m_items.begin(); it!=m_items.end(); ++it) {
-		VerilatedCovImpItem* itemp = *(it);
-		if (!itemMatchesString(itemp, matchp)) {
-		    delete itemp;
-		} else {
-		    newlist.push_back(itemp);
+		if (itemMatchesString(*it, matchp)) {
+		    newlist.push_back(*it);
 		}
 	    }
-	    m_items = newlist;
+	    m_items.swap(newlist);
 	}
     }
     void zero() {
-	for (ItemList::iterator it=m_items.begin(); it!=m_items.end(); ++it) {
-	    (*it)->zero();
+	// Generated models keep their counters in one array in the symbol
+	// table, so clear each run of adjacent counters with one memset
+	for (ItemList::iterator it=m_items.begin(); it!=m_items.end(); ) {
+	    const VerilatedCovImpItem& first = *it;
+	    size_t bytes = first.countBytes();
+	    char* nextp = (char*)first.m_countp + bytes;
+	    for (++it; it!=m_items.end() && it->m_wide==first.m_wide
+		     && it->m_countp==nextp; ++it) {
+		nextp += bytes;
+	    }
+	    memset(first.m_countp, 0, nextp - (char*)first.m_countp);
 	}
     }
 
     // We assume there's always call to i/f/p in that order
-    void inserti (VerilatedCovImpItem* itemp) {
-	assert(!m_insertp);
- 	m_insertp = itemp;
+    void inserti (void* countp, bool wide) {
+	assert(!m_inserting);
+	m_insert = VerilatedCovImpItem(countp, wide);
+	m_insert.zero();
+	m_inserting = true;
     }
     void insertf (const char* filenamep, int lineno) {
 	m_insertFilenamep = filenamep;
@@ -260,56 +254,55 @@ public:
     }
     void insertp (const char* ckeyps[MAX_KEYS],
 		  const char* valps[MAX_KEYS]) {
-	assert(m_insertp);
+	assert(m_inserting);
 	// First two key/vals are filename
 	ckeyps[0]="filename";	valps[0]=m_insertFilenamep;
-	string linestr = vlCovCvtToStr(m_insertLineno);
-	ckeyps[1]="lineno";	valps[1]=linestr.c_str();
-	// Default page if not specified
-	const char* fnstartp = m_insertFilenamep;
-	while (const char* foundp = strchr(fnstartp,'/')) fnstartp=foundp+1;
-	const char* fnendp = fnstartp;
-	while (*fnendp && *fnendp!='.') fnendp++;
-	string page_default = "sp_user/"+string(fnstartp,fnendp-fnstartp);
-	ckeyps[2]="page";	valps[2]=page_default.c_str();
+	char linestr[24]; sprintf(linestr, "%d", m_insertLineno);
+	ckeyps[1]="lineno";	valps[1]=linestr;
+	// Default page if not specified; same file as the last point, almost always
+	if (m_pageFilenamep != m_insertFilenamep) {
+	    const char* fnstartp = m_insertFilenamep;
+	    while (const char* foundp = strchr(fnstartp,'/')) fnstartp=foundp+1;
+	    const char* fnendp = fnstartp;
+	    while (*fnendp && *fnendp!='.') fnendp++;
+	    m_pageDefault = "sp_user/"+string(fnstartp,fnendp-fnstartp);
+	    m_pageFilenamep = m_insertFilenamep;
+	}
+	ckeyps[2]="page";	valps[2]=m_pageDefault.c_str();
 
-	// Keys -> strings
-	string keys[MAX_KEYS];
+	// Ignore empty keys
+	const char* keyps[MAX_KEYS];
 	for (int i=0; i<MAX_KEYS; ++i) {
-	    if (ckeyps[i] && ckeyps[i][0]) {
-		keys[i] = ckeyps[i];
-	    }
+	    keyps[i] = (ckeyps[i] && ckeyps[i][0]) ? ckeyps[i] : NULL;
 	}
-	// Ignore empty keys
 	for (int i=0; i<MAX_KEYS; ++i) {
-	    if (keys[i]!="") {
+	    if (keyps[i]) {
 		for (int j=i+1; j<MAX_KEYS; ++j) {
-		    if (keys[i] == keys[j]) {  // Duplicate key.  Keep the last one
-			keys[i] = "";
+		    if (keyps[j] && 0==strcmp(keyps[i], keyps[j])) {  // Duplicate key.  Keep the last one
+			keyps[i] = NULL;
 			break;
 		    }
 		}
 	    }
 	}
 	// Insert the values
-	int addKeynum=0;
+	m_insert.m_valStart = m_vals.size();
+	m_insertKeys.clear();
 	for (int i=0; i<MAX_KEYS; ++i) {
-	    const string key = keys[i];
-	    if (keys[i]!="") {
-		const string val = valps[i];
-		//cout<<"   "<<__FUNCTION__<<"  "<<key<<" = "<<val<<endl;
-		m_insertp->m_keys[addKeynum] = valueIndex(key);
-		m_insertp->m_vals[addKeynum] = valueIndex(val);
-		addKeynum++;
-		if (!legalKey(key)) {
-		    string msg = "%Error: Coverage keys of one character, or letter+digit are illegal: "+key;
+	    if (keyps[i]) {
+		//cout<<"   "<<__FUNCTION__<<"  "<<keyps[i]<<" = "<<valps[i]<<endl;
+		if (!legalKey(keyps[i])) {
+		    string msg = (string)"%Error: Coverage keys of one character, or letter+digit are illegal: "+keyps[i];
 		    vl_fatal("",0,"",msg.c_str());
 		}
+		m_insertKeys.push_back(valueIndex(keyps[i]));
+		m_vals.push_back(valueIndex(valps[i]));
 	    }
 	}
-	m_items.push_back(m_insertp);
+	m_insert.m_keyTable = keyTableIndex(m_insertKeys);
+	m_items.push_back(m_insert);
 	// Prepare for next
-	m_insertp = NULL;
+	m_inserting = false;
     }
 
     void write (const char* filename) {
@@ -326,32 +319,40 @@ public:
 	}
 	os << "# SystemC::Coverage-3\n";
 
+	// Short form of each key, computed once
+	IndexValueList shortKeys (m_indexValues.size());
+	vector<bool> shortDone (m_indexValues.size());
+
 	// Build list of events; totalize if collapsing hierarchy
 	typedef map<string,pair<string,vluint64_t> >	EventMap;
 	EventMap	eventCounts;
 	for (ItemList::iterator it=m_items.begin(); it!=m_items.end(); ++it) {
-	    VerilatedCovImpItem* itemp = *(it);
+	    const VerilatedCovImpItem& item = *it;
 	    string name;
 	    string hier;
 	    bool per_instance = false;
 
-	    for (int i=0; i<MAX_KEYS; ++i) {
-		if (itemp->m_keys[i] != KEY_UNDEF) {
-		    string key = VerilatedCovKey::shortKey(m_indexValues[itemp->m_keys[i]]);
-		    string val = m_indexValues[itemp->m_vals[i]];
-		    if (key == VL_CIK_PER_INSTANCE) {
-			if (val != "0") per_instance = true;
-		    }
-		    if (key == VL_CIK_HIER) {
-			hier = val;
-		    } else {
-			// Print it
-			name += keyValueFormatter(key,val);
-		    }
+	    const KeyList& keys = m_keyTables[item.m_keyTable];
+	    for (size_t i=0; i<keys.size(); ++i) {
+		vluint32_t keyIndex = keys[i];
+		if (!shortDone[keyIndex]) {
+		    shortKeys[keyIndex] = VerilatedCovKey::shortKey(m_indexValues[keyIndex]);
+		    shortDone[keyIndex] = true;
+		}
+		const string& key = shortKeys[keyIndex];
+		const string& val = m_indexValues[m_vals[item.m_valStart + i]];
+		if (key == VL_CIK_PER_INSTANCE) {
+		    if (val != "0") per_instance = true;
+		}
+		if (key == VL_CIK_HIER) {
+		    hier = val;
+		} else {
+		    // Print it
+		    name += VerilatedCovKey::keyValueFormatter(key,val);
 		}
 	    }
 	    if (per_instance) {  // Not collapsing hierarchies
-		name += keyValueFormatter(VL_CIK_HIER,hier);
+		name += VerilatedCovKey::keyValueFormatter(VL_CIK_HIER,hier);
 		hier = "";
 	    }
 
@@ -364,10 +365,10 @@ public:
 	    EventMap::iterator cit = eventCounts.find(name);
 	    if (cit != eventCounts.end()) {
 		const string& oldhier = cit->second.first;
-		cit->second.second += itemp->count();
-		cit->second.first  = combineHier(oldhier, hier);
+		cit->second.second += item.count();
+		cit->second.first  = VerilatedCovKey::combineHier(oldhier, hier);
 	    } else {
-		eventCounts.insert(make_pair(name, make_pair(hier,itemp->count())));
+		eventCounts.insert(make_pair(name, make_pair(hier,item.count())));
 	    }
 	}
 
@@ -375,33 +376,99 @@ public:
 	for (EventMap::iterator it=eventCounts.begin(); it!=eventCounts.end(); ++it) {
 	    os<<"C '"<<dec;
 	    os<<it->first;
-	    if (it->second.first != "") os<<keyValueFormatter(VL_CIK_HIER,it->second.first);
+	    if (it->second.first != "") os<<VerilatedCovKey::keyValueFormatter(VL_CIK_HIER,it->second.first);
 	    os<<"' "<<it->second.second;
 	    os<<endl;
 	}
     }
+
+    void writeBinary (const char* filename) {
+#ifndef VM_COVERAGE
+	vl_fatal("",0,"","%Error: Called VerilatedCov::writeBinary when VM_COVERAGE disabled\n");
+#endif
+	// See VL_COV_BINARY_MAGIC for the layout.  Nothing is formatted or
+	// combined here; verilator_coverage does that when reading.
+	ofstream os (filename, ios::out | ios::binary);
+	if (os.fail()) {
+	    string msg = (string)"%Error: Can't write '"+filename+"'";
+	    vl_fatal("",0,"",msg.c_str());
+	    return;
+	}
+	os.write(VL_COV_BINARY_MAGIC, 8);
+	writeU32(os, VL_COV_BINARY_ORDER);
+	writeU32(os, m_indexValues.size());
+	writeU32(os, m_keyTables.size());
+	writeU32(os, m_items.size());
+	for (size_t i=KEY_UNDEF+1; i<m_indexValues.size(); ++i) {
+	    writeVarU32(os, m_indexValues[i].length());
+	    os.write(m_indexValues[i].data(), m_indexValues[i].length());
+	}
+	for (size_t t=0; t<m_keyTables.size(); ++t) {
+	    writeVarU32(os, m_keyTables[t].size());
+	    for (size_t i=0; i<m_keyTables[t].size(); ++i) writeVarU32(os, m_keyTables[t][i]);
+	}
+	for (ItemList::iterator it=m_items.begin(); it!=m_items.end(); ++it) {
+	    writeVarU32(os, it->m_keyTable);
+	    for (size_t i=0; i<m_keyTables[it->m_keyTable].size(); ++i) {
+		writeVarU32(os, m_vals[it->m_valStart + i]);
+	    }
+	}
+	// Counts are written straight from the model, in runs of adjacent counters
+	for (ItemList::iterator it=m_items.begin(); it!=m_items.end(); ) {
+	    const VerilatedCovImpItem& first = *it;
+	    size_t bytes = first.countBytes();
+	    const char* nextp = (const char*)first.m_countp + bytes;
+	    vluint32_t num = 1;
+	    for (++it; it!=m_items.end() && it->m_wide==first.m_wide
+		     && it->m_countp==nextp; ++it, ++num) {
+		nextp += bytes;
+	    }
+	    writeU32(os, num);
+	    writeU32(os, bytes);
+	    os.write((const char*)first.m_countp, num*bytes);
+	}
+	if (os.fail()) {
+	    string msg = (string)"%Error: Can't write '"+filename+"'";
+	    vl_fatal("",0,"",msg.c_str());
+	}
+    }
 };
 
 //=============================================================================
 // VerilatedCov
 
 void VerilatedCov::clear() {
+    s_covMutex.lock();
     VerilatedCovImp::imp().clear();
+    s_covMutex.unlock();
 }
 void VerilatedCov::clearNonMatch (const char* matchp) {
+    s_covMutex.lock();
     VerilatedCovImp::imp().clearNonMatch(matchp);
+    s_covMutex.unlock();
 }
 void VerilatedCov::zero() {
+    s_covMutex.lock();
     VerilatedCovImp::imp().zero();
+    s_covMutex.unlock();
 }
 void VerilatedCov::write (const char* filenamep) {
-    VerilatedCovImp::imp().write(filenamep);
+    s_covMutex.lock();
+    VerilatedCovImp::imp().write(Verilated::forkFilename(filenamep));
+    s_covMutex.unlock();
+}
+void VerilatedCov::writeBinary (const char* filenamep) {
+    s_covMutex.lock();
+    VerilatedCovImp::imp().writeBinary(Verilated::forkFilename(filenamep));
+    s_covMutex.unlock();
 }
 void VerilatedCov::_inserti (vluint32_t* itemp) {
-    VerilatedCovImp::imp().inserti(new VerilatedCoverItemSpec<vluint32_t>(itemp));
+    s_covMutex.lock();  // Until _insertp
+    VerilatedCovImp::imp().inserti(itemp, false);
 }
 void VerilatedCov::_inserti (vluint64_t* itemp) {
-    VerilatedCovImp::imp().inserti(new VerilatedCoverItemSpec<vluint64_t>(itemp));
+    s_covMutex.lock();  // Until _insertp
+    VerilatedCovImp::imp().inserti(itemp, true);
 }
 void VerilatedCov::_insertf (const char* filename, int lineno) {
     VerilatedCovImp::imp().insertf(filename,lineno);
@@ -425,6 +492,7 @@ void VerilatedCov::_insertp (A(0),A(1),A(2),A(3),A(4),A(5),A(6),A(7),A(8),A(9),
 	   val10,val11,val12,val13,val14,val15,val16,val17,val18,val19,
 	   val20,val21,val22,val23,val24,val25,val26,val27,val28,val29};
     VerilatedCovImp::imp().insertp(keyps, valps);
+    s_covMutex.unlock();  // From _inserti
 }
 
 // And versions with fewer arguments  (oh for a language with named parameters!)
@@ -442,10 +510,11 @@ void VerilatedCov::_insertp (A(0),A(1),A(2),A(3),A(4),A(5),A(6),A(7),A(8),A(9),
 // Backward compatibility for Verilator
 void VerilatedCov::_insertp (A(0), A(1),  K(2),int val2,  K(3),int val3,
 			     K(4),const string& val4,  A(5),A(6)) {
-    string val2str = vlCovCvtToStr(val2);
-    string val3str = vlCovCvtToStr(val3);
+    // Called for every point Verilator inserts, so avoid ostringstream
+    char val2str[24]; sprintf(val2str, "%d", val2);
+    char val3str[24]; sprintf(val3str, "%d", val3);
     _insertp(C(0),C(1),
-	     key2,val2str.c_str(),  key3,val3str.c_str(),  key4, val4.c_str(),
+	     key2,val2str,  key3,val3str,  key4, val4.c_str(),
 	     C(5),C(6),N(7),N(8),N(9),
 	     N(10),N(11),N(12),N(13),N(14),N(15),N(16),N(17),N(18),N(19),
 	     N(20),N(21),N(22),N(23),N(24),N(25),N(26),N(27),N(28),N(29));
@@ -89,8 +89,12 @@ public:
     // GLOBAL METHODS
     /// Return default filename
     static const char* defaultFilename() { return "coverage.dat"; }
-    /// Write all coverage data to a file
+    /// Write all coverage data to a file; in a Verilated::forkChild() child,
+    /// the file is named by Verilated::forkFilename()
     static void write (const char* filenamep = defaultFilename());
+    /// Write all coverage data to a file in binary form; much faster for large
+    /// designs, and verilator_coverage reads either form
+    static void writeBinary (const char* filenamep = defaultFilename());
     /// Insert a coverage item
     /// We accept from 1-30 key/value pairs, all as strings.
     /// Call _insert1, followed by _insert2 and _insert3
@@ -24,6 +24,9 @@
 
 #include "verilatedos.h"
 
+#include <cctype>
+#include <cstdio>
+#include <cstring>
 #include <string>
 using namespace std;
 
@@ -140,6 +143,80 @@ public:
 	// VLCOVGEN_SHORT_AUTO_EDIT_END
 	return key;
     }
+    static string dequote(const string& text) {
+	// Quote any special characters
+	string rtn;
+	for (const char* pos = text.c_str(); *pos; ++pos) {
+	    if (!isprint(*pos) || *pos=='%' || *pos=='"') {
+		char hex[10]; sprintf(hex,"%%%02X",pos[0]);
+		rtn += hex;
+	    } else {
+		rtn += *pos;
+	    }
+	}
+	return rtn;
+    }
+    static string keyValueFormatter(const string& key, const string& value) {
+	string name;
+	if (key.length()==1 && isalpha(key[0])) {
+	    name += string("\001")+key;
+	} else {
+	    name += string("\001")+dequote(key);
+	}
+	name += string("\002")+dequote(value);
+	return name;
+    }
+    static string combineHier(const string& old, const string& add) {
+	// (foo.a.x, foo.b.x) => foo.*.x
+	// (foo.a.x, foo.b.y) => foo.*
+	// (foo.a.x, foo.b)   => foo.*
+	if (old == add) return add;
+	if (old == "") return add;
+	if (add == "") return old;
+
+	const char* a = old.c_str();
+	const char* b = add.c_str();
+
+	// Scan forward to first mismatch
+	const char* apre = a;
+	const char* bpre = b;
+	while (*apre == *bpre) { apre++; bpre++; }
+
+	// We used to backup and split on only .'s but it seems better to be verbose
+	// and not assume . is the separator
+	string prefix = string(a,apre-a);
+
+	// Scan backward to last mismatch
+	const char* apost = a+strlen(a)-1;
+	const char* bpost = b+strlen(b)-1;
+	while (*apost == *bpost
+	       && apost>apre && bpost>bpre) { apost--; bpost--; }
+
+	// Forward to . so we have a whole word
+	string suffix = *bpost ? string(bpost+1) : "";
+
+	string out = prefix+"*"+suffix;
+
+	//cout << "\nch pre="<<prefix<<"  s="<<suffix<<"\nch a="<<old<<"\nch b="<<add<<"\nch o="<<out<<endl;
+	return out;
+    }
 };
 
+//=============================================================================
+// Binary coverage database, written by VerilatedCov::writeBinary
+//
+//	VL_COV_BINARY_MAGIC, then vluint32_t's of VL_COV_BINARY_ORDER, number
+//	of strings, number of key tables and number of points, all in the
+//	writer's byte order.  "Var" below is 7 bits per byte, low first, with
+//	the high bit set on all but the last byte.
+//	Strings 1..n-1, each a var length then its characters.
+//	Key tables, each a var number of keys then their var string numbers;
+//	keys are unshortened.
+//	Per point a var key table, then a var string number for each key's value.
+//	Counts as runs until all points are covered, each a vluint32_t number
+//	of points and vluint32_t bytes per count (4 or 8), then the counts.
+
+#define VL_COV_BINARY_MAGIC "VLCOVB1\n"	///< First 8 bytes of a binary coverage file
+#define VL_COV_BINARY_ORDER 0x01020304	///< Byte order marker
+
 #endif // guard
@@ -51,6 +51,10 @@ inline string VL_CVT_PACK_STR_NI(IData lhs) {
 inline string VL_CONCATN_NNN(const string& lhs, const string& rhs) {
     return lhs+rhs;
 }
+/// Append in place, for s = {s, rhs}; returns lhs so appends may nest
+inline string& VL_APPENDN_NNN(string& lhs, const string& rhs) {
+    return lhs += rhs;
+}
 inline string VL_REPLICATEN_NNQ(int,int,int, const string& lhs, IData rep) {
     string out; out.reserve(lhs.length() * rep);
     for (unsigned times=0; times<rep; ++times) out += lhs;
@@ -63,9 +67,14 @@ inline string VL_REPLICATEN_NNI(int obits,int lbits,int rbits, const string& lhs
 extern IData VL_FOPEN_NI(const string& filename, IData mode);
 extern void VL_READMEM_N(bool hex, int width, int depth, int array_lsb, int fnwords,
                          const string& ofilename, void* memp, IData start, IData end);
+extern void VL_READMEM_N(bool hex, int width, int depth, int array_lsb, int fnwords,
+                         const string& ofilename, VerilatedSparseMem* memp, IData start, IData end);
 extern IData VL_SSCANF_INX(int lbits, const string& ld, const char* formatp, ...);
 extern void VL_SFORMAT_X(int obits_ignored, string &output, const char* formatp, ...);
 extern string VL_SFORMATF_NX(const char* formatp, ...);
+/// Compiled format string argument (%@), and $sformat into a string
+inline void VL_FMT_STRING(VerilatedFmtBuf& buf, const string& str) { buf.text(str.data(), str.length()); }
+inline void VL_FMT_SFORMAT(VerilatedFmtBuf& buf, string& output) { output.assign(buf.c_str(), buf.length()); }
 extern IData VL_VALUEPLUSARGS_INW(int rbits, const string& ld, WDataOutP rdp);
 inline IData VL_VALUEPLUSARGS_INI(int rbits, const string& ld, IData& rdr) {
     WData rwp[2];  // WData must always be at least 2
@@ -43,26 +43,25 @@ class VerilatedScope;
 //======================================================================
 // Types
 
-class VerilatedImp {
-    // Whole class is internal use only - Global information shared between verilated*.cpp files.
+class VerilatedContextImp {
+    // Whole class is internal use only - Per-VerilatedContext part of VerilatedImp
+    friend class VerilatedImp;
+    friend class VerilatedContext;
 
     // TYPES
     typedef vector<string> ArgVec;
+    typedef map<string,string> ArgPlusMap;
     typedef map<pair<const void*,void*>,void*> UserMap;
-    typedef map<const char*, int, VerilatedCStrCmp>  ExportNameMap;
 
     // MEMBERS
-    static VerilatedImp	s_s;		///< Static Singleton; One and only static this
-
     // Nothing here is save-restored; users expected to re-register appropriately
 
     ArgVec		m_argVec;	///< Argument list (NOT save-restored, may want different results)
     bool		m_argVecLoaded;	///< Ever loaded argument list
+    ArgPlusMap		m_argPlusMap;	///< argPlusMatch result for each prefix; cleared when arguments change
+    VerilatedMutex	m_argMutex;	///< Protects m_argVec and m_argPlusMap
     UserMap	 	m_userMap;	///< Map of <(scope,userkey), userData>
     VerilatedScopeNameMap	m_nameMap;	///< Map of <scope_name, scope pointer>
-    // Slow - somewhat static:
-    ExportNameMap	m_exportMap;	///< Map of <export_func_proto, func number>
-    int			m_exportNext;	///< Next export funcnum
 
     // File I/O
     vector<FILE*>	m_fdps;		///< File descriptors
@@ -70,18 +69,63 @@ class VerilatedImp {
 
 public: // But only for verilated*.cpp
     // CONSTRUCTORS
-    VerilatedImp() : m_argVecLoaded(false), m_exportNext(0) {
+    VerilatedContextImp() : m_argVecLoaded(false) {
 	m_fdps.resize(3);
 	m_fdps[0] = stdin;
 	m_fdps[1] = stdout;
 	m_fdps[2] = stderr;
     }
+    ~VerilatedContextImp() {}
+
+    // METHODS - arguments
+    void commandArgs(int argc, const char** argv) {
+	VerilatedLockGuard guard (m_argMutex);
+	m_argVec.clear();  // Always clear
+	commandArgsAddGuarded(argc, argv);
+    }
+    void commandArgsAdd(int argc, const char** argv) {
+	VerilatedLockGuard guard (m_argMutex);
+	commandArgsAddGuarded(argc, argv);
+    }
+private:
+    void commandArgsAddGuarded(int argc, const char** argv) {
+	if (!m_argVecLoaded) m_argVec.clear();
+	for (int i=0; i<argc; ++i) m_argVec.push_back(argv[i]);
+	m_argVecLoaded = true; // Can't just test later for empty vector, no arguments is ok
+	m_argPlusMap.clear();  // Model threads hold only copies of the results
+    }
+};
+
+class VerilatedImp {
+    // Whole class is internal use only - Global information shared between verilated*.cpp files.
+
+    // TYPES
+    typedef VerilatedContextImp::ArgVec ArgVec;
+    typedef VerilatedContextImp::UserMap UserMap;
+    typedef map<const char*, int, VerilatedCStrCmp>  ExportNameMap;
+
+    // MEMBERS
+    static VerilatedImp	s_s;		///< Static Singleton; One and only static this
+
+    // Shared by all contexts, as function numbers are compiled into every model
+    // Slow - somewhat static:
+    ExportNameMap	m_exportMap;	///< Map of <export_func_proto, func number>
+    int			m_exportNext;	///< Next export funcnum
+
+    static inline VerilatedContextImp& ctx() { return *Verilated::threadContextp()->impp(); }
+
+public: // But only for verilated*.cpp
+    // CONSTRUCTORS
+    VerilatedImp() : m_exportNext(0) {}
     ~VerilatedImp() {}
     static void internalsDump() {
 	VL_PRINTF("internalsDump:\n");
 	VL_PRINTF("  Argv:");
-	for (ArgVec::iterator it=s_s.m_argVec.begin(); it!=s_s.m_argVec.end(); ++it) {
-	    VL_PRINTF(" %s",it->c_str());
+	{
+	    VerilatedLockGuard guard (ctx().m_argMutex);
+	    for (ArgVec::iterator it=ctx().m_argVec.begin(); it!=ctx().m_argVec.end(); ++it) {
+		VL_PRINTF(" %s",it->c_str());
+	    }
 	}
 	VL_PRINTF("\n");
 	VL_PRINTF("  Version: %s %s\n", Verilated::productName(), Verilated::productVersion());
@@ -91,30 +135,30 @@ public: // But only for verilated*.cpp
     }
 
     // METHODS - arguments
-    static void commandArgs(int argc, const char** argv) {
-	s_s.m_argVec.clear();  // Always clear
-	commandArgsAdd(argc, argv);
-    }
-    static void commandArgsAdd(int argc, const char** argv) {
-	if (!s_s.m_argVecLoaded) s_s.m_argVec.clear();
-	for (int i=0; i<argc; ++i) s_s.m_argVec.push_back(argv[i]);
-	s_s.m_argVecLoaded = true; // Can't just test later for empty vector, no arguments is ok
-    }
     static string argPlusMatch(const char* prefixp) {
 	// Note prefixp does not include the leading "+"
-	size_t len = strlen(prefixp);
-	if (VL_UNLIKELY(!s_s.m_argVecLoaded)) {
-	    s_s.m_argVecLoaded = true;  // Complain only once
+	// Results are cached, as plusargs are often tested every cycle.  The
+	// result is copied under the lock, as commandArgsAdd may clear the cache
+	VerilatedContextImp& ci = ctx();
+	VerilatedLockGuard guard (ci.m_argMutex);
+	if (VL_UNLIKELY(!ci.m_argVecLoaded)) {
+	    ci.m_argVecLoaded = true;  // Complain only once
 	    vl_fatal("unknown",0,"",
 		     "%Error: Verilog called $test$plusargs or $value$plusargs without"
 		     " testbench C first calling Verilated::commandArgs(argc,argv).");
 	}
-	for (ArgVec::iterator it=s_s.m_argVec.begin(); it!=s_s.m_argVec.end(); ++it) {
-	    if ((*it)[0]=='+') {
-		if (0==strncmp(prefixp, it->c_str()+1, len)) return *it;
+	VerilatedContextImp::ArgPlusMap::iterator mit = ci.m_argPlusMap.find(prefixp);
+	if (mit == ci.m_argPlusMap.end()) {
+	    size_t len = strlen(prefixp);
+	    string match;
+	    for (ArgVec::iterator it=ci.m_argVec.begin(); it!=ci.m_argVec.end(); ++it) {
+		if ((*it)[0]=='+') {
+		    if (0==strncmp(prefixp, it->c_str()+1, len)) { match = *it; break; }
+		}
 	    }
+	    mit = ci.m_argPlusMap.insert(make_pair(string(prefixp), match)).first;
 	}
-	return "";
+	return mit->second;
     }
 
     // METHODS - user scope tracking
@@ -122,23 +166,26 @@ public: // But only for verilated*.cpp
     // There's often many more scopes than userdata's and thus having a ~48byte
     // per map overhead * N scopes would take much more space and cache thrashing.
     static inline void userInsert(const void* scopep, void* userKey, void* userData) {
-	UserMap::iterator it=s_s.m_userMap.find(make_pair(scopep,userKey));
-	if (it != s_s.m_userMap.end()) it->second = userData;
+	UserMap& userMap = ctx().m_userMap;
+	UserMap::iterator it=userMap.find(make_pair(scopep,userKey));
+	if (it != userMap.end()) it->second = userData;
 	// When we support VL_THREADs, we need a lock around this insert, as it's runtime
-	else s_s.m_userMap.insert(it, make_pair(make_pair(scopep,userKey),userData));
+	else userMap.insert(it, make_pair(make_pair(scopep,userKey),userData));
     }
     static inline void* userFind(const void* scopep, void* userKey) {
-	UserMap::iterator it=s_s.m_userMap.find(make_pair(scopep,userKey));
-	if (VL_LIKELY(it != s_s.m_userMap.end())) return it->second;
+	UserMap& userMap = ctx().m_userMap;
+	UserMap::iterator it=userMap.find(make_pair(scopep,userKey));
+	if (VL_LIKELY(it != userMap.end())) return it->second;
 	else return NULL;
     }
 private:
     /// Symbol table destruction cleans up the entries for each scope.
     static void userEraseScope(const VerilatedScope* scopep) {
 	// Slow ok - called once/scope on destruction, so we simply iterate.
-	for (UserMap::iterator it=s_s.m_userMap.begin(); it!=s_s.m_userMap.end(); ) {
+	UserMap& userMap = scopep->contextp()->impp()->m_userMap;
+	for (UserMap::iterator it=userMap.begin(); it!=userMap.end(); ) {
 	    if (it->first.first == scopep) {
-		s_s.m_userMap.erase(it++);
+		userMap.erase(it++);
 	    } else {
 		++it;
 	    }
@@ -146,7 +193,8 @@ private:
     }
     static void userDump() {
 	bool first = true;
-	for (UserMap::iterator it=s_s.m_userMap.begin(); it!=s_s.m_userMap.end(); ++it) {
+	UserMap& userMap = ctx().m_userMap;
+	for (UserMap::iterator it=userMap.begin(); it!=userMap.end(); ++it) {
 	    if (first) { VL_PRINTF("  userDump:\n"); first=false; }
 	    VL_PRINTF("    DPI_USER_DATA scope %p key %p: %p\n",
 		      it->first.first, it->first.second, it->second);
@@ -156,33 +204,29 @@ private:
 public: // But only for verilated*.cpp
     // METHODS - scope name
     static void scopeInsert(const VerilatedScope* scopep) {
-	// Slow ok - called once/scope at construction
-	VerilatedScopeNameMap::iterator it=s_s.m_nameMap.find(scopep->name());
-	if (it == s_s.m_nameMap.end()) {
-	    s_s.m_nameMap.insert(it, make_pair(scopep->name(),scopep));
-	}
+	// Called once/scope at construction
+	scopep->contextp()->impp()->m_nameMap.insertIndexed(scopep->name(), scopep);
     }
     static inline const VerilatedScope* scopeFind(const char* namep) {
-	VerilatedScopeNameMap::iterator it=s_s.m_nameMap.find(namep);
-	if (VL_LIKELY(it != s_s.m_nameMap.end())) return it->second;
-	else return NULL;
+	return ctx().m_nameMap.findp(namep);
     }
     static void scopeErase(const VerilatedScope* scopep) {
 	// Slow ok - called once/scope at destruction
+	if (!scopep->contextp()) return;  // Never configured
 	userEraseScope(scopep);
-	VerilatedScopeNameMap::iterator it=s_s.m_nameMap.find(scopep->name());
-	if (it != s_s.m_nameMap.end()) s_s.m_nameMap.erase(it);
+	scopep->contextp()->impp()->m_nameMap.eraseIndexed(scopep->name());
     }
     static void scopesDump() {
 	VL_PRINTF("  scopesDump:\n");
-	for (VerilatedScopeNameMap::iterator it=s_s.m_nameMap.begin(); it!=s_s.m_nameMap.end(); ++it) {
+	VerilatedScopeNameMap& nameMap = ctx().m_nameMap;
+	for (VerilatedScopeNameMap::iterator it=nameMap.begin(); it!=nameMap.end(); ++it) {
 	    const VerilatedScope* scopep = it->second;
 	    scopep->scopeDump();
 	}
 	VL_PRINTF("\n");
     }
     static const VerilatedScopeNameMap* scopeNameMap() {
-        return &s_s.m_nameMap;
+        return &ctx().m_nameMap;
     }
 
 public: // But only for verilated*.cpp
@@ -233,28 +277,31 @@ public: // But only for verilated*.cpp
     // METHODS - file IO
     static IData fdNew(FILE* fp) {
 	if (VL_UNLIKELY(!fp)) return 0;
+	VerilatedContextImp& ci = ctx();
 	// Bit 31 indicates it's a descriptor not a MCD
-	if (s_s.m_fdFree.empty()) {
+	if (ci.m_fdFree.empty()) {
 	    // Need to create more space in m_fdps and m_fdFree
-	    size_t start = s_s.m_fdps.size();
-	    s_s.m_fdps.resize(start*2);
-	    for (size_t i=start; i<start*2; ++i) s_s.m_fdFree.push_back((IData)i);
+	    size_t start = ci.m_fdps.size();
+	    ci.m_fdps.resize(start*2);
+	    for (size_t i=start; i<start*2; ++i) ci.m_fdFree.push_back((IData)i);
 	}
-	IData idx = s_s.m_fdFree.back(); s_s.m_fdFree.pop_back();
-	s_s.m_fdps[idx] = fp;
+	IData idx = ci.m_fdFree.back(); ci.m_fdFree.pop_back();
+	ci.m_fdps[idx] = fp;
 	return (idx | (1UL<<31));  // bit 31 indicates not MCD
     }
     static void fdDelete(IData fdi) {
+	VerilatedContextImp& ci = ctx();
 	IData idx = VL_MASK_I(31) & fdi;
-	if (VL_UNLIKELY(!(fdi & (1ULL<<31)) || idx >= s_s.m_fdps.size())) return;
-	if (VL_UNLIKELY(!s_s.m_fdps[idx])) return;  // Already free
-	s_s.m_fdps[idx] = NULL;
-	s_s.m_fdFree.push_back(idx);
+	if (VL_UNLIKELY(!(fdi & (1ULL<<31)) || idx >= ci.m_fdps.size())) return;
+	if (VL_UNLIKELY(!ci.m_fdps[idx])) return;  // Already free
+	ci.m_fdps[idx] = NULL;
+	ci.m_fdFree.push_back(idx);
     }
     static inline FILE* fdToFp(IData fdi) {
+	VerilatedContextImp& ci = ctx();
 	IData idx = VL_MASK_I(31) & fdi;
-	if (VL_UNLIKELY(!(fdi & (1ULL<<31)) || idx >= s_s.m_fdps.size())) return NULL;
-	return s_s.m_fdps[idx];
+	if (VL_UNLIKELY(!(fdi & (1ULL<<31)) || idx >= ci.m_fdps.size())) return NULL;
+	return ci.m_fdps[idx];
     }
 };
 
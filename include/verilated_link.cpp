@@ -0,0 +1,291 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//=============================================================================
+//
+// THIS MODULE IS PUBLICLY LICENSED
+//
+// Copyright 2017 by Wilson Snyder.  This program is free software;
+// you can redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License Version 2.0.
+//
+// This is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+//=============================================================================
+///
+/// \file
+/// \brief Lockstep exchange of boundary signals between partitioned models
+///
+//=============================================================================
+
+#include "verilatedos.h"
+#include "verilated.h"
+#include "verilated_link.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//=============================================================================
+// Shared file layout
+//
+//   Header, then for each side, two channels used on alternate cycles.
+//   A side writes cycle N's changes to its channel N%2, then sets that
+//   channel's sequence to N+1.  It can't reuse that channel until cycle
+//   N+2, which it only reaches after the other side has published N+1, so
+//   after the other side has finished reading N.
+//
+//   When batching, N counts batches rather than cycles, and each cycle's
+//   changes end with an end of cycle record.  Side 0 publishes a batch,
+//   and if it has inputs, waits for side 1's.  Side 1 waits for side 0's
+//   batch before starting its own, so only side 0 can get ahead, and
+//   before reusing a channel it waits for side 1 to publish the batch
+//   that finished reading it.
+//
+//   Header:   magic, capacity, batch (8 bytes each)
+//   Channel:  sequence (8 bytes), number of changes (8 bytes), then each
+//             change as signal index (4 bytes) and the signal's bytes
+
+static const vluint64_t VL_LINK_MAGIC = VL_ULL(0x564c4c494e4b3031);  // "VLLINK01"
+static const size_t VL_LINK_HEADER = 64;	// Magic, capacity; padded to a cache line
+static const size_t VL_LINK_CHAN_HEADER = 16;
+static const vluint32_t VL_LINK_END_CYCLE = 0xffffffff;	// Index of a batch's end of cycle record
+
+static size_t vl_link_chan_bytes(size_t capacity) {
+    // Round to cache lines so the sides don't share one
+    return (VL_LINK_CHAN_HEADER + capacity + 63) & ~(size_t)63;
+}
+
+//=============================================================================
+// VerilatedLink
+
+VerilatedLink::VerilatedLink()
+    : m_side(0), m_fd(-1), m_basep(NULL), m_mapBytes(0), m_capacity(0), m_batch(1), m_cycle(0)
+    , m_writep(NULL), m_writeChanges(0), m_readp(NULL), m_readChanges(0) {}
+
+VerilatedLink::~VerilatedLink() {
+    close();
+}
+
+void VerilatedLink::addOutput(const void* datap, size_t bytes) {
+    if (VL_UNLIKELY(isOpen())) vl_fatal(__FILE__,__LINE__,"","VerilatedLink::addOutput after open");
+    Signal sig;
+    sig.m_datap = const_cast<void*>(datap);
+    sig.m_bytes = bytes;
+    sig.m_shadowOff = m_shadow.size();
+    m_shadow.resize(m_shadow.size() + bytes);
+    m_outputs.push_back(sig);
+}
+
+void VerilatedLink::addInput(void* datap, size_t bytes) {
+    if (VL_UNLIKELY(isOpen())) vl_fatal(__FILE__,__LINE__,"","VerilatedLink::addInput after open");
+    Signal sig;
+    sig.m_datap = datap;
+    sig.m_bytes = bytes;
+    sig.m_shadowOff = 0;
+    m_inputs.push_back(sig);
+}
+
+bool VerilatedLink::open(const char* filenamep, int side, size_t capacity, int batch) {
+    close();
+    m_filename = filenamep;
+    m_side = side ? 1 : 0;
+    m_capacity = capacity;
+    m_batch = (batch > 1) ? batch : 1;
+    m_mapBytes = VL_LINK_HEADER + 4 * vl_link_chan_bytes(capacity);
+    if (m_side == 0) {
+	m_fd = ::open(filenamep, O_RDWR|O_CREAT|O_EXCL, 0666);
+	if (m_fd < 0) {
+	    VL_PRINTF("%%Error: VerilatedLink can't create %s: %s\n", filenamep, strerror(errno));
+	    return false;
+	}
+	if (ftruncate(m_fd, m_mapBytes)) {
+	    VL_PRINTF("%%Error: VerilatedLink can't size %s: %s\n", filenamep, strerror(errno));
+	    ::close(m_fd); m_fd = -1;
+	    return false;
+	}
+    } else {
+	// Wait for side 0 to create and size the file
+	struct stat st;
+	while (1) {
+	    if (m_fd < 0) m_fd = ::open(filenamep, O_RDWR);
+	    if (m_fd >= 0 && !fstat(m_fd, &st)) {
+		if ((size_t)st.st_size >= m_mapBytes) break;
+		if ((size_t)st.st_size > 0) {
+		    VL_PRINTF("%%Error: VerilatedLink %s capacity differs from other side\n", filenamep);
+		    ::close(m_fd); m_fd = -1;
+		    return false;
+		}
+	    }
+	    usleep(1000);
+	}
+    }
+    void* mapp = mmap(NULL, m_mapBytes, PROT_READ|PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if (mapp == MAP_FAILED) {
+	VL_PRINTF("%%Error: VerilatedLink can't map %s: %s\n", filenamep, strerror(errno));
+	::close(m_fd); m_fd = -1;
+	return false;
+    }
+    m_basep = (vluint8_t*)mapp;
+    volatile vluint64_t* magicp = (volatile vluint64_t*)m_basep;
+    if (m_side == 0) {
+	magicp[1] = capacity;
+	magicp[2] = m_batch;
+	__sync_synchronize();
+	magicp[0] = VL_LINK_MAGIC;
+    } else {
+	while (magicp[0] != VL_LINK_MAGIC) sched_yield();
+	__sync_synchronize();
+	if (magicp[1] != capacity) {
+	    VL_PRINTF("%%Error: VerilatedLink %s capacity differs from other side\n", filenamep);
+	    close();
+	    return false;
+	}
+	if (magicp[2] != (vluint64_t)m_batch) {
+	    VL_PRINTF("%%Error: VerilatedLink %s batch differs from other side\n", filenamep);
+	    close();
+	    return false;
+	}
+    }
+    m_cycle = 0;
+    return true;
+}
+
+void VerilatedLink::close() {
+    if (m_basep && m_writep) {
+	// Hand over the cycles of a partial batch
+	publish(m_cycle / m_batch + 1);
+    }
+    m_writep = NULL;
+    if (m_basep) { munmap(m_basep, m_mapBytes); m_basep = NULL; }
+    if (m_fd >= 0) {
+	::close(m_fd); m_fd = -1;
+	if (m_side == 0) unlink(m_filename.c_str());
+    }
+}
+
+vluint8_t* VerilatedLink::channelp(int side, vluint64_t cycle) const {
+    return m_basep + VL_LINK_HEADER + (side * 2 + (cycle & 1)) * vl_link_chan_bytes(m_capacity);
+}
+
+void VerilatedLink::wait(const volatile vluint64_t* seqp, vluint64_t seq) const {
+    // Spin briefly, as the other side is usually close behind, then yield
+    for (int spins = 0; *seqp != seq; ++spins) {
+	if (spins > 1000) sched_yield();
+    }
+    __sync_synchronize();
+}
+
+void VerilatedLink::writeOutputs(vluint8_t*& cp, vluint64_t& changes) {
+    // Append outputs that changed; all of them on the first cycle
+    const vluint8_t* endp = channelp(m_side, m_cycle / m_batch) + VL_LINK_CHAN_HEADER + m_capacity;
+    for (size_t i=0; i<m_outputs.size(); ++i) {
+	const Signal& sig = m_outputs[i];
+	vluint8_t* shadowp = &m_shadow[sig.m_shadowOff];
+	if (m_cycle && 0 == memcmp(shadowp, sig.m_datap, sig.m_bytes)) continue;
+	if (VL_UNLIKELY(cp + 4 + sig.m_bytes > endp)) {
+	    vl_fatal(__FILE__,__LINE__,"","VerilatedLink changes exceed open's capacity");
+	}
+	memcpy(shadowp, sig.m_datap, sig.m_bytes);
+	vluint32_t index = (vluint32_t)i;
+	memcpy(cp, &index, 4);
+	memcpy(cp + 4, sig.m_datap, sig.m_bytes);
+	cp += 4 + sig.m_bytes;
+	++changes;
+    }
+    if (m_batch > 1) {
+	if (VL_UNLIKELY(cp + 4 > endp)) {
+	    vl_fatal(__FILE__,__LINE__,"","VerilatedLink changes exceed open's capacity");
+	}
+	memcpy(cp, &VL_LINK_END_CYCLE, 4);
+	cp += 4;
+	++changes;
+    }
+}
+
+const vluint8_t* VerilatedLink::readInput(const vluint8_t* rp) {
+    // Apply one change, returning the next
+    vluint32_t index;
+    memcpy(&index, rp, 4);
+    if (index == VL_LINK_END_CYCLE) return rp + 4;
+    if (VL_UNLIKELY(index >= m_inputs.size())) {
+	vl_fatal(__FILE__,__LINE__,"","VerilatedLink other side has more outputs than inputs here");
+    }
+    const Signal& sig = m_inputs[index];
+    memcpy(sig.m_datap, rp + 4, sig.m_bytes);
+    return rp + 4 + sig.m_bytes;
+}
+
+void VerilatedLink::publish(vluint64_t seq) {
+    vluint8_t* outp = channelp(m_side, seq - 1);
+    ((volatile vluint64_t*)outp)[1] = m_writeChanges;
+    __sync_synchronize();
+    ((volatile vluint64_t*)outp)[0] = seq;
+}
+
+void VerilatedLink::exchange() {
+    if (VL_UNLIKELY(!isOpen())) vl_fatal(__FILE__,__LINE__,"","VerilatedLink::exchange before open");
+    if (m_batch > 1) { exchangeBatch(); return; }
+    // Send outputs that changed
+    vluint8_t* cp = channelp(m_side, m_cycle) + VL_LINK_CHAN_HEADER;
+    m_writeChanges = 0;
+    writeOutputs(cp, m_writeChanges);
+    publish(m_cycle + 1);
+
+    // Receive the other side's changes for this cycle
+    const vluint8_t* inp = channelp(1 - m_side, m_cycle);
+    wait((const volatile vluint64_t*)inp, m_cycle + 1);
+    vluint64_t changes = ((const volatile vluint64_t*)inp)[1];
+    const vluint8_t* rp = inp + VL_LINK_CHAN_HEADER;
+    for (vluint64_t c=0; c<changes; ++c) rp = readInput(rp);
+    ++m_cycle;
+}
+
+void VerilatedLink::exchangeBatch() {
+    vluint64_t batch = m_cycle / m_batch;
+    bool batchEnd = (m_cycle % m_batch) == (vluint64_t)(m_batch - 1);
+    if (!m_writep) {
+	// Starting a batch
+	if (m_side == 0 && batch >= 2) {
+	    // Side 1 finished reading this channel before publishing batch-2
+	    wait((const volatile vluint64_t*)channelp(1, batch), batch - 1);
+	}
+	if (m_side == 1) {
+	    const vluint8_t* inp = channelp(0, batch);
+	    wait((const volatile vluint64_t*)inp, batch + 1);
+	    m_readChanges = ((const volatile vluint64_t*)inp)[1];
+	    m_readp = inp + VL_LINK_CHAN_HEADER;
+	}
+	m_writep = channelp(m_side, batch) + VL_LINK_CHAN_HEADER;
+	m_writeChanges = 0;
+    }
+    writeOutputs(m_writep, m_writeChanges);
+    if (m_side == 1) {
+	// Side 0's changes for this cycle, through its end of cycle record
+	while (m_readChanges) {
+	    --m_readChanges;
+	    vluint32_t index;
+	    memcpy(&index, m_readp, 4);
+	    m_readp = readInput(m_readp);
+	    if (index == VL_LINK_END_CYCLE) break;
+	}
+    }
+    if (batchEnd) {
+	publish(batch + 1);
+	m_writep = NULL;
+	if (m_side == 0 && !m_inputs.empty()) {
+	    // Side 1's changes for the whole batch
+	    const vluint8_t* inp = channelp(1, batch);
+	    wait((const volatile vluint64_t*)inp, batch + 1);
+	    vluint64_t changes = ((const volatile vluint64_t*)inp)[1];
+	    const vluint8_t* rp = inp + VL_LINK_CHAN_HEADER;
+	    for (vluint64_t c=0; c<changes; ++c) rp = readInput(rp);
+	}
+    }
+    ++m_cycle;
+}
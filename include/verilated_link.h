@@ -0,0 +1,108 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//=============================================================================
+//
+// THIS MODULE IS PUBLICLY LICENSED
+//
+// Copyright 2017 by Wilson Snyder.  This program is free software;
+// you can redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License Version 2.0.
+//
+// This is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+//=============================================================================
+///
+/// \file
+/// \brief Lockstep exchange of boundary signals between partitioned models
+///
+///	A design may be split at module boundaries by Verilating each part
+///	with its own --top-module, and running each model in its own process.
+///	A VerilatedLink on each side connects the two through a shared
+///	memory file: each side registers its output and input signals in
+///	matching order, and calls exchange() once per cycle.  Only outputs
+///	that changed since the previous cycle are sent.
+///
+///	When side 1 doesn't feed back into side 0 each cycle, for example a
+///	reference model checking a Verilated model, the sides may hand over
+///	a batch of cycles at a time.  Side 1 still sees side 0's outputs
+///	cycle by cycle; side 0 sees side 1's only once per batch.
+///
+//=============================================================================
+
+#ifndef _VERILATED_LINK_H_
+#define _VERILATED_LINK_H_ 1
+
+#include "verilatedos.h"
+#include "verilated.h"
+
+#include <string>
+#include <vector>
+using namespace std;
+
+//=============================================================================
+// VerilatedLink - one side of a two-process boundary signal link
+
+class VerilatedLink {
+    // TYPES
+    struct Signal {
+	void*		m_datap;	///< Signal in this model
+	size_t		m_bytes;	///< Size of signal
+	size_t		m_shadowOff;	///< Offset of last sent value in m_shadow, outputs only
+    };
+    typedef vector<Signal> Signals;
+
+    // MEMBERS
+    string		m_filename;	///< Shared file name
+    int			m_side;		///< 0 = creates file, 1 = joins
+    int			m_fd;		///< Shared file descriptor, or -1
+    vluint8_t*		m_basep;	///< Shared mapping, or NULL
+    size_t		m_mapBytes;	///< Size of mapping
+    size_t		m_capacity;	///< Bytes for each channel's changes
+    int			m_batch;	///< Cycles handed over at a time
+    vluint64_t		m_cycle;	///< Exchanges completed
+    vluint8_t*		m_writep;	///< Next change in this side's channel, when batching
+    vluint64_t		m_writeChanges;	///< Changes in this side's channel, when batching
+    const vluint8_t*	m_readp;	///< Next change in side 0's channel, side 1 when batching
+    vluint64_t		m_readChanges;	///< Changes left to read there
+    Signals		m_outputs;	///< Signals sent to the other side
+    Signals		m_inputs;	///< Signals received from the other side
+    vector<vluint8_t>	m_shadow;	///< Last sent value of each output
+
+    // METHODS
+    vluint8_t* channelp(int side, vluint64_t cycle) const;
+    void wait(const volatile vluint64_t* seqp, vluint64_t seq) const;
+    void writeOutputs(vluint8_t*& cp, vluint64_t& changes);
+    const vluint8_t* readInput(const vluint8_t* rp);
+    void publish(vluint64_t seq);
+    void exchangeBatch();
+private:
+    VerilatedLink(const VerilatedLink&);	///< N/A, no copy constructor
+    VerilatedLink& operator=(const VerilatedLink&);	///< N/A, no assignment
+public:
+    // CREATORS
+    VerilatedLink();
+    ~VerilatedLink();
+    // METHODS
+    /// Register a signal to send; the other side registers its input in the same position
+    void addOutput(const void* datap, size_t bytes);
+    /// Register a signal to receive; the other side registers its output in the same position
+    void addInput(void* datap, size_t bytes);
+    /// Open the link.  Side 0 creates the file, which must not already
+    /// exist, and side 1 waits for it.  Capacity is the largest bytes of
+    /// changed outputs either side sends in one exchange, and must match.
+    /// With batch above 1, the sides hand over that many cycles at a time,
+    /// and capacity must also allow 4 bytes per cycle.
+    /// Returns false, with a message printed, on error.
+    bool open(const char* filenamep, int side, size_t capacity, int batch=1);
+    /// Close the link, handing over any partial batch; side 0 also removes the file
+    void close();
+    /// Send changed outputs, wait for the other side's, and update inputs.
+    /// Called by both sides once per cycle, typically after eval()
+    void exchange();
+    bool isOpen() const { return m_basep != NULL; }
+    vluint64_t cycle() const { return m_cycle; }	///< Exchanges completed
+};
+
+#endif  // guard
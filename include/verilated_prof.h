@@ -0,0 +1,195 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//=============================================================================
+//
+// THIS MODULE IS PUBLICLY LICENSED
+//
+// Copyright 2001-2017 by Wilson Snyder.  This program is free software;
+// you can redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License Version 2.0.
+//
+// This is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+//=============================================================================
+///
+/// \file
+/// \brief Verilator: Function profiling counters, for --profile-counters
+///
+///	Each generated function gets a static VerilatedProfCFunc, and a
+///	VerilatedProfScope around its body that reads the CPU's cycle
+///	counter on entry and exit.  At exit the counts are written for
+///	verilator_profcfunc to report.
+///
+///	With --profile-branches, each generated if statement gets a static
+///	VerilatedProfBranch counting how often it was taken.  At exit the
+///	counts are written for a later Verilation with --branch-profile.
+///
+///	With --profile-activity, each always block counts how often it was
+///	entered, in a table each model registers with VerilatedProfActivity.
+///	At exit the counts are written, by block and summed by module.
+///
+///	With --profile-converge, each model counts how many iterations each
+///	eval() took to settle, and how often each change-detected variable
+///	was seen changed, requesting another iteration.  Models register
+///	these with VerilatedProfConverge, and at exit they are written.
+///
+//=============================================================================
+
+#ifndef _VERILATED_PROF_H_
+#define _VERILATED_PROF_H_ 1
+
+#include "verilatedos.h"
+
+//=============================================================================
+/// Read a free running tick counter into val
+
+#if defined(__i386__) || defined(__x86_64__)
+# define VL_RDTSC(val) { \
+    vluint32_t lo, hi; \
+    asm volatile("rdtsc" : "=a" (lo), "=d" (hi)); \
+    (val) = ((vluint64_t)hi << 32) | lo; }
+#elif defined(__aarch64__)
+# define VL_RDTSC(val) { asm volatile("mrs %0, cntvct_el0" : "=r" (val)); }
+#else
+# define VL_RDTSC(val) { (val) = VerilatedProfCFunc::clockTicks(); }
+#endif
+
+//=============================================================================
+/// Counters for one generated function
+
+class VerilatedProfCFunc {
+    // MEMBERS
+    const char*		m_namep;	///< Function name, in gprof's demangled form
+    VerilatedProfCFunc*	m_nextp;	///< Next registered function
+    vluint64_t		m_calls;	///< Number of calls
+    vluint64_t		m_selfTicks;	///< Ticks in function, not counting profiled callees
+    vluint64_t		m_totalTicks;	///< Ticks in function, including callees
+public:
+    // CONSTRUCTORS
+    /// Register a function; constructed as a function static so only called once
+    explicit VerilatedProfCFunc(const char* namep);
+    // METHODS
+    inline void add(vluint64_t selfTicks, vluint64_t totalTicks) {
+#ifdef VL_THREADED
+	__sync_fetch_and_add(&m_calls, 1);
+	__sync_fetch_and_add(&m_selfTicks, selfTicks);
+	__sync_fetch_and_add(&m_totalTicks, totalTicks);
+#else
+	++m_calls;
+	m_selfTicks += selfTicks;
+	m_totalTicks += totalTicks;
+#endif
+    }
+    /// Write all function counts; done automatically at exit
+    static void write(const char* filenamep);
+    /// Set filename written at exit, also set by +verilator+prof+file+<filename>
+    static void filename(const char* filenamep);
+    static const char* filename();	///< Return filename written at exit
+    /// Ticks from the OS clock, where there is no cycle counter
+    static vluint64_t clockTicks();
+};
+
+//=============================================================================
+/// Time one call to a generated function, until end of scope
+
+class VerilatedProfScope {
+    // MEMBERS
+    VerilatedProfCFunc*	m_funcp;	///< Function being timed
+    VerilatedProfScope*	m_parentp;	///< Timer of calling function, or NULL
+    vluint64_t		m_startTicks;	///< Ticks at entry
+    vluint64_t		m_childTicks;	///< Ticks in profiled callees
+    static VL_THREAD VerilatedProfScope* t_currentp;	///< Innermost timer on this thread
+public:
+    // CONSTRUCTORS
+    explicit VerilatedProfScope(VerilatedProfCFunc& func)
+	: m_funcp(&func), m_parentp(t_currentp), m_childTicks(0) {
+	t_currentp = this;
+	VL_RDTSC(m_startTicks);
+    }
+    ~VerilatedProfScope() {
+	vluint64_t endTicks;
+	VL_RDTSC(endTicks);
+	vluint64_t ticks = endTicks - m_startTicks;
+	m_funcp->add((ticks > m_childTicks) ? (ticks - m_childTicks) : 0, ticks);
+	if (m_parentp) m_parentp->m_childTicks += ticks;
+	t_currentp = m_parentp;
+    }
+};
+
+//=============================================================================
+/// Counters for one generated if statement
+
+class VerilatedProfBranch {
+    // MEMBERS
+    const char*		m_namep;	///< Verilog filename:lineno of the if
+    VerilatedProfBranch* m_nextp;	///< Next registered branch
+    vluint64_t		m_taken;	///< Times condition was true
+    vluint64_t		m_notTaken;	///< Times condition was false
+public:
+    // CONSTRUCTORS
+    /// Register a branch; constructed as a function static so only called once
+    explicit VerilatedProfBranch(const char* namep);
+    // METHODS
+    /// Count the condition, and return it for the if
+    inline bool count(bool cond) {
+#ifdef VL_THREADED
+	if (cond) __sync_fetch_and_add(&m_taken, 1);
+	else __sync_fetch_and_add(&m_notTaken, 1);
+#else
+	if (cond) ++m_taken;
+	else ++m_notTaken;
+#endif
+	return cond;
+    }
+    /// Write all branch counts; done automatically at exit
+    static void write(const char* filenamep);
+    /// Set filename written at exit, also set by +verilator+prof+branch+file+<filename>
+    static void filename(const char* filenamep);
+    static const char* filename();	///< Return filename written at exit
+};
+
+//=============================================================================
+/// Counters for each always block of the models
+
+class VerilatedProfActivity {
+public:
+    /// Register a model's counters, zeroing them; called by its constructor
+    /// Each name is "module scope filename:lineno"
+    static void insert(vluint64_t* countsp, const char* const* namesp, int count);
+    /// Keep the counts of a model being deleted, to write later; called by its destructor
+    static void remove(const vluint64_t* countsp);
+    /// Write all block counts, and their sums by module; done automatically at exit
+    static void write(const char* filenamep);
+    /// Set filename written at exit, also set by +verilator+prof+activity+file+<filename>
+    static void filename(const char* filenamep);
+    static const char* filename();	///< Return filename written at exit
+};
+
+//=============================================================================
+/// Counters of eval() iterations, and the changes that caused them
+
+/// Histogram buckets of iterations per eval(); the last also counts longer evals
+#define VL_PROF_CONVERGE_LOOPS 16
+
+class VerilatedProfConverge {
+public:
+    /// Register a model's counters, zeroing them; called by its constructor
+    /// loopsp has VL_PROF_CONVERGE_LOOPS entries, [n] counting evals of n+1 iterations.
+    /// Each change name is "variable filename:lineno"
+    static void insert(vluint64_t* loopsp, vluint64_t* changesp, const char* const* namesp, int count);
+    /// Keep the counts of a model being deleted, to write later; called by its destructor
+    static void remove(const vluint64_t* loopsp);
+    /// Return evals of all models that took the given iterations, or more for the last bucket
+    static vluint64_t evals(int iterations);
+    /// Return how often the named change-detected variable requested another iteration
+    static vluint64_t changes(const char* namep);
+    /// Write the iteration histogram and change counts; done automatically at exit
+    static void write(const char* filenamep);
+    /// Set filename written at exit, also set by +verilator+prof+converge+file+<filename>
+    static void filename(const char* filenamep);
+    static const char* filename();	///< Return filename written at exit
+};
+
+#endif // Guard
@@ -25,6 +25,13 @@
 
 #include <fcntl.h>
 #include <cerrno>
+#include <ctime>
+
+#ifdef VL_THREADED
+# include <condition_variable>
+# include <mutex>
+# include <thread>
+#endif
 
 #if defined(_WIN32) && !defined(__MINGW32__) && !defined(__CYGWIN__)
 # include <io.h>
@@ -42,6 +49,111 @@
 // CONSTANTS
 static const char* VLTSAVE_HEADER_STR = "verilatorsave01\n";	///< Value of first bytes of each file
 static const char* VLTSAVE_TRAILER_STR = "vltsaved";	///< Value of last bytes of each file
+static const char* VLTSAVE_DELTA_STR = "verilatordelta1\n";	///< Value of first bytes of each delta file
+static const vluint64_t VLTSAVE_DELTA_END = ~VL_ULL(0);	///< Block index marking end of a delta file
+static const char* VLTSAVE_COMPRESS_STR = "verilatorzsav01\n";	///< Value of first bytes of each compressed file
+static const char* VLTSAVE_CHUNKED_STR = "verilatorchunk1\n";	///< Value of first bytes of each chunked file
+
+//=============================================================================
+// Compression
+//
+// A small LZ77 codec, so compress() needs no external library.  Saved
+// models are mostly zeros and repeated structures, which this gets most
+// of the gain from while running near memory speed.  Each token's control
+// byte is either 0-127, for that many plus one literal bytes following,
+// or 128-255, for a copy of that many minus 124 bytes from a distance
+// given by the following two bytes (little endian).  Copies may overlap,
+// so a distance of one repeats the previous byte.
+
+static const int VLTSAVE_LZ_HASH_BITS = 13;
+static const size_t VLTSAVE_LZ_MIN_MATCH = 4;
+static const size_t VLTSAVE_LZ_MAX_MATCH = 127 + VLTSAVE_LZ_MIN_MATCH;
+static const size_t VLTSAVE_LZ_MAX_DIST = 65535;
+
+static size_t vl_save_compress_bound(size_t size) {
+    return size + size/128 + 1;
+}
+
+static vluint8_t* vl_save_literals(vluint8_t* op, const vluint8_t* lp, size_t size) {
+    while (size) {
+	size_t blk = size;  if (blk > 128) blk = 128;
+	*op++ = (vluint8_t)(blk-1);
+	memcpy(op, lp, blk);
+	op += blk;  lp += blk;  size -= blk;
+    }
+    return op;
+}
+
+static size_t vl_save_compress(const vluint8_t* inp, size_t size, vluint8_t* outp) {
+    vluint32_t table[1<<VLTSAVE_LZ_HASH_BITS];  // Position+1 of last occurrence, 0=none
+    memset(table, 0, sizeof(table));
+    vluint8_t* op = outp;
+    size_t lit = 0;  // Start of pending literals
+    size_t pos = 0;
+    while (pos + VLTSAVE_LZ_MIN_MATCH <= size) {
+	vluint32_t word;  memcpy(&word, inp+pos, 4);
+	vluint32_t hash = (word * 2654435761U) >> (32-VLTSAVE_LZ_HASH_BITS);
+	size_t cand = table[hash];
+	table[hash] = (vluint32_t)(pos+1);
+	if (cand && (pos - (cand-1)) <= VLTSAVE_LZ_MAX_DIST
+	    && 0==memcmp(inp+cand-1, inp+pos, VLTSAVE_LZ_MIN_MATCH)) {
+	    const vluint8_t* mp = inp+cand-1;
+	    size_t len = VLTSAVE_LZ_MIN_MATCH;
+	    while (pos+len < size && len < VLTSAVE_LZ_MAX_MATCH && mp[len] == inp[pos+len]) ++len;
+	    op = vl_save_literals(op, inp+lit, pos-lit);
+	    size_t dist = inp + pos - mp;
+	    *op++ = (vluint8_t)(128 + len - VLTSAVE_LZ_MIN_MATCH);
+	    *op++ = (vluint8_t)(dist & 0xff);
+	    *op++ = (vluint8_t)(dist >> 8);
+	    pos += len;
+	    lit = pos;
+	} else {
+	    ++pos;
+	}
+    }
+    op = vl_save_literals(op, inp+lit, size-lit);
+    return op - outp;
+}
+
+static bool vl_save_decompress(const vluint8_t* inp, size_t size, vluint8_t* outp, size_t outSize) {
+    // Return false on corrupt data; never writes outside outp[0..outSize)
+    const vluint8_t* ip = inp;
+    const vluint8_t* iendp = inp + size;
+    vluint8_t* op = outp;
+    vluint8_t* oendp = outp + outSize;
+    while (ip < iendp) {
+	size_t ctl = *ip++;
+	if (ctl < 128) {
+	    size_t len = ctl + 1;
+	    if ((size_t)(iendp - ip) < len || (size_t)(oendp - op) < len) return false;
+	    memcpy(op, ip, len);
+	    op += len;  ip += len;
+	} else {
+	    size_t len = ctl - 128 + VLTSAVE_LZ_MIN_MATCH;
+	    if (iendp - ip < 2) return false;
+	    size_t dist = ip[0] | ((size_t)ip[1] << 8);
+	    ip += 2;
+	    if (!dist || dist > (size_t)(op - outp) || (size_t)(oendp - op) < len) return false;
+	    const vluint8_t* mp = op - dist;
+	    for (size_t i=0; i<len; ++i) op[i] = mp[i];  // Overlaps allowed
+	    op += len;
+	}
+    }
+    return op == oendp;
+}
+
+static ssize_t vl_save_read_fully(int fd, vluint8_t* datap, size_t size) {
+    // Return bytes read, short only at EOF, or -1 on error
+    size_t done = 0;
+    while (done < size) {
+	errno = 0;
+	ssize_t got = ::read(fd, datap+done, size-done);
+	if (got > 0) done += got;
+	else if (got == 0) break;
+	else if (errno != EAGAIN && errno != EINTR) return -1;
+    }
+    return done;
+}
 
 //=============================================================================
 //=============================================================================
@@ -112,6 +224,7 @@ void VerilatedDeserialize::trailer() {
 
 void VerilatedSave::open (const char* filenamep) {
     if (isOpen()) return;
+    wait();  // Previous async() file must be closed before its name may be reused
     VL_DEBUG_IF(VL_PRINTF("-vltSave: opening save file %s\n",filenamep););
 
     if (filenamep[0]=='|') {
@@ -129,6 +242,8 @@ void VerilatedSave::open (const char* filenamep) {
     m_isOpen = true;
     m_filename = filenamep;
     m_cp = m_bufp;
+    if (m_compress) writeRaw((const vluint8_t*)VLTSAVE_COMPRESS_STR, strlen(VLTSAVE_COMPRESS_STR));
+    if (m_async) asyncStart();
     header();
 }
 
@@ -152,15 +267,30 @@ void VerilatedRestore::open (const char* filenamep) {
     m_filename = filenamep;
     m_cp = m_bufp;
     m_endp = m_bufp;
+    // Compressed files are recognized by their own signature ahead of the usual header
+    char sig[16];
+    size_t siglen = strlen(VLTSAVE_COMPRESS_STR);
+    m_compressed = (::read(m_fd, sig, siglen) == (ssize_t)siglen
+		    && 0==memcmp(sig, VLTSAVE_COMPRESS_STR, siglen));
+    if (!m_compressed) ::lseek(m_fd, 0, SEEK_SET);
+    m_frame.clear();
+    m_framePos = 0;
     header();
 }
 
+VerilatedSave::~VerilatedSave() {
+    close();
+    asyncStop();
+    if (m_spareBufp) { delete[] m_spareBufp; m_spareBufp=NULL; }
+}
+
 void VerilatedSave::close () {
     if (!isOpen()) return;
     trailer();
     flush();
     m_isOpen = false;
-    ::close(m_fd);  // May get error, just ignore it
+    if (m_asyncp) asyncPost(true);  // Writer thread closes when done
+    else ::close(m_fd);  // May get error, just ignore it
 }
 
 void VerilatedRestore::close () {
@@ -176,9 +306,33 @@ void VerilatedRestore::close () {
 
 void VerilatedSave::flush() {
     if (VL_UNLIKELY(!isOpen())) return;
-    vluint8_t* wp = m_bufp;
+    if (m_asyncp) {
+	asyncPost(false);  // Swaps m_bufp to the other buffer
+    } else {
+	writeBuffer(m_bufp, m_cp - m_bufp);
+    }
+    m_cp = m_bufp; // Reset buffer
+}
+
+void VerilatedSave::writeBuffer(const vluint8_t* datap, size_t size) {
+    if (!size) return;
+    if (!m_compress) {
+	writeRaw(datap, size);
+	return;
+    }
+    // Each frame is the uncompressed and compressed sizes, then the compressed data
+    m_zbuf.resize(8 + vl_save_compress_bound(size));
+    vluint32_t rawSize = (vluint32_t)size;
+    vluint32_t zSize = (vluint32_t)vl_save_compress(datap, size, &m_zbuf[8]);
+    memcpy(&m_zbuf[0], &rawSize, 4);
+    memcpy(&m_zbuf[4], &zSize, 4);
+    writeRaw(&m_zbuf[0], 8 + zSize);
+}
+
+void VerilatedSave::writeRaw(const vluint8_t* datap, size_t size) {
+    const vluint8_t* wp = datap;
     while (1) {
-	ssize_t remaining = (m_cp - wp);
+	ssize_t remaining = (datap + size - wp);
 	if (remaining==0) break;
 	errno = 0;
 	ssize_t got = ::write (m_fd, wp, remaining);
@@ -189,12 +343,11 @@ void VerilatedSave::flush() {
 		// write failed, presume error (perhaps out of disk space)
 		string msg = string(__FUNCTION__)+": "+strerror(errno);
 		vl_fatal("",0,"",msg.c_str());
-		close();
+		m_isOpen = false;
 		break;
 	    }
 	}
     }
-    m_cp = m_bufp; // Reset buffer
 }
 
 void VerilatedRestore::fill() {
@@ -209,7 +362,8 @@ void VerilatedRestore::fill() {
 	ssize_t remaining = (m_bufp+bufferSize() - m_endp);
 	if (remaining==0) break;
 	errno = 0;
-	ssize_t got = ::read (m_fd, m_endp, remaining);
+	ssize_t got = (m_compressed ? readFrame(m_endp, remaining)
+		       : ::read (m_fd, m_endp, remaining));
 	if (got>0) {
 	    m_endp += got;
 	} else if (got < 0) {
@@ -228,6 +382,707 @@ void VerilatedRestore::fill() {
     }
 }
 
+ssize_t VerilatedRestore::readFrame(vluint8_t* datap, size_t size) {
+    // Return decompressed bytes, as if from ::read
+    if (m_framePos >= m_frame.size()) {
+	vluint8_t hdr[8];
+	ssize_t got = vl_save_read_fully(m_fd, hdr, 8);
+	if (got <= 0) return got;  // EOF or error
+	vluint32_t rawSize, zSize;
+	memcpy(&rawSize, &hdr[0], 4);
+	memcpy(&zSize, &hdr[4], 4);
+	m_zbuf.resize(zSize ? zSize : 1);
+	m_frame.resize(rawSize);
+	m_framePos = 0;
+	if (got != 8
+	    || vl_save_read_fully(m_fd, &m_zbuf[0], zSize) != (ssize_t)zSize
+	    || !vl_save_decompress(&m_zbuf[0], zSize, rawSize ? &m_frame[0] : NULL, rawSize)) {
+	    m_frame.clear();
+	    errno = EIO;  // Truncated or corrupt
+	    return -1;
+	}
+    }
+    size_t blk = m_frame.size() - m_framePos;
+    if (blk > size) blk = size;
+    memcpy(datap, &m_frame[m_framePos], blk);
+    m_framePos += blk;
+    return blk;
+}
+
+//=============================================================================
+// Asynchronous writer
+//
+// With async(), flush() hands the filled buffer to a writer thread, which
+// compresses and writes it while the model fills the other buffer.  Only
+// one buffer is ever in flight; a second flush() first waits for the
+// writer to finish the previous one.
+
+#ifdef VL_THREADED
+
+class VerilatedSaveAsync {
+public:
+    // MEMBERS
+    std::mutex			m_mutex;	///< Protects below
+    std::condition_variable	m_cv;		///< Signals job posted or completed
+    const vluint8_t*		m_jobp;		///< Buffer to write
+    size_t			m_jobSize;	///< Bytes in m_jobp
+    bool			m_jobClose;	///< Close m_fd after writing
+    bool			m_busy;		///< Job posted and not yet complete
+    bool			m_stop;		///< Writer should exit
+    std::thread			m_thread;	///< Writer thread
+    // CREATORS
+    VerilatedSaveAsync() {
+	m_jobp = NULL; m_jobSize = 0; m_jobClose = false;
+	m_busy = false; m_stop = false;
+    }
+    static void threadMain(VerilatedSave* savep) { savep->asyncWriterLoop(); }
+};
+
+void VerilatedSave::asyncStart() {
+    if (!m_spareBufp) m_spareBufp = new vluint8_t [bufferSize()];
+    if (m_asyncp) return;  // Reuse the thread from the last file
+    m_asyncp = new VerilatedSaveAsync;
+    m_asyncp->m_thread = std::thread(VerilatedSaveAsync::threadMain, this);
+}
+
+void VerilatedSave::asyncPost(bool closeFd) {
+    VerilatedSaveAsync* ap = m_asyncp;
+    std::unique_lock<std::mutex> lock(ap->m_mutex);
+    while (ap->m_busy) ap->m_cv.wait(lock);
+    ap->m_jobp = m_bufp;
+    ap->m_jobSize = m_cp - m_bufp;
+    ap->m_jobClose = closeFd;
+    ap->m_busy = true;
+    ap->m_cv.notify_all();
+    // The writer is done with the spare buffer, so fill it next
+    std::swap(m_bufp, m_spareBufp);
+}
+
+void VerilatedSave::wait() {
+    VerilatedSaveAsync* ap = m_asyncp;
+    if (!ap) return;
+    std::unique_lock<std::mutex> lock(ap->m_mutex);
+    while (ap->m_busy) ap->m_cv.wait(lock);
+}
+
+void VerilatedSave::asyncStop() {
+    VerilatedSaveAsync* ap = m_asyncp;
+    if (!ap) return;
+    {
+	std::unique_lock<std::mutex> lock(ap->m_mutex);
+	ap->m_stop = true;
+	ap->m_cv.notify_all();
+    }
+    ap->m_thread.join();
+    delete ap;
+    m_asyncp = NULL;
+}
+
+void VerilatedSave::asyncWriterLoop() {
+    VerilatedSaveAsync* ap = m_asyncp;
+    std::unique_lock<std::mutex> lock(ap->m_mutex);
+    while (1) {
+	// Finish any job before stopping, so destruction completes the file
+	if (!ap->m_busy) {
+	    if (ap->m_stop) break;
+	    ap->m_cv.wait(lock);
+	    continue;
+	}
+	lock.unlock();
+	writeBuffer(ap->m_jobp, ap->m_jobSize);
+	if (ap->m_jobClose) ::close(m_fd);  // May get error, just ignore it
+	lock.lock();
+	ap->m_busy = false;
+	ap->m_cv.notify_all();
+    }
+}
+
+#else  // !VL_THREADED
+
+void VerilatedSave::asyncStart() {
+    vl_fatal(__FILE__,__LINE__,"","VerilatedSave::async() requires compiling with VL_THREADED");
+}
+void VerilatedSave::asyncPost(bool) {}
+void VerilatedSave::wait() {}
+void VerilatedSave::asyncStop() {}
+void VerilatedSave::asyncWriterLoop() {}
+
+#endif  // VL_THREADED
+
+//=============================================================================
+//=============================================================================
+//=============================================================================
+// Delta checkpoints
+//
+// A delta file is the VLTSAVE_DELTA_STR header, the base's identifier and
+// the checkpoint's sequence number, then (block index, size, data) for each
+// changed block of the serialized stream, then VLTSAVE_DELTA_END and the
+// stream's total length.  A base is simply a delta with every block.
+
+static vluint64_t vl_delta_hash(const vluint8_t* datap, size_t size) {
+    // Fast 64-bit hash, a word at a time
+    vluint64_t hash = VL_ULL(0xcbf29ce484222325);
+    size_t i = 0;
+    for (; i+8 <= size; i += 8) {
+	vluint64_t word;  memcpy(&word, datap+i, 8);
+	hash = (hash ^ word) * VL_ULL(0x100000001b3);
+	hash ^= hash >> 29;
+    }
+    for (; i < size; ++i) {
+	hash = (hash ^ datap[i]) * VL_ULL(0x100000001b3);
+    }
+    return hash ^ size;
+}
+
+VerilatedSaveDelta::VerilatedSaveDelta() {
+    m_fd = -1;
+    m_blockp = new vluint8_t [blockSize()];
+    m_blockFill = 0;
+    m_blockIndex = 0;
+    m_baseId = 0;
+    m_seq = 0;
+    m_blocksWritten = 0;
+}
+
+VerilatedSaveDelta::~VerilatedSaveDelta() {
+    close();
+    if (m_blockp) { delete [] m_blockp; m_blockp=NULL; }
+}
+
+void VerilatedSaveDelta::open(const char* filenamep) {
+    if (isOpen()) return;
+    VL_DEBUG_IF(VL_PRINTF("-vltSave: opening delta save file %s\n",filenamep););
+
+    // cppcheck-suppress duplicateExpression
+    m_fd = ::open (filenamep, O_CREAT|O_WRONLY|O_TRUNC|O_LARGEFILE|O_NONBLOCK
+		   , 0666);
+    if (m_fd<0) {
+	// User code can check isOpen()
+	m_isOpen = false;
+	return;
+    }
+    m_isOpen = true;
+    m_filename = filenamep;
+    m_cp = m_bufp;
+    m_blockFill = 0;
+    m_blockIndex = 0;
+    m_blocksWritten = 0;
+    if (m_hashes.empty()) {
+	// New base; the identifier only needs to differ between series
+	m_seq = 0;
+	m_baseId = ((vluint64_t)time(NULL) << 20) ^ (vluint64_t)(size_t)this ^ (m_baseId+1);
+    } else {
+	++m_seq;
+    }
+    writeBytes(VLTSAVE_DELTA_STR, strlen(VLTSAVE_DELTA_STR));
+    writeBytes(&m_baseId, sizeof(m_baseId));
+    writeBytes(&m_seq, sizeof(m_seq));
+    header();
+}
+
+void VerilatedSaveDelta::close() {
+    if (!isOpen()) return;
+    trailer();
+    flush();
+    vluint64_t length = m_blockIndex * blockSize() + m_blockFill;
+    if (m_blockFill) blockDone();
+    m_hashes.resize(m_blockIndex);
+    writeBytes(&VLTSAVE_DELTA_END, sizeof(VLTSAVE_DELTA_END));
+    writeBytes(&length, sizeof(length));
+    m_isOpen = false;
+    ::close(m_fd);  // May get error, just ignore it
+}
+
+void VerilatedSaveDelta::flush() {
+    if (VL_UNLIKELY(!isOpen())) return;
+    // Assemble fixed size blocks, as buffer flushes land at varying offsets
+    const vluint8_t* rp = m_bufp;
+    while (rp < m_cp) {
+	size_t blk = blockSize() - m_blockFill;
+	if (blk > (size_t)(m_cp - rp)) blk = m_cp - rp;
+	memcpy(m_blockp + m_blockFill, rp, blk);
+	m_blockFill += blk;
+	rp += blk;
+	if (m_blockFill == blockSize()) blockDone();
+    }
+    m_cp = m_bufp; // Reset buffer
+}
+
+void VerilatedSaveDelta::blockDone() {
+    vluint64_t hash = vl_delta_hash(m_blockp, m_blockFill);
+    if (m_blockIndex >= m_hashes.size() || m_hashes[m_blockIndex] != hash) {
+	vluint32_t size = m_blockFill;
+	writeBytes(&m_blockIndex, sizeof(m_blockIndex));
+	writeBytes(&size, sizeof(size));
+	writeBytes(m_blockp, m_blockFill);
+	++m_blocksWritten;
+	if (m_blockIndex >= m_hashes.size()) m_hashes.resize(m_blockIndex+1);
+	m_hashes[m_blockIndex] = hash;
+    }
+    ++m_blockIndex;
+    m_blockFill = 0;
+}
+
+void VerilatedSaveDelta::writeBytes(const void* datap, size_t size) {
+    const vluint8_t* wp = (const vluint8_t*)datap;
+    while (size && isOpen()) {
+	errno = 0;
+	ssize_t got = ::write (m_fd, wp, size);
+	if (got>0) {
+	    wp += got;
+	    size -= got;
+	} else if (got < 0) {
+	    if (errno != EAGAIN && errno != EINTR) {
+		// write failed, presume error (perhaps out of disk space)
+		string msg = string(__FUNCTION__)+": "+strerror(errno);
+		vl_fatal("",0,"",msg.c_str());
+		m_isOpen = false;
+		::close(m_fd);
+		break;
+	    }
+	}
+    }
+}
+
+void VerilatedRestoreDelta::add(const char* filenamep) {
+    VL_DEBUG_IF(VL_PRINTF("-vltRestore: adding delta restore file %s\n",filenamep););
+    if (m_fds.empty()) m_filename = filenamep;
+    // cppcheck-suppress duplicateExpression
+    m_fds.push_back(::open (filenamep, O_RDONLY|O_LARGEFILE));  // open() checks for -1
+}
+
+void VerilatedRestoreDelta::open() {
+    if (isOpen()) return;
+    if (m_fds.empty()) return;
+    for (size_t f=0; f<m_fds.size(); ++f) {
+	// User code can check isOpen()
+	if (m_fds[f] < 0) return;
+    }
+    // Index where the final contents of every block are
+    for (size_t f=0; f<m_fds.size(); ++f) {
+	int fd = m_fds[f];
+	char hdr[16];
+	vluint64_t baseId = 0;
+	vluint64_t seq = 0;
+	if (!readBytes(fd, hdr, strlen(VLTSAVE_DELTA_STR))
+	    || 0 != memcmp(hdr, VLTSAVE_DELTA_STR, strlen(VLTSAVE_DELTA_STR))
+	    || !readBytes(fd, &baseId, sizeof(baseId))
+	    || !readBytes(fd, &seq, sizeof(seq))) {
+	    string msg = (string)"Can't deserialize; file has wrong delta header signature";
+	    vl_fatal(m_filename.c_str(), 0, "", msg.c_str());
+	    return;
+	}
+	if (f==0) m_baseId = baseId;
+	if (baseId != m_baseId || seq != f) {
+	    string msg = (string)"Can't deserialize; delta files are not the base then each later delta in order";
+	    vl_fatal(m_filename.c_str(), 0, "", msg.c_str());
+	    return;
+	}
+	vluint64_t length = 0;
+	while (1) {
+	    vluint64_t index = 0;
+	    vluint32_t size = 0;
+	    if (!readBytes(fd, &index, sizeof(index))) break;
+	    if (index == VLTSAVE_DELTA_END) {
+		if (!readBytes(fd, &length, sizeof(length))) index = 0;
+		break;
+	    }
+	    if (!readBytes(fd, &size, sizeof(size))) break;
+	    off_t offset = lseek(fd, 0, SEEK_CUR);
+	    if (index >= VLTSAVE_DELTA_END/VerilatedSaveDelta::blockSize()) break;
+	    if (index >= m_blocks.size()) m_blocks.resize(index+1);
+	    m_blocks[index].m_file = f;
+	    m_blocks[index].m_offset = offset;
+	    m_blocks[index].m_size = size;
+	    lseek(fd, size, SEEK_CUR);
+	}
+	size_t nblocks = (length + VerilatedSaveDelta::blockSize() - 1) / VerilatedSaveDelta::blockSize();
+	m_blocks.resize(nblocks);
+	if (!length || f+1 == m_fds.size()) {
+	    // Check the stream is complete.  Partial files also fail here.
+	    for (size_t b=0; b<nblocks; ++b) {
+		size_t size = ((b+1 < nblocks) ? VerilatedSaveDelta::blockSize()
+			       : (length - b * VerilatedSaveDelta::blockSize()));
+		if (!length || m_blocks[b].m_file < 0 || m_blocks[b].m_size != size) {
+		    string msg = (string)"Can't deserialize; delta files are truncated or missing the base";
+		    vl_fatal(m_filename.c_str(), 0, "", msg.c_str());
+		    return;
+		}
+	    }
+	}
+    }
+    m_isOpen = true;
+    m_cp = m_bufp;
+    m_endp = m_bufp;
+    m_readBlock = 0;
+    m_readOffset = 0;
+    header();
+}
+
+void VerilatedRestoreDelta::close() {
+    if (isOpen()) {
+	trailer();
+	m_isOpen = false;
+    }
+    for (size_t f=0; f<m_fds.size(); ++f) {
+	if (m_fds[f] >= 0) ::close(m_fds[f]);  // May get error, just ignore it
+    }
+    m_fds.clear();
+    m_blocks.clear();
+}
+
+void VerilatedRestoreDelta::fill() {
+    if (VL_UNLIKELY(!isOpen())) return;
+    // Move remaining characters down to start of buffer.  (No memcpy, overlaps allowed)
+    vluint8_t* rp = m_bufp;
+    for (vluint8_t* sp=m_cp; sp < m_endp;) *rp++ = *sp++;  // Overlaps
+    m_endp = m_bufp + (m_endp - m_cp);
+    m_cp = m_bufp; // Reset buffer
+    // Read into buffer starting at m_endp, from wherever each block's latest data is
+    size_t remaining = (m_bufp+bufferSize() - m_endp);
+    while (remaining && m_readBlock < m_blocks.size()) {
+	const Block& block = m_blocks[m_readBlock];
+	size_t blk = block.m_size - m_readOffset;
+	if (blk > remaining) blk = remaining;
+	int fd = m_fds[block.m_file];
+	if (lseek(fd, block.m_offset + m_readOffset, SEEK_SET) < 0
+	    || !readBytes(fd, m_endp, blk)) {
+	    string msg = string(__FUNCTION__)+": "+strerror(errno);
+	    vl_fatal("",0,"",msg.c_str());
+	    close();
+	    return;
+	}
+	m_endp += blk;
+	remaining -= blk;
+	m_readOffset += blk;
+	if (m_readOffset == block.m_size) { ++m_readBlock; m_readOffset = 0; }
+    }
+    if (m_readBlock >= m_blocks.size()) {
+	// Fill buffer from here to end with NULLs so reader's don't need to check eof each character.
+	while (m_endp < m_bufp+bufferSize()) *m_endp++ = '\0';
+    }
+}
+
+bool VerilatedRestoreDelta::readBytes(int fd, void* datap, size_t size) {
+    vluint8_t* dp = (vluint8_t*)datap;
+    while (size) {
+	errno = 0;
+	ssize_t got = ::read (fd, dp, size);
+	if (got>0) {
+	    dp += got;
+	    size -= got;
+	} else if (got < 0 && (errno == EAGAIN || errno == EINTR)) {
+	    continue;
+	} else {
+	    return false;  // EOF or error
+	}
+    }
+    return true;
+}
+
+//=============================================================================
+// VerilatedSaveMem/VerilatedRestoreMem
+
+void VerilatedSaveMem::open() {
+    if (isOpen()) return;
+    m_data.clear();
+    m_isOpen = true;
+    m_cp = m_bufp;
+    header();
+}
+
+void VerilatedSaveMem::close() {
+    if (!isOpen()) return;
+    trailer();
+    flush();
+    m_isOpen = false;
+}
+
+void VerilatedSaveMem::flush() {
+    if (VL_UNLIKELY(!isOpen())) return;
+    m_data.insert(m_data.end(), m_bufp, m_cp);
+    m_cp = m_bufp; // Reset buffer
+}
+
+void VerilatedRestoreMem::open(const VerilatedSaveMem& snapshot) {
+    if (isOpen()) return;
+    if (snapshot.isOpen() || !snapshot.size()) return;  // User code can check isOpen()
+    m_isOpen = true;
+    // Read in place, only copying the tail into our buffer, see fill()
+    m_ownBufp = m_bufp;
+    m_bufp = const_cast<vluint8_t*>(snapshot.data());
+    m_cp = m_bufp;
+    m_endp = m_bufp + snapshot.size();
+    header();
+}
+
+void VerilatedRestoreMem::close() {
+    if (!isOpen()) return;
+    trailer();
+    m_isOpen = false;
+    if (m_ownBufp) { m_bufp = m_ownBufp; m_ownBufp = NULL; }
+}
+
+void VerilatedRestoreMem::fill() {
+    if (VL_UNLIKELY(!isOpen())) return;
+    // Near the end; move the remainder into our buffer.  (Overlaps allowed)
+    size_t remaining = m_endp - m_cp;
+    if (m_ownBufp) { m_bufp = m_ownBufp; m_ownBufp = NULL; }
+    memmove(m_bufp, m_cp, remaining);
+    m_cp = m_bufp;
+    m_endp = m_bufp + remaining;
+    // Fill buffer from here to end with NULLs so reader's don't need to check eof each character.
+    while (m_endp < m_bufp+bufferSize()) *m_endp++ = '\0';
+}
+
+//=============================================================================
+//=============================================================================
+//=============================================================================
+// Chunked files
+//
+// A chunked file is the VLTSAVE_CHUNKED_STR header, the index's offset,
+// the size and contents of Verilated::serializedPtr(), then the chunks in
+// the order they finished.  The index at the end is the number of chunks,
+// then each chunk's offset and size, then VLTSAVE_TRAILER_STR.  Each chunk
+// is serialized into memory, so each thread needs its largest chunk's size.
+
+class VerilatedSaveChunkBuf : public VerilatedSerialize {
+public:
+    vector<vluint8_t>	m_data;		///< Chunk contents
+    VerilatedSaveChunkBuf() { m_isOpen = true; }
+    virtual ~VerilatedSaveChunkBuf() { close(); }
+    virtual void close() { flush(); }
+    virtual void flush() {
+	m_data.insert(m_data.end(), m_bufp, m_cp);
+	m_cp = m_bufp;
+    }
+};
+
+class VerilatedRestoreChunkBuf : public VerilatedDeserialize {
+    vluint8_t*		m_ownBufp;	///< Our buffer, while m_bufp points into m_data
+public:
+    vector<vluint8_t>	m_data;		///< Chunk contents
+    VerilatedRestoreChunkBuf() { m_ownBufp = NULL; }
+    virtual ~VerilatedRestoreChunkBuf() { close(); }
+    void start() {
+	// Read in place, as VerilatedRestoreMem does
+	close();
+	m_isOpen = true;
+	m_ownBufp = m_bufp;
+	m_bufp = m_data.empty() ? m_ownBufp : &m_data[0];
+	m_cp = m_bufp;
+	m_endp = m_bufp + m_data.size();
+    }
+    virtual void close() {
+	m_isOpen = false;
+	if (m_ownBufp) { m_bufp = m_ownBufp; m_ownBufp = NULL; }
+    }
+    virtual void flush() {}
+    virtual void fill() {
+	size_t remaining = m_endp - m_cp;
+	if (m_ownBufp) { m_bufp = m_ownBufp; m_ownBufp = NULL; }
+	memmove(m_bufp, m_cp, remaining);
+	m_cp = m_bufp;
+	m_endp = m_bufp + remaining;
+	while (m_endp < m_bufp+bufferSize()) *m_endp++ = '\0';
+    }
+};
+
+struct VerilatedChunkedJob {
+    // MEMBERS
+    int			m_fd;		///< File being written or read
+    void*		m_modelp;	///< Model being saved or restored
+    int			m_chunks;	///< Chunks in model
+    volatile int	m_nextChunk;	///< Next chunk to claim
+    volatile vluint64_t	m_nextOffset;	///< Next free offset in file, when saving
+    vector<vluint64_t>	m_offsets;	///< Offset of each chunk
+    vector<vluint64_t>	m_sizes;	///< Bytes of each chunk
+    volatile bool	m_failed;	///< Write or read failed
+    VerilatedSaveChunked::ChunkCb	m_saveCb;
+    VerilatedRestoreChunked::ChunkCb	m_restoreCb;
+    VerilatedChunkedJob(int fd, void* modelp, int chunks)
+	: m_fd(fd), m_modelp(modelp), m_chunks(chunks), m_nextChunk(0), m_nextOffset(0)
+	, m_offsets(chunks, 0), m_sizes(chunks, 0), m_failed(false)
+	, m_saveCb(NULL), m_restoreCb(NULL) {}
+    int claim() {
+#ifdef VL_THREADED
+	return __sync_fetch_and_add(&m_nextChunk, 1);
+#else
+	return m_nextChunk++;
+#endif
+    }
+    vluint64_t reserve(vluint64_t size) {
+#ifdef VL_THREADED
+	return __sync_fetch_and_add(&m_nextOffset, size);
+#else
+	vluint64_t offset = m_nextOffset;
+	m_nextOffset += size;
+	return offset;
+#endif
+    }
+};
+
+static bool vl_chunked_pwrite(int fd, const void* datap, size_t size, vluint64_t offset) {
+    const vluint8_t* dp = (const vluint8_t*)datap;
+    while (size) {
+	ssize_t done = ::pwrite(fd, dp, size, (off_t)offset);
+	if (done < 0) {
+	    if (errno == EAGAIN || errno == EINTR) continue;
+	    return false;
+	}
+	dp += done; offset += done; size -= done;
+    }
+    return true;
+}
+
+static bool vl_chunked_pread(int fd, void* datap, size_t size, vluint64_t offset) {
+    vluint8_t* dp = (vluint8_t*)datap;
+    while (size) {
+	ssize_t done = ::pread(fd, dp, size, (off_t)offset);
+	if (done == 0) return false;  // Truncated
+	if (done < 0) {
+	    if (errno == EAGAIN || errno == EINTR) continue;
+	    return false;
+	}
+	dp += done; offset += done; size -= done;
+    }
+    return true;
+}
+
+static void vl_chunked_save_worker(VerilatedChunkedJob* jobp) {
+    VerilatedSaveChunkBuf buf;
+    for (int chunk = jobp->claim(); chunk < jobp->m_chunks; chunk = jobp->claim()) {
+	buf.m_data.clear();
+	jobp->m_saveCb(jobp->m_modelp, chunk, buf);
+	buf.flush();
+	vluint64_t offset = jobp->reserve(buf.m_data.size());
+	jobp->m_offsets[chunk] = offset;
+	jobp->m_sizes[chunk] = buf.m_data.size();
+	if (!buf.m_data.empty()
+	    && !vl_chunked_pwrite(jobp->m_fd, &buf.m_data[0], buf.m_data.size(), offset)) {
+	    jobp->m_failed = true;
+	}
+    }
+}
+
+static void vl_chunked_restore_worker(VerilatedChunkedJob* jobp) {
+    VerilatedRestoreChunkBuf buf;
+    for (int chunk = jobp->claim(); chunk < jobp->m_chunks; chunk = jobp->claim()) {
+	buf.m_data.resize(jobp->m_sizes[chunk]);
+	if (!buf.m_data.empty()
+	    && !vl_chunked_pread(jobp->m_fd, &buf.m_data[0], buf.m_data.size(),
+				 jobp->m_offsets[chunk])) {
+	    jobp->m_failed = true;
+	    continue;
+	}
+	buf.start();
+	jobp->m_restoreCb(jobp->m_modelp, chunk, buf);
+	buf.close();
+    }
+}
+
+static void vl_chunked_run(VerilatedChunkedJob* jobp, int threads, void (*workerp)(VerilatedChunkedJob*)) {
+#ifdef VL_THREADED
+    vector<std::thread> workers;
+    for (int i=1; i<threads && i<jobp->m_chunks; ++i) workers.push_back(std::thread(workerp, jobp));
+    workerp(jobp);  // The calling thread works too
+    for (size_t i=0; i<workers.size(); ++i) workers[i].join();
+#else
+    if (threads > 1) {
+	vl_fatal(__FILE__,__LINE__,"","VerilatedSaveChunked::threads() above 1 requires compiling with VL_THREADED");
+    }
+    workerp(jobp);
+#endif
+}
+
+bool VerilatedSaveChunked::saveChunks(const char* filenamep, void* modelp, int chunks, ChunkCb cb) {
+    VL_DEBUG_IF(VL_PRINTF("-vltSave: opening chunked save file %s\n",filenamep););
+    // cppcheck-suppress duplicateExpression
+    int fd = ::open(filenamep, O_CREAT|O_WRONLY|O_TRUNC|O_LARGEFILE, 0666);
+    if (fd < 0) return false;
+    VerilatedChunkedJob job (fd, modelp, chunks);
+    job.m_saveCb = cb;
+    // Header, with the index's offset filled in once known
+    vluint64_t stateSize = Verilated::serializedSize();
+    vluint64_t headerSize = strlen(VLTSAVE_CHUNKED_STR) + 2*sizeof(vluint64_t);
+    job.m_nextOffset = headerSize + stateSize;
+    bool ok = (vl_chunked_pwrite(fd, &stateSize, sizeof(stateSize), headerSize - sizeof(vluint64_t))
+	       && vl_chunked_pwrite(fd, Verilated::serializedPtr(), stateSize, headerSize));
+    if (ok) {
+	vl_chunked_run(&job, m_threads, &vl_chunked_save_worker);
+	ok = !job.m_failed;
+    }
+    // Index and trailer
+    vluint64_t indexOffset = job.m_nextOffset;
+    vector<vluint64_t> index;
+    index.push_back(chunks);
+    for (int i=0; i<chunks; ++i) {
+	index.push_back(job.m_offsets[i]);
+	index.push_back(job.m_sizes[i]);
+    }
+    ok = ok && vl_chunked_pwrite(fd, &index[0], index.size()*sizeof(vluint64_t), indexOffset);
+    ok = ok && vl_chunked_pwrite(fd, VLTSAVE_TRAILER_STR, strlen(VLTSAVE_TRAILER_STR),
+				 indexOffset + index.size()*sizeof(vluint64_t));
+    // Written last, so an interrupted save has no index
+    ok = ok && vl_chunked_pwrite(fd, VLTSAVE_CHUNKED_STR, strlen(VLTSAVE_CHUNKED_STR), 0);
+    ok = ok && vl_chunked_pwrite(fd, &indexOffset, sizeof(indexOffset), strlen(VLTSAVE_CHUNKED_STR));
+    if (::close(fd)) ok = false;
+    return ok;
+}
+
+bool VerilatedRestoreChunked::restoreChunks(const char* filenamep, void* modelp, int chunks, ChunkCb cb) {
+    VL_DEBUG_IF(VL_PRINTF("-vltRestore: opening chunked restore file %s\n",filenamep););
+    // cppcheck-suppress duplicateExpression
+    int fd = ::open(filenamep, O_RDONLY|O_LARGEFILE);
+    if (fd < 0) return false;
+    VerilatedChunkedJob job (fd, modelp, chunks);
+    job.m_restoreCb = cb;
+    size_t siglen = strlen(VLTSAVE_CHUNKED_STR);
+    char sig[16];
+    vluint64_t indexOffset = 0;
+    vluint64_t stateSize = 0;
+    if (!vl_chunked_pread(fd, sig, siglen, 0)
+	|| 0!=memcmp(sig, VLTSAVE_CHUNKED_STR, siglen)
+	|| !vl_chunked_pread(fd, &indexOffset, sizeof(indexOffset), siglen)
+	|| !vl_chunked_pread(fd, &stateSize, sizeof(stateSize), siglen + sizeof(vluint64_t))) {
+	string msg = (string)"Can't deserialize; file has wrong header signature";
+	vl_fatal(filenamep, 0, "", msg.c_str());
+	::close(fd);
+	return false;
+    }
+    vector<vluint64_t> index (1 + 2*chunks);
+    char trailer[8];
+    if (stateSize != Verilated::serializedSize()
+	|| !vl_chunked_pread(fd, &index[0], sizeof(vluint64_t), indexOffset)
+	|| index[0] != (vluint64_t)chunks) {
+	string msg = (string)"Can't deserialize save-restore file as was made from different model";
+	vl_fatal(filenamep, 0, "", msg.c_str());
+	::close(fd);
+	return false;
+    }
+    if (!vl_chunked_pread(fd, &index[0], index.size()*sizeof(vluint64_t), indexOffset)
+	|| !vl_chunked_pread(fd, trailer, strlen(VLTSAVE_TRAILER_STR),
+			     indexOffset + index.size()*sizeof(vluint64_t))
+	|| 0!=memcmp(trailer, VLTSAVE_TRAILER_STR, strlen(VLTSAVE_TRAILER_STR))) {
+	string msg = (string)"Can't deserialize; file has wrong end-of-file signature";
+	vl_fatal(filenamep, 0, "", msg.c_str());
+	::close(fd);
+	return false;
+    }
+    for (int i=0; i<chunks; ++i) {
+	job.m_offsets[i] = index[1 + 2*i];
+	job.m_sizes[i] = index[2 + 2*i];
+    }
+    bool ok = vl_chunked_pread(fd, Verilated::serializedPtr(), stateSize,
+			       siglen + 2*sizeof(vluint64_t));
+    if (ok) {
+	vl_chunked_run(&job, m_threads, &vl_chunked_restore_worker);
+	ok = !job.m_failed;
+    }
+    ::close(fd);
+    return ok;
+}
+
 //=============================================================================
 // Serialization of types
 
@@ -23,8 +23,11 @@
 #define _VERILATED_SAVE_C_H_ 1
 
 #include "verilatedos.h"
+#include "verilated.h"
 
+#include <cstring>
 #include <string>
+#include <vector>
 using namespace std;
 
 //=============================================================================
@@ -90,8 +93,8 @@ public:
 	while (size) {
 	    bufferCheck();
 	    size_t blk = size;  if (blk>bufferInsertSize()) blk = bufferInsertSize();
-	    const vluint8_t* __restrict maxp = dp + blk;
-	    while (dp < maxp) *m_cp++ = *dp++;
+	    memcpy(m_cp, dp, blk);
+	    m_cp += blk; dp += blk;
 	    size -= blk;
 	}
 	return *this;  // For function chaining
@@ -117,8 +120,8 @@ public:
 	while (size) {
 	    bufferCheck();
 	    size_t blk = size;  if (blk>bufferInsertSize()) blk = bufferInsertSize();
-	    const vluint8_t* __restrict maxp = dp + blk;
-	    while (dp < maxp) *dp++ = *m_cp++;
+	    memcpy(dp, m_cp, blk);
+	    m_cp += blk; dp += blk;
 	    size -= blk;
 	}
 	return *this;  // For function chaining
@@ -140,19 +143,43 @@ public:
 //=============================================================================
 // VerilatedSave - serialize to a file
 
+class VerilatedSaveAsync;
+
 class VerilatedSave : public VerilatedSerialize {
 private:
     int			m_fd;		///< File descriptor we're writing to
+    bool		m_compress;	///< Compress the file, set by compress()
+    bool		m_async;	///< Write from a thread, set by async()
+    VerilatedSaveAsync*	m_asyncp;	///< Writer thread state, when running
+    vluint8_t*		m_spareBufp;	///< Buffer the writer thread isn't using
+    vector<vluint8_t>	m_zbuf;		///< Compressed frame being written
+
+    void writeBuffer(const vluint8_t* datap, size_t size);
+    void writeRaw(const vluint8_t* datap, size_t size);
+    void asyncStart();
+    void asyncPost(bool closeFd);
+    void asyncStop();
+    void asyncWriterLoop();
+    friend class VerilatedSaveAsync;
 
 public:
     // CREATORS
-    VerilatedSave() { m_fd=-1; }
-    virtual ~VerilatedSave() { close(); }
+    VerilatedSave() { m_fd=-1; m_compress=false; m_async=false; m_asyncp=NULL; m_spareBufp=NULL; }
+    virtual ~VerilatedSave();
     // METHODS
+    /// Compress the file as it is written; VerilatedRestore detects this by itself.
+    /// Must be called before open().
+    void compress(bool flag) { m_compress = flag; }
+    /// Compress and write from a separate thread, so the model can continue
+    /// while the save completes.  Requires VL_THREADED.  Must be called before open().
+    /// close() returns without waiting for the file; a later open(), wait()
+    /// or destroying this object waits.
+    void async(bool flag) { m_async = flag; }
     void open(const char* filenamep);	///< Open the file; call isOpen() to see if errors
     void open(const string& filename) { open(filename.c_str()); }
     virtual void close();
     virtual void flush();
+    void wait();	///< Wait for an async() save to be completely written
 };
 
 //=============================================================================
@@ -161,10 +188,16 @@ public:
 class VerilatedRestore : public VerilatedDeserialize {
 private:
     int			m_fd;		///< File descriptor we're writing to
+    bool		m_compressed;	///< File was written with VerilatedSave::compress()
+    vector<vluint8_t>	m_zbuf;		///< Compressed frame being read
+    vector<vluint8_t>	m_frame;	///< Decompressed frame
+    size_t		m_framePos;	///< Next byte to use in m_frame
+
+    ssize_t readFrame(vluint8_t* datap, size_t size);
 
 public:
     // CREATORS
-    VerilatedRestore() { m_fd=-1; }
+    VerilatedRestore() { m_fd=-1; m_compressed=false; m_framePos=0; }
     virtual ~VerilatedRestore() { close(); }
 
     // METHODS
@@ -175,6 +208,177 @@ public:
     virtual void fill();
 };
 
+//=============================================================================
+// VerilatedSaveDelta - serialize to a file, only writing what changed
+//
+// Keep one object across a series of checkpoints.  The first checkpoint
+// after construction (or fullNext()) is a full base; each later one only
+// stores the blocks of the stream that differ from the previous checkpoint,
+// as found by comparing a hash of every block.  Restore with
+// VerilatedRestoreDelta, adding the base and each later delta in order.
+
+class VerilatedSaveDelta : public VerilatedSerialize {
+private:
+    int			m_fd;		///< File descriptor we're writing to
+    vluint8_t*		m_blockp;	///< Block being assembled
+    size_t		m_blockFill;	///< Bytes in m_blockp
+    vluint64_t		m_blockIndex;	///< Index of block in m_blockp
+    vector<vluint64_t>	m_hashes;	///< Hash of each block in previous checkpoint
+    vluint64_t		m_baseId;	///< Identifies the base of the series
+    vluint64_t		m_seq;		///< Checkpoints since base
+    vluint64_t		m_blocksWritten;	///< Blocks written this checkpoint
+    void writeBytes(const void* datap, size_t size);
+    void blockDone();
+public:
+    // CREATORS
+    VerilatedSaveDelta();
+    virtual ~VerilatedSaveDelta();
+    // METHODS
+    static size_t blockSize() { return 64*1024; }
+    void open(const char* filenamep);	///< Open the file; call isOpen() to see if errors
+    void open(const string& filename) { open(filename.c_str()); }
+    virtual void close();
+    virtual void flush();
+    void fullNext() { m_hashes.clear(); }	///< Make the next checkpoint a full base
+    vluint64_t blocksWritten() const { return m_blocksWritten; }	///< In last checkpoint
+};
+
+//=============================================================================
+// VerilatedRestoreDelta - deserialize from a VerilatedSaveDelta base plus deltas
+
+class VerilatedRestoreDelta : public VerilatedDeserialize {
+private:
+    struct Block {
+	int		m_file;		///< Index into m_fds
+	vluint64_t	m_offset;	///< Data offset in file
+	vluint32_t	m_size;		///< Bytes in block
+	Block() : m_file(-1), m_offset(0), m_size(0) {}
+    };
+    vector<int>		m_fds;		///< Files added
+    vector<Block>	m_blocks;	///< Where each block's latest contents are
+    vluint64_t		m_baseId;	///< Identifies the base of the series
+    size_t		m_readBlock;	///< Block being read
+    size_t		m_readOffset;	///< Bytes read of m_readBlock
+    bool readBytes(int fd, void* datap, size_t size);
+
+public:
+    // CREATORS
+    VerilatedRestoreDelta() { m_baseId=0; m_readBlock=0; m_readOffset=0; }
+    virtual ~VerilatedRestoreDelta() { close(); }
+
+    // METHODS
+    void add(const char* filenamep);	///< Add base, then each delta, in order
+    void add(const string& filename) { add(filename.c_str()); }
+    void open();	///< Open after adding files; call isOpen() to see if errors
+    virtual void close();
+    virtual void flush() {}
+    virtual void fill();
+};
+
+//=============================================================================
+// VerilatedSaveMem - serialize to a snapshot in memory
+//
+// For restoring the same state many times, e.g. after reset, without file
+// I/O.  A snapshot may be restored any number of times with VerilatedRestoreMem.
+
+class VerilatedSaveMem : public VerilatedSerialize {
+private:
+    vector<vluint8_t>	m_data;		///< Snapshot contents
+public:
+    // CREATORS
+    VerilatedSaveMem() {}
+    virtual ~VerilatedSaveMem() { close(); }
+    // METHODS
+    void open();	///< Start a new snapshot, discarding any previous one
+    virtual void close();
+    virtual void flush();
+    const vluint8_t* data() const { return m_data.empty() ? NULL : &m_data[0]; }
+    size_t size() const { return m_data.size(); }	///< Bytes in snapshot
+};
+
+//=============================================================================
+// VerilatedRestoreMem - deserialize from a VerilatedSaveMem snapshot
+//
+// Reads directly from the snapshot, which must be closed, and must not be
+// changed or destroyed until this is closed.
+
+class VerilatedRestoreMem : public VerilatedDeserialize {
+private:
+    vluint8_t*		m_ownBufp;	///< Our buffer, while m_bufp points into the snapshot
+public:
+    // CREATORS
+    VerilatedRestoreMem() { m_ownBufp=NULL; }
+    virtual ~VerilatedRestoreMem() { close(); }
+    // METHODS
+    void open(const VerilatedSaveMem& snapshot);	///< Open the snapshot; call isOpen() to see if errors
+    virtual void close();
+    virtual void flush() {}
+    virtual void fill();
+};
+
+//=============================================================================
+// VerilatedSaveChunked - serialize a model as independent chunks, on threads
+//
+// Each instance of a model Verilated with --savable is a separate chunk.
+// Chunks are serialized by whichever thread is free, each into its own
+// buffer, and written at the file's next free offset.  The file ends with
+// an index of where each chunk is, so VerilatedRestoreChunked can restore
+// them on threads also.  Without VL_THREADED the chunks are done in turn.
+// Only VerilatedRestoreChunked reads these files.
+
+class VerilatedSaveChunked {
+public:
+    typedef void (*ChunkCb)(void* modelp, int chunk, VerilatedSerialize& os);
+private:
+    int			m_threads;	///< Threads to use, including the caller
+    bool saveChunks(const char* filenamep, void* modelp, int chunks, ChunkCb cb);
+    template <class T_Model> static void chunkCb(void* modelp, int chunk, VerilatedSerialize& os) {
+	static_cast<T_Model*>(modelp)->__VserializeChunk(chunk, os);
+    }
+public:
+    // CREATORS
+    VerilatedSaveChunked() : m_threads(1) {}
+    // METHODS
+    /// Threads to serialize on, including the calling thread.  More than one requires VL_THREADED.
+    void threads(int n) { m_threads = n < 1 ? 1 : n; }
+    int threads() const { return m_threads; }
+    /// Save the model's state.  Returns false if the file can't be written.
+    template <class T_Model> bool save(const char* filenamep, T_Model& model) {
+	return saveChunks(filenamep, &model, model.__Vchunks(), &chunkCb<T_Model>);
+    }
+    template <class T_Model> bool save(const string& filename, T_Model& model) {
+	return save(filename.c_str(), model);
+    }
+};
+
+//=============================================================================
+// VerilatedRestoreChunked - deserialize a VerilatedSaveChunked file, on threads
+
+class VerilatedRestoreChunked {
+public:
+    typedef void (*ChunkCb)(void* modelp, int chunk, VerilatedDeserialize& os);
+private:
+    int			m_threads;	///< Threads to use, including the caller
+    bool restoreChunks(const char* filenamep, void* modelp, int chunks, ChunkCb cb);
+    template <class T_Model> static void chunkCb(void* modelp, int chunk, VerilatedDeserialize& os) {
+	static_cast<T_Model*>(modelp)->__VdeserializeChunk(chunk, os);
+    }
+public:
+    // CREATORS
+    VerilatedRestoreChunked() : m_threads(1) {}
+    // METHODS
+    /// Threads to deserialize on, including the calling thread.  More than one requires VL_THREADED.
+    void threads(int n) { m_threads = n < 1 ? 1 : n; }
+    int threads() const { return m_threads; }
+    /// Restore the model's state.  Returns false if the file can't be read.
+    template <class T_Model> bool restore(const char* filenamep, T_Model& model) {
+	return restoreChunks(filenamep, &model, model.__Vchunks(), &chunkCb<T_Model>);
+    }
+    template <class T_Model> bool restore(const string& filename, T_Model& model) {
+	return restore(filename.c_str(), model);
+    }
+};
+
 //=============================================================================
 
 inline VerilatedSerialize&   operator<<(VerilatedSerialize& os,   vluint64_t& rhs) {
@@ -230,5 +434,38 @@ inline VerilatedDeserialize& operator>>(VerilatedDeserialize& os, string& rhs) {
     rhs.resize(len);
     return os.read((void*)rhs.data(), len);
 }
+template <class T_Entry, int T_Width, vluint64_t T_Depth>
+VerilatedSerialize& operator<<(VerilatedSerialize& os, VlSparseArray<T_Entry,T_Width,T_Depth>& rhs) {
+    // Only pages ever accessed are saved, each preceded by its page number
+    typedef typename VlSparseArray<T_Entry,T_Width,T_Depth>::Page Page;
+    vluint64_t used = 0;
+    for (size_t pg=0; pg<rhs.pages(); ++pg) if (rhs.pagep(pg)) ++used;
+    os<<used;
+    for (size_t pg=0; pg<rhs.pages(); ++pg) {
+	if (Page* pagep = rhs.pagep(pg)) {
+	    vluint64_t pgnum = pg;
+	    os<<pgnum;
+	    os.write(pagep, sizeof(Page));
+	}
+    }
+    return os;
+}
+template <class T_Entry, int T_Width, vluint64_t T_Depth>
+VerilatedDeserialize& operator>>(VerilatedDeserialize& os, VlSparseArray<T_Entry,T_Width,T_Depth>& rhs) {
+    typedef typename VlSparseArray<T_Entry,T_Width,T_Depth>::Page Page;
+    rhs.clear();
+    vluint64_t used = 0;
+    os>>used;
+    for (vluint64_t i=0; i<used; ++i) {
+	vluint64_t pgnum = 0;
+	os>>pgnum;
+	if (VL_UNLIKELY(pgnum >= rhs.pages())) {
+	    vl_fatal("", 0, "", "Restore of sparse memory page beyond bounds of array");
+	    return os;
+	}
+	os.read(rhs.pageNewp((size_t)pgnum), sizeof(Page));
+    }
+    return os;
+}
 
 #endif // guard
@@ -0,0 +1,195 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//=============================================================================
+//
+// THIS MODULE IS PUBLICLY LICENSED
+//
+// Copyright 2017 by Wilson Snyder.  This program is free software;
+// you can redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License Version 2.0.
+//
+// This is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+//=============================================================================
+///
+/// \file
+/// \brief Live streaming of trace data through a shared memory ring
+///
+//=============================================================================
+
+#include "verilatedos.h"
+#include "verilated.h"
+#include "verilated_shm.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//=============================================================================
+// Shared file layout
+//
+//   The positions are on their own cache lines, as the writer and reader
+//   each update one.  They count bytes since the stream started; the ring
+//   holds (write - read) unread bytes, the next at (read % capacity).
+
+static const vluint64_t VL_SHM_MAGIC = VL_ULL(0x564c53484d523031);  // "VLSHMR01"
+enum { VL_SHM_MAGIC_W = 0, VL_SHM_CAPACITY_W = 1, VL_SHM_CLOSED_W = 2,  // Header line
+       VL_SHM_WRITE_W = 8,	// Writer's position
+       VL_SHM_READ_W = 16 };	// Reader's position
+static const size_t VL_SHM_HEADER = 192;
+
+static inline volatile vluint64_t* vl_shm_word(vluint8_t* basep, int word) {
+    return ((volatile vluint64_t*)basep) + word;
+}
+
+static inline void vl_shm_wait(int& spins) {
+    // Spin briefly, as the other side is usually running, then yield
+    if (++spins > 1000) sched_yield();
+}
+
+//=============================================================================
+// VerilatedShmFile
+
+VerilatedShmFile::VerilatedShmFile(size_t capacity)
+    : m_capacity(capacity), m_fd(-1), m_basep(NULL) {}
+
+VerilatedShmFile::~VerilatedShmFile() {
+    close();
+}
+
+bool VerilatedShmFile::open(const string& name) {
+    close();
+    // Build the ring under a temporary name and rename it into place, so a
+    // reader never maps a ring being sized, nor has a previous run's ring
+    // truncated under it
+    string tmpName = name + ".tmp";
+    size_t mapBytes = VL_SHM_HEADER + m_capacity;
+    m_fd = ::open(tmpName.c_str(), O_RDWR|O_CREAT|O_TRUNC, 0666);
+    if (m_fd < 0) return false;
+    void* mapp = MAP_FAILED;
+    if (!ftruncate(m_fd, mapBytes)) {
+	mapp = mmap(NULL, mapBytes, PROT_READ|PROT_WRITE, MAP_SHARED, m_fd, 0);
+    }
+    if (mapp == MAP_FAILED) { ::close(m_fd); m_fd = -1; unlink(tmpName.c_str()); return false; }
+    m_basep = (vluint8_t*)mapp;
+    *vl_shm_word(m_basep, VL_SHM_CAPACITY_W) = m_capacity;
+    __sync_synchronize();
+    *vl_shm_word(m_basep, VL_SHM_MAGIC_W) = VL_SHM_MAGIC;
+    if (rename(tmpName.c_str(), name.c_str())) {
+	munmap(m_basep, mapBytes); m_basep = NULL;
+	::close(m_fd); m_fd = -1;
+	unlink(tmpName.c_str());
+	return false;
+    }
+    return true;
+}
+
+void VerilatedShmFile::close() {
+    if (m_basep) {
+	__sync_synchronize();
+	*vl_shm_word(m_basep, VL_SHM_CLOSED_W) = 1;
+	munmap(m_basep, VL_SHM_HEADER + m_capacity); m_basep = NULL;
+    }
+    if (m_fd >= 0) { ::close(m_fd); m_fd = -1; }
+}
+
+ssize_t VerilatedShmFile::write(const char* bufp, ssize_t len) {
+    if (VL_UNLIKELY(!m_basep)) return -1;
+    volatile vluint64_t* writep = vl_shm_word(m_basep, VL_SHM_WRITE_W);
+    volatile vluint64_t* readp = vl_shm_word(m_basep, VL_SHM_READ_W);
+    vluint8_t* datap = m_basep + VL_SHM_HEADER;
+    vluint64_t wpos = *writep;
+    ssize_t done = 0;
+    while (done < len) {
+	// Wait for the reader to free space
+	size_t space;
+	int spins = 0;
+	while (0 == (space = m_capacity - (size_t)(wpos - *readp))) vl_shm_wait(spins);
+	__sync_synchronize();
+	size_t offset = (size_t)(wpos % m_capacity);
+	size_t chunk = min(min(space, m_capacity - offset), (size_t)(len - done));
+	memcpy(datap + offset, bufp + done, chunk);
+	done += chunk;
+	wpos += chunk;
+	__sync_synchronize();
+	*writep = wpos;
+    }
+    return done;
+}
+
+//=============================================================================
+// VerilatedShmReader
+
+bool VerilatedShmReader::open(const char* filenamep) {
+    close();
+    // Wait for the simulation to create the ring; it appears complete
+    struct stat st;
+    while (1) {
+	if (m_fd < 0) m_fd = ::open(filenamep, O_RDWR);
+	if (m_fd >= 0 && !fstat(m_fd, &st) && (size_t)st.st_size > VL_SHM_HEADER) break;
+	usleep(1000);
+    }
+    m_mapBytes = st.st_size;
+    void* mapp = mmap(NULL, m_mapBytes, PROT_READ|PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if (mapp == MAP_FAILED) {
+	VL_PRINTF("%%Error: VerilatedShmReader can't map %s: %s\n", filenamep, strerror(errno));
+	::close(m_fd); m_fd = -1;
+	return false;
+    }
+    m_basep = (vluint8_t*)mapp;
+    int spins = 0;
+    while (*vl_shm_word(m_basep, VL_SHM_MAGIC_W) != VL_SHM_MAGIC) vl_shm_wait(spins);
+    __sync_synchronize();
+    m_capacity = *vl_shm_word(m_basep, VL_SHM_CAPACITY_W);
+    if (VL_SHM_HEADER + m_capacity != m_mapBytes) {
+	VL_PRINTF("%%Error: VerilatedShmReader %s is not a complete ring\n", filenamep);
+	close();
+	return false;
+    }
+    return true;
+}
+
+void VerilatedShmReader::close() {
+    if (m_basep) { munmap(m_basep, m_mapBytes); m_basep = NULL; }
+    if (m_fd >= 0) { ::close(m_fd); m_fd = -1; }
+}
+
+size_t VerilatedShmReader::peek(const char** datapp) {
+    volatile vluint64_t* writep = vl_shm_word(m_basep, VL_SHM_WRITE_W);
+    vluint64_t rpos = *vl_shm_word(m_basep, VL_SHM_READ_W);
+    size_t avail;
+    int spins = 0;
+    while (0 == (avail = (size_t)(*writep - rpos))) {
+	if (*vl_shm_word(m_basep, VL_SHM_CLOSED_W)) {
+	    // Closed after the last write, so recheck for data written before it
+	    __sync_synchronize();
+	    if (*writep == rpos) return 0;
+	} else {
+	    vl_shm_wait(spins);
+	}
+    }
+    __sync_synchronize();
+    size_t offset = (size_t)(rpos % m_capacity);
+    *datapp = (const char*)(m_basep + VL_SHM_HEADER + offset);
+    return min(avail, m_capacity - offset);
+}
+
+void VerilatedShmReader::consume(size_t bytes) {
+    __sync_synchronize();  // Done with the data before the writer may reuse it
+    *vl_shm_word(m_basep, VL_SHM_READ_W) += bytes;
+}
+
+size_t VerilatedShmReader::read(char* bufp, size_t len) {
+    const char* datap = NULL;
+    size_t got = min(peek(&datap), len);
+    memcpy(bufp, datap, got);
+    consume(got);
+    return got;
+}
@@ -0,0 +1,97 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//=============================================================================
+//
+// THIS MODULE IS PUBLICLY LICENSED
+//
+// Copyright 2017 by Wilson Snyder.  This program is free software;
+// you can redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License Version 2.0.
+//
+// This is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+//=============================================================================
+///
+/// \file
+/// \brief Live streaming of trace data through a shared memory ring
+///
+///	VerilatedShmFile is a trace file sink that writes into a ring in a
+///	shared memory file, rather than to disk.  Given to VerilatedBinC (or
+///	VerilatedVcdC) it streams the trace to a viewer or monitor in another
+///	process, which reads the ring in place with VerilatedShmReader.
+///
+///	Like a pipe, the ring is lossless: when it is full, the simulation
+///	waits for the reader.
+///
+//=============================================================================
+
+#ifndef _VERILATED_SHM_H_
+#define _VERILATED_SHM_H_ 1
+
+#include "verilatedos.h"
+#include "verilated_vcd_c.h"
+
+#include <string>
+using namespace std;
+
+//=============================================================================
+// VerilatedShmFile
+/// Trace file sink writing to a shared memory ring
+
+class VerilatedShmFile : public VerilatedVcdFile {
+    // MEMBERS
+    size_t		m_capacity;	///< Ring data bytes
+    int			m_fd;		///< Shared file descriptor, or -1
+    vluint8_t*		m_basep;	///< Shared mapping, or NULL
+private:
+    VerilatedShmFile(const VerilatedShmFile&);	///< N/A, no copy constructor
+    VerilatedShmFile& operator=(const VerilatedShmFile&);	///< N/A, no assignment
+public:
+    // CREATORS
+    /// Ring of the given bytes; larger rings let the simulation run further ahead of the reader
+    explicit VerilatedShmFile(size_t capacity = 16*1024*1024);
+    virtual ~VerilatedShmFile();
+    // METHODS
+    /// Create the shared file, for example under /dev/shm, replacing any existing.
+    /// It's built under name.tmp and renamed, so readers only see a complete ring
+    virtual bool open(const string& name);
+    /// Mark the stream ended, so the reader sees end of file once it reads the rest
+    virtual void close();
+    /// Copy into the ring, waiting for the reader as needed
+    virtual ssize_t write(const char* bufp, ssize_t len);
+};
+
+//=============================================================================
+// VerilatedShmReader
+/// Reader of a VerilatedShmFile ring, in another process
+
+class VerilatedShmReader {
+    // MEMBERS
+    int			m_fd;		///< Shared file descriptor, or -1
+    vluint8_t*		m_basep;	///< Shared mapping, or NULL
+    size_t		m_mapBytes;	///< Size of mapping
+    size_t		m_capacity;	///< Ring data bytes
+private:
+    VerilatedShmReader(const VerilatedShmReader&);	///< N/A, no copy constructor
+    VerilatedShmReader& operator=(const VerilatedShmReader&);	///< N/A, no assignment
+public:
+    // CREATORS
+    VerilatedShmReader() : m_fd(-1), m_basep(NULL), m_mapBytes(0), m_capacity(0) {}
+    ~VerilatedShmReader() { close(); }
+    // METHODS
+    /// Attach to a ring, waiting for the simulation to create it.  Returns false on error
+    bool open(const char* filenamep);
+    void close();
+    bool isOpen() const { return m_basep != NULL; }
+    /// Wait for data, and point to the next contiguous bytes in the ring,
+    /// without copying.  Returns how many, or 0 at end of stream.
+    size_t peek(const char** datapp);
+    /// Release bytes returned by peek() back to the writer
+    void consume(size_t bytes);
+    /// Copy up to len bytes out of the ring.  Returns how many, or 0 at end of stream
+    size_t read(char* bufp, size_t len);
+};
+
+#endif  // guard
@@ -31,6 +31,7 @@
 #include "verilated_heavy.h"
 
 #include <map>
+#include <vector>
 
 //===========================================================================
 /// Verilator range
@@ -62,11 +63,13 @@ class VerilatedVar {
     VerilatedRange	m_array;	// Array
     int			m_dims;		// Dimensions
     const char*		m_namep;	// Name - slowpath
+    CData*		m_chgp;		// Set when written, see VL_VPI_CHG; NULL if not marked
 protected:
     friend class VerilatedScope;
     VerilatedVar(const char* namep, void* datap,
 		 VerilatedVarType vltype, VerilatedVarFlags vlflags, int dims)
-	: m_datap(datap), m_vltype(vltype), m_vlflags(vlflags), m_dims(dims), m_namep(namep) {}
+	: m_datap(datap), m_vltype(vltype), m_vlflags(vlflags), m_dims(dims), m_namep(namep)
+	, m_chgp(NULL) {}
 public:
     ~VerilatedVar() {}
     void* datap() const { return m_datap; }
@@ -78,6 +81,7 @@ public:
     const VerilatedRange& array() const { return m_array; }
     const char* name() const { return m_namep; }
     int dims() const { return m_dims; }
+    CData* chgp() const { return m_chgp; }
 };
 
 //======================================================================
@@ -90,17 +94,111 @@ struct VerilatedCStrCmp {
     }
 };
 
+/// Hashed index of names, kept beside an ordered map for constant time
+/// lookups.  Open addressing with linear probing; T must be a pointer.
+
+template <class T> class VerilatedCStrHashIndex {
+    struct Entry {
+	const char*	m_namep;	// NULL if empty
+	vluint32_t	m_hash;
+	T		m_value;
+    };
+    vector<Entry>	m_entries;	// Power-of-2 sized
+    size_t		m_used;
+public:
+    VerilatedCStrHashIndex() : m_used(0) {}
+    ~VerilatedCStrHashIndex() {}
+    static vluint32_t hash(const char* namep) {
+	vluint32_t h = 2166136261U;  // FNV-1a
+	while (*namep) { h ^= (vluint8_t)*namep++; h *= 16777619U; }
+	return h;
+    }
+    T find(const char* namep) const {
+	if (VL_UNLIKELY(m_entries.empty())) return NULL;
+	vluint32_t h = hash(namep);
+	size_t mask = m_entries.size()-1;
+	for (size_t i = h & mask; m_entries[i].m_namep; i = (i+1) & mask) {
+	    if (m_entries[i].m_hash == h && 0==std::strcmp(m_entries[i].m_namep, namep)) {
+		return m_entries[i].m_value;
+	    }
+	}
+	return NULL;
+    }
+    void insert(const char* namep, T value) {
+	// Caller ensures namep isn't already present
+	if ((m_used+1)*4 > m_entries.size()*3) rehash(m_entries.empty() ? 16 : m_entries.size()*2);
+	vluint32_t h = hash(namep);
+	size_t mask = m_entries.size()-1;
+	size_t i = h & mask;
+	while (m_entries[i].m_namep) i = (i+1) & mask;
+	m_entries[i].m_namep = namep;
+	m_entries[i].m_hash = h;
+	m_entries[i].m_value = value;
+	++m_used;
+    }
+    void erase(const char* namep) {
+	if (m_entries.empty()) return;
+	vluint32_t h = hash(namep);
+	size_t mask = m_entries.size()-1;
+	size_t i = h & mask;
+	for (; m_entries[i].m_namep; i = (i+1) & mask) {
+	    if (m_entries[i].m_hash == h && 0==std::strcmp(m_entries[i].m_namep, namep)) break;
+	}
+	if (!m_entries[i].m_namep) return;
+	// Shift later entries of the probe sequence back, so no tombstones are needed
+	for (size_t j = (i+1) & mask; m_entries[j].m_namep; j = (j+1) & mask) {
+	    size_t home = m_entries[j].m_hash & mask;
+	    if (((j - home) & mask) >= ((j - i) & mask)) {
+		m_entries[i] = m_entries[j];
+		i = j;
+	    }
+	}
+	m_entries[i].m_namep = NULL;
+	--m_used;
+    }
+private:
+    void rehash(size_t size) {
+	vector<Entry> old;
+	old.swap(m_entries);
+	Entry empty;  empty.m_namep = NULL;  empty.m_hash = 0;  empty.m_value = NULL;
+	m_entries.resize(size, empty);
+	m_used = 0;
+	for (typename vector<Entry>::iterator it = old.begin(); it != old.end(); ++it) {
+	    if (it->m_namep) insert(it->m_namep, it->m_value);
+	}
+    }
+};
+
 class VerilatedScopeNameMap
     : public map<const char*, const VerilatedScope*, VerilatedCStrCmp> {
+    VerilatedCStrHashIndex<const VerilatedScope*> m_index;	///< Hashed index of above
+    VerilatedScopeNameMap(const VerilatedScopeNameMap&);	///< N/A, no copy constructor
 public:
     VerilatedScopeNameMap() {}
     ~VerilatedScopeNameMap() {}
+    // Use these instead of insert/erase, so the index stays in step
+    void insertIndexed(const char* namep, const VerilatedScope* scopep) {
+	if (insert(make_pair(namep,scopep)).second) m_index.insert(namep, scopep);
+    }
+    void eraseIndexed(const char* namep) {
+	iterator it = find(namep);
+	if (it != end()) { m_index.erase(it->first); erase(it); }
+    }
+    const VerilatedScope* findp(const char* namep) const { return m_index.find(namep); }
 };
 
 class VerilatedVarNameMap : public map<const char*, VerilatedVar, VerilatedCStrCmp> {
+    VerilatedCStrHashIndex<VerilatedVar*> m_index;	///< Hashed index of above
+    VerilatedVarNameMap(const VerilatedVarNameMap&);	///< N/A, no copy constructor
 public:
     VerilatedVarNameMap() {}
     ~VerilatedVarNameMap() {}
+    // Use instead of insert, so the index stays in step
+    void insertIndexed(const char* namep, const VerilatedVar& var) {
+	pair<iterator,bool> itb = insert(make_pair(namep,var));
+	if (itb.second) m_index.insert(namep, &(itb.first->second));
+    }
+    VerilatedVar* findp(const char* namep) const { return m_index.find(namep); }
 };
 
 #endif // Guard
@@ -0,0 +1,203 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//=============================================================================
+//
+// THIS MODULE IS PUBLICLY LICENSED
+//
+// Copyright 2017-2017 by Wilson Snyder.  This program is free software;
+// you can redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License Version 2.0.
+//
+// This is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+//=============================================================================
+///
+/// \file
+/// \brief Thread pool for verilated models built with --threads
+///
+//=============================================================================
+
+#include "verilated_threads.h"
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <set>
+#include <string>
+#ifdef __linux__
+# include <sched.h>
+# include <dirent.h>
+#endif
+
+//=============================================================================
+// VlThreadPool
+//
+// Group state is only changed by the caller, under the mutex, when no worker
+// is inside runTasks(); so workers read it without further locking, and a
+// worker waking late can never claim tasks from a stale group.
+
+#ifdef CPU_SETSIZE
+# define VL_CPUS_MAX CPU_SETSIZE  // Higher CPUs can't be put in a cpu_set_t
+#else
+# define VL_CPUS_MAX 1024
+#endif
+
+static std::vector<int> vl_parse_cpus(const char* cpusp) {
+    // Parse a list such as "0,2,4-7"
+    std::vector<int> cpus;
+    const char* cp = cpusp;
+    while (*cp) {
+	const char* entryp = cp;
+	char* endp;
+	long first = strtol(cp, &endp, 10);
+	if (endp == cp || first < 0 || first >= VL_CPUS_MAX) break;
+	long last = first;
+	cp = endp;
+	if (*cp == '-') {
+	    last = strtol(cp+1, &endp, 10);
+	    if (endp == cp+1 || last < first || last >= VL_CPUS_MAX) { cp = entryp; break; }
+	    cp = endp;
+	}
+	for (long cpu=first; cpu<=last; ++cpu) cpus.push_back((int)cpu);
+	if (*cp != ',') break;
+	++cp;
+    }
+    if (*cp) VL_PRINTF("%%Warning: Ignoring bad +verilator+threads+affinity list at '%s'\n", cp);
+    return cpus;
+}
+
+static int vl_cpu_node(int cpu) {
+    // NUMA node holding the CPU, or -1 if unknown
+#ifdef __linux__
+    char dirname[64];
+    sprintf(dirname, "/sys/devices/system/cpu/cpu%d", cpu);
+    int node = -1;
+    if (DIR* dirp = opendir(dirname)) {
+	while (struct dirent* entp = readdir(dirp)) {
+	    if (0 == strncmp(entp->d_name, "node", 4) && isdigit(entp->d_name[4])) {
+		node = atoi(entp->d_name+4);
+		break;
+	    }
+	}
+	closedir(dirp);
+    }
+    return node;
+#else
+    return -1;
+#endif
+}
+
+VlThreadPool::VlThreadPool(int nThreads)
+    : m_generation(0), m_active(0), m_nextTask(0)
+    , m_fnps(NULL), m_indexedFnp(NULL), m_count(0), m_symtab(NULL), m_contextp(NULL), m_shutdown(false) {
+    m_cpus = vl_parse_cpus(Verilated::threadsAffinity());
+    if (!m_cpus.empty()) {
+	// The model's state is first touched, so placed, by the constructing thread;
+	// report when the other threads would reach it across NUMA nodes
+	std::set<int> nodes;
+	for (int i=0; i<nThreads; ++i) nodes.insert(vl_cpu_node(m_cpus[i % m_cpus.size()]));
+	nodes.erase(-1);
+	if (nodes.size() > 1) {
+	    VL_PRINTF("%%Warning: +verilator+threads+affinity CPUs span %d NUMA nodes;"
+		      " model state is on the node of CPU %d\n", (int)nodes.size(), m_cpus[0]);
+	}
+	pinThread(0);
+    }
+    for (int i=1; i<nThreads; ++i) {
+	m_workers.push_back(std::thread(&VlThreadPool::workerLoop, this, i));
+    }
+}
+
+void VlThreadPool::pinThread(int index) {
+    // Pin the calling thread to its CPU from the affinity list
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    int cpu = m_cpus[index % m_cpus.size()];
+    CPU_SET(cpu, &set);
+    if (sched_setaffinity(0, sizeof(set), &set)) {
+	VL_PRINTF("%%Warning: Can't pin thread to CPU %d\n", cpu);
+    }
+#endif
+}
+
+VlThreadPool::~VlThreadPool() {
+    {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_shutdown = true;
+    }
+    m_startCv.notify_all();
+    for (std::vector<std::thread>::iterator it = m_workers.begin(); it != m_workers.end(); ++it) {
+	it->join();
+    }
+}
+
+void VlThreadPool::runTasks() {
+    int task;
+    while ((task = m_nextTask.fetch_add(1)) < m_count) {
+	if (m_fnps) m_fnps[task](m_symtab);
+	else m_indexedFnp(m_symtab, task);
+    }
+}
+
+void VlThreadPool::waitIdle(std::unique_lock<std::mutex>& lock) {
+    while (m_active) m_doneCv.wait(lock);
+}
+
+void VlThreadPool::workerLoop(int index) {
+    if (!m_cpus.empty()) pinThread(index);
+    vluint64_t seen = 0;
+    while (1) {
+	{
+	    std::unique_lock<std::mutex> lock(m_mutex);
+	    while (!m_shutdown && m_generation == seen) m_startCv.wait(lock);
+	    if (m_shutdown) return;
+	    seen = m_generation;
+	    ++m_active;
+	}
+	Verilated::threadContextp(m_contextp);  // Tasks see the same $finish, fds etc as the caller
+	runTasks();
+	{
+	    std::lock_guard<std::mutex> lock(m_mutex);
+	    if (--m_active == 0) m_doneCv.notify_one();
+	}
+    }
+}
+
+void VlThreadPool::execute(const VlMTaskFnp* fnps, int count, VlThrSymTab symtab) {
+    if (VL_UNLIKELY(m_workers.empty() || count < 2)) {
+	for (int i=0; i<count; ++i) fnps[i](symtab);
+	return;
+    }
+    start(fnps, NULL, count, symtab);
+}
+
+void VlThreadPool::executeIndexed(VlIndexedTaskFnp fnp, int count, void* datap) {
+    if (VL_UNLIKELY(m_workers.empty() || count < 2)) {
+	for (int i=0; i<count; ++i) fnp(datap, i);
+	return;
+    }
+    start(NULL, fnp, count, datap);
+}
+
+void VlThreadPool::start(const VlMTaskFnp* fnps, VlIndexedTaskFnp indexedFnp, int count, void* datap) {
+    {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	waitIdle(lock);  // Workers that woke late for the previous group
+	m_fnps = fnps;
+	m_indexedFnp = indexedFnp;
+	m_count = count;
+	m_symtab = datap;
+	m_contextp = Verilated::threadContextp();
+	m_nextTask.store(0);
+	++m_generation;
+    }
+    m_startCv.notify_all();
+    runTasks();
+    // All tasks are claimed; wait for those still running elsewhere
+    std::unique_lock<std::mutex> lock(m_mutex);
+    waitIdle(lock);
+}
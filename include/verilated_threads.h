@@ -0,0 +1,85 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//=============================================================================
+//
+// THIS MODULE IS PUBLICLY LICENSED
+//
+// Copyright 2017-2017 by Wilson Snyder.  This program is free software;
+// you can redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License Version 2.0.
+//
+// This is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+// for more details.
+//
+//=============================================================================
+///
+/// \file
+/// \brief Thread pool for verilated models built with --threads
+///
+//=============================================================================
+
+#ifndef _VERILATED_THREADS_H_
+#define _VERILATED_THREADS_H_ 1
+
+#include "verilatedos.h"
+#include "verilated.h"
+
+#ifndef VL_THREADED
+# error "verilated_threads.h requires VL_THREADED; use verilator --threads"
+#endif
+#if __cplusplus < 201103L
+# error "verilated_threads.h requires a C++11 compiler"
+#endif
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//=============================================================================
+// VlThreadPool - persistent worker threads executing groups of macro-tasks
+
+typedef void (*VlMTaskFnp)(VlThrSymTab);	///< Macro-task function
+typedef void (*VlIndexedTaskFnp)(void* datap, int task);	///< Task function told its index
+
+class VlThreadPool {
+    // MEMBERS
+    std::vector<std::thread>	m_workers;	///< Worker threads; the caller is also a worker
+    std::mutex			m_mutex;	///< Protects below condition variables
+    std::condition_variable	m_startCv;	///< Signals new group to workers
+    std::condition_variable	m_doneCv;	///< Signals workers going idle to caller
+    vluint64_t			m_generation;	///< Incremented as each group is started
+    int				m_active;	///< Workers inside runTasks()
+    std::atomic<int>		m_nextTask;	///< Next macro-task to claim in current group
+    const VlMTaskFnp*		m_fnps;		///< Current group's macro-tasks, or NULL
+    VlIndexedTaskFnp		m_indexedFnp;	///< Current group's task function, if !m_fnps
+    int				m_count;	///< Current group's number of macro-tasks
+    VlThrSymTab			m_symtab;	///< Current group's symbol table
+    VerilatedContext*		m_contextp;	///< Current group's caller's context
+    bool			m_shutdown;	///< Workers should exit
+    std::vector<int>		m_cpus;		///< CPUs threads are pinned to, in turn
+
+    // METHODS
+    void workerLoop(int index);
+    void pinThread(int index);
+    void runTasks();
+    void waitIdle(std::unique_lock<std::mutex>& lock);
+    void start(const VlMTaskFnp* fnps, VlIndexedTaskFnp indexedFnp, int count, void* datap);
+private:
+    VlThreadPool(const VlThreadPool&);	///< N/A, no copy constructor
+    VlThreadPool& operator=(const VlThreadPool&);	///< N/A, no assignment
+public:
+    // CREATORS
+    explicit VlThreadPool(int nThreads);	///< nThreads includes the calling thread
+    ~VlThreadPool();
+    // METHODS
+    /// Run count independent macro-tasks, returning when all have completed
+    void execute(const VlMTaskFnp* fnps, int count, VlThrSymTab symtab);
+    /// Run fnp(datap, task) for each task in [0,count), returning when all have completed
+    void executeIndexed(VlIndexedTaskFnp fnp, int count, void* datap);
+    int numThreads() const { return (int)m_workers.size()+1; }
+};
+
+#endif  // guard
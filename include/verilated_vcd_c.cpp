@@ -30,6 +30,7 @@
 #include <cerrno>
 #include <ctime>
 #include <algorithm>
+#include <deque>
 
 #if defined(_WIN32) && !defined(__MINGW32__) && !defined(__CYGWIN__)
 # include <io.h>
@@ -37,6 +38,13 @@
 # include <unistd.h>
 #endif
 
+#ifdef VL_THREADED
+# include <atomic>
+# include <condition_variable>
+# include <mutex>
+# include <thread>
+#endif
+
 // SPDIFF_ON
 
 #ifndef O_LARGEFILE // For example on WIN32
@@ -51,6 +59,8 @@
 
 vector<VerilatedVcd*>	VerilatedVcd::s_vcdVecp;	///< List of all created traces
 
+static VerilatedMutex s_vcdVecMutex;	///< Protects s_vcdVecp, as models may trace on several threads
+
 //=============================================================================
 // VerilatedVcdCallInfo
 /// Internal callback routines for each module being traced.
@@ -74,6 +84,40 @@ protected:
 	: m_initcb(icb), m_fullcb(fcb), m_changecb(changecb), m_userthis(ut), m_code(code) {};
 };
 
+//=============================================================================
+// VerilatedVcdRecorder
+/// Flight recorder state.
+///
+/// With flightRecorder(), records are kept in memory in segments instead of
+/// being written.  Each segment starts at a keyframe with a full dump, so the
+/// oldest segments can be discarded as they age past the kept time, or to
+/// bound memory.  flush() and close() write the kept segments.
+
+class VerilatedVcdRecorder {
+public:
+    struct Segment {
+	vluint64_t		m_time;		///< Time of keyframe starting segment
+	vector<vluint32_t>	m_recs;		///< Records
+    };
+    // MEMBERS
+    std::deque<Segment>	m_segs;		///< Kept segments, oldest first
+    vluint64_t		m_keepTime;	///< Time to keep
+    vluint64_t		m_keyframeTime;	///< Time between keyframes
+    size_t		m_maxWords;	///< Words of records to keep at most, 0=no limit
+    size_t		m_words;	///< Words of records in m_segs
+    vector<vluint32_t>	m_spare;	///< Emptied records of a discarded segment
+    // CREATORS
+    VerilatedVcdRecorder(vluint64_t keepTime, vluint64_t keyframeTime, size_t maxWords)
+	: m_keepTime(keepTime), m_keyframeTime(keyframeTime), m_maxWords(maxWords), m_words(0) {}
+    // METHODS
+    void dropOldest() {
+	m_words -= m_segs.front().m_recs.size();
+	m_spare.swap(m_segs.front().m_recs);
+	m_spare.clear();
+	m_segs.pop_front();
+    }
+};
+
 //=============================================================================
 //=============================================================================
 //=============================================================================
@@ -106,14 +150,27 @@ VerilatedVcd::VerilatedVcd(VerilatedVcdFile* filep)
     m_timeRes = m_timeUnit = 1e-9;
     m_timeLastDump = 0;
     m_sigs_oldvalp = NULL;
+    m_sigs_packedp = NULL;
+    m_fullGen = 0;
     m_evcd = false;
     m_scopeEscape = '.';  // Backward compatibility
     m_fullDump = true;
+    m_windowStart = 0;
+    m_windowLength = ~VL_ULL(0);
+    m_dumpIdle = true;
     m_wrChunkSize = 8*1024;
     m_wrBufp = new char [m_wrChunkSize*8];
     m_wrFlushp = m_wrBufp + m_wrChunkSize * 6;
     m_writep = m_wrBufp;
     m_wroteBytes = 0;
+    m_async = false;
+    m_asyncp = NULL;
+    m_recorderp = NULL;
+    m_recording = false;
+    m_compressp = NULL;
+    m_taskCb = NULL;
+    m_taskUserthis = NULL;
+    m_taskCode = 0;
 }
 
 void VerilatedVcd::open (const char* filename) {
@@ -121,11 +178,14 @@ void VerilatedVcd::open (const char* filename) {
 
     // Set member variables
     m_filename = filename;
+    s_vcdVecMutex.lock();
     s_vcdVecp.push_back(this);
+    s_vcdVecMutex.unlock();
 
     // SPDIFF_OFF
     // Set callback so an early exit will flush us
     Verilated::flushCb(&flush_all);
+    Verilated::forkCb(&fork_all);
 
     // SPDIFF_ON
     openNext (m_rolloverMB!=0);
@@ -136,12 +196,17 @@ void VerilatedVcd::open (const char* filename) {
     // Allocate space now we know the number of codes
     if (!m_sigs_oldvalp) {
 	m_sigs_oldvalp = new vluint32_t [m_nextCode+10];
+	m_sigs_packedp = new vluint64_t [m_nextCode+10]();
     }
+    // Excluded signals are dropped by record()
+    if (!m_sigs_off.empty()) m_recording = true;
 
     if (m_rolloverMB) {
 	openNext(true);
 	if (!isOpen()) return;
     }
+
+    if (m_async) asyncStart();
 }
 
 void VerilatedVcd::openNext (bool incFilename) {
@@ -188,16 +253,48 @@ void VerilatedVcd::openNext (bool incFilename) {
     m_wroteBytes = 0;
 }
 
+struct VerilatedVcdNameLess {
+    bool operator() (const pair<string,string>& a, const pair<string,string>& b) const {
+	return a.first < b.first;
+    }
+};
+struct VerilatedVcdNameEqual {
+    bool operator() (const pair<string,string>& a, const pair<string,string>& b) const {
+	return a.first == b.first;
+    }
+};
+
 void VerilatedVcd::makeNameMap() {
     // Take signal information from each module and build m_namemapp
     deleteNameMap();
     m_nextCode = 1;
     m_namemapp = new NameMap;
+    m_sigs_off.clear();
     for (vluint32_t ent = 0; ent< m_callbacks.size(); ent++) {
 	VerilatedVcdCallInfo *cip = m_callbacks[ent];
 	cip->m_code = nextCode();
 	(cip->m_initcb) (this, cip->m_userthis, cip->m_code);
     }
+    if (!m_traceGlobs.empty()) {
+	// Signals always of equal value share a code, so exclude a code
+	// only when none of the names declared with it matched
+	m_sigs_off.assign(m_nextCode, true);
+	for (size_t code=0; code<m_sigs_on.size(); ++code) {
+	    if (m_sigs_on[code]) m_sigs_off[code] = false;
+	}
+	m_sigs_on.clear();
+    }
+
+    // Sort by name, once; declarations are often already in order.
+    // Stable and keeping the first of any duplicate names, as a map insert did.
+    bool sorted = true;
+    VerilatedVcdNameLess less;
+    for (size_t i=1; i<m_namemapp->size(); ++i) {
+	if (less((*m_namemapp)[i], (*m_namemapp)[i-1])) { sorted = false; break; }
+    }
+    if (!sorted) stable_sort(m_namemapp->begin(), m_namemapp->end(), less);
+    m_namemapp->erase(unique(m_namemapp->begin(), m_namemapp->end(), VerilatedVcdNameEqual()),
+		      m_namemapp->end());
 
     // Though not speced, it's illegal to generate a vcd with signals
     // not under any module - it crashes at least two viewers.
@@ -209,17 +306,11 @@ void VerilatedVcd::makeNameMap() {
 	if (hiername.size() >= 1 && hiername[0] == '\t') nullScope=true;
     }
     if (nullScope) {
-	NameMap* newmapp = new NameMap;
+	// The same prefix on every name, so still sorted
 	for (NameMap::iterator it=m_namemapp->begin(); it!=m_namemapp->end(); ++it) {
-	    const string& hiername = it->first;
-	    const string& decl     = it->second;
-	    string newname = string("top");
-	    if (hiername[0] != '\t') newname += ' ';
-	    newname += hiername;
-	    newmapp->insert(make_pair(newname,decl));
+	    string& hiername = it->first;
+	    hiername.insert(0, (hiername[0] != '\t') ? "top " : "top");
 	}
-	deleteNameMap();
-	m_namemapp = newmapp;
     }
 }
 
@@ -229,21 +320,46 @@ void VerilatedVcd::deleteNameMap() {
 
 VerilatedVcd::~VerilatedVcd() {
     close();
+    asyncStop();
+    compressStop();
+    if (m_recorderp) { delete m_recorderp; m_recorderp=NULL; }
     if (m_wrBufp) { delete[] m_wrBufp; m_wrBufp=NULL; }
     if (m_sigs_oldvalp) { delete[] m_sigs_oldvalp; m_sigs_oldvalp=NULL; }
+    if (m_sigs_packedp) { delete[] m_sigs_packedp; m_sigs_packedp=NULL; }
     deleteNameMap();
     if (m_filep && m_fileNewed) { delete m_filep; m_filep = NULL; }
     // Remove from list of traces
+    s_vcdVecMutex.lock();
     vector<VerilatedVcd*>::iterator pos = find(s_vcdVecp.begin(), s_vcdVecp.end(), this);
     if (pos != s_vcdVecp.end()) { s_vcdVecp.erase(pos); }
+    s_vcdVecMutex.unlock();
 }
 
 void VerilatedVcd::closePrev () {
     if (!isOpen()) return;
 
+    asyncDrain();
+    recorderWrite();
     bufferFlush();
     m_isOpen = false;
     m_filep->close();
+    if (m_compressp) compressQueue(m_filename);
+}
+
+void VerilatedVcd::forkReopen () {
+    // In a forked child.  Buffers were flushed before the fork, so leave
+    // the parent its file, and start our own under a per-child name.
+    if (!isOpen()) return;
+    forkThreads();
+    m_isOpen = false;
+    m_filep->close();
+    m_filename = Verilated::forkFilename(m_filename.c_str());
+    openNext(false);
+    if (!isOpen()) return;
+    m_sigs.clear();  // Declared again by the header
+    dumpHeader();
+    if (!m_sigs_off.empty()) m_recording = true;
+    if (m_async) asyncStart();
 }
 
 void VerilatedVcd::closeErr () {
@@ -258,12 +374,14 @@ void VerilatedVcd::closeErr () {
 
 void VerilatedVcd::close() {
     if (!isOpen()) return;
+    asyncStop();
     if (m_evcd) {
 	printStr("$vcdclose ");
 	printTime(m_timeLastDump);
 	printStr(" $end\n");
     }
     closePrev();
+    compressWait();
 }
 
 void VerilatedVcd::printStr (const char* str) {
@@ -476,6 +594,37 @@ void VerilatedVcd::module (const string& name) {
     m_modName = name;
 }
 
+static bool vcdWildmatch(const char* s, const char* p) {
+    for ( ; *p; s++, p++) {
+	if (*p!='*') {
+	    if (((*s)!=(*p)) && *p != '?')
+		return false;
+	}
+	else {
+	    // Trailing star matches everything.
+	    if (!*++p) return true;
+	    while (vcdWildmatch(s, p) == false)
+		if (*++s == '\0')
+		    return false;
+	    return true;
+	}
+    }
+    return (*s == '\0');
+}
+
+bool VerilatedVcd::traceMatched (const string& name) const {
+    if (m_traceGlobs.empty()) return true;
+    // Verilated code separates scopes with spaces; match as dotted names
+    string dotted = name;
+    for (string::iterator it = dotted.begin(); it != dotted.end(); ++it) {
+	if (isScopeEscape(*it)) *it = '.';
+    }
+    for (vector<string>::const_iterator it = m_traceGlobs.begin(); it != m_traceGlobs.end(); ++it) {
+	if (vcdWildmatch(dotted.c_str(), it->c_str())) return true;
+    }
+    return false;
+}
+
 void VerilatedVcd::declare (vluint32_t code, const char* name, const char* wirep,
 			    int arraynum, bool tri, bool bussed, int msb, int lsb) {
     if (!code) { vl_fatal(__FILE__,__LINE__,"","Internal: internal trace problem, code 0 is illegal"); }
@@ -505,6 +654,13 @@ void VerilatedVcd::declare (vluint32_t code, const char* name, const char* wirep
     // Note the hiername may be nothing, if so we'll add "\t{name}"
     string nameasstr = name;
     if (m_modName!="") { nameasstr = m_modName+m_scopeEscape+nameasstr; }  // Optional ->module prefix
+    if (!m_traceGlobs.empty()) {
+	// If no name with its code matches, still compared against the old
+	// values, but never formatted
+	if (!traceMatched(nameasstr)) return;
+	if (m_sigs_on.size() < m_nextCode) m_sigs_on.resize(m_nextCode);
+	for (vluint32_t i=code; i<code+codesNeeded; ++i) m_sigs_on[i] = true;
+    }
     string hiername;
     string basename;
     for (const char* cp=nameasstr.c_str(); *cp; cp++) {
@@ -543,7 +699,7 @@ void VerilatedVcd::declare (vluint32_t code, const char* name, const char* wirep
 	decl += buf;
     }
     decl += " $end\n";
-    m_namemapp->insert(make_pair(hiername,decl));
+    m_namemapp->push_back(make_pair(hiername,decl));
 }
 
 void VerilatedVcd::declBit      (vluint32_t code, const char* name, int arraynum)
@@ -569,23 +725,25 @@ void VerilatedVcd::declDouble   (vluint32_t code, const char* name, int arraynum
 
 //=============================================================================
 
-void VerilatedVcd::fullDouble (vluint32_t code, const double newval) {
-    // cppcheck-suppress invalidPointerCast
-    (*((double*)&m_sigs_oldvalp[code])) = newval;
+void VerilatedVcd::emitDouble (vluint32_t code, const double newval) {
     // Buffer can't overflow before sprintf; we sized during declaration
     sprintf(m_writep, "r%.16g", newval);
     m_writep += strlen(m_writep);
     *m_writep++=' '; printCode(code); *m_writep++='\n';
     bufferCheck();
 }
+void VerilatedVcd::fullDouble (vluint32_t code, const double newval) {
+    // cppcheck-suppress invalidPointerCast
+    (*((double*)&m_sigs_oldvalp[code])) = newval;
+    if (VL_UNLIKELY(m_recording)) { record(REC_DOUBLE, code, 64, (const vluint32_t*)&newval, 2); return; }
+    emitDouble(code, newval);
+}
 void VerilatedVcd::fullFloat (vluint32_t code, const float newval) {
     // cppcheck-suppress invalidPointerCast
     (*((float*)&m_sigs_oldvalp[code])) = newval;
-    // Buffer can't overflow before sprintf; we sized during declaration
-    sprintf(m_writep, "r%.16g", (double)newval);
-    m_writep += strlen(m_writep);
-    *m_writep++=' '; printCode(code); *m_writep++='\n';
-    bufferCheck();
+    double dval = newval;
+    if (VL_UNLIKELY(m_recording)) { record(REC_DOUBLE, code, 64, (const vluint32_t*)&dval, 2); return; }
+    emitDouble(code, dval);
 }
 
 //=============================================================================
@@ -608,6 +766,7 @@ void VerilatedVcd::addCallback (
 
 void VerilatedVcd::dumpFull (vluint64_t timeui) {
     dumpPrep (timeui);
+    ++m_fullGen;  // Values now written here, not seen by chgBits
     for (vluint32_t ent = 0; ent< m_callbacks.size(); ent++) {
 	VerilatedVcdCallInfo *cip = m_callbacks[ent];
 	(cip->m_fullcb) (this, cip->m_userthis, cip->m_code);
@@ -615,14 +774,18 @@ void VerilatedVcd::dumpFull (vluint64_t timeui) {
     dumpDone ();
 }
 
-void VerilatedVcd::dump (vluint64_t timeui) {
+void VerilatedVcd::dumpInWindow (vluint64_t timeui) {
     if (!isOpen()) return;
+    if (VL_UNLIKELY(m_recorderp)) recorderCheck(timeui);
     if (VL_UNLIKELY(m_fullDump)) {
 	m_fullDump = false;	// No need for more full dumps
 	dumpFull(timeui);
+	// Covers all activity so far
+	for (vector<bool*>::iterator it = m_activityps.begin(); it != m_activityps.end(); ++it) **it = false;
 	return;
     }
-    if (VL_UNLIKELY(m_rolloverMB && m_wroteBytes > this->m_rolloverMB)) {
+    if (VL_UNLIKELY(!m_dumpIdle) && !activity()) return;
+    if (VL_UNLIKELY(m_rolloverMB && wroteBytes() > this->m_rolloverMB)) {
 	openNext(true);
 	if (!isOpen()) return;
     }
@@ -635,22 +798,497 @@ void VerilatedVcd::dump (vluint64_t timeui) {
 }
 
 void VerilatedVcd::dumpPrep (vluint64_t timeui) {
+    if (m_recording) {
+	vluint32_t data[2] = { (vluint32_t)timeui, (vluint32_t)(timeui>>32ULL) };
+	record(REC_TIME, 0, 64, data, 2);
+	return;
+    }
     printStr("#");
     printTime(timeui);
     printStr("\n");
 }
 
 void VerilatedVcd::dumpDone () {
+    if (m_asyncp) asyncPublish();
+}
+
+#ifdef VL_THREADED
+static VL_THREAD vector<vluint32_t>* t_taskRecsp = NULL;	///< Running change task's records
+#endif
+
+void VerilatedVcd::flush () {
+    asyncDrain();
+    recorderWrite();
+    bufferFlush();
+}
+
+void VerilatedVcd::asyncEmit (vluint32_t type, vluint32_t code, int bits, const vluint32_t* datap) {
+    // Format a record from async(), change tasks or the flight recorder
+    switch (type) {
+    case REC_TIME: {
+	printStr("#");
+	printTime(((vluint64_t)datap[1]<<32ULL) | datap[0]);
+	printStr("\n");
+	break;
+    }
+    case REC_BIT:	emitBit(code, datap[0]); break;
+    case REC_BUS:	emitBus(code, datap[0], bits); break;
+    case REC_QUAD:	emitQuad(code, ((vluint64_t)datap[1]<<32ULL) | datap[0], bits); break;
+    case REC_ARRAY:	emitArray(code, datap, bits); break;
+    case REC_TRIBIT:	emitTriBit(code, datap[0], datap[1]); break;
+    case REC_TRIBUS:	emitTriBus(code, datap[0], datap[1], bits); break;
+    case REC_TRIQUAD:	emitTriQuad(code, ((vluint64_t)datap[1]<<32ULL) | datap[0], datap[2], bits); break;
+    case REC_TRIARRAY:	emitTriArray(code, datap, datap+((bits-1)/32)+1, bits); break;
+    case REC_DOUBLE: {
+	double dval;
+	memcpy(&dval, datap, sizeof(dval));
+	emitDouble(code, dval);
+	break;
+    }
+    case REC_BITX:	emitBitX(code); break;
+    case REC_BUSX:	emitBusX(code, bits); break;
+    default: vl_fatal(__FILE__,__LINE__,"","Internal: Bad VCD record"); break;
+    }
+}
+
+//======================================================================
+// Flight recorder
+
+void VerilatedVcd::flightRecorder (vluint64_t keepTime, vluint64_t keyframeTime, size_t maxMB) {
+    if (m_recorderp) { delete m_recorderp; m_recorderp=NULL; }
+    if (!keyframeTime) keyframeTime = keepTime/4;
+    if (!keyframeTime) keyframeTime = 1;
+    m_recorderp = new VerilatedVcdRecorder(keepTime, keyframeTime, maxMB*1024*1024/sizeof(vluint32_t));
+    m_recording = true;
+}
+
+void VerilatedVcd::recorderCheck (vluint64_t timeui) {
+    VerilatedVcdRecorder* rp = m_recorderp;
+    if (rp->m_segs.empty() || m_fullDump
+	|| (timeui - rp->m_segs.back().m_time) >= rp->m_keyframeTime) {
+	// Discard segments entirely older than the kept time, or over the memory limit;
+	// the newest is kept as it's needed to know the values at the next keyframe
+	while (rp->m_segs.size() > 1
+	       && ((timeui - rp->m_segs[1].m_time) >= rp->m_keepTime
+		   || (rp->m_maxWords && rp->m_words > rp->m_maxWords))) {
+	    rp->dropOldest();
+	}
+	rp->m_segs.push_back(VerilatedVcdRecorder::Segment());
+	rp->m_segs.back().m_time = timeui;
+	rp->m_segs.back().m_recs.swap(rp->m_spare);  // Reuse a discarded segment's memory
+	m_fullDump = true;
+    }
+}
+
+void VerilatedVcd::recorderRecord (vluint32_t type, vluint32_t code, int bits,
+				   const vluint32_t* datap, int words, const vluint32_t* data2p) {
+    vector<vluint32_t>& recs = m_recorderp->m_segs.back().m_recs;
+    size_t oldSize = recs.size();
+    recs.push_back(type);
+    recs.push_back(code);
+    recs.push_back((vluint32_t)bits);
+    recs.insert(recs.end(), datap, datap+words);
+    if (data2p) recs.insert(recs.end(), data2p, data2p+words);
+    m_recorderp->m_words += recs.size() - oldSize;
+}
+
+void VerilatedVcd::recorderWrite () {
+    VerilatedVcdRecorder* rp = m_recorderp;
+    if (!rp || rp->m_segs.empty() || !isOpen()) return;
+    for (std::deque<VerilatedVcdRecorder::Segment>::iterator it = rp->m_segs.begin();
+	 it != rp->m_segs.end(); ++it) {
+	const vector<vluint32_t>& recs = it->m_recs;
+	for (size_t pos = 0; pos < recs.size(); ) {
+	    vluint32_t type = recs[pos];
+	    vluint32_t code = recs[pos+1];
+	    int bits = (int)recs[pos+2];
+	    int words = recordWords(type, bits);
+	    asyncEmit(type, code, bits, words ? &recs[pos+3] : NULL);
+	    pos += 3 + words;
+	}
+    }
+    rp->m_segs.clear();
+    rp->m_words = 0;
+    m_fullDump = true;  // Written data must not be repeated, so later data needs a keyframe
+}
+
+void VerilatedVcd::record (vluint32_t type, vluint32_t code, int bits,
+			   const vluint32_t* datap, int words, const vluint32_t* data2p) {
+    if (code < m_sigs_off.size() && m_sigs_off[code] && type != REC_TIME) return;  // Excluded by traceMatch
+#ifdef VL_THREADED
+    if (vector<vluint32_t>* recsp = t_taskRecsp) {
+	recsp->push_back(type);
+	recsp->push_back(code);
+	recsp->push_back((vluint32_t)bits);
+	recsp->insert(recsp->end(), datap, datap+words);
+	if (data2p) recsp->insert(recsp->end(), data2p, data2p+words);
+	return;
+    }
+#endif
+    if (m_recorderp) recorderRecord(type, code, bits, datap, words, data2p);
+    else if (m_asyncp) asyncRecord(type, code, bits, datap, words, data2p);
+    else if (data2p) emitTriArray(code, datap, data2p, bits);  // Only recording for traceMatch
+    else asyncEmit(type, code, bits, datap);
 }
 
+//======================================================================
+// Asynchronous writer
+//
+// With async(), the dumping routines still compare against the old values
+// on the eval thread, but only append each changed value as a raw record
+// to a single producer, single consumer ring.  A writer thread formats the
+// records and does all file I/O.  The ring's head is published at the end
+// of each dump() (or when the ring fills); a full ring blocks the eval
+// thread until the writer catches up.  All other file operations first
+// drain the ring, after which the writer is idle and the eval thread may
+// use the write buffer directly.
+
+#ifdef VL_THREADED
+
+class VerilatedVcdAsync {
+public:
+    // MEMBERS
+    vector<vluint32_t>		m_ring;		///< Record words, power-of-2 sized
+    size_t			m_mask;		///< m_ring.size()-1
+    size_t			m_localHead;	///< Producer's unpublished head
+    std::atomic<size_t>		m_head;		///< Published head, written by producer
+    std::atomic<size_t>		m_tail;		///< Consumed tail, written by writer
+    std::atomic<vluint64_t>	m_wroteBytes;	///< Copy of m_wroteBytes for the producer
+    std::mutex			m_mutex;	///< Protects below
+    std::condition_variable	m_dataCv;	///< Signals writer of data, drain or stop
+    std::condition_variable	m_spaceCv;	///< Signals producer of space or drain done
+    bool			m_writerWaiting;	///< Writer is asleep on m_dataCv
+    bool			m_producerWaiting;	///< Producer is asleep on m_spaceCv
+    vluint64_t			m_drainReq;	///< Drain requests made
+    vluint64_t			m_drainDone;	///< Drain requests completed
+    bool			m_stop;		///< Writer should exit
+    std::thread			m_thread;	///< Writer thread
+    // CREATORS
+    explicit VerilatedVcdAsync(size_t minWords)
+	: m_localHead(0), m_head(0), m_tail(0), m_wroteBytes(0)
+	, m_writerWaiting(false), m_producerWaiting(false)
+	, m_drainReq(0), m_drainDone(0), m_stop(false) {
+	size_t size = 1<<20;
+	while (size < minWords) size *= 2;
+	m_ring.resize(size);
+	m_mask = size-1;
+    }
+    // METHODS
+    inline size_t space() const { return m_ring.size() - (m_localHead - m_tail.load(std::memory_order_acquire)); }
+    inline void put(vluint32_t word) { m_ring[m_localHead++ & m_mask] = word; }
+    inline vluint32_t get(size_t pos) const { return m_ring[pos & m_mask]; }
+};
+
+void VerilatedVcd::asyncStart() {
+    if (m_asyncp) return;
+    bufferFlush();  // Header
+    // Largest record is a tristate array: header, plus two words per 32 bits
+    size_t maxWords = 0;
+    for (vector<VerilatedVcdSig>::iterator it = m_sigs.begin(); it != m_sigs.end(); ++it) {
+	maxWords = max(maxWords, (size_t)(3 + 2*((it->m_bits+31)/32)));
+    }
+    m_asyncp = new VerilatedVcdAsync(maxWords*4);
+    m_asyncp->m_wroteBytes.store(m_wroteBytes);
+    m_asyncp->m_thread = std::thread(&VerilatedVcd::asyncWriterLoop, this);
+    m_recording = true;
+}
+
+void VerilatedVcd::asyncRecord (vluint32_t type, vluint32_t code, int bits,
+				const vluint32_t* datap, int words, const vluint32_t* data2p) {
+    VerilatedVcdAsync* ap = m_asyncp;
+    size_t need = 3 + words + (data2p ? words : 0);
+    if (VL_UNLIKELY(ap->space() < need)) {
+	// Back-pressure: publish what we have and wait for the writer
+	asyncPublish();
+	std::unique_lock<std::mutex> lock(ap->m_mutex);
+	ap->m_producerWaiting = true;
+	while (ap->space() < need) ap->m_spaceCv.wait(lock);
+	ap->m_producerWaiting = false;
+    }
+    ap->put(type);
+    ap->put(code);
+    ap->put((vluint32_t)bits);
+    for (int w=0; w<words; ++w) ap->put(datap[w]);
+    if (data2p) for (int w=0; w<words; ++w) ap->put(data2p[w]);
+}
+
+void VerilatedVcd::asyncPublish() {
+    VerilatedVcdAsync* ap = m_asyncp;
+    ap->m_head.store(ap->m_localHead, std::memory_order_release);
+    std::lock_guard<std::mutex> lock(ap->m_mutex);
+    if (ap->m_writerWaiting) ap->m_dataCv.notify_one();
+}
+
+void VerilatedVcd::asyncDrain() {
+    VerilatedVcdAsync* ap = m_asyncp;
+    if (!ap) return;
+    if (std::this_thread::get_id() == ap->m_thread.get_id()) return;  // Fatal error while writing
+    asyncPublish();
+    std::unique_lock<std::mutex> lock(ap->m_mutex);
+    vluint64_t req = ++ap->m_drainReq;
+    ap->m_dataCv.notify_one();
+    ap->m_producerWaiting = true;
+    while (ap->m_drainDone < req) ap->m_spaceCv.wait(lock);
+    ap->m_producerWaiting = false;
+}
+
+void VerilatedVcd::asyncStop() {
+    VerilatedVcdAsync* ap = m_asyncp;
+    if (!ap) return;
+    asyncDrain();
+    {
+	std::lock_guard<std::mutex> lock(ap->m_mutex);
+	ap->m_stop = true;
+	ap->m_dataCv.notify_one();
+    }
+    ap->m_thread.join();
+    m_asyncp = NULL;
+    m_recording = recordingNeeded();
+    delete ap; VL_DANGLING(ap);
+}
+
+vluint64_t VerilatedVcd::wroteBytes() const {
+    return m_asyncp ? m_asyncp->m_wroteBytes.load(std::memory_order_relaxed) : m_wroteBytes;
+}
+
+void VerilatedVcd::asyncWriterLoop() {
+    VerilatedVcdAsync* ap = m_asyncp;
+    vector<vluint32_t> data;
+    size_t tail = ap->m_tail.load();
+    while (1) {
+	size_t head = ap->m_head.load(std::memory_order_acquire);
+	if (head == tail) {
+	    std::unique_lock<std::mutex> lock(ap->m_mutex);
+	    if (ap->m_drainDone < ap->m_drainReq
+		&& ap->m_head.load(std::memory_order_acquire) == tail) {
+		lock.unlock();
+		bufferFlush();
+		ap->m_wroteBytes.store(m_wroteBytes, std::memory_order_relaxed);
+		lock.lock();
+		ap->m_drainDone = ap->m_drainReq;
+		ap->m_spaceCv.notify_one();
+		continue;
+	    }
+	    if (ap->m_stop) return;
+	    ap->m_writerWaiting = true;
+	    while (ap->m_head.load(std::memory_order_acquire) == tail
+		   && ap->m_drainDone == ap->m_drainReq && !ap->m_stop) {
+		ap->m_dataCv.wait(lock);
+	    }
+	    ap->m_writerWaiting = false;
+	    continue;
+	}
+	while (tail != head) {
+	    vluint32_t type = ap->get(tail);
+	    vluint32_t code = ap->get(tail+1);
+	    int bits = (int)ap->get(tail+2);
+	    int words = recordWords(type, bits);
+	    data.resize(words+1);
+	    for (int w=0; w<words; ++w) data[w] = ap->get(tail+3+w);
+	    asyncEmit(type, code, bits, &data[0]);
+	    tail += 3 + words;
+	}
+	ap->m_tail.store(tail, std::memory_order_release);
+	ap->m_wroteBytes.store(m_wroteBytes, std::memory_order_relaxed);
+	std::lock_guard<std::mutex> lock(ap->m_mutex);
+	if (ap->m_producerWaiting) ap->m_spaceCv.notify_one();
+    }
+}
+
+//======================================================================
+// Change tasks
+//
+// With --threads, the change routine's independent activity groups each
+// become a task, and tasks run concurrently, typically on the model's
+// VlThreadPool.  Each group compares against disjoint parts of the old
+// value vector, so only the formatting needs ordering: while tasks run,
+// changed values are appended as records to the running task's own buffer,
+// and chgTasksEnd() then emits the buffers in task order, giving the same
+// output as running the groups serially.
+
+void VerilatedVcd::chgTasksBegin (VerilatedVcdTaskCallback_t cb, int count,
+				  void* userthis, vluint32_t code) {
+    m_taskCb = cb;
+    m_taskUserthis = userthis;
+    m_taskCode = code;
+    if ((int)m_taskRecs.size() < count) m_taskRecs.resize(count);
+    for (int task=0; task<count; ++task) m_taskRecs[task].clear();
+    m_recording = true;
+}
+
+void VerilatedVcd::chgTaskRun (void* vcdp, int task) {
+    VerilatedVcd* selfp = static_cast<VerilatedVcd*>(vcdp);
+    t_taskRecsp = &selfp->m_taskRecs[task];
+    selfp->m_taskCb(selfp, selfp->m_taskUserthis, selfp->m_taskCode, task);
+    t_taskRecsp = NULL;
+}
+
+//======================================================================
+// Background compression
+//
+// Each closed file's name is queued to a small pool of threads, each of
+// which runs the compression command on one file at a time.  Queuing
+// waits while every thread is busy and one file is already waiting,
+// so a slow compressor slows the simulation rather than using unbounded
+// disk for uncompressed files.
+
+class VerilatedVcdCompress {
+public:
+    string			m_command;	///< Command to run, given the filename
+    std::mutex			m_mutex;	///< Protects below
+    std::condition_variable	m_cv;		///< Signals queue or busy changes
+    deque<string>		m_queue;	///< Files waiting to compress
+    int				m_busy;		///< Files being compressed
+    bool			m_stop;		///< Threads should exit once idle
+    vector<std::thread>		m_threads;	///< Compression threads
+    explicit VerilatedVcdCompress(const char* command)
+	: m_command(command), m_busy(0), m_stop(false) {}
+    static string quoted(const string& filename) {
+	// Single quoted for the shell, so only a quote itself needs escaping
+	string out = "'";
+	for (string::const_iterator it = filename.begin(); it != filename.end(); ++it) {
+	    if (*it == '\'') out += "'\\''";
+	    else out += *it;
+	}
+	return out + "'";
+    }
+    void loop() {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (true) {
+	    while (m_queue.empty() && !m_stop) m_cv.wait(lock);
+	    if (m_queue.empty()) return;
+	    string filename = m_queue.front(); m_queue.pop_front();
+	    ++m_busy;
+	    m_cv.notify_all();
+	    lock.unlock();
+	    string cmd = m_command+" "+quoted(filename);
+	    if (system(cmd.c_str()) != 0) {
+		VL_PRINTF("%%Warning: VCD compression failed: %s\n", cmd.c_str());
+	    }
+	    lock.lock();
+	    --m_busy;
+	    m_cv.notify_all();
+	}
+    }
+};
+
+void VerilatedVcd::compress (const char* command, int threads) {
+    if (m_compressp || threads < 1) return;
+    m_compressp = new VerilatedVcdCompress(command);
+    for (int i=0; i<threads; ++i) {
+	m_compressp->m_threads.push_back(std::thread(&VerilatedVcdCompress::loop, m_compressp));
+    }
+}
+
+void VerilatedVcd::compressQueue (const string& filename) {
+    VerilatedVcdCompress* cp = m_compressp;
+    std::unique_lock<std::mutex> lock(cp->m_mutex);
+    while (!cp->m_queue.empty()) cp->m_cv.wait(lock);
+    cp->m_queue.push_back(filename);
+    cp->m_cv.notify_all();
+}
+
+void VerilatedVcd::compressWait () {
+    VerilatedVcdCompress* cp = m_compressp;
+    if (!cp) return;
+    std::unique_lock<std::mutex> lock(cp->m_mutex);
+    while (!cp->m_queue.empty() || cp->m_busy) cp->m_cv.wait(lock);
+}
+
+void VerilatedVcd::compressStop () {
+    VerilatedVcdCompress* cp = m_compressp;
+    if (!cp) return;
+    {
+	std::lock_guard<std::mutex> lock(cp->m_mutex);
+	cp->m_stop = true;  // Threads finish the queue first
+	cp->m_cv.notify_all();
+    }
+    for (vector<std::thread>::iterator it = cp->m_threads.begin(); it != cp->m_threads.end(); ++it) {
+	it->join();
+    }
+    m_compressp = NULL;
+    delete cp; VL_DANGLING(cp);
+}
+
+void VerilatedVcd::forkThreads () {
+    // Only the forking thread exists in a child; abandon, without joining,
+    // the state of our threads, and start new ones
+    m_asyncp = NULL;
+    m_recording = recordingNeeded();
+    if (VerilatedVcdCompress* cp = m_compressp) {
+	m_compressp = NULL;
+	compress(cp->m_command.c_str(), cp->m_threads.size());
+    }
+}
+
+void VerilatedVcd::chgTasksEnd () {
+    m_recording = recordingNeeded();
+    for (vector<vector<vluint32_t> >::iterator it = m_taskRecs.begin(); it != m_taskRecs.end(); ++it) {
+	const vector<vluint32_t>& recs = *it;
+	for (size_t pos = 0; pos < recs.size(); ) {
+	    vluint32_t type = recs[pos];
+	    vluint32_t code = recs[pos+1];
+	    int bits = (int)recs[pos+2];
+	    int words = recordWords(type, bits);
+	    const vluint32_t* datap = words ? &recs[pos+3] : NULL;
+	    if (m_recorderp) recorderRecord(type, code, bits, datap, words);
+	    else if (m_asyncp) asyncRecord(type, code, bits, datap, words);
+	    else asyncEmit(type, code, bits, datap);
+	    pos += 3 + words;
+	}
+    }
+    m_taskCb = NULL;
+}
+
+#else  // !VL_THREADED
+
+void VerilatedVcd::asyncStart() {
+    vl_fatal(__FILE__,__LINE__,"","VerilatedVcd::async() requires compiling with VL_THREADED");
+}
+void VerilatedVcd::asyncRecord (vluint32_t, vluint32_t, int, const vluint32_t*, int, const vluint32_t*) {}
+void VerilatedVcd::asyncPublish() {}
+void VerilatedVcd::asyncDrain() {}
+void VerilatedVcd::asyncStop() {}
+void VerilatedVcd::asyncWriterLoop() {}
+void VerilatedVcd::chgTasksBegin (VerilatedVcdTaskCallback_t cb, int, void* userthis, vluint32_t code) {
+    m_taskCb = cb;
+    m_taskUserthis = userthis;
+    m_taskCode = code;
+}
+void VerilatedVcd::chgTaskRun (void* vcdp, int task) {
+    VerilatedVcd* selfp = static_cast<VerilatedVcd*>(vcdp);
+    selfp->m_taskCb(selfp, selfp->m_taskUserthis, selfp->m_taskCode, task);
+}
+void VerilatedVcd::chgTasksEnd () { m_taskCb = NULL; }
+void VerilatedVcd::compress (const char*, int) {
+    vl_fatal(__FILE__,__LINE__,"","VerilatedVcd::compress() requires compiling with VL_THREADED");
+}
+void VerilatedVcd::compressQueue (const string&) {}
+void VerilatedVcd::compressWait () {}
+void VerilatedVcd::compressStop () {}
+void VerilatedVcd::forkThreads () {}
+vluint64_t VerilatedVcd::wroteBytes() const { return m_wroteBytes; }
+
+#endif  // VL_THREADED
+
 //======================================================================
 // Static members
 
 void VerilatedVcd::flush_all() {
+    s_vcdVecMutex.lock();
     for (vluint32_t ent = 0; ent< s_vcdVecp.size(); ent++) {
 	VerilatedVcd* vcdp = s_vcdVecp[ent];
 	vcdp->flush();
     }
+    s_vcdVecMutex.unlock();
+}
+
+void VerilatedVcd::fork_all() {
+    // Only the forking thread runs in the child, so no lock
+    for (vluint32_t ent = 0; ent< s_vcdVecp.size(); ent++) {
+	VerilatedVcd* vcdp = s_vcdVecp[ent];
+	vcdp->forkReopen();
+    }
 }
 
 //======================================================================
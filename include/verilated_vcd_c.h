@@ -31,6 +31,9 @@
 using namespace std;
 
 class VerilatedVcd;
+class VerilatedVcdAsync;
+class VerilatedVcdCompress;
+class VerilatedVcdRecorder;
 class VerilatedVcdCallInfo;
 
 // SPDIFF_ON
@@ -68,6 +71,7 @@ public:
 //=============================================================================
 
 typedef void (*VerilatedVcdCallback_t)(VerilatedVcd* vcdp, void* userthis, vluint32_t code);
+typedef void (*VerilatedVcdTaskCallback_t)(VerilatedVcd* vcdp, void* userthis, vluint32_t code, int task);
 
 //=============================================================================
 // VerilatedVcd
@@ -85,6 +89,10 @@ private:
     char		m_scopeEscape;	///< Character to separate scope components
     int			m_modDepth;	///< Depth of module hierarchy
     bool		m_fullDump;	///< True indicates dump ignoring if changed
+    vluint64_t		m_windowStart;	///< Dump only at times from this...
+    vluint64_t		m_windowLength;	///< ...for this long; 0 when dumping is off
+    bool		m_dumpIdle;	///< Dump even when no traced model was evaluated
+    vector<bool*>	m_activityps;	///< Each traced model's activity flag
     vluint32_t		m_nextCode;	///< Next code number to assign
     string		m_modName;	///< Module name being traced now
     double		m_timeRes;	///< Time resolution (ns/ms etc)
@@ -96,12 +104,27 @@ private:
     char*		m_writep;	///< Write pointer into output buffer
     vluint64_t		m_wrChunkSize;	///< Output buffer size
     vluint64_t		m_wroteBytes;	///< Number of bytes written to this file
+    bool		m_async;	///< Format and write on a separate thread
+    VerilatedVcdAsync*	m_asyncp;	///< Writer thread state, when running
+    bool		m_recording;	///< Send values to record(), for async(), recorder or tasks
+    VerilatedVcdRecorder* m_recorderp;	///< Flight recorder state, when keeping in memory
+    VerilatedVcdCompress* m_compressp;	///< Background compression of closed files, when enabled
+
+    VerilatedVcdTaskCallback_t	m_taskCb;	///< Change task routine, when running tasks
+    void*			m_taskUserthis;	///< Change task routine's userthis
+    vluint32_t			m_taskCode;	///< Change task routine's code
+    vector<vector<vluint32_t> >	m_taskRecs;	///< Records made by each change task
 
     vluint32_t*			m_sigs_oldvalp;	///< Pointer to old signal values
+    vluint64_t*			m_sigs_packedp;	///< Per code starting a chgBits group, last values and m_fullGen
+    vluint32_t			m_fullGen;	///< Full dumps made, so chgBits groups differ after one
     vector<VerilatedVcdSig>	m_sigs;		///< Pointer to signal information
+    vector<string>		m_traceGlobs;	///< Names to trace, from traceMatch; empty for all
+    vector<bool>		m_sigs_off;	///< Per code, true if excluded by traceMatch
+    vector<bool>		m_sigs_on;	///< Per code, true if a name matched traceMatch, while declaring
     vector<VerilatedVcdCallInfo*>	m_callbacks;	///< Routines to perform dumping
-    typedef map<string,string>	NameMap;
-    NameMap*			m_namemapp;	///< List of names for the header
+    typedef vector<pair<string,string> > NameMap;  // Vector sorted once, as a map is slow for many names
+    NameMap*			m_namemapp;	///< List of names and declarations for the header
     static vector<VerilatedVcd*>	s_vcdVecp;	///< List of all created traces
 
     void bufferResize(vluint64_t minsize);
@@ -115,9 +138,13 @@ private:
     }
     void closePrev();
     void closeErr();
+    void forkReopen();
+    void forkThreads();
     void openNext();
     void makeNameMap();
     void deleteNameMap();
+    bool traceMatched (const string& name) const;
+    bool recordingNeeded () const { return m_asyncp || m_recorderp || !m_sigs_off.empty(); }
     void printIndent (int levelchange);
     void printStr (const char* str);
     void printQuad (vluint64_t n);
@@ -144,6 +171,117 @@ private:
 	return out + ((char)((code)%94+33));
     }
 
+    // Formatting of values into the write buffer; with async() these are
+    // called by the writer thread, otherwise by the full* routines
+    inline void emitBit (vluint32_t code, const vluint32_t newval) {
+	*m_writep++=('0'+(char)(newval&1)); printCode(code); *m_writep++='\n';
+	bufferCheck();
+    }
+    inline void emitBus (vluint32_t code, const vluint32_t newval, int bits) {
+	*m_writep++='b';
+	for (int bit=bits-1; bit>=0; --bit) {
+	    *m_writep++=((newval&(1L<<bit))?'1':'0');
+	}
+	*m_writep++=' '; printCode(code); *m_writep++='\n';
+	bufferCheck();
+    }
+    inline void emitQuad (vluint32_t code, const vluint64_t newval, int bits) {
+	*m_writep++='b';
+	for (int bit=bits-1; bit>=0; --bit) {
+	    *m_writep++=((newval&(1ULL<<bit))?'1':'0');
+	}
+	*m_writep++=' '; printCode(code); *m_writep++='\n';
+	bufferCheck();
+    }
+    inline void emitArray (vluint32_t code, const vluint32_t* newval, int bits) {
+	*m_writep++='b';
+	for (int bit=bits-1; bit>=0; --bit) {
+	    *m_writep++=((newval[(bit/32)]&(1L<<(bit&0x1f)))?'1':'0');
+	}
+	*m_writep++=' '; printCode(code); *m_writep++='\n';
+	bufferCheck();
+    }
+    inline void emitTriBit (vluint32_t code, const vluint32_t newval, const vluint32_t newtri) {
+	*m_writep++ = "01zz"[newval | (newtri<<1)];
+	printCode(code); *m_writep++='\n';
+	bufferCheck();
+    }
+    inline void emitTriBus (vluint32_t code, const vluint32_t newval, const vluint32_t newtri, int bits) {
+	*m_writep++='b';
+	for (int bit=bits-1; bit>=0; --bit) {
+	    *m_writep++ = "01zz"[((newval >> bit)&1)
+				 | (((newtri >> bit)&1)<<1)];
+	}
+	*m_writep++=' '; printCode(code); *m_writep++='\n';
+	bufferCheck();
+    }
+    inline void emitTriQuad (vluint32_t code, const vluint64_t newval, const vluint32_t newtri, int bits) {
+	*m_writep++='b';
+	for (int bit=bits-1; bit>=0; --bit) {
+	    *m_writep++ = "01zz"[((newval >> bit)&1ULL)
+				 | (((newtri >> bit)&1ULL)<<1ULL)];
+	}
+	*m_writep++=' '; printCode(code); *m_writep++='\n';
+	bufferCheck();
+    }
+    inline void emitTriArray (vluint32_t code, const vluint32_t* newvalp, const vluint32_t* newtrip, int bits) {
+	*m_writep++='b';
+	for (int bit=bits-1; bit>=0; --bit) {
+	    vluint32_t valbit = (newvalp[(bit/32)]>>(bit&0x1f)) & 1;
+	    vluint32_t tribit = (newtrip[(bit/32)]>>(bit&0x1f)) & 1;
+	    *m_writep++ = "01zz"[valbit | (tribit<<1)];
+	}
+	*m_writep++=' '; printCode(code); *m_writep++='\n';
+	bufferCheck();
+    }
+    void emitDouble (vluint32_t code, const double newval);
+    inline void emitBitX (vluint32_t code) {
+	*m_writep++='x'; printCode(code); *m_writep++='\n';
+	bufferCheck();
+    }
+    inline void emitBusX (vluint32_t code, int bits) {
+	*m_writep++='b';
+	for (int bit=bits-1; bit>=0; --bit) {
+	    *m_writep++='x';
+	}
+	*m_writep++=' '; printCode(code); *m_writep++='\n';
+	bufferCheck();
+    }
+
+    // Asynchronous writer
+    enum RecType { REC_TIME, REC_BIT, REC_BUS, REC_QUAD, REC_ARRAY,
+		   REC_TRIBIT, REC_TRIBUS, REC_TRIQUAD, REC_TRIARRAY,
+		   REC_DOUBLE, REC_BITX, REC_BUSX };
+    static inline int recordWords (vluint32_t type, int bits) {
+	switch (type) {
+	case REC_BITX: case REC_BUSX: return 0;
+	case REC_BIT: case REC_BUS: return 1;
+	case REC_TIME: case REC_QUAD: case REC_TRIBIT: case REC_TRIBUS: case REC_DOUBLE: return 2;
+	case REC_TRIQUAD: return 3;
+	case REC_ARRAY: return ((bits-1)/32)+1;
+	default: return 2*(((bits-1)/32)+1);  // REC_TRIARRAY
+	}
+    }
+    void record (vluint32_t type, vluint32_t code, int bits,
+		 const vluint32_t* datap, int words, const vluint32_t* data2p=NULL);
+    void recorderCheck (vluint64_t timeui);
+    void recorderRecord (vluint32_t type, vluint32_t code, int bits,
+			 const vluint32_t* datap, int words, const vluint32_t* data2p=NULL);
+    void recorderWrite ();
+    void asyncRecord (vluint32_t type, vluint32_t code, int bits,
+		      const vluint32_t* datap, int words, const vluint32_t* data2p=NULL);
+    void asyncStart();
+    void asyncPublish();
+    void asyncDrain();
+    void asyncStop();
+    void asyncWriterLoop();
+    void asyncEmit (vluint32_t type, vluint32_t code, int bits, const vluint32_t* datap);
+    void compressQueue (const string& filename);
+    void compressWait ();
+    void compressStop ();
+    vluint64_t wroteBytes() const;
+    friend class VerilatedVcdAsync;
+
     VerilatedVcd(const VerilatedVcd& );	///< N/A, no copy constructor
 
 protected:
@@ -162,16 +300,34 @@ public:
     void rolloverMB(vluint64_t rolloverMB) { m_rolloverMB=rolloverMB; };
     /// Is file open?
     bool isOpen() const { return m_isOpen; }
+    /// Format and write the file on a separate thread (requires VL_THREADED).
+    /// Must be set before open().
+    void async(bool flag) { m_async = flag; }
+    /// Keep only the last keepTime of changes in memory, with a full dump
+    /// every keyframeTime (default keepTime/4), and using at most maxMB
+    /// (default unlimited) for them; flush() and close() write them.
+    void flightRecorder (vluint64_t keepTime, vluint64_t keyframeTime=0, size_t maxMB=0);
+    /// Compress each file once closed, e.g. each rolloverMB segment, by
+    /// running command (e.g. "gzip") with the filename on one of threads
+    /// background threads.  Closing more files than threads are compressing
+    /// waits, to bound the work queued.  close() waits for all to finish.
+    /// Requires VL_THREADED.  Set before open().
+    void compress (const char* command, int threads=2);
     /// Change character that splits scopes.  Note whitespace are ALWAYS escapes.
     void scopeEscape(char flag) { m_scopeEscape = flag; }
     /// Is this an escape?
-    inline bool isScopeEscape(char c) { return isspace(c) || c==m_scopeEscape; }
+    inline bool isScopeEscape(char c) const { return isspace(c) || c==m_scopeEscape; }
+    /// Trace only signals whose full name, e.g. "top.t.sub.sig", matches
+    /// a glob given here (with * and ?).  May be called multiple times,
+    /// before open().  Excluded signals are not formatted or written.
+    void traceMatch(const char* globp) { m_traceGlobs.push_back(globp); }
 
     // METHODS
     void open (const char* filename);	///< Open the file; call isOpen() to see if errors
     void openNext (bool incFilename);	///< Open next data-only file
-    void flush() { bufferFlush(); }	///< Flush any remaining data
+    void flush();			///< Flush any remaining data
     static void flush_all();		///< Flush any remaining data from all files
+    static void fork_all();		///< In a Verilated::forkChild() child, reopen all files
     void close ();			///< Close the file
 
     void set_time_unit (const char* unit); ///< Set time units (s/ms, defaults to ns)
@@ -184,14 +340,48 @@ public:
     string doubleToTimescale (double value);
 
     /// Inside dumping routines, called each cycle to make the dump
-    void dump     (vluint64_t timeui);
+    void dump (vluint64_t timeui) {
+	// Outside the window this test is the only cost; the next dump inside is full
+	if (VL_UNLIKELY((timeui - m_windowStart) >= m_windowLength)) { m_fullDump = true; return; }
+	dumpInWindow(timeui);
+    }
+    void dumpInWindow (vluint64_t timeui);
+    bool activity () const {
+	for (vector<bool*>::const_iterator it = m_activityps.begin(); it != m_activityps.end(); ++it) {
+	    if (**it) return true;
+	}
+	return m_activityps.empty();
+    }
+    /// Dump only at times startTime <= time < stopTime, e.g. around a failure
+    void dumpWindow (vluint64_t startTime, vluint64_t stopTime) {
+	m_windowStart = startTime;
+	m_windowLength = (stopTime > startTime) ? (stopTime - startTime) : 0;
+    }
+    /// Start dumping at all times (the default), e.g. from a DPI trigger
+    void dumpOn () { m_windowStart = 0; m_windowLength = ~VL_ULL(0); }
+    /// Stop dumping until dumpOn() or dumpWindow()
+    void dumpOff () { m_windowLength = 0; }
+    /// Skip dumps, including their time, when no traced model was
+    /// evaluated since the last dump; false suits SystemC, which calls
+    /// dump at every time step of the whole simulation
+    void dumpIdle (bool flag) { m_dumpIdle = flag; }
     /// Call dump with a absolute unscaled time in seconds
     void dumpSeconds (double secs) { dump((vluint64_t)(secs * m_timeRes)); }
 
+    /// Inside change dumping routines with --threads, run count independent
+    /// routines, e.g. by executing chgTaskRun on a VlThreadPool, as
+    /// chgTasksBegin(); for each task chgTaskRun(vcdp, task); chgTasksEnd().
+    /// The values each task changes are emitted in task order.
+    void chgTasksBegin (VerilatedVcdTaskCallback_t cb, int count, void* userthis, vluint32_t code);
+    static void chgTaskRun (void* vcdp, int task);
+    void chgTasksEnd ();
+
     /// Inside dumping routines, declare callbacks for tracings
     void addCallback (VerilatedVcdCallback_t init, VerilatedVcdCallback_t full,
 		      VerilatedVcdCallback_t change,
 		      void* userthis);
+    /// Inside dumping routines, declare a model's flag set when it is evaluated
+    void addActivity (bool* activityp) { m_activityps.push_back(activityp); }
 
     /// Inside dumping routines, declare a module
     void module (const string& name);
@@ -212,81 +402,57 @@ public:
     void fullBit (vluint32_t code, const vluint32_t newval) {
 	// Note the &1, so we don't require clean input -- makes more common no change case faster
 	m_sigs_oldvalp[code] = newval;
-	*m_writep++=('0'+(char)(newval&1)); printCode(code); *m_writep++='\n';
-	bufferCheck();
+	if (VL_UNLIKELY(m_recording)) { record(REC_BIT, code, 1, &newval, 1); return; }
+	emitBit(code, newval);
     }
     void fullBus (vluint32_t code, const vluint32_t newval, int bits) {
 	m_sigs_oldvalp[code] = newval;
-	*m_writep++='b';
-	for (int bit=bits-1; bit>=0; --bit) {
-	    *m_writep++=((newval&(1L<<bit))?'1':'0');
-	}
-	*m_writep++=' '; printCode(code); *m_writep++='\n';
-	bufferCheck();
+	if (VL_UNLIKELY(m_recording)) { record(REC_BUS, code, bits, &newval, 1); return; }
+	emitBus(code, newval, bits);
     }
     void fullQuad (vluint32_t code, const vluint64_t newval, int bits) {
 	(*((vluint64_t*)&m_sigs_oldvalp[code])) = newval;
-	*m_writep++='b';
-	for (int bit=bits-1; bit>=0; --bit) {
-	    *m_writep++=((newval&(1ULL<<bit))?'1':'0');
-	}
-	*m_writep++=' '; printCode(code); *m_writep++='\n';
-	bufferCheck();
+	if (VL_UNLIKELY(m_recording)) { record(REC_QUAD, code, bits, &m_sigs_oldvalp[code], 2); return; }
+	emitQuad(code, newval, bits);
     }
     void fullArray (vluint32_t code, const vluint32_t* newval, int bits) {
 	for (int word=0; word<(((bits-1)/32)+1); ++word) {
 	    m_sigs_oldvalp[code+word] = newval[word];
 	}
-	*m_writep++='b';
-	for (int bit=bits-1; bit>=0; --bit) {
-	    *m_writep++=((newval[(bit/32)]&(1L<<(bit&0x1f)))?'1':'0');
-	}
-	*m_writep++=' '; printCode(code); *m_writep++='\n';
-	bufferCheck();
+	if (VL_UNLIKELY(m_recording)) { record(REC_ARRAY, code, bits, newval, ((bits-1)/32)+1); return; }
+	emitArray(code, newval, bits);
     }
     void fullTriBit (vluint32_t code, const vluint32_t newval, const vluint32_t newtri) {
 	m_sigs_oldvalp[code]   = newval;
 	m_sigs_oldvalp[code+1] = newtri;
-	*m_writep++ = "01zz"[m_sigs_oldvalp[code]
-			     | (m_sigs_oldvalp[code+1]<<1)];
-	printCode(code); *m_writep++='\n';
-	bufferCheck();
+	if (VL_UNLIKELY(m_recording)) { record(REC_TRIBIT, code, 1, &m_sigs_oldvalp[code], 2); return; }
+	emitTriBit(code, newval, newtri);
     }
     void fullTriBus (vluint32_t code, const vluint32_t newval, const vluint32_t newtri, int bits) {
 	m_sigs_oldvalp[code] = newval;
 	m_sigs_oldvalp[code+1] = newtri;
-	*m_writep++='b';
-	for (int bit=bits-1; bit>=0; --bit) {
-	    *m_writep++ = "01zz"[((newval >> bit)&1)
-				 | (((newtri >> bit)&1)<<1)];
-	}
-	*m_writep++=' '; printCode(code); *m_writep++='\n';
-	bufferCheck();
+	if (VL_UNLIKELY(m_recording)) { record(REC_TRIBUS, code, bits, &m_sigs_oldvalp[code], 2); return; }
+	emitTriBus(code, newval, newtri, bits);
     }
     void fullTriQuad (vluint32_t code, const vluint64_t newval, const vluint32_t newtri, int bits) {
 	(*((vluint64_t*)&m_sigs_oldvalp[code])) = newval;
 	(*((vluint64_t*)&m_sigs_oldvalp[code+1])) = newtri;
-	*m_writep++='b';
-	for (int bit=bits-1; bit>=0; --bit) {
-	    *m_writep++ = "01zz"[((newval >> bit)&1ULL)
-				 | (((newtri >> bit)&1ULL)<<1ULL)];
+	if (VL_UNLIKELY(m_recording)) {
+	    vluint32_t data[3] = { (vluint32_t)newval, (vluint32_t)(newval>>32ULL), newtri };
+	    record(REC_TRIQUAD, code, bits, data, 3); return;
 	}
-	*m_writep++=' '; printCode(code); *m_writep++='\n';
-	bufferCheck();
+	emitTriQuad(code, newval, newtri, bits);
     }
     void fullTriArray (vluint32_t code, const vluint32_t* newvalp, const vluint32_t* newtrip, int bits) {
 	for (int word=0; word<(((bits-1)/32)+1); ++word) {
 	    m_sigs_oldvalp[code+word*2]   = newvalp[word];
 	    m_sigs_oldvalp[code+word*2+1] = newtrip[word];
 	}
-	*m_writep++='b';
-	for (int bit=bits-1; bit>=0; --bit) {
-	    vluint32_t valbit = (newvalp[(bit/32)]>>(bit&0x1f)) & 1;
-	    vluint32_t tribit = (newtrip[(bit/32)]>>(bit&0x1f)) & 1;
-	    *m_writep++ = "01zz"[valbit | (tribit<<1)];
+	if (VL_UNLIKELY(m_recording)) {
+	    record(REC_TRIARRAY, code, bits, newvalp, ((bits-1)/32)+1, newtrip);
+	    return;
 	}
-	*m_writep++=' '; printCode(code); *m_writep++='\n';
-	bufferCheck();
+	emitTriArray(code, newvalp, newtrip, bits);
     }
     void fullDouble (vluint32_t code, const double newval);
     void fullFloat (vluint32_t code, const float newval);
@@ -296,16 +462,12 @@ public:
     /// Thus this is for special standalone applications that after calling
     /// fullBitX, must when then value goes non-X call fullBit.
     inline void fullBitX (vluint32_t code) {
-	*m_writep++='x'; printCode(code); *m_writep++='\n';
-	bufferCheck();
+	if (VL_UNLIKELY(m_recording)) { record(REC_BITX, code, 1, NULL, 0); return; }
+	emitBitX(code);
     }
     inline void fullBusX (vluint32_t code, int bits) {
-	*m_writep++='b';
-	for (int bit=bits-1; bit>=0; --bit) {
-	    *m_writep++='x';
-	}
-	*m_writep++=' '; printCode(code); *m_writep++='\n';
-	bufferCheck();
+	if (VL_UNLIKELY(m_recording)) { record(REC_BUSX, code, bits, NULL, 0); return; }
+	emitBusX(code, bits);
     }
     inline void fullQuadX (vluint32_t code, int bits) { fullBusX (code, bits); }
     inline void fullArrayX (vluint32_t code, int bits) { fullBusX (code, bits); }
@@ -320,6 +482,16 @@ public:
 	    }
 	}
     }
+    /// Inside dumping routines, dump 1-bit signals with consecutive codes if
+    /// any changed; bit i of newvals is code+i.  Compares all of them at once
+    /// against their last values, which a full dump invalidates.
+    inline void chgBits (vluint32_t code, const vluint32_t newvals, int count) {
+	vluint64_t packed = (((vluint64_t)m_fullGen)<<32ULL) | newvals;
+	if (VL_UNLIKELY(m_sigs_packedp[code] != packed)) {
+	    m_sigs_packedp[code] = packed;
+	    for (int i=0; i<count; ++i) chgBit(code+i, (newvals>>i) & 1);
+	}
+    }
     inline void chgBus (vluint32_t code, const vluint32_t newval, int bits) {
 	vluint32_t diff = m_sigs_oldvalp[code] ^ newval;
 	if (VL_UNLIKELY(diff)) {
@@ -419,6 +591,18 @@ public:
     void openNext (bool incFilename=true) { m_sptrace.openNext(incFilename); }
     /// Set size in megabytes after which new file should be created
     void rolloverMB(size_t rolloverMB) { m_sptrace.rolloverMB(rolloverMB); };
+    /// Format and write on a separate thread; set before open (requires VL_THREADED)
+    void async(bool flag) { m_sptrace.async(flag); }
+    /// Trace only signals with full names matching the glob; see
+    /// VerilatedVcd::traceMatch.  Set before open.
+    void traceMatch(const char* globp) { m_sptrace.traceMatch(globp); }
+    /// Compress each closed file in the background; see VerilatedVcd::compress.
+    /// Set before open.
+    void compress(const char* command, int threads=2) { m_sptrace.compress(command, threads); }
+    /// Keep only recent changes in memory, writing them at flush() or close();
+    /// see VerilatedVcd::flightRecorder.  Set before open.
+    void flightRecorder(vluint64_t keepTime, vluint64_t keyframeTime=0, size_t maxMB=0) {
+	m_sptrace.flightRecorder(keepTime, keyframeTime, maxMB); }
     /// Close dump
     void close() { m_sptrace.close(); }
     /// Flush dump
@@ -430,6 +614,15 @@ public:
     void dump (double timestamp) { dump((vluint64_t)timestamp); }
     void dump (vluint32_t timestamp) { dump((vluint64_t)timestamp); }
     void dump (int timestamp) { dump((vluint64_t)timestamp); }
+    /// Dump only at times startTime <= time < stopTime; the first dump
+    /// in the window writes all values.  Outside it dump() just returns.
+    void dumpWindow (vluint64_t startTime, vluint64_t stopTime) { m_sptrace.dumpWindow(startTime, stopTime); }
+    /// Dump at all times (the default)
+    void dumpOn () { m_sptrace.dumpOn(); }
+    /// Stop dumping until dumpOn() or dumpWindow()
+    void dumpOff () { m_sptrace.dumpOff(); }
+    /// Skip dumps when no traced model was evaluated; see VerilatedVcd::dumpIdle
+    void dumpIdle (bool flag) { m_sptrace.dumpIdle(flag); }
     /// Set time units (s/ms, defaults to ns)
     /// See also VL_TIME_PRECISION, and VL_TIME_MULTIPLIER in verilated.h
     void set_time_unit (const char* unit) { m_sptrace.set_time_unit(unit); }
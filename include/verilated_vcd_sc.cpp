@@ -31,13 +31,13 @@
 #if (SYSTEMC_VERSION>=20050714)
     // SystemC 2.1.v1
 // cppcheck-suppress unusedFunction
-void VerilatedVcdSc::write_comment (const std::string &) {}
-void VerilatedVcdSc::trace (const unsigned int &, const std::string &, const char **) {}
+void VerilatedScTraceFile::write_comment (const std::string &) {}
+void VerilatedScTraceFile::trace (const unsigned int &, const std::string &, const char **) {}
 
 # define DECL_TRACE_METHOD_A(tp) \
-    void VerilatedVcdSc::trace( const tp& object, const std::string& name ) {}
+    void VerilatedScTraceFile::trace( const tp& object, const std::string& name ) {}
 # define DECL_TRACE_METHOD_B(tp) \
-    void VerilatedVcdSc::trace( const tp& object, const std::string& name, int width ) {}
+    void VerilatedScTraceFile::trace( const tp& object, const std::string& name, int width ) {}
 
     DECL_TRACE_METHOD_A( bool )
     DECL_TRACE_METHOD_A( sc_dt::sc_bit )
@@ -76,13 +76,13 @@ void VerilatedVcdSc::trace (const unsigned int &, const std::string &, const cha
 #elif (SYSTEMC_VERSION>20011000)
     // SystemC 2.0.1
 // cppcheck-suppress unusedFunction
-void VerilatedVcdSc::write_comment (const sc_string &) {}
-void VerilatedVcdSc::trace (const unsigned int &, const sc_string &, const char **) {}
+void VerilatedScTraceFile::write_comment (const sc_string &) {}
+void VerilatedScTraceFile::trace (const unsigned int &, const sc_string &, const char **) {}
 
 #define DECL_TRACE_METHOD_A(tp) \
-    void VerilatedVcdSc::trace( const tp& object, const sc_string& name ) {}
+    void VerilatedScTraceFile::trace( const tp& object, const sc_string& name ) {}
 #define DECL_TRACE_METHOD_B(tp) \
-    void VerilatedVcdSc::trace( const tp& object, const sc_string& name, int width ) {}
+    void VerilatedScTraceFile::trace( const tp& object, const sc_string& name, int width ) {}
 
     DECL_TRACE_METHOD_A( bool )
     DECL_TRACE_METHOD_A( sc_bit )
@@ -119,13 +119,13 @@ void VerilatedVcdSc::trace (const unsigned int &, const sc_string &, const char
 #else
     // SystemC 1.2.1beta
 // cppcheck-suppress unusedFunction
-void VerilatedVcdSc::write_comment (const sc_string &) {}
-void VerilatedVcdSc::trace (const unsigned int &, const sc_string &, const char **) {}
+void VerilatedScTraceFile::write_comment (const sc_string &) {}
+void VerilatedScTraceFile::trace (const unsigned int &, const sc_string &, const char **) {}
 
 #define DECL_TRACE_METHOD_A(tp) \
-    void VerilatedVcdSc::trace( const tp& object, const sc_string& name ) {}
+    void VerilatedScTraceFile::trace( const tp& object, const sc_string& name ) {}
 #define DECL_TRACE_METHOD_B(tp) \
-    void VerilatedVcdSc::trace( const tp& object, const sc_string& name, int width ) {}
+    void VerilatedScTraceFile::trace( const tp& object, const sc_string& name, int width ) {}
 
     DECL_TRACE_METHOD_A( bool )
     DECL_TRACE_METHOD_B( unsigned char )
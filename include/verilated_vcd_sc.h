@@ -28,44 +28,46 @@
 
 // SPDIFF_ON
 //=============================================================================
-// VerilatedVcdSc
+// VerilatedScTraceFile
 ///
-/// This class is passed to the SystemC simulation kernel, just like a
-/// documented SystemC trace format.
+/// SystemC trace file glue shared by VerilatedVcdSc and VerilatedBinSc.
+/// The kernel calls cycle() at every time step, so the trace is told to
+/// skip steps in which no traced model was evaluated.
 
-class VerilatedVcdSc
+class VerilatedScTraceFile
     : sc_trace_file
-    , public VerilatedVcdC
 {
-public:
-    VerilatedVcdSc() {
+protected:
+    VerilatedScTraceFile() {
 	sc_get_curr_simcontext()->add_trace_file(this);
+    }
+    virtual ~VerilatedScTraceFile() {}
+    /// Write one time step of dump data
+    virtual void scDump(double timestamp) = 0;
+    /// Take the trace's time unit and resolution from SystemC's, and skip idle steps
+    template <class T_Trace> static void scSetup(T_Trace* tracep) {
 # if (SYSTEMC_VERSION>=20060505)
 	// We want to avoid a depreciated warning, but still be back compatible.
 	// Turning off the message just for this still results in an annoying "to turn off" message.
 	sc_time t1sec(1,SC_SEC);
 	if (t1sec.to_default_time_units()!=0) {
 	    sc_time tunits(1.0/t1sec.to_default_time_units(),SC_SEC);
-	    spTrace()->set_time_unit(tunits.to_string());
+	    tracep->set_time_unit(tunits.to_string());
 	}
-	spTrace()->set_time_resolution(sc_get_time_resolution().to_string());
+	tracep->set_time_resolution(sc_get_time_resolution().to_string());
 # elif (SYSTEMC_VERSION>20011000)
 	// To confuse matters 2.1.beta returns a char* here, while 2.1.v1 returns a std::string
 	// we allow both flavors with overloaded set_time_* functions.
-	spTrace()->set_time_unit(sc_get_default_time_unit().to_string());
-	spTrace()->set_time_resolution(sc_get_time_resolution().to_string());
+	tracep->set_time_unit(sc_get_default_time_unit().to_string());
+	tracep->set_time_resolution(sc_get_time_resolution().to_string());
 # endif
+	tracep->dumpIdle(false);
     }
-
-    virtual ~VerilatedVcdSc() {}
+public:
     /// Called by SystemC simulate()
     virtual void cycle (bool delta_cycle) {
-# if (SYSTEMC_VERSION>20011000)
-	if (!delta_cycle) { this->dump(sc_time_stamp().to_double()); }
-# else
 	// VCD files must have integer timestamps, so we write all times in increments of time_resolution
-	if (!delta_cycle) { this->dump(sc_time_stamp().to_double()); }
-# endif
+	if (!delta_cycle) { scDump(sc_time_stamp().to_double()); }
     }
 
 private:
@@ -210,4 +212,23 @@ private:
 # undef DECL_TRACE_METHOD_B
 };
 
+//=============================================================================
+// VerilatedVcdSc
+///
+/// This class is passed to the SystemC simulation kernel, just like a
+/// documented SystemC trace format.
+
+class VerilatedVcdSc
+    : VerilatedScTraceFile
+    , public VerilatedVcdC
+{
+public:
+    VerilatedVcdSc() {
+	scSetup(spTrace());
+    }
+    virtual ~VerilatedVcdSc() {}
+protected:
+    virtual void scDump(double timestamp) { this->dump(timestamp); }
+};
+
 #endif // guard
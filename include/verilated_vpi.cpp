@@ -32,14 +32,253 @@
 #include "verilated.h"
 #include "verilated_vpi.h"
 
+#ifdef VL_THREADED
+# include <mutex>
+#endif
+
 //======================================================================
 
 VerilatedVpi VerilatedVpi::s_s;  // Singleton
-vluint8_t* VerilatedVpio::s_freeHead = NULL;
+vluint8_t* VerilatedVpio::s_freeHeads[VerilatedVpio::FREE_CLASSES];
+#ifdef VL_THREADED
+static std::mutex s_vpiChangedMutex;  // Protects VerilatedVpi::m_changed
+#endif
+
+//======================================================================
+// VerilatedVpio Methods
+
+vluint8_t* VerilatedVpio::freeRefill(size_t sclass) {
+    // Carve a batch of objects from one allocation onto the free list
+    size_t chunk = sclass*FREE_GRAIN + 8;  // +8: 8 bytes for next
+    vluint8_t* blockp = (vluint8_t*)(::operator new(chunk*FREE_BATCH));
+    for (int i=FREE_BATCH-1; i>=0; --i) {
+	vluint8_t* newp = blockp + chunk*i;
+	*((vluint8_t**)newp) = s_freeHeads[sclass];
+	s_freeHeads[sclass] = newp;
+    }
+    return s_freeHeads[sclass];
+}
+
+vpiHandle VerilatedVpioVarIter::dovpi_scan() {
+    if (VL_LIKELY(m_scopep->varsp())) {
+	VerilatedVarNameMap* varsp = m_scopep->varsp();
+	if (VL_UNLIKELY(!m_started)) { m_it = varsp->begin(); m_started=true; }
+	else if (VL_UNLIKELY(m_it == varsp->end())) return 0;
+	else ++m_it;
+	if (m_it == varsp->end()) return 0;
+	return VerilatedVpi::varHandle(&(m_it->second), m_scopep);
+    } else {
+	return 0;  // End of list - only one deep
+    }
+}
 
 //======================================================================
 // VerilatedVpi Methods
 
+vpiHandle VerilatedVpi::scopeHandle(const VerilatedScope* scopep) {
+    VpioScopeHandles::iterator it = s_s.m_scopeHandles.find(scopep);
+    if (VL_LIKELY(it != s_s.m_scopeHandles.end())) return it->second->castVpiHandle();
+    VerilatedVpioScope* vop = new VerilatedVpioScope(scopep);
+    vop->cached(true);
+    s_s.m_scopeHandles.insert(make_pair(scopep, vop));
+    return vop->castVpiHandle();
+}
+
+vpiHandle VerilatedVpi::varHandle(const VerilatedVar* varp, const VerilatedScope* scopep) {
+    VpioVarHandles::key_type key = make_pair(scopep, varp);
+    VpioVarHandles::iterator it = s_s.m_varHandles.find(key);
+    if (VL_LIKELY(it != s_s.m_varHandles.end())) return it->second->castVpiHandle();
+    VerilatedVpioVar* vop = new VerilatedVpioVar(varp, scopep);
+    vop->cached(true);
+    s_s.m_varHandles.insert(make_pair(key, vop));
+    return vop->castVpiHandle();
+}
+
+void Verilated::vpiChanged(CData* chgp) {
+    *chgp = 1;
+    VerilatedVpi::changed(chgp);
+}
+
+void VerilatedVpi::changed(CData* chgp) {
+#ifdef VL_THREADED
+    std::lock_guard<std::mutex> lock(s_vpiChangedMutex);
+#endif
+    s_s.m_changed.push_back(chgp);
+}
+
+void VerilatedVpi::callValueCbs() {
+    // Signals the model marks with VL_VPI_CHG are only checked when written
+    // since the last call; any others are always checked.  A written
+    // signal without callbacks keeps its flag set, so further writes
+    // don't report it again; cbReasonAdd rearms it.
+    vector<CData*> changed;
+    {
+#ifdef VL_THREADED
+	std::lock_guard<std::mutex> lock(s_vpiChangedMutex);
+#endif
+	changed.swap(s_s.m_changed);
+    }
+    set<VerilatedVpioVar*> update; // set of objects to update after callbacks
+    for (vector<CData*>::iterator it=changed.begin(); it!=changed.end(); ++it) {
+	CData* chgp = *it;
+	if (VL_UNLIKELY(!*chgp)) continue;  // Duplicate, or rearmed since
+	VpioChgCbs::iterator cit = s_s.m_chgCbs.find(chgp);
+	if (cit == s_s.m_chgCbs.end()) continue;
+	*chgp = 0;  // Before callbacks, so their writes are seen next call
+	callValueCbList(cit->second, update);
+	if (cit->second.empty()) s_s.m_chgCbs.erase(cit);
+    }
+    callValueCbList(s_s.m_cbObjLists[cbValueChange], update);
+    for (set<VerilatedVpioVar*>::iterator it=update.begin(); it!=update.end(); ++it) {
+	memcpy((*it)->prevDatap(), (*it)->varDatap(), (*it)->entSize());
+    }
+}
+
+void VerilatedVpi::callValueCbList(VpioCbList& cbObjList, set<VerilatedVpioVar*>& update) {
+    for (VpioCbList::iterator it=cbObjList.begin(); it!=cbObjList.end();) {
+	if (VL_UNLIKELY(!*it)) { // Deleted earlier, cleanup
+	    it = cbObjList.erase(it);
+	    continue;
+	}
+	VerilatedVpioCb* vop = *it++;
+	if (VerilatedVpioVar* varop = VerilatedVpioVar::castp(vop->cb_datap()->obj)) {
+	    void* newDatap = varop->varDatap();
+	    void* prevDatap = varop->prevDatap();  // Was malloced when we added the callback
+	    VL_DEBUG_IF_PLI(VL_PRINTF("-vltVpi:  value_test %s v[0]=%d/%d %p %p\n",
+				      varop->fullname(), *((CData*)newDatap), *((CData*)prevDatap),
+				      newDatap, prevDatap););
+	    if (memcmp(prevDatap, newDatap, varop->entSize())) {
+		VL_DEBUG_IF_PLI(VL_PRINTF("-vltVpi:  value_callback %p %s v[0]=%d\n",
+					  vop,varop->fullname(), *((CData*)newDatap)););
+		update.insert(varop);
+		vpi_get_value(vop->cb_datap()->obj, vop->cb_datap()->value);
+		(vop->cb_rtnp()) (vop->cb_datap());
+	    }
+	}
+    }
+}
+
+
+void VerilatedVpi::timedWheelPut(VerilatedVpioCb* vop) {
+    // Caller ensures m_wheelTime <= time < m_wheelTime+TIMED_WHEEL
+    VpioCbList& slot = s_s.m_timedWheel[vop->time() & (TIMED_WHEEL-1)];
+    vop->timedWhere(VerilatedVpioCb::TIMED_LIST, slot.insert(slot.end(), vop));
+    ++s_s.m_wheelEntries;
+}
+
+void VerilatedVpi::cbTimedAdd(VerilatedVpioCb* vop) {
+    if (VL_UNLIKELY(vop->time() < s_s.m_wheelTime)) {
+	if (VL_UNLIKELY(timedRewound(VL_TIME_Q()))) {
+	    // Not due; timedRewind will place it with the others
+	    s_s.m_timedFar.insert(make_pair(vop->time(), vop));
+	    vop->timedWhere(VerilatedVpioCb::TIMED_FAR);
+	} else {  // Already due
+	    vop->timedWhere(VerilatedVpioCb::TIMED_LIST,
+			    s_s.m_timedDue.insert(s_s.m_timedDue.end(), vop));
+	}
+    } else if (vop->time() < s_s.m_wheelTime + TIMED_WHEEL) {
+	timedWheelPut(vop);
+    } else {
+	s_s.m_timedFar.insert(make_pair(vop->time(), vop));
+	vop->timedWhere(VerilatedVpioCb::TIMED_FAR);
+    }
+}
+
+void VerilatedVpi::cbTimedRemove(VerilatedVpioCb* cbp) {
+    if (cbp->timedWhere() == VerilatedVpioCb::TIMED_LIST) {
+	// We do not remove it now as we may be iterating the list,
+	// instead set to NULL and will cleanup later
+	*(cbp->timedIt()) = NULL;
+    } else if (cbp->timedWhere() == VerilatedVpioCb::TIMED_FAR) {
+	s_s.m_timedFar.erase(make_pair(cbp->time(), cbp));
+    }
+    cbp->timedWhere(VerilatedVpioCb::TIMED_NONE);
+}
+
+void VerilatedVpi::timedFarToWheel() {
+    // Far callbacks now within the wheel's times move into it
+    while (!s_s.m_timedFar.empty()
+	   && s_s.m_timedFar.begin()->first < s_s.m_wheelTime + TIMED_WHEEL) {
+	VerilatedVpioCb* vop = s_s.m_timedFar.begin()->second;
+	s_s.m_timedFar.erase(s_s.m_timedFar.begin());
+	timedWheelPut(vop);
+    }
+}
+
+void VerilatedVpi::timedRewind() {
+    // Time went back, e.g. to rerun a test, so callbacks no longer due
+    // must not be called.  Place every callback again starting from zero.
+    VpioCbList cbs;
+    cbs.splice(cbs.end(), s_s.m_timedDue);
+    for (int i=0; i<TIMED_WHEEL; ++i) cbs.splice(cbs.end(), s_s.m_timedWheel[i]);
+    s_s.m_wheelEntries = 0;
+    s_s.m_wheelTime = 0;
+    for (VpioCbList::iterator it=cbs.begin(); it!=cbs.end(); ++it) {
+	if (*it) cbTimedAdd(*it);
+    }
+    timedFarToWheel();
+}
+
+void VerilatedVpi::timedAdvance(QData time) {
+    if (VL_UNLIKELY(timedRewound(time))) timedRewind();
+    // Move callbacks at or before time from the wheel to the due list
+    while (s_s.m_wheelTime <= time) {
+	if (!s_s.m_wheelEntries) {
+	    // Nothing near, so skip to the next far callback, or past time
+	    QData nextTime = time + 1;
+	    if (!s_s.m_timedFar.empty() && s_s.m_timedFar.begin()->first < nextTime) {
+		nextTime = s_s.m_timedFar.begin()->first;
+	    }
+	    s_s.m_wheelTime = nextTime;
+	} else {
+	    VpioCbList& slot = s_s.m_timedWheel[s_s.m_wheelTime & (TIMED_WHEEL-1)];
+	    for (VpioCbList::iterator it=slot.begin(); it!=slot.end(); ++it) {
+		--s_s.m_wheelEntries;
+	    }
+	    // Splicing keeps the callbacks' iterators valid
+	    s_s.m_timedDue.splice(s_s.m_timedDue.end(), slot);
+	    ++s_s.m_wheelTime;
+	}
+	timedFarToWheel();
+    }
+}
+
+void VerilatedVpi::callTimedCbs() {
+    timedAdvance(VL_TIME_Q());
+    // Due callbacks are called each time until removed.  Those added by
+    // these callbacks are called next time.
+    VpioCbList& cbObjList = s_s.m_timedDue;
+    if (cbObjList.empty()) return;
+    VpioCbList::iterator lastIt = --cbObjList.end();
+    for (VpioCbList::iterator it=cbObjList.begin(); true; ) {
+	bool last = (it == lastIt);
+	if (VL_UNLIKELY(!*it)) { // Deleted earlier, cleanup
+	    it = cbObjList.erase(it);
+	} else {
+	    VerilatedVpioCb* vop = *it++;
+	    VL_DEBUG_IF_PLI(VL_PRINTF("-vltVpi:  timed_callback %p\n",vop););
+	    (vop->cb_rtnp()) (vop->cb_datap());
+	}
+	if (last) break;
+    }
+}
+
+QData VerilatedVpi::cbNextDeadline() {
+    if (VL_UNLIKELY(timedRewound(VL_TIME_Q()))) timedRewind();
+    for (VpioCbList::iterator it=s_s.m_timedDue.begin(); it!=s_s.m_timedDue.end(); ++it) {
+	if (*it) return (*it)->time();
+    }
+    if (s_s.m_wheelEntries) {
+	for (QData time = s_s.m_wheelTime; time < s_s.m_wheelTime + TIMED_WHEEL; ++time) {
+	    VpioCbList& slot = s_s.m_timedWheel[time & (TIMED_WHEEL-1)];
+	    for (VpioCbList::iterator it=slot.begin(); it!=slot.end(); ++it) {
+		if (*it) return time;
+	    }
+	}
+    }
+    if (!s_s.m_timedFar.empty()) return s_s.m_timedFar.begin()->first;
+    return ~VL_ULL(0);  // maxquad
+}
 
 VerilatedVpiError* VerilatedVpi::error_info() {
     if (s_s.m_errorInfop == NULL) {
@@ -511,7 +750,7 @@ vpiHandle vpi_handle_by_name(PLI_BYTE8* namep, vpiHandle scope) {
 	// This doesn't yet follow the hierarchy in the proper way
 	scopep = Verilated::scopeFind(namep);
 	if (scopep) {  // Whole thing found as a scope
-	    return (new VerilatedVpioScope(scopep))->castVpiHandle();
+	    return VerilatedVpi::scopeHandle(scopep);
 	}
 	const char* baseNamep = scopeAndName.c_str();
 	string scopename;
@@ -525,7 +764,7 @@ vpiHandle vpi_handle_by_name(PLI_BYTE8* namep, vpiHandle scope) {
 	varp = scopep->varFind(baseNamep);
     }
     if (!varp) return NULL;
-    return (new VerilatedVpioVar(varp, scopep))->castVpiHandle();
+    return VerilatedVpi::varHandle(varp, scopep);
 }
 
 vpiHandle vpi_handle_by_index(vpiHandle object, PLI_INT32 indx) {
@@ -578,12 +817,12 @@ vpiHandle vpi_handle(PLI_INT32 type, vpiHandle object) {
     case vpiScope: {
 	VerilatedVpioVar* vop = VerilatedVpioVar::castp(object);
 	if (VL_UNLIKELY(!vop)) return 0;
-	return (new VerilatedVpioScope(vop->scopep()))->castVpiHandle();
+	return VerilatedVpi::scopeHandle(vop->scopep());
     }
     case vpiParent: {
 	VerilatedVpioMemoryWord* vop = VerilatedVpioMemoryWord::castp(object);
 	if (VL_UNLIKELY(!vop)) return 0;
-	return (new VerilatedVpioVar(vop->varp(), vop->scopep()))->castVpiHandle();
+	return VerilatedVpi::varHandle(vop->varp(), vop->scopep());
     }
     default:
         _VL_VPI_WARNING(__FILE__, __LINE__, "%s: Unsupported type %s, nothing will be returned",
@@ -991,6 +1230,9 @@ vpiHandle vpi_put_value(vpiHandle object, p_vpi_value value_p,
             _VL_VPI_WARNING(__FILE__, __LINE__, "Ignoring vpi_put_value to signal marked read-only, use public_flat_rw instead: ", vop->fullname());
 	    return 0;
 	}
+	if (CData* chgp = vop->varp()->chgp()) {
+	    if (!*chgp) Verilated::vpiChanged(chgp);  // For cbValueChange on this signal
+	}
 	if (value_p->format == vpiVectorVal) {
 	    if (VL_UNLIKELY(!value_p->value.vector)) return NULL;
 	    switch (vop->varp()->vltype()) {
@@ -1244,6 +1486,83 @@ void vpi_put_value_array(vpiHandle object, p_vpi_arrayvalue arrayvalue_p,
 }
 
 
+// batched value processing
+
+int VerilatedVpiBatch::add(vpiHandle object) {
+    VL_DEBUG_IF_PLI(VL_PRINTF("-vltVpi:  VerilatedVpiBatch::add %p\n",object););
+    _VL_VPI_ERROR_RESET(); // reset vpi error status
+    VerilatedVpioVar* vop = VerilatedVpioVar::castp(object);
+    if (VL_UNLIKELY(!vop)) {
+	_VL_VPI_ERROR(__FILE__, __LINE__, "%s: Unsupported vpiHandle (%p)", VL_FUNC, object);
+	return -1;
+    }
+    Signal sig;
+    sig.m_datap = vop->varDatap();
+    sig.m_chgp = vop->varp()->chgp();
+    sig.m_offset = m_words;
+    sig.m_vltype = vop->varp()->vltype();
+    sig.m_rw = vop->varp()->isPublicRW();
+    int bits = vop->varp()->range().elements();
+    switch (sig.m_vltype) {
+    case VLVT_UINT8:
+    case VLVT_UINT16:
+    case VLVT_UINT32: sig.m_words = 1; break;
+    case VLVT_UINT64: sig.m_words = 2; break;
+    case VLVT_WDATA: sig.m_words = VL_WORDS_I(bits); break;
+    default:
+	_VL_VPI_ERROR(__FILE__, __LINE__, "%s: Unsupported variable type for %s",
+		      VL_FUNC, vop->fullname());
+	return -1;
+    }
+    int topBits = bits - (sig.m_words-1)*VL_WORDSIZE;
+    sig.m_mask = (topBits > 0 && topBits < VL_WORDSIZE) ? VL_MASK_I(topBits) : ~VL_UL(0);
+    m_signals.push_back(sig);
+    m_words += sig.m_words;
+    return sig.m_offset;
+}
+
+void VerilatedVpiBatch::get(vluint32_t* wordsp) const {
+    for (vector<Signal>::const_iterator it = m_signals.begin(); it != m_signals.end(); ++it) {
+	vluint32_t* op = wordsp + it->m_offset;
+	switch (it->m_vltype) {
+	case VLVT_UINT8:  *op = *((CData*)(it->m_datap)); break;
+	case VLVT_UINT16: *op = *((SData*)(it->m_datap)); break;
+	case VLVT_UINT32: *op = *((IData*)(it->m_datap)); break;
+	case VLVT_UINT64: {
+	    QData data = *((QData*)(it->m_datap));
+	    op[0] = (IData)data;
+	    op[1] = (IData)(data >> VL_ULL(32));
+	    break;
+	}
+	default:  // VLVT_WDATA
+	    memcpy(op, it->m_datap, it->m_words * sizeof(IData));
+	    break;
+	}
+    }
+}
+
+void VerilatedVpiBatch::put(const vluint32_t* wordsp) {
+    for (vector<Signal>::iterator it = m_signals.begin(); it != m_signals.end(); ++it) {
+	if (VL_UNLIKELY(!it->m_rw)) continue;
+	const vluint32_t* ip = wordsp + it->m_offset;
+	switch (it->m_vltype) {
+	case VLVT_UINT8:  *((CData*)(it->m_datap)) = ip[0] & it->m_mask; break;
+	case VLVT_UINT16: *((SData*)(it->m_datap)) = ip[0] & it->m_mask; break;
+	case VLVT_UINT32: *((IData*)(it->m_datap)) = ip[0] & it->m_mask; break;
+	case VLVT_UINT64:
+	    *((QData*)(it->m_datap)) = ((QData)(ip[1] & it->m_mask) << VL_ULL(32)) | ip[0];
+	    break;
+	default: {  // VLVT_WDATA
+	    IData* datap = (IData*)(it->m_datap);
+	    memcpy(datap, ip, it->m_words * sizeof(IData));
+	    datap[it->m_words-1] &= it->m_mask;
+	    break;
+	}
+	}
+	if (it->m_chgp && !*(it->m_chgp)) Verilated::vpiChanged(it->m_chgp);  // For cbValueChange
+    }
+}
+
 // time processing
 
 void vpi_get_time(vpiHandle object, p_vpi_time time_p) {
@@ -1353,6 +1672,7 @@ PLI_INT32 vpi_release_handle (vpiHandle object) {
     VerilatedVpio* vop = VerilatedVpio::castp(object);
     _VL_VPI_ERROR_RESET(); // reset vpi error status
     if (VL_UNLIKELY(!vop)) return 0;
+    if (vop->cached()) return 1;  // Shared scope or variable handle
     vpi_remove_cb(object);  // May not be a callback, but that's ok
     delete vop;
     return 1;
@@ -32,6 +32,7 @@
 #include <list>
 #include <set>
 #include <map>
+#include <vector>
 
 //======================================================================
 // From IEEE 1800-2009 annex K
@@ -64,38 +65,47 @@
 // Base VPI handled object
 class VerilatedVpio {
     // MEM MANGLEMENT
-    static vluint8_t* s_freeHead;
+    enum { FREE_GRAIN = 16,		// Bytes between size classes
+	   FREE_CLASSES = 16,		// Size classes pooled; larger objects aren't
+	   FREE_BATCH = 64 };		// Objects allocated at once when a class is empty
+    static vluint8_t* s_freeHeads[FREE_CLASSES];
+    static vluint8_t* freeRefill(size_t sclass);
+    // MEMBERS
+    bool		m_cached;	// Shared handle from VerilatedVpi's cache, never freed
 
 public:
     // CONSTRUCTORS
-    VerilatedVpio() {}
+    VerilatedVpio() : m_cached(false) {}
     virtual ~VerilatedVpio() {}
     inline static void* operator new(size_t size) {
-	// We new and delete tons of vpi structures, so keep them around
-	// To simplify our free list, we use a size large enough for all derived types
+	// We new and delete tons of vpi structures, so keep them around,
+	// on a free list for each size class.
 	// We reserve word zero for the next pointer, as that's safer in case a
 	// dangling reference to the original remains around.
-	static size_t chunk = 96;
-	if (VL_UNLIKELY(size>chunk)) vl_fatal(__FILE__,__LINE__,"", "increase chunk");
-	if (VL_LIKELY(s_freeHead)) {
-	    vluint8_t* newp = s_freeHead;
-	    s_freeHead = *((vluint8_t**)newp);
-	    return newp+8;
-	} else {
+	size_t sclass = (size + FREE_GRAIN - 1) / FREE_GRAIN;
+	if (VL_UNLIKELY(sclass >= FREE_CLASSES)) {
 	    // +8: 8 bytes for next
-	    vluint8_t* newp = (vluint8_t*)(::operator new(chunk+8));
-	    return newp+8;
+	    return ((vluint8_t*)(::operator new(size+8)))+8;
 	}
+	vluint8_t* newp = s_freeHeads[sclass];
+	if (VL_UNLIKELY(!newp)) newp = freeRefill(sclass);
+	s_freeHeads[sclass] = *((vluint8_t**)newp);
+	return newp+8;
     }
     inline static void operator delete(void* obj, size_t size) {
+	// Size is of the most derived class, as the destructor is virtual
 	vluint8_t* oldp = ((vluint8_t*)obj)-8;
-	*((void**)oldp) = s_freeHead;
-	s_freeHead = oldp;
+	size_t sclass = (size + FREE_GRAIN - 1) / FREE_GRAIN;
+	if (VL_UNLIKELY(sclass >= FREE_CLASSES)) { ::operator delete(oldp); return; }
+	*((void**)oldp) = s_freeHeads[sclass];
+	s_freeHeads[sclass] = oldp;
     }
     // MEMBERS
     static inline VerilatedVpio* castp(vpiHandle h) { return dynamic_cast<VerilatedVpio*>((VerilatedVpio*)h); }
     inline vpiHandle castVpiHandle() { return (vpiHandle)(this); }
     // ACCESSORS
+    bool cached() const { return m_cached; }
+    void cached(bool flag) { m_cached = flag; }
     virtual const char* name() { return "<null>"; }
     virtual const char* fullname() { return "<null>"; }
     virtual const char* defname() { return "<null>"; }
@@ -108,13 +118,20 @@ public:
 typedef PLI_INT32 (*VerilatedPliCb)(struct t_cb_data *);
 
 class VerilatedVpioCb : public VerilatedVpio {
+public:
+    typedef list<VerilatedVpioCb*>::iterator TimedIt;
+    enum TimedWhere { TIMED_NONE, TIMED_LIST, TIMED_FAR };  // Where a cbAfterDelay is held
+private:
     t_cb_data		m_cbData;
     s_vpi_value		m_value;
     QData		m_time;
+    CData*		m_chgp;		// cbValueChange signal's VL_VPI_CHG flag, when indexed by it
+    TimedWhere		m_timedWhere;	// cbAfterDelay's container in VerilatedVpi
+    TimedIt		m_timedIt;	// cbAfterDelay's entry, when TIMED_LIST
 public:
     // cppcheck-suppress uninitVar  // m_value
     VerilatedVpioCb(const t_cb_data* cbDatap, QData time)
-	: m_cbData(*cbDatap), m_time(time) {
+	: m_cbData(*cbDatap), m_time(time), m_chgp(NULL), m_timedWhere(TIMED_NONE) {
         m_value.format = cbDatap->value ? cbDatap->value->format : vpiSuppressVal;
 	m_cbData.value = &m_value;
     }
@@ -125,6 +142,12 @@ public:
     VerilatedPliCb cb_rtnp() const { return m_cbData.cb_rtn; }
     t_cb_data* cb_datap() { return &(m_cbData); }
     QData time() const { return m_time; }
+    CData* chgp() const { return m_chgp; }
+    void chgp(CData* flagp) { m_chgp = flagp; }
+    TimedWhere timedWhere() const { return m_timedWhere; }
+    TimedIt timedIt() const { return m_timedIt; }
+    void timedWhere(TimedWhere where) { m_timedWhere = where; }
+    void timedWhere(TimedWhere where, TimedIt it) { m_timedWhere = where; m_timedIt = it; }
 };
 
 class VerilatedVpioConst : public VerilatedVpio {
@@ -260,19 +283,7 @@ public:
     virtual ~VerilatedVpioVarIter() {}
     static inline VerilatedVpioVarIter* castp(vpiHandle h) { return dynamic_cast<VerilatedVpioVarIter*>((VerilatedVpio*)h); }
     virtual vluint32_t type() { return vpiIterator; }
-    virtual vpiHandle dovpi_scan() {
-	if (VL_LIKELY(m_scopep->varsp())) {
-	    VerilatedVarNameMap* varsp = m_scopep->varsp();
-	    if (VL_UNLIKELY(!m_started)) { m_it = varsp->begin(); m_started=true; }
-	    else if (VL_UNLIKELY(m_it == varsp->end())) return 0;
-	    else ++m_it;
-	    if (m_it == varsp->end()) return 0;
-	    return ((new VerilatedVpioVar(&(m_it->second), m_scopep))
-		    ->castVpiHandle());
-	} else {
-	    return 0;  // End of list - only one deep
-	}
-    }
+    virtual vpiHandle dovpi_scan();
 };
 
 class VerilatedVpioMemoryWordIter : public VerilatedVpio {
@@ -309,72 +320,105 @@ struct VerilatedVpiTimedCbsCmp {
     }
 };
 
+//======================================================================
+/// Verilator extension: read or write the raw values of many signals at
+/// once.  add() each signal's handle once, then each get() copies every
+/// signal into one array of words, without per-signal format conversion.
+/// Each signal takes VL_WORDS_I(width) words, least significant first.
+
+class VerilatedVpiBatch {
+    struct Signal {
+	void*		m_datap;	// Signal's data
+	CData*		m_chgp;		// Signal's VL_VPI_CHG flag, or NULL
+	vluint32_t	m_offset;	// First word in get()/put() arrays
+	vluint32_t	m_words;	// Words of this signal
+	IData		m_mask;		// Valid bits of most significant word
+	VerilatedVarType m_vltype;
+	bool		m_rw;		// Writable by put()
+    };
+    vector<Signal>	m_signals;
+    vluint32_t		m_words;	// Total words
+public:
+    VerilatedVpiBatch() : m_words(0) {}
+    ~VerilatedVpiBatch() {}
+    /// Add a signal, returning the offset of its first word, or -1 if unsupported
+    int add(vpiHandle object);
+    size_t size() const { return m_signals.size(); }	///< Signals added
+    vluint32_t words() const { return m_words; }	///< Size of get()/put() arrays
+    void get(vluint32_t* wordsp) const;	///< Read every signal into wordsp[0..words())
+    void put(const vluint32_t* wordsp);	///< Write every public_flat_rw signal from wordsp
+};
+
+//======================================================================
+
 class VerilatedVpiError;
 
 class VerilatedVpi {
     enum { CB_ENUM_MAX_VALUE = cbAtEndOfSimTime+1 };	// Maxium callback reason
+    enum { TIMED_WHEEL = 256 };	// Times ahead held in the timing wheel, power of two
     typedef list<VerilatedVpioCb*> VpioCbList;
     typedef set<pair<QData,VerilatedVpioCb*>,VerilatedVpiTimedCbsCmp > VpioTimedCbs;
+    typedef map<const CData*,VpioCbList> VpioChgCbs;
+    typedef map<const VerilatedScope*,VerilatedVpioScope*> VpioScopeHandles;
+    typedef map<pair<const VerilatedScope*,const VerilatedVar*>,VerilatedVpioVar*> VpioVarHandles;
 
     struct product_info {
 	PLI_BYTE8* product;
     };
 
     VpioCbList		m_cbObjLists[CB_ENUM_MAX_VALUE];	// Callbacks for each supported reason
-    VpioTimedCbs	m_timedCbs;	// Time based callbacks
+    // Time based callbacks: near ones by time in a wheel of lists, far ones
+    // ordered, and ones past due, which are called until removed
+    VpioCbList		m_timedWheel[TIMED_WHEEL];	// Slot for each time from m_wheelTime
+    QData		m_wheelTime;	// Earliest time not yet moved to m_timedDue
+    size_t		m_wheelEntries;	// Entries in m_timedWheel, including removed ones
+    VpioTimedCbs	m_timedFar;	// Callbacks at or after m_wheelTime+TIMED_WHEEL
+    VpioCbList		m_timedDue;	// Callbacks past due, in time order
+    VpioChgCbs		m_chgCbs;	// cbValueChange callbacks, by signal's VL_VPI_CHG flag
+    vector<CData*>	m_changed;	// VL_VPI_CHG flags set since last callValueCbs
     VerilatedVpiError*  m_errorInfop;	// Container for vpi error info
+    VpioScopeHandles	m_scopeHandles;	// Shared handle for each scope
+    VpioVarHandles	m_varHandles;	// Shared handle for each whole variable
 
     static VerilatedVpi s_s;		// Singleton
 
 public:
-    VerilatedVpi() { m_errorInfop=NULL; }
+    VerilatedVpi() { m_errorInfop=NULL; m_wheelTime=0; m_wheelEntries=0; }
     ~VerilatedVpi() {}
     static void cbReasonAdd(VerilatedVpioCb* vop) {
 	if (vop->reason() == cbValueChange) {
 	    if (VerilatedVpioVar* varop = VerilatedVpioVar::castp(vop->cb_datap()->obj)) {
 		varop->createPrevDatap();
+		if (CData* chgp = varop->varp()->chgp()) {
+		    // Model marks writes to this signal, so only check it when written
+		    VpioCbList& cbObjList = s_s.m_chgCbs[chgp];
+		    bool watched = false;
+		    for (VpioCbList::iterator it=cbObjList.begin(); it!=cbObjList.end(); ++it) {
+			if (*it) watched = true;
+		    }
+		    if (!watched) *chgp = 0;  // Unwatched flags are left set, so rearm
+		    vop->chgp(chgp);
+		    cbObjList.push_back(vop);
+		    return;
+		}
 	    }
 	}
 	if (VL_UNLIKELY(vop->reason() >= CB_ENUM_MAX_VALUE)) vl_fatal(__FILE__,__LINE__,"", "vpi bb reason too large");
 	s_s.m_cbObjLists[vop->reason()].push_back(vop);
     }
-    static void cbTimedAdd(VerilatedVpioCb* vop) {
-	s_s.m_timedCbs.insert(make_pair(vop->time(), vop));
-    }
+    static void cbTimedAdd(VerilatedVpioCb* vop);
     static void cbReasonRemove(VerilatedVpioCb* cbp) {
-	VpioCbList& cbObjList = s_s.m_cbObjLists[cbp->reason()];
+	VpioCbList& cbObjList = (cbp->chgp() ? s_s.m_chgCbs[cbp->chgp()]
+				 : s_s.m_cbObjLists[cbp->reason()]);
 	// We do not remove it now as we may be iterating the list,
 	// instead set to NULL and will cleanup later
 	for (VpioCbList::iterator it=cbObjList.begin(); it!=cbObjList.end(); ++it) {
             if (*it == cbp) *it = NULL;
 	}
     }
-    static void cbTimedRemove(VerilatedVpioCb* cbp) {
-	VpioTimedCbs::iterator it=s_s.m_timedCbs.find(make_pair(cbp->time(),cbp));
-	if (VL_LIKELY(it != s_s.m_timedCbs.end())) {
-	    s_s.m_timedCbs.erase(it);
-	}
-    }
-    static void callTimedCbs() {
-	QData time = VL_TIME_Q();
-	for (VpioTimedCbs::iterator it=s_s.m_timedCbs.begin(); it!=s_s.m_timedCbs.end(); ) {
-	    if (VL_UNLIKELY(it->first <= time)) {
-		VerilatedVpioCb* vop = it->second;
-		++it;  // iterator may be deleted by callback
-		VL_DEBUG_IF_PLI(VL_PRINTF("-vltVpi:  timed_callback %p\n",vop););
-		(vop->cb_rtnp()) (vop->cb_datap());
-	    }
-	    else { ++it; }
-	}
-    }
-    static QData cbNextDeadline() {
-	VpioTimedCbs::iterator it=s_s.m_timedCbs.begin();
-	if (VL_LIKELY(it!=s_s.m_timedCbs.end())) {
-	    return it->first;
-	} else {
-	    return ~VL_ULL(0);  // maxquad
-	}
-    }
+    static void cbTimedRemove(VerilatedVpioCb* cbp);
+    static void callTimedCbs();
+    static QData cbNextDeadline();
     static void callCbs(vluint32_t reason) {
 	VpioCbList& cbObjList = s_s.m_cbObjLists[reason];
 	for (VpioCbList::iterator it=cbObjList.begin(); it!=cbObjList.end();) {
@@ -387,34 +431,21 @@ public:
 	    (vop->cb_rtnp()) (vop->cb_datap());
 	}
     }
-    static void callValueCbs() {
-	VpioCbList& cbObjList = s_s.m_cbObjLists[cbValueChange];
-        set<VerilatedVpioVar*> update; // set of objects to update after callbacks
-	for (VpioCbList::iterator it=cbObjList.begin(); it!=cbObjList.end();) {
-	    if (VL_UNLIKELY(!*it)) { // Deleted earlier, cleanup
-		it = cbObjList.erase(it);
-		continue;
-	    }
-	    VerilatedVpioCb* vop = *it++;
-	    if (VerilatedVpioVar* varop = VerilatedVpioVar::castp(vop->cb_datap()->obj)) {
-		void* newDatap = varop->varDatap();
-		void* prevDatap = varop->prevDatap();  // Was malloced when we added the callback
-		VL_DEBUG_IF_PLI(VL_PRINTF("-vltVpi:  value_test %s v[0]=%d/%d %p %p\n",
-					  varop->fullname(), *((CData*)newDatap), *((CData*)prevDatap),
-					  newDatap, prevDatap););
-		if (memcmp(prevDatap, newDatap, varop->entSize())) {
-		    VL_DEBUG_IF_PLI(VL_PRINTF("-vltVpi:  value_callback %p %s v[0]=%d\n",
-					      vop,varop->fullname(), *((CData*)newDatap)););
-                    update.insert(varop);
-		    vpi_get_value(vop->cb_datap()->obj, vop->cb_datap()->value);
-		    (vop->cb_rtnp()) (vop->cb_datap());
-		}
-	    }
-	}
-	for (set<VerilatedVpioVar*>::iterator it=update.begin(); it!=update.end(); ++it) {
-	    memcpy((*it)->prevDatap(), (*it)->varDatap(), (*it)->entSize());
-	}
-    }
+    static void callValueCbs();
+    static void changed(CData* chgp);  // Called by Verilated::vpiChanged
+    // Scopes and variables don't change, so each has one handle, made on
+    // first lookup, that vpi_release_handle leaves in place
+    static vpiHandle scopeHandle(const VerilatedScope* scopep);
+    static vpiHandle varHandle(const VerilatedVar* varp, const VerilatedScope* scopep);
+private:
+    static void callValueCbList(VpioCbList& cbObjList, set<VerilatedVpioVar*>& update);
+    static void timedWheelPut(VerilatedVpioCb* vop);
+    static void timedFarToWheel();
+    static void timedRewind();
+    static void timedAdvance(QData time);
+    /// Time went back since the wheel advanced, so callbacks are misplaced
+    static bool timedRewound(QData time) { return time + 1 < s_s.m_wheelTime; }
+public:
 
     static VerilatedVpiError* error_info(); // getter for vpi error info
 };
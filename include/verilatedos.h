@@ -72,6 +72,25 @@
 # define VL_PREFETCH_RW(p)		///< Prefetch data with read/write intent
 #endif
 
+// Hot and cold code placement, used on Verilated functions.  GCC groups these
+// into .text.hot and .text.unlikely, so the per-cycle code stays contiguous.
+// May be predefined, e.g. to add a section() for a custom linker script.
+#if defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 3))
+# ifndef VL_ATTR_COLD
+#  define VL_ATTR_COLD __attribute__ ((cold))
+# endif
+# ifndef VL_ATTR_HOT
+#  define VL_ATTR_HOT __attribute__ ((hot))
+# endif
+#else
+# ifndef VL_ATTR_COLD
+#  define VL_ATTR_COLD			///< Function rarely called, e.g. initialization
+# endif
+# ifndef VL_ATTR_HOT
+#  define VL_ATTR_HOT			///< Function called every evaluation
+# endif
+#endif
+
 #ifdef VL_THREADED
 # ifdef __GNUC__
 #  define VL_THREAD	__thread	///< Storage class for thread-local storage
@@ -106,6 +125,7 @@
 
 #if __cplusplus >= 201103L || defined(__GXX_EXPERIMENTAL_CXX0X__)
 # define VL_HAS_UNIQUE_PTR
+# define VL_HAS_MOVE		///< Rvalue references and move construction
 # define VL_UNIQUE_PTR unique_ptr
 #else
 # define VL_UNIQUE_PTR auto_ptr
@@ -199,6 +219,12 @@ typedef unsigned long long	vluint64_t;	///< 64-bit unsigned type
 # endif
 #endif
 
+// 128-bit type, for 64x64->128 multiplies and divides, where the compiler has one
+#if defined(__SIZEOF_INT128__) && !defined(VL_NO_INT128)
+# define VL_HAVE_INT128 1
+__extension__ typedef unsigned __int128 vluint128_t;	///< 128-bit unsigned type
+#endif
+
 //=========================================================================
 // Printing printf/scanf formats
 // Alas cinttypes isn't that standard yet
@@ -234,6 +260,17 @@ typedef unsigned long long	vluint64_t;	///< 64-bit unsigned type
 # define VL_DEV_NULL "/dev/null"
 #endif
 
+// Character reads inside VL_FLOCKFILE/VL_FUNLOCKFILE skip stdio's per-call lock
+#ifdef _WIN32
+# define VL_FLOCKFILE(fp)
+# define VL_FUNLOCKFILE(fp)
+# define VL_GETC_UNLOCKED(fp) getc(fp)
+#else // Linux or compliant Unix flavors
+# define VL_FLOCKFILE(fp) flockfile(fp)
+# define VL_FUNLOCKFILE(fp) funlockfile(fp)
+# define VL_GETC_UNLOCKED(fp) getc_unlocked(fp)
+#endif
+
 //=========================================================================
 // Integer size macros
 
@@ -282,6 +319,38 @@ typedef unsigned long long	vluint64_t;	///< 64-bit unsigned type
 # define VL_ROUND(n) round(n)
 #endif
 
+//=========================================================================
+// Locking
+
+#ifdef VL_THREADED
+# include <mutex>
+/// Mutex protecting runtime tables that models on several threads share
+class VerilatedMutex {
+    std::mutex		m_mutex;	///< Mutex
+public:
+    void lock() { m_mutex.lock(); }
+    void unlock() { m_mutex.unlock(); }
+};
+#else
+/// Mutex protecting runtime tables; does nothing without VL_THREADED
+class VerilatedMutex {
+public:
+    void lock() {}
+    void unlock() {}
+};
+#endif
+
+/// Lock a VerilatedMutex until the end of the scope
+class VerilatedLockGuard {
+    VerilatedMutex&	m_mutexr;	///< Mutex held
+private:
+    VerilatedLockGuard(const VerilatedLockGuard&);	///< N/A, no copy constructor
+    VerilatedLockGuard& operator=(const VerilatedLockGuard&);	///< N/A, no assignment
+public:
+    explicit VerilatedLockGuard(VerilatedMutex& mutexr) : m_mutexr(mutexr) { m_mutexr.lock(); }
+    ~VerilatedLockGuard() { m_mutexr.unlock(); }
+};
+
 //=========================================================================
 
 #endif /*guard*/
@@ -25,6 +25,12 @@
 //	    Find SenTree in under global TopScope, or create it there
 //	    Move SenTree the global SenTree
 //
+// V3ActiveTop's merge transformations, after V3Order:
+//   For each clocked ACTIVE under the top scope or an UNTILSTABLE
+//	Look back for an ACTIVE with the same SenTree
+//	If no ACTIVE in between accesses what it writes, or writes what it accesses
+//	    Move it after that ACTIVE, so V3Clock tests the sensitivity once
+//
 //*************************************************************************
 
 #include "config_build.h"
@@ -33,6 +39,8 @@
 #include <cstdarg>
 #include <unistd.h>
 #include <algorithm>
+#include <map>
+#include <set>
 #include <vector>
 
 #include "V3Global.h"
@@ -40,6 +48,7 @@
 #include "V3Ast.h"
 #include "V3SenTree.h"
 #include "V3Const.h"
+#include "V3Stats.h"
 
 //######################################################################
 // Active class functions
@@ -154,6 +163,147 @@ public:
     virtual ~ActiveTopVisitor() {}
 };
 
+//######################################################################
+// Merge ordered actives, as a visitor of each AstNode
+
+class ActiveMergeAccessVisitor : public AstNVisitor {
+private:
+    // STATE
+    set<AstVarScope*>	m_readps;	// Variables read
+    set<AstVarScope*>	m_writeps;	// Variables written
+    set<AstCFunc*>	m_funcps;	// Functions already visited
+    bool		m_impure;	// Has side effects that must stay ordered
+    // VISITORS
+    virtual void visit(AstVarRef* nodep) {
+	if (!nodep->varScopep()) return;
+	if (nodep->lvalue()) m_writeps.insert(nodep->varScopep());
+	else m_readps.insert(nodep->varScopep());
+    }
+    virtual void visit(AstCCall* nodep) {
+	nodep->iterateChildren(*this);
+	if (nodep->funcp() && m_funcps.insert(nodep->funcp()).second) {
+	    if (nodep->funcp()->dpiImport()) m_impure = true;
+	    nodep->funcp()->accept(*this);
+	}
+    }
+    virtual void visit(AstNode* nodep) {
+	if (!nodep->isPure() || nodep->isOutputter()
+	    || nodep->castCStmt() || nodep->castCMath() || nodep->castUCStmt() || nodep->castUCFunc()) {
+	    m_impure = true;
+	}
+	nodep->iterateChildren(*this);
+    }
+public:
+    // CONSTUCTORS
+    explicit ActiveMergeAccessVisitor(AstActive* nodep) {
+	m_impure = false;
+	nodep->sensesp()->accept(*this);  // The sensitivity test reads these where the active is
+	nodep->iterateChildren(*this);
+    }
+    virtual ~ActiveMergeAccessVisitor() {}
+    // METHODS
+    static bool intersects(const set<AstVarScope*>& ap, const set<AstVarScope*>& bp) {
+	for (set<AstVarScope*>::const_iterator it = ap.begin(); it != ap.end(); ++it) {
+	    if (bp.find(*it) != bp.end()) return true;
+	}
+	return false;
+    }
+    bool conflicts(const ActiveMergeAccessVisitor& other) const {
+	return ((m_impure && other.m_impure)
+		|| intersects(m_writeps, other.m_readps)
+		|| intersects(m_writeps, other.m_writeps)
+		|| intersects(m_readps, other.m_writeps));
+    }
+};
+
+class ActiveMergeVisitor : public AstNVisitor {
+private:
+    // TYPES
+    enum { MERGE_SCAN = 32 };	// How many actives to look back past, bounding compile time
+    typedef map<AstActive*,ActiveMergeAccessVisitor*> AccessMap;
+
+    // STATE
+    AccessMap		m_accesses;	// Variables each active accesses, made when needed
+    V3Double0		m_statMerged;	// Statistic tracking
+
+    // METHODS
+    static int debug() {
+	static int level = -1;
+	if (VL_UNLIKELY(level < 0)) level = v3Global.opt.debugSrcLevel(__FILE__);
+	return level;
+    }
+
+    const ActiveMergeAccessVisitor& access(AstActive* nodep) {
+	AccessMap::iterator it = m_accesses.find(nodep);
+	if (it != m_accesses.end()) return *(it->second);
+	ActiveMergeAccessVisitor* accessp = new ActiveMergeAccessVisitor(nodep);
+	m_accesses.insert(make_pair(nodep, accessp));
+	return *accessp;
+    }
+    void mergeList(AstNode* listp) {
+	// Actives evaluated in sequence, as V3Clock will place them in _eval or a loop
+	vector<AstActive*> seq;
+	for (AstNode* nodep = listp; nodep; nodep = nodep->nextp()) {
+	    if (nodep->castCFunc()) continue;  // Not evaluated here
+	    AstActive* activep = nodep->castActive();
+	    if (!activep) {
+		// Barrier, such as an UNTILSTABLE loop
+		mergeSeq(seq);
+		seq.clear();
+		nodep->accept(*this);
+		continue;
+	    }
+	    if (activep->hasInitial() || activep->hasSettle()) continue;  // Evaluated elsewhere
+	    seq.push_back(activep);
+	}
+	mergeSeq(seq);
+    }
+    void mergeSeq(vector<AstActive*>& seq) {
+	for (size_t j = 1; j < seq.size(); ++j) {
+	    AstActive* activep = seq[j];
+	    if (!activep->hasClocked()) continue;
+	    if (seq[j-1]->sensesp()->sameTree(activep->sensesp())) continue;  // Already adjacent
+	    size_t lowest = (j > MERGE_SCAN) ? j - MERGE_SCAN : 0;
+	    for (size_t i = j - 1; i-- > lowest; ) {
+		if (access(seq[i+1]).conflicts(access(activep))) break;
+		if (seq[i]->sensesp()->sameTree(activep->sensesp())) {
+		    UINFO(4,"  Merge active "<<activep<<" after "<<seq[i]<<endl);
+		    seq[i]->addNextHere(activep->unlinkFrBack());
+		    seq.erase(seq.begin() + j);
+		    seq.insert(seq.begin() + i + 1, activep);
+		    ++m_statMerged;
+		    break;
+		}
+	    }
+	}
+    }
+
+    // VISITORS
+    virtual void visit(AstTopScope* nodep) {
+	mergeList(nodep->scopep()->blocksp());
+    }
+    virtual void visit(AstUntilStable* nodep) {
+	mergeList(nodep->bodysp());
+    }
+    virtual void visit(AstNodeStmt*) {}	// Accelerate
+    virtual void visit(AstNodeMath*) {}	// Accelerate
+    virtual void visit(AstNode* nodep) {
+	nodep->iterateChildren(*this);
+    }
+
+public:
+    // CONSTUCTORS
+    explicit ActiveMergeVisitor(AstNetlist* nodep) {
+	nodep->accept(*this);
+    }
+    virtual ~ActiveMergeVisitor() {
+	for (AccessMap::iterator it = m_accesses.begin(); it != m_accesses.end(); ++it) {
+	    delete it->second;
+	}
+	V3Stats::addStat("Optimizations, Actives merged", m_statMerged);
+    }
+};
+
 //######################################################################
 // Active class functions
 
@@ -162,3 +312,9 @@ void V3ActiveTop::activeTopAll(AstNetlist* nodep) {
     ActiveTopVisitor visitor (nodep);
     V3Global::dumpCheckGlobalTree("activetop.tree", 0, v3Global.opt.dumpTreeLevel(__FILE__) >= 3);
 }
+
+void V3ActiveTop::mergeAll(AstNetlist* nodep) {
+    UINFO(2,__FUNCTION__<<": "<<endl);
+    ActiveMergeVisitor visitor (nodep);
+    V3Global::dumpCheckGlobalTree("activemerge.tree", 0, v3Global.opt.dumpTreeLevel(__FILE__) >= 3);
+}
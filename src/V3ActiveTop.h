@@ -30,6 +30,7 @@
 class V3ActiveTop {
 public:
     static void activeTopAll(AstNetlist* nodep);
+    static void mergeAll(AstNetlist* nodep);
 };
 
 #endif // Guard
@@ -73,29 +73,36 @@ private:
 	}
     }
 
+    AstNode* newAssertOn(FileLine* fl) {
+	// If assertions are off, have constant propagation rip them out later
+	// This allows syntax errors and such to be detected normally.
+	return (v3Global.opt.assertOn()
+		? (AstNode*)(new AstCMath(fl, "Verilated::assertOn()", 1))
+		: (AstNode*)(new AstConst(fl, AstConst::LogicFalse())));
+    }
     AstNode* newIfAssertOn(AstNode* nodep) {
 	// Add a internal if to check assertions are on.
 	// Don't make this a AND term, as it's unlikely to need to test this.
-	AstNode* newp
-	    = new AstIf (nodep->fileline(),
-			 // If assertions are off, have constant propagation rip them out later
-			 // This allows syntax errors and such to be detected normally.
-			 (v3Global.opt.assertOn()
-			  ? (AstNode*)(new AstCMath(nodep->fileline(), "Verilated::assertOn()", 1))
-			  : (AstNode*)(new AstConst(nodep->fileline(), AstConst::LogicFalse()))),
-			 nodep, NULL);
+	AstNode* newp = new AstIf (nodep->fileline(), newAssertOn(nodep->fileline()), nodep, NULL);
 	newp->user1(true); // Don't assert/cover this if
 	return newp;
     }
+    AstNode* newAssertOnAnd(AstNode* checkp) {
+	// Assertions on, and the failure check.  With assertions turned off at
+	// runtime, the check itself, often a wide one-hot test, is then skipped.
+	return new AstLogAnd (checkp->fileline(), newAssertOn(checkp->fileline()), checkp);
+    }
 
-    AstNode* newFireAssert(AstNode* nodep, const string& message) {
+    AstNode* newFireAssertBody(AstNode* nodep, const string& message) {
 	AstDisplay* dispp = new AstDisplay (nodep->fileline(), AstDisplayType::DT_ERROR, message, NULL, NULL);
 	AstNode* bodysp = dispp;
 	replaceDisplay(dispp, "%%Error");   // Convert to standard DISPLAY format
 	bodysp->addNext(new AstStop (nodep->fileline()));
-	bodysp = newIfAssertOn(bodysp);
 	return bodysp;
     }
+    AstNode* newFireAssert(AstNode* nodep, const string& message) {
+	return newIfAssertOn(newFireAssertBody(nodep, message));
+    }
 
     void newPslAssertion(AstNode* nodep, AstNode* propp, AstSenTree* sentreep,
 			 AstNode* stmtsp, const string& message) {
@@ -208,8 +215,8 @@ private:
 			     ? static_cast<AstNode*>(new AstOneHot0(nodep->fileline(), propp))
 			     : static_cast<AstNode*>(new AstOneHot (nodep->fileline(), propp)));
 	    AstIf* checkifp = new AstIf (nodep->fileline(),
-					 new AstLogNot (nodep->fileline(), ohot),
-					 newFireAssert(nodep, "'unique if' statement violated"),
+					 newAssertOnAnd(new AstLogNot (nodep->fileline(), ohot)),
+					 newFireAssertBody(nodep, "'unique if' statement violated"),
 					 newifp);
 	    checkifp->branchPred(AstBranchPred::BP_UNLIKELY);
 	    nodep->replaceWith(checkifp);
@@ -264,8 +271,8 @@ private:
 				     ? static_cast<AstNode*>(new AstOneHot0(nodep->fileline(), propp))
 				     : static_cast<AstNode*>(new AstOneHot (nodep->fileline(), propp)));
 		    AstIf* ifp = new AstIf (nodep->fileline(),
-					    new AstLogNot (nodep->fileline(), ohot),
-					    newFireAssert(nodep, "synthesis parallel_case, but multiple matches found"),
+					    newAssertOnAnd(new AstLogNot (nodep->fileline(), ohot)),
+					    newFireAssertBody(nodep, "synthesis parallel_case, but multiple matches found"),
 					    NULL);
 		    ifp->branchPred(AstBranchPred::BP_UNLIKELY);
 		    nodep->addNotParallelp(ifp);
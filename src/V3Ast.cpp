@@ -27,6 +27,7 @@
 #include "V3Ast.h"
 #include "V3File.h"
 #include "V3Global.h"
+#include "V3AstBinary.h"
 #include "V3Broken.h"
 #include "V3String.h"
 
@@ -52,6 +53,15 @@ bool AstUser3InUse::s_userBusy=false;
 bool AstUser4InUse::s_userBusy=false;
 bool AstUser5InUse::s_userBusy=false;
 
+AstUserTable AstUser1InUse::s_table;
+AstUserTable AstUser2InUse::s_table;
+AstUserTable AstUser3InUse::s_table;
+AstUserTable AstUser4InUse::s_table;
+AstUserTable AstUser5InUse::s_table;
+
+uint32_t AstNodeUserIndex::s_nextIndex=0;
+vector<uint32_t> AstNodeUserIndex::s_freeIndexes;
+
 int AstNodeDType::s_uniqueNum = 0;
 
 
@@ -60,6 +70,45 @@ int AstNodeDType::s_uniqueNum = 0;
 
 ostream& operator<<(ostream& os, AstType rhs);
 
+//######################################################################
+// User data tables
+
+void AstUserTable::grow(uint32_t index) {
+    // Grow geometrically, so setting nodes in index order is linear
+    size_t newSize = max(max((size_t)index + 1, m_entries.size() * 2), (size_t)1024);
+    Entry zero;  zero.m_u = VNUser(0);  zero.m_cnt = 0;
+    m_entries.resize(newSize, zero);
+}
+
+uint32_t AstNodeUserIndex::allocIndex() {
+    if (!s_freeIndexes.empty()) {
+	uint32_t index = s_freeIndexes.back();
+	s_freeIndexes.pop_back();
+	return index;
+    }
+    UASSERT_STATIC(s_nextIndex != 0xffffffffU, "AstNode user index overflowed!");
+    return s_nextIndex++;
+}
+
+AstNodeUserIndex::AstNodeUserIndex(const AstNodeUserIndex& other) {
+    m_index = allocIndex();
+    AstUser1InUse::s_table.copy(other.m_index, m_index);
+    AstUser2InUse::s_table.copy(other.m_index, m_index);
+    AstUser3InUse::s_table.copy(other.m_index, m_index);
+    AstUser4InUse::s_table.copy(other.m_index, m_index);
+    AstUser5InUse::s_table.copy(other.m_index, m_index);
+}
+
+AstNodeUserIndex::~AstNodeUserIndex() {
+    // A later node with this index must not see our data
+    AstUser1InUse::s_table.reset(m_index);
+    AstUser2InUse::s_table.reset(m_index);
+    AstUser3InUse::s_table.reset(m_index);
+    AstUser4InUse::s_table.reset(m_index);
+    AstUser5InUse::s_table.reset(m_index);
+    s_freeIndexes.push_back(m_index);
+}
+
 //######################################################################
 // Creators
 
@@ -80,16 +129,6 @@ void AstNode::init() {
     // Attributes
     m_didWidth = false;
     m_doingWidth = false;
-    m_user1u = VNUser(0);
-    m_user1Cnt = 0;
-    m_user2u = VNUser(0);
-    m_user2Cnt = 0;
-    m_user3u = VNUser(0);
-    m_user3Cnt = 0;
-    m_user4u = VNUser(0);
-    m_user4Cnt = 0;
-    m_user5u = VNUser(0);
-    m_user5Cnt = 0;
 }
 
 string AstNode::encodeName(const string& namein) {
@@ -433,6 +472,7 @@ AstNode* AstNode::unlinkFrBackWithNext(AstNRelinker* linkerp) {
     UASSERT(oldp->m_backp,"Node has no back, already unlinked?\n");
     oldp->editCountInc();
     AstNode* backp = oldp->m_backp;
+    backp->editCountInc();  // So editedSince() on the parent sees the removal
     if (linkerp) {
 	linkerp->m_oldp = oldp;
 	linkerp->m_backp  = backp;
@@ -481,6 +521,7 @@ AstNode* AstNode::unlinkFrBack(AstNRelinker* linkerp) {
     UASSERT(oldp->m_backp,"Node has no back, already unlinked?\n");
     oldp->editCountInc();
     AstNode* backp = oldp->m_backp;
+    backp->editCountInc();  // So editedSince() on the parent sees the removal
     if (linkerp) {
 	linkerp->m_oldp = oldp;
 	linkerp->m_backp  = backp;
@@ -727,6 +768,63 @@ void AstNode::operator delete(void* objp, size_t size) {
     V3Broken::deleted(nodep);
     ::operator delete(objp);
 }
+#else
+
+//######################################################################
+// Node allocator
+
+// Passes create and delete small nodes by the million as they rewrite the
+// tree.  Rather than using the general heap for each, carve nodes out of
+// large chunks, and recycle deleted nodes through a freelist per size class;
+// this is faster and doesn't fragment memory.  Chunks are never returned,
+// the netlist lives until exit (and the final tree isn't deleted either,
+// except with VL_LEAK_CHECKS where the plain heap is used for checking).
+struct AstNodeArena {
+    enum { ALIGN = 8,			// Alignment and size class granularity
+	   MAX_SIZE = 512,		// Larger objects use the general heap
+	   CHUNK_SIZE = 1024*1024 };	// Bytes allocated at once
+    struct FreeBlock { FreeBlock* m_nextp; };
+    // MEMBERS - zero initialized, as nodes may be made during static construction
+    FreeBlock*	m_freeps[MAX_SIZE/ALIGN + 1];	// Freelist for each size class
+    char*	m_chunkp;	// Unused part of current chunk
+    size_t	m_chunkLeft;	// Bytes left in current chunk
+    // METHODS
+    void* alloc(size_t size) {
+	if (VL_UNLIKELY(size > MAX_SIZE)) return ::operator new(size);
+	size_t cls = (size + ALIGN - 1) / ALIGN;
+	if (FreeBlock* blockp = m_freeps[cls]) {
+	    m_freeps[cls] = blockp->m_nextp;
+	    return blockp;
+	}
+	size_t bytes = cls * ALIGN;
+	if (VL_UNLIKELY(m_chunkLeft < bytes)) {
+	    // Remainder of the old chunk is abandoned; it's under MAX_SIZE
+	    m_chunkp = static_cast<char*>(::operator new(CHUNK_SIZE));
+	    m_chunkLeft = CHUNK_SIZE;
+	}
+	void* objp = m_chunkp;
+	m_chunkp += bytes;
+	m_chunkLeft -= bytes;
+	return objp;
+    }
+    void free(void* objp, size_t size) {
+	if (VL_UNLIKELY(size > MAX_SIZE)) { ::operator delete(objp); return; }
+	size_t cls = (size + ALIGN - 1) / ALIGN;
+	FreeBlock* blockp = static_cast<FreeBlock*>(objp);
+	blockp->m_nextp = m_freeps[cls];
+	m_freeps[cls] = blockp;
+    }
+};
+static AstNodeArena s_nodeArena;
+
+void* AstNode::operator new(size_t size) {
+    return s_nodeArena.alloc(size);
+}
+
+void AstNode::operator delete(void* objp, size_t size) {
+    if (!objp) return;
+    s_nodeArena.free(objp, size);
+}
 #endif
 
 //======================================================================
@@ -756,6 +854,44 @@ void AstNode::iterateChildrenConst(AstNVisitor& v) {
     if (m_op4p) m_op4p->iterateAndNextConst(v);
 }
 
+void AstNode::iterateChildrenEdited(AstNVisitor& v, vluint64_t editCnt) {
+    if (m_op1p) m_op1p->iterateAndNextEdited(v, editCnt);
+    if (m_op2p) m_op2p->iterateAndNextEdited(v, editCnt);
+    if (m_op3p) m_op3p->iterateAndNextEdited(v, editCnt);
+    if (m_op4p) m_op4p->iterateAndNextEdited(v, editCnt);
+}
+
+void AstNode::iterateAndNextEdited(AstNVisitor& v, vluint64_t editCnt) {
+    // As with iterateAndNext, but skip nodes where nothing at or below them
+    // changed after editCnt, for incremental visitors such as V3Const
+    AstNode* nodep=this;
+    while (nodep) {
+	if (!nodep->editedSince(editCnt)) {
+	    nodep = nodep->m_nextp;
+	    continue;
+	}
+	AstNode* niterp = nodep;  // This address may get stomped via m_iterpp if the node is edited
+	niterp->m_iterpp = &niterp;
+	niterp->accept(v);
+	if (!niterp) return;  // Perhaps node deleted inside accept
+	niterp->m_iterpp = NULL;
+	if (VL_UNLIKELY(niterp!=nodep)) { // Edited node inside accept
+	    nodep = niterp;
+	} else {  // Unchanged node, just continue loop
+	    nodep = niterp->m_nextp;
+	}
+    }
+}
+
+bool AstNode::editedSince(vluint64_t editCnt) const {
+    if (m_editCount > editCnt) return true;
+    for (const AstNode* nodep=m_op1p; nodep; nodep=nodep->m_nextp) if (nodep->editedSince(editCnt)) return true;
+    for (const AstNode* nodep=m_op2p; nodep; nodep=nodep->m_nextp) if (nodep->editedSince(editCnt)) return true;
+    for (const AstNode* nodep=m_op3p; nodep; nodep=nodep->m_nextp) if (nodep->editedSince(editCnt)) return true;
+    for (const AstNode* nodep=m_op4p; nodep; nodep=nodep->m_nextp) if (nodep->editedSince(editCnt)) return true;
+    return false;
+}
+
 void AstNode::iterateAndNext(AstNVisitor& v) {
     // This is a very hot function
     // IMPORTANT: If you replace a node that's the target of this iterator,
@@ -816,6 +952,29 @@ void AstNode::iterateAndNextConst(AstNVisitor& v) {
     }
 }
 
+void AstNode::iterateFlat(AstNVisitor& v) {
+    // Visit this and everything below it, in the same order as visitors
+    // calling iterateChildren first, but with an explicit stack, so deep
+    // trees can't overflow the C stack, and without the per-node edit
+    // tracking.  For visitors that only look at each node; their visit()
+    // functions must not iterate children or edit the tree.
+    vector<AstNode*> stack;
+    stack.reserve(64);
+    AstNode* nodep = this;
+    while (1) {
+	// Pushed in reverse, so children are done before the next node, op1 first
+	if (nodep != this && nodep->m_nextp) stack.push_back(nodep->m_nextp);
+	if (nodep->m_op4p) stack.push_back(nodep->m_op4p);
+	if (nodep->m_op3p) stack.push_back(nodep->m_op3p);
+	if (nodep->m_op2p) stack.push_back(nodep->m_op2p);
+	if (nodep->m_op1p) stack.push_back(nodep->m_op1p);
+	nodep->accept(v);
+	if (stack.empty()) break;
+	nodep = stack.back(); stack.pop_back();
+	ASTNODE_PREFETCH(nodep->m_op1p);
+    }
+}
+
 AstNode* AstNode::iterateSubtreeReturnEdits(AstNVisitor& v) {
     // Some visitors perform tree edits (such as V3Const), and may even
     // replace/delete the exact nodep that the visitor is called with.  If
@@ -1030,7 +1189,10 @@ void AstNode::dumpTreeAndNext(ostream& os, const string& indent, int maxDepth) {
 }
 
 void AstNode::dumpTreeFile(const string& filename, bool append, bool doDump) {
-    if (doDump) {
+    if (doDump && v3Global.opt.dumpTreeBinary() && !append) {
+	UINFO(2,"Dumping "<<filename<<"b"<<endl);
+	V3AstBinary::dumpTreeFile(this, filename+"b");
+    } else if (doDump) {
 	{   // Write log & close
 	    UINFO(2,"Dumping "<<filename<<endl);
 	    const VL_UNIQUE_PTR<ofstream> logsp (V3File::new_ofstream(filename, append));
@@ -1046,7 +1208,8 @@ void AstNode::dumpTreeFile(const string& filename, bool append, bool doDump) {
 	    }
 	}
     }
-    if (v3Global.opt.debugCheck() || v3Global.opt.dumpTree()) {
+    if ((v3Global.opt.debugCheck() || v3Global.opt.dumpTree())
+	&& (!this->castNetlist() || V3Broken::checkDue())) {
 	// Error check
 	checkTree();
 	// Broken isn't part of check tree because it can munge iterp's
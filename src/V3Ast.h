@@ -26,6 +26,7 @@
 #include "V3FileLine.h"
 #include "V3Number.h"
 #include "V3Global.h"
+#include "V3String.h"
 #include <vector>
 #include <cmath>
 #include <map>
@@ -265,6 +266,7 @@ public:
 	VAR_ISOLATE_ASSIGNMENTS,	// V3LinkParse moves to AstVar::attrIsolateAssign
 	VAR_SC_BV,			// V3LinkParse moves to AstVar::attrScBv
 	VAR_SFORMAT,			// V3LinkParse moves to AstVar::attrSFormat
+	VAR_SPARSE,			// V3LinkParse moves to AstVar::attrSparse
 	VAR_CLOCKER,                    // V3LinkParse moves to AstVar::attrClocker
 	VAR_NO_CLOCKER                  // V3LinkParse moves to AstVar::attrClocker
     };
@@ -279,7 +281,7 @@ public:
 	    "MEMBER_BASE",
 	    "VAR_BASE", "VAR_CLOCK", "VAR_CLOCK_ENABLE", "VAR_PUBLIC",
 	    "VAR_PUBLIC_FLAT", "VAR_PUBLIC_FLAT_RD","VAR_PUBLIC_FLAT_RW",
-	    "VAR_ISOLATE_ASSIGNMENTS", "VAR_SC_BV", "VAR_SFORMAT", "VAR_CLOCKER",
+	    "VAR_ISOLATE_ASSIGNMENTS", "VAR_SC_BV", "VAR_SFORMAT", "VAR_SPARSE", "VAR_CLOCKER",
 	    "VAR_NO_CLOCKER"
 	};
 	return names[m_e];
@@ -752,6 +754,48 @@ public:
     static inline VNUser fromInt (int i) { return VNUser(i); }
 };
 
+//######################################################################
+// AstUserTable - Storage for one of the user() slots of all nodes
+//
+//  Rather than every node carrying all five slots, each node has a dense
+//  index (AstNodeUserIndex), and each slot's data is kept in a table
+//  indexed by it.  A table only grows as its slot is written, and is
+//  released when the slot's AstUser#InUse goes out of scope, so memory is
+//  only used by the slots a pass actually needs.
+
+class AstUserTable {
+    struct Entry {
+	VNUser		m_u;	// Contains any information the user iteration routine wants
+	uint32_t	m_cnt;	// Mark of when userp was set
+    };
+    vector<Entry>	m_entries;	// Indexed by AstNodeUserIndex
+    void grow(uint32_t index);
+public:
+    // METHODS
+    VNUser get(uint32_t index, uint32_t cnt) const {
+	return ((index < m_entries.size() && m_entries[index].m_cnt == cnt)
+		? m_entries[index].m_u : VNUser(0));
+    }
+    void set(uint32_t index, uint32_t cnt, const VNUser& user) {
+	if (VL_UNLIKELY(index >= m_entries.size())) grow(index);
+	m_entries[index].m_u = user;
+	m_entries[index].m_cnt = cnt;
+    }
+    void copy(uint32_t fromIndex, uint32_t toIndex) {
+	if (fromIndex < m_entries.size()) {
+	    Entry entry = m_entries[fromIndex];
+	    set(toIndex, entry.m_cnt, entry.m_u);
+	}
+    }
+    void reset(uint32_t index) {
+	if (index < m_entries.size()) {
+	    m_entries[index].m_u = VNUser(0);
+	    m_entries[index].m_cnt = 0;
+	}
+    }
+    void release() { vector<Entry> empty; m_entries.swap(empty); }
+};
+
 //######################################################################
 // AstUserResource - Generic pointer base class for tracking usage of user()
 //
@@ -771,10 +815,11 @@ protected:
 	userBusyRef = true;
 	clearcnt(id, cntGblRef, userBusyRef);
     }
-    static void	free(int id, uint32_t& cntGblRef, bool& userBusyRef) {
+    static void	free(int id, uint32_t& cntGblRef, bool& userBusyRef, AstUserTable& tableRef) {
 	UASSERT_STATIC(userBusyRef, "Free of User"+cvtToStr(id)+"() not under AstUserInUse");
 	clearcnt(id, cntGblRef, userBusyRef);  // Includes a checkUse for us
 	userBusyRef = false;
+	tableRef.release();  // Nothing in it is valid any more
     }
     static void clearcnt(int id, uint32_t& cntGblRef, bool& userBusyRef) {
 	UASSERT_STATIC(userBusyRef, "Clear of User"+cvtToStr(id)+"() not under AstUserInUse");
@@ -794,59 +839,88 @@ protected:
 class AstUser1InUse : AstUserInUseBase {
 protected:
     friend class AstNode;
+    friend class AstNodeUserIndex;
     static uint32_t	s_userCntGbl;	// Count of which usage of userp() this is
     static bool		s_userBusy;	// Count is in use
+    static AstUserTable	s_table;	// Values of user1p()
 public:
     AstUser1InUse()     { allocate(1, s_userCntGbl/*ref*/, s_userBusy/*ref*/); }
-    ~AstUser1InUse()    { free    (1, s_userCntGbl/*ref*/, s_userBusy/*ref*/); }
+    ~AstUser1InUse()    { free    (1, s_userCntGbl/*ref*/, s_userBusy/*ref*/, s_table/*ref*/); }
     static void clear() { clearcnt(1, s_userCntGbl/*ref*/, s_userBusy/*ref*/); }
     static void check() { checkcnt(1, s_userCntGbl/*ref*/, s_userBusy/*ref*/); }
 };
 class AstUser2InUse : AstUserInUseBase {
 protected:
     friend class AstNode;
+    friend class AstNodeUserIndex;
     static uint32_t	s_userCntGbl;	// Count of which usage of userp() this is
     static bool		s_userBusy;	// Count is in use
+    static AstUserTable	s_table;	// Values of user2p()
 public:
     AstUser2InUse()      { allocate(2, s_userCntGbl/*ref*/, s_userBusy/*ref*/); }
-    ~AstUser2InUse()     { free    (2, s_userCntGbl/*ref*/, s_userBusy/*ref*/); }
+    ~AstUser2InUse()     { free    (2, s_userCntGbl/*ref*/, s_userBusy/*ref*/, s_table/*ref*/); }
     static void clear()  { clearcnt(2, s_userCntGbl/*ref*/, s_userBusy/*ref*/); }
     static void check()	 { checkcnt(2, s_userCntGbl/*ref*/, s_userBusy/*ref*/); }
 };
 class AstUser3InUse : AstUserInUseBase {
 protected:
     friend class AstNode;
+    friend class AstNodeUserIndex;
     static uint32_t	s_userCntGbl;	// Count of which usage of userp() this is
     static bool		s_userBusy;	// Count is in use
+    static AstUserTable	s_table;	// Values of user3p()
 public:
     AstUser3InUse()      { allocate(3, s_userCntGbl/*ref*/, s_userBusy/*ref*/); }
-    ~AstUser3InUse()     { free    (3, s_userCntGbl/*ref*/, s_userBusy/*ref*/); }
+    ~AstUser3InUse()     { free    (3, s_userCntGbl/*ref*/, s_userBusy/*ref*/, s_table/*ref*/); }
     static void clear()  { clearcnt(3, s_userCntGbl/*ref*/, s_userBusy/*ref*/); }
     static void check()	 { checkcnt(3, s_userCntGbl/*ref*/, s_userBusy/*ref*/); }
 };
 class AstUser4InUse : AstUserInUseBase {
 protected:
     friend class AstNode;
+    friend class AstNodeUserIndex;
     static uint32_t	s_userCntGbl;	// Count of which usage of userp() this is
     static bool		s_userBusy;	// Count is in use
+    static AstUserTable	s_table;	// Values of user4p()
 public:
     AstUser4InUse()      { allocate(4, s_userCntGbl/*ref*/, s_userBusy/*ref*/); }
-    ~AstUser4InUse()     { free    (4, s_userCntGbl/*ref*/, s_userBusy/*ref*/); }
+    ~AstUser4InUse()     { free    (4, s_userCntGbl/*ref*/, s_userBusy/*ref*/, s_table/*ref*/); }
     static void clear()  { clearcnt(4, s_userCntGbl/*ref*/, s_userBusy/*ref*/); }
     static void check()	 { checkcnt(4, s_userCntGbl/*ref*/, s_userBusy/*ref*/); }
 };
 class AstUser5InUse : AstUserInUseBase {
 protected:
     friend class AstNode;
+    friend class AstNodeUserIndex;
     static uint32_t	s_userCntGbl;	// Count of which usage of userp() this is
     static bool		s_userBusy;	// Count is in use
+    static AstUserTable	s_table;	// Values of user5p()
 public:
     AstUser5InUse()      { allocate(5, s_userCntGbl/*ref*/, s_userBusy/*ref*/); }
-    ~AstUser5InUse()     { free    (5, s_userCntGbl/*ref*/, s_userBusy/*ref*/); }
+    ~AstUser5InUse()     { free    (5, s_userCntGbl/*ref*/, s_userBusy/*ref*/, s_table/*ref*/); }
     static void clear()  { clearcnt(5, s_userCntGbl/*ref*/, s_userBusy/*ref*/); }
     static void check()	 { checkcnt(5, s_userCntGbl/*ref*/, s_userBusy/*ref*/); }
 };
 
+//######################################################################
+// AstNodeUserIndex - A node's index into the AstUserTables
+//
+//  Indexes of deleted nodes are reused, to keep the tables dense.  A copied
+//  (cloned) node gets a new index, with a copy of the original's user data.
+
+class AstNodeUserIndex {
+    uint32_t	m_index;	// Index into the AstUserTables
+    static uint32_t		s_nextIndex;	// Next never used index
+    static vector<uint32_t>	s_freeIndexes;	// Indexes of deleted nodes, to reuse
+    static uint32_t allocIndex();
+    AstNodeUserIndex& operator= (const AstNodeUserIndex&);	///< N/A, no assignment
+public:
+    AstNodeUserIndex() { m_index = allocIndex(); }
+    AstNodeUserIndex(const AstNodeUserIndex& other);
+    ~AstNodeUserIndex();
+    uint32_t index() const { return m_index; }
+};
+
 //######################################################################
 // AstNVisitor -- Allows new functions to be called on each node
 // type without changing the base classes.  See "Modern C++ Design".
@@ -981,17 +1055,7 @@ class AstNode {
     bool	m_doingWidth:1;	// Inside V3Width
     //		// Space for more bools here
 
-    // This member ordering both allows 64 bit alignment and puts associated data together
-    VNUser	m_user1u;	// Contains any information the user iteration routine wants
-    uint32_t	m_user1Cnt;	// Mark of when userp was set
-    uint32_t	m_user2Cnt;	// Mark of when userp was set
-    VNUser	m_user2u;	// Contains any information the user iteration routine wants
-    VNUser	m_user3u;	// Contains any information the user iteration routine wants
-    uint32_t	m_user3Cnt;	// Mark of when userp was set
-    uint32_t	m_user4Cnt;	// Mark of when userp was set
-    VNUser	m_user4u;	// Contains any information the user iteration routine wants
-    VNUser	m_user5u;	// Contains any information the user iteration routine wants
-    uint32_t	m_user5Cnt;	// Mark of when userp was set
+    AstNodeUserIndex m_userIndex;	// Where user#p()'s are stored in the AstUserTables
 
     // METHODS
     void	op1p(AstNode* nodep) { m_op1p = nodep; if (nodep) nodep->m_backp = this; }
@@ -1065,10 +1129,8 @@ public:
 
     // CONSTRUCTORS
     virtual ~AstNode();
-#ifdef VL_LEAK_CHECKS
     static void* operator new(size_t size);
     static void operator delete(void* obj, size_t size);
-#endif
 
     // CONSTANT ACCESSORS
     static int	instrCountBranch() { return 4; }	///< Instruction cycles to branch
@@ -1121,10 +1183,10 @@ public:
     VNUser	user1u() const {
 	// Slows things down measurably, so disabled by default
 	//UASSERT_STATIC(AstUser1InUse::s_userBusy, "userp set w/o busy");
-	return ((m_user1Cnt==AstUser1InUse::s_userCntGbl) ? m_user1u : VNUser(0));
+	return AstUser1InUse::s_table.get(m_userIndex.index(), AstUser1InUse::s_userCntGbl);
     }
     AstNode*	user1p() const { return user1u().toNodep(); }
-    void	user1u(const VNUser& user) { m_user1u=user; m_user1Cnt=AstUser1InUse::s_userCntGbl; }
+    void	user1u(const VNUser& user) { AstUser1InUse::s_table.set(m_userIndex.index(), AstUser1InUse::s_userCntGbl, user); }
     void	user1p(void* userp) { user1u(VNUser(userp)); }
     int		user1() const { return user1u().toInt(); }
     void	user1(int val) { user1u(VNUser(val)); }
@@ -1135,10 +1197,10 @@ public:
     VNUser	user2u() const {
 	// Slows things down measurably, so disabled by default
 	//UASSERT_STATIC(AstUser2InUse::s_userBusy, "userp set w/o busy");
-	return ((m_user2Cnt==AstUser2InUse::s_userCntGbl) ? m_user2u : VNUser(0));
+	return AstUser2InUse::s_table.get(m_userIndex.index(), AstUser2InUse::s_userCntGbl);
     }
     AstNode*	user2p() const { return user2u().toNodep(); }
-    void	user2u(const VNUser& user) { m_user2u=user; m_user2Cnt=AstUser2InUse::s_userCntGbl; }
+    void	user2u(const VNUser& user) { AstUser2InUse::s_table.set(m_userIndex.index(), AstUser2InUse::s_userCntGbl, user); }
     void	user2p(void* userp) { user2u(VNUser(userp)); }
     int		user2() const { return user2u().toInt(); }
     void	user2(int val) { user2u(VNUser(val)); }
@@ -1149,10 +1211,10 @@ public:
     VNUser	user3u() const {
 	// Slows things down measurably, so disabled by default
 	//UASSERT_STATIC(AstUser3InUse::s_userBusy, "userp set w/o busy");
-	return ((m_user3Cnt==AstUser3InUse::s_userCntGbl) ? m_user3u : VNUser(0));
+	return AstUser3InUse::s_table.get(m_userIndex.index(), AstUser3InUse::s_userCntGbl);
     }
     AstNode*	user3p() const { return user3u().toNodep(); }
-    void	user3u(const VNUser& user) { m_user3u=user; m_user3Cnt=AstUser3InUse::s_userCntGbl; }
+    void	user3u(const VNUser& user) { AstUser3InUse::s_table.set(m_userIndex.index(), AstUser3InUse::s_userCntGbl, user); }
     void	user3p(void* userp) { user3u(VNUser(userp)); }
     int		user3() const { return user3u().toInt(); }
     void	user3(int val) { user3u(VNUser(val)); }
@@ -1163,10 +1225,10 @@ public:
     VNUser	user4u() const {
 	// Slows things down measurably, so disabled by default
 	//UASSERT_STATIC(AstUser4InUse::s_userBusy, "userp set w/o busy");
-	return ((m_user4Cnt==AstUser4InUse::s_userCntGbl) ? m_user4u : VNUser(0));
+	return AstUser4InUse::s_table.get(m_userIndex.index(), AstUser4InUse::s_userCntGbl);
     }
     AstNode*	user4p() const { return user4u().toNodep(); }
-    void	user4u(const VNUser& user) { m_user4u=user; m_user4Cnt=AstUser4InUse::s_userCntGbl; }
+    void	user4u(const VNUser& user) { AstUser4InUse::s_table.set(m_userIndex.index(), AstUser4InUse::s_userCntGbl, user); }
     void	user4p(void* userp) { user4u(VNUser(userp)); }
     int		user4() const { return user4u().toInt(); }
     void	user4(int val) { user4u(VNUser(val)); }
@@ -1177,10 +1239,10 @@ public:
     VNUser	user5u() const {
 	// Slows things down measurably, so disabled by default
 	//UASSERT_STATIC(AstUser5InUse::s_userBusy, "userp set w/o busy");
-	return ((m_user5Cnt==AstUser5InUse::s_userCntGbl) ? m_user5u : VNUser(0));
+	return AstUser5InUse::s_table.get(m_userIndex.index(), AstUser5InUse::s_userCntGbl);
     }
     AstNode*	user5p() const { return user5u().toNodep(); }
-    void	user5u(const VNUser& user) { m_user5u=user; m_user5Cnt=AstUser5InUse::s_userCntGbl; }
+    void	user5u(const VNUser& user) { AstUser5InUse::s_table.set(m_userIndex.index(), AstUser5InUse::s_userCntGbl, user); }
     void	user5p(void* userp) { user5u(VNUser(userp)); }
     int		user5() const { return user5u().toInt(); }
     void	user5(int val) { user5u(VNUser(val)); }
@@ -1193,6 +1255,7 @@ public:
     static vluint64_t	editCountLast() { return s_editCntLast; }
     static vluint64_t	editCountGbl() { return s_editCntGbl; }
     static void		editCountSetLast() { s_editCntLast = editCountGbl(); }
+    bool	editedSince(vluint64_t editCnt) const;	// This node or any below edited after editCnt
 
     // ACCESSORS for specific types
     // Alas these can't be virtual or they break when passed a NULL
@@ -1293,11 +1356,14 @@ public:
     // INVOKERS
     virtual void accept(AstNVisitor& v) = 0;
     void	iterate(AstNVisitor& v) { this->accept(v); } 	  // Does this; excludes following this->next
+    void	iterateFlat(AstNVisitor& v);  // This and all below, without recursion; visit() must not iterate nor edit
     void	iterateAndNext(AstNVisitor& v);
     void	iterateAndNextConst(AstNVisitor& v);
     void	iterateChildren(AstNVisitor& v);  // Excludes following this->next
     void	iterateChildrenBackwards(AstNVisitor& v);  // Excludes following this->next
     void	iterateChildrenConst(AstNVisitor& v);  // Excludes following this->next
+    void	iterateChildrenEdited(AstNVisitor& v, vluint64_t editCnt);  // Skips children that are editedSince(editCnt)==false
+    void	iterateAndNextEdited(AstNVisitor& v, vluint64_t editCnt);
     AstNode*	iterateSubtreeReturnEdits(AstNVisitor& v);  // Return edited nodep; see comments in V3Ast.cpp
 
     // CONVERSION
@@ -1591,7 +1657,7 @@ private:
     AstVar*	m_varp;		// [AfterLink] Pointer to variable itself
     AstVarScope* m_varScopep;	// Varscope for hierarchy
     AstPackage*	m_packagep;	// Package hierarchy
-    string	m_name;		// Name of variable
+    VIdent	m_name;		// Name of variable
     string	m_hiername;	// Scope converted into name-> for emitting
     bool	m_hierThis;	// Hiername points to "this" function
     void init();
@@ -1832,7 +1898,7 @@ public:
 
 class AstNodeFTask : public AstNode {
 private:
-    string	m_name;		// Name of task
+    VIdent	m_name;		// Name of task
     string	m_cname;	// Name of task if DPI import
     bool	m_taskPublic:1;	// Public task
     bool	m_attrIsolateAssign:1;// User isolate_assignments attribute
@@ -1893,7 +1959,7 @@ class AstNodeFTaskRef : public AstNode {
     // A reference to a task (or function)
 private:
     AstNodeFTask*	m_taskp;	// [AfterLink] Pointer to task referenced
-    string		m_name;		// Name of variable
+    VIdent		m_name;		// Name of variable
     string		m_dotted;	// Dotted part of scope to task or ""
     string		m_inlinedDots;	// Dotted hierarchy flattened out
     AstPackage*		m_packagep;	// Package hierarchy
@@ -1941,7 +2007,7 @@ class AstNodeModule : public AstNode {
     // something that can live directly under the TOP,
     // excluding $unit package stuff
 private:
-    string	m_name;		// Name of the module
+    VIdent	m_name;		// Name of the module
     string	m_origName;	// Name of the module, ignoring name() changes, for dot lookup
     bool	m_modPublic:1;	// Module has public references
     bool	m_modTrace:1;	// Tracing this module
@@ -0,0 +1,163 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//*************************************************************************
+// DESCRIPTION: Verilator: Binary tree dump files
+//
+// Code available from: http://www.veripool.org/verilator
+//
+//*************************************************************************
+//
+// Copyright 2003-2017 by Wilson Snyder.  This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+//
+// Verilator is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+//*************************************************************************
+// BINARY TREE DUMPS:
+//	Same content as AstNode::dumpTree, in a form much smaller and
+//	cheaper to write:
+//	    Indentation becomes a depth and child slot per node
+//	    Node pointers become small ids, numbered on first mention
+//	    Strings (types, filelines, dump text) are written once and
+//	    then referenced by id
+//	The file is built in memory, then written by a background thread.
+//
+//	Format, after a first text line, is a series of records.
+//	Numbers are unsigned LEB128 varints, strings are a length then bytes.
+//	    'H' editCountLast editCountGbl		Header
+//	    'U'						No changes since last dump
+//	    'S' string					Define next string id (from 1; 0 is "")
+//	    'N' depth slot flags type id edit fl rest	Node: type, fl, rest are string ids
+//	    'R' depth slot text				Node dumped in an unknown form
+//	flags: 1 = edited since last dump (prints as <e#>)
+//	verilator_difftree converts this back to the text form.
+//
+//*************************************************************************
+
+#include "config_build.h"
+#include "verilatedos.h"
+#include <cstdio>
+#include <cstdarg>
+#include <map>
+#include <sstream>
+
+#include "V3Global.h"
+#include "V3AstBinary.h"
+#include "V3File.h"
+
+//######################################################################
+
+class AstBinaryWriter {
+    // MEMBERS
+    typedef map<string,uint32_t> StringMap;
+    typedef map<vluint64_t,uint32_t> PtrMap;
+    string		m_out;		// File contents
+    StringMap		m_strings;	// Id of each string written
+    PtrMap		m_ptrs;		// Id of each pointer mentioned
+    ostringstream	m_dump;		// Buffer for each node's dump()
+
+    // METHODS
+    void putByte(char c) { m_out += c; }
+    void putNum(vluint64_t value) {
+	do {
+	    char c = (char)(value & 0x7f);
+	    value >>= 7;
+	    if (value) c |= (char)0x80;
+	    m_out += c;
+	} while (value);
+    }
+    uint32_t stringId(const string& str) {
+	if (str.empty()) return 0;
+	StringMap::iterator it = m_strings.find(str);
+	if (it != m_strings.end()) return it->second;
+	uint32_t id = m_strings.size()+1;
+	m_strings.insert(make_pair(str, id));
+	putByte('S'); putNum(str.length()); m_out += str;
+	return id;
+    }
+    uint32_t ptrId(vluint64_t ptr) {
+	PtrMap::iterator it = m_ptrs.find(ptr);
+	if (it != m_ptrs.end()) return it->second;
+	uint32_t id = m_ptrs.size()+1;
+	m_ptrs.insert(make_pair(ptr, id));
+	return id;
+    }
+    string normalize(const string& text) {
+	// Replace hex pointers with their ids, so equal dumps intern to equal strings
+	string out;
+	string::size_type pos = 0;
+	while (true) {
+	    string::size_type hexPos = text.find("0x", pos);
+	    if (hexPos == string::npos) break;
+	    string::size_type end = hexPos+2;
+	    vluint64_t ptr = 0;
+	    while (end < text.length() && isxdigit(text[end])) {
+		char c = tolower(text[end]);
+		ptr = (ptr<<4) | (vluint64_t)(isdigit(c) ? (c-'0') : (c-'a'+10));
+		++end;
+	    }
+	    out.append(text, pos, hexPos+2-pos);
+	    if (end > hexPos+2) {
+		ostringstream os; os<<hex<<ptrId(ptr);
+		out += os.str();
+	    }
+	    pos = end;
+	}
+	out.append(text, pos, string::npos);
+	return out;
+    }
+    void node(AstNode* nodep, uint32_t depth, int slot) {
+	m_dump.str("");
+	nodep->dump(m_dump);
+	string text = m_dump.str();
+	// Split "TYPE 0xPTR <eEDIT> {FL}REST" so the varying parts are numbers
+	string type = nodep->typeName();
+	string::size_type editPos = text.find(" <e");
+	string::size_type flPos = (editPos == string::npos) ? string::npos : text.find(" {", editPos);
+	string::size_type flEnd = (flPos == string::npos) ? string::npos : text.find('}', flPos);
+	if (text.compare(0, type.length()+1, type+" ") != 0 || flEnd == string::npos) {
+	    uint32_t textId = stringId(normalize(text));
+	    putByte('R'); putNum(depth); putNum(slot); putNum(textId);
+	} else {
+	    uint32_t typeId = stringId(type);
+	    uint32_t flId = stringId(text.substr(flPos+2, flEnd-flPos-2));
+	    uint32_t restId = stringId(normalize(text.substr(flEnd+1)));
+	    putByte('N'); putNum(depth); putNum(slot);
+	    putNum((nodep->editCount() >= AstNode::editCountLast()) ? 1 : 0);
+	    putNum(typeId);
+	    putNum(ptrId((vluint64_t)(size_t)nodep));
+	    putNum(nodep->editCount());
+	    putNum(flId);
+	    putNum(restId);
+	}
+	for (AstNode* subp=nodep->op1p(); subp; subp=subp->nextp()) node(subp, depth+1, 1);
+	for (AstNode* subp=nodep->op2p(); subp; subp=subp->nextp()) node(subp, depth+1, 2);
+	for (AstNode* subp=nodep->op3p(); subp; subp=subp->nextp()) node(subp, depth+1, 3);
+	for (AstNode* subp=nodep->op4p(); subp; subp=subp->nextp()) node(subp, depth+1, 4);
+    }
+public:
+    // CONSTRUCTORS
+    AstBinaryWriter(AstNode* nodep, const string& filename) {
+	m_out = "Verilator Binary Tree Dump (format 0x3900)\n";
+	putByte('H'); putNum(AstNode::editCountLast()); putNum(AstNode::editCountGbl());
+	if (AstNode::editCountGbl()==AstNode::editCountLast()
+	    && !(v3Global.opt.dumpTree()>=9)) {
+	    putByte('U');
+	} else {
+	    node(nodep, 0, 0);
+	}
+	V3File::writeBehind(filename, m_out);
+    }
+    ~AstBinaryWriter() {}
+};
+
+//######################################################################
+// V3AstBinary class functions
+
+void V3AstBinary::dumpTreeFile(AstNode* nodep, const string& filename) {
+    AstBinaryWriter writer (nodep, filename);
+}
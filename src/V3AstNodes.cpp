@@ -587,9 +587,11 @@ void AstTypeTable::clearCache() {
 	for (int numer=0; numer<AstNumeric::_ENUM_MAX; ++numer) {
 	    LogicMap& mapr = m_logicMap[isbit][numer];
 	    mapr.clear();
+	    m_rangeMap[isbit][numer].clear();
 	}
     }
     m_detailedMap.clear();
+    m_sliceMap.clear();
     // Clear generic()'s so dead detection will work
     for (AstNode* nodep = typesp(); nodep; nodep=nodep->nextp()) {
 	if (AstBasicDType* bdtypep = nodep->castBasicDType()) {
@@ -648,10 +650,34 @@ AstBasicDType* AstTypeTable::findLogicBitDType(FileLine* fl, AstBasicDTypeKwd kw
 
 AstBasicDType* AstTypeTable::findLogicBitDType(FileLine* fl, AstBasicDTypeKwd kwd,
 					       VNumRange range, int widthMin, AstNumeric numeric) {
+    int idx = IDX0_LOGIC;
+    if (kwd == AstBasicDTypeKwd::LOGIC) idx = IDX0_LOGIC;
+    else if (kwd == AstBasicDTypeKwd::BIT) idx = IDX0_BIT;
+    else fl->v3fatalSrc("Bad kwd for findLogicBitDType");
+    // Look up without making a node, as most ranges repeat
+    pair<VNumRange,int> key = make_pair(range,widthMin);
+    RangeMap& mapr = m_rangeMap[idx][(int)numeric];
+    RangeMap::const_iterator it = mapr.find(key);
+    if (it != mapr.end()) return it->second;
+    //
     AstBasicDType* new1p = new AstBasicDType(fl, kwd, numeric, range, widthMin);
     AstBasicDType* newp = findInsertSameDType(new1p);
     if (newp != new1p) new1p->deleteTree();
     else addTypesp(newp);
+    //
+    mapr.insert(make_pair(key,newp));
+    return newp;
+}
+
+AstPackArrayDType* AstTypeTable::findPackArrayDType(FileLine* fl, AstNodeDType* subDTypep,
+						    VNumRange range) {
+    // Array selects make the same slice types repeatedly; share them
+    pair<AstNodeDType*,VNumRange> key = make_pair(subDTypep,range);
+    SliceMap::const_iterator it = m_sliceMap.find(key);
+    if (it != m_sliceMap.end()) return it->second;
+    AstPackArrayDType* newp = new AstPackArrayDType(fl, subDTypep, new AstRange(fl, range));
+    addTypesp(newp);
+    m_sliceMap.insert(make_pair(key,newp));
     return newp;
 }
 
@@ -983,6 +1009,7 @@ void AstVar::dump(ostream& str) {
     if (isUsedLoopIdx()) str<<" [LOOP]";
     if (attrClockEn()) str<<" [aCLKEN]";
     if (attrIsolateAssign()) str<<" [aISO]";
+    if (attrSparse()) str<<" [aSPARSE]";
     if (attrFileDescr()) str<<" [aFD]";
     if (isFuncReturn()) str<<" [FUNCRTN]";
     else if (isFuncLocal()) str<<" [FUNC]";
@@ -1039,6 +1066,10 @@ void AstBegin::dump(ostream& str) {
     if (generate()) str<<" [GEN]";
     if (genforp()) str<<" [GENFOR]";
 }
+void AstWhile::dump(ostream& str) {
+    this->AstNode::dump(str);
+    if (loops()) str<<" [LOOPS="<<loops()<<"]";
+}
 void AstCoverDecl::dump(ostream& str) {
     this->AstNode::dump(str);
     if (this->dataDeclNullp()) {
@@ -1086,6 +1117,7 @@ void AstCCall::dump(ostream& str) {
 void AstCFunc::dump(ostream& str) {
     this->AstNode::dump(str);
     if (slow()) str<<" [SLOW]";
+    if (isHot()) str<<" [HOT]";
     if (pure()) str<<" [PURE]";
     if (dpiImport()) str<<" [DPII]";
     if (dpiExport()) str<<" [DPIX]";
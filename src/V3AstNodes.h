@@ -531,7 +531,7 @@ public:
 class AstRefDType : public AstNodeDType {
 private:
     AstNodeDType* m_refDTypep;	// data type pointed to, BELOW the AstTypedef
-    string	m_name;		// Name of an AstTypedef
+    VIdent	m_name;		// Name of an AstTypedef
     AstPackage*	m_packagep;	// Package hierarchy
 public:
     AstRefDType(FileLine* fl, const string& name)
@@ -606,7 +606,7 @@ class AstMemberDType : public AstNodeDType {
     // PARENT: AstClassDType
 private:
     AstNodeDType*	m_refDTypep;	// Elements of this type (after widthing)
-    string	m_name;		// Name of variable
+    VIdent	m_name;		// Name of variable
     int		m_lsb;		// Within this level's packed struct, the LSB of the first bit of the member
     //UNSUP: int m_randType;	// Randomization type (IEEE)
 public:
@@ -980,7 +980,7 @@ public:
 class AstVar : public AstNode {
     // A variable (in/out/wire/reg/param) inside a module
 private:
-    string	m_name;		// Name of variable
+    VIdent	m_name;		// Name of variable
     string	m_origName;	// Original name before dot addition
     AstVarType	m_varType;	// Type of variable
     bool	m_input:1;	// Input or inout
@@ -1004,6 +1004,7 @@ private:
     bool	m_attrScBv:1; // User force bit vector attribute
     bool	m_attrIsolateAssign:1;// User isolate_assignments attribute
     bool	m_attrSFormat:1;// User sformat attribute
+    bool	m_attrSparse:1;	// User sparse attribute
     bool	m_fileDescr:1;	// File descriptor
     bool	m_isConst:1;	// Table contains constant data
     bool	m_isStatic:1;	// Static variable
@@ -1022,6 +1023,7 @@ private:
 	m_sigPublic=false; m_sigModPublic=false; m_sigUserRdPublic=false; m_sigUserRWPublic=false;
 	m_funcLocal=false; m_funcReturn=false;
 	m_attrClockEn=false; m_attrScBv=false; m_attrIsolateAssign=false; m_attrSFormat=false;
+	m_attrSparse=false;
 	m_fileDescr=false; m_isConst=false; m_isStatic=false; m_isPulldown=false; m_isPullup=false;
 	m_isIfaceParent=false; m_attrClocker=AstVarAttrClocker::CLOCKER_UNKNOWN; m_noSubst=false;
 	m_trace=false;
@@ -1102,6 +1104,7 @@ public:
     void	attrScBv(bool flag) { m_attrScBv = flag; }
     void	attrIsolateAssign(bool flag) { m_attrIsolateAssign = flag; }
     void	attrSFormat(bool flag) { m_attrSFormat = flag; }
+    void	attrSparse(bool flag) { m_attrSparse = flag; }
     void	usedClock(bool flag) { m_usedClock = flag; }
     void	usedParam(bool flag) { m_usedParam = flag; }
     void	usedLoopIdx(bool flag) { m_usedLoopIdx = flag; }
@@ -1146,6 +1149,9 @@ public:
     bool	isStatementTemp() const { return (varType()==AstVarType::STMTTEMP); }
     bool	isMovableToBlock() const { return (varType()==AstVarType::BLOCKTEMP || isFuncLocal()); }
     bool	isXTemp() const { return (varType()==AstVarType::XTEMP); }
+    bool	isShadow() const { return (name().compare(0,6,"__Vdly")==0	// Copy for delayed assignment or change detection
+					   || name().compare(0,11,"__Vchglast_")==0
+					   || name().compare(0,11,"__Vclklast_")==0); }
     bool	isParam() const { return (varType()==AstVarType::LPARAM || varType()==AstVarType::GPARAM); }
     bool	isGParam() const { return (varType()==AstVarType::GPARAM); }
     bool	isGenVar() const { return (varType()==AstVarType::GENVAR); }
@@ -1176,6 +1182,7 @@ public:
     bool	attrScClocked() const { return m_scClocked; }
     bool	attrSFormat() const { return m_attrSFormat; }
     bool	attrIsolateAssign() const { return m_attrIsolateAssign; }
+    bool	attrSparse() const { return m_attrSparse; }
     AstVarAttrClocker attrClocker() const { return m_attrClocker; }
     virtual string verilogKwd() const;
     void	propagateAttrFrom(AstVar* fromp) {
@@ -1184,6 +1191,7 @@ public:
 	if (fromp->attrClockEn()) attrClockEn(true);
 	if (fromp->attrFileDescr()) attrFileDescr(true);
 	if (fromp->attrIsolateAssign()) attrIsolateAssign(true);
+	if (fromp->attrSparse()) attrSparse(true);
     }
     bool	gateMultiInputOptimizable() const {
 	// Ok to gate optimize; must return false if propagateAttrFrom would do anything
@@ -1248,7 +1256,7 @@ class AstScope : public AstNode {
     // Children: NODEBLOCK
 private:
     // An AstScope->name() is special: . indicates an uninlined scope, __DOT__ an inlined scope
-    string	m_name;		// Name
+    VIdent	m_name;		// Name
     AstScope*	m_aboveScopep;	// Scope above this one in the hierarchy (NULL if top)
     AstCell*	m_aboveCellp;	// Cell above this in the hierarchy (NULL if top)
     AstNodeModule*	m_modp;		// Module scope corresponds to
@@ -1401,7 +1409,7 @@ class AstPin : public AstNode {
     // A pin on a cell
 private:
     int		m_pinNum;	// Pin number
-    string	m_name;		// Pin name, or "" for number based interconnect
+    VIdent	m_name;		// Pin name, or "" for number based interconnect
     AstVar*	m_modVarp;	// Input/output this pin connects to on submodule.
     AstParamTypeDType*	m_modPTypep;	// Param type this pin connects to on submodule.
     bool	m_param;	// Pin connects to parameter
@@ -1592,7 +1600,7 @@ public:
 class AstCell : public AstNode {
     // A instantiation cell or interface call (don't know which until link)
 private:
-    string	m_name;		// Cell name
+    VIdent	m_name;		// Cell name
     string	m_origName;	// Original name before dot addition
     string	m_modName;	// Module the cell instances
     AstNodeModule* m_modp;	// [AfterLink] Pointer to module instanced
@@ -1758,7 +1766,7 @@ class AstParseRef : public AstNode {
     // Children: TEXT|DOT|SEL*|TASK|FUNC (or expression under sel)
 private:
     AstParseRefExp	m_expect;		// Type we think it should resolve to
-    string		m_name;
+    VIdent		m_name;
 public:
     AstParseRef(FileLine* fl, AstParseRefExp expect, const string& name, AstNode* lhsp, AstNodeFTaskRef* ftaskrefp)
 	:AstNode(fl), m_expect(expect), m_name(name) { setNOp1p(lhsp); setNOp2p(ftaskrefp); }
@@ -2241,6 +2249,29 @@ public:
     AstCoverDecl*	declp() const { return m_declp; }	// Where defined
 };
 
+class AstActivityInc : public AstNodeStmt {
+    // Block activity point, for --profile-activity; increment the block's counter
+    // Parents:  {statement list}
+    // Children: none
+private:
+    string	m_name;		// Module, scope and source location of block
+    int		m_binNum;	// Counter number, set by V3EmitCSyms
+public:
+    AstActivityInc(FileLine* fl, const string& name)
+	: AstNodeStmt(fl), m_name(name), m_binNum(0) {}
+    ASTNODE_NODE_FUNCS(ActivityInc)
+    virtual string name() const { return m_name; }
+    virtual int instrCount()	const { return 1+2*instrCountLd(); }
+    virtual V3Hash sameHash() const { return V3Hash(name()); }
+    virtual bool same(AstNode* samep) const {
+	return name()==samep->castActivityInc()->name(); }
+    virtual bool isGateOptimizable() const { return false; }
+    virtual bool isPredictOptimizable() const { return false; }
+    virtual bool isOutputter() const { return true; }
+    int		binNum() const { return m_binNum; }
+    void	binNum(int flag) { m_binNum = flag; }
+};
+
 class AstCoverToggle : public AstNodeStmt {
     // Toggle analysis of given signal
     // Parents:  MODULE
@@ -2750,12 +2781,17 @@ public:
 };
 
 class AstWhile : public AstNodeStmt {
+    int		m_loops;	// Known iteration count, or 0 if unknown
 public:
     AstWhile(FileLine* fileline, AstNode* condp, AstNode* bodysp, AstNode* incsp=NULL)
 	: AstNodeStmt(fileline) {
 	setOp2p(condp); addNOp3p(bodysp); addNOp4p(incsp);
+	m_loops = 0;
     }
     ASTNODE_NODE_FUNCS(While)
+    virtual void dump(ostream& str);
+    int		loops() const { return m_loops; }
+    void	loops(int value) { m_loops = value; }	// Set by V3Unroll for --unroll-keep loops
     AstNode*	precondsp()	const { return op1p(); }	// op1= prepare statements for condition (exec every loop)
     AstNode*	condp()		const { return op2p(); }	// op2= condition to continue
     AstNode*	bodysp()	const { return op3p(); }	// op3= body of loop
@@ -2937,16 +2973,19 @@ class AstChangeDet : public AstNodeStmt {
     // A comparison to determine change detection, common & must be fast.
 private:
     bool	m_clockReq;	// Type of detection
+    int		m_binNum;	// --profile-converge counter number, set by V3EmitCSyms
 public:
     // Null lhs+rhs used to indicate change needed with no spec vars
     AstChangeDet(FileLine* fl, AstNode* lhsp, AstNode* rhsp, bool clockReq)
 	: AstNodeStmt(fl) {
-	setNOp1p(lhsp); setNOp2p(rhsp); m_clockReq=clockReq;
+	setNOp1p(lhsp); setNOp2p(rhsp); m_clockReq=clockReq; m_binNum=0;
     }
     ASTNODE_NODE_FUNCS(ChangeDet)
     AstNode*	lhsp() 	const { return op1p(); }
     AstNode*	rhsp() 	const { return op2p(); }
     bool	isClockReq() const { return m_clockReq; }
+    int		binNum() const { return m_binNum; }
+    void	binNum(int flag) { m_binNum = flag; }
     virtual bool isGateOptimizable() const { return false; }
     virtual bool isPredictOptimizable() const { return false; }
     virtual int instrCount()	const { return widthInstrs(); }
@@ -3135,6 +3174,7 @@ private:
     VNumRange	m_bitRange;	// Property of var the trace details
     VNumRange	m_arrayRange;	// Property of var the trace details
     uint32_t	m_codeInc;	// Code increment
+    bool	m_instShared;	// Declared instead by an identical instance's function
 public:
     AstTraceDecl(FileLine* fl, const string& showname, AstNode* valuep,
 		 const VNumRange& bitRange, const VNumRange& arrayRange)
@@ -3142,6 +3182,7 @@ public:
 	, m_showname(showname), m_bitRange(bitRange), m_arrayRange(arrayRange) {
 	dtypeFrom(valuep);
 	m_code = 0;
+	m_instShared = false;
 	m_codeInc = ((arrayRange.ranged() ? arrayRange.elements() : 1)
 		     * valuep->dtypep()->widthWords());
     }
@@ -3156,6 +3197,8 @@ public:
     uint32_t	code() const { return m_code; }
     void	code(uint32_t code) { m_code=code; }
     uint32_t	codeInc() const { return m_codeInc; }
+    bool	instShared() const { return m_instShared; }	// Kept only for its AstTraceIncs
+    void	instShared(bool flag) { m_instShared = flag; }
     const VNumRange& bitRange() const { return m_bitRange; }
     const VNumRange& arrayRange() const { return m_arrayRange; }
 };
@@ -4349,6 +4392,24 @@ public:
     virtual bool cleanLhs() {return false;} virtual bool cleanRhs() {return true;}
     virtual bool sizeMattersLhs() {return true;} virtual bool sizeMattersRhs() {return false;}
 };
+class AstPext : public AstNodeBiop {
+    // Parallel bit extract: the bits of lhs under constant mask rhs, gathered into the LSBs
+    // Made by V3Expand from concatenations of selects
+public:
+    AstPext(FileLine* fl, AstNode* lhsp, AstNode* rhsp, int setwidth)
+	: AstNodeBiop(fl, lhsp, rhsp) {
+	dtypeSetLogicSized(setwidth,setwidth,AstNumeric::UNSIGNED);
+    }
+    ASTNODE_NODE_FUNCS(Pext)
+    virtual AstNode* cloneType(AstNode* lhsp, AstNode* rhsp) { return new AstPext(this->fileline(), lhsp, rhsp, width()); }
+    virtual void numberOperate(V3Number& out, const V3Number& lhs, const V3Number& rhs) { out.opPext(lhs,rhs); }
+    virtual string emitVerilog() { return "%f$_PEXT(%l, %r)"; }
+    virtual string emitC() { return "VL_PEXT_%nq%lq%rq(%li, %ri)"; }
+    virtual bool cleanOut() {return true;}
+    virtual bool cleanLhs() {return false;} virtual bool cleanRhs() {return true;}
+    virtual bool sizeMattersLhs() {return false;} virtual bool sizeMattersRhs() {return false;}
+    virtual int instrCount()	const { return widthInstrs()*4; }
+};
 class AstShiftR : public AstNodeBiop {
 public:
     AstShiftR(FileLine* fl, AstNode* lhsp, AstNode* rhsp, int setwidth=0)
@@ -5109,6 +5170,7 @@ private:
     bool	m_slow:1;		// Slow routine, called once or just at init time
     bool	m_funcPublic:1;		// From user public task/function
     bool	m_isInline:1;		// Inline function
+    bool	m_isHot:1;		// Called on every evaluation, see V3Branch
     bool	m_isStatic:1;		// Function is declared static (no this)
     bool	m_symProlog:1;		// Setup symbol table for later instructions
     bool	m_entryPoint:1;		// User may call into this top level function
@@ -5130,6 +5192,7 @@ public:
 	m_slow = false;
 	m_funcPublic = false;
 	m_isInline = false;
+	m_isHot = false;
 	m_isStatic = true;	// Note defaults to static, later we see where thisp is needed
 	m_symProlog = false;
 	m_entryPoint = false;
@@ -5176,6 +5239,8 @@ public:
     AstCFuncType funcType() const { return m_funcType; }
     bool	isInline() const { return m_isInline; }
     void	isInline(bool flag) { m_isInline = flag; }
+    bool	isHot() const { return m_isHot; }
+    void	isHot(bool flag) { m_isHot = flag; }
     bool	isStatic() const { return m_isStatic; }
     void	isStatic(bool flag) { m_isStatic = flag; }
     bool	symProlog() const { return m_symProlog; }
@@ -5236,6 +5301,7 @@ public:
     virtual V3Hash sameHash() const { return V3Hash(funcp()); }
     virtual bool same(AstNode* samep) const {
 	return (funcp()==samep->castCCall()->funcp()
+		&& hiername()==samep->castCCall()->hiername()
 		&& argTypes()==samep->castCCall()->argTypes()); }
     AstNode*	exprsp()	const { return op1p(); }	// op1= expressions to print
     virtual bool isGateOptimizable() const { return false; }
@@ -5252,6 +5318,46 @@ public:
     void addArgsp(AstNode* nodep) { addOp1p(nodep); }
 };
 
+class AstExecMTasks : public AstNodeStmt {
+    // Set of independent macro-task calls run concurrently on the thread pool (--threads)
+    // Parents:  Anything above a statement
+    // Children: CCALLs, one per macro-task, to static "void*" symtab functions
+public:
+    AstExecMTasks(FileLine* fl, AstNode* callsp)
+	: AstNodeStmt(fl) {
+	addNOp1p(callsp);
+    }
+    ASTNODE_NODE_FUNCS(ExecMTasks)
+    virtual bool isGateOptimizable() const { return false; }
+    virtual bool isPredictOptimizable() const { return false; }
+    virtual bool isPure() const { return false; }
+    virtual bool isOutputter() const { return true; }
+    virtual V3Hash sameHash() const { return V3Hash(); }
+    virtual bool same(AstNode* samep) const { return true; }
+    AstCCall*	callsp()	const { return op1p()->castCCall(); }	// op1= mtask calls
+    void addCallsp(AstNode* nodep) { addOp1p(nodep); }
+};
+
+class AstExecInstances : public AstNodeStmt {
+    // Calls of one function on a run of instances, emitted as a loop over a table of instances
+    // Parents:  Anything above a statement
+    // Children: CCALLs, in order, same function and arguments, differing only in hiername
+public:
+    AstExecInstances(FileLine* fl, AstNode* callsp)
+	: AstNodeStmt(fl) {
+	addNOp1p(callsp);
+    }
+    ASTNODE_NODE_FUNCS(ExecInstances)
+    virtual bool isGateOptimizable() const { return false; }
+    virtual bool isPredictOptimizable() const { return false; }
+    virtual bool isPure() const { return false; }
+    virtual bool isOutputter() const { return true; }
+    virtual V3Hash sameHash() const { return V3Hash(); }
+    virtual bool same(AstNode* samep) const { return true; }
+    AstCCall*	callsp()	const { return op1p()->castCCall(); }	// op1= instance calls
+    void addCallsp(AstNode* nodep) { addOp1p(nodep); }
+};
+
 class AstCReturn : public AstNodeStmt {
     // C++ return from a function
     // Parents:  CFUNC/statement
@@ -5344,8 +5450,14 @@ class AstTypeTable : public AstNode {
     enum { IDX0_LOGIC, IDX0_BIT, _IDX0_MAX };
     LogicMap m_logicMap[_IDX0_MAX][AstNumeric::_ENUM_MAX];  // uses above IDX enums
     //
+    typedef map<pair<VNumRange,int>,AstBasicDType*> RangeMap;  // Range, widthMin
+    RangeMap m_rangeMap[_IDX0_MAX][AstNumeric::_ENUM_MAX];  // uses above IDX enums
+    //
     typedef map<VBasicTypeKey,AstBasicDType*> DetailedMap;
     DetailedMap m_detailedMap;
+    //
+    typedef map<pair<AstNodeDType*,VNumRange>,AstPackArrayDType*> SliceMap;  // Sub dtype, range
+    SliceMap m_sliceMap;
 public:
     explicit AstTypeTable(FileLine* fl) : AstNode(fl) {
 	for (int i=0; i<AstBasicDTypeKwd::_ENUM_MAX; ++i) m_basicps[i] = NULL;
@@ -5359,6 +5471,7 @@ public:
     AstBasicDType* findLogicBitDType(FileLine* fl, AstBasicDTypeKwd kwd,
 				     VNumRange range, int widthMin, AstNumeric numeric);
     AstBasicDType* findInsertSameDType(AstBasicDType* nodep);
+    AstPackArrayDType* findPackArrayDType(FileLine* fl, AstNodeDType* subDTypep, VNumRange range);
     void clearCache();
     void repairCache();
     virtual void dump(ostream& str=cout);
@@ -24,6 +24,10 @@
 //	At each FTASKREF,
 //	   Count calls into the function
 //	Then, if FTASK is called only once, add inline attribute
+//	With --branch-profile, an IF whose counts are lopsided takes its
+//	prediction from the profile instead.
+//	Functions called from _eval (and per clock copies) and _change_request are hot,
+//	as they run every evaluation; the emitter places them together.
 //
 //*************************************************************************
 
@@ -33,10 +37,61 @@
 #include <cstdarg>
 #include <unistd.h>
 #include <map>
+#include <fstream>
+#include <sstream>
+#include <memory>
 
 #include "V3Global.h"
 #include "V3Branch.h"
 #include "V3Ast.h"
+#include "V3File.h"
+#include "V3Stats.h"
+
+//######################################################################
+// Branch profile, as read from --branch-profile
+
+class BranchProfile {
+    // TYPES
+    typedef map<string,pair<double,double> > CountMap;  // Name -> taken, not taken
+    // MEMBERS
+    CountMap	m_counts;	// Counts for each branch name
+    bool	m_read;		// Profile has been read
+public:
+    BranchProfile() : m_read(false) {}
+    static BranchProfile& singleton() {
+	static BranchProfile s_profile;
+	return s_profile;
+    }
+    void readIfNeeded() {
+	if (m_read) return;
+	m_read = true;
+	string filename = v3Global.opt.branchProfile();
+	const VL_UNIQUE_PTR<ifstream> ifp (V3File::new_ifstream_nodepend(filename));
+	if (ifp->fail()) {
+	    v3fatal("Cannot open --branch-profile file: "<<filename);
+	    return;
+	}
+	string line;
+	while (getline(*ifp, line)) {
+	    if (line.compare(0, 7, "branch ") != 0) continue;
+	    istringstream is (line.substr(7));
+	    double taken = 0; double notTaken = 0;
+	    is>>taken>>notTaken>>ws;
+	    string name; getline(is, name);
+	    // Multiple ifs may come from the same line; sum them
+	    m_counts[name].first += taken;
+	    m_counts[name].second += notTaken;
+	}
+    }
+    bool counts(const string& name, double& taken, double& notTaken) {
+	readIfNeeded();
+	CountMap::iterator it = m_counts.find(name);
+	if (it == m_counts.end()) return false;
+	taken = it->second.first;
+	notTaken = it->second.second;
+	return true;
+    }
+};
 
 //######################################################################
 // Branch state, as a visitor of each AstNode
@@ -49,12 +104,17 @@ private:
     AstUser1InUse	m_inuser1;
 
     // TYPES
+    enum { BRANCH_PROFILE_MIN = 16 };	// Fewer executions than this are ignored
     typedef vector<AstCFunc*> CFuncVec;
+    typedef map<AstCFunc*,CFuncVec> CalleeMap;
 
     // STATE
     int		m_likely;	// Excuses for branch likely taken
     int		m_unlikely;	// Excuses for branch likely not taken
     CFuncVec	m_cfuncsp;	// List of all tasks
+    AstCFunc*	m_cfuncp;	// Current function
+    CalleeMap	m_callees;	// Functions called from each function
+    V3Double0	m_statProfiled;	// Statistic tracking
 
     // METHODS
     static int debug() {
@@ -67,6 +127,23 @@ private:
 	m_likely = false;
 	m_unlikely = false;
     }
+    void profilePred(AstNodeIf* nodep) {
+	// Measured behavior beats the heuristic; a branch that goes either way
+	// is better left unhinted
+	double taken = 0; double notTaken = 0;
+	if (!V3Branch::profileCounts(nodep->fileline(), taken, notTaken)) return;
+	double total = taken + notTaken;
+	if (total < BRANCH_PROFILE_MIN) return;
+	if (taken >= total * 0.9) {
+	    nodep->branchPred(AstBranchPred::BP_LIKELY);
+	} else if (taken <= total * 0.1) {
+	    nodep->branchPred(AstBranchPred::BP_UNLIKELY);
+	} else {
+	    nodep->branchPred(AstBranchPred::BP_UNKNOWN);
+	}
+	UINFO(4,"  PROFILE "<<taken<<"/"<<total<<": "<<nodep<<endl);
+	++m_statProfiled;
+    }
     void checkUnlikely(AstNode* nodep) {
 	if (nodep->isUnlikely()) {
 	    UINFO(4,"  UNLIKELY: "<<nodep<<endl);
@@ -97,6 +174,7 @@ private:
 	    } else if (likeness<0) {
 		nodep->branchPred(AstBranchPred::BP_UNLIKELY);
 	    } // else leave unknown
+	    if (v3Global.opt.branchProfile() != "") profilePred(nodep);
 	}
 	m_likely = lastLikely;
 	m_unlikely = lastUnlikely;
@@ -104,12 +182,15 @@ private:
     virtual void visit(AstCCall* nodep) {
 	checkUnlikely(nodep);
 	nodep->funcp()->user1Inc();
+	if (m_cfuncp) m_callees[m_cfuncp].push_back(nodep->funcp());
 	nodep->iterateChildren(*this);
     }
     virtual void visit(AstCFunc* nodep) {
 	checkUnlikely(nodep);
 	m_cfuncsp.push_back(nodep);
+	m_cfuncp = nodep;
 	nodep->iterateChildren(*this);
+	m_cfuncp = NULL;
     }
     virtual void visit(AstNode* nodep) {
 	checkUnlikely(nodep);
@@ -125,15 +206,38 @@ private:
 	    }
 	}
     }
+    void markHot(AstCFunc* nodep) {
+	if (nodep->isHot() || nodep->slow()) return;
+	UINFO(8,"  HOT: "<<nodep<<endl);
+	nodep->isHot(true);
+	CalleeMap::iterator it = m_callees.find(nodep);
+	if (it == m_callees.end()) return;
+	for (CFuncVec::iterator cit=it->second.begin(); cit!=it->second.end(); ++cit) {
+	    markHot(*cit);
+	}
+    }
+    void calc_hot() {
+	for (CFuncVec::iterator it=m_cfuncsp.begin(); it!=m_cfuncsp.end(); ++it) {
+	    AstCFunc* nodep = *it;
+	    if (nodep->name() == "_eval" || nodep->name() == "_change_request"
+		|| nodep->name().compare(0, 7, "_eval__") == 0) {  // --eval-domains
+		markHot(nodep);
+	    }
+	}
+    }
 
 public:
     // CONSTUCTORS
     explicit BranchVisitor(AstNetlist* nodep) {
+	m_cfuncp = NULL;
 	reset();
 	nodep->iterateChildren(*this);
 	calc_tasks();
+	calc_hot();
+    }
+    virtual ~BranchVisitor() {
+	V3Stats::addStat("Optimizations, Branch hints from profile", m_statProfiled);
     }
-    virtual ~BranchVisitor() {}
 };
 
 //######################################################################
@@ -143,3 +247,11 @@ void V3Branch::branchAll(AstNetlist* rootp) {
     UINFO(2,__FUNCTION__<<": "<<endl);
     BranchVisitor visitor (rootp);
 }
+
+string V3Branch::profileName(FileLine* fl) {
+    return fl->filename()+":"+cvtToStr(fl->lineno());
+}
+
+bool V3Branch::profileCounts(FileLine* fl, double& taken, double& notTaken) {
+    return BranchProfile::singleton().counts(profileName(fl), taken, notTaken);
+}
@@ -31,6 +31,11 @@ class V3Branch {
 public:
     // CREATORS
     static void branchAll(AstNetlist* rootp);
+    // METHODS
+    // Name of a branch in --profile-branches output
+    static string profileName(FileLine* fl);
+    // Counts for a branch from --branch-profile, false if none recorded
+    static bool profileCounts(FileLine* fl, double& taken, double& notTaken);
 };
 
 #endif // Guard
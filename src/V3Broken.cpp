@@ -22,6 +22,7 @@
 // Entire netlist
 //	Mark all nodes
 //	Check all links point to marked nodes
+//	Check nodes edited since the last check are consistent
 //
 //*************************************************************************
 
@@ -186,19 +187,14 @@ private:
     // NODE STATE
     //  Nothing!	// This may be called deep inside other routines
     //			// so userp and friends may not be used
-    // METHODS
-    void processAndIterate(AstNode* nodep) {
-	BrokenTable::addInTree(nodep, nodep->maybePointedTo());
-	nodep->iterateChildrenConst(*this);
-    }
     // VISITORS
     virtual void visit(AstNode* nodep) {
-	processAndIterate(nodep);
+	BrokenTable::addInTree(nodep, nodep->maybePointedTo());
     }
 public:
     // CONSTUCTORS
     explicit BrokenMarkVisitor(AstNetlist* nodep) {
-	nodep->accept(*this);
+	nodep->iterateFlat(*this);  // Every node, however deep
     }
     virtual ~BrokenMarkVisitor() {}
 };
@@ -208,6 +204,9 @@ public:
 
 class BrokenCheckVisitor : public AstNVisitor {
 private:
+    // STATE
+    vluint64_t	m_sinceEdit;	// Nodes with editCount() above this changed since last check
+
     void checkWidthMin(AstNode* nodep) {
 	if (nodep->width() != nodep->widthMin()
 	    && v3Global.widthMinUsage()==VWidthMinUsage::MATCHES_WIDTH) {
@@ -216,6 +215,7 @@ private:
     }
     void processAndIterate(AstNode* nodep) {
 	BrokenTable::setUnder(nodep,true);
+	// Links are always checked, as what they point to may have been deleted
 	if (const char* whyp=nodep->broken()) {
 	    nodep->v3fatalSrc("Broken link in node (or something without maybePointedTo): "<<whyp);
 	}
@@ -223,6 +223,12 @@ private:
 	    if (!nodep->dtypep()->brokeExists()) { nodep->v3fatalSrc("Broken link in node->dtypep() to "<<(void*)nodep->dtypep()); }
 	    else if (!nodep->dtypep()->castNodeDType()) { nodep->v3fatalSrc("Non-dtype link in node->dtypep() to "<<(void*)nodep->dtypep()); }
 	}
+	if (nodep->editCount() > m_sinceEdit) checkNode(nodep);
+	nodep->iterateChildrenConst(*this);
+	BrokenTable::setUnder(nodep,false);
+    }
+    void checkNode(AstNode* nodep) {
+	// Checks of the node itself, which only change when it is edited
 	if (v3Global.assertDTypesResolved()) {
 	    if (nodep->hasDType()) {
 		if (!nodep->dtypep()) nodep->v3fatalSrc("No dtype on node with hasDType(): "<<nodep->prettyTypeName());
@@ -233,12 +239,11 @@ private:
 	    if (AstNodeDType* dnodep = nodep->castNodeDType()) checkWidthMin(dnodep);
 	}
 	checkWidthMin(nodep);
-	nodep->iterateChildrenConst(*this);
-	BrokenTable::setUnder(nodep,false);
     }
     virtual void visit(AstNodeAssign* nodep) {
 	processAndIterate(nodep);
 	if (v3Global.assertDTypesResolved()
+	    && nodep->editCount() > m_sinceEdit
 	    && nodep->brokeLhsMustBeLvalue()
 	    && nodep->lhsp()->castNodeVarRef()
 	    && !nodep->lhsp()->castNodeVarRef()->lvalue()) {
@@ -250,7 +255,8 @@ private:
     }
 public:
     // CONSTUCTORS
-    explicit BrokenCheckVisitor(AstNetlist* nodep) {
+    BrokenCheckVisitor(AstNetlist* nodep, vluint64_t sinceEdit) {
+	m_sinceEdit = sinceEdit;
 	nodep->accept(*this);
     }
     virtual ~BrokenCheckVisitor() {}
@@ -259,6 +265,22 @@ public:
 //######################################################################
 // Broken class functions
 
+// State of the last check, to only recheck nodes edited since
+static bool		s_brokenChecked = false;	// Any check done
+static vluint64_t	s_brokenEditCount = 0;		// AstNode::editCountGbl() at last check
+static bool		s_brokenDTypesResolved = false;	// assertDTypesResolved() at last check
+static VWidthMinUsage	s_brokenWidthMinUsage;		// widthMinUsage() at last check
+static int		s_brokenSkipped = 0;		// Changed passes not yet checked
+
+bool V3Broken::checkDue() {
+    if (s_brokenChecked && s_brokenEditCount == AstNode::editCountGbl()) {
+	return false;  // Unchanged since last check
+    }
+    if (++s_brokenSkipped < v3Global.opt.debugCheckSample()) return false;
+    s_brokenSkipped = 0;
+    return true;
+}
+
 void V3Broken::brokenAll(AstNetlist* nodep) {
     //UINFO(9,__FUNCTION__<<": "<<endl);
     static bool inBroken = false;
@@ -267,10 +289,20 @@ void V3Broken::brokenAll(AstNetlist* nodep) {
 	UINFO(1,"Broken called under broken, skipping recursion.\n");
     } else {
 	inBroken = true;
+	// Node checks depend on these global states; if changed recheck everything
+	bool incremental = (s_brokenChecked
+			    && s_brokenDTypesResolved == v3Global.assertDTypesResolved()
+			    && s_brokenWidthMinUsage == v3Global.widthMinUsage());
+	vluint64_t sinceEdit = incremental ? s_brokenEditCount : 0;
+	UINFO(9,"Broken check, nodes edited after <e"<<sinceEdit<<">"<<endl);
 	BrokenTable::prepForTree();
 	BrokenMarkVisitor mvisitor (nodep);
-	BrokenCheckVisitor cvisitor (nodep);
+	BrokenCheckVisitor cvisitor (nodep, sinceEdit);
 	BrokenTable::doneWithTree();
+	s_brokenChecked = true;
+	s_brokenEditCount = AstNode::editCountGbl();
+	s_brokenDTypesResolved = v3Global.assertDTypesResolved();
+	s_brokenWidthMinUsage = v3Global.widthMinUsage();
 	inBroken = false;
     }
 }
@@ -30,6 +30,7 @@
 class V3Broken {
 public:
     static void brokenAll(AstNetlist* nodep);
+    static bool checkDue();	// Tree changed, and check due per --debug-check-sample
     static void addNewed(AstNode* nodep);
     static void deleted(AstNode* nodep);
 };
@@ -28,9 +28,13 @@
 //						    (other items))
 //						body
 //		Or, converts to a if/else tree.
+//	    Narrow complete cases become a tree of IFs on each bit.
+//	    Wider cases of many unmasked constants (decoders, address muxes)
+//		Sort by value and make a balanced tree of < compares,
+//		with a short chain of == compares at each leaf.
+//	    With --branch-profile, items of distinct constants are tested
+//		most frequently taken first.
 //	FUTURES:
-//	    Large 16+ bit tables with constants and no masking (address muxes)
-//		Enter all into multimap, sort by value and use a tree of < and == compares.
 //	    "Diagonal" find of {rightmost,leftmost} bit {set,clear}
 //		Ignoring mask, check each value is unique (using multimap as above?)
 //		Each branch is then mask-and-compare operation (IE <000000001_000000000 at midpoint.)
@@ -43,15 +47,22 @@
 #include <cstdarg>
 #include <unistd.h>
 #include <algorithm>
+#include <vector>
+#include <map>
+#include <set>
 
 #include "V3Global.h"
 #include "V3Case.h"
 #include "V3Ast.h"
 #include "V3Stats.h"
+#include "V3Branch.h"
 
 #define CASE_OVERLAP_WIDTH 12		// Maximum width we can check for overlaps in
 #define CASE_BARF	   999999	// Magic width when non-constant
 #define CASE_ENCODER_GROUP_DEPTH 8	// Levels of priority to be ORed together in top IF tree
+#define CASE_BINARY_MIN_VALUES 8	// Fewest values to search as a binary tree
+#define CASE_BINARY_LEAF_RUNS 3		// Most runs compared in order at a binary tree leaf
+#define CASE_BINARY_GROWTH 2		// Most growth in statements from cloning bodies
 
 //######################################################################
 
@@ -122,6 +133,24 @@ public:
 //######################################################################
 // Case state, as a visitor of each AstNode
 
+class CaseCountVisitor : public AstNVisitor {
+private:
+    int		m_count;	// Number of nodes
+    virtual void visit(AstNode* nodep) {
+	m_count++;
+	nodep->iterateChildren(*this);
+    }
+public:
+    explicit CaseCountVisitor(AstNode* nodep) {
+	m_count = 0;
+	if (nodep) nodep->iterateAndNext(*this);
+    }
+    virtual ~CaseCountVisitor() {}
+    int count() const { return m_count; }
+};
+
+//######################################################################
+
 class CaseVisitor : public AstNVisitor {
 private:
     // NODE STATE
@@ -132,12 +161,24 @@ private:
     // STATE
     V3Double0	m_statCaseFast;	// Statistic tracking
     V3Double0	m_statCaseSlow;	// Statistic tracking
+    V3Double0	m_statCaseBinary;	// Statistic tracking
+    V3Double0	m_statCaseProfiled;	// Statistic tracking
+
+    // TYPES
+    struct CaseRun {
+	// Consecutive sorted values selecting the same item
+	vector<AstConst*> m_constps;	// Values, ascending
+	AstCaseItem*	m_itemp;	// Item selected
+	explicit CaseRun(AstCaseItem* itemp) : m_itemp(itemp) {}
+    };
 
     // Per-CASE
     int		m_caseWidth;	// Width of valueItems
     int		m_caseItems;	// Number of caseItem unique values
     bool	m_caseNoOverlapsAllCovered;	// Proven to be synopsys parallel_case compliant
     AstNode*	m_valueItem[1<<CASE_OVERLAP_WIDTH];  // For each possible value, the case branch we need
+    vector<CaseRun>	m_caseRuns;	// For binary trees, runs of values in ascending order
+    AstCaseItem*	m_caseDefaultp;	// For binary trees, default item or NULL
 
     // METHODS
     static int debug() {
@@ -300,11 +341,154 @@ private:
 	if (debug()>=9) ifrootp->dumpTree(cout,"    _simp: ");
     }
 
+    bool isCaseBinary(AstCase* nodep) {
+	// Many constants without masks, too wide or incomplete for a bit tree
+	AstNode* cexprp = nodep->exprp();
+	m_caseRuns.clear();
+	m_caseDefaultp = NULL;
+	if (cexprp->width() > 64 || cexprp->isDouble() || cexprp->isString()) return false;
+	typedef map<vluint64_t,pair<AstConst*,AstCaseItem*> > ValueMap;
+	ValueMap values;
+	for (AstCaseItem* itemp = nodep->itemsp(); itemp; itemp=itemp->nextp()->castCaseItem()) {
+	    if (itemp->isDefault()) {
+		if (!m_caseDefaultp) m_caseDefaultp = itemp;
+		continue;
+	    }
+	    for (AstNode* icondp = itemp->condsp(); icondp!=NULL; icondp=icondp->nextp()) {
+		AstConst* iconstp = icondp->castConst();
+		if (!iconstp || iconstp->width() != cexprp->width()) return false;
+		if (neverItem(nodep, iconstp)) continue;
+		if (iconstp->num().isFourState()) return false;	// Masked casex/casez item
+		// Earlier items have priority over overlapping later ones
+		values.insert(make_pair(iconstp->num().toUQuad(), make_pair(iconstp, itemp)));
+	    }
+	}
+	if (values.size() < CASE_BINARY_MIN_VALUES) return false;
+	for (ValueMap::iterator it = values.begin(); it != values.end(); ++it) {
+	    if (m_caseRuns.empty() || m_caseRuns.back().m_itemp != it->second.second) {
+		m_caseRuns.push_back(CaseRun(it->second.second));
+	    }
+	    m_caseRuns.back().m_constps.push_back(it->second.first);
+	}
+	// Bodies selected by several runs, and the default at every leaf, are cloned;
+	// don't let that grow the code too much
+	map<AstCaseItem*,int> itemCounts;
+	int origCount = 0;
+	for (AstCaseItem* itemp = nodep->itemsp(); itemp; itemp=itemp->nextp()->castCaseItem()) {
+	    int count = CaseCountVisitor(itemp->bodysp()).count();
+	    itemCounts[itemp] = count;
+	    origCount += count;
+	}
+	int newCount = 0;
+	for (vector<CaseRun>::iterator it = m_caseRuns.begin(); it != m_caseRuns.end(); ++it) {
+	    newCount += itemCounts[it->m_itemp];
+	}
+	int leaves = (m_caseRuns.size() + CASE_BINARY_LEAF_RUNS - 1) / CASE_BINARY_LEAF_RUNS;
+	if (m_caseDefaultp) newCount += leaves * itemCounts[m_caseDefaultp];
+	if (newCount > CASE_BINARY_GROWTH * origCount + CASE_BINARY_MIN_VALUES) {
+	    UINFO(8,"Binary case would grow too much: "<<nodep<<endl);
+	    return false;
+	}
+	UINFO(8,"Binary case statement: "<<nodep<<endl);
+	return true;
+    }
+
+    AstNode* replaceCaseBinaryRecurse(AstNode* cexprp, int lo, int hi) {
+	// Tree selecting among runs [lo,hi)
+	FileLine* fl = cexprp->fileline();
+	if (hi - lo > CASE_BINARY_LEAF_RUNS) {
+	    // IF (cexpr < first value of middle run, lower half, upper half)
+	    int mid = lo + (hi - lo) / 2;
+	    AstNode* midp = m_caseRuns[mid].m_constps[0]->cloneTree(false);
+	    AstIf* ifp = new AstIf(fl, new AstLt(fl, cexprp->cloneTree(false), midp),
+				   replaceCaseBinaryRecurse(cexprp, lo, mid),
+				   replaceCaseBinaryRecurse(cexprp, mid, hi));
+	    return ifp;
+	}
+	// Leaf: IF (cexpr == run values, body, IF (... , default))
+	AstNode* elsep = NULL;
+	if (m_caseDefaultp && m_caseDefaultp->bodysp()) {
+	    elsep = m_caseDefaultp->bodysp()->cloneTree(true);
+	}
+	for (int run = hi-1; run >= lo; --run) {
+	    AstNode* condp = NULL;
+	    for (vector<AstConst*>::iterator it = m_caseRuns[run].m_constps.begin();
+		 it != m_caseRuns[run].m_constps.end(); ++it) {
+		AstNode* eqp = AstEq::newTyped(fl, cexprp->cloneTree(false), (*it)->cloneTree(false));
+		condp = condp ? new AstLogOr(fl, condp, eqp) : eqp;
+	    }
+	    AstNode* bodysp = m_caseRuns[run].m_itemp->bodysp();
+	    if (bodysp) bodysp = bodysp->cloneTree(true);
+	    elsep = new AstIf(fl, condp, bodysp, elsep);
+	}
+	return elsep;
+    }
+
+    void replaceCaseBinary(AstCase* nodep) {
+	// CASE(cexpr, values...)
+	// ->  IF(cexpr < v_mid, IF(cexpr < v_low_mid, ...),
+	//                       IF(cexpr < v_high_mid, ...))
+	// with leaves IF(cexpr == v, istmts, IF(cexpr == v2, ... default))
+	AstNode* cexprp = nodep->exprp()->unlinkFrBack();
+	// Handle any assertions
+	replaceCaseParallel(nodep, false);
+	AstNode* ifrootp = replaceCaseBinaryRecurse(cexprp, 0, m_caseRuns.size());
+	m_caseRuns.clear();
+	m_caseDefaultp = NULL;
+	if (ifrootp) nodep->replaceWith(ifrootp);
+	else nodep->unlinkFrBack();
+	nodep->deleteTree(); VL_DANGLING(nodep);
+	cexprp->deleteTree(); VL_DANGLING(cexprp);
+	if (debug()>=9 && ifrootp) ifrootp->dumpTree(cout,"    _bin: ");
+    }
+
+    static bool profileCountGreater(const pair<double,AstCaseItem*>& lhs,
+				    const pair<double,AstCaseItem*>& rhs) {
+	return lhs.first > rhs.first;
+    }
+    void orderByProfile(AstCase* nodep) {
+	// The IFs built below test items in order, so test the most common first.
+	// Only legal when at most one item can match, so every item must be
+	// distinct two-state constants, and any default must already be last.
+	set<string> values;
+	vector<pair<double,AstCaseItem*> > items;
+	for (AstCaseItem* itemp = nodep->itemsp(); itemp; itemp=itemp->nextp()->castCaseItem()) {
+	    if (!itemp->condsp()) {
+		if (itemp->nextp()) return;
+		continue;
+	    }
+	    for (AstNode* icondp = itemp->condsp(); icondp!=NULL; icondp=icondp->nextp()) {
+		AstConst* iconstp = icondp->castConst();
+		if (!iconstp || iconstp->num().isFourState()) return;
+		if (!values.insert(iconstp->num().ascii(false)).second) return;
+	    }
+	    double taken = 0; double notTaken = 0;
+	    V3Branch::profileCounts(itemp->fileline(), taken, notTaken);
+	    items.push_back(make_pair(taken, itemp));
+	}
+	stable_sort(items.begin(), items.end(), profileCountGreater);
+	bool reordered = false;
+	AstCaseItem* expectp = nodep->itemsp();
+	for (size_t i=0; i<items.size(); ++i) {
+	    if (items[i].second != expectp) reordered = true;
+	    expectp = expectp->nextp()->castCaseItem();
+	}
+	if (!reordered) return;
+	UINFO(8,"  Profile ordered: "<<nodep<<endl);
+	++m_statCaseProfiled;
+	AstCaseItem* defaultp = NULL;
+	if (expectp) defaultp = expectp->unlinkFrBack()->castCaseItem();  // Default is left over
+	for (size_t i=0; i<items.size(); ++i) items[i].second->unlinkFrBack();
+	for (size_t i=0; i<items.size(); ++i) nodep->addItemsp(items[i].second);
+	if (defaultp) nodep->addItemsp(defaultp);
+    }
+
     void replaceCaseComplicated(AstCase* nodep) {
 	// CASEx(cexpr,ITEM(icond1,istmts1),ITEM(icond2,istmts2),ITEM(default,istmts3))
 	// ->  IF((cexpr==icond1),istmts1,
 	//		         IF((EQ (AND MASK cexpr) (AND MASK icond1)
 	//				,istmts2, istmts3
+	if (v3Global.opt.branchProfile() != "") orderByProfile(nodep);
 	AstNode* cexprp = nodep->exprp()->unlinkFrBack();
 	// We'll do this in two stages.  First stage, convert the conditions to
 	// the appropriate IF AND terms.
@@ -381,8 +565,7 @@ private:
 	// Now build the IF statement tree
 	// The tree can be quite huge.  Pull ever group of 8 out, and make a OR tree.
 	// This reduces the depth for the bottom elements, at the cost of some of the top elements.
-	// If we ever have profiling data, we should pull out the most common item from here and
-	// instead make it the first IF branch.
+	// With profiling data, orderByProfile has already put the most common items first.
 	int depth = 0;
 	AstNode* grouprootp = NULL;
 	AstIf* groupnextp = NULL;
@@ -460,6 +643,11 @@ private:
 	    // we can make a tree of statements to avoid extra comparisons
 	    ++m_statCaseFast;
 	    replaceCaseFast(nodep); VL_DANGLING(nodep);
+	} else if (v3Global.opt.oCase() && isCaseBinary(nodep)) {
+	    // Sparse or wide selection among constants;
+	    // search the sorted values rather than compare each in turn
+	    ++m_statCaseBinary;
+	    replaceCaseBinary(nodep); VL_DANGLING(nodep);
 	} else {
 	    ++m_statCaseSlow;
 	    replaceCaseComplicated(nodep); VL_DANGLING(nodep);
@@ -475,11 +663,14 @@ public:
     // CONSTUCTORS
     explicit CaseVisitor(AstNetlist* nodep) {
 	m_caseNoOverlapsAllCovered = false;
+	m_caseDefaultp = NULL;
 	nodep->accept(*this);
     }
     virtual ~CaseVisitor() {
 	V3Stats::addStat("Optimizations, Cases parallelized", m_statCaseFast);
 	V3Stats::addStat("Optimizations, Cases complex", m_statCaseSlow);
+	V3Stats::addStat("Optimizations, Cases binary searched", m_statCaseBinary);
+	V3Stats::addStat("Optimizations, Cases ordered by profile", m_statCaseProfiled);
     }
 };
 
@@ -35,6 +35,7 @@
 #include <vector>
 #include <deque>
 #include <list>
+#include <map>
 #include <memory>
 
 #include "V3Global.h"
@@ -62,6 +63,9 @@ public:
 // Graph support classes
 
 class CdcEitherVertex : public V3GraphVertex {
+public:
+    enum AsyncCone { CONE_UNKNOWN, CONE_VISITING, CONE_SAFE, CONE_HAZARD };
+private:
     AstScope*	m_scopep;
     AstNode*	m_nodep;
     AstSenTree*	m_srcDomainp;
@@ -69,12 +73,14 @@ class CdcEitherVertex : public V3GraphVertex {
     bool	m_srcDomainSet:1;
     bool	m_dstDomainSet:1;
     bool	m_asyncPath:1;
+    AsyncCone	m_asyncCone;	// Whether fanin has hazards, as found by asyncConeHazard
+    int		m_asyncDepth;	// Depth in asyncConeHazard's walk, while CONE_VISITING
 public:
     CdcEitherVertex(V3Graph* graphp, AstScope* scopep, AstNode* nodep)
 	: V3GraphVertex(graphp), m_scopep(scopep), m_nodep(nodep)
 	, m_srcDomainp(NULL), m_dstDomainp(NULL)
 	, m_srcDomainSet(false), m_dstDomainSet(false)
-	, m_asyncPath(false) {}
+	, m_asyncPath(false), m_asyncCone(CONE_UNKNOWN), m_asyncDepth(0) {}
     virtual ~CdcEitherVertex() {}
     // Accessors
     AstScope* scopep() const { return m_scopep; }
@@ -89,6 +95,10 @@ public:
     void dstDomainSet(bool flag) { m_dstDomainSet = flag; }
     bool asyncPath() const { return m_asyncPath; }
     void asyncPath(bool flag) { m_asyncPath = flag; }
+    AsyncCone asyncCone() const { return m_asyncCone; }
+    void asyncCone(AsyncCone state) { m_asyncCone = state; }
+    int asyncDepth() const { return m_asyncDepth; }
+    void asyncDepth(int depth) { m_asyncDepth = depth; }
 };
 
 class CdcVarVertex : public CdcEitherVertex {
@@ -229,6 +239,14 @@ private:
     uint32_t		m_userGeneration; // Generation count to avoid slow userClearVertices
     int			m_filelineWidth;  // Characters in longest fileline
 
+    // Domains, for edgeReport; each set of domains is merged into one sentree only once
+    typedef vector<bool> DomainBits;	// Bit per base domain, without trailing zeros
+    map<AstSenTree*,DomainBits> m_domainBits;	// Bits of each base or merged domain
+    map<DomainBits,AstSenTree*> m_domainMerged;	// Merged domain of each set of bases
+    vector<AstSenTree*>	m_domainBases;	// Base domain of each bit
+    vector<AstSenTree*>	m_domainNewps;	// Domains created here, to delete
+    AstSenTree*		m_comboDomainp;	// Domain of primary inputs
+
     // METHODS
     void iterateNewStmt(AstNode* nodep) {
 	if (m_scopep) {
@@ -340,7 +358,9 @@ private:
 	m_graph.userClearVertices();  // user1: uint32_t - was analyzed generation
 	for (V3GraphVertex* itp = m_graph.verticesBeginp(); itp; itp=itp->verticesNextp()) {
 	    if (CdcVarVertex* vvertexp = dynamic_cast<CdcVarVertex*>(itp)) {
-		if (vvertexp->cntAsyncRst()) {
+		int low = 0;
+		if (vvertexp->cntAsyncRst()
+		    && asyncConeHazard(vvertexp, 0, low)) {  // Else known clean, skip the walks
 		    m_userGeneration++;  // Effectively a userClearVertices()
 		    UINFO(8, "   Trace One async: "<<vvertexp<<endl);
 		    // Twice, as we need to detect, then propagate
@@ -357,6 +377,49 @@ private:
 	}
     }
 
+    bool asyncConeHazard(CdcEitherVertex* vertexp, int depth, int& lowr) {
+	// Return if traceAsyncRecurse may find a hazard, remembering the answer
+	// for each vertex so cones shared by many resets are walked once.
+	// A vertex on a loop back to one still being visited isn't finished
+	// until that one is, so it's left unknown.  Hazards only get cleared,
+	// so a remembered CONE_HAZARD just means the full walk finds nothing.
+	switch (vertexp->asyncCone()) {
+	case CdcEitherVertex::CONE_SAFE: return false;
+	case CdcEitherVertex::CONE_HAZARD: return true;
+	case CdcEitherVertex::CONE_VISITING:
+	    lowr = min(lowr, vertexp->asyncDepth());
+	    return false;
+	default: break;
+	}
+	vertexp->asyncCone(CdcEitherVertex::CONE_VISITING);
+	vertexp->asyncDepth(depth);
+	bool hazard = false;
+	int low = depth;
+	CdcLogicVertex* lvertexp = dynamic_cast<CdcLogicVertex*>(vertexp);
+	CdcVarVertex* vvertexp = dynamic_cast<CdcVarVertex*>(vertexp);
+	if (lvertexp && lvertexp->hazard()) {
+	    hazard = true;
+	} else if (vvertexp && (vvertexp->varScp()->varp()->isPrimaryIn() || vvertexp->fromFlop())) {
+	    // Stops here, as in traceAsyncRecurse
+	} else {
+	    for (V3GraphEdge* edgep = vertexp->inBeginp(); edgep; edgep = edgep->inNextp()) {
+		if (asyncConeHazard((CdcEitherVertex*)edgep->fromp(), depth+1, low)) {
+		    hazard = true;
+		    break;
+		}
+	    }
+	}
+	if (hazard) {
+	    vertexp->asyncCone(CdcEitherVertex::CONE_HAZARD);
+	} else if (low >= depth) {
+	    vertexp->asyncCone(CdcEitherVertex::CONE_SAFE);
+	} else {
+	    vertexp->asyncCone(CdcEitherVertex::CONE_UNKNOWN);
+	    lowr = min(lowr, low);
+	}
+	return hazard;
+    }
+
     CdcEitherVertex* traceAsyncRecurse(CdcEitherVertex* vertexp, bool mark) {
 	// First pass: Return vertex of any hazardous stuff attached, or NULL if OK
 	// If first pass returns true, second pass calls asyncPath() on appropriate nodes
@@ -532,6 +595,36 @@ private:
 	}
     }
 
+    const DomainBits& domainBits(AstSenTree* sentreep) {
+	// Bits of a domain, making it a new base domain if not seen before
+	map<AstSenTree*,DomainBits>::iterator it = m_domainBits.find(sentreep);
+	if (it == m_domainBits.end()) {
+	    DomainBits bits (m_domainBases.size()+1, false);
+	    bits.back() = true;
+	    m_domainBases.push_back(sentreep);
+	    m_domainMerged.insert(make_pair(bits, sentreep));
+	    it = m_domainBits.insert(make_pair(sentreep, bits)).first;
+	}
+	return it->second;
+    }
+    AstSenTree* domainMerged(const DomainBits& bits) {
+	// One sentree for a set of base domains, combining them the first time
+	map<DomainBits,AstSenTree*>::iterator it = m_domainMerged.find(bits);
+	if (it != m_domainMerged.end()) return it->second;
+	AstSenTree* senoutp = NULL;
+	for (size_t i=0; i<bits.size(); ++i) {
+	    if (!bits[i]) continue;
+	    if (!senoutp) senoutp = m_domainBases[i]->cloneTree(true);
+	    else senoutp->addSensesp(m_domainBases[i]->sensesp()->cloneTree(true));
+	}
+	// Multiple domains need complicated optimizations
+	senoutp = V3Const::constifyExpensiveEdit(senoutp)->castSenTree();
+	m_domainNewps.push_back(senoutp);
+	m_domainBits.insert(make_pair(senoutp, bits));
+	m_domainMerged.insert(make_pair(bits, senoutp));
+	return senoutp;
+    }
+
     void edgeDomainRecurse(CdcEitherVertex* vertexp, bool traceDests, int level) {
 	// Scan back to inputs/outputs, flops, and compute clock domain information
 	UINFO(8,spaces(level)<<"     Tracein  "<<vertexp<<endl);
@@ -550,7 +643,11 @@ private:
 	    // If primary I/O, give it domain of the input
 	    AstVar* varp = vvertexp->varScp()->varp();
 	    if (varp->isPrimaryIO() && varp->isInput() && !traceDests) {
-		senouts.insert(new AstSenTree(varp->fileline(), new AstSenItem(varp->fileline(), AstSenItem::Combo())));
+		if (!m_comboDomainp) {
+		    m_comboDomainp = new AstSenTree(varp->fileline(), new AstSenItem(varp->fileline(), AstSenItem::Combo()));
+		    m_domainNewps.push_back(m_comboDomainp);
+		}
+		senouts.insert(m_comboDomainp);
 	    }
 	}
 
@@ -571,20 +668,16 @@ private:
 
 	// Convert list of senses into one sense node
 	AstSenTree* senoutp = NULL;
-	bool	    senedited = false;
-	for (SenSet::iterator it=senouts.begin(); it!=senouts.end(); ++it) {
-	    if (!senoutp) senoutp = *it;
-	    else {
-		if (!senedited) {
-		    senedited = true;
-		    senoutp = senoutp->cloneTree(true);
-		}
-		senoutp->addSensesp((*it)->sensesp()->cloneTree(true));
+	if (senouts.size() == 1) {
+	    senoutp = *senouts.begin();
+	} else if (!senouts.empty()) {
+	    DomainBits bits;
+	    for (SenSet::iterator it=senouts.begin(); it!=senouts.end(); ++it) {
+		const DomainBits& addBits = domainBits(*it);
+		if (bits.size() < addBits.size()) bits.resize(addBits.size(), false);
+		for (size_t i=0; i<addBits.size(); ++i) if (addBits[i]) bits[i] = true;
 	    }
-	}
-	// If multiple domains need to do complicated optimizations
-	if (senedited) {
-	    senoutp = V3Const::constifyExpensiveEdit(senoutp)->castSenTree();
+	    senoutp = domainMerged(bits);
 	}
 	if (traceDests) {
 	    vertexp->dstDomainSet(true);  // Note it's set - domainp may be null, so can't use that
@@ -735,6 +828,7 @@ public:
 	m_inSenItem = 0;
 	m_userGeneration = 0;
 	m_filelineWidth = 0;
+	m_comboDomainp = NULL;
 
 	// Make report of all signal names and what clock edges they have
 	string filename = v3Global.opt.makeDir()+"/"+v3Global.opt.prefix()+"__cdc.txt";
@@ -755,6 +849,9 @@ public:
     }
     virtual ~CdcVisitor() {
 	if (m_ofp) { delete m_ofp; m_ofp = NULL; }
+	for (vector<AstSenTree*>::iterator it = m_domainNewps.begin(); it != m_domainNewps.end(); ++it) {
+	    (*it)->deleteTree();
+	}
     }
 };
 
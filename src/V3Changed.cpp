@@ -90,9 +90,14 @@ public:
 		// This is currently using AstLogOr which will shortcut the evaluation if
 		// any function returns true. This is likely what we want and is similar to the logic already in use
 		// inside V3EmitC, however, it also means that verbose logging may miss to print change detect variables.
-		AstNode* newp = new AstCReturn(m_scopetopp->fileline(),
-					       new AstLogOr(m_scopetopp->fileline(), callp,
-							    returnp->lhsp()->unlinkFrBack()));
+		// With --profile-converge every function is called, so each changed variable is counted.
+		AstNode* orp;
+		if (v3Global.opt.profileConverge()) {
+		    orp = new AstOr(m_scopetopp->fileline(), callp, returnp->lhsp()->unlinkFrBack());
+		} else {
+		    orp = new AstLogOr(m_scopetopp->fileline(), callp, returnp->lhsp()->unlinkFrBack());
+		}
+		AstNode* newp = new AstCReturn(m_scopetopp->fileline(), orp);
 		returnp->replaceWith(newp);
 		returnp->deleteTree(); VL_DANGLING(returnp);
 	    }
@@ -22,6 +22,9 @@
 // Each module:
 //	For each math operator, if it requires a clean operand,
 //	and the operand is dirty, insert a CLEAN node.
+//	An operator's output is also clean if its operands' significant
+//	bits show its upper bits must be zero, e.g. adding two zero
+//	extended values.
 //	Resize operands to C++ 32/64/wide types.
 //	Copy all width() values to widthMin() so RANGE, etc can still see orig widths
 //
@@ -37,6 +40,7 @@
 #include "V3Global.h"
 #include "V3Clean.h"
 #include "V3Ast.h"
+#include "V3Stats.h"
 
 //######################################################################
 // Clean state, as a visitor of each AstNode
@@ -48,15 +52,18 @@ private:
     //  AstNode::user()		-> CleanState.  For this node, 0==UNKNOWN
     //  AstNode::user2()	-> bool.  True indicates widthMin has been propagated
     //  AstNodeDType::user3()	-> AstNodeDType*.  Alternative node with C size
+    //  AstNode::user4()	-> int.  Significant bits+1, bits above may only be zero.  0=unknown
     AstUser1InUse	m_inuser1;
     AstUser2InUse	m_inuser2;
     AstUser3InUse	m_inuser3;
+    AstUser4InUse	m_inuser4;
 
     // TYPES
     enum CleanState { CS_UNKNOWN, CS_CLEAN, CS_DIRTY };
 
     // STATE
     AstNodeModule* m_modp;
+    V3Double0	m_statCleanBits;	// Statistic tracking
 
     // METHODS
     static int debug() {
@@ -114,9 +121,34 @@ private:
     void setClean(AstNode* nodep, bool isClean) {
 	computeCppWidth (nodep);  // Just to be sure it's in widthMin
 	bool wholeUint = ((nodep->widthMin() % VL_WORDSIZE) == 0);  //32,64,...
+	if (!isClean && !wholeUint && sigBits(nodep) <= nodep->widthMin()) {
+	    UINFO(9,"  CleanBySigBits "<<nodep<<endl);
+	    ++m_statCleanBits;
+	    isClean = true;
+	}
 	setCleanState(nodep, ((isClean||wholeUint) ? CS_CLEAN:CS_DIRTY));
     }
 
+    // Significant bits: bits above may only be zero, even in the C++ storage
+    int sigBits(AstNode* nodep) {
+	if (nodep->user4()) return nodep->user4()-1;
+	if (AstConst* constp = nodep->castConst()) {
+	    if (!constp->num().isFourState()) return constp->num().mostSetBitP1();
+	}
+	if (nodep->user1() && isClean(nodep)) return nodep->widthMin();
+	return nodep->width();  // Dirty, so anything in the C++ storage
+    }
+    void setSigBits(AstNode* nodep, int bits) {
+	// Called before setClean, so its state can use this
+	nodep->user4(std::min(bits, nodep->width()) + 1);
+    }
+    int constShift(AstNodeBiop* nodep) {
+	AstConst* constp = nodep->rhsp()->castConst();
+	if (!constp || constp->num().isFourState()
+	    || constp->num().mostSetBitP1() > 16) return -1;
+	return constp->num().toUInt();
+    }
+
     // Operate on nodes
     void insertClean(AstNode* nodep) {  // We'll insert ABOVE passed node
 	UINFO(4,"  NeedClean "<<nodep<<endl);
@@ -192,16 +224,49 @@ private:
     }
     virtual void visit(AstAnd* nodep) {
 	operandBiop(nodep);
+	setSigBits(nodep, std::min(sigBits(nodep->lhsp()), sigBits(nodep->rhsp())));
 	setClean (nodep, isClean(nodep->lhsp()) || isClean(nodep->rhsp()));
     }
     virtual void visit(AstXor* nodep) {
 	operandBiop(nodep);
+	setSigBits(nodep, std::max(sigBits(nodep->lhsp()), sigBits(nodep->rhsp())));
 	setClean (nodep, isClean(nodep->lhsp()) && isClean(nodep->rhsp()));
     }
     virtual void visit(AstOr* nodep) {
 	operandBiop(nodep);
+	setSigBits(nodep, std::max(sigBits(nodep->lhsp()), sigBits(nodep->rhsp())));
 	setClean (nodep, isClean(nodep->lhsp()) && isClean(nodep->rhsp()));
     }
+    virtual void visit(AstAdd* nodep) {
+	operandBiop(nodep);
+	// A carry adds at most one bit
+	setSigBits(nodep, std::max(sigBits(nodep->lhsp()), sigBits(nodep->rhsp())) + 1);
+	setClean (nodep, nodep->cleanOut());
+    }
+    virtual void visit(AstMul* nodep) {
+	operandBiop(nodep);
+	setSigBits(nodep, sigBits(nodep->lhsp()) + sigBits(nodep->rhsp()));
+	setClean (nodep, nodep->cleanOut());
+    }
+    virtual void visit(AstShiftL* nodep) {
+	operandBiop(nodep);
+	int shift = constShift(nodep);
+	if (shift >= 0) setSigBits(nodep, sigBits(nodep->lhsp()) + shift);
+	setClean (nodep, nodep->cleanOut());
+    }
+    virtual void visit(AstShiftR* nodep) {
+	operandBiop(nodep);
+	int shift = constShift(nodep);
+	if (shift >= 0) setSigBits(nodep, std::max(0, sigBits(nodep->lhsp()) - shift));
+	setClean (nodep, nodep->cleanOut());
+    }
+    virtual void visit(AstExtend* nodep) {
+	nodep->iterateChildren(*this);
+	computeCppWidth(nodep);
+	insureClean(nodep->lhsp());
+	setSigBits(nodep, sigBits(nodep->lhsp()));
+	setClean (nodep, nodep->cleanOut());
+    }
     virtual void visit(AstNodeMath* nodep) {
 	nodep->iterateChildren(*this);
 	computeCppWidth(nodep);
@@ -251,6 +316,7 @@ private:
     virtual void visit(AstNodeCond* nodep) {
 	nodep->iterateChildren(*this);
 	insureClean(nodep->condp());
+	setSigBits(nodep, std::max(sigBits(nodep->expr1p()), sigBits(nodep->expr2p())));
 	setClean(nodep, isClean(nodep->expr1p()) && isClean(nodep->expr2p()));
     }
     virtual void visit(AstWhile* nodep) {
@@ -288,7 +354,9 @@ public:
     explicit CleanVisitor(AstNetlist* nodep) {
 	nodep->accept(*this);
     }
-    virtual ~CleanVisitor() {}
+    virtual ~CleanVisitor() {
+	V3Stats::addStat("Optimizations, Clean by significant bits", m_statCleanBits);
+    }
 };
 
 //######################################################################
@@ -29,6 +29,22 @@
 //		Replace UNTILSTABLEs with loops until specified signals become const.
 //   Create global calling function for any per-scope functions.  (For FINALs).
 //
+// V3Clock's domains transformations (--eval-domains):
+//   For each edge of a top level input clock tested at the top of _eval
+//	Form _eval__{edge}__{clock}, a copy of _eval without the
+//	sensitivity IFs that only test other top level input clocks
+//
+// V3Clock's sparse transformations (--eval-sparse):
+//   For each combo call at the top of _eval
+//	Wrap in IF(any statement before it writing what it reads ran
+//		   || any top level input it reads changed)
+//
+// V3Clock's reset transformations:
+//   Find top level inputs used as async resets, read under a sensitivity IF
+//	shared with another clock
+//   Move the _eval body to _eval_resets, called only when a reset changed
+//	Else run a copy of it with the reset edges removed from the IFs
+//
 //*************************************************************************
 
 #include "config_build.h"
@@ -37,11 +53,15 @@
 #include <cstdarg>
 #include <unistd.h>
 #include <algorithm>
+#include <map>
+#include <set>
+#include <vector>
 
 #include "V3Global.h"
 #include "V3Clock.h"
 #include "V3Ast.h"
 #include "V3EmitCBase.h"
+#include "V3Stats.h"
 
 //######################################################################
 // Clock state, as a visitor of each AstNode
@@ -71,6 +91,8 @@ private:
     AstSenTree*		m_lastSenp;	// Last sensitivity match, so we can detect duplicates.
     AstIf*		m_lastIfp;	// Last sensitivity if active to add more under
     int			m_stableNum;	// Number of each untilstable
+    V3Double0		m_statToggleGroups;	// Statistic tracking
+    V3Double0		m_statToggleGroupBits;	// Statistic tracking
 
     // METHODS
     static int debug() {
@@ -274,6 +296,13 @@ private:
 	    stmtsp->unlinkFrBackWithNext();
 	    cmtp->addNextHere(stmtsp);
 	}
+	if (v3Global.opt.profileActivity()) {
+	    // Count entries to this instance's block
+	    cmtp->addNextHere(new AstActivityInc(nodep->fileline(),
+						 m_scopep->modp()->prettyName()+" "+m_scopep->prettyName()
+						 +" "+nodep->fileline()->filename()
+						 +":"+cvtToStr(nodep->fileline()->lineno())));
+	}
 	nodep->deleteTree(); VL_DANGLING(nodep);
     }
     virtual void visit(AstAlwaysPost* nodep) {
@@ -285,8 +314,7 @@ private:
 	}
 	nodep->deleteTree(); VL_DANGLING(nodep);
     }
-    virtual void visit(AstCoverToggle* nodep) {
-	//nodep->dumpTree(cout,"ct:");
+    AstIf* makeToggleIf(AstCoverToggle* nodep) {
 	//COVERTOGGLE(INC, ORIG, CHANGE) ->
 	//   IF(ORIG ^ CHANGE) { INC; CHANGE = ORIG; }
 	AstNode* incp = nodep->incp()->unlinkFrBack();
@@ -303,6 +331,67 @@ private:
 	newp->addIfsp(new AstAssign(nodep->fileline(),
 				    changep->cloneTree(false),
 				    origp->cloneTree(false)));
+	return newp;
+    }
+    static bool toggleBitSel(AstCoverToggle* nodep, AstNode*& origFromp, AstNode*& changeFromp, int& lsb) {
+	// True if toggle is of a single bit of a variable, against the same bit of its change var
+	AstSel* origSelp = nodep->origp()->castSel();
+	AstSel* changeSelp = nodep->changep()->castSel();
+	if (!origSelp || !changeSelp) return false;
+	if (!origSelp->lsbp()->castConst() || !origSelp->widthp()->castConst()
+	    || !changeSelp->lsbp()->castConst() || !changeSelp->widthp()->castConst()) return false;
+	if (origSelp->widthConst() != 1 || changeSelp->widthConst() != 1
+	    || origSelp->lsbConst() != changeSelp->lsbConst()) return false;
+	if (!origSelp->fromp()->castNodeVarRef() || !changeSelp->fromp()->castNodeVarRef()) return false;
+	if (origSelp->fromp()->width() != changeSelp->fromp()->width()) return false;
+	origFromp = origSelp->fromp();
+	changeFromp = changeSelp->fromp();
+	lsb = origSelp->lsbConst();
+	return true;
+    }
+    virtual void visit(AstCoverToggle* nodep) {
+	//nodep->dumpTree(cout,"ct:");
+	// Adjacent toggles of bits of the same vector are put under one
+	// whole-vector compare, so a quiet vector costs one test instead of one per bit:
+	//COVERTOGGLE(INC0, ORIG[0], CHANGE[0]) COVERTOGGLE(INC1, ORIG[1], CHANGE[1]) ... ->
+	//   IF((ORIG & MASK) != (CHANGE & MASK)) { IF(ORIG[0] ^ CHANGE[0]) {...} IF(ORIG[1] ^ CHANGE[1]) {...} ... }
+	// The per-bit tests are unchanged, so counts are identical.
+	AstNode* origFromp; AstNode* changeFromp; int lsb;
+	vector<AstCoverToggle*> groupps;
+	if (toggleBitSel(nodep, origFromp/*ref*/, changeFromp/*ref*/, lsb/*ref*/)) {
+	    V3Number mask (nodep->fileline(), origFromp->width());
+	    mask.setBit(lsb, 1);
+	    for (AstNode* np = nodep->nextp(); np; np = np->nextp()) {
+		AstCoverToggle* togp = np->castCoverToggle();
+		AstNode* nextOrigp; AstNode* nextChangep; int nextLsb;
+		if (!togp || !toggleBitSel(togp, nextOrigp/*ref*/, nextChangep/*ref*/, nextLsb/*ref*/)
+		    || !nextOrigp->sameTree(origFromp) || !nextChangep->sameTree(changeFromp)) break;
+		mask.setBit(nextLsb, 1);
+		groupps.push_back(togp);
+	    }
+	    if (!groupps.empty()) {
+		FileLine* fl = nodep->fileline();
+		AstNode* condOrigp = origFromp->cloneTree(false);
+		AstNode* condChangep = changeFromp->cloneTree(false);
+		if (!mask.isEqAllOnes()) {
+		    condOrigp = new AstAnd(fl, new AstConst(fl, mask), condOrigp);
+		    condChangep = new AstAnd(fl, new AstConst(fl, mask), condChangep);
+		}
+		AstIf* newp = new AstIf(fl, new AstNeq(fl, condOrigp, condChangep), NULL, NULL);
+		newp->addIfsp(makeToggleIf(nodep));
+		for (vector<AstCoverToggle*>::iterator it = groupps.begin(); it != groupps.end(); ++it) {
+		    AstCoverToggle* togp = *it;
+		    togp->unlinkFrBack();
+		    newp->addIfsp(makeToggleIf(togp));
+		    togp->deleteTree(); VL_DANGLING(togp);
+		}
+		m_statToggleGroups++;
+		m_statToggleGroupBits += groupps.size() + 1;
+		nodep->replaceWith(newp); nodep->deleteTree(); VL_DANGLING(nodep);
+		return;
+	    }
+	}
+	AstIf* newp = makeToggleIf(nodep);
 	nodep->replaceWith(newp); nodep->deleteTree(); VL_DANGLING(nodep);
     }
     virtual void visit(AstInitial* nodep) {
@@ -404,7 +493,569 @@ public:
 	//
 	nodep->accept(*this);
     }
-    virtual ~ClockVisitor() {}
+    virtual ~ClockVisitor() {
+	V3Stats::addStat("Optimizations, Toggle vectors grouped", m_statToggleGroups);
+	V3Stats::addStat("Optimizations, Toggle bits grouped", m_statToggleGroupBits);
+    }
+};
+
+//######################################################################
+// Sensitivity IF matching, common to the _eval copying visitors
+
+class ClockEdgeVisitor : public AstNVisitor {
+protected:
+    // TYPES
+    enum { EDGE_POS = 1, EDGE_NEG = 2 };
+    typedef map<AstVarScope*,int> EdgeMap;	// Clock -> EDGE_ bits
+    typedef map<AstIf*,EdgeMap> IfEdgeMap;
+
+    // STATE
+    AstScope*		m_scopep;	// Top scope
+    IfEdgeMap		m_ifEdges;	// Edges each sensitivity IF tests
+    map<AstVarScope*,AstVarScope*> m_lastVscps;	// Clock -> its __Vclklast
+
+    // METHODS
+    static int debug() {
+	static int level = -1;
+	if (VL_UNLIKELY(level < 0)) level = v3Global.opt.debugSrcLevel(__FILE__);
+	return level;
+    }
+
+    AstVarScope* inputClock(AstNode* nodep) {
+	AstVarRef* refp = nodep->castVarRef();
+	if (!refp || !refp->varScopep()) return NULL;
+	AstVarScope* vscp = refp->varScopep();
+	if (vscp->scopep() != m_scopep || !vscp->varp()->isInput()) return NULL;
+	return vscp;
+    }
+    bool isLastOf(AstNode* nodep, AstVarScope* clkVscp) {
+	// Matches the __Vclklast V3Clock created for clkVscp
+	AstVarRef* refp = nodep->castVarRef();
+	if (refp && refp->varScopep()
+	    && refp->varScopep()->varp()->name()
+	    == ((string)"__Vclklast__"+clkVscp->scopep()->nameDotless()+"__"+clkVscp->varp()->name())) {
+	    m_lastVscps[clkVscp] = refp->varScopep();
+	    return true;
+	}
+	return false;
+    }
+    bool senseEdge(AstNode* lhsp, AstNode* rhsp, bool xorOp, EdgeMap& edges) {
+	// POSEDGE:  var & ~var_last	NEGEDGE:  ~var & var_last	BOTHEDGE:  var ^ var_last
+	if (AstVarScope* clkVscp = inputClock(lhsp)) {
+	    if (xorOp && isLastOf(rhsp, clkVscp)) {
+		edges[clkVscp] |= EDGE_POS | EDGE_NEG;
+		return true;
+	    } else if (!xorOp && rhsp->castNot() && isLastOf(rhsp->castNot()->lhsp(), clkVscp)) {
+		edges[clkVscp] |= EDGE_POS;
+		return true;
+	    }
+	} else if (AstNot* notp = lhsp->castNot()) {
+	    AstVarScope* notClkVscp = inputClock(notp->lhsp());
+	    if (!xorOp && notClkVscp && isLastOf(rhsp, notClkVscp)) {
+		edges[notClkVscp] |= EDGE_NEG;
+		return true;
+	    }
+	}
+	return false;
+    }
+    bool senseEdges(AstNode* nodep, EdgeMap& edges) {
+	// Return true if the condition is only edges of top level input clocks
+	if (AstOr* orp = nodep->castOr()) {
+	    return senseEdges(orp->lhsp(), edges) && senseEdges(orp->rhsp(), edges);
+	} else if (AstAnd* andp = nodep->castAnd()) {
+	    return (senseEdge(andp->lhsp(), andp->rhsp(), false, edges)
+		    || senseEdge(andp->rhsp(), andp->lhsp(), false, edges));
+	} else if (AstXor* xorp = nodep->castXor()) {
+	    return (senseEdge(xorp->lhsp(), xorp->rhsp(), true, edges)
+		    || senseEdge(xorp->rhsp(), xorp->lhsp(), true, edges));
+	}
+	return false;
+    }
+    AstCFunc* findEval(AstTopScope* nodep) {
+	for (AstNode* blockp = nodep->scopep()->blocksp(); blockp; blockp = blockp->nextp()) {
+	    AstCFunc* funcp = blockp->castCFunc();
+	    if (funcp && funcp->name() == "_eval") return funcp;
+	}
+	return NULL;
+    }
+
+    // VISITORS
+    virtual void visit(AstNodeStmt*) {}	// Accelerate
+    virtual void visit(AstNodeMath*) {}	// Accelerate
+    virtual void visit(AstNode* nodep) {
+	nodep->iterateChildren(*this);
+    }
+
+public:
+    // CONSTUCTORS
+    ClockEdgeVisitor() {
+	m_scopep = NULL;
+    }
+    virtual ~ClockEdgeVisitor() {}
+};
+
+//######################################################################
+// Per clock eval functions, as a visitor of each AstNode
+
+class ClockDomainVisitor : public ClockEdgeVisitor {
+private:
+    // TYPES
+    typedef map<pair<AstVarScope*,int>,AstCFunc*> DomainMap;
+
+    // STATE
+    V3Double0		m_statDomains;	// Statistic tracking
+
+    // METHODS
+    AstCFunc* newDomainFunc(AstCFunc* evalp, AstVarScope* clkVscp, int edge) {
+	string edgeName = (edge == EDGE_POS) ? "posedge" : "negedge";
+	AstCFunc* funcp = new AstCFunc(evalp->fileline(),
+				       "_eval__"+edgeName+"__"+clkVscp->varp()->name(), m_scopep);
+	funcp->argTypes(evalp->argTypes());
+	funcp->dontCombine(true);
+	funcp->symProlog(true);
+	funcp->isStatic(true);
+	funcp->entryPoint(true);
+	if (evalp->initsp()) funcp->addInitsp(evalp->initsp()->cloneTree(true));
+	if (evalp->finalsp()) funcp->addFinalsp(evalp->finalsp()->cloneTree(true));
+	m_scopep->addActivep(funcp);
+	UINFO(4,"  New domain "<<funcp<<endl);
+	++m_statDomains;
+	return funcp;
+    }
+    void makeDomains(AstCFunc* evalp) {
+	// Find which IFs test only input clock edges
+	DomainMap domains;
+	for (AstNode* stmtp = evalp->stmtsp(); stmtp; stmtp = stmtp->nextp()) {
+	    AstIf* ifp = stmtp->castIf();
+	    EdgeMap edges;
+	    if (ifp && senseEdges(ifp->condp(), edges)) {
+		m_ifEdges[ifp] = edges;
+		for (EdgeMap::iterator it = edges.begin(); it != edges.end(); ++it) {
+		    if (it->second & EDGE_POS) domains[make_pair(it->first, (int)EDGE_POS)] = NULL;
+		    if (it->second & EDGE_NEG) domains[make_pair(it->first, (int)EDGE_NEG)] = NULL;
+		}
+	    }
+	}
+	// Copy _eval for each, dropping the IFs that can't be true as other clocks are unchanged
+	for (DomainMap::iterator it = domains.begin(); it != domains.end(); ++it) {
+	    AstVarScope* clkVscp = it->first.first;
+	    int edge = it->first.second;
+	    AstCFunc* funcp = newDomainFunc(evalp, clkVscp, edge);
+	    for (AstNode* stmtp = evalp->stmtsp(); stmtp; stmtp = stmtp->nextp()) {
+		IfEdgeMap::iterator iit = stmtp->castIf() ? m_ifEdges.find(stmtp->castIf()) : m_ifEdges.end();
+		if (iit != m_ifEdges.end()) {
+		    EdgeMap::iterator eit = iit->second.find(clkVscp);
+		    if (eit == iit->second.end() || !(eit->second & edge)) continue;
+		}
+		funcp->addStmtsp(stmtp->cloneTree(false));
+	    }
+	}
+    }
+
+    // VISITORS
+    virtual void visit(AstTopScope* nodep) {
+	m_scopep = nodep->scopep();
+	if (AstCFunc* evalp = findEval(nodep)) makeDomains(evalp);
+	m_scopep = NULL;
+    }
+
+public:
+    // CONSTUCTORS
+    explicit ClockDomainVisitor(AstNetlist* nodep) {
+	nodep->accept(*this);
+    }
+    virtual ~ClockDomainVisitor() {
+	V3Stats::addStat("Optimizations, Clock domain eval functions", m_statDomains);
+    }
+};
+
+//######################################################################
+// Variables accessed under statements, following calls
+
+class ClockAccessVisitor : public AstNVisitor {
+private:
+    // STATE
+    set<AstVarScope*>	m_readps;	// Variables read
+    set<AstVarScope*>	m_writeps;	// Variables written
+    set<AstCFunc*>	m_funcps;	// Functions already visited
+    bool		m_impure;	// Has side effects, or reads beyond its variables
+    // VISITORS
+    virtual void visit(AstVarRef* nodep) {
+	AstVarScope* vscp = nodep->varScopep();
+	// Trace activity is only read by the trace functions, outside _eval
+	if (!vscp || vscp->varp()->name() == "__Vm_traceActivity") return;
+	if (nodep->lvalue()) m_writeps.insert(vscp);
+	else m_readps.insert(vscp);
+    }
+    virtual void visit(AstCCall* nodep) {
+	nodep->iterateChildren(*this);
+	if (nodep->funcp() && m_funcps.insert(nodep->funcp()).second) {
+	    if (nodep->funcp()->dpiImport()) m_impure = true;
+	    nodep->funcp()->accept(*this);
+	}
+    }
+    virtual void visit(AstNode* nodep) {
+	if (!nodep->isPure() || nodep->isOutputter()
+	    || nodep->castCStmt() || nodep->castCMath() || nodep->castUCStmt() || nodep->castUCFunc()
+	    || nodep->castRand() || nodep->castTime() || nodep->castTimeD() || nodep->castCoverInc()) {
+	    m_impure = true;
+	}
+	nodep->iterateChildren(*this);
+    }
+public:
+    // CONSTUCTORS
+    ClockAccessVisitor() {
+	m_impure = false;
+    }
+    virtual ~ClockAccessVisitor() {}
+    // METHODS
+    void add(AstNode* nodep) { nodep->accept(*this); }
+    const set<AstVarScope*>& readps() const { return m_readps; }
+    const set<AstVarScope*>& writeps() const { return m_writeps; }
+    bool impure() const { return m_impure; }
+};
+
+//######################################################################
+// Async reset fast path, as a visitor of each AstNode
+
+class ClockResetVisitor : public ClockEdgeVisitor {
+private:
+    // STATE
+    set<AstVarScope*>	m_resetps;	// Input clocks used as async resets
+    V3Double0		m_statResets;	// Statistic tracking
+    V3Double0		m_statIfs;	// Statistic tracking
+
+    // METHODS
+    void findResets(AstCFunc* evalp) {
+	// An input that shares a sensitivity IF with another, and is read
+	// by the logic under it, is an async reset rather than the clock
+	for (AstNode* stmtp = evalp->stmtsp(); stmtp; stmtp = stmtp->nextp()) {
+	    AstIf* ifp = stmtp->castIf();
+	    EdgeMap edges;
+	    if (ifp && senseEdges(ifp->condp(), edges)) {
+		m_ifEdges[ifp] = edges;
+		if (edges.size() < 2) continue;
+		ClockAccessVisitor accessVisitor;
+		for (AstNode* bodyp = ifp->ifsp(); bodyp; bodyp = bodyp->nextp()) accessVisitor.add(bodyp);
+		for (EdgeMap::iterator it = edges.begin(); it != edges.end(); ++it) {
+		    if (accessVisitor.readps().find(it->first) != accessVisitor.readps().end()) {
+			UINFO(4,"  Async reset "<<it->first<<endl);
+			m_resetps.insert(it->first);
+		    }
+		}
+	    }
+	}
+    }
+    AstNode* dropResetEdges(AstNode* condp) {
+	// Return a copy of the sensitivity condition without the reset edges, or NULL if none left
+	if (AstOr* orp = condp->castOr()) {
+	    AstNode* lhsp = dropResetEdges(orp->lhsp());
+	    AstNode* rhsp = dropResetEdges(orp->rhsp());
+	    if (!lhsp) return rhsp;
+	    if (!rhsp) return lhsp;
+	    return new AstOr(orp->fileline(), lhsp, rhsp);
+	}
+	EdgeMap edges;
+	if (senseEdges(condp, edges) && m_resetps.find(edges.begin()->first) != m_resetps.end()) {
+	    return NULL;
+	}
+	return condp->cloneTree(false);
+    }
+    AstCFunc* newResetFunc(AstCFunc* evalp) {
+	// Not an _eval__ name, as it isn't a domain entry point
+	AstCFunc* funcp = new AstCFunc(evalp->fileline(), "_eval_resets", m_scopep);
+	funcp->argTypes(evalp->argTypes());
+	funcp->dontCombine(true);
+	funcp->symProlog(true);
+	funcp->isStatic(true);
+	if (evalp->initsp()) funcp->addInitsp(evalp->initsp()->cloneTree(true));
+	m_scopep->addActivep(funcp);
+	return funcp;
+    }
+    void makeFastPath(AstCFunc* evalp) {
+	findResets(evalp);
+	if (m_resetps.empty() || !evalp->stmtsp()) return;
+	FileLine* fl = evalp->fileline();
+	// Copy _eval without the reset edges, as the fast path while resets are stable
+	AstNode* fastp = NULL;
+	for (AstNode* stmtp = evalp->stmtsp(); stmtp; stmtp = stmtp->nextp()) {
+	    IfEdgeMap::iterator iit = stmtp->castIf() ? m_ifEdges.find(stmtp->castIf()) : m_ifEdges.end();
+	    if (iit == m_ifEdges.end()) {
+		fastp = AstNode::addNext(fastp, stmtp->cloneTree(false));
+		continue;
+	    }
+	    AstIf* ifp = iit->first;
+	    AstNode* condp = dropResetEdges(ifp->condp());
+	    if (!condp) continue;  // Only resets
+	    AstIf* newp = ifp->cloneTree(false);
+	    if (newp->condp()->sameTree(condp)) {
+		condp->deleteTree(); VL_DANGLING(condp);
+	    } else {
+		AstNode* oldp = newp->condp();
+		oldp->replaceWith(condp);
+		oldp->deleteTree(); VL_DANGLING(oldp);
+		++m_statIfs;
+	    }
+	    fastp = AstNode::addNext(fastp, newp);
+	}
+	// The original body, when any reset changed, goes to its own function
+	AstCFunc* resetFuncp = newResetFunc(evalp);
+	resetFuncp->addStmtsp(evalp->stmtsp()->unlinkFrBackWithNext());
+	AstNode* changep = NULL;
+	for (set<AstVarScope*>::iterator it = m_resetps.begin(); it != m_resetps.end(); ++it) {
+	    AstVarScope* vscp = *it;
+	    AstNode* xorp = new AstXor(fl, new AstVarRef(fl, vscp, false),
+				       new AstVarRef(fl, m_lastVscps[vscp], false));
+	    changep = changep ? new AstOr(fl, changep, xorp) : xorp;
+	    ++m_statResets;
+	}
+	AstCCall* callp = new AstCCall(fl, resetFuncp);
+	callp->argTypes("vlSymsp");
+	AstIf* ifp = new AstIf(fl, changep, callp, fastp);
+	ifp->branchPred(AstBranchPred::BP_UNLIKELY);
+	evalp->addStmtsp(ifp);
+    }
+
+    // VISITORS
+    virtual void visit(AstTopScope* nodep) {
+	m_scopep = nodep->scopep();
+	if (AstCFunc* evalp = findEval(nodep)) makeFastPath(evalp);
+	m_scopep = NULL;
+    }
+
+public:
+    // CONSTUCTORS
+    explicit ClockResetVisitor(AstNetlist* nodep) {
+	nodep->accept(*this);
+    }
+    virtual ~ClockResetVisitor() {
+	V3Stats::addStat("Optimizations, Async reset fast path resets", m_statResets);
+	V3Stats::addStat("Optimizations, Async reset fast path IFs", m_statIfs);
+    }
+};
+
+//######################################################################
+// Sparse combo evaluation (--eval-sparse), as a visitor of each AstNode
+
+class ClockSparseVisitor : public AstNVisitor {
+private:
+    // TYPES
+    struct StmtInfo {
+	AstNode*		m_stmtp;	// Statement at the top of _eval
+	AstIf*			m_ifp;		// IF guarding everything the statement does, else NULL
+	AstVarScope*		m_ranVscp;	// Set when m_ifp's body runs, NULL until needed
+	set<AstVarScope*>	m_readps;	// Variables read
+	set<AstVarScope*>	m_writeps;	// Variables written
+	bool			m_impure;	// Can't be skipped
+    };
+    typedef map<AstVarScope*,vector<int> > WriterMap;
+
+    // STATE
+    AstNodeModule*	m_modp;		// Current module
+    AstNodeModule*	m_topModp;	// Top module
+    AstScope*		m_scopep;	// Top scope
+    AstCFunc*		m_evalFuncp;	// _eval
+    AstCFunc*		m_settleFuncp;	// _eval_settle
+    AstVarScope*	m_allVscp;	// Set by settle, so the next _eval runs everything
+    vector<StmtInfo>	m_stmts;	// Statements at the top of _eval, in order
+    WriterMap		m_writers;	// Statements writing each variable
+    set<AstVarScope*>	m_outsideps;	// Variables written outside the _eval statements
+    map<AstVarScope*,AstVarScope*> m_lastInps;	// Top level input -> value at the last _eval
+    bool		m_userC;	// Has user $c, which may write anything
+    int			m_ranNum;	// Number of ran flags
+    V3Double0		m_statGuarded;	// Statistic tracking
+
+    // METHODS
+    static int debug() {
+	static int level = -1;
+	if (VL_UNLIKELY(level < 0)) level = v3Global.opt.debugSrcLevel(__FILE__);
+	return level;
+    }
+
+    AstVarScope* newVarScope(const string& name, AstVar* examplep) {
+	FileLine* fl = m_evalFuncp->fileline();
+	AstVar* varp = (examplep
+			? new AstVar(fl, AstVarType::MODULETEMP, name, examplep)
+			: new AstVar(fl, AstVarType::MODULETEMP, name, VFlagBitPacked(), 1));
+	m_topModp->addStmtp(varp);
+	AstVarScope* vscp = new AstVarScope(fl, m_scopep, varp);
+	m_scopep->addVarp(vscp);
+	return vscp;
+    }
+    bool isTopInput(AstVarScope* vscp) const {
+	return (vscp->scopep() == m_scopep
+		&& (vscp->varp()->isInput() || vscp->varp()->isInout()));
+    }
+    bool isOutside(AstVarScope* vscp) const {
+	// Written by the application, VPI or outside of eval
+	return (vscp->varp()->isSigPublic() || vscp->varp()->isSigUserRWPublic()
+		|| m_outsideps.find(vscp) != m_outsideps.end());
+    }
+    AstNode* ranRef(int stmtNum) {
+	// Flag set when the statement ran, made when first needed
+	StmtInfo& info = m_stmts[stmtNum];
+	FileLine* fl = info.m_ifp->fileline();
+	if (!info.m_ranVscp) {
+	    info.m_ranVscp = newVarScope("__Vsparse_ran"+cvtToStr(++m_ranNum), NULL);
+	    info.m_ifp->addHereThisAsNext(new AstAssign(fl, new AstVarRef(fl, info.m_ranVscp, true),
+							new AstConst(fl, AstConst::LogicFalse())));
+	    info.m_ifp->addIfsp(new AstAssign(fl, new AstVarRef(fl, info.m_ranVscp, true),
+					      new AstConst(fl, AstConst::LogicTrue())));
+	}
+	return new AstVarRef(fl, info.m_ranVscp, false);
+    }
+    AstNode* inputChanged(AstVarScope* vscp) {
+	FileLine* fl = vscp->fileline();
+	AstVarScope*& lastVscp = m_lastInps[vscp];
+	if (!lastVscp) {
+	    lastVscp = newVarScope("__Vsparse_last__"+vscp->varp()->name(), vscp->varp());
+	    m_evalFuncp->addFinalsp(new AstAssign(fl, new AstVarRef(fl, lastVscp, true),
+						  new AstVarRef(fl, vscp, false)));
+	}
+	return new AstNeq(fl, new AstVarRef(fl, vscp, false), new AstVarRef(fl, lastVscp, false));
+    }
+    bool isActivitySet(AstNode* nodep) const {
+	AstAssign* assp = nodep ? nodep->castAssign() : NULL;
+	AstSel* selp = assp ? assp->lhsp()->castSel() : NULL;
+	AstVarRef* refp = selp ? selp->fromp()->castVarRef() : NULL;
+	return refp && refp->varp()->name() == "__Vm_traceActivity";
+    }
+    void guardCall(int stmtNum) {
+	// A combo call only needs to run when a statement before it writing
+	// what it reads ran, or a top level input it reads changed
+	StmtInfo& info = m_stmts[stmtNum];
+	for (set<AstVarScope*>::iterator it = info.m_writeps.begin(); it != info.m_writeps.end(); ++it) {
+	    if (m_writers[*it].size() > 1 || isTopInput(*it) || isOutside(*it)) return;
+	}
+	set<int> stmtNums;
+	set<AstVarScope*> inputps;
+	for (set<AstVarScope*>::iterator it = info.m_readps.begin(); it != info.m_readps.end(); ++it) {
+	    AstVarScope* vscp = *it;
+	    if (isOutside(vscp)) return;
+	    WriterMap::iterator wit = m_writers.find(vscp);
+	    if (isTopInput(vscp)) {
+		if (wit != m_writers.end()) return;
+		if (vscp->varp()->dtypeSkipRefp()->castUnpackArrayDType()) return;
+		inputps.insert(vscp);
+		continue;
+	    }
+	    if (wit == m_writers.end()) continue;  // Constant after settle
+	    for (vector<int>::iterator nit = wit->second.begin(); nit != wit->second.end(); ++nit) {
+		if (*nit == stmtNum) continue;
+		if (*nit > stmtNum || !m_stmts[*nit].m_ifp) return;  // Feedback, or always runs
+		stmtNums.insert(*nit);
+	    }
+	}
+	FileLine* fl = info.m_stmtp->fileline();
+	AstNode* condp = new AstVarRef(fl, m_allVscp, false);
+	for (set<int>::iterator it = stmtNums.begin(); it != stmtNums.end(); ++it) {
+	    condp = new AstOr(fl, condp, ranRef(*it));
+	}
+	for (set<AstVarScope*>::iterator it = inputps.begin(); it != inputps.end(); ++it) {
+	    condp = new AstOr(fl, condp, inputChanged(*it));
+	}
+	AstNode* callp = info.m_stmtp;
+	AstNode* activityp = isActivitySet(callp->nextp()) ? callp->nextp()->unlinkFrBack() : NULL;
+	AstNRelinker handle;
+	callp->unlinkFrBack(&handle);
+	AstIf* ifp = new AstIf(fl, condp, callp, NULL);
+	if (activityp) ifp->addIfsp(activityp);
+	handle.relink(ifp);
+	info.m_stmtp = ifp;
+	info.m_ifp = ifp;
+	++m_statGuarded;
+    }
+    void makeSparse() {
+	for (AstNode* stmtp = m_evalFuncp->initsp(); stmtp; stmtp = stmtp->nextp()) {
+	    ClockAccessVisitor accessVisitor;  accessVisitor.add(stmtp);
+	    m_outsideps.insert(accessVisitor.writeps().begin(), accessVisitor.writeps().end());
+	}
+	for (AstNode* stmtp = m_evalFuncp->finalsp(); stmtp; stmtp = stmtp->nextp()) {
+	    ClockAccessVisitor accessVisitor;  accessVisitor.add(stmtp);
+	    m_outsideps.insert(accessVisitor.writeps().begin(), accessVisitor.writeps().end());
+	}
+	for (AstNode* stmtp = m_evalFuncp->stmtsp(); stmtp; stmtp = stmtp->nextp()) {
+	    ClockAccessVisitor accessVisitor;  accessVisitor.add(stmtp);
+	    StmtInfo info;
+	    info.m_stmtp = stmtp;
+	    info.m_ifp = (stmtp->castIf() && !stmtp->castIf()->elsesp()) ? stmtp->castIf() : NULL;
+	    info.m_ranVscp = NULL;
+	    info.m_readps = accessVisitor.readps();
+	    info.m_writeps = accessVisitor.writeps();
+	    info.m_impure = accessVisitor.impure();
+	    for (set<AstVarScope*>::iterator it = info.m_writeps.begin(); it != info.m_writeps.end(); ++it) {
+		m_writers[*it].push_back(m_stmts.size());
+	    }
+	    m_stmts.push_back(info);
+	}
+	m_allVscp = newVarScope("__Vsparse_all", NULL);
+	FileLine* fl = m_evalFuncp->fileline();
+	m_settleFuncp->addStmtsp(new AstAssign(fl, new AstVarRef(fl, m_allVscp, true),
+					       new AstConst(fl, AstConst::LogicTrue())));
+	m_evalFuncp->addFinalsp(new AstAssign(fl, new AstVarRef(fl, m_allVscp, true),
+					      new AstConst(fl, AstConst::LogicFalse())));
+	for (int stmtNum = 0; stmtNum < (int)m_stmts.size(); ++stmtNum) {
+	    if (m_stmts[stmtNum].m_stmtp->castCCall() && !m_stmts[stmtNum].m_impure) guardCall(stmtNum);
+	}
+    }
+
+    // VISITORS
+    virtual void visit(AstNetlist* nodep) {
+	nodep->iterateChildren(*this);
+	if (m_userC) {
+	    UINFO(4,"  No sparse eval, as has user $c\n");
+	} else if (m_evalFuncp && m_evalFuncp->stmtsp() && m_settleFuncp) {
+	    makeSparse();
+	}
+    }
+    virtual void visit(AstNodeModule* nodep) {
+	m_modp = nodep;
+	nodep->iterateChildren(*this);
+	m_modp = NULL;
+    }
+    virtual void visit(AstTopScope* nodep) {
+	m_topModp = m_modp;
+	m_scopep = nodep->scopep();
+	nodep->iterateChildren(*this);
+    }
+    virtual void visit(AstCFunc* nodep) {
+	if (m_scopep && nodep->scopep() == m_scopep) {
+	    if (nodep->name() == "_eval") m_evalFuncp = nodep;
+	    else if (nodep->name() == "_eval_settle") m_settleFuncp = nodep;
+	}
+	if (nodep->funcPublic() || nodep->dpiExport() || nodep->dpiExportWrapper()) {
+	    // Callable by the application at any time
+	    ClockAccessVisitor accessVisitor;  accessVisitor.add(nodep);
+	    m_outsideps.insert(accessVisitor.writeps().begin(), accessVisitor.writeps().end());
+	}
+	nodep->iterateChildren(*this);
+    }
+    virtual void visit(AstUCStmt*) {
+	m_userC = true;
+    }
+    virtual void visit(AstUCFunc*) {
+	m_userC = true;
+    }
+    virtual void visit(AstNode* nodep) {
+	nodep->iterateChildren(*this);
+    }
+
+public:
+    // CONSTUCTORS
+    explicit ClockSparseVisitor(AstNetlist* nodep) {
+	m_modp = NULL;
+	m_topModp = NULL;
+	m_scopep = NULL;
+	m_evalFuncp = NULL;
+	m_settleFuncp = NULL;
+	m_allVscp = NULL;
+	m_userC = false;
+	m_ranNum = 0;
+	nodep->accept(*this);
+    }
+    virtual ~ClockSparseVisitor() {
+	V3Stats::addStat("Optimizations, Sparse eval calls guarded", m_statGuarded);
+    }
 };
 
 //######################################################################
@@ -415,3 +1066,21 @@ void V3Clock::clockAll(AstNetlist* nodep) {
     ClockVisitor visitor (nodep);
     V3Global::dumpCheckGlobalTree("clock.tree", 0, v3Global.opt.dumpTreeLevel(__FILE__) >= 3);
 }
+
+void V3Clock::domainsAll(AstNetlist* nodep) {
+    UINFO(2,__FUNCTION__<<": "<<endl);
+    ClockDomainVisitor visitor (nodep);
+    V3Global::dumpCheckGlobalTree("clockdomain.tree", 0, v3Global.opt.dumpTreeLevel(__FILE__) >= 3);
+}
+
+void V3Clock::sparseAll(AstNetlist* nodep) {
+    UINFO(2,__FUNCTION__<<": "<<endl);
+    ClockSparseVisitor visitor (nodep);
+    V3Global::dumpCheckGlobalTree("clocksparse.tree", 0, v3Global.opt.dumpTreeLevel(__FILE__) >= 3);
+}
+
+void V3Clock::resetsAll(AstNetlist* nodep) {
+    UINFO(2,__FUNCTION__<<": "<<endl);
+    ClockResetVisitor visitor (nodep);
+    V3Global::dumpCheckGlobalTree("clockreset.tree", 0, v3Global.opt.dumpTreeLevel(__FILE__) >= 3);
+}
@@ -30,6 +30,9 @@
 class V3Clock {
 public:
     static void clockAll(AstNetlist* nodep);
+    static void domainsAll(AstNetlist* nodep);
+    static void sparseAll(AstNetlist* nodep);
+    static void resetsAll(AstNetlist* nodep);
 };
 
 #endif // Guard
@@ -32,6 +32,13 @@
 //		Move common block to function
 //		Replace each common block ref with funccall
 //
+//	If --combine-instances
+//	    Make each instance's references to its own scope relative to "this->"
+//	    Repeat duplicate function combining until no more functions combine,
+//	    as merged callees make their callers identical
+//	    Replace runs of calls of one function on different instances
+//	    with a loop over a table of the instances
+//
 //*************************************************************************
 
 #include "config_build.h"
@@ -52,6 +59,7 @@
 //######################################################################
 
 #define COMBINE_MIN_STATEMENTS 50	// Min # of statements to be worth making a function
+#define COMBINE_MIN_INSTANCE_LOOP 4	// Min # of instance calls to be worth making a loop
 
 //######################################################################
 
@@ -175,6 +183,75 @@ public:
     virtual ~CombMarkVisitor() {}
 };
 
+//######################################################################
+// Make functions relative to their instance
+
+class CombInstanceVisitor : CombBaseVisitor {
+    // Convert references to a function's own instance from "vlSymsp->TOP__inst."
+    // to "this->", so the functions of different instances of the same module
+    // may become identical.
+private:
+    // STATE
+    V3Double0		m_statRelative;	// Statistic tracking
+    AstCFunc*		m_funcp;	// Current function
+    string		m_hiername;	// Hierarchical name of current function's instance
+    bool		m_changed;	// Current function was changed
+
+    // METHODS
+    void relativeName(AstNode* nodep) {
+	// Caller applies the new name
+	UINFO(9,"     Relative "<<nodep<<endl);
+	m_changed = true;
+    }
+    // VISITORS
+    virtual void visit(AstCFunc* nodep) {
+	if (nodep->dontCombine()
+	    || nodep->funcPublic()
+	    || nodep->dpiImport() || nodep->dpiExport() || nodep->dpiExportWrapper()
+	    || !nodep->scopep()
+	    || !nodep->scopep()->aboveScopep()) {  // Top has only one instance
+	    return;
+	}
+	m_funcp = nodep;
+	m_hiername = nodep->scopep()->nameVlSym()+".";
+	m_changed = false;
+	nodep->iterateChildren(*this);
+	if (m_changed) {
+	    nodep->isStatic(false);
+	    ++m_statRelative;
+	}
+	m_funcp = NULL;
+    }
+    virtual void visit(AstNodeVarRef* nodep) {
+	nodep->iterateChildren(*this);
+	if (m_funcp && nodep->hiername() == m_hiername) {
+	    relativeName(nodep);
+	    nodep->hiername("this->");
+	}
+    }
+    virtual void visit(AstCCall* nodep) {
+	nodep->iterateChildren(*this);
+	if (m_funcp && nodep->hiername() == m_hiername) {
+	    relativeName(nodep);
+	    nodep->hiername("this->");
+	}
+    }
+    virtual void visit(AstVar*) {}
+    virtual void visit(AstNode* nodep) {
+	nodep->iterateChildren(*this);
+    }
+public:
+    // CONSTRUCTORS
+    explicit CombInstanceVisitor(AstNetlist* nodep) {
+	m_funcp = NULL;
+	m_changed = false;
+	nodep->accept(*this);
+    }
+    virtual ~CombInstanceVisitor() {
+	V3Stats::addStat("Optimizations, Combine instance-relative CFuncs", m_statRelative);
+    }
+};
+
 //######################################################################
 // Combine state, as a visitor of each AstNode
 
@@ -185,7 +262,7 @@ private:
     //  AstNodeStmt::user()	-> bool.  True if iterated already
     //  AstCFunc::user3p()	-> AstCFunc*, If set, replace ccalls to this func with new func
     //  AstNodeStmt::user3()	-> AstNode*.  True if to ignore this cell
-    //  AstNodeStmt::user4()	-> V3Hashed::V3Hash.  Hash value of this node (hash of 0 is illegal)
+    //  AstNodeStmt::user4()	-> int.  V3Hashed entry of this node (0 is unhashed)
     AstUser1InUse	m_inuser1;
     AstUser3InUse	m_inuser3;
     //AstUser4InUse	part of V3Hashed
@@ -225,7 +302,7 @@ private:
 	    if (oldfuncp
 		&& oldfuncp->emptyBody()
 		&& !oldfuncp->dontCombine()) {
-		UINFO(5,"     EmptyFunc "<<hex<<V3Hash(oldfuncp->user4p())<<" "<<oldfuncp<<endl);
+		UINFO(5,"     EmptyFunc "<<hex<<m_hashed.nodeHash(oldfuncp)<<" "<<oldfuncp<<endl);
 		// Mark user3p on entire old tree, so we don't process it more
 		CombMarkVisitor visitor(oldfuncp);
 		m_call.replaceFunc(oldfuncp, NULL);
@@ -236,10 +313,10 @@ private:
     }
     void walkDupFuncs() {
 	for (V3Hashed::iterator it = m_hashed.begin(); it != m_hashed.end(); ++it) {
-	    V3Hash hashval = it->first;
+	    V3Hashed::Key hashval = it->first;
 	    AstNode* node1p = it->second;
 	    if (!node1p->castCFunc()) continue;
-	    if (hashval.isIllegal()) node1p->v3fatalSrc("Illegal (unhashed) nodes");
+	    if (!node1p->user4()) node1p->v3fatalSrc("Illegal (unhashed) nodes");
 	    for (V3Hashed::iterator eqit = it; eqit != m_hashed.end(); ++eqit) {
 		AstNode* node2p = eqit->second;
 		if (!(eqit->first == hashval)) break;
@@ -255,8 +332,8 @@ private:
 	}
     }
     void replaceFuncWFunc(AstCFunc* oldfuncp, AstCFunc* newfuncp) {
-	UINFO(5,"     DupFunc "<<hex<<V3Hash(newfuncp->user4p())<<" "<<newfuncp<<endl);
-	UINFO(5,"         and "<<hex<<V3Hash(oldfuncp->user4p())<<" "<<oldfuncp<<endl);
+	UINFO(5,"     DupFunc "<<hex<<m_hashed.nodeHash(newfuncp)<<" "<<newfuncp<<endl);
+	UINFO(5,"         and "<<hex<<m_hashed.nodeHash(oldfuncp)<<" "<<oldfuncp<<endl);
 	// Mark user3p on entire old tree, so we don't process it more
 	++m_statCombs;
 	CombMarkVisitor visitor(oldfuncp);
@@ -280,7 +357,7 @@ private:
     }
 
     void walkDupCodeStart(AstNode* node1p) {
-	V3Hash hashval (node1p->user4p());
+	V3Hashed::Key hashval = m_hashed.nodeKey(node1p);
 	//UINFO(4,"    STMT "<<hashval<<" "<<node1p<<endl);
 	//
 	int	 bestDepth = 0;		// Best substitution found in the search
@@ -323,9 +400,9 @@ private:
 	if (node1p->user1p() || node2p->user1p()) return 0;   // Already iterated
 	if (node1p->user3p() || node2p->user3p()) return 0;   // Already merged
 	if (!m_hashed.sameNodes(node1p,node2p)) return 0; // walk of tree has same comparison
-	V3Hash hashval(node1p->user4p());
-	//UINFO(9,"        wdup1 "<<level<<" "<<V3Hash(node1p->user4p())<<" "<<node1p<<endl);
-	//UINFO(9,"        wdup2 "<<level<<" "<<V3Hash(node2p->user4p())<<" "<<node2p<<endl);
+	V3Hash hashval = m_hashed.nodeHash(node1p);
+	//UINFO(9,"        wdup1 "<<level<<" "<<m_hashed.nodeHash(node1p)<<" "<<node1p<<endl);
+	//UINFO(9,"        wdup2 "<<level<<" "<<m_hashed.nodeHash(node2p)<<" "<<node2p<<endl);
 	m_walkLast1p = node1p;
 	m_walkLast2p = node2p;
 	node1p->user1(true);
@@ -417,6 +494,17 @@ private:
 	// Walk the hashes looking for duplicate functions
 	if (duplicateFunctionCombine()) {
 	    walkDupFuncs();
+	    // Instance-relative functions that call combined functions may now
+	    // themselves be identical; rehash until nothing more combines
+	    while (v3Global.opt.combineInstances()) {
+		double lastCombs = m_statCombs;
+		m_hashed.clear();
+		m_state = STATE_HASH;
+		nodep->iterateChildren(*this);
+		m_state = STATE_IDLE;
+		walkDupFuncs();
+		if (m_statCombs == lastCombs) break;
+	    }
 	}
 	// Walk the statements looking for large replicated code sections
 	if (statementCombine()) {
@@ -468,11 +556,99 @@ public:
     }
 };
 
+//######################################################################
+// Loop over instances calling a shared function
+
+class CombLoopVisitor : CombBaseVisitor {
+    // Once instances share functions, the caller still calls each
+    // instance's copy in turn, e.g. for an array of instances.  Replace
+    // such runs with an AstExecInstances, emitted as one loop.
+private:
+    // STATE
+    V3Double0		m_statLoops;	// Statistic tracking
+    V3Double0		m_statCalls;	// Statistic tracking
+    vector<AstCCall*>	m_startps;	// First call of each run found
+
+    // METHODS
+    static bool loopable(AstNode* nodep) {
+	AstCCall* callp = nodep ? nodep->castCCall() : NULL;
+	if (!callp || callp->argsp()) return false;
+	// Must be a statement, on an instance in the symbol table
+	if (callp->backp()->castNodeMath() || callp->backp()->castCReturn()
+	    || callp->backp()->castExecMTasks()) return false;
+	AstScope* scopep = callp->funcp()->scopep();
+	if (!scopep || !scopep->aboveScopep()) return false;
+	string hier = callp->hiername();
+	return (hier.length() > 10 && hier.substr(0, 9) == "vlSymsp->"
+		&& hier[hier.length()-1] == '.');
+    }
+    static bool sameCall(AstCCall* nodep, AstNode* otherp) {
+	if (!loopable(otherp)) return false;
+	AstCCall* callp = otherp->castCCall();
+	return (callp->funcp() == nodep->funcp()
+		&& callp->argTypes() == nodep->argTypes());
+    }
+    void makeLoop(AstCCall* startp) {
+	AstNode* lastp = startp;
+	int calls = 1;
+	while (sameCall(startp, lastp->nextp())) { lastp = lastp->nextp(); ++calls; }
+	if (calls < COMBINE_MIN_INSTANCE_LOOP) return;
+	UINFO(6,"  Instance loop of "<<calls<<" "<<startp<<endl);
+	AstNRelinker relinkHandle;
+	for (AstNode* nextp, *walkp = startp; 1; walkp = nextp) {
+	    nextp = walkp->nextp();
+	    if (walkp==startp) walkp->unlinkFrBack(&relinkHandle);
+	    else { walkp->unlinkFrBack(); startp->addNext(walkp); }
+	    if (walkp==lastp) break;
+	}
+	relinkHandle.relink(new AstExecInstances(startp->fileline(), startp));
+	++m_statLoops;
+	m_statCalls += calls;
+    }
+
+    // VISITORS
+    virtual void visit(AstCCall* nodep) {
+	nodep->iterateChildren(*this);
+	// Only the first of each run; the list is changed after the walk
+	AstNode* prevp = nodep->backp();
+	if (loopable(nodep) && !(prevp->nextp() == nodep && sameCall(nodep, prevp))) {
+	    m_startps.push_back(nodep);
+	}
+    }
+    virtual void visit(AstVar*) {}
+    virtual void visit(AstNodeMath*) {}
+    virtual void visit(AstNode* nodep) {
+	nodep->iterateChildren(*this);
+    }
+public:
+    // CONSTRUCTORS
+    explicit CombLoopVisitor(AstNetlist* nodep) {
+	nodep->accept(*this);
+	for (vector<AstCCall*>::iterator it = m_startps.begin(); it != m_startps.end(); ++it) {
+	    makeLoop(*it);
+	}
+    }
+    virtual ~CombLoopVisitor() {
+	V3Stats::addStat("Optimizations, Combine instance loops", m_statLoops);
+	V3Stats::addStat("Optimizations, Combine instance loop calls", m_statCalls);
+    }
+};
+
 //######################################################################
 // Combine class functions
 
 void V3Combine::combineAll(AstNetlist* nodep) {
     UINFO(2,__FUNCTION__<<": "<<endl);
-    CombineVisitor visitor (nodep);
+    if (v3Global.opt.combineInstances()) {
+	CombInstanceVisitor visitor (nodep);
+    }
+    {
+	CombineVisitor visitor (nodep);
+    }
+    // With --output-min-includes the symbol table holds references, which
+    // can't be indexed by pointer-to-member
+    if (v3Global.opt.combineInstances() && !v3Global.opt.outputMinIncludes()) {
+	CombLoopVisitor visitor (nodep);
+    }
     V3Global::dumpCheckGlobalTree("combine.tree", 0, v3Global.opt.dumpTreeLevel(__FILE__) >= 3);
 }
@@ -27,6 +27,7 @@
 #include "V3Global.h"
 #include "V3String.h"
 #include "V3Config.h"
+#include "V3Ast.h"
 
 //######################################################################
 
@@ -141,6 +142,74 @@ public:
 
 V3ConfigIgnores V3ConfigIgnores::s_singleton;
 
+//######################################################################
+
+class V3ConfigWatch {
+public:
+    FileLine*	m_fl;		// Where the watch was declared
+    string	m_module;	// Module name, may be wildcarded
+    string	m_var;		// Variable name, may be wildcarded
+    V3Number	m_value;	// Value to match
+    bool	m_used;		// Found a matching variable
+    V3ConfigWatch(FileLine* fl, const string& module, const string& var, const V3Number& value)
+	: m_fl(fl), m_module(module), m_var(var), m_value(value), m_used(false) {}
+    ~V3ConfigWatch() {}
+};
+
+class V3ConfigWatches {
+    typedef vector<V3ConfigWatch> Watches;
+
+    // MEMBERS
+    Watches		m_watches;	// All watches, in declaration order
+
+    static V3ConfigWatches s_singleton;	// Singleton (not via local static, as that's slow)
+
+    V3ConfigWatches() {}
+    ~V3ConfigWatches() {}
+
+    // METHODS
+    static AstNode* newWatch(const V3ConfigWatch& watch, AstNodeModule* modp, AstVar* varp) {
+	// Build: always @* if (var == value) $c("Verilated::watchCall(name);");
+	// Being combo logic reading only the variable, ordering places it
+	// after the variable's writers, in their domain when they have one.
+	FileLine* fl = watch.m_fl;
+	string name = AstNode::prettyName(modp->name())+"."+varp->prettyName();
+	AstNode* bodysp = new AstUCStmt(fl, new AstText(fl, "Verilated::watchCall(\""+name+"\");"));
+	AstIf* ifp = new AstIf(fl, new AstEq(fl, new AstVarRef(fl, varp, false),
+					     new AstConst(fl, watch.m_value)),
+			       bodysp, NULL);
+	ifp->branchPred(AstBranchPred::BP_UNLIKELY);
+	return new AstAlways(fl, VAlwaysKwd::ALWAYS, NULL, ifp);
+    }
+
+public:
+    inline static V3ConfigWatches& singleton() { return s_singleton; }
+
+    void addWatch(FileLine* fl, const string& module, const string& var, const V3Number& value) {
+	UINFO(9,"config addWatch "<<module<<"."<<var<<endl);
+	m_watches.push_back(V3ConfigWatch(fl, module, var, value));
+    }
+    void applyWatches(AstNetlist* nodep) {
+	for (Watches::iterator it = m_watches.begin(); it != m_watches.end(); ++it) {
+	    for (AstNodeModule* modp = nodep->modulesp(); modp; modp=modp->nextp()->castNodeModule()) {
+		if (!VString::wildmatch(modp->name().c_str(), it->m_module.c_str())) continue;
+		for (AstNode* stmtp = modp->stmtsp(); stmtp; stmtp=stmtp->nextp()) {
+		    AstVar* varp = stmtp->castVar();
+		    if (!varp || !VString::wildmatch(varp->name().c_str(), it->m_var.c_str())) continue;
+		    UINFO(4,"  Watch "<<modp->name()<<"."<<varp->name()<<endl);
+		    modp->addStmtp(newWatch(*it, modp, varp));
+		    it->m_used = true;
+		}
+	    }
+	    if (!it->m_used) {
+		it->m_fl->v3error("Watch variable not found: "<<it->m_module<<"."<<it->m_var);
+	    }
+	}
+    }
+};
+
+V3ConfigWatches V3ConfigWatches::s_singleton;
+
 //######################################################################
 // V3Config
 
@@ -156,3 +225,11 @@ void V3Config::addIgnore(V3ErrorCode code, bool on, string filename, int min, in
 void V3Config::applyIgnores(FileLine* filelinep) {
     V3ConfigIgnores::singleton().applyIgnores(filelinep);
 }
+
+void V3Config::addWatch(FileLine* fl, const string& module, const string& var, const V3Number& value) {
+    V3ConfigWatches::singleton().addWatch(fl, module, var, value);
+}
+
+void V3Config::applyWatches(AstNetlist* nodep) {
+    V3ConfigWatches::singleton().applyWatches(nodep);
+}
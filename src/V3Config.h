@@ -26,12 +26,17 @@
 #include "V3Error.h"
 #include "V3FileLine.h"
 
+class AstNetlist;
+class V3Number;
+
 //######################################################################
 
 class V3Config {
 public:
     static void addIgnore(V3ErrorCode code, bool on, string filename, int min, int max);
     static void applyIgnores(FileLine* filelinep);
+    static void addWatch(FileLine* fl, const string& module, const string& var, const V3Number& value);
+    static void applyWatches(AstNetlist* nodep);
 };
 
 #endif // Guard
@@ -107,6 +107,8 @@ private:
     bool	m_doShort;	// Remove expressions that short circuit
     bool	m_doV;		// Verilog, not C++ conversion
     bool	m_doGenerate;	// Postpone width checking inside generate
+    vluint64_t	m_editCnt;	// If nonzero, skip statements not edited after this edit count
+    bool	m_valueSet;	// Gave a variable a constant value, references everywhere may now fold
     AstNodeModule*	m_modp;	// Current module
     AstArraySel*	m_selp;	// Current select
     AstNode*	m_scopep;	// Current scope
@@ -841,6 +843,17 @@ private:
 	newp->dtypeFrom(nodep);
 	nodep->replaceWith(newp); nodep->deleteTree(); VL_DANGLING(nodep);
     }
+    void replaceModAnd (AstModDiv* nodep) {  // ModDiv, but not ModDivS as not simple mask
+	UINFO(5,"MODDIV(b,2^n)->AND(b,2^n-1) "<<nodep<<endl);
+	int amount = nodep->rhsp()->castConst()->num().mostSetBitP1()-1;  // 2^n->n+1
+	V3Number mask (nodep->fileline(), nodep->width());
+	mask.setMask(amount);
+	AstNode* opp = nodep->lhsp()->unlinkFrBack();
+	AstAnd* newp = new AstAnd(nodep->fileline(),
+				  opp, new AstConst(nodep->fileline(), mask));
+	newp->dtypeFrom(nodep);
+	nodep->replaceWith(newp); nodep->deleteTree(); VL_DANGLING(nodep);
+    }
     void replaceShiftOp (AstNodeBiop* nodep) {
 	UINFO(5,"SHIFT(AND(a,b),CONST)->AND(SHIFT(a,CONST),SHIFT(b,CONST)) "<<nodep<<endl);
 	AstNRelinker handle;
@@ -1199,26 +1212,35 @@ private:
 	// Iterate modules backwards, in bottom-up order.  That's faster
 	nodep->iterateChildrenBackwards(*this);
     }
+    void iterateStmts(AstNode* nodep) {
+	// Statements in these containers are the unit of incremental folding.
+	// Going no deeper keeps each AstJumpLabel and its AstJumpGos together.
+	if (m_editCnt) nodep->iterateChildrenEdited(*this, m_editCnt);
+	else nodep->iterateChildren(*this);
+    }
     virtual void visit(AstNodeModule* nodep) {
 	m_modp = nodep;
-	nodep->iterateChildren(*this);
+	iterateStmts(nodep);
 	m_modp = NULL;
     }
     virtual void visit(AstCFunc* nodep) {
 	// No ASSIGNW removals under funcs, we've long eliminated INITIALs
 	// (We should perhaps rename the assignw's to just assigns)
 	m_wremove = false;
-	nodep->iterateChildren(*this);
+	iterateStmts(nodep);
 	m_wremove = true;
     }
     virtual void visit(AstScope* nodep) {
 	// No ASSIGNW removals under scope, we've long eliminated INITIALs
 	m_scopep = nodep;
 	m_wremove = false;
-	nodep->iterateChildren(*this);
+	iterateStmts(nodep);
 	m_wremove = true;
 	m_scopep = NULL;
     }
+    virtual void visit(AstActive* nodep) {
+	iterateStmts(nodep);
+    }
 
     void swapSides(AstNodeBiCom* nodep) {
 	// COMMUNATIVE({a},CONST) -> COMMUNATIVE(CONST,{a})
@@ -1757,6 +1779,7 @@ private:
 	    // Set the initial value right in the variable so we can constant propagate
 	    AstNode* initvaluep = exprp->cloneTree(false);
 	    varrefp->varp()->valuep(initvaluep);
+	    m_valueSet = true;
 	}
     }
 
@@ -2064,6 +2087,7 @@ private:
     TREEOP ("AstDivS  {$lhsp, $rhsp.isOne}",	"replaceWLhs(nodep)");
     TREEOP ("AstMul   {operandIsPowTwo($lhsp), $rhsp}",	"replaceMulShift(nodep)");  // a*2^n -> a<<n
     TREEOP ("AstDiv   {$lhsp, operandIsPowTwo($rhsp)}",	"replaceDivShift(nodep)");  // a/2^n -> a>>n
+    TREEOP ("AstModDiv{$lhsp, operandIsPowTwo($rhsp)}",	"replaceModAnd(nodep)");  // a % 2^n -> a&(2^n-1)
     TREEOP ("AstPow   {operandIsTwo($lhsp), $rhsp}",	"replacePowShift(nodep)");  // 2**a == 1<<a
     TREEOP ("AstSub   {$lhsp.castAdd, operandSubAdd(nodep)}", "AstAdd{AstSub{$lhsp->castAdd()->lhsp(),$rhsp}, $lhsp->castAdd()->rhsp()}"); // ((a+x)-y) -> (a+(x-y))
     // Trinary ops
@@ -2323,6 +2347,8 @@ public:
 	m_doShort = true;	// Presently always done
 	m_doV = false;
 	m_doGenerate = false;	// Inside generate conditionals
+	m_editCnt = 0;
+	m_valueSet = false;
 	m_warn = false;
 	m_wremove = true;  // Overridden in visitors
 	m_modp = NULL;
@@ -2342,6 +2368,8 @@ public:
 	}
     }
     virtual ~ConstVisitor() {}
+    void incrementalSince(vluint64_t editCnt) { m_editCnt = editCnt; }
+    bool valueSet() const { return m_valueSet; }
     AstNode* mainAcceptEdit(AstNode* nodep) {
 	// Operate starting at a random place
 	return nodep->iterateSubtreeReturnEdits(*this);
@@ -2435,11 +2463,35 @@ void V3Const::constifyAllLive(AstNetlist* nodep) {
     V3Global::dumpCheckGlobalTree("const.tree", 0, v3Global.opt.dumpTreeLevel(__FILE__) >= 3);
 }
 
+static bool constVarEditedSince(AstNetlist* nodep, vluint64_t editCnt) {
+    // A reference folds according to its variable, yet editing the variable
+    // doesn't edit the statements that reference it.  So if any variable
+    // changed, every statement must be revisited.
+    for (AstNodeModule* modp = nodep->modulesp(); modp; modp=modp->nextp()->castNodeModule()) {
+	for (AstNode* stmtp = modp->stmtsp(); stmtp; stmtp=stmtp->nextp()) {
+	    if (stmtp->castVar() && stmtp->editedSince(editCnt)) return true;
+	}
+    }
+    return false;
+}
+
 void V3Const::constifyAll(AstNetlist* nodep) {
     // Only call from Verilator.cpp, as it uses user#'s
     UINFO(2,__FUNCTION__<<": "<<endl);
+    // Statements untouched since the previous call started were folded by it
+    // (or an earlier call), so only edited statements need visiting again.
+    // Attribute changes such as AstVar::sigPublic() aren't edits, hence
+    // this is off unless -ON.
+    vluint64_t lastEditCnt = v3Global.constEditCnt();
+    vluint64_t editCnt = AstNode::editCountGbl();
     ConstVisitor visitor (ConstVisitor::PROC_V_EXPENSIVE);
+    if (v3Global.opt.oConstIncr() && lastEditCnt
+	&& !constVarEditedSince(nodep, lastEditCnt)) {
+	visitor.incrementalSince(lastEditCnt);
+    }
     (void)visitor.mainAcceptEdit(nodep);
+    // Unedited references to a newly constant variable need a full pass
+    v3Global.constEditCnt(visitor.valueSet() ? 0 : editCnt);
     V3Global::dumpCheckGlobalTree("const.tree", 0, v3Global.opt.dumpTreeLevel(__FILE__) >= 3);
 }
 
@@ -0,0 +1,372 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//*************************************************************************
+// DESCRIPTION: Verilator: Common subexpression elimination
+//
+// Code available from: http://www.veripool.org/verilator
+//
+//*************************************************************************
+//
+// Copyright 2003-2017 by Wilson Snyder.  This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+//
+// Verilator is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+//*************************************************************************
+// V3Cse's Transformations:
+//
+// Each CFunc:
+//	Walk each statement list in order, hashing the pure expressions
+//	that are always evaluated by each ASSIGN rhs and IF condition.
+//	    If an identical expression was seen earlier in the same list, or
+//	    in an enclosing list, and no variable it reads has been written
+//	    since, then:
+//		Assign the earlier expression to a new STMTTEMP before its
+//		statement, and replace both occurrences with the temp.
+//	    Any assignment to a variable makes expressions reading it stale.
+//	    Calls, user C code, and $display etc make all expressions stale.
+//	    Leaving a statement list forgets the expressions seen in it,
+//	    as they don't dominate the statements that follow.
+//	    WHILE loops first mark everything they write, as the body
+//	    repeats after later writes in the loop.
+//
+//*************************************************************************
+
+#include "config_build.h"
+#include "verilatedos.h"
+#include <cstdio>
+#include <cstdarg>
+#include <unistd.h>
+#include <algorithm>
+#include <vector>
+
+#include "V3Global.h"
+#include "V3Cse.h"
+#include "V3Hashed.h"
+#include "V3Stats.h"
+#include "V3Ast.h"
+
+//######################################################################
+// Common debugging baseclass
+
+class CseBaseVisitor : public AstNVisitor {
+public:
+    static int debug() {
+	static int level = -1;
+	if (VL_UNLIKELY(level < 0)) level = v3Global.opt.debugSrcLevel(__FILE__);
+	return level;
+    }
+    static bool isBarrier(AstNode* nodep) {
+	// Node whose effects on variables can't be tracked
+	return (!nodep->isPure()
+		|| nodep->castCCall() || nodep->castCStmt() || nodep->castUCStmt()
+		|| nodep->castCMath() || nodep->castUCFunc()
+		|| nodep->castJumpGo() || nodep->castCReturn());
+    }
+};
+
+//######################################################################
+// Mark variables written under a statement
+
+class CseWriteVisitor : public CseBaseVisitor {
+private:
+    // NODE STATE
+    //  AstVar::user1()		-> int.  Step of last write (set by caller's AstUser1InUse)
+
+    // STATE
+    int		m_step;		// Step to mark writes with
+    bool	m_barrier;	// Found a node with untracked effects
+
+    // VISITORS
+    virtual void visit(AstNodeVarRef* nodep) {
+	if (nodep->lvalue()) nodep->varp()->user1(m_step);
+    }
+    virtual void visit(AstVar* nodep) {}
+    virtual void visit(AstNode* nodep) {
+	if (isBarrier(nodep)) m_barrier = true;
+	nodep->iterateChildren(*this);
+    }
+public:
+    // CONSTUCTORS
+    CseWriteVisitor(AstNode* nodep, int step) {
+	m_step = step;
+	m_barrier = false;
+	nodep->accept(*this);
+    }
+    virtual ~CseWriteVisitor() {}
+    bool barrier() const { return m_barrier; }
+};
+
+//######################################################################
+// Expression seen earlier in the function
+
+class CseEntry {
+public:
+    V3Hashed::iterator	m_it;		// Where in hash, the node is m_it->second
+    bool		m_inMap;	// m_it is valid
+    int			m_step;		// Step when expression was evaluated
+    AstVar*		m_varp;		// Temp holding the value, NULL if not reused yet
+    CseEntry(V3Hashed::iterator it, int step)
+	: m_it(it), m_inMap(true), m_step(step), m_varp(NULL) {}
+    ~CseEntry() {}
+};
+
+//######################################################################
+// Cse state, as a visitor of each AstNode
+
+class CseVisitor : public CseBaseVisitor {
+private:
+    // NODE STATE
+    //  AstVar::user1()		-> int.  Step of last write
+    //  AstNodeMath::user2p()	-> CseEntry*.  Entry for hashed expression
+    //  AstNodeMath::user3()	-> int.  Nodes in expression, or -1 if can't be reused
+    //  AstNode::user4()	-> Used by V3Hashed
+    AstUser1InUse	m_inuser1;
+    AstUser2InUse	m_inuser2;
+    AstUser3InUse	m_inuser3;
+
+    // STATE
+    AstNodeModule*	m_modp;		// Current module
+    AstCFunc*		m_funcp;	// Current function
+    V3Hashed		m_hashed;	// Expressions available for reuse
+    vector<CseEntry*>	m_entryps;	// Entries to delete when we are finished
+    vector<CseEntry*>	m_scopeps;	// Entries in the current statement list and those enclosing it
+    int			m_step;		// Step counter for writes
+    int			m_barrierStep;	// Step of last untracked effect
+    V3Double0		m_statCse;	// Statistic tracking
+
+    enum { CSE_MIN_NODES = 4 };		// Smaller expressions aren't worth a temp
+
+    // METHODS
+    int sizeIterate(AstNode* nodep) {
+	// Set user3 for the expression and those under it
+	int size = 1;
+	AstNodeVarRef* varrefp = nodep->castNodeVarRef();
+	if (!nodep->castNodeMath()
+	    || (varrefp && varrefp->lvalue())
+	    || isBarrier(nodep)
+	    || !nodep->isGateOptimizable()
+	    || !nodep->isPredictOptimizable()
+	    || !nodep->isSubstOptimizable()) {
+	    size = -1;
+	}
+	AstNode* opps[4] = { nodep->op1p(), nodep->op2p(), nodep->op3p(), nodep->op4p() };
+	for (int i=0; i<4; ++i) {
+	    for (AstNode* subp = opps[i]; subp; subp=subp->nextp()) {
+		int subsize = sizeIterate(subp);
+		if (size < 0 || subsize < 0) size = -1;
+		else size += subsize;
+	    }
+	}
+	nodep->user3(size);
+	return size;
+    }
+    bool isCandidate(AstNode* nodep) {
+	return (nodep->user3() >= CSE_MIN_NODES
+		&& nodep->dtypep()
+		&& !nodep->isWide()
+		&& !nodep->isDouble()
+		&& !nodep->isString());
+    }
+    bool varsUnchanged(AstNode* nodep, int step) {
+	if (AstNodeVarRef* varrefp = nodep->castNodeVarRef()) {
+	    if (varrefp->varp()->user1() > step) return false;
+	}
+	AstNode* opps[4] = { nodep->op1p(), nodep->op2p(), nodep->op3p(), nodep->op4p() };
+	for (int i=0; i<4; ++i) {
+	    for (AstNode* subp = opps[i]; subp; subp=subp->nextp()) {
+		if (!varsUnchanged(subp, step)) return false;
+	    }
+	}
+	return true;
+    }
+    void entryErase(CseEntry* entryp) {
+	if (entryp->m_inMap) {
+	    m_hashed.mmap().erase(entryp->m_it);
+	    entryp->m_inMap = false;
+	}
+    }
+    CseEntry* findEntry(AstNode* nodep) {
+	// Return still valid earlier identical expression, if any
+	pair<V3Hashed::iterator,V3Hashed::iterator> eqrange
+	    = m_hashed.mmap().equal_range(m_hashed.nodeKey(nodep));
+	for (V3Hashed::iterator eqit = eqrange.first; eqit != eqrange.second; ) {
+	    AstNode* node2p = eqit->second;
+	    ++eqit;  // As may erase
+	    if (nodep != node2p && m_hashed.sameNodes(nodep, node2p)) {
+		CseEntry* entryp = (CseEntry*)(node2p->user2p());
+		if (entryp->m_step >= m_barrierStep
+		    && varsUnchanged(node2p, entryp->m_step)) {
+		    return entryp;
+		}
+		// Stale, and this expression will replace it
+		entryErase(entryp);
+	    }
+	}
+	return NULL;
+    }
+    void addEntry(AstNode* nodep) {
+	CseEntry* entryp = new CseEntry(m_hashed.hashAndInsert(nodep), m_step);
+	m_entryps.push_back(entryp);
+	m_scopeps.push_back(entryp);
+	nodep->user2p(entryp);
+    }
+    void replaceWithTemp(AstNode* nodep, CseEntry* entryp) {
+	UINFO(8,"   CseReuse "<<nodep<<endl);
+	if (!entryp->m_varp) {
+	    // First reuse; evaluate the earlier expression into a temp before its statement
+	    AstNode* firstp = entryp->m_it->second;
+	    AstNode* stmtp = firstp;
+	    while (!stmtp->castNodeStmt()) stmtp = stmtp->backp();
+	    UINFO(8,"   CseFirst "<<firstp<<endl);
+	    string newvarname = ((string)"__Vcse"+cvtToStr(m_modp->varNumGetInc()));
+	    AstVar* varp = new AstVar (firstp->fileline(), AstVarType::STMTTEMP, newvarname,
+				       firstp->dtypep());
+	    varp->noSubst(true);  // Else V3Const would put the expressions back
+	    m_funcp->addInitsp(varp);
+	    entryp->m_varp = varp;
+	    AstNRelinker linker;
+	    firstp->unlinkFrBack(&linker);
+	    linker.relink(new AstVarRef(firstp->fileline(), varp, false));
+	    AstAssign* assp = new AstAssign (firstp->fileline(),
+					     new AstVarRef(firstp->fileline(), varp, true),
+					     firstp);
+	    stmtp->addHereThisAsNext(assp);
+	    // The temp's expression may later be changed by reuses under it,
+	    // so compare against this copy from now on
+	    entryp->m_it->second = nodep;
+	    nodep->user2p(entryp);
+	}
+	AstNRelinker linker;
+	nodep->unlinkFrBack(&linker);
+	linker.relink(new AstVarRef(nodep->fileline(), entryp->m_varp, false));
+	pushDeletep(nodep); VL_DANGLING(nodep);  // May be the compare copy, so only deleted when finished
+	++m_statCse;
+    }
+    bool cseExpr(AstNode* nodep, bool always) {
+	// Reuse or remember expressions under nodep; return true if changed
+	// Only expressions always evaluated may be remembered, as the temp
+	// evaluates them unconditionally.
+	if (isCandidate(nodep)) {
+	    m_hashed.hash(nodep);
+	    if (CseEntry* entryp = findEntry(nodep)) {
+		replaceWithTemp(nodep, entryp); VL_DANGLING(nodep);
+		return true;
+	    }
+	}
+	bool changed = false;
+	if (AstNodeCond* condp = nodep->castNodeCond()) {
+	    changed |= cseExpr(condp->condp(), always);
+	    changed |= cseExpr(condp->expr1p(), false);
+	    changed |= cseExpr(condp->expr2p(), false);
+	} else if (nodep->castLogAnd() || nodep->castLogOr() || nodep->castLogIf()) {
+	    AstNodeBiop* biopp = nodep->castNodeBiop();
+	    changed |= cseExpr(biopp->lhsp(), always);
+	    changed |= cseExpr(biopp->rhsp(), false);
+	} else {
+	    AstNode* opps[4] = { nodep->op1p(), nodep->op2p(), nodep->op3p(), nodep->op4p() };
+	    for (int i=0; i<4; ++i) {
+		for (AstNode* nextp, *subp = opps[i]; subp; subp=nextp) {
+		    nextp = subp->nextp();
+		    changed |= cseExpr(subp, always);
+		}
+	    }
+	}
+	if (changed) nodep->user4(0);  // Rehash, as below has changed
+	if (always && isCandidate(nodep)) {
+	    m_hashed.hash(nodep);
+	    addEntry(nodep);
+	}
+	return changed;
+    }
+    void markWrites(AstNode* nodep) {
+	CseWriteVisitor visitor (nodep, ++m_step);
+	if (visitor.barrier()) {
+	    UINFO(8,"   CseBarrier "<<nodep<<endl);
+	    m_barrierStep = ++m_step;
+	}
+    }
+    void cseStmt(AstNode* nodep) {
+	if (AstNodeAssign* assp = nodep->castNodeAssign()) {
+	    sizeIterate(assp->rhsp());
+	    cseExpr(assp->rhsp(), true);
+	    markWrites(assp);
+	} else if (AstNodeIf* ifp = nodep->castNodeIf()) {
+	    sizeIterate(ifp->condp());
+	    cseExpr(ifp->condp(), true);
+	    markWrites(ifp->condp());
+	    cseBlock(ifp->ifsp());
+	    cseBlock(ifp->elsesp());
+	} else if (AstWhile* whilep = nodep->castWhile()) {
+	    markWrites(whilep);
+	    cseBlock(whilep->bodysp());
+	} else if (nodep->castComment()) {
+	} else {
+	    // Unknown statement, don't look inside, but note what it changes
+	    markWrites(nodep);
+	    m_barrierStep = ++m_step;
+	}
+    }
+    void cseBlock(AstNode* stmtsp) {
+	size_t scopeStart = m_scopeps.size();
+	for (AstNode* nextp, *stmtp = stmtsp; stmtp; stmtp = nextp) {
+	    nextp = stmtp->nextp();
+	    cseStmt(stmtp);
+	}
+	// Later statements aren't dominated by this list's expressions
+	for (size_t i=scopeStart; i<m_scopeps.size(); ++i) {
+	    entryErase(m_scopeps[i]);
+	}
+	m_scopeps.resize(scopeStart);
+    }
+
+    // VISITORS
+    virtual void visit(AstNodeModule* nodep) {
+	m_modp = nodep;
+	nodep->iterateChildren(*this);
+	m_modp = NULL;
+    }
+    virtual void visit(AstCFunc* nodep) {
+	UINFO(4," CFUNC "<<nodep<<endl);
+	m_funcp = nodep;
+	m_hashed.clear();
+	m_barrierStep = ++m_step;
+	cseBlock(nodep->stmtsp());
+	m_funcp = NULL;
+    }
+    virtual void visit(AstVar* nodep) {}
+    virtual void visit(AstNodeMath* nodep) {}
+    virtual void visit(AstNode* nodep) {
+	nodep->iterateChildren(*this);
+    }
+public:
+    // CONSTUCTORS
+    explicit CseVisitor(AstNetlist* nodep) {
+	m_modp = NULL;
+	m_funcp = NULL;
+	m_step = 0;
+	m_barrierStep = 0;
+	nodep->accept(*this);
+    }
+    virtual ~CseVisitor() {
+	V3Stats::addStat("Optimizations, Common subexpressions", m_statCse);
+	for (vector<CseEntry*>::iterator it = m_entryps.begin(); it != m_entryps.end(); ++it) {
+	    delete (*it);
+	}
+    }
+};
+
+//######################################################################
+// Cse class functions
+
+void V3Cse::cseAll(AstNetlist* nodep) {
+    UINFO(2,__FUNCTION__<<": "<<endl);
+    {
+	CseVisitor visitor (nodep);
+    }  // Destruct before checking
+    V3Global::dumpCheckGlobalTree("cse.tree", 0, v3Global.opt.dumpTreeLevel(__FILE__) >= 3);
+}
@@ -20,6 +20,8 @@
 // DEAD TRANSFORMATIONS:
 //	Remove any unreferenced modules
 //	Remove any unreferenced variables
+//	Removals that free other nodes are followed with worklists, so the
+//	sweep costs time in proportion to what is removed
 //
 // TODO: A graph would make the process of circular and interlinked
 // dependencies easier to resolve.
@@ -57,10 +59,13 @@ class DeadModVisitor : public AstNVisitor {
 private:
     // NODE STATE
     // ** Shared with DeadVisitor **
+    // STATE
+    vector<AstNodeModule*>*	m_deadModsp;	// Modules that have lost their last reference
     // VISITORS
     virtual void visit(AstCell* nodep) {
 	nodep->iterateChildren(*this);
 	nodep->modp()->user1Inc(-1);
+	if (nodep->modp()->user1() == 0) m_deadModsp->push_back(nodep->modp());
     }
     //-----
     virtual void visit(AstNodeMath* nodep) {}  // Accelerate
@@ -69,7 +74,8 @@ private:
     }
 public:
     // CONSTRUCTORS
-    explicit DeadModVisitor(AstNodeModule* nodep) {
+    DeadModVisitor(AstNodeModule* nodep, vector<AstNodeModule*>* deadModsp) {
+	m_deadModsp = deadModsp;
 	nodep->accept(*this);
     }
     virtual ~DeadModVisitor() {}
@@ -86,7 +92,9 @@ private:
     //	AstVar::user1()		-> int. Count of number of references
     //	AstVarScope::user1()	-> int. Count of number of references
     //	AstNodeDType::user1()	-> int. Count of number of references
+    //	AstScope::user2()	-> bool. Empty, so may be removed (deadCheckScope)
     AstUser1InUse	m_inuser1;
+    AstUser2InUse	m_inuser2;
 
     // TYPES
     typedef multimap<AstVarScope*,AstNodeAssign*>	AssignMap;
@@ -271,25 +279,28 @@ private:
     }
 
     // METHODS
+    bool mightElimMod(AstNodeModule* modp) {
+	// > 2 because L1 is the wrapper, L2 is the top user module
+	return modp->level()>2 && modp->user1()==0 && !modp->internal();
+    }
     void deadCheckMod() {
 	// Kill any unused modules
 	// V3LinkCells has a graph that is capable of this too, but we need to do it
 	// after we've done all the generate blocks
-	for (bool retry=true; retry; ) {
-	    retry=false;
-	    AstNodeModule* nextmodp;
-	    for (AstNodeModule* modp = v3Global.rootp()->modulesp(); modp; modp=nextmodp) {
-		nextmodp = modp->nextp()->castNodeModule();
-		if (modp->level()>2	&& modp->user1()==0 && !modp->internal()) {
-		    // > 2 because L1 is the wrapper, L2 is the top user module
-		    UINFO(4,"  Dead module "<<modp<<endl);
-		    // And its children may now be killable too; correct counts
-		    // Recurse, as cells may not be directly under the module but in a generate
-		    DeadModVisitor visitor(modp);
-		    modp->unlinkFrBack()->deleteTree(); VL_DANGLING(modp);
-		    retry = true;
-		}
-	    }
+	// Killing a module may kill the modules it instantiates, so keep a worklist
+	// rather than rescanning every module after each removal
+	vector<AstNodeModule*> deadModsp;
+	for (AstNodeModule* modp = v3Global.rootp()->modulesp(); modp; modp=modp->nextp()->castNodeModule()) {
+	    if (mightElimMod(modp)) deadModsp.push_back(modp);
+	}
+	while (!deadModsp.empty()) {
+	    AstNodeModule* modp = deadModsp.back(); deadModsp.pop_back();
+	    if (!mightElimMod(modp)) continue;
+	    UINFO(4,"  Dead module "<<modp<<endl);
+	    // And its children may now be killable too; correct counts
+	    // Recurse, as cells may not be directly under the module but in a generate
+	    DeadModVisitor visitor(modp, &deadModsp);
+	    modp->unlinkFrBack()->deleteTree(); VL_DANGLING(modp);
 	}
     }
     bool mightElimVar(AstVar* nodep) {
@@ -301,23 +312,23 @@ private:
     }
 
     void deadCheckScope() {
-	for (bool retry=true; retry; ) {
-	    retry = false;
-	    for (vector<AstScope*>::iterator it = m_scopesp.begin(); it != m_scopesp.end();++it) {
-		AstScope* scp = *it;
-		if (!scp)
-		    continue;
-		if (scp->user1() == 0) {
-		    UINFO(4, "	Dead AstScope " << scp << endl);
-		    scp->aboveScopep()->user1Inc(-1);
-		    if (scp->dtypep()) {
-			scp->dtypep()->user1Inc(-1);
-		    }
-		    scp->unlinkFrBack()->deleteTree(); VL_DANGLING(scp);
-		    *it = NULL;
-		    retry = true;
-		}
+	// Killing a scope may kill the empty scope above it, so keep a worklist
+	// rather than rescanning every scope after each removal
+	vector<AstScope*> deadScopesp;
+	for (vector<AstScope*>::iterator it = m_scopesp.begin(); it != m_scopesp.end();++it) {
+	    (*it)->user2(true);
+	    if ((*it)->user1() == 0) deadScopesp.push_back(*it);
+	}
+	while (!deadScopesp.empty()) {
+	    AstScope* scp = deadScopesp.back(); deadScopesp.pop_back();
+	    UINFO(4, "	Dead AstScope " << scp << endl);
+	    AstScope* abovep = scp->aboveScopep();
+	    abovep->user1Inc(-1);
+	    if (abovep->user1() == 0 && abovep->user2()) deadScopesp.push_back(abovep);
+	    if (scp->dtypep()) {
+		scp->dtypep()->user1Inc(-1);
 	    }
+	    scp->unlinkFrBack()->deleteTree(); VL_DANGLING(scp);
 	}
     }
 
@@ -349,21 +360,17 @@ private:
 		vscp->unlinkFrBack()->deleteTree(); VL_DANGLING(vscp);
 	    }
 	}
-	for (bool retry=true; retry; ) {
-	    retry = false;
-	    for (vector<AstVar *>::iterator it = m_varsp.begin(); it != m_varsp.end();++it) {
-		AstVar* varp = *it;
-		if (!varp)
-		    continue;
-		if (varp->user1() == 0) {
-		    UINFO(4, "	Dead " << varp << endl);
-		    if (varp->dtypep()) {
-			varp->dtypep()->user1Inc(-1);
-		    }
-		    varp->unlinkFrBack()->deleteTree(); VL_DANGLING(varp);
-		    *it = NULL;
-		    retry = true;
+	// Removing a variable only lowers its dtype's count, never another
+	// variable's, so one pass finds them all
+	for (vector<AstVar *>::iterator it = m_varsp.begin(); it != m_varsp.end();++it) {
+	    AstVar* varp = *it;
+	    if (varp->user1() == 0) {
+		UINFO(4, "	Dead " << varp << endl);
+		if (varp->dtypep()) {
+		    varp->dtypep()->user1Inc(-1);
 		}
+		varp->unlinkFrBack()->deleteTree(); VL_DANGLING(varp);
+		*it = NULL;
 	    }
 	}
 	for (vector<AstNode*>::iterator it = m_dtypesp.begin(); it != m_dtypesp.end();++it) {
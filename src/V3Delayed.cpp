@@ -49,6 +49,27 @@
 //	...
 //	ASSIGNW (BITSEL(ARRAYSEL(VARREF(x), __Vdlyvdim_x), __Vdlyvlsb_x), __Vdlyvval_x)
 //
+// ASSIGNDLY (ARRAYSEL (VARREF(v), bits), rhs) inside a loop
+// ->	VAR __Vdlyvqidx_x[depth]	Write log of addresses
+//	VAR __Vdlyvqval_x[depth]	Write log of values
+//	VAR __Vdlyvqcnt_x		Entries in the log
+//	ASSIGNPRE (__Vdlyvqcnt_x, 0)
+//	...
+//	IF (__Vdlyvqcnt_x < depth)
+//	    ASSIGN (ARRAYSEL(__Vdlyvqidx_x, __Vdlyvqcnt_x), bits)
+//	    ASSIGN (ARRAYSEL(__Vdlyvqval_x, __Vdlyvqcnt_x), rhs)
+//	    ASSIGN (__Vdlyvqcnt_x, __Vdlyvqcnt_x + 1)
+//	ELSE STOP
+//	...
+//	Commit the log in order, so the last write to an address wins:
+//	WHILE (__Vdlyvqi_x < __Vdlyvqcnt_x)
+//	    ASSIGN (ARRAYSEL(VARREF(x), ARRAYSEL(__Vdlyvqidx_x, __Vdlyvqi_x)),
+//		    ARRAYSEL(__Vdlyvqval_x, __Vdlyvqi_x))
+//
+// If an array is referenced only by a single always block, and that block
+// reads it only before its first delayed write, no same-cycle read can see
+// the write, and the ASSIGNDLY becomes a plain ASSIGN with no temporaries.
+//
 //*************************************************************************
 
 #include "config_build.h"
@@ -58,6 +79,7 @@
 #include <unistd.h>
 #include <algorithm>
 #include <map>
+#include <set>
 #include <deque>
 
 #include "V3Global.h"
@@ -65,6 +87,117 @@
 #include "V3Ast.h"
 #include "V3Stats.h"
 
+//######################################################################
+
+#define DELAYED_QUEUE_MAX_DEPTH 4096	// Max array entries to use a write log for
+
+//######################################################################
+// Find arrays whose delayed assignments may be made immediate
+
+class DelayedElideVisitor : public AstNVisitor {
+public:
+    typedef std::set<AstVarScope*> VscSet;
+private:
+    // TYPES
+    struct ArrayInfo {
+	AstNode*	m_blockp;	// Only always block referencing the array
+	AstWhile*	m_readLoopp;	// Outermost loop of last read, or NULL
+	bool		m_written;	// Has seen a delayed write
+	bool		m_bad;		// Can't elide
+	ArrayInfo() : m_blockp(NULL), m_readLoopp(NULL), m_written(false), m_bad(false) {}
+    };
+    typedef std::map<AstVarScope*,ArrayInfo> InfoMap;
+
+    // STATE
+    InfoMap		m_infos;	// Usage of each array
+    AstNode*		m_blockp;	// Current always block
+    AstWhile*		m_loopp;	// Outermost loop in current block
+    bool		m_inDly;	// True in delayed assignments
+    bool		m_inInitial;	// True in intial blocks
+    VscSet		m_elided;	// Arrays that may be elided
+
+    // METHODS
+    static int debug() {
+	static int level = -1;
+	if (VL_UNLIKELY(level < 0)) level = v3Global.opt.debugSrcLevel(__FILE__);
+	return level;
+    }
+
+    void bad(ArrayInfo& info, AstNode* nodep, const char* reasonp) {
+	if (!info.m_bad) UINFO(6,"    NoElide "<<reasonp<<" "<<nodep<<endl);
+	info.m_bad = true;
+    }
+
+    // VISITORS
+    virtual void visit(AstActive* nodep) {
+	bool oldinit = m_inInitial;
+	m_inInitial = nodep->hasInitial();
+	nodep->iterateChildren(*this);
+	m_inInitial = oldinit;
+    }
+    virtual void visit(AstAlways* nodep) {
+	m_blockp = nodep;
+	nodep->iterateChildren(*this);
+	m_blockp = NULL;
+    }
+    virtual void visit(AstWhile* nodep) {
+	AstWhile* oldloopp = m_loopp;
+	if (!m_loopp) m_loopp = nodep;
+	nodep->iterateChildren(*this);
+	m_loopp = oldloopp;
+    }
+    virtual void visit(AstAssignDly* nodep) {
+	m_inDly = true;
+	nodep->iterateChildren(*this);
+	m_inDly = false;
+    }
+    virtual void visit(AstVarRef* nodep) {
+	AstVarScope* vscp = nodep->varScopep();
+	if (!vscp || !nodep->varp()->dtypeSkipRefp()->castUnpackArrayDType()) return;
+	if (m_inInitial) return;  // Runs once before any clock
+	ArrayInfo& info = m_infos[vscp];
+	if (nodep->varp()->isSigPublic() || nodep->varp()->isIO()) {
+	    bad(info, nodep, "public");
+	} else if (!m_blockp || (info.m_blockp && info.m_blockp != m_blockp)) {
+	    bad(info, nodep, "multiple blocks");
+	} else if (nodep->lvalue()) {
+	    if (!m_inDly) {
+		bad(info, nodep, "blocking write");
+	    } else if (!(nodep->backp()->castArraySel()
+			 && nodep->backp()->castArraySel()->fromp() == nodep)) {
+		bad(info, nodep, "whole array write");
+	    } else if (m_loopp && info.m_readLoopp == m_loopp) {
+		bad(info, nodep, "loop reads earlier write");
+	    }
+	    info.m_written = true;
+	} else {
+	    if (info.m_written) bad(info, nodep, "read after write");
+	    info.m_readLoopp = m_loopp;
+	}
+	info.m_blockp = m_blockp;
+    }
+    virtual void visit(AstNode* nodep) {
+	nodep->iterateChildren(*this);
+    }
+public:
+    // CONSTUCTORS
+    explicit DelayedElideVisitor(AstNetlist* nodep) {
+	m_blockp = NULL;
+	m_loopp = NULL;
+	m_inDly = false;
+	m_inInitial = false;
+	nodep->accept(*this);
+	for (InfoMap::iterator it = m_infos.begin(); it != m_infos.end(); ++it) {
+	    if (it->second.m_written && !it->second.m_bad) {
+		UINFO(4,"  Elide "<<it->first<<endl);
+		m_elided.insert(it->first);
+	    }
+	}
+    }
+    virtual ~DelayedElideVisitor() {}
+    const VscSet& elided() const { return m_elided; }
+};
+
 //######################################################################
 // Delayed state, as a visitor of each AstNode
 
@@ -99,9 +232,21 @@ private:
     bool		m_inDly;	// True in delayed assignments
     bool		m_inLoop;	// True in for loops
     bool		m_inInitial;	// True in intial blocks
+    AstWhile*		m_loopp;	// Outermost loop
     typedef std::map<pair<AstNodeModule*,string>,AstVar*> VarMap;
     VarMap		m_modVarMap;	// Table of new var names created under module
+    struct QueueVars {
+	AstVarScope*	m_idxvscp;	// Write log of addresses
+	AstVarScope*	m_valvscp;	// Write log of values
+	AstVarScope*	m_cntvscp;	// Entries in the log
+	int		m_depth;	// Entries the log may hold
+    };
+    typedef std::map<pair<AstVarScope*,AstWhile*>,QueueVars> QueueMap;
+    QueueMap		m_queueMap;	// Write logs created under current active
+    const DelayedElideVisitor::VscSet& m_elided;  // Arrays whose writes may be immediate
     V3Double0		m_statSharedSet;// Statistic tracking
+    V3Double0		m_statElided;	// Statistic tracking
+    V3Double0		m_statQueued;	// Statistic tracking
 
 
     // METHODS
@@ -337,6 +482,111 @@ private:
 	return newlhsp;
     }
 
+    AstVarScope* elidedArray(AstNode* lhsp) {
+	// Return array's var scope if its delayed writes may be immediate
+	while (true) {
+	    if (AstSel* selp = lhsp->castSel()) lhsp = selp->fromp();
+	    else if (AstArraySel* selp = lhsp->castArraySel()) lhsp = selp->fromp();
+	    else break;
+	}
+	AstVarRef* varrefp = lhsp->castVarRef();
+	if (varrefp && m_elided.find(varrefp->varScopep()) != m_elided.end()) {
+	    return varrefp->varScopep();
+	}
+	return NULL;
+    }
+    AstVarScope* createQueueArray(AstVarRef* varrefp, const string& name, int depth, AstNodeDType* subDTypep) {
+	FileLine* fl = varrefp->fileline();
+	AstNodeArrayDType* dtypep
+	    = new AstUnpackArrayDType(fl, subDTypep, new AstRange(fl, depth-1, 0));
+	v3Global.rootp()->typeTablep()->addTypesp(dtypep);
+	return createVarSc(varrefp->varScopep(), name, 0, dtypep);
+    }
+    bool createDlyQueue(AstAssignDly* nodep, AstNode* lhsp) {
+	// Create delayed assignment to an array inside a loop, where the temporaries
+	// of createDlyArray would be overwritten by each iteration.
+	// See top of this file for transformation
+	// Return false if unsupported
+	AstArraySel* arrayselp = lhsp->castArraySel();
+	if (!arrayselp) return false;  // Bit select
+	AstVarRef* varrefp = arrayselp->fromp()->castVarRef();
+	if (!varrefp) return false;  // Multiple dimensions
+	AstUnpackArrayDType* adtypep = varrefp->varp()->dtypeSkipRefp()->castUnpackArrayDType();
+	if (!adtypep || adtypep->elementsConst() > DELAYED_QUEUE_MAX_DEPTH) return false;
+	FileLine* fl = nodep->fileline();
+	UINFO(4,"AssignDlyQueue: "<<nodep<<endl);
+	//
+	//=== Find or create the log for this array and loop
+	pair<AstVarScope*,AstWhile*> key = make_pair(varrefp->varScopep(), m_loopp);
+	QueueMap::iterator it = m_queueMap.find(key);
+	if (it == m_queueMap.end()) {
+	    AstVar* oldvarp = varrefp->varp();
+	    int modVecNum = oldvarp->user4();  oldvarp->user4(modVecNum+1);
+	    string suffix = "__"+oldvarp->shortName()+"__v"+cvtToStr(modVecNum);
+	    QueueVars vars;
+	    vars.m_depth = adtypep->elementsConst();
+	    vars.m_idxvscp = createQueueArray(varrefp, "__Vdlyvqidx"+suffix, vars.m_depth,
+					      arrayselp->bitp()->dtypep());
+	    vars.m_valvscp = createQueueArray(varrefp, "__Vdlyvqval"+suffix, vars.m_depth,
+					      arrayselp->dtypep());
+	    vars.m_cntvscp = createVarSc(varrefp->varScopep(), "__Vdlyvqcnt"+suffix, 32, NULL);
+	    AstVarScope* ivscp = createVarSc(varrefp->varScopep(), "__Vdlyvqi"+suffix, 32, NULL);
+	    it = m_queueMap.insert(make_pair(key, vars)).first;
+	    //
+	    // Commit the log under the ALWAYSPOST for the array, in order with
+	    // any other delayed assignments to it
+	    AstAlwaysPost* finalp = varrefp->varScopep()->user4p()->castAlwaysPost();
+	    if (finalp) {
+		checkActivePost(varrefp, finalp->user2p()->castActive());
+	    } else {
+		finalp = new AstAlwaysPost(fl, NULL/*sens*/, NULL/*body*/);
+		AstActive* newactp = createActivePost(varrefp);
+		newactp->addStmtsp(finalp);
+		varrefp->varScopep()->user4p(finalp);
+		finalp->user2p(newactp);
+	    }
+	    finalp->user2p()->castActive()->addStmtsp(
+		new AstAssignPre(fl, new AstVarRef(fl, vars.m_cntvscp, true),
+				 new AstConst(fl, AstConst::Unsized32(), 0)));
+	    finalp->addBodysp(new AstAssign(fl, new AstVarRef(fl, ivscp, true),
+					    new AstConst(fl, AstConst::Unsized32(), 0)));
+	    AstNode* commitp
+		= new AstAssign(fl,
+				new AstArraySel(fl, new AstVarRef(fl, varrefp->varScopep(), true),
+						new AstArraySel(fl, new AstVarRef(fl, vars.m_idxvscp, false),
+								new AstVarRef(fl, ivscp, false))),
+				new AstArraySel(fl, new AstVarRef(fl, vars.m_valvscp, false),
+						new AstVarRef(fl, ivscp, false)));
+	    AstNode* incp
+		= new AstAssign(fl, new AstVarRef(fl, ivscp, true),
+				new AstAdd(fl, new AstVarRef(fl, ivscp, false),
+					   new AstConst(fl, AstConst::Unsized32(), 1)));
+	    finalp->addBodysp(new AstWhile(fl, new AstLt(fl, new AstVarRef(fl, ivscp, false),
+							 new AstVarRef(fl, vars.m_cntvscp, false)),
+					   commitp, incp));
+	    finalp->user3p(NULL);  // Later IFs must not share across the commit
+	    finalp->user4p(NULL);
+	}
+	const QueueVars& vars = it->second;
+	//
+	//=== Append to the log; a loop writing more entries than the array has stops
+	AstNode* logp
+	    = new AstAssign(fl, new AstArraySel(fl, new AstVarRef(fl, vars.m_idxvscp, true),
+						new AstVarRef(fl, vars.m_cntvscp, false)),
+			    arrayselp->bitp()->unlinkFrBack());
+	logp->addNext(new AstAssign(fl, new AstArraySel(fl, new AstVarRef(fl, vars.m_valvscp, true),
+							new AstVarRef(fl, vars.m_cntvscp, false)),
+				    nodep->rhsp()->unlinkFrBack()));
+	logp->addNext(new AstAssign(fl, new AstVarRef(fl, vars.m_cntvscp, true),
+				    new AstAdd(fl, new AstVarRef(fl, vars.m_cntvscp, false),
+					       new AstConst(fl, AstConst::Unsized32(), 1))));
+	nodep->addNextHere(new AstIf(fl, new AstLt(fl, new AstVarRef(fl, vars.m_cntvscp, false),
+						   new AstConst(fl, AstConst::Unsized32(), vars.m_depth)),
+				     logp, new AstStop(fl)));
+	++m_statQueued;
+	return true;
+    }
+
     // VISITORS
     virtual void visit(AstNetlist* nodep) {
 	//VV*****  We reset all userp() on the netlist
@@ -358,6 +608,7 @@ private:
 	bool oldinit = m_inInitial;
 	m_inInitial = nodep->hasInitial();
 	AstNode::user3ClearTree();  // Two sets to same variable in different actives must use different vars.
+	m_queueMap.clear();
 	nodep->iterateChildren(*this);
 	m_inInitial = oldinit;
     }
@@ -368,9 +619,30 @@ private:
 	if (nodep->lhsp()->castArraySel()
 	    || (nodep->lhsp()->castSel()
 		&& nodep->lhsp()->castSel()->fromp()->castArraySel())) {
+	    if (AstVarScope* vscp = elidedArray(nodep->lhsp())) {
+		// No same-cycle read can see the write, so it may be immediate
+		UINFO(4,"AssignDlyElide: "<<nodep<<endl);
+		AstNode* newp = new AstAssign(nodep->fileline(), nodep->lhsp()->unlinkFrBack(),
+					      nodep->rhsp()->unlinkFrBack());
+		nodep->replaceWith(newp); pushDeletep(nodep); VL_DANGLING(nodep);
+		if (!vscp->user5()) ++m_statElided;
+		markVarUsage(vscp, VU_DLY);
+		m_inDly = false;
+		m_nextDlyp = NULL;
+		return;
+	    }
 	    AstNode* lhsp = nodep->lhsp()->unlinkFrBack();
+	    if (m_inLoop) {
+		if (createDlyQueue(nodep, lhsp)) {
+		    nodep->unlinkFrBack()->deleteTree(); VL_DANGLING(nodep);
+		    lhsp->deleteTree(); VL_DANGLING(lhsp);
+		    m_inDly = false;
+		    m_nextDlyp = NULL;
+		    return;
+		}
+		nodep->v3warn(E_BLKLOOPINIT,"Unsupported: Delayed assignment to array inside for loops (non-delayed is ok - see docs)");
+	    }
 	    AstNode* newlhsp = createDlyArray(nodep, lhsp);
-	    if (m_inLoop) nodep->v3warn(E_BLKLOOPINIT,"Unsupported: Delayed assignment to array inside for loops (non-delayed is ok - see docs)");
 	    if (newlhsp) {
 		nodep->lhsp(newlhsp);
 	    } else {
@@ -437,9 +709,12 @@ private:
     }
     virtual void visit(AstWhile* nodep) {
 	bool oldloop = m_inLoop;
+	AstWhile* oldloopp = m_loopp;
 	m_inLoop = true;
+	if (!m_loopp) m_loopp = nodep;
 	nodep->iterateChildren(*this);
 	m_inLoop = oldloop;
+	m_loopp = oldloopp;
     }
 
     //--------------------
@@ -450,18 +725,22 @@ private:
 
 public:
     // CONSTUCTORS
-    explicit DelayedVisitor(AstNetlist* nodep) {
+    DelayedVisitor(AstNetlist* nodep, const DelayedElideVisitor::VscSet& elided)
+	: m_elided(elided) {
 	m_inDly = false;
 	m_activep=NULL;
 	m_cfuncp=NULL;
 	m_nextDlyp=NULL;
 	m_inLoop = false;
+	m_loopp = NULL;
 	m_inInitial = false;
 
 	nodep->accept(*this);
     }
     virtual ~DelayedVisitor() {
 	V3Stats::addStat("Optimizations, Delayed shared-sets", m_statSharedSet);
+	V3Stats::addStat("Optimizations, Delayed arrays made immediate", m_statElided);
+	V3Stats::addStat("Optimizations, Delayed array writes logged", m_statQueued);
     }
 };
 
@@ -470,6 +749,7 @@ public:
 
 void V3Delayed::delayedAll(AstNetlist* nodep) {
     UINFO(2,__FUNCTION__<<": "<<endl);
-    DelayedVisitor visitor (nodep);
+    DelayedElideVisitor elideVisitor (nodep);
+    DelayedVisitor visitor (nodep, elideVisitor.elided());
     V3Global::dumpCheckGlobalTree("delayed.tree", 0, v3Global.opt.dumpTreeLevel(__FILE__) >= 3);
 }
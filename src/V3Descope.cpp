@@ -87,7 +87,11 @@ private:
 	    hierThisr = false;
 	    return name+"->";
 	} else {
-	    // Reference to something else, use global variable
+	    // Reference to something else, use global variable.
+	    // Every non-top instance is a member of the symbol table, so this is
+	    // a constant displacement from vlSymsp, not a further pointer load.
+	    // Only the top instance is reached through a pointer, loaded once per
+	    // function into vlTOPp.
 	    UINFO(8,"      Descope "<<scopep<<endl);
 	    UINFO(8,"           to "<<scopep->name()<<endl);
 	    UINFO(8,"        under "<<m_scopep->name()<<endl);
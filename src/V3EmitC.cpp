@@ -27,14 +27,134 @@
 #include <map>
 #include <vector>
 #include <algorithm>
+#include <queue>
 
 #include "V3Global.h"
 #include "V3String.h"
 #include "V3EmitC.h"
 #include "V3EmitCBase.h"
 #include "V3Number.h"
+#include "V3Os.h"
+#include "V3Stats.h"
+#include "V3Branch.h"
 
 #define VL_VALUE_STRING_MAX_WIDTH 8192	// We use a static char array in VL_VALUE_STRING
+#define RESET_LAZY_MIN_BYTES 65536	// Memories at least this large get VL_RAND_RESET_MEM
+
+//######################################################################
+// Classify variables by the functions using them, for --layout-hot-cold
+
+class EmitCVarLayoutVisitor : public EmitCBaseVisitor {
+public:
+    // TYPES
+    enum VarUse { VU_NONE=0, VU_SLOW=1, VU_TRACE=2, VU_HOT=4 };
+private:
+    // NODE STATE
+    // Entire netlist, kept while the modules are emitted
+    //  AstVar::user4()	-> int.  VarUse flags of the functions referencing it
+    AstUser4InUse	m_inuser4;
+
+    // STATE
+    AstCFunc*	m_funcp;	// Current function
+
+    // VISITORS
+    virtual void visit(AstCFunc* nodep) {
+	m_funcp = nodep;
+	nodep->iterateChildren(*this);
+	m_funcp = NULL;
+    }
+    virtual void visit(AstVarRef* nodep) {
+	if (m_funcp) {
+	    int use = (m_funcp->funcType().isTrace() ? VU_TRACE
+		       : m_funcp->slow() ? VU_SLOW : VU_HOT);
+	    nodep->varp()->user4(nodep->varp()->user4() | use);
+	}
+    }
+    virtual void visit(AstNode* nodep) {
+	nodep->iterateChildren(*this);
+    }
+public:
+    // CONSTUCTORS
+    explicit EmitCVarLayoutVisitor(AstNetlist* nodep) {
+	m_funcp = NULL;
+	nodep->accept(*this);
+    }
+    virtual ~EmitCVarLayoutVisitor() {}
+};
+
+//######################################################################
+// Find the other module classes each module's code refers to, for --output-min-includes
+
+class EmitCModRefVisitor : public EmitCBaseVisitor {
+public:
+    // TYPES
+    typedef set<string> ClassNames;
+private:
+    // NODE STATE
+    // Entire netlist, kept while the modules are emitted
+    //  AstVar::user5p()	-> AstNodeModule*.  Module declaring it
+    //  AstCFunc::user5p()	-> AstNodeModule*.  Module declaring it
+    AstUser5InUse	m_inuser5;
+
+    // STATE
+    typedef map<AstNodeModule*,ClassNames> ModRefs;
+    ModRefs		m_refs;		// Class names each module refers to
+    ClassNames		m_allClasses;	// Every module's class name
+    AstNodeModule*	m_modp;		// Current module
+    bool		m_collect;	// Second pass, collecting references
+
+    // METHODS
+    void addRef(AstNode* targetp) {
+	AstNodeModule* ownerp = targetp->user5p()->castNodeModule();
+	if (ownerp && ownerp != m_modp) m_refs[m_modp].insert(modClassName(ownerp));
+    }
+
+    // VISITORS
+    virtual void visit(AstNodeModule* nodep) {
+	m_modp = nodep;
+	if (!m_collect) m_allClasses.insert(modClassName(nodep));
+	nodep->iterateChildren(*this);
+	m_modp = NULL;
+    }
+    virtual void visit(AstVar* nodep) {
+	if (!m_collect) nodep->user5p(m_modp);
+	nodep->iterateChildren(*this);
+    }
+    virtual void visit(AstCFunc* nodep) {
+	if (!m_collect) nodep->user5p(m_modp);
+	nodep->iterateChildren(*this);
+    }
+    virtual void visit(AstVarRef* nodep) {
+	if (m_collect) addRef(nodep->varp());
+	nodep->iterateChildren(*this);
+    }
+    virtual void visit(AstCCall* nodep) {
+	if (m_collect) addRef(nodep->funcp());
+	nodep->iterateChildren(*this);
+    }
+    // $c code may refer to anything
+    virtual void visit(AstUCStmt* nodep) {
+	if (m_collect) m_refs[m_modp] = m_allClasses;
+    }
+    virtual void visit(AstUCFunc* nodep) {
+	if (m_collect) m_refs[m_modp] = m_allClasses;
+    }
+    virtual void visit(AstNode* nodep) {
+	nodep->iterateChildren(*this);
+    }
+public:
+    // CONSTUCTORS
+    explicit EmitCModRefVisitor(AstNetlist* nodep) {
+	m_modp = NULL;
+	m_collect = false;
+	nodep->accept(*this);
+	m_collect = true;
+	nodep->accept(*this);
+    }
+    virtual ~EmitCModRefVisitor() {}
+    // ACCESSORS
+    const ClassNames& refs(AstNodeModule* modp) { return m_refs[modp]; }
+};
 
 //######################################################################
 // Emit statements and math operators
@@ -42,10 +162,15 @@
 class EmitCStmts : public EmitCBaseVisitor {
 private:
     bool	m_suppressSemi;
+    bool	m_pinsChanged;		// Skip conversion of unchanged --pins-changed pins
     AstVarRef*	m_wideTempRefp;		// Variable that _WW macros should be setting
+    AstVarRef*	m_sformatDestp;		// String that a $sformatf is formatting into
     vector<AstVar*>		m_ctorVarsVec;		// All variables in constructor order
     int		m_splitSize;	// # of cfunc nodes placed into output file
     int		m_splitFilenum;	// File number being created, 0 = primary
+    int		m_loopDepth;	// Counted loops we are under, to name their counters
+    int		m_profBranchNum;	// --profile-branches counters in this function
+    FileLine*	m_lineDirFlp;	// --line-directives source of following code, or NULL for C++
 
 public:
     // METHODS
@@ -61,6 +186,7 @@ public:
     int splitSize() const { return m_splitSize; }
     void splitSizeInc(int count) { m_splitSize += count; }
     void splitSizeInc(AstNode* nodep) { splitSizeInc(EmitCBaseCounterVisitor(nodep).count()); }
+    void pinsChanged(bool flag) { m_pinsChanged = flag; }
     bool splitNeeded() { return (splitSize() && v3Global.opt.outputSplit()
 				 && v3Global.opt.outputSplit() < splitSize()); }
 
@@ -68,12 +194,39 @@ public:
     void displayNode(AstNode* nodep, AstScopeName* scopenamep,
 		     const string& vformat, AstNode* exprsp, bool isScan);
     void displayEmit(AstNode* nodep, bool isScan);
+    void displayEmitCompiled(AstNode* nodep);
+    void displayEmitArg(unsigned argn, bool isScan);
     void displayArg(AstNode* dispp, AstNode** elistp, bool isScan,
 		    const string& vfmt, char fmtLetter);
+    bool emitStringAssign(AstNodeAssign* nodep);
+    void putsLineDirective(AstNode* nodep) {
+	// With --line-directives, attribute the following code to the statement's
+	// Verilog source, so debuggers and sampling profilers report RTL lines
+	if (!v3Global.opt.lineDirectives()) return;
+	FileLine* flp = nodep->fileline();
+	if (m_lineDirFlp && m_lineDirFlp->lineno() == flp->lineno()
+	    && m_lineDirFlp->filename() == flp->filename()) return;
+	if (ofp()->column()) puts("\n");
+	ofp()->putsNoTracking("#line "+cvtToStr(flp->lineno())+" ");
+	ofp()->putsQuoted(flp->filename());
+	ofp()->putsNoTracking("\n");
+	m_lineDirFlp = flp;
+    }
+    void putsLineDirectiveEnd() {
+	// Return to the C++ file's own lines, for the code that isn't from a statement
+	if (!m_lineDirFlp) return;
+	if (ofp()->column()) puts("\n");
+	ofp()->putsNoTracking("#line "+cvtToStr(ofp()->lineno()+1)+" ");
+	ofp()->putsQuoted(V3Os::filenameNonDir(ofp()->filename()));
+	ofp()->putsNoTracking("\n");
+	m_lineDirFlp = NULL;
+    }
 
     void emitVarDecl(AstVar* nodep, const string& prefixIfImp);
     typedef enum {EVL_IO, EVL_SIG, EVL_TEMP, EVL_PAR, EVL_ALL} EisWhich;
     void emitVarList(AstNode* firstp, EisWhich which, const string& prefixIfImp);
+    typedef enum {EVG_HOT, EVG_COLD, EVG_TRACE} EisGroup;
+    int emitVarGroup(AstNode* firstp, EisGroup group);
     void emitVarCtors();
     bool emitSimpleOk(AstNodeMath* nodep);
     void emitIQW(AstNode* nodep) {
@@ -133,7 +286,12 @@ public:
 
     // VISITORS
     virtual void visit(AstNodeAssign* nodep) {
-	bool paren = true;  bool decind = false;
+	bool paren = true;  bool decind = false;  bool closeBrace = false;
+	if (!m_suppressSemi) putsLineDirective(nodep);
+	if (nodep->lhsp()->castVarRef() && nodep->lhsp()->isString() && !m_suppressSemi
+	    && emitStringAssign(nodep)) {
+	    return;
+	}
 	if (AstSel* selp=nodep->lhsp()->castSel()) {
 	    if (selp->widthMin()==1) {
 		putbs("VL_ASSIGNBIT_");
@@ -164,6 +322,16 @@ public:
 	    puts(cvtToStr(nodep->widthMin())+",");
 	    nodep->lhsp()->iterateAndNext(*this); puts(", ");
 	} else if (AstVar* varp = AstVar::scVarRecurse(nodep->rhsp())) {
+	    AstVarRef* pinRefp = nodep->rhsp()->castVarRef();
+	    if (pinRefp && pinsChangedVar(varp) && !m_suppressSemi) {
+		string pin = pinRefp->hiername()+varp->name();
+		string last = pinRefp->hiername()+pinsChangedName(varp);
+		if (m_pinsChanged) {
+		    puts("if (VL_UNLIKELY("+pin+".read() != "+last+")) {\n");
+		    closeBrace = true;
+		}
+		puts(last+" = "+pin+".read();\n");
+	    }
 	    putbs("VL_ASSIGN_"); 	// Get a systemC variable
 	    emitIQW(nodep);
 	    emitScIQW(varp);
@@ -194,10 +362,13 @@ public:
 	if (paren) puts(")");
 	if (decind) ofp()->blockDec();
 	if (!m_suppressSemi) puts(";\n");
+	if (closeBrace) puts("}\n");
     }
     virtual void visit(AstAlwaysPublic*) {
     }
     virtual void visit(AstCCall* nodep) {
+	bool isStmt = !(nodep->backp()->castNodeMath() || nodep->backp()->castCReturn());
+	if (isStmt) putsLineDirective(nodep);
 	puts(nodep->hiername());
 	puts(nodep->funcp()->name());
 	puts("(");
@@ -208,13 +379,45 @@ public:
 	    subnodep->accept(*this);
 	    comma = true;
 	}
-	if (nodep->backp()->castNodeMath() || nodep->backp()->castCReturn()) {
+	if (!isStmt) {
 	    // We should have a separate CCall for math and statement usage, but...
 	    puts(")");
 	} else {
 	    puts(");\n");
 	}
     }
+    virtual void visit(AstExecMTasks* nodep) {
+	// Macro-tasks are all static functions under the top module
+	int count = 0;
+	puts("{\n");
+	puts("static const VlMTaskFnp __Vmtasks[] = {");
+	for (AstCCall* callp = nodep->callsp(); callp; callp = callp->nextp()->castCCall()) {
+	    if (count++) puts(",");
+	    puts("\n&"+topClassName()+"::"+callp->funcp()->name());
+	}
+	puts("};\n");
+	puts("vlSymsp->__Vm_threadPoolp->execute(__Vmtasks, "+cvtToStr(count)+", vlSymsp);\n");
+	puts("}\n");
+    }
+    virtual void visit(AstExecInstances* nodep) {
+	// Instances are symbol table members, so table them as pointers-to-member
+	AstCCall* firstp = nodep->callsp();
+	string instClass = modClassName(firstp->funcp()->scopep()->modp());
+	int count = 0;
+	puts("{\n");
+	puts("static "+instClass+" "+symClassName()+"::* const __Vinsts[] = {");
+	for (AstCCall* callp = firstp; callp; callp = callp->nextp()->castCCall()) {
+	    // hiername is "vlSymsp->{member}."
+	    string hier = callp->hiername();
+	    if (count++) puts(",");
+	    puts("\n&"+symClassName()+"::"+hier.substr(9, hier.length()-10));
+	}
+	puts("};\n");
+	puts("for (int __Vi=0; __Vi<"+cvtToStr(count)+"; ++__Vi) {\n");
+	puts("(vlSymsp->*__Vinsts[__Vi])."+firstp->funcp()->name()+"("+firstp->argTypes()+");\n");
+	puts("}\n");
+	puts("}\n");
+    }
     virtual void visit(AstNodeCase* nodep) {
 	// In V3Case...
 	nodep->v3fatalSrc("Case statements should have been reduced out");
@@ -241,6 +444,11 @@ public:
 	puts(", ");	putsQuoted(nodep->comment());
 	puts(");\n");
     }
+    virtual void visit(AstActivityInc* nodep) {
+	puts("++(vlSymsp->__Vactivity[");
+	puts(cvtToStr(nodep->binNum()));
+	puts("]);\n");
+    }
     virtual void visit(AstCoverInc* nodep) {
 	puts("++(vlSymsp->__Vcoverage[");
 	puts(cvtToStr(nodep->declp()->dataDeclThisp()->binNum()));
@@ -252,6 +460,7 @@ public:
 	puts(");\n");
     }
     virtual void visit(AstDisplay* nodep) {
+	putsLineDirective(nodep);
 	string text = nodep->fmtp()->text();
 	if (nodep->addNewline()) text += "\n";
 	displayNode(nodep, nodep->fmtp()->scopeNamep(), text, nodep->fmtp()->exprsp(), false);
@@ -348,6 +557,8 @@ public:
 	putbs(", ");
 	nodep->filenamep()->iterateAndNext(*this);
 	putbs(", ");
+	if (nodep->memp()->castVarRef()
+	    && sparseArray(nodep->memp()->castVarRef()->varp())) puts("&");  // As VerilatedSparseMem*
 	nodep->memp()->iterateAndNext(*this);
 	putbs(","); if (nodep->lsbp()) { nodep->lsbp()->iterateAndNext(*this); }
 	else puts(cvtToStr(array_lsb));
@@ -406,21 +617,41 @@ public:
 	puts("__Vlabel"+cvtToStr(nodep->labelNum())+": ;\n");
     }
     virtual void visit(AstWhile* nodep) {
+	putsLineDirective(nodep);
 	nodep->precondsp()->iterateAndNext(*this);
-	puts("while (");
-	nodep->condp()->iterateAndNext(*this);
-	puts(") {\n");
+	if (nodep->loops()) {
+	    // V3Unroll found the condition holds for exactly loops() iterations;
+	    // a constant trip count lets the compiler unroll or vectorize
+	    string counter = "__Vloop"+cvtToStr(++m_loopDepth);
+	    puts("for (int "+counter+"=0; "+counter+"<"+cvtToStr(nodep->loops())+"; ++"+counter+") {\n");
+	} else {
+	    puts("while (");
+	    nodep->condp()->iterateAndNext(*this);
+	    puts(") {\n");
+	}
 	nodep->bodysp()->iterateAndNext(*this);
 	nodep->incsp()->iterateAndNext(*this);
 	nodep->precondsp()->iterateAndNext(*this);  // Need to recompute before next loop
+	if (nodep->loops()) --m_loopDepth;
 	puts("}\n");
     }
     virtual void visit(AstNodeIf* nodep) {
+	string profName;
+	if (v3Global.opt.profileBranches()) {
+	    // Named by source line, so --branch-profile can find it in the next build
+	    profName = "__Vprofbr"+cvtToStr(++m_profBranchNum);
+	    puts("static VerilatedProfBranch "+profName+" (");
+	    putsQuoted(V3Branch::profileName(nodep->fileline()));
+	    puts(");\n");
+	}
+	putsLineDirective(nodep);
 	puts("if (");
 	if (nodep->branchPred() != AstBranchPred::BP_UNKNOWN) {
 	    puts(nodep->branchPred().ascii()); puts("(");
 	}
+	if (profName != "") puts(profName+".count(");
 	nodep->condp()->iterateAndNext(*this);
+	if (profName != "") puts(")");
 	if (nodep->branchPred() != AstBranchPred::BP_UNKNOWN) puts(")");
 	puts(") {\n");
 	nodep->ifsp()->iterateAndNext(*this);
@@ -503,6 +734,23 @@ public:
 	    puts(")");
 	}
     }
+    bool emitDivConst(AstNodeBiop* nodep, const string& funcName) {
+	// Wide division by a constant that fits in a word, left by V3Premit;
+	// as a literal the C++ compiler reduces the division to multiplies
+	AstConst* constp = nodep->rhsp()->castConst();
+	if (!nodep->isWide() || !constp
+	    || constp->num().isFourState()
+	    || constp->num().mostSetBitP1() > VL_WORDSIZE) return false;
+	emitOpName(nodep, funcName+"(%lw, %P, %li, "+cvtToStr(constp->num().toUInt())+"U)",
+		   nodep->lhsp(), NULL, NULL);
+	return true;
+    }
+    virtual void visit(AstDiv* nodep) {
+	if (!emitDivConst(nodep, "VL_DIV_WWI")) visit(nodep->castNodeBiop());
+    }
+    virtual void visit(AstModDiv* nodep) {
+	if (!emitDivConst(nodep, "VL_MODDIV_WWI")) visit(nodep->castNodeBiop());
+    }
     virtual void visit(AstMulS* nodep) {
 	if (nodep->widthWords() > VL_MULS_MAX_WORDS) {
 	    nodep->v3error("Unsupported: Signed multiply of "<<nodep->width()<<" bits exceeds hardcoded limit VL_MULS_MAX_WORDS in verilatedos.h");
@@ -600,7 +848,25 @@ public:
     }
     // Terminals
     virtual void visit(AstVarRef* nodep) {
-	puts(nodep->hiername());
+	emitVarRef(nodep);
+    }
+    void emitVarRef(AstVarRef* nodep) {
+	if (nodep->lvalue() && vpiChgVar(nodep->varp())) {
+	    // Still an lvalue, so usable anywhere the variable is
+	    puts("VL_VPI_CHG(");
+	    puts(nodep->hiername());
+	    puts(vpiChgName(nodep->varp()));
+	    puts(", ");
+	    puts(nodep->hiername());
+	    puts(nodep->varp()->name());
+	    puts(")");
+	    return;
+	}
+	if (constPoolVar(nodep->varp())) {
+	    puts(symClassName()+"::");  // Shared by all modules, see EmitCSyms
+	} else {
+	    puts(nodep->hiername());
+	}
 	puts(nodep->varp()->name());
     }
     void emitCvtPackStr(AstNode* nodep) { 
@@ -637,8 +903,7 @@ public:
 	    if (!assigntop) {
 		puts(assignString);
 	    } else if (assigntop->castVarRef()) {
-		puts(assigntop->hiername());
-		puts(assigntop->varp()->name());
+		emitVarRef(assigntop);
 	    } else {
 		assigntop->iterateAndNext(*this);
 	    }
@@ -718,9 +983,14 @@ public:
 public:
     EmitCStmts() {
 	m_suppressSemi = false;
+	m_pinsChanged = false;
 	m_wideTempRefp = NULL;
+	m_sformatDestp = NULL;
 	m_splitSize = 0;
 	m_splitFilenum = 0;
+	m_loopDepth = 0;
+	m_profBranchNum = 0;
+	m_lineDirFlp = NULL;
     }
     virtual ~EmitCStmts() {}
 };
@@ -729,15 +999,69 @@ public:
 // Internal EmitC implementation
 
 class EmitCImp : EmitCStmts {
+    // TYPES
+    enum { CHANGEDET_CALL_WORDS = 4 };	// Compare wider signals with VL_NEQ_W, which may use SIMD
+
     // MEMBERS
     AstNodeModule*	m_modp;
     vector<AstChangeDet*>	m_blkChangeDetVec;	// All encountered changes in block
     bool	m_slow;		// Creating __Slow file
     bool	m_fast;		// Creating non __Slow file (or both)
+    vector<AstVar*>	m_resetVarps[4];	// --reset-tables: scalars to reset, by resetTableType
+    set<string>		m_splitTags;	// --output-split-stable file tags used in this module
+    EmitCModRefVisitor*	m_modRefsp;	// --output-min-includes classes referenced, or NULL
 
     //---------------------------------------
     // METHODS
 
+    static bool resetZero(AstVar* varp) {
+	return (varp->attrFileDescr() // Zero it out, so we don't core dump if never call $fopen
+		|| (varp->basicp() && varp->basicp()->isZeroInit())
+		|| (varp->name().size()>=1 && varp->name()[0]=='_' && v3Global.opt.underlineZero()));
+    }
+    int resetTableType(AstVar* varp) {
+	// Return which --reset-tables table a variable is reset by, or -1 if it needs its own statement
+	if (!v3Global.opt.resetTables()) return -1;
+	if (varp->isParam() || varp->isStatic() || varp->isSc() || varp->isWide()) return -1;
+	if (varp->isIO() && m_modp->isTop() && optSystemC()) return -1;
+	if (!varp->basicp() || varp->basicp()->isOpaque() || varp->basicp()->isDouble()) return -1;
+	if (varp->valuep() || varp->dtypeSkipRefp()->castUnpackArrayDType()) return -1;
+	if (resetZero(varp) || v3Global.opt.xInitialEdge()) return -1;
+	if (varp->widthMin() <= 8) return 0;
+	else if (varp->widthMin() <= 16) return 1;
+	else if (!varp->isQuad()) return 2;
+	else return 3;
+    }
+    void emitResetTables() {
+	// Reset each group of same-typed scalars by looping over a table of
+	// member pointers and widths, rather than a statement each, as this
+	// code only runs once but takes much of the compile time
+	static const char* const types[] = {"CData", "SData", "IData", "QData"};
+	string classname = modClassName(m_modp);
+	for (int type=0; type<4; ++type) {
+	    vector<AstVar*>& varps = m_resetVarps[type];
+	    if (varps.empty()) continue;
+	    puts("{ static "+string(types[type])+" "+classname+"::* const __Vrp[] = {\n");
+	    for (vector<AstVar*>::iterator it = varps.begin(); it != varps.end(); ++it) {
+		puts("&"+classname+"::"+(*it)->name()+",\n");
+	    }
+	    puts("};\n");
+	    puts("static const int __Vrw[] = {");
+	    for (vector<AstVar*>::iterator it = varps.begin(); it != varps.end(); ++it) {
+		if (it != varps.begin()) puts(",");
+		puts(cvtToStr((*it)->widthMin()));
+	    }
+	    puts("};\n");
+	    // MSVC++ pre V7 doesn't support 'for (int ...)', so declare in sep block
+	    puts("int __Vi=0;");
+	    puts(" for (; __Vi<"+cvtToStr(varps.size())+"; ++__Vi) {\n");
+	    puts("this->*__Vrp[__Vi] = VL_RAND_RESET_"+string(type==3 ? "Q" : "I")+"(__Vrw[__Vi]);\n");
+	    puts("}}\n");
+	    splitSizeInc(1);
+	    varps.clear();
+	}
+    }
+
     void doubleOrDetect(AstChangeDet* changep, bool& gotOne) {
 	if (!changep->rhsp()) {
 	    if (!gotOne) gotOne = true;
@@ -750,6 +1074,16 @@ class EmitCImp : EmitCStmts {
 	    static int addDoubleOr = 10;	// Determined experimentally as best
 	    if (!lhsp->castVarRef() && !lhsp->castArraySel()) changep->v3fatalSrc("Not ref?");
 	    if (!rhsp->castVarRef() && !rhsp->castArraySel()) changep->v3fatalSrc("Not ref?");
+	    if (lhsp->isWide() && lhsp->widthWords() >= CHANGEDET_CALL_WORDS) {
+		if (!gotOne) gotOne = true;
+		else puts(" | ");
+		puts("VL_NEQ_W("+cvtToStr(lhsp->widthWords())+", ");
+		lhsp->iterateAndNext(*this);
+		puts(", ");
+		rhsp->iterateAndNext(*this);
+		puts(")");
+		return;
+	    }
 	    for (int word=0; word<changep->lhsp()->widthWords(); word++) {
 		if (!gotOne) {
 		    gotOne = true;
@@ -772,9 +1106,11 @@ class EmitCImp : EmitCStmts {
 	}
     }
 
-    V3OutCFile* newOutCFile(AstNodeModule* modp, bool slow, bool source, int filenum=0) {
+    V3OutCFile* newOutCFile(AstNodeModule* modp, bool slow, bool source, int filenum=0,
+			    const string& filetag="") {
 	string filenameNoExt = v3Global.opt.makeDir()+"/"+ modClassName(modp);
-	if (filenum) filenameNoExt += "__"+cvtToStr(filenum);
+	if (filetag!="") filenameNoExt += "__"+filetag;
+	else if (filenum) filenameNoExt += "__"+cvtToStr(filenum);
 	filenameNoExt += (slow ? "__Slow":"");
 	V3OutCFile* ofp = NULL;
 	if (v3Global.opt.lintOnly()) {
@@ -825,15 +1161,26 @@ class EmitCImp : EmitCStmts {
 	if (!(nodep->slow() ? m_slow : m_fast)) return;
 
 	m_blkChangeDetVec.clear();
+	// Slow functions, such as the initial settle, always convert pins
+	pinsChanged(!nodep->slow());
 
 	splitSizeInc(nodep);
 
 	puts("\n");
 	if (nodep->isInline()) puts("VL_INLINE_OPT ");
+	if (nodep->slow()) puts("VL_ATTR_COLD ");
+	else if (nodep->isHot()) puts("VL_ATTR_HOT ");
 	puts(nodep->rtnTypeVoid()); puts(" ");
 	puts(modClassName(m_modp)+"::"+nodep->name()
 	     +"("+cFuncArgs(nodep)+") {\n");
 
+	if (v3Global.opt.profileCounters()) {
+	    // Named as gprof would, so verilator_profcfunc can read either
+	    puts("static VerilatedProfCFunc __Vprof (\""+modClassName(m_modp)+"::"+nodep->name()
+		 +"("+cFuncArgs(nodep)+")\");\n");
+	    puts("VerilatedProfScope __Vprofscope (__Vprof);\n");
+	}
+
 	puts("VL_DEBUG_IF(VL_PRINTF(\"  ");
 	for (int i=0;i<m_modp->level();i++) { puts("  "); }
 	puts(modClassName(m_modp)+"::"+nodep->name()
@@ -854,13 +1201,19 @@ class EmitCImp : EmitCStmts {
 
 	if (nodep->stmtsp()) putsDecoration("// Body\n");
 	nodep->stmtsp()->iterateAndNext(*this);
+	emitResetTables();
 	if (!m_blkChangeDetVec.empty()) emitChangeDet();
 
 	if (nodep->finalsp()) putsDecoration("// Final\n");
+	bool chgFinals = !m_blkChangeDetVec.empty() && nodep->finalsp();
+	// Change detect finals only copy values to __Vchglast, so are unneeded if none differ
+	if (chgFinals) puts("if (__req) {\n");
 	nodep->finalsp()->iterateAndNext(*this);
+	if (chgFinals) puts("}\n");
 	//
 
 	if (!m_blkChangeDetVec.empty()) puts("return __req;\n");
+	putsLineDirectiveEnd();
 
 	//puts("__Vm_activity = true;\n");
 	puts("}\n");
@@ -899,6 +1252,20 @@ class EmitCImp : EmitCStmts {
 			 +varname+"\\n\"); );\n");
 		}
 	    }
+	    if (v3Global.opt.profileConverge()) {
+		puts("if (VL_UNLIKELY(__req)) {\n");
+		for (vector<AstChangeDet*>::iterator it = m_blkChangeDetVec.begin();
+		     it != m_blkChangeDetVec.end(); ++it) {
+		    AstChangeDet* nodep = *it;
+		    if (nodep->lhsp()) {
+			puts("if (");
+			bool gotOneIgnore = false;
+			doubleOrDetect(nodep, gotOneIgnore);
+			puts(") ++(vlSymsp->__Vconverge_chg["+cvtToStr(nodep->binNum())+"]);\n");
+		    }
+		}
+		puts("}\n");
+	    }
 	}
     }
 
@@ -908,7 +1275,9 @@ class EmitCImp : EmitCStmts {
 
     virtual void visit(AstCReset* nodep) {
 	AstVar* varp = nodep->varrefp()->varp();
-	emitVarReset(varp);
+	int type = resetTableType(varp);
+	if (type >= 0) m_resetVarps[type].push_back(varp);
+	else emitVarReset(varp);
     }
 
     //---------------------------------------
@@ -924,6 +1293,8 @@ class EmitCImp : EmitCStmts {
     void emitConfigureImp(AstNodeModule* modp);
     void emitCoverageDecl(AstNodeModule* modp);
     void emitCoverageImp(AstNodeModule* modp);
+    void emitMemoryImp(AstNodeModule* modp);
+    void emitLinkPorts(AstNodeModule* modp, bool inClassBody);
     void emitDestructorImp(AstNodeModule* modp);
     void emitSavableImp(AstNodeModule* modp);
     void emitTextSection(AstType type);
@@ -932,7 +1303,14 @@ class EmitCImp : EmitCStmts {
     void emitImp(AstNodeModule* modp);
     void emitStaticDecl(AstNodeModule* modp);
     void emitWrapEval(AstNodeModule* modp);
+    void emitEvalLoop();
+    void emitEvalCycles(AstNodeModule* modp);
+    void emitEvalDomains(AstNodeModule* modp, bool decl);
+    void emitEvalLazy(AstNodeModule* modp);
     void emitInt(AstNodeModule* modp);
+    void emitBalancedFuncs(AstNodeModule* modp);
+    bool splitStableNeeded(AstCFunc* funcp);
+    string splitStableTag(AstCFunc* funcp);
     void writeMakefile(string filename);
 
 public:
@@ -940,9 +1318,10 @@ public:
 	m_modp = NULL;
 	m_slow = false;
 	m_fast = false;
+	m_modRefsp = NULL;
     }
     virtual ~EmitCImp() {}
-    void main(AstNodeModule* modp, bool slow, bool fast);
+    void main(AstNodeModule* modp, bool slow, bool fast, EmitCModRefVisitor* modRefsp);
     void mainDoFunc(AstCFunc* nodep) {
 	nodep->accept(*this);
     }
@@ -999,6 +1378,9 @@ void EmitCStmts::emitVarDecl(AstVar* nodep, const string& prefixIfImp) {
 	puts(nodep->vlArgType(true,false,false));
 	emitDeclArrayBrackets(nodep);
 	puts(";\n");
+    } else if (sparseArray(nodep)) {
+	// Huge memories; entries are allocated a page at a time on first access
+	puts(sparseArrayType(nodep)+"\t"+nodep->name()+";\n");
     } else {
 	// Arrays need a small alignment, but may need different padding after.
 	// For example three VL_SIG8's needs alignment 1 but size 3.
@@ -1187,6 +1569,10 @@ void EmitCStmts::displayEmit(AstNode* nodep, bool isScan) {
     if (emitDispState.m_format == ""
 	&& nodep->castDisplay()) { // not fscanf etc, as they need to return value
 	// NOP
+    } else if (nodep->castDisplay()
+	       || nodep->castSFormat()
+	       || (nodep->castSFormatF() && m_sformatDestp)) {
+	displayEmitCompiled(nodep);
     } else {
 	// Format
 	bool isStmt = false;
@@ -1230,19 +1616,9 @@ void EmitCStmts::displayEmit(AstNode* nodep, bool isScan) {
 	// Arguments
 	for (unsigned i=0; i < emitDispState.m_argsp.size(); i++) {
 	    puts(",");
-	    char     fmt  = emitDispState.m_argsChar[i];
-	    AstNode* argp = emitDispState.m_argsp[i];
-	    string   func = emitDispState.m_argsFunc[i];
 	    ofp()->indentInc();
 	    ofp()->putbs("");
-	    if (func!="") puts(func);
-	    if (argp) {
-		if (isScan) puts("&(");
-		else if (fmt == '@') puts("&(");
-		argp->iterate(*this);
-		if (isScan) puts(")");
-		else if (fmt == '@') puts(")");
-	    }
+	    displayEmitArg(i, isScan);
 	    ofp()->indentDec();
 	}
         // End
@@ -1254,6 +1630,155 @@ void EmitCStmts::displayEmit(AstNode* nodep, bool isScan) {
     }
 }
 
+void EmitCStmts::displayEmitArg(unsigned argn, bool isScan) {
+    char     fmt  = emitDispState.m_argsChar[argn];
+    AstNode* argp = emitDispState.m_argsp[argn];
+    string   func = emitDispState.m_argsFunc[argn];
+    if (func!="") puts(func);
+    if (argp) {
+	if (isScan) puts("&(");
+	else if (fmt == '@') puts("&(");
+	argp->iterate(*this);
+	if (isScan) puts(")");
+	else if (fmt == '@') puts(")");
+    }
+}
+
+void EmitCStmts::displayEmitCompiled(AstNode* nodep) {
+    // Emit a call for each piece of the format, so the runtime only
+    // converts values rather than parsing the format on every call.
+    // Pieces and arguments are as VL_WRITEF would take them.
+    const string& format = emitDispState.m_format;
+    unsigned argn = 0;
+    string text;
+    puts("{ VerilatedFmtBuf __Vfmt;\n");
+    for (string::const_iterator pos = format.begin(); pos != format.end(); ++pos) {
+	if (pos[0] != '%') { text += pos[0]; continue; }
+	string::const_iterator pctp = pos;
+	bool widthSet = false;
+	int width = 0;
+	for (++pos; pos != format.end() && (isdigit(pos[0]) || pos[0]=='.'); ++pos) {
+	    if (pos[0] != '.') { widthSet = true; width = width*10 + (pos[0] - '0'); }
+	}
+	if (pos == format.end()) nodep->v3fatalSrc("Unterminated $display-like format");
+	char fmt = pos[0];
+	if (fmt == '%') { text += '%'; continue; }
+	if (text != "") {
+	    puts("__Vfmt.text(");
+	    ofp()->putsQuoted(text);
+	    puts(","+cvtToStr(text.length())+");\n");
+	    text = "";
+	}
+	if (argn >= emitDispState.m_argsp.size()) nodep->v3fatalSrc("Missing $display-like argument");
+	switch (fmt) {
+	case 'N':  // Scope name, add . if needed
+	case 'S':  // Scope name
+	    puts((fmt=='N') ? "__Vfmt.name(" : "__Vfmt.cstr(");
+	    displayEmitArg(argn++, false);
+	    break;
+	case '@':  // String
+	    argn++;  // Width is ignored
+	    puts("VL_FMT_STRING(__Vfmt, ");
+	    emitDispState.m_argsp[argn]->iterate(*this);
+	    argn++;
+	    break;
+	case 'e':
+	case 'f':
+	case 'g':
+	    argn++;  // Width is ignored
+	    puts("__Vfmt.real(");
+	    ofp()->putsQuoted(string(pctp, pos+1));
+	    puts(", ");
+	    displayEmitArg(argn++, false);
+	    break;
+	default:
+	    puts("__Vfmt.num('"+string(1,fmt)+"', "+(widthSet ? cvtToStr(width) : "-1")
+		 +", "+((pctp[1]=='0') ? "true" : "false")+", ");
+	    displayEmitArg(argn++, false);  // Width
+	    puts(", ");
+	    displayEmitArg(argn++, false);
+	    break;
+	}
+	puts(");\n");
+    }
+    if (text != "") {
+	puts("__Vfmt.text(");
+	ofp()->putsQuoted(text);
+	puts(","+cvtToStr(text.length())+");\n");
+    }
+    // Output
+    if (AstDisplay* dispp = nodep->castDisplay()) {
+	if (dispp->filep()) {
+	    puts("__Vfmt.fwritef(");
+	    dispp->filep()->iterate(*this);
+	    puts(");\n");
+	} else {
+	    puts("__Vfmt.writef();\n");
+	}
+    } else if (AstSFormat* dispp = nodep->castSFormat()) {
+	if (dispp->lhsp()->isString()) {
+	    puts("VL_FMT_SFORMAT(__Vfmt, ");
+	} else {
+	    puts("__Vfmt.sformat(");
+	    puts(cvtToStr(dispp->lhsp()->widthMin()));
+	    putbs(", ");
+	}
+	dispp->lhsp()->iterate(*this);
+	puts(");\n");
+    } else if (nodep->castSFormatF() && m_sformatDestp) {
+	puts("VL_FMT_SFORMAT(__Vfmt, ");
+	m_sformatDestp->iterate(*this);
+	puts(");\n");
+    } else {
+	nodep->v3fatalSrc("Unknown displayEmitCompiled node type");
+    }
+    puts("}\n");
+    // Prep for next
+    emitDispState.clear();
+}
+
+static bool emitRefsVar(AstNode* nodep, AstVar* varp) {
+    for (; nodep; nodep=nodep->nextp()) {
+	if (AstVarRef* refp = nodep->castVarRef()) {
+	    if (refp->varp() == varp) return true;
+	}
+	if (emitRefsVar(nodep->op1p(), varp) || emitRefsVar(nodep->op2p(), varp)
+	    || emitRefsVar(nodep->op3p(), varp) || emitRefsVar(nodep->op4p(), varp)) return true;
+    }
+    return false;
+}
+
+bool EmitCStmts::emitStringAssign(AstNodeAssign* nodep) {
+    // Assign common string forms in place, reusing the string's buffer,
+    // rather than building and copying temporaries.  Return false if not done.
+    AstVarRef* lhsp = nodep->lhsp()->castVarRef();
+    if (nodep->rhsp()->castSFormatF()) {
+	// s = $sformatf(...) as $sformat(s, ...)
+	m_sformatDestp = lhsp;
+	nodep->rhsp()->iterate(*this);
+	m_sformatDestp = NULL;
+	return true;
+    }
+    // s = {s, a, ...} as appends to s; the pieces must not read s, as it changes
+    vector<AstNode*> appendps;  // Last appended first
+    AstNode* firstp = nodep->rhsp();
+    for (AstConcatN* catp; (catp = firstp->castConcatN()); firstp = catp->lhsp()) {
+	if (emitRefsVar(catp->rhsp(), lhsp->varp())) return false;
+	appendps.push_back(catp->rhsp());
+    }
+    AstVarRef* firstRefp = firstp->castVarRef();
+    if (appendps.empty() || !firstRefp || !firstRefp->sameNoLvalue(lhsp)) return false;
+    for (size_t i=0; i<appendps.size(); ++i) puts("VL_APPENDN_NNN(");
+    lhsp->iterate(*this);
+    for (size_t i=appendps.size(); i-- > 0; ) {
+	puts(", ");
+	appendps[i]->iterate(*this);
+	puts(")");
+    }
+    puts(";\n");
+    return true;
+}
+
 void EmitCStmts::displayArg(AstNode* dispp, AstNode** elistp, bool isScan,
 			    const string& vfmt, char fmtLetter) {
     // Print display argument, edits elistp
@@ -1384,6 +1909,9 @@ void EmitCImp::emitVarReset(AstVar* varp) {
 	// If an ARRAYINIT we initialize it using an initial block similar to a signal
 	//puts("// parameter "+varp->name()+" = "+varp->valuep()->name()+"\n");
     }
+    else if (constPoolVar(varp)) {
+	// Initialized where __Syms defines it
+    }
     else if (AstInitArray* initarp = varp->valuep()->castInitArray()) {
 	if (AstUnpackArrayDType* arrayp = varp->dtypeSkipRefp()->castUnpackArrayDType()) {
 	    if (initarp->defaultp()) {
@@ -1407,7 +1935,17 @@ void EmitCImp::emitVarReset(AstVar* varp) {
     else if (varp->basicp() && varp->basicp()->keyword() == AstBasicDTypeKwd::STRING) {
 	// Constructor deals with it
     }
+    else if (sparseArray(varp)) {
+	// VlSparseArray resets each page when first accessed
+    }
     else {
+	bool zeroit = resetZero(varp);
+	// Large memories are zeroed without touching every page, when reset is to zero
+	bool lazy = false;
+	if (!zeroit && varp->dtypeSkipRefp()->castUnpackArrayDType() && varp->basicp()) {
+	    lazy = (varBytes(varp) >= RESET_LAZY_MIN_BYTES);
+	}
+	if (lazy) puts("if (!VL_RAND_RESET_MEM(&"+varp->name()+", sizeof("+varp->name()+"))) {\n");
 	int vects = 0;
 	// This isn't very robust and may need cleanup for other data types
 	for (AstUnpackArrayDType* arrayp=varp->dtypeSkipRefp()->castUnpackArrayDType(); arrayp;
@@ -1420,9 +1958,6 @@ void EmitCImp::emitVarReset(AstVar* varp) {
 	    puts(" for (; "+ivar+"<"+cvtToStr(arrayp->elementsConst()));
 	    puts("; ++"+ivar+") {\n");
 	}
-	bool zeroit = (varp->attrFileDescr() // Zero it out, so we don't core dump if never call $fopen
-		       || (varp->basicp() && varp->basicp()->isZeroInit())
-		       || (varp->name().size()>=1 && varp->name()[0]=='_' && v3Global.opt.underlineZero()));
 	if (varp->isWide()) {
 	    // DOCUMENT: We randomize everything.  If the user wants a _var to be zero,
 	    // there should be a initial statement.  (Different from verilator2.)
@@ -1455,6 +1990,7 @@ void EmitCImp::emitVarReset(AstVar* varp) {
 	    }
 	}
 	for (int v=0; v<vects; ++v) puts( "}}\n");
+	if (lazy) puts("}\n");
     }
     splitSizeInc(1);
 }
@@ -1483,8 +2019,14 @@ void EmitCImp::emitCtorImp(AstNodeModule* modp) {
     putsDecoration("// Reset internal values\n");
     if (modp->isTop()) {
 	if (v3Global.opt.inhibitSim()) puts("__Vm_inhibitSim = false;\n");
+	if (v3Global.opt.lazyOutputs() && !optSystemC()) puts("__Vm_lazyDirty = true;\n");
 	puts("\n");
     }
+    for (AstNode* nodep=modp->stmtsp(); nodep; nodep = nodep->nextp()) {
+	if (AstVar* varp = nodep->castVar()) {
+	    if (vpiChgVar(varp)) puts(vpiChgName(varp)+" = 0;\n");
+	}
+    }
     putsDecoration("// Reset structure values\n");
     puts("_ctor_var_reset();\n");
     emitTextSection(AstType::atScCtor);
@@ -1525,6 +2067,57 @@ void EmitCImp::emitCoverageImp(AstNodeModule* modp) {
     }
 }
 
+void EmitCImp::emitMemoryImp(AstNodeModule* modp) {
+    puts("\n// Member sizes, for memoryReport\n");
+    puts("const VerilatedMemoryVar "+modClassName(modp)+"::__Vmemory[] = {\n");
+    for (AstNode* nodep=modp->stmtsp(); nodep; nodep = nodep->nextp()) {
+	if (AstVar* varp = nodep->castVar()) {
+	    if (!classMemberVar(varp)) continue;
+	    puts("{\""+varp->prettyName()+"\", sizeof((("+modClassName(modp)+"*)0)->"+varp->name()+"), "
+		 +memoryKind(varp)+"},\n");
+	}
+    }
+    puts("{NULL, 0, 0}};\n");
+    if (modp->isTop()) {
+	puts("\nvoid "+modClassName(modp)+"::memoryReport() {\n");
+	puts(   "__VlSymsp->__Vmemory_report();\n");
+	puts("}\n");
+    }
+    splitSizeInc(10);
+}
+
+void EmitCImp::emitLinkPorts(AstNodeModule* modp, bool inClassBody) {
+    // Inputs then outputs, each in declaration order; the other side registers the reverse
+    if (inClassBody) {
+	puts("/// Register the ports with a VerilatedLink, for another process to drive and check.\n");
+	puts("/// The other side registers, in this order, these outputs then these inputs:\n");
+    } else {
+	puts("\nvoid "+modClassName(modp)+"::linkPorts(VerilatedLink* linkp) {\n");
+    }
+    for (int outputs=0; outputs<2; ++outputs) {
+	int pos = 0;
+	for (AstNode* nodep=modp->stmtsp(); nodep; nodep = nodep->nextp()) {
+	    AstVar* varp = nodep->castVar();
+	    if (!varp || !varp->isIO() || varp->isInout()) continue;  // Either side may drive an inout
+	    if (varp->isOutput() != (outputs != 0)) continue;
+	    if (inClassBody) {
+		puts(string("///   ")+(outputs ? "output " : "input ")+cvtToStr(pos)+": "+varp->name()
+		     +", "+cvtToStr((int)varBytes(varp))+" bytes\n");
+	    } else {
+		puts(string("linkp->")+(outputs ? "addOutput" : "addInput")
+		     +"(&"+varp->name()+", sizeof("+varp->name()+"));\n");
+	    }
+	    ++pos;
+	}
+    }
+    if (inClassBody) {
+	puts("void linkPorts(VerilatedLink* linkp);\n");
+    } else {
+	puts("}\n");
+	splitSizeInc(10);
+    }
+}
+
 void EmitCImp::emitDestructorImp(AstNodeModule* modp) {
     puts("\n");
     puts(modClassName(modp)+"::~"+modClassName(modp)+"() {\n");
@@ -1542,7 +2135,10 @@ void EmitCImp::emitSavableImp(AstNodeModule* modp) {
 	    string funcname = de ? "__Vdeserialize" : "__Vserialize";
 	    string writeread = de ? "read" : "write";
 	    string op = de ? ">>" : "<<";
-	    puts("void "+modClassName(modp)+"::"+funcname+"("+classname+"& os) {\n");
+	    // The top's own members are also a chunk of a VerilatedSaveChunked file,
+	    // so they're separate from its children
+	    string selfname = modp->isTop() ? funcname+"Self" : funcname;
+	    puts("void "+modClassName(modp)+"::"+selfname+"("+classname+"& os) {\n");
 	    // Place a computed checksum to insure proper structure save/restore formatting
 	    // OK if this hash includes some things we won't dump, since just looking for loading the wrong model
 	    VHashSha1 hash;
@@ -1569,6 +2165,9 @@ void EmitCImp::emitSavableImp(AstNodeModule* modp) {
 		    }
 		    else if (varp->isParam()) {}
 		    else if (varp->isStatic() && varp->isConst()) {}
+		    else if (sparseArray(varp)) {
+			puts("os"+op+varp->name()+";\n");
+		    }
 		    else {
 			int vects = 0;
 			// This isn't very robust and may need cleanup for other data types
@@ -1599,10 +2198,20 @@ void EmitCImp::emitSavableImp(AstNodeModule* modp) {
 		}
 	    }
 
-	    if (modp->isTop()) {  // Save the children
-		puts(   "__VlSymsp->"+funcname+"(os);\n");
-	    }
 	    puts("}\n");
+
+	    if (modp->isTop()) {
+		puts("void "+modClassName(modp)+"::"+funcname+"("+classname+"& os) {\n");
+		puts(   selfname+"(os);\n");
+		puts(   "__VlSymsp->"+funcname+"(os);\n");  // Save the children
+		puts("}\n");
+		puts("void "+modClassName(modp)+"::"+funcname+"Chunk(int chunk, "+classname+"& os) {\n");
+		puts(   "__VlSymsp->"+funcname+"Chunk(chunk, os);\n");
+		puts("}\n");
+	    }
+	}
+	if (modp->isTop()) {
+	    puts("int "+modClassName(modp)+"::__Vchunks() const { return "+symClassName()+"::__Vchunks(); }\n");
 	}
     }
 }
@@ -1656,11 +2265,22 @@ void EmitCImp::emitSensitives() {
     // Create sensitivity list for when to evaluate the model.
     // If C++ code, the user must call this routine themself.
     if (m_modp->isTop() && optSystemC()) {
-	putsDecoration("// Sensitivities on all clocks and combo inputs\n");
+	// With --sc-sensitive-clocks, combo inputs are sampled at clock edges,
+	// unless there are no clocks to be sensitive to
+	bool clocksOnly = false;
+	if (v3Global.opt.scSensitiveClocks()) {
+	    for (AstNode* nodep=m_modp->stmtsp(); nodep; nodep = nodep->nextp()) {
+		if (AstVar* varp = nodep->castVar()) {
+		    if (varp->isInput() && varp->isUsedClock()) clocksOnly = true;
+		}
+	    }
+	}
+	if (clocksOnly) putsDecoration("// Sensitivities on all clocks\n");
+	else putsDecoration("// Sensitivities on all clocks and combo inputs\n");
 	puts("SC_METHOD(eval);\n");
 	for (AstNode* nodep=m_modp->stmtsp(); nodep; nodep = nodep->nextp()) {
 	    if (AstVar* varp = nodep->castVar()) {
-		if (varp->isInput() && (varp->isScSensitive() || varp->isUsedClock())) {
+		if (varp->isInput() && ((varp->isScSensitive() && !clocksOnly) || varp->isUsedClock())) {
 		    int vects = 0;
 		    // This isn't very robust and may need cleanup for other data types
 		    for (AstUnpackArrayDType* arrayp=varp->dtypeSkipRefp()->castUnpackArrayDType(); arrayp;
@@ -1685,7 +2305,7 @@ void EmitCImp::emitSensitives() {
 }
 
 void EmitCImp::emitWrapEval(AstNodeModule* modp) {
-    puts("\nvoid "+modClassName(modp)+"::eval() {\n");
+    puts("\nVL_ATTR_HOT void "+modClassName(modp)+"::eval() {\n");
     puts(EmitCBaseVisitor::symClassVar()+" = this->__VlSymsp; // Setup global symbol table\n");
     puts(EmitCBaseVisitor::symTopAssign()+"\n");
     putsDecoration("// Initialize\n");
@@ -1693,23 +2313,19 @@ void EmitCImp::emitWrapEval(AstNodeModule* modp) {
     if (v3Global.opt.inhibitSim()) {
 	puts("if (VL_UNLIKELY(__Vm_inhibitSim)) return;\n");
     }
+    if (v3Global.opt.lazyOutputs() && !optSystemC()) puts("__Vm_lazyDirty = true;\n");
     putsDecoration("// Evaluate till stable\n");
     puts("VL_DEBUG_IF(VL_PRINTF(\"\\n----TOP Evaluate "+modClassName(modp)+"::eval\\n\"); );\n");
-    puts("int __VclockLoop = 0;\n");
-    puts("QData __Vchange=1;\n");
-    puts("while (VL_LIKELY(__Vchange)) {\n");
-    puts(    "VL_DEBUG_IF(VL_PRINTF(\" Clock loop\\n\"););\n");
-    puts(    "vlSymsp->__Vm_activity = true;\n");
-    puts(    "_eval(vlSymsp);\n");
-    puts(    "__Vchange = _change_request(vlSymsp);\n");
-    puts(    "if (++__VclockLoop > "+cvtToStr(v3Global.opt.convergeLimit())
-	     +") vl_fatal(__FILE__,__LINE__,__FILE__,\"Verilated model didn't converge\");\n");
-    puts("}\n");
+    emitEvalLoop();
     puts("}\n");
     splitSizeInc(10);
 
+    if (v3Global.opt.evalCycles() != "") emitEvalCycles(modp);
+    if (v3Global.opt.evalDomains() && !optSystemC()) emitEvalDomains(modp, false);
+    if (v3Global.opt.lazyOutputs() && !optSystemC()) emitEvalLazy(modp);
+
     //
-    puts("\nvoid "+modClassName(modp)+"::_eval_initial_loop("+EmitCBaseVisitor::symClassVar()+") {\n");
+    puts("\nVL_ATTR_COLD void "+modClassName(modp)+"::_eval_initial_loop("+EmitCBaseVisitor::symClassVar()+") {\n");
     puts("vlSymsp->__Vm_didInit = true;\n");
     puts("_eval_initial(vlSymsp);\n");
     puts(    "vlSymsp->__Vm_activity = true;\n");
@@ -1726,6 +2342,116 @@ void EmitCImp::emitWrapEval(AstNodeModule* modp) {
     splitSizeInc(10);
 }
 
+void EmitCImp::emitEvalLoop() {
+    puts("int __VclockLoop = 0;\n");
+    puts("QData __Vchange=1;\n");
+    puts("while (VL_LIKELY(__Vchange)) {\n");
+    puts(    "VL_DEBUG_IF(VL_PRINTF(\" Clock loop\\n\"););\n");
+    puts(    "vlSymsp->__Vm_activity = true;\n");
+    puts(    "_eval(vlSymsp);\n");
+    puts(    "__Vchange = _change_request(vlSymsp);\n");
+    puts(    "if (++__VclockLoop > "+cvtToStr(v3Global.opt.convergeLimit())
+	     +") vl_fatal(__FILE__,__LINE__,__FILE__,\"Verilated model didn't converge\");\n");
+    puts("}\n");
+    if (v3Global.opt.profileConverge()) {
+	puts("++(vlSymsp->__Vconverge_loops[__VclockLoop < VL_PROF_CONVERGE_LOOPS"
+	     " ? __VclockLoop-1 : VL_PROF_CONVERGE_LOOPS-1]);\n");
+    }
+}
+
+void EmitCImp::emitEvalCycles(AstNodeModule* modp) {
+    // Run many clock cycles in one call, so the application avoids two eval() calls per cycle
+    AstVar* clkVarp = NULL;
+    for (AstNode* nodep = modp->stmtsp(); nodep; nodep = nodep->nextp()) {
+	if (AstVar* varp = nodep->castVar()) {
+	    if (varp->isInput() && varp->name() == v3Global.opt.evalCycles()) clkVarp = varp;
+	}
+    }
+    if (optSystemC()) {
+	modp->v3error("Unsupported: --eval-cycles with SystemC output");
+	return;
+    } else if (!clkVarp || clkVarp->widthMin() != 1) {
+	modp->v3error("--eval-cycles clock is not a one bit top level input: "<<v3Global.opt.evalCycles());
+	return;
+    }
+    string clk = clkVarp->name();
+    puts("\nVL_ATTR_HOT vluint64_t "+modClassName(modp)+"::evalCycles(vluint64_t cycles, EvalCyclesCb cbp, void* userp) {\n");
+    puts(EmitCBaseVisitor::symClassVar()+" = this->__VlSymsp; // Setup global symbol table\n");
+    puts(EmitCBaseVisitor::symTopAssign()+"\n");
+    puts("if (VL_UNLIKELY(!vlSymsp->__Vm_didInit)) _eval_initial_loop(vlSymsp);\n");
+    if (v3Global.opt.inhibitSim()) {
+	puts("if (VL_UNLIKELY(__Vm_inhibitSim)) return 0;\n");
+    }
+    puts("vluint64_t __Vcycle = 0;\n");
+    puts("for (; __Vcycle < cycles && VL_LIKELY(!Verilated::gotFinish()); ++__Vcycle) {\n");
+    puts(    "if (cbp) cbp(this, __Vcycle, userp);\n");
+    puts(    clk+" = 1;\n");
+    puts(    "{\n"); emitEvalLoop(); puts("}\n");
+    puts(    clk+" = 0;\n");
+    puts(    "{\n"); emitEvalLoop(); puts("}\n");
+    puts("}\n");
+    puts("return __Vcycle;\n");
+    puts("}\n");
+    splitSizeInc(20);
+}
+
+void EmitCImp::emitEvalDomains(AstNodeModule* modp, bool decl) {
+    // Entry points for V3Clock::domainsAll's _eval__{edge}__{clock} functions
+    for (AstNode* nodep = modp->stmtsp(); nodep; nodep = nodep->nextp()) {
+	AstCFunc* funcp = nodep->castCFunc();
+	if (!funcp || funcp->name().compare(0, 7, "_eval__") != 0) continue;
+	string edgeClk = funcp->name().substr(7);  // {edge}__{clock}
+	string::size_type pos = edgeClk.find("__");
+	if (pos == string::npos) continue;
+	string edge = edgeClk.substr(0, pos);
+	string clk = edgeClk.substr(pos+2);
+	string apiName = "eval_"+edge+"_"+clk;
+	if (decl) {
+	    puts("/// Set "+clk+" "+(edge=="posedge" ? "high" : "low")
+		 +" and evaluate.  Other clocks must be unchanged since the last evaluation.\n");
+	    puts("void "+apiName+"();\n");
+	    continue;
+	}
+	puts("\nVL_ATTR_HOT void "+modClassName(modp)+"::"+apiName+"() {\n");
+	puts(EmitCBaseVisitor::symClassVar()+" = this->__VlSymsp; // Setup global symbol table\n");
+	puts(EmitCBaseVisitor::symTopAssign()+"\n");
+	puts("if (VL_UNLIKELY(!vlSymsp->__Vm_didInit)) _eval_initial_loop(vlSymsp);\n");
+	if (v3Global.opt.inhibitSim()) {
+	    puts("if (VL_UNLIKELY(__Vm_inhibitSim)) return;\n");
+	}
+	puts(clk+(edge=="posedge" ? " = 1;\n" : " = 0;\n"));
+	puts("vlSymsp->__Vm_activity = true;\n");
+	puts(funcp->name()+"(vlSymsp);\n");
+	putsDecoration("// Anything else that changed settles as usual\n");
+	puts("if (VL_UNLIKELY(_change_request(vlSymsp))) eval();\n");
+	puts("}\n");
+	splitSizeInc(10);
+    }
+}
+
+void EmitCImp::emitEvalLazy(AstNodeModule* modp) {
+    // Evaluate the logic V3Order moved to the __Vlazy_req domain, if anything changed since
+    bool haveLazy = false;
+    for (AstNode* nodep = modp->stmtsp(); nodep; nodep = nodep->nextp()) {
+	if (AstVar* varp = nodep->castVar()) {
+	    if (varp->name() == "__Vlazy_req") haveLazy = true;
+	}
+    }
+    puts("\nvoid "+modClassName(modp)+"::evalLazy() {\n");
+    if (!haveLazy) {
+	putsDecoration("// No logic feeds only the lazy outputs\n");
+	puts("__Vm_lazyDirty = false;\n");
+    } else {
+	puts("if (VL_LIKELY(!__Vm_lazyDirty)) return;\n");
+	puts("__Vlazy_req = 1;\n");
+	puts("eval();\n");
+	puts("__Vlazy_req = 0;\n");
+	puts("__Vm_lazyDirty = false;\n");
+    }
+    puts("}\n");
+    splitSizeInc(10);
+}
+
 //----------------------------------------------------------------------
 // Top interface/ implementation
 
@@ -1752,6 +2478,7 @@ void EmitCStmts::emitVarList(AstNode* firstp, EisWhich which, const string& pref
 		    default: v3fatalSrc("Bad Case");
 		    }
 		    if (varp->isStatic() ? !isstatic : isstatic) doit=false;
+		    if (constPoolVar(varp)) doit=false;  // Declared by __Syms
 		    if (doit) {
 			int sigbytes = varp->dtypeSkipRefp()->widthAlignBytes();
 			int sortbytes = sortmax-1;
@@ -1773,6 +2500,44 @@ void EmitCStmts::emitVarList(AstNode* firstp, EisWhich which, const string& pref
     }
 }
 
+struct CmpVarAlignBytes {
+    static int alignBytes(const AstVar* varp) {
+	if (varp->basicp() && varp->basicp()->isOpaque()) return 8;
+	if (varp->isScBv() || varp->isScBigUint()) return 8;
+	return varp->dtypeSkipRefp()->widthAlignBytes();
+    }
+    inline bool operator () (const AstVar* lhsp, const AstVar* rhsp) const {
+	return alignBytes(lhsp) > alignBytes(rhsp);
+    }
+};
+
+int EmitCStmts::emitVarGroup(AstNode* firstp, EisGroup group) {
+    // For --layout-hot-cold, put out the local signals and variables
+    // used by one group of functions (see EmitCVarLayoutVisitor).
+    // Largest alignment first, so sub-word variables pack without padding;
+    // the previous order is kept within each alignment.
+    // Returns number of variables emitted.
+    vector<AstVar*> vars;
+    for (AstNode* nodep=firstp; nodep; nodep = nodep->nextp()) {
+	if (AstVar* varp = nodep->castVar()) {
+	    if (varp->isIO() || !(varp->isSignal() || varp->isTemp())) continue;
+	    int use = varp->user4();
+	    EisGroup varGroup = ((use & EmitCVarLayoutVisitor::VU_HOT) ? EVG_HOT
+				 : (use == EmitCVarLayoutVisitor::VU_TRACE) ? EVG_TRACE
+				 : EVG_COLD);
+	    if (varGroup != group) continue;
+	    if (constPoolVar(varp)) continue;  // Declared by __Syms
+	    if (varp->isStatic()) emitVarDecl(varp, "");  // Takes no space in the class
+	    else vars.push_back(varp);
+	}
+    }
+    stable_sort(vars.begin(), vars.end(), CmpVarAlignBytes());
+    for (vector<AstVar*>::iterator it = vars.begin(); it != vars.end(); ++it) {
+	emitVarDecl(*it, "");
+    }
+    return vars.size();
+}
+
 struct CmpName {
     inline bool operator () (const AstNode* lhsp, const AstNode* rhsp) const {
 	return lhsp->name() < rhsp->name();
@@ -1818,6 +2583,10 @@ void EmitCImp::emitInt(AstNodeModule* modp) {
     if (v3Global.opt.savable()) {
 	puts("#include \"verilated_save.h\"\n");
     }
+    if (v3Global.opt.profileCounters() || v3Global.opt.profileBranches()
+	|| v3Global.opt.profileActivity() || v3Global.opt.profileConverge()) {
+	puts("#include \"verilated_prof.h\"\n");
+    }
     if (v3Global.opt.coverage()) {
 	puts("#include \"verilated_cov.h\"\n");
 	if (v3Global.opt.savable()) v3error("--coverage and --savable not supported together");
@@ -1842,6 +2611,9 @@ void EmitCImp::emitInt(AstNodeModule* modp) {
     if (v3Global.opt.trace()) {
 	puts("class "+v3Global.opt.traceClassBase()+";\n");
     }
+    if (v3Global.opt.linkPorts() && modp->isTop()) {
+	puts("class VerilatedLink;\n");
+    }
 
     puts("\n//----------\n\n");
     emitTextSection(AstType::atScHdr);
@@ -1871,23 +2643,50 @@ void EmitCImp::emitInt(AstNodeModule* modp) {
     if (modp->isTop()) puts("// propagate new values into/out from the Verilated model.\n");
     emitVarList(modp->stmtsp(), EVL_IO, "");
 
-    puts("\n// LOCAL SIGNALS\n");
-    if (modp->isTop()) puts("// Internals; generally not touched by application code\n");
-    emitVarList(modp->stmtsp(), EVL_SIG, "");
+    if (v3Global.opt.layoutHotCold()) {
+	puts("\n// LOCAL SIGNALS AND VARIABLES USED BY EVALUATION\n");
+	if (modp->isTop()) puts("// Internals; generally not touched by application code\n");
+	// Start on a new cache line, away from the ports and other modules' cells
+	puts("CData\t__Vm_hotAlign VL_ATTR_ALIGNED(64);\n");
+	V3Stats::addStatSum("EmitC, Layout hot variables", emitVarGroup(modp->stmtsp(), EVG_HOT));
+
+	puts("\n// LOCAL SIGNALS AND VARIABLES USED ONLY BY INITIAL AND SETTLE\n");
+	if (modp->isTop()) puts("// Internals; generally not touched by application code\n");
+	puts("CData\t__Vm_coldAlign VL_ATTR_ALIGNED(64);\n");
+	V3Stats::addStatSum("EmitC, Layout cold variables", emitVarGroup(modp->stmtsp(), EVG_COLD));
+
+	puts("\n// LOCAL SIGNALS AND VARIABLES USED ONLY BY TRACING\n");
+	if (modp->isTop()) puts("// Internals; generally not touched by application code\n");
+	V3Stats::addStatSum("EmitC, Layout trace-only variables", emitVarGroup(modp->stmtsp(), EVG_TRACE));
+    } else {
+	puts("\n// LOCAL SIGNALS\n");
+	if (modp->isTop()) puts("// Internals; generally not touched by application code\n");
+	emitVarList(modp->stmtsp(), EVL_SIG, "");
 
-    puts("\n// LOCAL VARIABLES\n");
-    if (modp->isTop()) puts("// Internals; generally not touched by application code\n");
-    emitVarList(modp->stmtsp(), EVL_TEMP, "");
+	puts("\n// LOCAL VARIABLES\n");
+	if (modp->isTop()) puts("// Internals; generally not touched by application code\n");
+	emitVarList(modp->stmtsp(), EVL_TEMP, "");
+    }
 
     puts("\n// INTERNAL VARIABLES\n");
     if (modp->isTop()) puts("// Internals; generally not touched by application code\n");
     ofp()->putsPrivate(!modp->isTop());  // private: unless top
     puts(symClassName()+"*\t__VlSymsp;\t\t// Symbol table\n");
     ofp()->putsPrivate(false);  // public:
+    puts("static const VerilatedMemoryVar __Vmemory[];\t///< Member sizes, for memoryReport\n");
     if (modp->isTop()) {
 	if (v3Global.opt.inhibitSim()) {
 	    puts("bool\t__Vm_inhibitSim;\t///< Set true to disable evaluation of module\n");
 	}
+	if (v3Global.opt.lazyOutputs() && !optSystemC()) {
+	    puts("bool\t__Vm_lazyDirty;\t///< Lazy outputs need evaluation\n");
+	}
+    }
+    for (AstNode* nodep=modp->stmtsp(); nodep; nodep = nodep->nextp()) {
+	if (AstVar* varp = nodep->castVar()) {
+	    if (vpiChgVar(varp)) puts("CData\t"+vpiChgName(varp)+";\t///< Written since last VPI value change check\n");
+	    if (pinsChangedVar(varp)) puts(varp->scType()+"\t"+pinsChangedName(varp)+";\t///< Last converted value of pin\n");
+	}
     }
     emitCoverageDecl(modp);	// may flip public/private
 
@@ -1943,7 +2742,7 @@ void EmitCImp::emitInt(AstNodeModule* modp) {
     }
     if (v3Global.opt.trace()) {
 	if (modp->isTop()) puts("/// Trace signals in the model; called by application code\n");
-	puts("void trace (VerilatedVcdC* tfp, int levels, int options=0);\n");
+	puts("void trace ("+v3Global.opt.traceClassBase()+"C* tfp, int levels, int options=0);\n");
 	if (modp->isTop() && optSystemC()) {
 	    puts("/// SC tracing; avoid overloaded virtual function lint warning\n");
 	    puts("virtual void trace (sc_trace_file* tfp) const { ::sc_core::sc_module::trace(tfp); }\n");
@@ -1959,11 +2758,27 @@ void EmitCImp::emitInt(AstNodeModule* modp) {
 	else puts("/// Evaluate the model.  Application must call when inputs change.\n");
 	puts("void eval();\n");
 	ofp()->putsPrivate(false);  // public:
+	if (v3Global.opt.evalCycles() != "" && !optSystemC()) {
+	    puts("/// Called before each evalCycles() cycle, to set inputs\n");
+	    puts("typedef void (*EvalCyclesCb)("+modClassName(modp)+"* topp, vluint64_t cycle, void* userp);\n");
+	    puts("/// Evaluate the model for the given number of cycles of "+v3Global.opt.evalCycles()
+		 +", each setting it high then low.\n");
+	    puts("/// Returns cycles run, fewer if $finish was called.\n");
+	    puts("vluint64_t evalCycles(vluint64_t cycles, EvalCyclesCb cbp=NULL, void* userp=NULL);\n");
+	}
+	if (v3Global.opt.evalDomains() && !optSystemC()) emitEvalDomains(modp, true);
+	if (v3Global.opt.lazyOutputs() && !optSystemC()) {
+	    puts("/// Update the --lazy-output signals.  Application must call before reading them.\n");
+	    puts("void evalLazy();\n");
+	}
 	if (!optSystemC()) puts("/// Simulation complete, run final blocks.  Application must call on completion.\n");
 	puts("void final();\n");
 	if (v3Global.opt.inhibitSim()) {
 	    puts("void inhibitSim(bool flag) { __Vm_inhibitSim=flag; }\t///< Set true to disable evaluation of module\n");
 	}
+	puts("/// Print the memory used by each instance, its arrays, and shadow copies\n");
+	puts("void memoryReport();\n");
+	if (v3Global.opt.linkPorts()) emitLinkPorts(modp, true);
     }
 
     puts("\n// INTERNAL METHODS\n");
@@ -1982,11 +2797,22 @@ void EmitCImp::emitInt(AstNodeModule* modp) {
 	puts("static void traceInit ("+v3Global.opt.traceClassBase()+"* vcdp, void* userthis, uint32_t code);\n");
 	puts("static void traceFull ("+v3Global.opt.traceClassBase()+"* vcdp, void* userthis, uint32_t code);\n");
 	puts("static void traceChg  ("+v3Global.opt.traceClassBase()+"* vcdp, void* userthis, uint32_t code);\n");
+	if (v3Global.opt.mtasks() && !v3Global.opt.traceBin()) {
+	    puts("static void traceChgTask ("+v3Global.opt.traceClassBase()+"* vcdp, void* userthis, uint32_t code, int task);\n");
+	}
     }
     if (v3Global.opt.savable()) {
 	ofp()->putsPrivate(false);  // public:
 	puts("void __Vserialize(VerilatedSerialize& os);\n");
 	puts("void __Vdeserialize(VerilatedDeserialize& os);\n");
+	if (modp->isTop()) {
+	    puts("// Independent parts of the state, for VerilatedSaveChunked\n");
+	    puts("int __Vchunks() const;\n");
+	    puts("void __VserializeChunk(int chunk, VerilatedSerialize& os);\n");
+	    puts("void __VdeserializeChunk(int chunk, VerilatedDeserialize& os);\n");
+	    puts("void __VserializeSelf(VerilatedSerialize& os);\n");
+	    puts("void __VdeserializeSelf(VerilatedDeserialize& os);\n");
+	}
 	puts("\n");
     }
 
@@ -2012,11 +2838,21 @@ void EmitCImp::emitImp(AstNodeModule* modp) {
 
     // Us
     puts("#include \""+ symClassName() +".h\"\n");
+    if (m_modRefsp) {
+	// __Syms.h only declares the module classes, so include those referenced
+	const EmitCModRefVisitor::ClassNames& refs = m_modRefsp->refs(modp);
+	for (EmitCModRefVisitor::ClassNames::const_iterator it = refs.begin(); it != refs.end(); ++it) {
+	    puts("#include \""+*it+".h\"\n");
+	}
+    }
 
     if (v3Global.dpi()) {
 	puts("\n");
 	puts("#include \"verilated_dpi.h\"\n");
     }
+    if (v3Global.opt.linkPorts() && modp->isTop()) {
+	puts("#include \"verilated_link.h\"\n");
+    }
 
     emitTextSection(AstType::atScImpHdr);
 
@@ -2038,6 +2874,8 @@ void EmitCImp::emitImp(AstNodeModule* modp) {
 	emitDestructorImp(modp);
 	emitSavableImp(modp);
 	emitCoverageImp(modp);
+	emitMemoryImp(modp);
+	if (v3Global.opt.linkPorts() && modp->isTop()) emitLinkPorts(modp, false);
     }
 
     if (m_fast && splitFilenum()==0) {
@@ -2056,9 +2894,10 @@ void EmitCImp::emitImp(AstNodeModule* modp) {
 
 //######################################################################
 
-void EmitCImp::main(AstNodeModule* modp, bool slow, bool fast) {
+void EmitCImp::main(AstNodeModule* modp, bool slow, bool fast, EmitCModRefVisitor* modRefsp) {
     // Output a module
     m_modp = modp;
+    m_modRefsp = modRefsp;
     m_slow = slow;
     m_fast = fast;
 
@@ -2087,13 +2926,21 @@ void EmitCImp::main(AstNodeModule* modp, bool slow, bool fast) {
 
     emitImp (modp);
 
+    if (v3Global.opt.outputSplit() && v3Global.opt.outputSplitBalance()) {
+	emitBalancedFuncs(modp);
+	delete m_ofp; m_ofp=NULL;
+	return;
+    }
+
+    m_splitTags.clear();
     for (AstNode* nodep=modp->stmtsp(); nodep; nodep = nodep->nextp()) {
 	if (AstCFunc* funcp = nodep->castCFunc()) {
-	    if (splitNeeded()) {
+	    if (v3Global.opt.outputSplitStable() ? splitStableNeeded(funcp) : splitNeeded()) {
 		// Close old file
 		delete m_ofp; m_ofp=NULL;
 		// Open a new file
-		m_ofp = newOutCFile (modp, !m_fast, true/*source*/, splitFilenumInc());
+		int filenum = splitFilenumInc();
+		m_ofp = newOutCFile (modp, !m_fast, true/*source*/, filenum, splitStableTag(funcp));
 		emitImp (modp);
 	    }
 	    splitSizeInc(10);  // Even blank functions get a file with a low csplit
@@ -2104,12 +2951,89 @@ void EmitCImp::main(AstNodeModule* modp, bool slow, bool fast) {
     delete m_ofp; m_ofp=NULL;
 }
 
+bool EmitCImp::splitStableNeeded(AstCFunc* funcp) {
+    // With --output-split-stable, a file ends before a function chosen by a
+    // hash of its name, once the file is half full, rather than wherever the
+    // running size crosses --output-split.  After an edit, the boundaries
+    // after the edited function fall at the same functions as before, so the
+    // files there keep their contents.
+    int split = v3Global.opt.outputSplit();
+    if (!split || !splitSize()) return false;
+    if (splitSize() >= 2*split) return true;
+    return splitSize() >= split/2 && (V3Hash(funcp->name()).hshval() % 4) == 0;
+}
+
+string EmitCImp::splitStableTag(AstCFunc* funcp) {
+    // Name files by their first function, so unchanged files keep their names
+    if (!v3Global.opt.outputSplitStable()) return "";
+    char tag[20];
+    sprintf(tag, "%06x", V3Hash(funcp->name()).hshval());
+    if (m_splitTags.find(tag) != m_splitTags.end()) return "";  // Hash collision, use number
+    m_splitTags.insert(tag);
+    return tag;
+}
+
+void EmitCImp::emitBalancedFuncs(AstNodeModule* modp) {
+    // Rather than filling each file in function order, pack functions by
+    // estimated cost into as many files as --output-split requires, largest
+    // first into the least loaded file, so the parallel compiles of the
+    // files take similar times.  The first file already holds emitImp's code.
+    typedef vector<AstCFunc*> FuncVec;
+    typedef vector<pair<int,int> > CostVec;	// (-cost, function index)
+    FuncVec funcps;
+    CostVec costs;
+    int total = splitSize();
+    for (AstNode* nodep=modp->stmtsp(); nodep; nodep = nodep->nextp()) {
+	if (AstCFunc* funcp = nodep->castCFunc()) {
+	    int cost = 10;  // Even blank functions get a file with a low csplit
+	    if (!funcp->funcType().isTrace() && !funcp->dpiImport()
+		&& (funcp->slow() ? m_slow : m_fast)) {
+		cost += EmitCBaseCounterVisitor(funcp).count();
+	    }
+	    costs.push_back(make_pair(-cost, (int)funcps.size()));
+	    funcps.push_back(funcp);
+	    total += cost;
+	}
+    }
+    int nfiles = (total + v3Global.opt.outputSplit() - 1) / v3Global.opt.outputSplit();
+    nfiles = max(1, min(nfiles, (int)funcps.size() + 1));
+    sort(costs.begin(), costs.end());
+
+    // Least loaded file first, ties go to the lower numbered file
+    typedef priority_queue<pair<int,int>, vector<pair<int,int> >, greater<pair<int,int> > > LoadQueue;
+    LoadQueue loads;
+    for (int file=0; file<nfiles; ++file) loads.push(make_pair(file ? 0 : splitSize(), file));
+    vector<int> fileOf (funcps.size(), 0);
+    for (CostVec::iterator it = costs.begin(); it != costs.end(); ++it) {
+	pair<int,int> least = loads.top();  loads.pop();
+	fileOf[it->second] = least.second;
+	loads.push(make_pair(least.first - it->first, least.second));
+    }
+
+    for (int file=0; file<nfiles; ++file) {
+	if (file && find(fileOf.begin(), fileOf.end(), file) == fileOf.end()) continue;
+	if (file) {
+	    delete m_ofp; m_ofp=NULL;
+	    m_ofp = newOutCFile (modp, !m_fast, true/*source*/, splitFilenumInc());
+	    emitImp (modp);
+	}
+	for (size_t i=0; i<funcps.size(); ++i) {
+	    if (fileOf[i] == file) {
+		splitSizeInc(10);
+		mainDoFunc(funcps[i]);
+	    }
+	}
+    }
+}
+
 //######################################################################
 // Tracing routines
 
 class EmitCTrace : EmitCStmts {
     AstCFunc*	m_funcp;	// Function we're in now
     bool	m_slow;		// Making slow file
+    int		m_packSkip;	// Following AstTraceIncs already packed into a chgBits
+    bool	m_packNone;	// Don't pack AstTraceIncs with those following
 
     // METHODS
     void newOutCFile(int filenum) {
@@ -2131,8 +3055,15 @@ class EmitCTrace : EmitCStmts {
 
     void emitTraceHeader() {
 	// Includes
-	puts("#include \"verilated_vcd_c.h\"\n");
+	if (v3Global.opt.traceBin()) puts("#include \"verilated_bin_c.h\"\n");
+	else puts("#include \"verilated_vcd_c.h\"\n");
 	puts("#include \""+ symClassName() +".h\"\n");
+	if (v3Global.opt.outputMinIncludes()) {
+	    // Tracing reaches all modules, but __Syms.h only declares them
+	    for (AstNodeModule* nodep = v3Global.rootp()->modulesp(); nodep; nodep=nodep->nextp()->castNodeModule()) {
+		puts("#include \""+modClassName(nodep)+".h\"\n");
+	    }
+	}
 	puts("\n");
     }
 
@@ -2140,11 +3071,12 @@ class EmitCTrace : EmitCStmts {
 	puts("\n//======================\n\n");
 
 	puts("void "+topClassName()+"::trace (");
-	puts("VerilatedVcdC* tfp, int, int) {\n");
+	puts(v3Global.opt.traceClassBase()+"C* tfp, int, int) {\n");
 	puts(  "tfp->spTrace()->addCallback ("
 	       "&"+topClassName()+"::traceInit"
 	       +", &"+topClassName()+"::traceFull"
 	       +", &"+topClassName()+"::traceChg, this);\n");
+	puts(  "tfp->spTrace()->addActivity(&__VlSymsp->__Vm_activity);\n");
 	puts("}\n");
 	splitSizeInc(10);
 
@@ -2190,6 +3122,38 @@ class EmitCTrace : EmitCStmts {
 	puts("\n//======================\n\n");
     }
 
+    int traceChgTasks(AstCFunc* nodep) {
+	// With --threads, each activity group of the change function is a task
+	// Returns the number of tasks, or 0 to dump serially
+	if (nodep->funcType() != AstCFuncType::TRACE_CHANGE
+	    || !v3Global.opt.mtasks() || v3Global.opt.traceBin()) return 0;
+	int tasks = 0;
+	for (AstNode* stmtp = nodep->stmtsp(); stmtp; stmtp=stmtp->nextp()) ++tasks;
+	return (tasks >= 2) ? tasks : 0;
+    }
+    void emitTraceChgTasks(AstCFunc* nodep) {
+	puts("\n");
+	puts("void "+topClassName()+"::traceChgTask("
+	     +v3Global.opt.traceClassBase()+"* vcdp, void* userthis, uint32_t code, int task) {\n");
+	putsDecoration("// Callback from vcd->chgTaskRun(), with the trace's activity group to dump\n");
+	puts(EmitCBaseVisitor::symClassVar()+" = static_cast<"+EmitCBaseVisitor::symClassName()+"*>(userthis);\n");
+	puts(EmitCBaseVisitor::symTopAssign()+"\n");
+	puts("switch (task) {\n");
+	int task = 0;
+	for (AstNode* stmtp = nodep->stmtsp(); stmtp; stmtp=stmtp->nextp()) {
+	    puts("case "+cvtToStr(task++)+": {\n");
+	    // A trace here is alone in its task, so can't be packed with the next
+	    m_packNone = (stmtp->castTraceInc() != NULL);
+	    stmtp->iterate(*this);
+	    m_packNone = false;
+	    puts("break;\n");
+	    puts("}\n");
+	}
+	puts("}\n");
+	putsLineDirectiveEnd();
+	puts("}\n");
+    }
+
     bool emitTraceIsScBv(AstTraceInc* nodep) {
 	AstVarRef* varrefp = nodep->valuep()->castVarRef();
 	if (!varrefp) return false;
@@ -2265,6 +3229,41 @@ class EmitCTrace : EmitCStmts {
 	}
 	puts(");\n");
     }
+    bool emitTracePackable(AstTraceInc* nodep) {
+	// Plain 1-bit signal, which chgBits may compare along with others
+	return (!nodep->precondsp()
+		&& !nodep->declp()->arrayRange().ranged()
+		&& !nodep->declp()->bitRange().ranged()
+		&& !nodep->dtypep()->basicp()->isDouble()
+		&& !nodep->isWide() && !nodep->isQuad()
+		&& !emitTraceIsScBv(nodep) && !emitTraceIsScBigUint(nodep));
+    }
+    int emitTraceChangeBits(AstTraceInc* nodep) {
+	// In change functions, pack a run of 1-bit signals with consecutive
+	// codes into a word, so the common case of no change is one compare.
+	// Returns how many signals were emitted, or 0 if none.
+	if (m_funcp->funcType() != AstCFuncType::TRACE_CHANGE
+	    && m_funcp->funcType() != AstCFuncType::TRACE_CHANGE_SUB) return 0;
+	if (m_packNone || !emitTracePackable(nodep)) return 0;
+	vector<AstTraceInc*> incps;
+	incps.push_back(nodep);
+	for (AstNode* nextp = nodep->nextp(); nextp && incps.size() < 32; nextp = nextp->nextp()) {
+	    AstTraceInc* incp = nextp->castTraceInc();
+	    if (!incp || !emitTracePackable(incp)
+		|| incp->declp()->code() != nodep->declp()->code() + incps.size()) break;
+	    incps.push_back(incp);
+	}
+	if (incps.size() < 2) return 0;
+	puts("vcdp->chgBits(c+"+cvtToStr(nodep->declp()->code())+",");
+	for (size_t i=0; i<incps.size(); ++i) {
+	    if (i) puts("\n| ");
+	    puts("((vluint32_t)");
+	    emitTraceValue(incps[i], -1);
+	    puts("<<"+cvtToStr(i)+")");
+	}
+	puts(","+cvtToStr(incps.size())+");\n");
+	return incps.size();
+    }
     void emitTraceValue(AstTraceInc* nodep, int arrayindex) {
 	if (nodep->valuep()->castVarRef()) {
 	    AstVarRef* varrefp = nodep->valuep()->castVarRef();
@@ -2338,15 +3337,27 @@ class EmitCTrace : EmitCStmts {
 
 	    putsDecoration("// Body\n");
 	    puts("{\n");
-	    nodep->stmtsp()->iterateAndNext(*this);
+	    int tasks = traceChgTasks(nodep);
+	    if (tasks) {
+		string count = cvtToStr(tasks);
+		puts("vcdp->chgTasksBegin(&"+topClassName()+"::traceChgTask, "+count+", vlSymsp, code);\n");
+		puts("vlSymsp->__Vm_threadPoolp->executeIndexed(&"
+		     +v3Global.opt.traceClassBase()+"::chgTaskRun, "+count+", vcdp);\n");
+		puts("vcdp->chgTasksEnd();\n");
+	    } else {
+		nodep->stmtsp()->iterateAndNext(*this);
+	    }
 	    puts("}\n");
 	    if (nodep->finalsp()) putsDecoration("// Final\n");
 	    nodep->finalsp()->iterateAndNext(*this);
+	    putsLineDirectiveEnd();
 	    puts("}\n");
+	    if (tasks) emitTraceChgTasks(nodep);
 	}
 	m_funcp = NULL;
     }
     virtual void visit(AstTraceDecl* nodep) {
+	if (nodep->instShared()) return;  // Declared by a call with another instance's function
 	if (nodep->arrayRange().ranged()) {
 	    puts("{int i; for (i=0; i<"+cvtToStr(nodep->arrayRange().elements())+"; i++) {\n");
 	    emitTraceInitOne(nodep);
@@ -2357,11 +3368,17 @@ class EmitCTrace : EmitCStmts {
 	}
     }
     virtual void visit(AstTraceInc* nodep) {
+	if (m_packSkip) {  // Already emitted by emitTraceChangeBits
+	    --m_packSkip;
+	    return;
+	}
 	if (nodep->declp()->arrayRange().ranged()) {
 	    // It traces faster if we unroll the loop
 	    for (int i=0; i<nodep->declp()->arrayRange().elements(); i++) {
 		emitTraceChangeOne(nodep, i);
 	    }
+	} else if (int count = emitTraceChangeBits(nodep)) {
+	    m_packSkip = count - 1;
 	} else {
 	    emitTraceChangeOne(nodep, -1);
 	}
@@ -2375,6 +3392,8 @@ public:
     explicit EmitCTrace(bool slow) {
 	m_funcp = NULL;
 	m_slow = slow;
+	m_packSkip = 0;
+	m_packNone = false;
     }
     virtual ~EmitCTrace() {}
     void main() {
@@ -2393,17 +3412,46 @@ public:
 //######################################################################
 // EmitC class functions
 
+static int emitcFreeBodies(AstNodeModule* modp) {
+    // All emitters are done with this module's function bodies, so free them,
+    // lowering the peak memory as later modules are emitted.  The functions
+    // themselves remain, as calls from other modules refer to them.
+    int freed = 0;
+    for (AstNode* nodep = modp->stmtsp(); nodep; nodep = nodep->nextp()) {
+	if (AstCFunc* funcp = nodep->castCFunc()) {
+	    if (funcp->initsp()) funcp->initsp()->unlinkFrBackWithNext()->deleteTree();
+	    if (funcp->stmtsp()) funcp->stmtsp()->unlinkFrBackWithNext()->deleteTree();
+	    if (funcp->finalsp()) funcp->finalsp()->unlinkFrBackWithNext()->deleteTree();
+	    ++freed;
+	}
+    }
+    return freed;
+}
+
 void V3EmitC::emitc() {
     UINFO(2,__FUNCTION__<<": "<<endl);
+    // Bodies are kept when the tree is later checked, dumped or written as XML
+    bool freeBodies = (!v3Global.opt.debugCheck() && !v3Global.opt.dumpTree());
+    int freed = 0;
+    // Variable usage for --layout-hot-cold, kept until all modules are emitted
+    EmitCVarLayoutVisitor* layoutp = NULL;
+    if (v3Global.opt.layoutHotCold()) layoutp = new EmitCVarLayoutVisitor(v3Global.rootp());
+    // Classes each module refers to, for --output-min-includes
+    EmitCModRefVisitor* modRefsp = NULL;
+    if (v3Global.opt.outputMinIncludes()) modRefsp = new EmitCModRefVisitor(v3Global.rootp());
     // Process each module in turn
     for (AstNodeModule* nodep = v3Global.rootp()->modulesp(); nodep; nodep=nodep->nextp()->castNodeModule()) {
 	if (v3Global.opt.outputSplit()) {
-	    { EmitCImp imp; imp.main(nodep, false, true); }
-	    { EmitCImp imp; imp.main(nodep, true, false); }
+	    { EmitCImp imp; imp.main(nodep, false, true, modRefsp); }
+	    { EmitCImp imp; imp.main(nodep, true, false, modRefsp); }
 	} else {
-	    { EmitCImp imp; imp.main(nodep, true, true); }
+	    { EmitCImp imp; imp.main(nodep, true, true, modRefsp); }
 	}
+	if (freeBodies) freed += emitcFreeBodies(nodep);
     }
+    if (layoutp) { delete layoutp; layoutp=NULL; }
+    if (modRefsp) { delete modRefsp; modRefsp=NULL; }
+    if (freed) V3Stats::addStat("EmitC, Function bodies freed after emit", freed);
 }
 
 void V3EmitC::emitcTrace() {
@@ -59,6 +59,80 @@ public:
     static string topClassName() {		// Return name of top wrapper module
 	return v3Global.opt.prefix();
     }
+    static bool vpiChgVar(const AstVar* varp) {	// Writes to this variable mark VPI value changes
+	return (v3Global.opt.vpi() && varp->isSigUserRdPublic() && !varp->isParam()
+		&& !varp->isPrimaryIn() && !varp->isSc());
+    }
+    static string vpiChgName(const AstVar* varp) {	// Name of variable's VPI value change flag
+	return "__Vvpichg__"+varp->name();
+    }
+    static bool pinsChangedVar(const AstVar* varp) {	// Input only converted from SystemC when changed
+	return (v3Global.opt.pinsChanged() && varp->isInput() && varp->isSc()
+		&& (varp->isScBv() || varp->isScBigUint())
+		&& !varp->dtypeSkipRefp()->castUnpackArrayDType());
+    }
+    static string pinsChangedName(const AstVar* varp) {	// Name of pin's last converted value
+	return "__Vsclast__"+varp->name();
+    }
+    static double varBytes(AstVar* varp) {	// Bytes of C storage for variable, including unpacked arrays
+	double bytes = (varp->isWide() ? varp->widthWords() * (VL_WORDSIZE/8)
+			: varp->isQuad() ? 8 : (varp->width() > 16) ? 4 : (varp->width() > 8) ? 2 : 1);
+	for (AstUnpackArrayDType* arrayp=varp->dtypeSkipRefp()->castUnpackArrayDType(); arrayp;
+	     arrayp = arrayp->subDTypep()->skipRefp()->castUnpackArrayDType()) {
+	    bytes *= arrayp->elementsConst();
+	}
+	return bytes;
+    }
+    static bool classMemberVar(AstVar* varp) {	// Variable is a member of each instance of its module class
+	return (!varp->isStatic()
+		&& (varp->isIO() || varp->isSignal() || varp->isTemp()
+		    || (varp->isParam() && !varp->valuep()->castConst())));
+    }
+    static bool sparseArray(AstVar* varp) {	// Variable is stored as a VlSparseArray
+	AstUnpackArrayDType* adtypep = varp->dtypeSkipRefp()->castUnpackArrayDType();
+	AstBasicDType* basicp = varp->basicp();
+	if (!adtypep || adtypep->subDTypep()->skipRefp()->castUnpackArrayDType()  // One dimension only
+	    || !basicp || basicp->isOpaque() || basicp->isZeroInit()
+	    || varp->isIO() || varp->isParam() || varp->isStatic() || varp->isSc()
+	    || varp->isSigPublic() || varp->attrFileDescr()
+	    || (v3Global.opt.underlineZero() && varp->name().size()>=1 && varp->name()[0]=='_')) {
+	    return false;
+	}
+	return (varp->attrSparse()
+		|| (v3Global.opt.sparseMemMin()
+		    && varBytes(varp) >= (double)v3Global.opt.sparseMemMin() * 1024.0));
+    }
+    static string memoryKind(AstVar* varp) {	// VerilatedMemoryKind of a classMemberVar(), for memoryReport
+	if (sparseArray(varp)) return "VL_MEMKIND_SPARSE";
+	else if (varp->isShadow()) return "VL_MEMKIND_SHADOW";
+	else if (varp->dtypeSkipRefp()->castUnpackArrayDType()) return "VL_MEMKIND_ARRAY";
+	else return "VL_MEMKIND_SIGNAL";
+    }
+    static string sparseArrayType(AstVar* varp) {	// C type of a sparseArray() variable
+	string entry = (varp->widthMin() <= 8 ? "CData" : varp->widthMin() <= 16 ? "SData"
+			: varp->isQuad() ? "QData" : !varp->isWide() ? "IData"
+			: "WData["+cvtToStr(varp->widthWords())+"]");
+	return ("VlSparseArray<"+entry+","+cvtToStr(varp->widthMin())
+		+","+cvtToStr(varp->dtypeSkipRefp()->castUnpackArrayDType()->elementsConst())+">");
+    }
+    static bool constPoolVar(AstVar* varp) {	// Constant table shared from __Syms, see EmitCSyms
+	AstInitArray* initarp = varp->valuep() ? varp->valuep()->castInitArray() : NULL;
+	AstUnpackArrayDType* adtypep = varp->dtypeSkipRefp()->castUnpackArrayDType();
+	if (!varp->isStatic() || !varp->isConst() || !initarp || !adtypep
+	    || adtypep->subDTypep()->skipRefp()->castUnpackArrayDType()  // One dimension only
+	    || varp->isWide() || varp->isSigPublic()) {
+	    return false;
+	}
+	if (initarp->defaultp() && !initarp->defaultp()->castConst()) return false;
+	for (AstNode* itemp = initarp->initsp(); itemp; itemp=itemp->nextp()) {
+	    if (!itemp->castConst()) return false;
+	}
+	return true;
+    }
+    static string constPoolType(AstVar* varp) {	// C type of each element of a constPoolVar()
+	return (varp->widthMin() <= 8 ? "CData" : varp->widthMin() <= 16 ? "SData"
+		: varp->isQuad() ? "QData" : "IData");
+    }
     AstCFile* newCFile(const string& filename, bool slow, bool source) {
 	AstCFile* cfilep = new AstCFile(v3Global.rootp()->fileline(), filename);
 	cfilep->slow(slow);
@@ -99,19 +173,23 @@ class EmitCBaseCounterVisitor : public AstNVisitor {
 private:
     // STATE
     int			m_count;	// Number of statements
+    int			m_cost;		// Estimated compile plus run cost
     // VISITORS
     virtual void visit(AstNode* nodep) {
 	m_count++;
+	m_cost += 1 + nodep->instrCount();  // Each node costs compile time, plus its instructions
 	nodep->iterateChildren(*this);
     }
 public:
     // CONSTUCTORS
     explicit EmitCBaseCounterVisitor(AstNode* nodep) {
 	m_count = 0;
+	m_cost = 0;
 	nodep->accept(*this);
     }
     virtual ~EmitCBaseCounterVisitor() {}
     int count() const { return m_count; }
+    int cost() const { return m_cost; }
 };
 
 #endif // guard
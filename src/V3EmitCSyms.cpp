@@ -33,6 +33,7 @@
 #include "V3EmitC.h"
 #include "V3EmitCBase.h"
 #include "V3LanguageWords.h"
+#include "V3Stats.h"
 
 //######################################################################
 // Symbol table emitting
@@ -62,6 +63,10 @@ class EmitCSyms : EmitCBaseVisitor {
     typedef map<string,ScopeNameData> ScopeNames;
     typedef pair<AstScope*,AstNodeModule*> ScopeModPair;
     typedef pair<AstNodeModule*,AstVar*> ModVarPair;
+    struct ConstPoolData { string m_type; vector<vluint64_t> m_values;
+	ConstPoolData(const string& type, const vector<vluint64_t>& values)
+	    : m_type(type), m_values(values) {}
+    };
     struct CmpName {
 	inline bool operator () (const ScopeModPair& lhsp, const ScopeModPair& rhsp) const {
 	    return lhsp.first->name() < rhsp.first->name();
@@ -86,13 +91,22 @@ class EmitCSyms : EmitCBaseVisitor {
     ScopeNames		m_scopeNames;	// Each unique AstScopeName
     ScopeFuncs		m_scopeFuncs;	// Each {scope,dpi-export-func}
     ScopeVars		m_scopeVars;	// Each {scope,public-var}
+    set<string>		m_scopeVarFuncs;	// Each scope with an emitted variable table
     V3LanguageWords 	m_words;	// Reserved word detector
     int		m_coverBins;		// Coverage bin number
     int		m_labelNum;		// Next label number
+    double	m_traceCodes;		// Trace codes, each a word of old value
+    vector<string>	m_activityNames;	// Name of each --profile-activity counter
+    vector<string>	m_convergeNames;	// Name of each --profile-converge change counter
+    map<string,int>	m_convergeBins;		// Counter number of each --profile-converge name
+    vector<ConstPoolData> m_constPool;	// Each unique constant table
+    map<string,int>	m_constPoolNums;	// Pool number of each constant table's contents
+    int		m_constPoolShared;	// Constant tables found already in the pool
 
     // METHODS
     void emitSymHdr();
     void emitSymImp();
+    void emitScopeVarFuncs();
     void emitDpiHdr();
     void emitDpiImp();
 
@@ -108,6 +122,33 @@ class EmitCSyms : EmitCBaseVisitor {
 	}
     }
 
+    void constPoolAdd(AstVar* varp) {
+	// Tables with identical contents, from any module, share one static const array
+	AstInitArray* initarp = varp->valuep()->castInitArray();
+	int elements = varp->dtypeSkipRefp()->castUnpackArrayDType()->elementsConst();
+	vluint64_t fill = initarp->defaultp() ? initarp->defaultp()->castConst()->toUQuad() : 0;
+	vector<vluint64_t> values (elements, fill);
+	int pos = 0;
+	for (AstNode* itemp = initarp->initsp(); itemp; ++pos, itemp=itemp->nextp()) {
+	    int index = initarp->posIndex(pos);
+	    if (index >= elements) initarp->v3fatalSrc("InitArray index past end of array");
+	    values[index] = itemp->castConst()->toUQuad();
+	}
+	string type = constPoolType(varp);
+	string key = type;
+	for (vector<vluint64_t>::iterator it = values.begin(); it != values.end(); ++it) {
+	    key += " "+cvtToStr(*it);
+	}
+	map<string,int>::iterator it = m_constPoolNums.find(key);
+	if (it == m_constPoolNums.end()) {
+	    it = m_constPoolNums.insert(make_pair(key, (int)m_constPool.size())).first;
+	    m_constPool.push_back(ConstPoolData(type, values));
+	} else {
+	    ++m_constPoolShared;
+	}
+	varp->name("__Vconst"+cvtToStr(it->second));
+    }
+
     void varsExpand() {
 	// We didn'e have all m_scopes loaded when we encountered variables, so expand them now
 	// It would be less code if each module inserted its own variables.
@@ -210,6 +251,7 @@ class EmitCSyms : EmitCBaseVisitor {
     virtual void visit(AstVar* nodep) {
 	nameCheck(nodep);
 	nodep->iterateChildren(*this);
+	if (constPoolVar(nodep)) constPoolAdd(nodep);
 	if (nodep->isSigUserRdPublic()
 	    && !nodep->isParam()) {  // The VPI functions require a pointer to allow modification, but parameters are constants
 	    m_modVars.push_back(make_pair(m_modp, nodep));
@@ -221,13 +263,37 @@ class EmitCSyms : EmitCBaseVisitor {
 	    nodep->binNum(m_coverBins++);
 	}
     }
+    virtual void visit(AstActivityInc* nodep) {
+	// Assign numbers to all counters, so we know how big of an array to use
+	nodep->binNum(m_activityNames.size());
+	m_activityNames.push_back(nodep->name());
+    }
+    virtual void visit(AstChangeDet* nodep) {
+	// Variables with several detections, such as array elements, share a counter
+	if (!nodep->lhsp()) return;
+	AstNode* fromp = nodep->lhsp();
+	while (AstArraySel* selp = fromp->castArraySel()) fromp = selp->fromp();
+	string name = (fromp->castVarRef() ? fromp->castVarRef()->varp()->prettyName()
+		       : nodep->lhsp()->prettyTypeName());
+	name += " "+nodep->fileline()->filename()+":"+cvtToStr(nodep->fileline()->lineno());
+	map<string,int>::iterator it = m_convergeBins.find(name);
+	if (it == m_convergeBins.end()) {
+	    it = m_convergeBins.insert(make_pair(name, (int)m_convergeNames.size())).first;
+	    m_convergeNames.push_back(name);
+	}
+	nodep->binNum(it->second);
+    }
+    virtual void visit(AstTraceDecl* nodep) {
+	m_traceCodes += nodep->codeInc();
+    }
     virtual void visit(AstJumpLabel* nodep) {
 	nodep->labelNum(++m_labelNum);
 	nodep->iterateChildren(*this);
     }
     virtual void visit(AstCFunc* nodep) {
 	nameCheck(nodep);
-	if (nodep->dpiImport() || nodep->dpiExportWrapper()) {
+	if ((nodep->dpiImport() || nodep->dpiExportWrapper())
+	    && nodep->argTypes() == "") {  // __Vbound exports are C++ only, so not in __Dpi.h
 	    m_dpis.push_back(nodep);
 	}
 	m_funcp = nodep;
@@ -247,8 +313,11 @@ public:
 	m_funcp = NULL;
 	m_modp = NULL;
 	m_coverBins = 0;
+	m_constPoolShared = 0;
 	m_labelNum = 0;
+	m_traceCodes = 0;
 	nodep->accept(*this);
+	V3Stats::addStat("EmitC, Constant tables shared", m_constPoolShared);
     }
 };
 
@@ -275,11 +344,27 @@ void EmitCSyms::emitSymHdr() {
     } else {
 	puts("#include \"verilated.h\"\n");
     }
+    if (v3Global.opt.mtasks()) {
+	puts("#include \"verilated_threads.h\"\n");
+    }
+    if (v3Global.opt.profileConverge()) {
+	puts("#include \"verilated_prof.h\"\n");
+    }
 
     // for
-    puts("\n// INCLUDE MODULE CLASSES\n");
-    for (AstNodeModule* nodep = v3Global.rootp()->modulesp(); nodep; nodep=nodep->nextp()->castNodeModule()) {
-	puts("#include \""+modClassName(nodep)+".h\"\n");
+    bool minIncludes = v3Global.opt.outputMinIncludes();
+    if (minIncludes) {
+	// Each file includes the classes it uses, so editing one module
+	// doesn't recompile every file
+	puts("\n// DECLARE MODULE CLASSES (from --output-min-includes)\n");
+	for (AstNodeModule* nodep = v3Global.rootp()->modulesp(); nodep; nodep=nodep->nextp()->castNodeModule()) {
+	    puts("class "+modClassName(nodep)+";\n");
+	}
+    } else {
+	puts("\n// INCLUDE MODULE CLASSES\n");
+	for (AstNodeModule* nodep = v3Global.rootp()->modulesp(); nodep; nodep=nodep->nextp()->castNodeModule()) {
+	    puts("#include \""+modClassName(nodep)+".h\"\n");
+	}
     }
 
     if (v3Global.dpi()) {
@@ -305,6 +390,9 @@ void EmitCSyms::emitSymHdr() {
     puts("const char* __Vm_namep;\n");	// Must be before subcells, as constructor order needed before _vlCoverInsert.
     puts("bool\t__Vm_activity;\t\t///< Used by trace routines to determine change occurred\n");
     puts("bool\t__Vm_didInit;\n");
+    if (v3Global.opt.mtasks()) {
+	puts("VlThreadPool*\t__Vm_threadPoolp;\t///< Runs macro-tasks (--threads)\n");
+    }
 
     puts("\n// SUBCELL STATE\n");
     for (vector<ScopeModPair>::iterator it = m_scopes.begin(); it != m_scopes.end(); ++it) {
@@ -314,14 +402,36 @@ void EmitCSyms::emitSymHdr() {
 	    puts(scopep->nameDotless()+"p;\n");
 	}
 	else {
-	    ofp()->printf("%-30s ", (modClassName(modp)+"").c_str());
+	    // With only declarations, the instances are allocated by the constructor
+	    ofp()->printf("%-30s ", (modClassName(modp)+(minIncludes?"&":"")).c_str());
 	    puts(scopep->nameDotless()+";\n");
 	}
     }
 
     puts("\n// COVERAGE\n");
     if (m_coverBins) {
-	puts("uint32_t\t__Vcoverage["); puts(cvtToStr(m_coverBins)); puts("];\n");
+	// Start on its own cache line, apart from the flags written every eval
+	puts("uint32_t\t__Vcoverage["); puts(cvtToStr(m_coverBins)); puts("] VL_ATTR_ALIGNED(64);\n");
+    }
+
+    if (!m_activityNames.empty()) {
+	puts("\n// ACTIVITY\n");
+	puts("vluint64_t\t__Vactivity["+cvtToStr(m_activityNames.size())+"] VL_ATTR_ALIGNED(64);\n");
+    }
+
+    if (v3Global.opt.profileConverge()) {
+	puts("\n// CONVERGENCE\n");
+	puts("vluint64_t\t__Vconverge_loops[VL_PROF_CONVERGE_LOOPS] VL_ATTR_ALIGNED(64);\n");
+	// At least one entry, as zero length arrays aren't standard
+	puts("vluint64_t\t__Vconverge_chg["+cvtToStr(max((size_t)1, m_convergeNames.size()))+"];\n");
+    }
+
+    if (!m_constPool.empty()) {
+	puts("\n// CONSTANT TABLES\n");
+	for (size_t i=0; i<m_constPool.size(); ++i) {
+	    puts("static const "+m_constPool[i].m_type+"\t__Vconst"+cvtToStr(i)
+		 +"["+cvtToStr(m_constPool[i].m_values.size())+"];\n");
+	}
     }
 
     puts("\n// SCOPE NAMES\n");
@@ -331,14 +441,29 @@ void EmitCSyms::emitSymHdr() {
 
     puts("\n// CREATORS\n");
     puts(symClassName()+"("+topClassName()+"* topp, const char* namep);\n");
-    puts((string)"~"+symClassName()+"() {};\n");
+    if (minIncludes || !m_activityNames.empty() || v3Global.opt.profileConverge()) {
+	puts((string)"~"+symClassName()+"();\n");
+    } else if (v3Global.opt.mtasks()) {
+	puts((string)"~"+symClassName()+"() { delete __Vm_threadPoolp; __Vm_threadPoolp=NULL; };\n");
+    } else {
+	puts((string)"~"+symClassName()+"() {};\n");
+    }
 
     puts("\n// METHODS\n");
     puts("inline const char* name() { return __Vm_namep; }\n");
     puts("inline bool getClearActivity() { bool r=__Vm_activity; __Vm_activity=false; return r;}\n");
+    puts("void __Vmemory_report();\n");
     if (v3Global.opt.savable() ) {
 	puts("void __Vserialize(VerilatedSerialize& os);\n");
 	puts("void __Vdeserialize(VerilatedDeserialize& os);\n");
+	// Chunk 0 is the top and this, then each other instance
+	int chunks = 1;
+	for (vector<ScopeModPair>::iterator it = m_scopes.begin(); it != m_scopes.end(); ++it) {
+	    if (!it->second->isTop()) ++chunks;
+	}
+	puts("static int __Vchunks() { return "+cvtToStr(chunks)+"; }\n");
+	puts("void __VserializeChunk(int chunk, VerilatedSerialize& os);\n");
+	puts("void __VdeserializeChunk(int chunk, VerilatedDeserialize& os);\n");
     }
     puts("\n");
     puts("} VL_ATTR_ALIGNED(64);\n");
@@ -346,6 +471,71 @@ void EmitCSyms::emitSymHdr() {
     puts("#endif  /*guard*/\n");
 }
 
+void EmitCSyms::emitScopeVarFuncs() {
+    // Each scope's public variables are a table inserted on first lookup,
+    // rather than a call per variable in the constructor
+    typedef map<string,vector<string> > ScopeEntries;
+    ScopeEntries entries;
+    for (ScopeVars::iterator it = m_scopeVars.begin(); it != m_scopeVars.end(); ++it) {
+	AstNodeModule* modp = it->second.m_modp;
+	AstScope* scopep = it->second.m_scopep;
+	AstVar* varp = it->second.m_varp;
+	//
+	int pdim=0;
+	int udim=0;
+	string bounds;
+	if (AstBasicDType* basicp = varp->basicp()) {
+	    // Range is always first, it's not in "C" order
+	    if (basicp->isRanged()) {
+		bounds += ","; bounds += cvtToStr(basicp->msb());
+		bounds += ","; bounds += cvtToStr(basicp->lsb());
+		pdim++;
+	    }
+	    for (AstNodeDType* dtypep=varp->dtypep(); dtypep; ) {
+		dtypep = dtypep->skipRefp();  // Skip AstRefDType/AstTypedef, or return same node
+		if (AstNodeArrayDType* adtypep = dtypep->castNodeArrayDType()) {
+		    bounds += ","; bounds += cvtToStr(adtypep->msb());
+		    bounds += ","; bounds += cvtToStr(adtypep->lsb());
+		    if (dtypep->castPackArrayDType()) pdim++; else udim++;
+		    dtypep = adtypep->subDTypep();
+		}
+		else break; // AstBasicDType - nothing below, 1
+	    }
+	}
+	if (pdim>1 || udim>1) {
+	    // VerilatedImp can't deal with >2d or packed arrays
+	    puts("//UNSUP "+it->second.m_scopeName+" "+varp->name()+"\n");
+	    continue;
+	}
+	for (int i=pdim+udim; i<2; ++i) bounds += ",0,0";
+	string scopeAccess = (modp->isTop() ? "vlSymsp->"+scopep->nameDotless()+"p->"
+			      : "vlSymsp->"+scopep->nameDotless()+".");
+	string entry = "{\""+it->second.m_varBasePretty+"\"";
+	entry += ", &("+scopeAccess+varp->name()+")";
+	if (vpiChgVar(varp)) entry += ", &("+scopeAccess+vpiChgName(varp)+")";
+	else entry += ", NULL";
+	entry += ", "+string(varp->vlEnumType());  // VLVT_UINT32 etc
+	entry += ", "+string(varp->vlEnumDir());  // VLVD_IN etc
+	if (varp->isSigUserRWPublic()) entry += "|VLVF_PUB_RW";
+	else if (varp->isSigUserRdPublic()) entry += "|VLVF_PUB_RD";
+	entry += ", "+cvtToStr(pdim+udim);
+	entry += ", {"+bounds.substr(1)+"}}";
+	entries[it->second.m_scopeName].push_back(entry);
+    }
+    for (ScopeEntries::iterator it = entries.begin(); it != entries.end(); ++it) {
+	m_scopeVarFuncs.insert(it->first);
+	puts("\nstatic void __Vscope_vars_"+it->first+"(VerilatedScope* scopep) {\n");
+	puts(symClassName()+"* vlSymsp = static_cast<"+symClassName()+"*>(scopep->symsp());\n");
+	puts("const VerilatedVarDesc vars[] = {\n");
+	for (vector<string>::iterator eit = it->second.begin(); eit != it->second.end(); ++eit) {
+	    puts(*eit+",\n");
+	}
+	puts("};\n");
+	puts("scopep->varsInsert(vars, "+cvtToStr(it->second.size())+");\n");
+	puts("}\n");
+    }
+}
+
 void EmitCSyms::emitSymImp() {
     UINFO(6,__FUNCTION__<<": "<<endl);
     string filename = v3Global.opt.makeDir()+"/"+symClassName()+".cpp";
@@ -363,14 +553,54 @@ void EmitCSyms::emitSymImp() {
 	puts("#include \""+modClassName(nodep)+".h\"\n");
     }
 
+    if (!m_activityNames.empty()) {
+	puts("#include \"verilated_prof.h\"\n");
+	puts("\n// ACTIVITY NAMES\n");
+	puts("static const char* const __Vactivity_names[] = {\n");
+	for (vector<string>::iterator it = m_activityNames.begin(); it != m_activityNames.end(); ++it) {
+	    putsQuoted(*it);
+	    puts(",\n");
+	}
+	puts("};\n");
+    }
+    if (v3Global.opt.profileConverge()) {
+	puts("\n// CONVERGENCE NAMES\n");
+	puts("static const char* const __Vconverge_names[] = {\n");
+	for (vector<string>::iterator it = m_convergeNames.begin(); it != m_convergeNames.end(); ++it) {
+	    putsQuoted(*it);
+	    puts(",\n");
+	}
+	puts("NULL};\n");
+    }
+
+    if (!m_constPool.empty()) {
+	puts("\n// CONSTANT TABLES\n");
+	for (size_t i=0; i<m_constPool.size(); ++i) {
+	    const ConstPoolData& data = m_constPool[i];
+	    puts("const "+data.m_type+" "+symClassName()+"::__Vconst"+cvtToStr(i)
+		 +"["+cvtToStr(data.m_values.size())+"] = {");
+	    for (size_t v=0; v<data.m_values.size(); ++v) {
+		if (v % 8 == 0) puts("\n");
+		if (data.m_type == "QData") ofp()->printf("VL_ULL(0x%" VL_PRI64 "x),", data.m_values[v]);
+		else ofp()->printf("0x%x,", (unsigned)data.m_values[v]);
+	    }
+	    puts("\n};\n");
+	}
+    }
+
     //puts("\n// GLOBALS\n");
 
+    if (v3Global.dpi()) emitScopeVarFuncs();
+
     puts("\n// FUNCTIONS\n");
     puts(symClassName()+"::"+symClassName()+"("+topClassName()+"* topp, const char* namep)\n");
     puts("\t// Setup locals\n");
     puts("\t: __Vm_namep(namep)\n");	// No leak, as we get destroyed when the top is destroyed
     puts("\t, __Vm_activity(false)\n");
     puts("\t, __Vm_didInit(false)\n");
+    if (v3Global.opt.mtasks()) {
+	puts("\t, __Vm_threadPoolp(new VlThreadPool("+cvtToStr(v3Global.opt.threads())+"))\n");
+    }
     puts("\t// Setup submodule names\n");
     char comma=',';
     for (vector<ScopeModPair>::iterator it = m_scopes.begin(); it != m_scopes.end(); ++it) {
@@ -379,10 +609,13 @@ void EmitCSyms::emitSymImp() {
 	} else {
 	    string nameDl = scopep->nameDotless();
 	    ofp()->printf("\t%c %-30s ", comma, nameDl.c_str());
+	    if (v3Global.opt.outputMinIncludes()) puts("(*new "+modClassName(modp));
 	    puts("(Verilated::catName(topp->name(),");
 	    // The "." is added by catName
 	    putsQuoted(scopep->prettyName());
-	    puts("))\n");
+	    puts("))");
+	    if (v3Global.opt.outputMinIncludes()) puts(")");
+	    puts("\n");
 	    comma=',';
 	}
     }
@@ -420,6 +653,16 @@ void EmitCSyms::emitSymImp() {
 	}
     }
 
+    if (!m_activityNames.empty()) {
+	puts("// Register block activity counters\n");
+	puts("VerilatedProfActivity::insert(__Vactivity, __Vactivity_names, "
+	     +cvtToStr(m_activityNames.size())+");\n");
+    }
+    if (v3Global.opt.profileConverge()) {
+	puts("// Register eval convergence counters\n");
+	puts("VerilatedProfConverge::insert(__Vconverge_loops, __Vconverge_chg, __Vconverge_names, "
+	     +cvtToStr(m_convergeNames.size())+");\n");
+    }
     puts("// Setup scope names\n");
     for (ScopeNames::iterator it = m_scopeNames.begin(); it != m_scopeNames.end(); ++it) {
 	puts("__Vscope_"+it->second.m_symName+".configure(this,name(),");
@@ -444,63 +687,59 @@ void EmitCSyms::emitSymImp() {
 		puts("));\n");
 	    }
 	}
-	// It would be less code if each module inserted its own variables.
-	// Someday.  For now public isn't common.
-	for (ScopeVars::iterator it = m_scopeVars.begin(); it != m_scopeVars.end(); ++it) {
-	    AstNodeModule* modp = it->second.m_modp;
-	    AstScope* scopep = it->second.m_scopep;
-	    AstVar* varp = it->second.m_varp;
-	    //
-	    int pdim=0;
-	    int udim=0;
-	    string bounds;
-	    if (AstBasicDType* basicp = varp->basicp()) {
-		// Range is always first, it's not in "C" order
-		if (basicp->isRanged()) {
-		    bounds += " ,"; bounds += cvtToStr(basicp->msb());
-		    bounds += ","; bounds += cvtToStr(basicp->lsb());
-		    pdim++;
-		}
-		for (AstNodeDType* dtypep=varp->dtypep(); dtypep; ) {
-		    dtypep = dtypep->skipRefp();  // Skip AstRefDType/AstTypedef, or return same node
-		    if (AstNodeArrayDType* adtypep = dtypep->castNodeArrayDType()) {
-			bounds += " ,"; bounds += cvtToStr(adtypep->msb());
-			bounds += ","; bounds += cvtToStr(adtypep->lsb());
-			if (dtypep->castPackArrayDType()) pdim++; else udim++;
-			dtypep = adtypep->subDTypep();
-		    }
-		    else break; // AstBasicDType - nothing below, 1
+	puts("}\n");
+	puts("// Setup public variables, inserted on first lookup\n");
+	for (set<string>::iterator it = m_scopeVarFuncs.begin(); it != m_scopeVarFuncs.end(); ++it) {
+	    puts("__Vscope_"+*it+".varsLazy(&__Vscope_vars_"+*it+");\n");
+	}
+    }
+
+    puts("}\n");
+
+    if (v3Global.opt.outputMinIncludes() || !m_activityNames.empty()
+	|| v3Global.opt.profileConverge()) {
+	puts("\n"+symClassName()+"::~"+symClassName()+"() {\n");
+	if (!m_activityNames.empty()) {
+	    puts("VerilatedProfActivity::remove(__Vactivity);\n");
+	}
+	if (v3Global.opt.profileConverge()) {
+	    puts("VerilatedProfConverge::remove(__Vconverge_loops);\n");
+	}
+	if (v3Global.opt.mtasks()) {
+	    puts("delete __Vm_threadPoolp; __Vm_threadPoolp=NULL;\n");
+	}
+	if (v3Global.opt.outputMinIncludes()) {
+	    // Reverse of construction, as for members
+	    for (vector<ScopeModPair>::reverse_iterator it = m_scopes.rbegin(); it != m_scopes.rend(); ++it) {
+		AstScope* scopep = it->first;  AstNodeModule* modp = it->second;
+		if (!modp->isTop()) {
+		    puts("delete &"+scopep->nameDotless()+";\n");
 		}
 	    }
-	    //
-	    if (pdim>1 || udim>1) {
-		puts("//UNSUP ");  // VerilatedImp can't deal with >2d or packed arrays
-	    }
-	    puts("__Vscope_"+it->second.m_scopeName+".varInsert(__Vfinal,");
-	    putsQuoted(it->second.m_varBasePretty);
-	    puts(", &(");
-	    if (modp->isTop()) {
-		puts(scopep->nameDotless());
-		puts("p->");
-	    } else {
-		puts(scopep->nameDotless());
-		puts(".");
-	    }
-	    puts(varp->name());
-	    puts("), ");
-	    puts(varp->vlEnumType());  // VLVT_UINT32 etc
-	    puts(",");
-	    puts(varp->vlEnumDir());  // VLVD_IN etc
-	    if (varp->isSigUserRWPublic()) puts("|VLVF_PUB_RW");
-	    else if (varp->isSigUserRdPublic()) puts("|VLVF_PUB_RD");
-	    puts(",");
-	    puts(cvtToStr(pdim+udim));
-	    puts(bounds);
-	    puts(");\n");
 	}
 	puts("}\n");
     }
 
+    puts("\nvoid "+symClassName()+"::__Vmemory_report() {\n");
+    puts(   "VerilatedMemoryReport report;\n");
+    for (vector<ScopeModPair>::iterator it = m_scopes.begin(); it != m_scopes.end(); ++it) {
+	AstScope* scopep = it->first;  AstNodeModule* modp = it->second;
+	string instp = modp->isTop() ? "TOPp->" : scopep->nameDotless()+".";
+	puts("report.instance(");
+	putsQuoted(scopep->prettyName());
+	puts(", sizeof("+modClassName(modp)+"), "+modClassName(modp)+"::__Vmemory);\n");
+	for (AstNode* nodep=modp->stmtsp(); nodep; nodep = nodep->nextp()) {
+	    if (AstVar* varp = nodep->castVar()) {
+		if (sparseArray(varp)) {
+		    puts("report.sparse(\""+varp->prettyName()+"\", "+instp+varp->name()+".memoryBytes());\n");
+		}
+	    }
+	}
+    }
+    if (m_traceCodes) {
+	puts("report.trace("+cvtToStr((vluint64_t)m_traceCodes * sizeof(vluint32_t))+");\n");
+    }
+    puts("report.totals();\n");
     puts("}\n");
 
     if (v3Global.opt.savable() ) {
@@ -522,6 +761,23 @@ void EmitCSyms::emitSymImp() {
 		}
 	    }
 	    puts("}\n");
+	    puts("void "+symClassName()+"::"+funcname+"Chunk(int chunk, "+classname+"& os) {\n");
+	    puts(   "switch (chunk) {\n");
+	    puts(   "case 0:\n");
+	    puts(   "os"+op+"__Vm_activity;\n");
+	    puts(   "os"+op+"__Vm_didInit;\n");
+	    puts(   "TOPp->"+funcname+"Self(os);\n");
+	    puts(   "break;\n");
+	    int chunk = 1;
+	    for (vector<ScopeModPair>::iterator it = m_scopes.begin(); it != m_scopes.end(); ++it) {
+		AstScope* scopep = it->first;  AstNodeModule* modp = it->second;
+		if (!modp->isTop()) {
+		    puts(   "case "+cvtToStr(chunk++)+": "+scopep->nameDotless()+"."+funcname+"(os); break;\n");
+		}
+	    }
+	    puts(   "default: break;\n");
+	    puts(   "}\n");
+	    puts("}\n");
 	}
     }
 }
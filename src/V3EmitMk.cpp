@@ -23,6 +23,7 @@
 #include <cstdio>
 #include <cstdarg>
 #include <unistd.h>
+#include <sys/stat.h>
 #include <cmath>
 #include <map>
 #include <vector>
@@ -64,6 +65,14 @@ public:
 	of.puts("VM_COVERAGE = "); of.puts(v3Global.opt.coverage()?"1":"0"); of.puts("\n");
 	of.puts("# Tracing output mode?  0/1 (from --trace)\n");
 	of.puts("VM_TRACE = "); of.puts(v3Global.opt.trace()?"1":"0"); of.puts("\n");
+	of.puts("# Threaded output mode?  0/1 (from --threads)\n");
+	of.puts("VM_THREADS = "); of.puts(v3Global.opt.mtasks()?"1":"0"); of.puts("\n");
+	of.puts("# Time from VerilatedContext?  0/1 (from --time-context)\n");
+	of.puts("VM_TIME_CONTEXT = "); of.puts(v3Global.opt.timeContext()?"1":"0"); of.puts("\n");
+	of.puts("# Wide arrays never alias?  0/1 (from --restrict-wide)\n");
+	of.puts("VM_RESTRICT_WIDE = "); of.puts(v3Global.opt.restrictWide()?"1":"0"); of.puts("\n");
+	of.puts("# Quick build mode?  0/1 (from --quick-build)\n");
+	of.puts("VM_QUICK = "); of.puts(v3Global.opt.quickBuild()?"1":"0"); of.puts("\n");
 
 	of.puts("\n### Object file lists...\n");
 	for (int support=0; support<3; support++) {
@@ -78,6 +87,9 @@ public:
 		of.puts(" += \\\n");
 		if (support==2 && !slow) {
 		    putMakeClassEntry(of, "verilated.cpp");
+		    if (v3Global.opt.mtasks()) {
+			putMakeClassEntry(of, "verilated_threads.cpp");
+		    }
 		    if (v3Global.dpi()) {
 			putMakeClassEntry(of, "verilated_dpi.cpp");
 		    }
@@ -90,8 +102,14 @@ public:
 		    if (v3Global.opt.coverage()) {
 			putMakeClassEntry(of, "verilated_cov.cpp");
 		    }
+		    if (v3Global.opt.linkPorts()) {
+			putMakeClassEntry(of, "verilated_link.cpp");
+		    }
 		    if (v3Global.opt.trace()) {
 			putMakeClassEntry(of, "verilated_vcd_c.cpp");
+			if (v3Global.opt.traceBin()) {
+			    putMakeClassEntry(of, "verilated_bin_c.cpp");
+			}
 			if (v3Global.opt.systemC()) {
 			    putMakeClassEntry(of, "verilated_vcd_sc.cpp");
 			}
@@ -110,10 +128,60 @@ public:
 	    }
 	}
 
+	if (v3Global.opt.outputGroups()) emitGroups(of);
+
 	of.puts("\n");
 	of.putsHeader();
     }
 
+    void emitGroups(V3OutMkFile& of) {
+	// Unity build groups for --output-groups.  Each of the fast and slow
+	// files are spread across the groups by size, largest first to the
+	// smallest group, so the groups take similar times to compile.
+	of.puts("\n### Unity build groups, compiled instead of the files above (from --output-groups)\n");
+	string groupList;
+	string groupRules;
+	for (int slow=0; slow<2; slow++) {
+	    vector<pair<off_t,string> > files;  // Size, filename
+	    for (AstCFile* nodep = v3Global.rootp()->filesp(); nodep; nodep=nodep->nextp()->castCFile()) {
+		if (nodep->source() && nodep->slow()==(slow!=0)) {
+		    struct stat st;
+		    off_t size = (stat(nodep->name().c_str(), &st) == 0) ? st.st_size : 0;
+		    files.push_back(make_pair(size, V3Os::filenameNonDir(nodep->name())));
+		}
+	    }
+	    if (files.empty()) continue;
+	    int ngroups = min((int)files.size(), v3Global.opt.outputGroups());
+	    vector<off_t> groupSizes (ngroups, 0);
+	    vector<V3StringList> groupFiles (ngroups);
+	    stable_sort(files.begin(), files.end(), GroupSizeCmp());
+	    for (size_t i=0; i<files.size(); ++i) {
+		int smallest = min_element(groupSizes.begin(), groupSizes.end()) - groupSizes.begin();
+		groupSizes[smallest] += files[i].first;
+		groupFiles[smallest].push_back(files[i].second);
+	    }
+	    for (int g=0; g<ngroups; ++g) {
+		// Slow groups are named __Slow so verilated.mk compiles them with OPT_SLOW
+		string name = v3Global.opt.prefix()+"__Group"+cvtToStr(g+1)+(slow?"__Slow":"");
+		groupList += "\t"+name+" \\\n";
+		groupRules += name+".cpp:";
+		for (V3StringList::iterator it = groupFiles[g].begin(); it != groupFiles[g].end(); ++it) {
+		    groupRules += " "+*it;
+		}
+		groupRules += "\n";
+	    }
+	}
+	of.puts("VM_GROUPS += \\\n");
+	of.puts(groupList);
+	of.puts("\n");
+	of.puts(groupRules);
+    }
+    struct GroupSizeCmp {
+	bool operator() (const pair<off_t,string>& lhs, const pair<off_t,string>& rhs) const {
+	    return lhs.first > rhs.first;
+	}
+    };
+
     void emitOverallMake() {
 	// Generate the makefile
 	V3OutMkFile of (v3Global.opt.makeDir()+"/"+ v3Global.opt.prefix() + ".mk");
@@ -211,6 +279,16 @@ public:
 	    of.puts(v3Global.opt.exeName()+": $(VK_USER_OBJS) $(VK_GLOBAL_OBJS) $(VM_PREFIX)__ALL.a\n");
 	    of.puts("\t$(LINK) $(LDFLAGS) $^ $(LOADLIBES) $(LDLIBS) -o $@ $(LIBS) $(SC_LIBS) 2>&1 | c++filt\n");
 	    of.puts("\n");
+
+	    of.puts("\n### Profile guided optimization rules... (from --exe)\n");
+	    of.puts("# Build instrumented, run VM_PGO_RUN to train, then rebuild optimized\n");
+	    of.puts("VM_PGO_RUN ?= ./"+v3Global.opt.exeName()+"\n");
+	    of.puts("pgo:\n");
+	    of.puts("\trm -rf $(VM_PGO_DIR)\n");
+	    of.puts("\t$(MAKE) -f "+v3Global.opt.prefix()+".mk pgo-gen\n");
+	    of.puts("\t$(VM_PGO_RUN)\n");
+	    of.puts("\t$(MAKE) -f "+v3Global.opt.prefix()+".mk pgo-use\n");
+	    of.puts("\n");
 	}
 
 	of.puts("\n");
@@ -37,8 +37,12 @@
 // Emit statements and math operators
 
 class EmitXmlFileVisitor : public AstNVisitor {
+    // TYPES
+    typedef map<string,string> TagMap;
     // MEMBERS
     V3OutFile*	m_ofp;
+    bool	m_compact;	// --xml-compact, write without indentation tracking
+    TagMap	m_tags;		// Tag for each node type name, as downcasing every node is slow
 
     // METHODS
     static int debug() {
@@ -49,8 +53,14 @@ class EmitXmlFileVisitor : public AstNVisitor {
 
     // Outfile methods
     V3OutFile*	ofp() const { return m_ofp; }
-    virtual void puts(const string& str) { ofp()->puts(str); }
-    virtual void putbs(const string& str) { ofp()->putbs(str); }
+    virtual void puts(const string& str) {
+	if (m_compact) ofp()->putsNoTracking(str);
+	else ofp()->puts(str);
+    }
+    virtual void putbs(const string& str) {
+	if (m_compact) ofp()->putsNoTracking(str);
+	else ofp()->putbs(str);
+    }
     virtual void putfs(AstNode*, const string& str) { putbs(str); }
     virtual void putqs(AstNode*, const string& str) { putbs(str); }
     virtual void putsNoTracking(const string& str) { ofp()->putsNoTracking(str); }
@@ -64,13 +74,18 @@ class EmitXmlFileVisitor : public AstNVisitor {
     }
 
     // XML methods
+    const string& typeTag(AstNode* nodep) {
+	string& tagr = m_tags[nodep->typeName()];
+	if (tagr=="") tagr = VString::downcase(nodep->typeName());
+	return tagr;
+    }
     void outputTag(AstNode* nodep, string tag) {
-	if (tag=="") tag = VString::downcase(nodep->typeName());
+	if (tag=="") tag = typeTag(nodep);
 	puts("<"+tag+" "+nodep->fileline()->xml());
 	if (nodep->name()!="") { puts(" name="); putsQuoted(nodep->prettyName()); }
     }
     void outputChildrenEnd(AstNode* nodep, string tag) {
-	if (tag=="") tag = VString::downcase(nodep->typeName());
+	if (tag=="") tag = typeTag(nodep);
 	if (nodep->op1p() || nodep->op2p() || nodep->op3p() || nodep->op4p()) {
 	    puts(">\n");
 	    nodep->iterateChildren(*this);
@@ -132,6 +147,7 @@ class EmitXmlFileVisitor : public AstNVisitor {
 public:
     EmitXmlFileVisitor(AstNode* nodep, V3OutFile* ofp) {
 	m_ofp = ofp;
+	m_compact = v3Global.opt.xmlCompact();
 	nodep->accept(*this);
     }
     virtual ~EmitXmlFileVisitor() {}
@@ -189,7 +205,8 @@ void V3EmitXml::emitxml() {
     {
 	stringstream sstr;
 	FileLine::fileNameNumMapDumpXml(sstr);
-	of.puts(sstr.str());
+	if (v3Global.opt.xmlCompact()) of.putsNoTracking(sstr.str());
+	else of.puts(sstr.str());
     }
     EmitXmlFileVisitor visitor (v3Global.rootp(), &of);
     of.puts("</verilator_xml>\n");
@@ -26,6 +26,10 @@
 //	    Note in this case that the widthMin is not correct for the MSW of
 //	    the vector.  This must be accounted for if doing later constant
 //	    propagation across signals.
+//	Wide operands wider than --expand-limit words are left whole, so they
+//	    are emitted as calls to the VL_*_W word loop functions.
+//	Concatenations of constant selects of one variable, in the same bit
+//	    order, become a parallel bit extract (VL_PEXT).
 //
 //*************************************************************************
 
@@ -38,8 +42,11 @@
 
 #include "V3Global.h"
 #include "V3Expand.h"
+#include "V3Stats.h"
 #include "V3Ast.h"
 
+#define EXPAND_MIN_GATHER 3	// Min # of selects to be worth a bit extract
+
 //######################################################################
 // Expand state, as a visitor of each AstNode
 
@@ -51,6 +58,8 @@ private:
 
     // STATE
     AstNode*		m_stmtp;	// Current statement
+    V3Double0		m_statWordLoops;	// Statistic tracking
+    V3Double0		m_statGathers;	// Statistic tracking
 
     // METHODS
     static int debug() {
@@ -59,6 +68,17 @@ private:
 	return level;
     }
 
+    bool isWordLoop (AstNode* nodep) {
+	// Too wide to expand into per-word statements; leave for a VL_*_W call
+	if (v3Global.opt.expandLimit()
+	    && nodep->isWide() && nodep->widthWords() > v3Global.opt.expandLimit()) {
+	    UINFO(8,"    WordLoop "<<nodep<<endl);
+	    ++m_statWordLoops;
+	    return true;
+	}
+	return false;
+    }
+
     int longOrQuadWidth (AstNode* nodep) {
 	// Return 32 or 64...
 	return (nodep->width()+(VL_WORDSIZE-1)) & ~(VL_WORDSIZE-1);
@@ -650,6 +670,8 @@ private:
 
     virtual void visit(AstConcat* nodep) {
 	if (nodep->user1SetOnce()) return;  // Process once
+	// Before the children are expanded, see if it's all selects
+	if (!nodep->isWide() && expandGather(nodep)) return;
 	nodep->iterateChildren(*this);
 	if (nodep->isWide()) {
 	    // See under ASSIGN(WIDE)
@@ -670,6 +692,43 @@ private:
 	    replaceWithDelete(nodep,newp); VL_DANGLING(nodep);
 	}
     }
+    bool gatherSels(AstNode* nodep, vector<AstSel*>& selps) {
+	// Collect the selects of a concatenation, MSB first; false if not all selects
+	if (AstConcat* concatp = nodep->castConcat()) {
+	    return gatherSels(concatp->lhsp(), selps) && gatherSels(concatp->rhsp(), selps);
+	}
+	AstSel* selp = nodep->castSel();
+	if (!selp || !selp->lsbp()->castConst() || !selp->widthp()->castConst()) return false;
+	AstNodeVarRef* varrefp = selp->fromp()->castNodeVarRef();
+	if (!varrefp || varrefp->lvalue() || varrefp->isWide()) return false;
+	selps.push_back(selp);
+	return true;
+    }
+    bool expandGather(AstConcat* nodep) {
+	// {a[7], a[4:3], a[1]} -> PEXT(a, 'b10011010)
+	// The selects must be of one variable, in increasing bit order from the LSB
+	vector<AstSel*> selps;
+	if (!gatherSels(nodep, selps) || selps.size() < EXPAND_MIN_GATHER) return false;
+	AstNode* fromp = selps.back()->fromp();
+	V3Number mask (nodep->fileline(), longOrQuadWidth(fromp));
+	mask.setZero();
+	int nextLsb = 0;
+	for (vector<AstSel*>::reverse_iterator it = selps.rbegin(); it != selps.rend(); ++it) {
+	    AstSel* selp = *it;
+	    if (!selp->fromp()->sameTree(fromp)) return false;
+	    int lsb = selp->lsbConst();
+	    if (lsb < nextLsb || lsb + (int)selp->widthConst() > fromp->width()) return false;
+	    for (int bit=lsb; bit<lsb+(int)selp->widthConst(); ++bit) mask.setBit(bit, 1);
+	    nextLsb = lsb + selp->widthConst();
+	}
+	UINFO(8,"    GATHER "<<nodep<<endl);
+	++m_statGathers;
+	AstNode* newp = new AstPext (nodep->fileline(), fromp->cloneTree(false),
+				     new AstConst (nodep->fileline(), mask), nodep->width());
+	newp->dtypeFrom(nodep);
+	replaceWithDelete(nodep,newp); VL_DANGLING(nodep);
+	return true;
+    }
     bool expandWide (AstNodeAssign* nodep, AstConcat* rhsp) {
 	UINFO(8,"    Wordize ASSIGN(CONCAT) "<<nodep<<endl);
 	// Lhs or Rhs may be word, long, or quad.
@@ -767,7 +826,7 @@ private:
     void visitEqNeq(AstNodeBiop* nodep) {
 	if (nodep->user1SetOnce()) return;  // Process once
 	nodep->iterateChildren(*this);
-	if (nodep->lhsp()->isWide()) {
+	if (nodep->lhsp()->isWide() && !isWordLoop(nodep->lhsp())) {
 	    UINFO(8,"    Wordize EQ/NEQ "<<nodep<<endl);
 	    // -> (0=={or{for each_word{WORDSEL(lhs,#)^WORDSEL(rhs,#)}}}
 	    AstNode* newp = NULL;
@@ -793,7 +852,9 @@ private:
     virtual void visit(AstRedOr* nodep) {
 	if (nodep->user1SetOnce()) return;  // Process once
 	nodep->iterateChildren(*this);
-	if (nodep->lhsp()->isWide()) {
+	if (isWordLoop(nodep->lhsp())) {
+	    // Leave whole, the emitted VL_*_W call loops over the words
+	} else if (nodep->lhsp()->isWide()) {
 	    UINFO(8,"    Wordize REDOR "<<nodep<<endl);
 	    // -> (0!={or{for each_word{WORDSEL(lhs,#)}}}
 	    AstNode* newp = NULL;
@@ -817,7 +878,9 @@ private:
     virtual void visit(AstRedAnd* nodep) {
 	if (nodep->user1SetOnce()) return;  // Process once
 	nodep->iterateChildren(*this);
-	if (nodep->lhsp()->isWide()) {
+	if (isWordLoop(nodep->lhsp())) {
+	    // Leave whole, the emitted VL_*_W call loops over the words
+	} else if (nodep->lhsp()->isWide()) {
 	    UINFO(8,"    Wordize REDAND "<<nodep<<endl);
 	    // -> (0!={and{for each_word{WORDSEL(lhs,#)}}}
 	    AstNode* newp = NULL;
@@ -846,7 +909,7 @@ private:
     virtual void visit(AstRedXor* nodep) {
 	if (nodep->user1SetOnce()) return;  // Process once
 	nodep->iterateChildren(*this);
-	if (nodep->lhsp()->isWide()) {
+	if (nodep->lhsp()->isWide() && !isWordLoop(nodep->lhsp())) {
 	    UINFO(8,"    Wordize REDXOR "<<nodep<<endl);
 	    // -> (0!={redxor{for each_word{XOR(WORDSEL(lhs,#))}}}
 	    AstNode* newp = NULL;
@@ -877,7 +940,9 @@ private:
 				|| nodep->lhsp()->castArraySel()))
 	    && !AstVar::scVarRecurse(nodep->lhsp())	// Need special function for SC
 	    && !AstVar::scVarRecurse(nodep->rhsp())) {
-	    if (AstConst* rhsp = nodep->rhsp()->castConst()) {
+	    if (isWordLoop(nodep)) {
+		// Leave whole, the emitted VL_*_W call loops over the words
+	    } else if (AstConst* rhsp = nodep->rhsp()->castConst()) {
 		did = expandWide(nodep,rhsp);
 	    } else if (AstVarRef* rhsp = nodep->rhsp()->castVarRef()) {
 		did = expandWide(nodep,rhsp);
@@ -925,7 +990,10 @@ public:
 	m_stmtp=NULL;
 	nodep->accept(*this);
     }
-    virtual ~ExpandVisitor() {}
+    virtual ~ExpandVisitor() {
+	V3Stats::addStat("Optimizations, Expand word loops", m_statWordLoops);
+	V3Stats::addStat("Optimizations, Expand bit gathers", m_statGathers);
+    }
 };
 
 //----------------------------------------------------------------------
@@ -21,6 +21,7 @@
 #include "config_build.h"
 #include "verilatedos.h"
 #include <cstdarg>
+#include <cstring>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -29,6 +30,8 @@
 #include <iomanip>
 #include <memory>
 #include <map>
+#include <deque>
+#include <algorithm>
 
 #if defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))
 # define INFILTER_PIPE  // Allow pipe filtering.  Needs fork()
@@ -36,6 +39,11 @@
 
 #ifdef INFILTER_PIPE
 # include <sys/wait.h>
+# define INFILTER_READAHEAD  // Allow reading files ahead of parsing.  Needs pthreads
+# include <pthread.h>
+# define INFILTER_MMAP  // Allow memory mapping large files
+# include <sys/mman.h>
+# define FILE_WRITEBEHIND  // Allow writing files on a background thread.  Needs pthreads
 #endif
 
 #include "V3Global.h"
@@ -43,11 +51,15 @@
 #include "V3Os.h"
 #include "V3PreShell.h"
 #include "V3Ast.h"
+#include "V3Stats.h"
 
 // If change this code, run a test with the below size set very small
 //#define INFILTER_IPC_BUFSIZ 16
 #define INFILTER_IPC_BUFSIZ 64*1024  // For debug, try this as a small number
 #define INFILTER_CACHE_MAX  64*1024  // Maximum bytes to cache if same file read twice
+#define INFILTER_AHEAD_MAX  64*1024*1024  // Maximum bytes read ahead and not yet parsed
+#define INFILTER_MMAP_MIN   INFILTER_CACHE_MAX  // Minimum bytes to memory map instead of read
+#define FILE_WRITEBEHIND_MAX 256*1024*1024  // Maximum bytes queued and not yet written
 
 //######################################################################
 // V3File Internal state
@@ -59,6 +71,7 @@ class V3FileDependImp {
 	bool		m_target;	// True if write, else read
 	string		m_filename;	// Filename
 	struct stat	m_stat;		// Stat information
+	string		m_hash;		// Hash of contents, sources only
     public:
 	DependFile(const string& filename, bool target)
 	    : m_target(target), m_filename(filename) {
@@ -67,6 +80,8 @@ class V3FileDependImp {
 	~DependFile() {}
 	const string& filename() const { return m_filename; }
 	bool target() const { return m_target; }
+	const string& hash() const { return m_hash; }
+	void loadHash() { m_hash = contentsHash(filename()); }
 	off_t size() const { return m_stat.st_size; }
 	ino_t ino() const { return m_stat.st_ino; }
 	time_t mtime() const { return m_stat.st_mtime; }
@@ -84,9 +99,27 @@ class V3FileDependImp {
 	bool operator<(const DependFile& rhs) const { return filename()<rhs.filename(); }
     };
 
+    class HashedFile {
+	// Hash of a file's contents, valid while its stat is unchanged
+	off_t		m_size;
+	ino_t		m_ino;
+	time_t		m_mtime;
+	string		m_hash;
+    public:
+	HashedFile(off_t size, ino_t ino, time_t mtime, const string& hash)
+	    : m_size(size), m_ino(ino), m_mtime(mtime), m_hash(hash) {}
+	~HashedFile() {}
+	const string& hash() const { return m_hash; }
+	bool sameStat(const struct stat& st) const {
+	    return st.st_size == m_size && st.st_ino == m_ino && st.st_mtime == m_mtime;
+	}
+    };
+    typedef map<string,HashedFile> HashedMap;
+
     // MEMBERS
     set<string>		m_filenameSet;		// Files generated (elim duplicates)
     set<DependFile>	m_filenameList;		// Files sourced/generated
+    static HashedMap	s_hashedMap;		// Hashes already known, by filename
 
     static string stripQuotes(const string& in) {
 	string pretty = in;
@@ -102,6 +135,7 @@ public:
 	    m_filenameSet.insert(filename);
 	    DependFile df (filename, false);
 	    df.loadStats();  // Get size now, in case changes during the run
+	    df.loadHash();
 	    m_filenameList.insert(df);
 	}
     }
@@ -114,13 +148,86 @@ public:
     void writeDepend(const string& filename);
     void writeTimes(const string& filename, const string& cmdline);
     bool checkTimes(const string& filename, const string& cmdline);
+    void loadHashes(const string& filename);
+    static string contentsHash(const string& filename);
 };
 
+V3FileDependImp::HashedMap V3FileDependImp::s_hashedMap;
 V3FileDependImp  dependImp;	// Depend implementation class
 
 //######################################################################
 // V3FileDependImp
 
+static inline void fnvHash(vluint64_t& hash, const char* datap, size_t len) {
+    // 64-bit FNV-1a
+    for (size_t i=0; i<len; ++i) {
+	hash ^= (unsigned char)datap[i];
+	hash *= VL_ULL(0x100000001b3);
+    }
+}
+static string fnvString(vluint64_t hash) {
+    ostringstream os;  os<<hex<<setfill('0')<<setw(16)<<hash;
+    return os.str();
+}
+
+string V3FileDependImp::contentsHash(const string& filename) {
+    // Hash of the file's contents, so sources that were rewritten
+    // or touched without changing don't force a rerun.  "-" if unreadable.
+    // Files are only read if their stat differs from when last hashed,
+    // by this run or, see loadHashes, by the previous run.
+    struct stat st;
+    if (stat(filename.c_str(), &st) != 0) return "-";
+    HashedMap::iterator it = s_hashedMap.find(filename);
+    if (it != s_hashedMap.end()) {
+	if (it->second.sameStat(st)) return it->second.hash();
+	s_hashedMap.erase(it);
+    }
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return "-";
+    vluint64_t hash = VL_ULL(0xcbf29ce484222325);
+    char buf[INFILTER_IPC_BUFSIZ];
+    while (1) {
+	ssize_t got = read(fd, buf, sizeof(buf));
+	if (got < 0 && (errno == EINTR || errno == EAGAIN)) continue;
+	if (got <= 0) break;
+	fnvHash(hash, buf, got);
+    }
+    close(fd);
+    string hashStr = fnvString(hash);
+    s_hashedMap.insert(make_pair(filename, HashedFile(st.st_size, st.st_ino, st.st_mtime, hashStr)));
+    return hashStr;
+}
+
+void V3FileDependImp::loadHashes(const string& filename) {
+    // Seed contentsHash with the source hashes in a writeTimes file, so
+    // an edit-compile loop only rereads the sources that were edited.
+    // A source modified in the same second the file was written might have
+    // changed again without changing its mtime, so it is not trusted.
+    struct stat datStat;
+    if (stat(filename.c_str(), &datStat) != 0) return;
+    const VL_UNIQUE_PTR<ifstream> ifp (V3File::new_ifstream_nodepend(filename));
+    if (ifp->fail()) return;
+    {
+	string ignore;  getline(*ifp, ignore);  // Description
+	getline(*ifp, ignore);  // Command line
+    }
+    while (!ifp->eof()) {
+	char   chkDir;   *ifp>>chkDir;
+	off_t  chkSize;  *ifp>>chkSize;
+	ino_t  chkIno;   *ifp>>chkIno;
+	if (ifp->eof()) break;
+	time_t chkMtime; *ifp>>chkMtime;
+	string chkHash;  *ifp>>chkHash;
+	char   quote;    *ifp>>quote;
+	string chkFilename; getline(*ifp, chkFilename, '"');
+	if (ifp->fail()) break;
+	if (chkDir == 'S' && chkHash != "-" && chkMtime < datStat.st_mtime
+	    && s_hashedMap.find(chkFilename) == s_hashedMap.end()) {
+	    s_hashedMap.insert(make_pair(chkFilename, HashedFile(chkSize, chkIno, chkMtime, chkHash)));
+	}
+    }
+}
+
 inline void V3FileDependImp::writeDepend(const string& filename) {
     const VL_UNIQUE_PTR<ofstream> ofp (V3File::new_ofstream(filename));
     if (ofp->fail()) v3fatalSrc("Can't write "<<filename);
@@ -179,12 +286,14 @@ inline void V3FileDependImp::writeTimes(const string& filename, const string& cm
 	*ofp<<" "<<setw(8)<<showSize;
 	*ofp<<" "<<setw(8)<<showIno;
 	*ofp<<" "<<setw(11)<<iter->mtime();
+	*ofp<<" "<<(iter->hash().empty() ? "-" : iter->hash());
 	*ofp<<" \""<<iter->filename()<<"\"";
 	*ofp<<endl;
     }
 }
 
 inline bool V3FileDependImp::checkTimes(const string& filename, const string& cmdlineIn) {
+    loadHashes(filename);  // Even if the check fails, most sources are likely unchanged
     const VL_UNIQUE_PTR<ifstream> ifp (V3File::new_ifstream_nodepend(filename));
     if (ifp->fail()) {
 	UINFO(2,"   --check-times failed: no input "<<filename<<endl);
@@ -210,6 +319,7 @@ inline bool V3FileDependImp::checkTimes(const string& filename, const string& cm
 	ino_t  chkIno;   *ifp>>chkIno;
 	if (ifp->eof()) break;  // Needed to read final whitespace before found eof
 	time_t chkMtime; *ifp>>chkMtime;
+	string chkHash;  *ifp>>chkHash;
 	char   quote;    *ifp>>quote;
 	string chkFilename; getline(*ifp, chkFilename, '"');
 	//UINFO(9," got d="<<chkDir<<" s="<<chkSize<<" mt="<<chkMtime<<" fn = "<<chkFilename<<endl);
@@ -230,7 +340,9 @@ inline bool V3FileDependImp::checkTimes(const string& filename, const string& cm
 	    if (!(chkStat.st_size >= chkSize
 		  && chkStat.st_ino == chkIno
 		  && chkStat.st_mtime >= chkMtime
-		  && chkStat.st_mtime <= (chkMtime + 20))) {
+		  && chkStat.st_mtime <= (chkMtime + 20))
+		&& !(chkDir == 'S' && chkHash != "-"
+		     && chkHash == contentsHash(chkFilename))) {
 		UINFO(2,"   --check-times failed: out-of-date "<<chkFilename
 		      <<"; "<<chkStat.st_size<<"=?"<<chkSize
 		      <<" "<<chkStat.st_mtime<<"=?"<<chkMtime<<endl);
@@ -241,9 +353,142 @@ inline bool V3FileDependImp::checkTimes(const string& filename, const string& cm
     return true;
 }
 
+//######################################################################
+// V3FileWriteBehindImp
+
+class V3FileWriteBehindImp {
+    // Files queued by V3File::writeBehind, written in order by a background
+    // thread so writing large debug files overlaps later work
+    typedef deque<pair<string,string> > FileQueue;
+#ifdef FILE_WRITEBEHIND
+    // All under m_mutex
+    pthread_t		m_thread;	// Thread writing files
+    pthread_mutex_t	m_mutex;	// Lock on below
+    pthread_cond_t	m_cond;		// Signaled when a file is queued or written
+    bool		m_running;	// Thread was started
+    bool		m_busy;		// Thread is writing a file
+    FileQueue		m_queue;	// Files to write, filename and contents
+    size_t		m_bytes;	// Total bytes in m_queue
+    string		m_failed;	// Name of a file that couldn't be written
+#endif
+    static int debug() {
+	static int level = -1;
+	if (VL_UNLIKELY(level < 0)) level = v3Global.opt.debugSrcLevel(__FILE__);
+	return level;
+    }
+    static bool writeFile(const string& filename, const string& contents) {
+	FILE* fp = fopen(filename.c_str(), "wb");
+	if (!fp) return false;
+	bool ok = (fwrite(contents.data(), 1, contents.length(), fp) == contents.length());
+	if (fclose(fp) != 0) ok = false;
+	return ok;
+    }
+#ifdef FILE_WRITEBEHIND
+    static void* writeThread(void* thisp) {
+	static_cast<V3FileWriteBehindImp*>(thisp)->writeLoop();
+	return NULL;
+    }
+    void writeLoop() {
+	// Runs on the write thread; must not use UINFO, v3error, etc.
+	pthread_mutex_lock(&m_mutex);
+	while (true) {
+	    if (m_queue.empty()) {
+		if (!m_running) break;
+		pthread_cond_wait(&m_cond, &m_mutex);
+		continue;
+	    }
+	    string filename; string contents;
+	    filename.swap(m_queue.front().first);
+	    contents.swap(m_queue.front().second);
+	    m_queue.pop_front();
+	    m_busy = true;
+	    pthread_mutex_unlock(&m_mutex);
+
+	    bool ok = writeFile(filename, contents);
+
+	    pthread_mutex_lock(&m_mutex);
+	    if (!ok && m_failed == "") m_failed = filename;
+	    m_bytes -= contents.length();
+	    m_busy = false;
+	    pthread_cond_broadcast(&m_cond);
+	}
+	pthread_mutex_unlock(&m_mutex);
+    }
+#endif
+public:
+    void write(const string& filename, string& contents) {
+#ifdef FILE_WRITEBEHIND
+	pthread_mutex_lock(&m_mutex);
+	if (!m_running) {
+	    if (pthread_create(&m_thread, NULL, &V3FileWriteBehindImp::writeThread, this) == 0) {
+		m_running = true;
+	    }
+	}
+	if (m_running) {
+	    // Limit memory held by files not yet written
+	    while (m_bytes > FILE_WRITEBEHIND_MAX) pthread_cond_wait(&m_cond, &m_mutex);
+	    UINFO(9,"writeBehind queued "<<filename<<endl);
+	    m_bytes += contents.length();
+	    m_queue.push_back(make_pair(filename, string()));
+	    m_queue.back().second.swap(contents);
+	    pthread_cond_broadcast(&m_cond);
+	    pthread_mutex_unlock(&m_mutex);
+	    return;
+	}
+	pthread_mutex_unlock(&m_mutex);
+#endif
+	if (!writeFile(filename, contents)) v3fatal("Can't write "<<filename);
+	contents.clear();
+    }
+    void flush() {
+#ifdef FILE_WRITEBEHIND
+	pthread_mutex_lock(&m_mutex);
+	while (!m_queue.empty() || m_busy) pthread_cond_wait(&m_cond, &m_mutex);
+	string failed = m_failed;
+	m_failed = "";
+	pthread_mutex_unlock(&m_mutex);
+	if (failed != "") v3fatal("Can't write "<<failed);
+#endif
+    }
+    // CONSTRUCTORS
+    V3FileWriteBehindImp() {
+#ifdef FILE_WRITEBEHIND
+	m_running = false;
+	m_busy = false;
+	m_bytes = 0;
+	pthread_mutex_init(&m_mutex, NULL);
+	pthread_cond_init(&m_cond, NULL);
+#endif
+    }
+    ~V3FileWriteBehindImp() {
+#ifdef FILE_WRITEBEHIND
+	// Finish writing anything queued, even when exiting on an error
+	pthread_mutex_lock(&m_mutex);
+	bool running = m_running;
+	m_running = false;
+	pthread_cond_broadcast(&m_cond);
+	pthread_mutex_unlock(&m_mutex);
+	if (running) pthread_join(m_thread, NULL);
+	pthread_cond_destroy(&m_cond);
+	pthread_mutex_destroy(&m_mutex);
+#endif
+    }
+};
+
+V3FileWriteBehindImp writeBehindImp;	// Write behind implementation class
+
 //######################################################################
 // V3File
 
+void V3File::writeBehind(const string& filename, string& contents) {
+    createMakeDir();
+    addTgtDepend(filename);
+    writeBehindImp.write(filename, contents);
+}
+void V3File::writeBehindFlush() {
+    writeBehindImp.flush();
+}
+
 void V3File::addSrcDepend(const string& filename) {
     dependImp.addSrcDepend(filename);
 }
@@ -260,6 +505,15 @@ bool V3File::checkTimes(const string& filename, const string& cmdline) {
     return dependImp.checkTimes(filename, cmdline);
 }
 
+string V3File::contentsHash(const string& filename) {
+    return V3FileDependImp::contentsHash(filename);
+}
+string V3File::stringHash(const string& str) {
+    vluint64_t hash = VL_ULL(0xcbf29ce484222325);
+    fnvHash(hash, str.data(), str.length());
+    return fnvString(hash);
+}
+
 void V3File::createMakeDir() {
     static bool created = false;
     if (!created) {
@@ -276,6 +530,18 @@ class V3InFilterImp {
     typedef V3InFilter::StrList StrList;
 
     FileContentsMap	m_contentsMap;	// Cache of file contents
+#ifdef INFILTER_READAHEAD
+    // Read ahead state, all under m_aheadMutex
+    pthread_t		m_aheadThread;	// Thread reading files before they are needed
+    pthread_mutex_t	m_aheadMutex;	// Lock on below
+    pthread_cond_t	m_aheadCond;	// Signaled when a file is read, or read space is freed
+    bool		m_aheadRunning;	// Thread was started
+    bool		m_aheadStop;	// Thread should exit
+    StrList		m_aheadNames;	// Files waiting to be read ahead
+    string		m_aheadCurrent;	// File being read ahead now
+    FileContentsMap	m_aheadContents;  // Files read ahead, not yet requested
+    size_t		m_aheadBytes;	// Total bytes in m_aheadContents
+#endif
     bool		m_readEof;	// Received EOF on read
 #ifdef INFILTER_PIPE
     pid_t		m_pid;		// fork() process id
@@ -300,6 +566,15 @@ private:
 	else return readContentsFile(filename,outl);
     }
     bool readContentsFile(const string& filename, StrList& outl) {
+#ifdef INFILTER_READAHEAD
+	{
+	    string contents;
+	    if (readAheadFetch(filename, contents)) {
+		outl.push_back(contents);
+		return true;
+	    }
+	}
+#endif
 	int fd = open (filename.c_str(), O_RDONLY);
 	if (fd<0) return false;
 	m_readEof = false;
@@ -327,6 +602,123 @@ private:
 #endif
     }
 
+#ifdef INFILTER_READAHEAD
+    // Read ahead.  Files given on the command line are read on a separate
+    // thread, so file system latency overlaps preprocessing and parsing.
+    // Preprocessing itself must stay in order, as defines carry across files.
+    static void* readAheadThread(void* thisp) {
+	static_cast<V3InFilterImp*>(thisp)->readAheadLoop();
+	return NULL;
+    }
+    void readAheadLoop() {
+	// Runs on the read ahead thread; must not use UINFO, v3error, etc.
+	pthread_mutex_lock(&m_aheadMutex);
+	while (!m_aheadStop && !m_aheadNames.empty()) {
+	    if (m_aheadBytes > INFILTER_AHEAD_MAX) {
+		pthread_cond_wait(&m_aheadCond, &m_aheadMutex);
+		continue;
+	    }
+	    m_aheadCurrent = m_aheadNames.front();
+	    m_aheadNames.pop_front();
+	    string filename = m_aheadCurrent;
+	    pthread_mutex_unlock(&m_aheadMutex);
+
+	    string contents;
+	    bool ok = false;
+	    int fd = open (filename.c_str(), O_RDONLY);
+#ifdef INFILTER_MMAP
+	    struct stat st;
+	    if (fd >= 0 && fstat(fd, &st) == 0 && st.st_size >= INFILTER_MMAP_MIN) {
+		// Will be memory mapped when parsed instead
+		close(fd); fd = -1;
+	    }
+#endif
+	    if (fd >= 0) {
+		char buf[INFILTER_IPC_BUFSIZ];
+		ok = true;
+		while (1) {
+		    ssize_t got = read (fd, buf, sizeof(buf));
+		    if (got > 0) contents.append(buf, got);
+		    else if (got < 0 && errno == EINTR) continue;
+		    else { ok = (got == 0); break; }
+		}
+		close(fd);
+	    }
+
+	    pthread_mutex_lock(&m_aheadMutex);
+	    if (ok) {  // Else main thread will report the error when it reads it
+		m_aheadBytes += contents.length();
+		m_aheadContents.insert(make_pair(filename, contents));
+	    }
+	    m_aheadCurrent = "";
+	    pthread_cond_broadcast(&m_aheadCond);
+	}
+	pthread_mutex_unlock(&m_aheadMutex);
+    }
+    bool readAheadFetch(const string& filename, string& out) {
+	// Return contents if read ahead, waiting if it's still queued
+	if (!m_aheadRunning) return false;
+	bool found = false;
+	pthread_mutex_lock(&m_aheadMutex);
+	while (true) {
+	    FileContentsMap::iterator it = m_aheadContents.find(filename);
+	    if (it != m_aheadContents.end()) {
+		UINFO(9,"readAheadFetch got "<<filename<<endl);
+		m_aheadBytes -= it->second.length();
+		out.swap(it->second);
+		m_aheadContents.erase(it);
+		pthread_cond_broadcast(&m_aheadCond);
+		found = true;
+		break;
+	    }
+	    if (m_aheadCurrent != filename) {
+		// Not read yet; read it here rather than wait, as the read
+		// ahead may be stalled on INFILTER_AHEAD_MAX
+		StrList::iterator nit = find(m_aheadNames.begin(), m_aheadNames.end(), filename);
+		if (nit != m_aheadNames.end()) m_aheadNames.erase(nit);
+		break;
+	    }
+	    pthread_cond_wait(&m_aheadCond, &m_aheadMutex);
+	}
+	pthread_mutex_unlock(&m_aheadMutex);
+	return found;
+    }
+    void readAheadStop() {
+	if (!m_aheadRunning) return;
+	pthread_mutex_lock(&m_aheadMutex);
+	m_aheadStop = true;
+	m_aheadNames.clear();
+	pthread_cond_broadcast(&m_aheadCond);
+	pthread_mutex_unlock(&m_aheadMutex);
+	pthread_join(m_aheadThread, NULL);
+	m_aheadRunning = false;
+    }
+#endif
+
+public:
+    void readAhead(const string& filename) {
+#ifdef INFILTER_READAHEAD
+	if (m_pid) return;  // Filter must see requests in order
+	if (m_aheadRunning) return;  // Only queued before readAheadStart
+	m_aheadNames.push_back(filename);
+#else
+	if (filename=="") {}  // Prevent unused
+#endif
+    }
+    void readAheadStart() {
+#ifdef INFILTER_READAHEAD
+	if (m_aheadRunning || m_aheadNames.empty()) return;
+	UINFO(3,"Reading ahead "<<m_aheadNames.size()<<" files"<<endl);
+	m_aheadStop = false;
+	if (pthread_create(&m_aheadThread, NULL, &V3InFilterImp::readAheadThread, this) == 0) {
+	    m_aheadRunning = true;
+	} else {
+	    m_aheadNames.clear();  // Just read them as needed
+	}
+#endif
+    }
+
+private:
     // cppcheck-suppress functionConst
     void checkFilter(bool hang) {
 #ifdef INFILTER_PIPE
@@ -508,6 +900,40 @@ protected:
 	}
 	return true;
     }
+    V3InFilterView* readView(const string& filename) {
+	V3InFilterView* viewp = new V3InFilterView;
+#ifdef INFILTER_MMAP
+	if (!m_pid && m_contentsMap.find(filename) == m_contentsMap.end()) {
+# ifdef INFILTER_READAHEAD
+	    if (readAheadFetch(filename, viewp->m_contents)) {
+		viewp->m_datap = viewp->m_contents.data();
+		viewp->m_size = viewp->m_contents.length();
+		return viewp;
+	    }
+# endif
+	    int fd = open (filename.c_str(), O_RDONLY);
+	    if (fd < 0) { delete viewp; return NULL; }
+	    struct stat st;
+	    if (fstat(fd, &st) == 0 && st.st_size >= INFILTER_MMAP_MIN) {
+		void* mapp = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (mapp != MAP_FAILED) {
+		    UINFO(9,"readView mapped "<<filename<<endl);
+		    close(fd);
+		    viewp->m_mapp = mapp;
+		    viewp->m_datap = static_cast<const char*>(mapp);
+		    viewp->m_size = st.st_size;
+		    return viewp;
+		}
+	    }
+	    close(fd);
+	    // Else read it normally below
+	}
+#endif
+	StrList outl;
+	if (!readWholefile(filename, outl)) { delete viewp; return NULL; }
+	viewp->contents(listString(outl));
+	return viewp;
+    }
     size_t listSize(StrList& sl) {
 	size_t out = 0;
 	for (StrList::iterator it=sl.begin(); it!=sl.end(); ++it) {
@@ -530,9 +956,23 @@ protected:
 	m_pidStatus = 0;
 	m_writeFd = 0;
 	m_readFd = 0;
+#ifdef INFILTER_READAHEAD
+	pthread_mutex_init(&m_aheadMutex, NULL);
+	pthread_cond_init(&m_aheadCond, NULL);
+	m_aheadRunning = false;
+	m_aheadStop = false;
+	m_aheadBytes = 0;
+#endif
 	start(command);
     }
-    ~V3InFilterImp() { stop(); }
+    ~V3InFilterImp() {
+#ifdef INFILTER_READAHEAD
+	readAheadStop();
+	pthread_cond_destroy(&m_aheadCond);
+	pthread_mutex_destroy(&m_aheadMutex);
+#endif
+	stop();
+    }
 };
 
 //######################################################################
@@ -546,6 +986,23 @@ bool V3InFilter::readWholefile(const string& filename, V3InFilter::StrList& outl
     if (!m_impp) v3fatalSrc("readWholefile on invalid filter");
     return m_impp->readWholefile(filename, outl);
 }
+V3InFilterView* V3InFilter::readView(const string& filename) {
+    if (!m_impp) v3fatalSrc("readView on invalid filter");
+    return m_impp->readView(filename);
+}
+V3InFilterView::~V3InFilterView() {
+#ifdef INFILTER_MMAP
+    if (m_mapp) munmap(m_mapp, m_size);
+#endif
+}
+void V3InFilter::readAhead(const string& filename) {
+    if (!m_impp) v3fatalSrc("readAhead on invalid filter");
+    m_impp->readAhead(filename);
+}
+void V3InFilter::readAheadStart() {
+    if (!m_impp) v3fatalSrc("readAheadStart on invalid filter");
+    m_impp->readAheadStart();
+}
 
 //######################################################################
 // V3OutFormatter: A class for printing to a file, with automatic indentation of C++ code.
@@ -650,6 +1107,16 @@ int V3OutFormatter::endLevels (const char *strg) {
     return (levels);
 }
 
+static inline bool outPlainChar(char chr) {
+    // Characters that, outside Verilog, never change indentation or line
+    switch (chr) {
+    case '\n': case '\t': case '{': case '}': case '(': case ')': case '<': case '>':
+	return false;
+    default:
+	return true;
+    }
+}
+
 void V3OutFormatter::puts (const char *strg) {
     if (m_prependIndent) {
 	putsNoTracking(indentStr(endLevels(strg)));
@@ -657,6 +1124,17 @@ void V3OutFormatter::puts (const char *strg) {
     }
     bool wordstart = true;
     for (const char* cp=strg; *cp; cp++) {
+	if (m_lang != LA_VERILOG && outPlainChar(*cp)) {
+	    // Output a run of plain characters in bulk, tracking only the column
+	    // as putcNoTracking would
+	    const char* startp = cp;
+	    for (; *cp && outPlainChar(*cp); cp++) {
+		if (*cp != ' ' && *cp != '|' && *cp != '&') m_nobreak = false;
+	    }
+	    m_column += cp - startp;
+	    putsOutput(startp, cp - startp);
+	    if (!*cp) break;
+	}
 	putcNoTracking (*cp);
 	switch (*cp) {
 	case '\n':
@@ -812,15 +1290,63 @@ void V3OutFormatter::printf (const char *fmt...) {
 // V3OutFormatter: A class for printing to a file, with automatic indentation of C++ code.
 
 V3OutFile::V3OutFile(const string& filename, V3OutFormatter::Language lang)
-    : V3OutFormatter(filename, lang) {
-    if ((m_fp = V3File::new_fopen_w(filename.c_str())) == NULL) {
+    : V3OutFormatter(filename, lang), m_filename(filename) {
+    m_fp = NULL;
+    m_oldFp = NULL;
+    m_matchedBytes = 0;
+    if (v3Global.opt.outputKeepUnchanged()) {
+	// Compare against the existing file, and only rewrite it once output differs,
+	// so make doesn't rebuild from files that didn't change
+	V3File::addTgtDepend(filename);
+	m_oldFp = fopen(filename.c_str(), "rb");
+    }
+    if (!m_oldFp && (m_fp = V3File::new_fopen_w(filename.c_str())) == NULL) {
 	v3fatal("Cannot write "<<filename);
     }
+    m_bufferp = new char [WRITE_BUFFER_SIZE];
+    m_usedBytes = 0;
 }
 
 V3OutFile::~V3OutFile() {
+    writeBlock();
+    if (m_oldFp) {
+	if (fgetc(m_oldFp) != EOF) {  // Existing file is longer
+	    diverge();
+	} else {
+	    fclose(m_oldFp);  m_oldFp = NULL;
+	    V3Stats::addStatSum("Output files, unchanged", 1);
+	}
+    }
     if (m_fp) fclose(m_fp);
     m_fp = NULL;
+    delete[] m_bufferp; m_bufferp = NULL;
+}
+
+void V3OutFile::writeBlock() {
+    if (m_usedBytes && m_oldFp) {
+	char oldbuf[WRITE_BUFFER_SIZE];
+	if (fread(oldbuf, 1, m_usedBytes, m_oldFp) == m_usedBytes
+	    && 0==memcmp(oldbuf, m_bufferp, m_usedBytes)) {
+	    m_matchedBytes += m_usedBytes;
+	    m_usedBytes = 0;
+	    return;
+	}
+	diverge();
+    }
+    if (m_usedBytes && m_fp) fwrite(m_bufferp, 1, m_usedBytes, m_fp);
+    m_usedBytes = 0;
+}
+
+void V3OutFile::diverge() {
+    // Output differs from the existing file; rewrite it, starting with what matched
+    string prefix (m_matchedBytes, '\0');
+    rewind(m_oldFp);
+    bool ok = (!m_matchedBytes || fread(&prefix[0], 1, m_matchedBytes, m_oldFp) == m_matchedBytes);
+    fclose(m_oldFp);  m_oldFp = NULL;
+    if (!ok || (m_fp = fopen(m_filename.c_str(), "w")) == NULL) {
+	v3fatal("Cannot write "<<m_filename);
+    }
+    if (m_matchedBytes) fwrite(prefix.data(), 1, m_matchedBytes, m_fp);
 }
 
 void V3OutFile::putsForceIncs() {
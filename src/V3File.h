@@ -24,6 +24,7 @@
 #include "verilatedos.h"
 #include "V3Error.h"
 #include <cstdio>
+#include <cstring>
 #include <stack>
 #include <set>
 #include <list>
@@ -59,6 +60,10 @@ public:
 	return fopen(filename.c_str(),"w");
     }
 
+    // Write contents on a background thread, taking them by swap; errors are fatal at flush
+    static void writeBehind(const string& filename, string& contents);
+    static void writeBehindFlush();	// Wait until all writeBehind files are written
+
     // Dependencies
     static void addSrcDepend(const string& filename);
     static void addTgtDepend(const string& filename);
@@ -66,6 +71,10 @@ public:
     static void writeTimes(const string& filename, const string& cmdline);
     static bool checkTimes(const string& filename, const string& cmdline);
 
+    // Hashes, as hex strings; contentsHash returns "-" if the file can't be read
+    static string contentsHash(const string& filename);
+    static string stringHash(const string& str);
+
     // Directory utilities
     static void createMakeDir();
 };
@@ -75,6 +84,26 @@ public:
 
 class V3InFilterImp;
 
+class V3InFilterView {
+    // Read-only contents of an input file, memory mapped when possible,
+    // so large files are handed to the preprocessor without copies.
+    friend class V3InFilterImp;
+    const char*	m_datap;	// Contents
+    size_t	m_size;		// Bytes of contents
+    void*	m_mapp;		// Memory mapped region, or NULL if in m_contents
+    string	m_contents;	// Contents when not memory mapped
+    V3InFilterView(const V3InFilterView&); ///< N/A, no copy constructor
+    V3InFilterView() : m_datap(NULL), m_size(0), m_mapp(NULL) {}
+    void contents(const string& str) {
+	m_contents = str;
+	m_datap = m_contents.data(); m_size = m_contents.length();
+    }
+public:
+    const char* data() const { return m_datap; }
+    size_t size() const { return m_size; }
+    ~V3InFilterView();
+};
+
 class V3InFilter {
     V3InFilterImp* m_impp;
     V3InFilter(const V3InFilter&); ///< N/A, no copy constructor
@@ -85,6 +114,12 @@ public:
     // METHODS
     // Read file contents and return it.  Return true on success.
     bool readWholefile(const string& filename, StrList& outl);
+    // Read file contents into a new view, caller must delete.  Return NULL on failure.
+    V3InFilterView* readView(const string& filename);
+    // Queue a file that will be read soon, to read it in the background
+    void readAhead(const string& filename);
+    // Start reading the queued files
+    void readAheadStart();
 
     // CONSTRUCTORS
     explicit V3InFilter(const string& command);
@@ -131,6 +166,8 @@ public:
     virtual ~V3OutFormatter() {}
     // ACCESSORS
     int column() const { return m_column; }
+    int lineno() const { return m_lineno; }	///< Line being written
+    const string& filename() const { return m_filename; }
     int blockIndent() const { return m_blockIndent; }
     void blockIndent(int flag) { m_blockIndent=flag; }
     // METHODS
@@ -158,21 +195,46 @@ public:
 
     // CALLBACKS - MUST OVERRIDE
     virtual void putcOutput(char chr) = 0;
+    // CALLBACKS - MAY OVERRIDE for speed
+    virtual void putsOutput(const char* strg, size_t len) {
+	for (size_t i=0; i<len; ++i) putcOutput(strg[i]);
+    }
 };
 
 //============================================================================
 // V3OutFile: A class for printing to a file, with automatic indentation of C++ code.
 
 class V3OutFile : public V3OutFormatter {
+    // TYPES
+    enum MiscConsts {
+	WRITE_BUFFER_SIZE = 128*1024};	// Bytes buffered before writing
     // MEMBERS
+    string	m_filename;
     FILE*	m_fp;
+    FILE*	m_oldFp;	// With --output-keep-unchanged, existing file while output matches it
+    size_t	m_matchedBytes;	// Bytes matching m_oldFp so far
+    char*	m_bufferp;	// Characters not yet written, as fputc per character is slow
+    size_t	m_usedBytes;	// Number of characters in m_bufferp
 public:
     V3OutFile(const string& filename, V3OutFormatter::Language lang);
     virtual ~V3OutFile();
     void putsForceIncs();
 private:
+    void writeBlock();
+    void diverge();
     // CALLBACKS
-    virtual void putcOutput(char chr) { fputc(chr, m_fp); }
+    virtual void putcOutput(char chr) {
+	m_bufferp[m_usedBytes++] = chr;
+	if (VL_UNLIKELY(m_usedBytes >= WRITE_BUFFER_SIZE)) writeBlock();
+    }
+    virtual void putsOutput(const char* strg, size_t len) {
+	if (VL_UNLIKELY(m_usedBytes + len >= WRITE_BUFFER_SIZE)) {
+	    V3OutFormatter::putsOutput(strg, len);
+	} else {
+	    memcpy(m_bufferp + m_usedBytes, strg, len);
+	    m_usedBytes += len;
+	}
+    }
 };
 
 //######################################################################
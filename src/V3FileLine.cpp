@@ -143,7 +143,20 @@ FileLine* FileLine::copyOrSameFileLine() {
     if (lastNewp && *lastNewp == *this) {  // Compares lineno, filename, etc
 	return lastNewp;
     }
+    // Tokens also return to earlier lines, such as after macros and
+    // includes, so share any identical fileline made before.
+    typedef multimap<pair<int,int>,FileLine*> InternMap;
+    static InternMap s_interned;  // Filelines made here, by filename number and line
+    pair<int,int> key = make_pair(m_filenameno, m_lineno);
+    pair<InternMap::iterator,InternMap::iterator> range = s_interned.equal_range(key);
+    for (InternMap::iterator it = range.first; it != range.second; ++it) {
+	if (*it->second == *this) {
+	    lastNewp = it->second;
+	    return lastNewp;
+	}
+    }
     FileLine* newp = new FileLine(this);
+    s_interned.insert(make_pair(key, newp));
     lastNewp = newp;
     return newp;
 }
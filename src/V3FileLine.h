@@ -156,7 +156,8 @@ public:
     void modifyStateInherit(const FileLine* fromp);
     // Change the current fileline due to actions discovered after parsing
     // and may have side effects on other nodes sharing this FileLine.
-    // Use only when this is intended
+    // Use only when this is intended, on nodes V3LinkParse gives their own
+    // FileLine (variables, always, if and case items), or after making a copy
     void modifyWarnOff(V3ErrorCode code, bool flag) { warnOff(code,flag); }
 
     // OPERATORS
@@ -130,11 +130,13 @@ public:
 };
 
 class GateVarVertex : public GateEitherVertex {
+    typedef map<GateLogicVertex*, GateVarRefList> UseMap;
     AstVarScope* m_varScp;
     bool	 m_isTop;
     bool	 m_isClock;
     AstNode*	 m_rstSyncNodep;	// Used as reset and not in SenItem, in clocked always
     AstNode*	 m_rstAsyncNodep;	// Used as reset and in SenItem, in clocked always
+    UseMap	 m_uses;		// Rvalue references to this var, by consuming logic
 public:
     GateVarVertex(V3Graph* graphp, AstScope* scopep, AstVarScope* varScp)
 	: GateEitherVertex(graphp, scopep), m_varScp(varScp), m_isTop(false)
@@ -153,6 +155,16 @@ public:
     AstNode* rstAsyncNodep() const { return m_rstAsyncNodep; }
     void rstAsyncNodep(AstNode* nodep) { m_rstAsyncNodep=nodep; }
     // METHODS
+    void addUse(GateLogicVertex* lvertexp, AstNodeVarRef* refp) { m_uses[lvertexp].push_back(refp); }
+    void clearUses(GateLogicVertex* lvertexp) { m_uses.erase(lvertexp); }
+    void takeUses(GateLogicVertex* lvertexp, GateVarRefList& refsr) {
+	// Move the references under the given logic into refsr; they're about to be replaced
+	UseMap::iterator it = m_uses.find(lvertexp);
+	if (it != m_uses.end()) {
+	    refsr.swap(it->second);
+	    m_uses.erase(it);
+	}
+    }
     void propagateAttrClocksFrom(GateVarVertex* fromp) {
 	// Propagate clock and general attribute onto this node
 	varScp()->varp()->propagateAttrFrom(fromp->varScp()->varp());
@@ -168,9 +180,11 @@ class GateLogicVertex : public GateEitherVertex {
     AstNode*	m_nodep;
     AstActive*	m_activep;	// Under what active; NULL is ok (under cfunc or such)
     bool	m_slow;		// In slow block
+    bool	m_constPending;	// Substituted into since last constified
 public:
     GateLogicVertex(V3Graph* graphp, AstScope* scopep, AstNode* nodep, AstActive* activep, bool slow)
-	: GateEitherVertex(graphp,scopep), m_nodep(nodep), m_activep(activep), m_slow(slow) {}
+	: GateEitherVertex(graphp,scopep), m_nodep(nodep), m_activep(activep), m_slow(slow)
+	, m_constPending(false) {}
     virtual ~GateLogicVertex() {}
     // ACCESSORS
     virtual string name() const { return (cvtToStr((void*)m_nodep)+"@"+scopep()->prettyName()); }
@@ -178,6 +192,8 @@ public:
     AstNode* nodep() const { return m_nodep; }
     AstActive* activep() const { return m_activep; }
     bool	slow() const { return m_slow; }
+    bool	constPending() const { return m_constPending; }
+    void	constPending(bool flag) { m_constPending = flag; }
     VNUser accept(GateGraphBaseVisitor& v, VNUser vu=VNUser(0)) { return v.visit(this,vu); }
 };
 
@@ -294,6 +310,33 @@ public:
     }
 };
 
+//######################################################################
+// Record the rvalue references under logic in their variables' use lists
+
+class GateUseVisitor : public GateBaseVisitor {
+private:
+    // NODE STATE
+    // AstVarScope::user1p	-> GateVarVertex* for usage var (from GateVisitor)
+    // STATE
+    GateLogicVertex*	m_logicVertexp;	// Logic the references are under
+    // VISITORS
+    virtual void visit(AstNodeVarRef* nodep) {
+	if (!nodep->lvalue()) {
+	    if (GateVarVertex* vvertexp = (GateVarVertex*)(nodep->varScopep()->user1p())) {
+		vvertexp->addUse(m_logicVertexp, nodep);
+	    }
+	}
+    }
+    virtual void visit(AstNode* nodep) {}
+public:
+    // CONSTUCTORS
+    GateUseVisitor(AstNode* nodep, GateLogicVertex* logicVertexp) {
+	m_logicVertexp = logicVertexp;
+	nodep->iterateFlat(*this);
+    }
+    virtual ~GateUseVisitor() {}
+};
+
 //######################################################################
 // Gate class functions
 
@@ -311,6 +354,7 @@ private:
 
     // STATE
     V3Graph		m_graph;	// Scoreboard of var usages/dependencies
+    vector<GateLogicVertex*> m_constPendings;	// Logic substituted into, to constify
     GateLogicVertex*	m_logicVertexp;	// Current statement being tracked, NULL=ignored
     AstScope*		m_scopep;	// Current scope being processed
     AstNodeModule*	m_modp;		// Current module
@@ -365,7 +409,8 @@ private:
 
     void optimizeSignals(bool allowMultiIn);
     bool elimLogicOkOutputs(GateLogicVertex* consumeVertexp, const GateOkVisitor& okVisitor);
-    void optimizeElimVar(AstVarScope* varscp, AstNode* logicp, AstNode* consumerp);
+    void optimizeElimVar(GateVarVertex* vvertexp, AstNode* substp, GateLogicVertex* consumeVertexp);
+    void constifyLogic(GateLogicVertex* lvertexp);
     void warnSignals();
     void consumedMark();
     void consumedMarkRecurse(GateEitherVertex* vertexp);
@@ -448,6 +493,7 @@ private:
 		new V3GraphEdge(&m_graph, m_logicVertexp, vvertexp, 1);
 	    } else {
 		new V3GraphEdge(&m_graph, vvertexp, m_logicVertexp, 1);
+		vvertexp->addUse(m_logicVertexp, nodep);
 	    }
 	}
     }
@@ -567,6 +613,7 @@ void GateVisitor::optimizeSignals(bool allowMultiIn) {
 		GateLogicVertex* logicVertexp = dynamic_cast<GateLogicVertex*>
 		    (vvertexp->inBeginp()->fromp());
 		UINFO(8, "  From "<<logicVertexp->name()<<endl);
+		if (logicVertexp->reducible()) constifyLogic(logicVertexp);
 		AstNode* logicp = logicVertexp->nodep();
 		if (logicVertexp->reducible()) {
 		    // Can we eliminate?
@@ -617,13 +664,12 @@ void GateVisitor::optimizeSignals(bool allowMultiIn) {
 			for (V3GraphEdge* edgep = vvertexp->outBeginp();
 			     edgep; ) {
 			    GateLogicVertex* consumeVertexp = dynamic_cast<GateLogicVertex*>(edgep->top());
-			    AstNode* consumerp = consumeVertexp->nodep();
 			    if (!elimLogicOkOutputs(consumeVertexp, okVisitor/*ref*/)) {
 				// Cannot optimize this replacement
 				removedAllUsages = false;
 				edgep = edgep->outNextp();
 			    } else {
-				optimizeElimVar(vvertexp->varScp(), substp, consumerp);
+				optimizeElimVar(vvertexp, substp, consumeVertexp);
 				// If the new replacement referred to a signal,
 				// Correct the graph to point to this new generating variable
 				const GateVarRefList& rhsVarRefs = okVisitor.rhsVarRefs();
@@ -663,6 +709,12 @@ void GateVisitor::optimizeSignals(bool allowMultiIn) {
 	    }
 	}
     }
+    // Constify whatever was substituted into, once each rather than per substitution
+    for (vector<GateLogicVertex*>::iterator it = m_constPendings.begin();
+	 it != m_constPendings.end(); ++it) {
+	constifyLogic(*it);
+    }
+    m_constPendings.clear();
 }
 
 bool GateVisitor::elimLogicOkOutputs(GateLogicVertex* consumeVertexp, const GateOkVisitor& okVisitor) {
@@ -816,28 +868,8 @@ private:
     // VISITORS
     virtual void visit(AstNodeVarRef* nodep) {
 	if (nodep->varScopep() == m_elimVarScp) {
-	    // Substitute in the new tree
-	    // It's possible we substitute into something that will be reduced more later
-	    // however, as we never delete the top Always/initial statement, all should be well.
 	    m_didReplace = true;
-	    if (nodep->lvalue()) nodep->v3fatalSrc("Can't replace lvalue assignments with const var");
-	    AstNode* substp = m_replaceTreep->cloneTree(false);
-	    if (nodep->castNodeVarRef()
-		&& substp->castNodeVarRef()
-		&& nodep->same(substp)) {
-		// Prevent a infinite loop...
-		substp->v3fatalSrc("Replacing node with itself; perhaps circular logic?");
-	    }
-	    // Which fileline() to use?
-	    // If replacing with logic, an error/warning is likely to want to point to the logic
-	    // IE what we're replacing with.
-	    // However a VARREF should point to the original as it's otherwise confusing
-	    // to throw warnings that point to a PIN rather than where the pin us used.
-	    if (substp->castVarRef()) substp->fileline(nodep->fileline());
-	    // Make the substp an rvalue like nodep. This facilitate the hashing in dedupe.
-	    if (AstNodeVarRef* varrefp = substp->castNodeVarRef()) varrefp->lvalue(false);
-	    nodep->replaceWith(substp);
-	    nodep->deleteTree(); VL_DANGLING(nodep);
+	    replaceVarRef(nodep, m_replaceTreep); VL_DANGLING(nodep);
 	}
     }
     virtual void visit(AstNode* nodep) {
@@ -853,20 +885,65 @@ public:
 	nodep->accept(*this);
     }
     bool didReplace() const { return m_didReplace; }
+    static AstNode* replaceVarRef(AstNodeVarRef* nodep, AstNode* replaceTreep) {
+	// Substitute in the new tree, returning it
+	// It's possible we substitute into something that will be reduced more later
+	// however, as we never delete the top Always/initial statement, all should be well.
+	if (nodep->lvalue()) nodep->v3fatalSrc("Can't replace lvalue assignments with const var");
+	AstNode* substp = replaceTreep->cloneTree(false);
+	if (nodep->castNodeVarRef()
+	    && substp->castNodeVarRef()
+	    && nodep->same(substp)) {
+	    // Prevent a infinite loop...
+	    substp->v3fatalSrc("Replacing node with itself; perhaps circular logic?");
+	}
+	// Which fileline() to use?
+	// If replacing with logic, an error/warning is likely to want to point to the logic
+	// IE what we're replacing with.
+	// However a VARREF should point to the original as it's otherwise confusing
+	// to throw warnings that point to a PIN rather than where the pin us used.
+	if (substp->castVarRef()) substp->fileline(nodep->fileline());
+	// Make the substp an rvalue like nodep. This facilitate the hashing in dedupe.
+	if (AstNodeVarRef* varrefp = substp->castNodeVarRef()) varrefp->lvalue(false);
+	nodep->replaceWith(substp);
+	nodep->deleteTree(); VL_DANGLING(nodep);
+	return substp;
+    }
 };
 
-void GateVisitor::optimizeElimVar(AstVarScope* varscp, AstNode* substp, AstNode* consumerp) {
+void GateVisitor::optimizeElimVar(GateVarVertex* vvertexp, AstNode* substp, GateLogicVertex* consumeVertexp) {
+    // Replace just the references the use list has under the consumer,
+    // rather than searching the consumer, which is slow when it has many eliminated inputs
+    AstNode* consumerp = consumeVertexp->nodep();
     if (debug()>=5) consumerp->dumpTree(cout,"\telimUsePre: ");
-    GateElimVisitor elimVisitor (consumerp, varscp, substp);
-    if (elimVisitor.didReplace()) {
-	if (debug()>=9) consumerp->dumpTree(cout,"\telimUseCns: ");
-	//Caution: Can't let V3Const change our handle to consumerp, such as by
-	// optimizing away this assignment, etc.
-	consumerp = V3Const::constifyEdit(consumerp);
-	if (debug()>=5) consumerp->dumpTree(cout,"\telimUseDne: ");
+    GateVarRefList refs;
+    vvertexp->takeUses(consumeVertexp, refs/*ref*/);
+    if (refs.empty()) return;
+    for (GateVarRefList::iterator it = refs.begin(); it != refs.end(); ++it) {
+	AstNode* newp = GateElimVisitor::replaceVarRef(*it, substp);
+	GateUseVisitor useVisitor (newp, consumeVertexp);  // Substituted refs are now used by the consumer
+    }
+    if (debug()>=9) consumerp->dumpTree(cout,"\telimUseCns: ");
+    if (!consumeVertexp->constPending()) {
+	consumeVertexp->constPending(true);
+	m_constPendings.push_back(consumeVertexp);
     }
 }
 
+void GateVisitor::constifyLogic(GateLogicVertex* lvertexp) {
+    if (!lvertexp->constPending()) return;
+    lvertexp->constPending(false);
+    // V3Const may delete references, so rebuild the logic's use lists afterwards
+    for (V3GraphEdge* edgep = lvertexp->inBeginp(); edgep; edgep = edgep->inNextp()) {
+	dynamic_cast<GateVarVertex*>(edgep->fromp())->clearUses(lvertexp);
+    }
+    //Caution: Can't let V3Const change our handle to consumerp, such as by
+    // optimizing away this assignment, etc.
+    AstNode* consumerp = V3Const::constifyEdit(lvertexp->nodep());
+    if (debug()>=5) consumerp->dumpTree(cout,"\telimUseDne: ");
+    GateUseVisitor useVisitor (lvertexp->nodep(), lvertexp);
+}
+
 //######################################################################
 // Auxiliary hash class for GateDedupeVarVisitor
 
@@ -1394,7 +1471,12 @@ private:
 		    }
 		    UINFO(9,"CLK DECOMP Connecting - "<<assignp->lhsp()<<" <-> "<<m_clk_vsp<<endl);
 		    AstNode* rhsp = assignp->rhsp();
-		    rhsp->replaceWith(new AstVarRef(rhsp->fileline(), m_clk_vsp, false));
+		    AstVarRef* newrefp = new AstVarRef(rhsp->fileline(), m_clk_vsp, false);
+		    rhsp->replaceWith(newrefp);
+		    for (V3GraphEdge* edgep = lvertexp->inBeginp(); edgep; edgep = edgep->inNextp()) {
+			dynamic_cast<GateVarVertex*>(edgep->fromp())->clearUses(lvertexp);
+		    }
+		    m_clk_vvertexp->addUse(lvertexp, newrefp);
 		    for (V3GraphEdge* edgep = lvertexp->inBeginp(); edgep; ) {
 			edgep->unlinkDelete(); VL_DANGLING(edgep);
 		    }
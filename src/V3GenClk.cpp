@@ -152,6 +152,8 @@ private:
     AstActive*	m_activep;		// Inside activate statement
     AstNodeAssign* m_assignp;		// Inside assigndly statement
     AstNodeModule*	m_topModp;	// Top module
+    bool	m_inCall;		// Tracing a function from its call
+    bool	m_inSlow;		// Inside initial/settle activation
 
     // VISITORS
     virtual void visit(AstTopScope* nodep) {
@@ -173,7 +175,18 @@ private:
     virtual void visit(AstCCall* nodep) {
 	nodep->iterateChildren(*this);
 	// Enter the function and trace it
+	bool lastInCall = m_inCall;
+	m_inCall = true;
 	nodep->funcp()->accept(*this);
+	m_inCall = lastInCall;
+    }
+    virtual void visit(AstCFunc* nodep) {
+	// Functions are traced from their calls, so statements are seen in
+	// evaluation order and under the domain of the calling activation.
+	// Only functions called from outside the model are walked in place.
+	if (m_inCall || nodep->dpiExport() || nodep->funcPublic()) {
+	    nodep->iterateChildren(*this);
+	}
     }
     //----
 
@@ -185,9 +198,11 @@ private:
 	    UINFO(8,"  VarAct "<<nodep<<endl);
 	    vscp->user1(true);
 	}
-	if (m_assignp && nodep->lvalue() && vscp->user1()) {
+	if (m_assignp && nodep->lvalue() && vscp->user1() && !m_inSlow) {
 	    // Variable was previously used as a clock, and is now being set
 	    // Thus a unordered generated clock...
+	    // Initial and settle logic runs before _eval, which sees any
+	    // clock change through its edge detection, so needs no recheck.
 	    UINFO(8,"  VarSetAct "<<nodep<<endl);
 	    vscp->circular(true);
 	}
@@ -203,7 +218,9 @@ private:
 	m_activep = nodep;
 	nodep->sensesp()->iterateChildren(*this);  // iterateAndNext?
 	m_activep = NULL;
+	m_inSlow = nodep->hasInitial() || nodep->hasSettle();
 	nodep->iterateChildren(*this);
+	m_inSlow = false;
     }
 
     //-----
@@ -217,6 +234,8 @@ public:
 	m_activep = NULL;
 	m_assignp = NULL;
 	m_topModp = NULL;
+	m_inCall = false;
+	m_inSlow = false;
 	nodep->accept(*this);
     }
     virtual ~GenClkReadVisitor() {}
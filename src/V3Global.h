@@ -66,6 +66,7 @@ class V3Global {
     int		m_debugFileNumber;	// Number to append to debug files created
     bool	m_assertDTypesResolved;	// Tree should have dtypep()'s
     bool	m_constRemoveXs;	// Const needs to strip any Xs
+    vluint64_t	m_constEditCnt;		// Const edit count when constifyAll last started, 0 = none
     bool	m_needHInlines;		// Need __Inlines file
     bool	m_needHeavy;		// Need verilated_heavy.h include
     bool	m_dpi;			// Need __Dpi include files
@@ -81,6 +82,7 @@ public:
 	m_widthMinUsage = VWidthMinUsage::LINT_WIDTH;
 	m_assertDTypesResolved = false;
 	m_constRemoveXs = false;
+	m_constEditCnt = 0;
 	m_needHInlines = false;
 	m_needHeavy = false;
 	m_dpi = false;
@@ -102,6 +104,8 @@ public:
     void widthMinUsage(const VWidthMinUsage& flag) { m_widthMinUsage = flag; }
     bool constRemoveXs() const { return m_constRemoveXs; }
     void constRemoveXs(bool flag) { m_constRemoveXs = flag; }
+    vluint64_t constEditCnt() const { return m_constEditCnt; }
+    void constEditCnt(vluint64_t cnt) { m_constEditCnt = cnt; }
     string debugFilename(const string& nameComment, int newNumber=0) {
 	++m_debugFileNumber;
 	if (newNumber) m_debugFileNumber = newNumber;
@@ -31,6 +31,7 @@
 class V3Graph;
 class V3GraphVertex;
 class V3GraphEdge;
+class V3GraphCsr;
 class GraphAcycEdge;
 class OrderEitherVertex;
 class OrderLogicVertex;
@@ -56,7 +57,8 @@ protected:
     void acyclicDFSIterate(V3GraphVertex *vertexp, int depth, uint32_t currentRank);
     void acyclicCut();
     void acyclicLoop(V3GraphVertex* vertexp, int depth);
-    double orderDFSIterate(V3GraphVertex* vertexp);
+    double orderDFSIterate(const V3GraphCsr& csr, vector<uint8_t>& state,
+			   vector<double>& fanouts, uint32_t vtx);
     void dumpEdge(ostream& os, V3GraphVertex* vertexp, V3GraphEdge* edgep);
     void verticesUnlink() { m_vertices.reset(); }
     // ACCESSORS
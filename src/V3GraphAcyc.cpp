@@ -26,9 +26,12 @@
 #include <algorithm>
 #include <vector>
 #include <list>
+#include <set>
 
 #include "V3Global.h"
 #include "V3Graph.h"
+#include "V3Os.h"
+#include "V3Stats.h"
 
 //######################################################################
 //######################################################################
@@ -107,6 +110,7 @@ private:
     vector<OrigEdgeList*>	m_origEdgeDelp;	// List of deletions to do when done
     V3EdgeFuncP		m_origEdgeFuncp;	// Function that says we follow this edge (in original graph)
     uint32_t		m_placeStep;		// Number that user() must be equal to to indicate processing
+    uint32_t		m_statCuts;		// Statistic tracking: breakGraph edges cut
 
     static int debug() { return V3Graph::debug(); }
 
@@ -122,6 +126,7 @@ private:
     void cutBackward (GraphAcycVertex* vertexp);
     void deleteMarked();
     void place();
+    void placeFast(const vector<V3GraphEdge*>& edges);
     void placeTryEdge(V3GraphEdge* edgep);
     bool placeIterate(GraphAcycVertex* vertexp, uint32_t currentRank);
 
@@ -158,6 +163,7 @@ private:
 	// From the break edge, cut edges in original graph it represents
 	UINFO(8,why<<" CUT "<<breakEdgep->fromp()<<endl);
 	breakEdgep->cut();
+	m_statCuts++;
 	OrigEdgeList* oEListp = (OrigEdgeList*)(breakEdgep->userp());
 	if (!oEListp) v3fatalSrc("No original edge associated with cutting edge "<<breakEdgep<<endl);
 	// The breakGraph edge may represent multiple real edges; cut them all
@@ -187,6 +193,7 @@ public:
 	m_origGraphp = origGraphp;
 	m_origEdgeFuncp = edgeFuncp;
 	m_placeStep = 0;
+	m_statCuts = 0;
     }
     ~GraphAcyc() {
 	for (vector<OrigEdgeList*>::iterator it = m_origEdgeDelp.begin(); it != m_origEdgeDelp.end(); ++it) {
@@ -464,6 +471,13 @@ void GraphAcyc::place() {
 	}
     }
 
+    // Trying each edge costs a walk of the graph; for huge graphs use the linear heuristic
+    if (v3Global.opt.acyclicFast() && numEdges > v3Global.opt.acyclicFast()) {
+	UINFO(4, "    Fast placement\n");
+	placeFast(edges);
+	return;
+    }
+
     // Sort by weight, then by vertex (so that we completely process one vertex, when possible)
     stable_sort(edges.begin(), edges.end(), GraphAcycEdgeCmp());
 
@@ -475,6 +489,113 @@ void GraphAcyc::place() {
     }
 }
 
+void GraphAcyc::placeFast(const vector<V3GraphEdge*>& edges) {
+    // Eades-Lin-Smyth style ordering, constrained so non-cutable edges always point forward.
+    // Of the vertices whose non-cutable inputs are all placed, repeatedly place the one with
+    // the most cutable weight going out versus coming in from unplaced vertices.
+    // Cutable edges pointing backwards in the final order are cut.
+    // Vertex::user() is the index into the arrays below
+    typedef set<pair<vlsint64_t,uint32_t> > ReadySet;	// (-delta, index), best first
+    vector<GraphAcycVertex*> vertexps;
+    for (V3GraphVertex* vertexp = m_breakGraph.verticesBeginp(); vertexp; vertexp=vertexp->verticesNextp()) {
+	vertexp->user(vertexps.size());
+	vertexps.push_back((GraphAcycVertex*)vertexp);
+    }
+    uint32_t size = vertexps.size();
+    vector<vlsint64_t> delta (size, 0);	// Cutable out weight less in weight, to unplaced vertices
+    vector<uint32_t> waiting (size, 0);	// Non-cutable inputs from unplaced vertices
+    vector<uint32_t> order (size, 0);	// Position in placement order
+    vector<bool> placed (size, false);
+    for (uint32_t i=0; i<size; ++i) {
+	for (V3GraphEdge* edgep = vertexps[i]->outBeginp(); edgep; edgep=edgep->outNextp()) {
+	    if (!edgep->weight()) continue;
+	    uint32_t to = edgep->top()->user();
+	    if (edgep->cutable()) {
+		delta[i] += edgep->weight();
+		delta[to] -= edgep->weight();
+	    } else {
+		waiting[to]++;
+	    }
+	}
+    }
+    ReadySet ready;
+    for (uint32_t i=0; i<size; ++i) {
+	if (!waiting[i]) ready.insert(make_pair(-delta[i], i));
+    }
+    uint32_t nextOrder = 0;
+    uint32_t scan = 0;	// Fallback if a non-cutable loop leaves nothing ready
+    while (nextOrder < size) {
+	uint32_t vtx;
+	if (!ready.empty()) {
+	    vtx = ready.begin()->second;
+	    ready.erase(ready.begin());
+	} else {
+	    while (placed[scan]) scan++;
+	    vtx = scan;
+	}
+	placed[vtx] = true;
+	order[vtx] = nextOrder++;
+	// Edges to/from this vertex no longer count against the unplaced neighbors
+	for (V3GraphEdge* edgep = vertexps[vtx]->outBeginp(); edgep; edgep=edgep->outNextp()) {
+	    if (!edgep->weight()) continue;
+	    uint32_t to = edgep->top()->user();
+	    if (placed[to]) continue;
+	    if (edgep->cutable()) {
+		if (!waiting[to]) ready.erase(make_pair(-delta[to], to));
+		delta[to] += edgep->weight();
+		if (!waiting[to]) ready.insert(make_pair(-delta[to], to));
+	    } else if (waiting[to] && !--waiting[to]) {
+		ready.insert(make_pair(-delta[to], to));
+	    }
+	}
+	for (V3GraphEdge* edgep = vertexps[vtx]->inBeginp(); edgep; edgep=edgep->inNextp()) {
+	    if (!edgep->weight() || !edgep->cutable()) continue;
+	    uint32_t from = edgep->fromp()->user();
+	    if (placed[from]) continue;
+	    if (!waiting[from]) ready.erase(make_pair(-delta[from], from));
+	    delta[from] -= edgep->weight();
+	    if (!waiting[from]) ready.insert(make_pair(-delta[from], from));
+	}
+    }
+
+    // Rank along the kept (forward) edges, in placement order
+    vector<uint32_t> byOrder (size);
+    for (uint32_t i=0; i<size; ++i) byOrder[order[i]] = i;
+    vector<uint32_t> rank (size, 0);
+    for (uint32_t o=0; o<size; ++o) {
+	uint32_t from = byOrder[o];
+	for (V3GraphEdge* edgep = vertexps[from]->outBeginp(); edgep; edgep=edgep->outNextp()) {
+	    if (!edgep->weight()) continue;
+	    uint32_t to = edgep->top()->user();
+	    if (order[to] > order[from] && rank[to] <= rank[from]) rank[to] = rank[from]+1;
+	}
+    }
+
+    // Refine: heaviest backward edges first, keep any the ranks already satisfy.
+    // Kept edges never lower a rank, so each check stays valid.
+    vector<V3GraphEdge*> backs;
+    for (vector<V3GraphEdge*>::const_iterator it = edges.begin(); it!=edges.end(); ++it) {
+	V3GraphEdge* edgep = *it;
+	uint32_t from = edgep->fromp()->user();
+	uint32_t to = edgep->top()->user();
+	if (order[to] > order[from]) {
+	    edgep->cutable(false);
+	} else {
+	    backs.push_back(edgep);
+	}
+    }
+    stable_sort(backs.begin(), backs.end(), GraphAcycEdgeCmp());
+    for (vector<V3GraphEdge*>::iterator it = backs.begin(); it!=backs.end(); ++it) {
+	V3GraphEdge* edgep = *it;
+	if (rank[edgep->fromp()->user()] < rank[edgep->top()->user()]) {
+	    edgep->cutable(false);
+	} else {
+	    cutOrigEdge (edgep, "  Cut order");
+	    edgep->unlinkDelete(); VL_DANGLING(edgep);
+	}
+    }
+}
+
 void GraphAcyc::placeTryEdge(V3GraphEdge* edgep) {
     // Try to make this edge uncutable
     m_placeStep++;
@@ -536,6 +657,7 @@ bool GraphAcyc::placeIterate(GraphAcycVertex* vertexp, uint32_t currentRank) {
 //----- Main algorithm entry point
 
 void GraphAcyc::main () {
+    double startTime = V3Os::timeWall();
     m_breakGraph.userClearEdges();
 
     // Color based on possible loops
@@ -568,6 +690,9 @@ void GraphAcyc::main () {
     // Only needed to assert there are no loops in completed graph
     m_breakGraph.rank(&V3GraphEdge::followAlwaysTrue);
     if (debug()>=6) m_breakGraph.dumpDotFilePrefixed("acyc_done");
+
+    V3Stats::addStatSum("Graph, Acyclic edges cut", m_statCuts);
+    V3Stats::addStatSum("Graph, Acyclic time (s)", V3Os::timeWall() - startTime);
 }
 
 void V3Graph::acyclic(V3EdgeFuncP edgeFuncp) {
@@ -28,9 +28,218 @@
 #include <map>
 #include <list>
 
+#if defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))
+# define GRAPH_PTHREADS  // Allow --verilate-jobs
+# include <pthread.h>
+#endif
+
 #include "V3Global.h"
 #include "V3GraphAlg.h"
 
+//######################################################################
+//######################################################################
+// Compressed sparse row snapshot
+
+V3GraphCsr::V3GraphCsr(V3Graph* graphp, V3EdgeFuncP edgeFuncp) {
+    // Number the vertices
+    uint32_t vertices = 0;
+    for (V3GraphVertex* vertexp = graphp->verticesBeginp(); vertexp; vertexp=vertexp->verticesNextp()) {
+	vertexp->user(vertices++);
+    }
+    m_vertices.reserve(vertices);
+    m_outBegin.reserve(vertices+1);
+    m_inCount.assign(vertices, 0);
+    // Pack the followed edges
+    for (V3GraphVertex* vertexp = graphp->verticesBeginp(); vertexp; vertexp=vertexp->verticesNextp()) {
+	m_vertices.push_back(vertexp);
+	m_outBegin.push_back(m_outTo.size());
+	for (V3GraphEdge* edgep = vertexp->outBeginp(); edgep; edgep=edgep->outNextp()) {
+	    if (edgep->weight() && (edgeFuncp)(edgep)) {
+		m_outTo.push_back(edgep->top()->user());
+		++m_inCount[edgep->top()->user()];
+	    }
+	}
+    }
+    m_outBegin.push_back(m_outTo.size());
+    UINFO(9,"  Csr "<<vertices<<" vertices, "<<m_outTo.size()<<" edges"<<endl);
+}
+
+void V3GraphCsr::addInEdges() {
+    if (!m_inBegin.empty()) return;  // Already done
+    // Counting sort of the edges by target; sources stay in vertex order
+    m_inBegin.assign(size()+1, 0);
+    for (uint32_t vtx = 0; vtx < size(); ++vtx) m_inBegin[vtx+1] = m_inBegin[vtx] + m_inCount[vtx];
+    m_inFrom.resize(m_outTo.size());
+    vector<uint32_t> fill (m_inBegin.begin(), m_inBegin.end()-1);
+    for (uint32_t vtx = 0; vtx < size(); ++vtx) {
+	for (uint32_t edge = outBegin(vtx); edge < outEnd(vtx); ++edge) {
+	    m_inFrom[fill[outTo(edge)]++] = vtx;
+	}
+    }
+}
+
+//######################################################################
+//######################################################################
+// Parallel helpers
+//	With --verilate-jobs, work over large graphs is split into chunks
+//	run on separate threads.  Each chunk only writes its own results,
+//	which the caller merges in chunk order, so the results never depend on
+//	the number of jobs.
+
+#define GRAPH_PARALLEL_MIN 4096		// Minimum work items per chunk
+
+class GraphParallelTask {
+public:
+    virtual void run(uint32_t chunk, uint32_t begin, uint32_t end) = 0;
+    virtual ~GraphParallelTask() {}
+};
+
+class GraphParallel {
+    struct Job {
+	GraphParallelTask* m_taskp;
+	uint32_t m_chunk;
+	uint32_t m_begin;
+	uint32_t m_end;
+    };
+    static void* jobThread(void* jobp) {
+	Job* jp = static_cast<Job*>(jobp);
+	jp->m_taskp->run(jp->m_chunk, jp->m_begin, jp->m_end);
+	return NULL;
+    }
+public:
+    static uint32_t chunks(uint32_t items) {
+	// Number of chunks to split the given number of work items into
+	uint32_t most = items / GRAPH_PARALLEL_MIN;
+	uint32_t jobs = v3Global.opt.verilateJobs();
+	if (jobs > most) jobs = most;
+	return jobs ? jobs : 1;
+    }
+    static void run(GraphParallelTask& task, uint32_t items, uint32_t chunks) {
+	// Run task over items split into chunks, returning when all are done
+	vector<Job> jobs (chunks);
+	for (uint32_t chunk = 0; chunk < chunks; ++chunk) {
+	    jobs[chunk].m_taskp = &task;
+	    jobs[chunk].m_chunk = chunk;
+	    jobs[chunk].m_begin = (uint32_t)((vluint64_t)items * chunk / chunks);
+	    jobs[chunk].m_end = (uint32_t)((vluint64_t)items * (chunk+1) / chunks);
+	}
+#ifdef GRAPH_PTHREADS
+	vector<pthread_t> threads (chunks);
+	vector<bool> started (chunks, false);
+	for (uint32_t chunk = 1; chunk < chunks; ++chunk) {
+	    started[chunk] = !pthread_create(&threads[chunk], NULL, &jobThread, &jobs[chunk]);
+	}
+	for (uint32_t chunk = 0; chunk < chunks; ++chunk) {
+	    if (!started[chunk]) jobThread(&jobs[chunk]);  // Main thread, or couldn't start
+	}
+	for (uint32_t chunk = 1; chunk < chunks; ++chunk) {
+	    if (started[chunk]) pthread_join(threads[chunk], NULL);
+	}
+#else
+	for (uint32_t chunk = 0; chunk < chunks; ++chunk) jobThread(&jobs[chunk]);
+#endif
+    }
+};
+
+class GraphFrontierTask : public GraphParallelTask {
+    // Level synchronous walk of a V3GraphCsr, from a frontier of vertices
+    // Vertices are visited once per level; the order within a level is arbitrary,
+    // so visit() must give the same result whatever the order.
+    vector<uint32_t>*		m_frontierp;	// Vertices being visited
+    vector<vector<uint32_t> >	m_next;		// Each chunk's vertices for next level
+protected:
+    const V3GraphCsr&	m_csr;		// Graph being walked
+    bool		m_reverse;	// Walk inbound edges
+    // Visit vertex, adding any vertices for the next level to nextr
+    virtual void visit(uint32_t vtx, vector<uint32_t>& nextr) = 0;
+    virtual void visitedLevel(const vector<uint32_t>&) {}
+    uint32_t edgeBegin(uint32_t vtx) const { return m_reverse ? m_csr.inBegin(vtx) : m_csr.outBegin(vtx); }
+    uint32_t edgeEnd(uint32_t vtx) const { return m_reverse ? m_csr.inEnd(vtx) : m_csr.outEnd(vtx); }
+    uint32_t edgeOther(uint32_t edge) const { return m_reverse ? m_csr.inFrom(edge) : m_csr.outTo(edge); }
+public:
+    GraphFrontierTask(const V3GraphCsr& csr, bool reverse)
+	: m_frontierp(NULL), m_csr(csr), m_reverse(reverse) {}
+    virtual ~GraphFrontierTask() {}
+    virtual void run(uint32_t chunk, uint32_t begin, uint32_t end) {
+	for (uint32_t i = begin; i < end; ++i) visit((*m_frontierp)[i], m_next[chunk]);
+    }
+    uint32_t walk(vector<uint32_t>& frontier) {
+	// Walk until no vertices are left; returns number of vertices visited
+	uint32_t visited = 0;
+	while (!frontier.empty()) {
+	    visited += frontier.size();
+	    uint32_t chunks = GraphParallel::chunks(frontier.size());
+	    m_frontierp = &frontier;
+	    m_next.assign(chunks, vector<uint32_t>());
+	    GraphParallel::run(*this, frontier.size(), chunks);
+	    frontier.clear();
+	    for (uint32_t chunk = 0; chunk < chunks; ++chunk) {
+		frontier.insert(frontier.end(), m_next[chunk].begin(), m_next[chunk].end());
+	    }
+	    visitedLevel(frontier);
+	}
+	m_frontierp = NULL;
+	return visited;
+    }
+};
+
+class GraphPeelTask : public GraphFrontierTask {
+    // Kahn style peeling: a vertex is visited when all its edges from visited
+    // vertices are counted down.  Vertices with m_part 0 are ignored.
+    vector<uint32_t>&	m_waiting;	// Each vertex's uncounted edges
+    vector<uint32_t>*	m_partp;	// If set, each vertex's partition, cleared when visited
+    vector<uint32_t>*	m_rankp;	// If set, each vertex's rank, one past its inputs
+protected:
+    virtual void visit(uint32_t vtx, vector<uint32_t>& nextr) {
+	for (uint32_t edge = edgeBegin(vtx); edge < edgeEnd(vtx); ++edge) {
+	    uint32_t other = edgeOther(edge);
+	    if (m_partp && !(*m_partp)[other]) continue;
+	    if (!__sync_sub_and_fetch(&m_waiting[other], 1)) {
+		// Only this thread counted it down, so only it writes it
+		if (m_rankp) (*m_rankp)[other] = (*m_rankp)[vtx] + 1;
+		nextr.push_back(other);
+	    }
+	}
+    }
+    virtual void visitedLevel(const vector<uint32_t>& frontier) {
+	if (m_partp) {
+	    for (vector<uint32_t>::const_iterator it = frontier.begin(); it != frontier.end(); ++it) {
+		(*m_partp)[*it] = 0;
+	    }
+	}
+    }
+public:
+    GraphPeelTask(const V3GraphCsr& csr, bool reverse, vector<uint32_t>& waiting,
+		  vector<uint32_t>* partp, vector<uint32_t>* rankp)
+	: GraphFrontierTask(csr, reverse), m_waiting(waiting), m_partp(partp), m_rankp(rankp) {}
+    virtual ~GraphPeelTask() {}
+};
+
+class GraphReachTask : public GraphFrontierTask {
+    // Mark vertices reachable within a partition
+    const vector<uint32_t>&	m_part;		// Each vertex's partition
+    uint32_t			m_label;	// Partition being walked
+    vector<uint32_t>&		m_mark;		// Each vertex's mark, m_stamp if reached
+    uint32_t			m_stamp;	// Mark for this walk
+protected:
+    virtual void visit(uint32_t vtx, vector<uint32_t>& nextr) {
+	for (uint32_t edge = edgeBegin(vtx); edge < edgeEnd(vtx); ++edge) {
+	    uint32_t other = edgeOther(edge);
+	    if (m_part[other] != m_label) continue;
+	    uint32_t old = m_mark[other];
+	    if (old != m_stamp && __sync_bool_compare_and_swap(&m_mark[other], old, m_stamp)) {
+		nextr.push_back(other);
+	    }
+	}
+    }
+public:
+    GraphReachTask(const V3GraphCsr& csr, bool reverse, const vector<uint32_t>& part,
+		   uint32_t label, vector<uint32_t>& mark, uint32_t stamp)
+	: GraphFrontierTask(csr, reverse), m_part(part), m_label(label)
+	, m_mark(mark), m_stamp(stamp) {}
+    virtual ~GraphReachTask() {}
+};
+
 //######################################################################
 //######################################################################
 // Algorithms - delete
@@ -74,27 +283,48 @@ void V3Graph::deleteCutableOnlyEdges() {
 //######################################################################
 // Algorithms - weakly connected components
 
-class GraphRemoveRedundant : GraphAlg {
+class GraphRemoveRedundant : GraphAlg, GraphParallelTask {
     bool	m_sumWeights;		///< Sum, rather then maximize weights
+    vector<V3GraphVertex*>	   m_vertices;	// Vertex for each vertex number
+    vector<vector<V3GraphEdge*> > m_marks;	// Each chunk's edge to each vertex number
+    vector<vector<V3GraphEdge*> > m_deletes;	// Each chunk's edges to delete
 private:
     void main() {
+	// Vertex::m_user begin: vertex number
+	// Each vertex only edits its own outbound edges, so vertices are processed in
+	// parallel, and the edges to delete are unlinked afterwards.
 	for (V3GraphVertex* vertexp = m_graphp->verticesBeginp(); vertexp; vertexp=vertexp->verticesNextp()) {
-	    vertexIterate(vertexp);
+	    vertexp->user(m_vertices.size());
+	    m_vertices.push_back(vertexp);
+	}
+	uint32_t chunks = GraphParallel::chunks(m_vertices.size());
+	m_marks.resize(chunks);
+	m_deletes.resize(chunks);
+	GraphParallel::run(*this, m_vertices.size(), chunks);
+	for (uint32_t chunk = 0; chunk < chunks; ++chunk) {
+	    for (vector<V3GraphEdge*>::iterator it = m_deletes[chunk].begin(); it != m_deletes[chunk].end(); ++it) {
+		(*it)->unlinkDelete();
+	    }
 	}
     }
-    void vertexIterate(V3GraphVertex* vertexp) {
+    virtual void run(uint32_t chunk, uint32_t begin, uint32_t end) {
+	m_marks[chunk].assign(m_vertices.size(), NULL);
+	for (uint32_t vtx = begin; vtx < end; ++vtx) {
+	    vertexIterate(m_vertices[vtx], m_marks[chunk], m_deletes[chunk]);
+	}
+    }
+    void vertexIterate(V3GraphVertex* vertexp, vector<V3GraphEdge*>& marks, vector<V3GraphEdge*>& deletes) {
 	// Clear marks
 	for (V3GraphEdge* edgep = vertexp->outBeginp(); edgep; edgep=edgep->outNextp()) {
-	    edgep->top()->userp(NULL);
+	    marks[edgep->top()->user()] = NULL;
 	}
 	// Mark edges and detect duplications
-	for (V3GraphEdge* nextp, *edgep = vertexp->outBeginp(); edgep; edgep=nextp) {
-	    nextp = edgep->outNextp();
+	for (V3GraphEdge* edgep = vertexp->outBeginp(); edgep; edgep=edgep->outNextp()) {
 	    if (followEdge(edgep)) {
-		V3GraphVertex* outVertexp = edgep->top();
-		V3GraphEdge* prevEdgep = (V3GraphEdge*)outVertexp->userp();
+		V3GraphEdge*& markr = marks[edgep->top()->user()];
+		V3GraphEdge* prevEdgep = markr;
 		if (!prevEdgep) { // No previous assignment
-		    outVertexp->userp(edgep);
+		    markr = edgep;
 		} else { // Duplicate
 		    bool saveOld = true;
 		    if (prevEdgep->cutable() && !edgep->cutable()) {
@@ -109,11 +339,11 @@ private:
 		    }
 		    if (saveOld) {
 			if (m_sumWeights) prevEdgep->weight(prevEdgep->weight() + edgep->weight());
-			edgep->unlinkDelete(); VL_DANGLING(edgep);
+			deletes.push_back(edgep);
 		    } else {
 			if (m_sumWeights) edgep->weight(prevEdgep->weight() + edgep->weight());
-			prevEdgep->unlinkDelete(); VL_DANGLING(prevEdgep);
-			outVertexp->userp(edgep);
+			deletes.push_back(prevEdgep);
+			markr = edgep;
 		    }
 		}
 	    }
@@ -185,76 +415,179 @@ void V3Graph::weaklyConnected(V3EdgeFuncP edgeFuncp) {
 
 class GraphAlgStrongly : GraphAlg {
 private:
+    V3GraphCsr	m_csr;			// Snapshot of graph
     uint32_t	m_currentDfs;		// DFS count
-    vector<V3GraphVertex*> m_callTrace;	// List of everything we hit processing so far
+    vector<uint32_t> m_dfs;		// Each vertex's DFS number indicating possible root of subtree, 0=not iterated
+    vector<uint32_t> m_color;		// Each vertex's output subtree number (fully processed)
+    vector<uint32_t> m_callTrace;	// List of everything we hit processing so far
+    vector<uint32_t> m_first;		// Each subtree number's first vertex, plus one
+    vector<uint32_t> m_comp;		// Each vertex's component, its first vertex plus one
+    vector<uint32_t> m_part;		// Each vertex's partition still to be split, 0=done
 
     void main() {
-	// Use Tarjan's algorithm to find the strongly connected subgraphs.
 	// Node State:
-	//     Vertex::user  	// DFS number indicating possible root of subtree, 0=not iterated
-	//     Vertex::color	// Output subtree number (fully processed)
+	//     Vertex::user  	// Clobbered
+	//     Vertex::color	// Output component number, its lowest numbered vertex plus one
+	// Components are numbered by their first vertex, so the serial and parallel
+	// algorithms give identical colors.
 
 	// Clear info
-	for (V3GraphVertex* vertexp = m_graphp->verticesBeginp(); vertexp; vertexp=vertexp->verticesNextp()) {
-	    vertexp->color(0);
-	    vertexp->user(0);
-	}
+	m_dfs.assign(m_csr.size(), 0);
+	m_color.assign(m_csr.size(), 0);
+	m_first.assign(2*m_csr.size()+2, 0);
+	m_comp.assign(m_csr.size(), 0);
 	// Color graph
-	for (V3GraphVertex* vertexp = m_graphp->verticesBeginp(); vertexp; vertexp=vertexp->verticesNextp()) {
-	    if (!vertexp->user()) {
-		m_currentDfs++;
-		vertexIterate(vertexp);
-	    }
+	if (GraphParallel::chunks(m_csr.size()) > 1) {
+	    mainParallel();
+	} else {
+	    vector<uint32_t> vertices (m_csr.size());
+	    for (uint32_t vtx = 0; vtx < m_csr.size(); ++vtx) vertices[vtx] = vtx;
+	    tarjan(vertices);
 	}
 	// If there's a single vertex of a color, it doesn't need a subgraph
 	// This simplifies the consumer's code, and reduces graph debugging clutter
-	for (V3GraphVertex* vertexp = m_graphp->verticesBeginp(); vertexp; vertexp=vertexp->verticesNextp()) {
+	for (uint32_t vtx = 0; vtx < m_csr.size(); ++vtx) {
 	    bool onecolor = true;
-	    for (V3GraphEdge* edgep = vertexp->outBeginp(); edgep; edgep=edgep->outNextp()) {
-		if (followEdge(edgep)) {
-		    if (vertexp->color() == edgep->top()->color()) {
-			onecolor = false;
-			break;
-		    }
+	    for (uint32_t edge = m_csr.outBegin(vtx); edge < m_csr.outEnd(vtx); ++edge) {
+		if (m_comp[vtx] == m_comp[m_csr.outTo(edge)]) {
+		    onecolor = false;
+		    break;
 		}
 	    }
-	    if (onecolor) vertexp->color(0);
+	    if (onecolor) m_comp[vtx] = 0;
+	}
+	// Write back to the graph
+	for (uint32_t vtx = 0; vtx < m_csr.size(); ++vtx) {
+	    m_csr.vertexp(vtx)->color(m_comp[vtx]);
 	}
     }
 
-    void vertexIterate(V3GraphVertex* vertexp) {
+    void tarjan(const vector<uint32_t>& vertices) {
+	// Use Tarjan's algorithm to find the strongly connected subgraphs
+	// Vertices must be in ascending order, and if m_part is used all in one partition.
+	for (vector<uint32_t>::const_iterator it = vertices.begin(); it != vertices.end(); ++it) {
+	    if (!m_dfs[*it]) {
+		m_currentDfs++;
+		vertexIterate(*it);
+	    }
+	}
+	for (vector<uint32_t>::const_iterator it = vertices.begin(); it != vertices.end(); ++it) {
+	    uint32_t& firstr = m_first[m_color[*it]];
+	    if (!firstr) firstr = *it + 1;
+	    m_comp[*it] = firstr;
+	}
+    }
+
+    void vertexIterate(uint32_t vtx) {
 	uint32_t thisDfsNum = m_currentDfs++;
-	vertexp->user(thisDfsNum);
-	vertexp->color(0);
-	for (V3GraphEdge* edgep = vertexp->outBeginp(); edgep; edgep=edgep->outNextp()) {
-	    if (followEdge(edgep)) {
-		V3GraphVertex* top = edgep->top();
-		if (!top->user()) {  // Dest not computed yet
-		    vertexIterate(top);
-		}
-		if (!top->color()) { // Dest not in a component
-		    if (vertexp->user() > top->user()) vertexp->user(top->user());
-		}
+	m_dfs[vtx] = thisDfsNum;
+	m_color[vtx] = 0;
+	for (uint32_t edge = m_csr.outBegin(vtx); edge < m_csr.outEnd(vtx); ++edge) {
+	    uint32_t to = m_csr.outTo(edge);
+	    if (!m_part.empty() && m_part[to] != m_part[vtx]) continue;  // Outside partition
+	    if (!m_dfs[to]) {  // Dest not computed yet
+		vertexIterate(to);
+	    }
+	    if (!m_color[to]) { // Dest not in a component
+		if (m_dfs[vtx] > m_dfs[to]) m_dfs[vtx] = m_dfs[to];
 	    }
 	}
-	if (vertexp->user() == thisDfsNum) { // New head of subtree
-	    vertexp->color(thisDfsNum); // Mark as component
+	if (m_dfs[vtx] == thisDfsNum) { // New head of subtree
+	    m_color[vtx] = thisDfsNum; // Mark as component
 	    while (!m_callTrace.empty()) {
-		V3GraphVertex* popVertexp = m_callTrace.back();
-		if (popVertexp->user() >= thisDfsNum) { // Lower node is part of this subtree
+		uint32_t popVtx = m_callTrace.back();
+		if (m_dfs[popVtx] >= thisDfsNum) { // Lower node is part of this subtree
 		    m_callTrace.pop_back();
-		    popVertexp->color(thisDfsNum);
+		    m_color[popVtx] = thisDfsNum;
 		} else {
 		    break;
 		}
 	    }
 	} else { // In another subtree (maybe...)
-	    m_callTrace.push_back(vertexp);
+	    m_callTrace.push_back(vtx);
+	}
+    }
+
+    void mainParallel() {
+	// Forward-backward decomposition.  First peel off vertices with no
+	// inputs, or no outputs, as they can't be in a loop.  Then take the
+	// lowest vertex of a partition; the vertices both reachable from it and
+	// reaching it are its component, and the remaining vertices split into
+	// three partitions that can't share a component.
+	m_csr.addInEdges();
+	m_part.assign(m_csr.size(), 1);
+	{
+	    vector<uint32_t> waiting (m_csr.size());
+	    vector<uint32_t> frontier;
+	    for (uint32_t vtx = 0; vtx < m_csr.size(); ++vtx) {
+		waiting[vtx] = m_csr.inCount(vtx);
+		if (!waiting[vtx]) { frontier.push_back(vtx); m_part[vtx] = 0; }
+	    }
+	    GraphPeelTask(m_csr, false, waiting, &m_part, NULL).walk(frontier);
+	    for (uint32_t vtx = 0; vtx < m_csr.size(); ++vtx) {
+		if (!m_part[vtx]) continue;
+		waiting[vtx] = 0;
+		for (uint32_t edge = m_csr.outBegin(vtx); edge < m_csr.outEnd(vtx); ++edge) {
+		    if (m_part[m_csr.outTo(edge)]) waiting[vtx]++;
+		}
+		if (!waiting[vtx]) frontier.push_back(vtx);
+	    }
+	    for (vector<uint32_t>::iterator it = frontier.begin(); it != frontier.end(); ++it) m_part[*it] = 0;
+	    GraphPeelTask(m_csr, true, waiting, &m_part, NULL).walk(frontier);
+	}
+	vector<vector<uint32_t> > work;
+	work.push_back(vector<uint32_t>());
+	for (uint32_t vtx = 0; vtx < m_csr.size(); ++vtx) {
+	    if (m_part[vtx]) work.back().push_back(vtx);
+	    else m_comp[vtx] = vtx + 1;
+	}
+	UINFO(9,"  Strongly trimmed to "<<work.back().size()<<" vertices"<<endl);
+	vector<uint32_t> fwdMark (m_csr.size(), 0);
+	vector<uint32_t> bwdMark (m_csr.size(), 0);
+	uint32_t stamp = 0;
+	uint32_t nextLabel = 2;
+	while (!work.empty()) {
+	    vector<uint32_t> vertices;
+	    vertices.swap(work.back());
+	    work.pop_back();
+	    if (vertices.empty()) continue;
+	    if (GraphParallel::chunks(vertices.size()) <= 1) {
+		tarjan(vertices);
+		continue;
+	    }
+	    uint32_t pivot = vertices.front();
+	    uint32_t label = m_part[pivot];
+	    ++stamp;
+	    fwdMark[pivot] = stamp;
+	    bwdMark[pivot] = stamp;
+	    vector<uint32_t> frontier (1, pivot);
+	    GraphReachTask(m_csr, false, m_part, label, fwdMark, stamp).walk(frontier);
+	    frontier.assign(1, pivot);
+	    GraphReachTask(m_csr, true, m_part, label, bwdMark, stamp).walk(frontier);
+	    vector<uint32_t> fwdOnly, bwdOnly, neither;
+	    for (vector<uint32_t>::iterator it = vertices.begin(); it != vertices.end(); ++it) {
+		bool fwd = fwdMark[*it] == stamp;
+		bool bwd = bwdMark[*it] == stamp;
+		if (fwd && bwd) m_comp[*it] = pivot + 1;
+		else if (fwd) fwdOnly.push_back(*it);
+		else if (bwd) bwdOnly.push_back(*it);
+		else neither.push_back(*it);
+	    }
+	    splitPart(work, fwdOnly, nextLabel++);
+	    splitPart(work, bwdOnly, nextLabel++);
+	    splitPart(work, neither, nextLabel++);
 	}
+	m_part.clear();
+    }
+    void splitPart(vector<vector<uint32_t> >& work, vector<uint32_t>& vertices, uint32_t label) {
+	if (vertices.empty()) return;
+	for (vector<uint32_t>::iterator it = vertices.begin(); it != vertices.end(); ++it) m_part[*it] = label;
+	work.push_back(vector<uint32_t>());
+	work.back().swap(vertices);
     }
 public:
     GraphAlgStrongly(V3Graph* graphp, V3EdgeFuncP edgeFuncp)
-	: GraphAlg(graphp, edgeFuncp) {
+	: GraphAlg(graphp, edgeFuncp), m_csr(graphp, edgeFuncp) {
 	m_currentDfs = 0;
 	main();
     }
@@ -271,43 +604,72 @@ void V3Graph::stronglyConnected(V3EdgeFuncP edgeFuncp) {
 
 class GraphAlgRank : GraphAlg {
 private:
+    V3GraphCsr	m_csr;			// Snapshot of graph
+    vector<uint8_t> m_state;		// Each vertex's 1 indicates processing, 2 indicates completed
+    vector<uint32_t> m_rank;		// Each vertex's rank
+
     void main() {
 	// Rank each vertex, ignoring cutable edges
-	// Vertex::m_user begin: 1 indicates processing, 2 indicates completed
 	// Clear existing ranks
-	for (V3GraphVertex* vertexp = m_graphp->verticesBeginp(); vertexp; vertexp=vertexp->verticesNextp()) {
-	    vertexp->rank(0);
-	    vertexp->user(0);
-	}
-	for (V3GraphVertex* vertexp = m_graphp->verticesBeginp(); vertexp; vertexp=vertexp->verticesNextp()) {
-	    if (!vertexp->user()) {
-		vertexIterate(vertexp,1);
+	m_state.assign(m_csr.size(), 0);
+	m_rank.assign(m_csr.size(), 0);
+	if (GraphParallel::chunks(m_csr.size()) <= 1 || !mainParallel()) {
+	    for (uint32_t vtx = 0; vtx < m_csr.size(); ++vtx) {
+		if (!m_state[vtx]) {
+		    vertexIterate(vtx,1);
+		}
 	    }
 	}
+	// Write back to the graph
+	for (uint32_t vtx = 0; vtx < m_csr.size(); ++vtx) {
+	    m_csr.vertexp(vtx)->user(m_state[vtx]);
+	    m_csr.vertexp(vtx)->rank(m_rank[vtx]);
+	}
     }
 
-    void vertexIterate(V3GraphVertex* vertexp, uint32_t currentRank) {
+    void vertexIterate(uint32_t vtx, uint32_t currentRank) {
 	// Assign rank to each unvisited node
 	// If larger rank is found, assign it and loop back through
 	// If we hit a back node make a list of all loops
-	if (vertexp->user() == 1) {
+	if (m_state[vtx] == 1) {
+	    V3GraphVertex* vertexp = m_csr.vertexp(vtx);
 	    m_graphp->reportLoops(m_edgeFuncp, vertexp);
 	    m_graphp->loopsMessageCb(vertexp);
 	    return;
 	}
-	if (vertexp->rank() >= currentRank) return;  // Already processed it
-	vertexp->user(1);
-	vertexp->rank(currentRank);
-	for (V3GraphEdge* edgep = vertexp->outBeginp(); edgep; edgep=edgep->outNextp()) {
-	    if (followEdge(edgep)) {
-		vertexIterate(edgep->top(),currentRank+1);
+	if (m_rank[vtx] >= currentRank) return;  // Already processed it
+	m_state[vtx] = 1;
+	m_rank[vtx] = currentRank;
+	for (uint32_t edge = m_csr.outBegin(vtx); edge < m_csr.outEnd(vtx); ++edge) {
+	    vertexIterate(m_csr.outTo(edge),currentRank+1);
+	}
+	m_state[vtx] = 2;
+    }
+
+    bool mainParallel() {
+	// Level synchronous: a vertex is ranked one past its last input to be ranked,
+	// which gives the same longest path ranks as the depth first walk.
+	// Returns false if there's a loop, for the depth first walk to report.
+	vector<uint32_t> waiting (m_csr.size());
+	vector<uint32_t> frontier;
+	for (uint32_t vtx = 0; vtx < m_csr.size(); ++vtx) {
+	    waiting[vtx] = m_csr.inCount(vtx);
+	    if (!waiting[vtx]) {
+		frontier.push_back(vtx);
+		m_rank[vtx] = 1;
 	    }
 	}
-	vertexp->user(2);
+	uint32_t ranked = GraphPeelTask(m_csr, false, waiting, NULL, &m_rank).walk(frontier);
+	if (ranked != m_csr.size()) {
+	    m_rank.assign(m_csr.size(), 0);
+	    return false;
+	}
+	m_state.assign(m_csr.size(), 2);
+	return true;
     }
 public:
     GraphAlgRank(V3Graph* graphp, V3EdgeFuncP edgeFuncp)
-	: GraphAlg(graphp, edgeFuncp) {
+	: GraphAlg(graphp, edgeFuncp), m_csr(graphp, edgeFuncp) {
 	main();
     }
     ~GraphAlgRank() {}
@@ -509,11 +871,18 @@ void V3Graph::order() {
     rank(&V3GraphEdge::followAlwaysTrue);
 
     // Compute fanouts
-    // Vertex::m_user begin: 1 indicates processing, 2 indicates completed
-    userClearVertices();
-    for (V3GraphVertex* vertexp = verticesBeginp(); vertexp; vertexp=vertexp->verticesNextp()) {
-	if (!vertexp->user()) {
-	    orderDFSIterate(vertexp);
+    {
+	V3GraphCsr csr (this, &V3GraphEdge::followAlwaysTrue);
+	vector<uint8_t> state (csr.size(), 0);  // 1 indicates processing, 2 indicates completed
+	vector<double> fanouts (csr.size(), 0);
+	for (uint32_t vtx = 0; vtx < csr.size(); ++vtx) {
+	    if (!state[vtx]) {
+		orderDFSIterate(csr, state, fanouts, vtx);
+	    }
+	}
+	for (uint32_t vtx = 0; vtx < csr.size(); ++vtx) {
+	    csr.vertexp(vtx)->user(state[vtx]);
+	    csr.vertexp(vtx)->fanout(fanouts[vtx]);
 	}
     }
 
@@ -525,21 +894,20 @@ void V3Graph::order() {
     sortEdges();
 }
 
-double V3Graph::orderDFSIterate(V3GraphVertex* vertexp) {
+double V3Graph::orderDFSIterate(const V3GraphCsr& csr, vector<uint8_t>& state,
+				vector<double>& fanouts, uint32_t vtx) {
     // Compute fanouts of each node
     // If forward edge, don't double count that fanout
-    if (vertexp->user() == 2) return vertexp->fanout();  // Already processed it
-    if (vertexp->user() == 1) v3fatalSrc("Loop found, backward edges should be dead");
-    vertexp->user(1);
+    if (state[vtx] == 2) return fanouts[vtx];  // Already processed it
+    if (state[vtx] == 1) v3fatalSrc("Loop found, backward edges should be dead");
+    state[vtx] = 1;
     double fanout = 0;
-    for (V3GraphEdge* edgep = vertexp->outBeginp(); edgep; edgep = edgep->outNextp()) {
-	if (edgep->weight()) fanout += orderDFSIterate(edgep->m_top);
+    for (uint32_t edge = csr.outBegin(vtx); edge < csr.outEnd(vtx); ++edge) {
+	fanout += orderDFSIterate(csr, state, fanouts, csr.outTo(edge));
     }
     // Just count inbound edges
-    for (V3GraphEdge* edgep = vertexp->inBeginp(); edgep; edgep = edgep->inNextp()) {
-	if (edgep->weight()) fanout ++;
-    }
-    vertexp->fanout(fanout);
-    vertexp->user(2);
-    return vertexp->fanout();
+    fanout += csr.inCount(vtx);
+    fanouts[vtx] = fanout;
+    state[vtx] = 2;
+    return fanout;
 }
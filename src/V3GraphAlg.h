@@ -43,6 +43,37 @@ protected:
     ~GraphAlg() {}
 };
 
+//=============================================================================
+// Compressed sparse row snapshot of a graph
+// Read-only; the followed outbound edges of each vertex are stored
+// contiguously as target vertex numbers, in the graph's own vertex and edge
+// order, so algorithms run on it visit the graph exactly as they would by
+// walking the linked lists.  Results are written back to the V3GraphVertexes;
+// any edit to the graph requires a new snapshot.
+
+class V3GraphCsr {
+    vector<V3GraphVertex*>	m_vertices;	// Vertex for each vertex number
+    vector<uint32_t>		m_outBegin;	// Index into m_outTo of vertex's first edge, plus end
+    vector<uint32_t>		m_outTo;	// Target vertex number of each edge
+    vector<uint32_t>		m_inCount;	// Number of followed inbound edges of each vertex
+    vector<uint32_t>		m_inBegin;	// Index into m_inFrom of vertex's first edge, plus end
+    vector<uint32_t>		m_inFrom;	// Source vertex number of each inbound edge
+public:
+    // Vertex::m_user is clobbered
+    V3GraphCsr(V3Graph* graphp, V3EdgeFuncP edgeFuncp);
+    ~V3GraphCsr() {}
+    void addInEdges();	// Also pack inbound edges, for walking backwards
+    uint32_t size() const { return m_vertices.size(); }
+    V3GraphVertex* vertexp(uint32_t vtx) const { return m_vertices[vtx]; }
+    uint32_t outBegin(uint32_t vtx) const { return m_outBegin[vtx]; }
+    uint32_t outEnd(uint32_t vtx) const { return m_outBegin[vtx+1]; }
+    uint32_t outTo(uint32_t edge) const { return m_outTo[edge]; }
+    uint32_t inCount(uint32_t vtx) const { return m_inCount[vtx]; }
+    uint32_t inBegin(uint32_t vtx) const { return m_inBegin[vtx]; }
+    uint32_t inEnd(uint32_t vtx) const { return m_inBegin[vtx+1]; }
+    uint32_t inFrom(uint32_t edge) const { return m_inFrom[edge]; }
+};
+
 //============================================================================
 
 #endif // Guard
@@ -22,6 +22,8 @@
 //	    Hash each node depth first
 //		Hash includes varp name and operator type, and constants
 //		Form lookup table based on hash of each statement  w/ nodep and next nodep
+//	    Lookup table is keyed by a 64 bit hash of the whole tree, so that
+//	    few unequal trees share a bucket and need a sameTree compare
 //
 //*************************************************************************
 
@@ -47,11 +49,13 @@ class HashedVisitor : public AstNVisitor {
 private:
     // NODE STATE
     // Entire netlist:
-    //  AstNodeStmt::user4()	-> V3Hash.  Hash value of this node (hash of 0 is illegal)
+    //  AstNodeStmt::user4()	-> int.  Index+1 of V3Hashed entry (0 is unhashed)
     //AstUser4InUse	in V3Hashed.h
 
     // STATE
+    V3Hashed*		m_hashedp;	// Where node hashes are stored
     V3Hash		m_lowerHash;	// Hash of the statement we're building
+    V3Hashed::Key	m_lowerKey;	// Structural hash of the statement we're building
 
     static int debug() {
 	static int level = -1;
@@ -60,6 +64,10 @@ private:
     }
 
     // METHODS
+    static inline V3Hashed::Key keyMix(V3Hashed::Key key, vluint64_t value) {
+	key = (key ^ (value + VL_ULL(0x9e3779b97f4a7c15))) * VL_ULL(0xff51afd7ed558ccd);
+	return key ^ (key >> 32);
+    }
     void nodeHashIterate(AstNode* nodep) {
 	if (!nodep->user4()) {
 	    if (nodep->backp()->castCFunc()
@@ -67,23 +75,29 @@ private:
 		nodep->v3fatalSrc("Node "<<nodep->prettyTypeName()<<" in statement position but not marked stmt (node under function)");
 	    }
 	    V3Hash oldHash = m_lowerHash;
+	    V3Hashed::Key oldKey = m_lowerKey;
 	    {
-		m_lowerHash = nodep->sameHash();
-		if (m_lowerHash.isIllegal()) {
+		V3Hash sameHash = nodep->sameHash();
+		if (sameHash.isIllegal()) {
 		    nodep->v3fatalSrc("sameHash function undefined (returns 0) for node under CFunc.");
 		}
 		// For identical nodes, the type should be the same thus dtypep should be the same too
-		m_lowerHash = V3Hash(m_lowerHash, V3Hash(nodep->type()<<6, V3Hash(nodep->dtypep())));
+		m_lowerHash = V3Hash(sameHash, V3Hash(nodep->type()<<6, V3Hash(nodep->dtypep())));
+		m_lowerKey = keyMix(keyMix(keyMix(0, nodep->type()),
+					   (vluint64_t)(size_t)(nodep->dtypep())),
+				    sameHash.fullValue());
 		// Now update m_lowerHash for our children's (and next children) contributions
 		nodep->iterateChildren(*this);
 		// Store the hash value
-		nodep->user4(m_lowerHash.fullValue());
+		m_hashedp->setEntry(nodep, m_lowerHash, m_lowerKey);
 		//UINFO(9, "    hashnode "<<m_lowerHash<<"  "<<nodep<<endl);
 	    }
 	    m_lowerHash = oldHash;
+	    m_lowerKey = oldKey;
 	}
 	// Update what will become the above node's hash
-	m_lowerHash += V3Hashed::nodeHash(nodep);
+	m_lowerHash += m_hashedp->nodeHash(nodep);
+	m_lowerKey = keyMix(m_lowerKey, m_hashedp->nodeKey(nodep));
     }
 
     //--------------------
@@ -97,9 +111,11 @@ private:
 
 public:
     // CONSTUCTORS
-    explicit HashedVisitor(AstNode* nodep) {
+    HashedVisitor(V3Hashed* hashedp, AstNode* nodep) {
+	m_hashedp = hashedp;
+	m_lowerKey = 0;
 	nodeHashIterate(nodep);
-	//UINFO(9,"  stmthash "<<hex<<V3Hashed::nodeHash(nodep)<<"  "<<nodep<<endl);
+	//UINFO(9,"  stmthash "<<hex<<m_hashedp->nodeHash(nodep)<<"  "<<nodep<<endl);
     }
     virtual ~HashedVisitor() {}
 };
@@ -109,29 +125,30 @@ public:
 
 V3Hashed::iterator V3Hashed::hashAndInsert(AstNode* nodep) {
     hash(nodep);
-    return m_hashMmap.insert(make_pair(nodeHash(nodep), nodep));
+    return m_hashMmap.insert(make_pair(nodeKey(nodep), nodep));
 }
 
 void V3Hashed::hash(AstNode* nodep) {
     UINFO(8,"   hashI "<<nodep<<endl);
-    if (!nodep->user4p()) {
-	HashedVisitor visitor (nodep);
+    if (!nodep->user4()) {
+	HashedVisitor visitor (this, nodep);
     }
 }
 
 bool V3Hashed::sameNodes(AstNode* node1p, AstNode* node2p) {
-    if (!node1p->user4p()) node1p->v3fatalSrc("Called isIdentical on non-hashed nodes");
-    if (!node2p->user4p()) node2p->v3fatalSrc("Called isIdentical on non-hashed nodes");
-    return (node1p->user4p() == node2p->user4p()  // Same hash
+    if (!node1p->user4()) node1p->v3fatalSrc("Called isIdentical on non-hashed nodes");
+    if (!node2p->user4()) node2p->v3fatalSrc("Called isIdentical on non-hashed nodes");
+    return (nodeKey(node1p) == nodeKey(node2p)  // Same hash
+	    && nodeHash(node1p) == nodeHash(node2p)
 	    && node1p->sameTree(node2p));
 }
 
 void V3Hashed::erase(iterator it) {
     AstNode* nodep = iteratorNodep(it);
     UINFO(8,"   erase "<<nodep<<endl);
-    if (!nodep->user4p()) nodep->v3fatalSrc("Called removeNode on non-hashed node");
+    if (!nodep->user4()) nodep->v3fatalSrc("Called removeNode on non-hashed node");
     m_hashMmap.erase(it);
-    nodep->user4p(NULL);   // So we don't allow removeNode again
+    nodep->user4(0);   // So we don't allow removeNode again
 }
 
 void V3Hashed::dumpFilePrefixed(const string& nameComment, bool tree) {
@@ -146,7 +163,7 @@ void V3Hashed::dumpFile(const string& filename, bool tree) {
 
     map<int,int> dist;
 
-    V3Hash lasthash;
+    Key lasthash = 0;
     int num_in_bucket = 0;
     for (HashMmap::iterator it=begin(); 1; ++it) {
 	if (lasthash != it->first || it==end()) {
@@ -173,7 +190,7 @@ void V3Hashed::dumpFile(const string& filename, bool tree) {
     for (HashMmap::iterator it=begin(); it!=end(); ++it) {
 	if (lasthash != it->first) {
 	    lasthash = it->first;
-	    *logp <<"    "<<it->first<<endl;
+	    *logp <<"    "<<hex<<setw(16)<<setfill('0')<<it->first<<setfill(' ')<<dec<<endl;
 	}
 	*logp <<"\t"<<it->second<<endl;
 	// Dumping the entire tree may make nearly N^2 sized dumps,
@@ -184,8 +201,8 @@ void V3Hashed::dumpFile(const string& filename, bool tree) {
 
 V3Hashed::iterator V3Hashed::findDuplicate(AstNode* nodep) {
     UINFO(8,"   findD "<<nodep<<endl);
-    if (!nodep->user4p()) nodep->v3fatalSrc("Called findDuplicate on non-hashed node");
-    pair <HashMmap::iterator,HashMmap::iterator> eqrange = mmap().equal_range(nodeHash(nodep));
+    if (!nodep->user4()) nodep->v3fatalSrc("Called findDuplicate on non-hashed node");
+    pair <HashMmap::iterator,HashMmap::iterator> eqrange = mmap().equal_range(nodeKey(nodep));
     for (HashMmap::iterator eqit = eqrange.first; eqit != eqrange.second; ++eqit) {
 	AstNode* node2p = eqit->second;
 	if (nodep != node2p && sameNodes(nodep, node2p)) {
@@ -197,8 +214,8 @@ V3Hashed::iterator V3Hashed::findDuplicate(AstNode* nodep) {
 
 V3Hashed::iterator V3Hashed::findDuplicate(AstNode* nodep, V3HashedUserCheck* checkp) {
     UINFO(8,"   findD "<<nodep<<endl);
-    if (!nodep->user4p()) nodep->v3fatalSrc("Called findDuplicate on non-hashed node");
-    pair <HashMmap::iterator,HashMmap::iterator> eqrange = mmap().equal_range(nodeHash(nodep));
+    if (!nodep->user4()) nodep->v3fatalSrc("Called findDuplicate on non-hashed node");
+    pair <HashMmap::iterator,HashMmap::iterator> eqrange = mmap().equal_range(nodeKey(nodep));
     for (HashMmap::iterator eqit = eqrange.first; eqit != eqrange.second; ++eqit) {
 	AstNode* node2p = eqit->second;
 	if (nodep != node2p && checkp->check(nodep,node2p) && sameNodes(nodep, node2p)) {
@@ -26,6 +26,7 @@
 #include "V3Ast.h"
 
 #include <map>
+#include <vector>
 
 //============================================================================
 
@@ -54,17 +55,32 @@ struct V3HashedUserCheck {
 
 class V3Hashed : public VHashedBase {
     // NODE STATE
-    //  AstNode::user4()	-> V3Hash.  Hash value of this node (hash of 0 is illegal)
+    //  AstNode::user4()	-> int.  Index+1 into m_entries of the node's hashes (0 is unhashed)
     AstUser4InUse	m_inuser4;
 
     // TYPES
-    typedef multimap<V3Hash,AstNode*> HashMmap;
+public:
+    typedef vluint64_t Key;	// Structural hash used as the map key
+private:
+    struct Entry {
+	V3Hash		m_hash;		// Node count and 24 bit hash, as computed by sameHash()
+	Key		m_key;		// 64 bit hash of the entire tree
+	Entry(V3Hash hash, Key key) : m_hash(hash), m_key(key) {}
+    };
+    typedef multimap<Key,AstNode*> HashMmap;
 public:
     typedef HashMmap::iterator iterator;
 private:
     // MEMBERS
     HashMmap		m_hashMmap;	// hashvalue -> nodes with that hash
+    vector<Entry>	m_entries;	// Hashes of each hashed node, cloned nodes share them
 
+    friend class HashedVisitor;
+    const Entry& entry(AstNode* nodep) const { return m_entries[nodep->user4()-1]; }
+    void setEntry(AstNode* nodep, V3Hash hash, Key key) {
+	m_entries.push_back(Entry(hash, key));
+	nodep->user4(m_entries.size());
+    }
 public:
     // CONSTRUCTORS
     V3Hashed() { clear(); }
@@ -76,7 +92,7 @@ public:
     iterator end() { return m_hashMmap.end(); }
 
     // METHODS
-    void clear() { m_hashMmap.clear(); AstNode::user4ClearTree(); }
+    void clear() { m_hashMmap.clear(); m_entries.clear(); AstNode::user4ClearTree(); }
     iterator hashAndInsert(AstNode* nodep);	// Hash the node, and insert into map. Return iterator to inserted
     void hash(AstNode* nodep);	// Only hash the node
     bool sameNodes(AstNode* node1p, AstNode* node2p);	// After hashing, and tell if identical
@@ -86,7 +102,8 @@ public:
     AstNode* iteratorNodep(iterator it) { return it->second; }
     void dumpFile(const string& filename, bool tree);
     void dumpFilePrefixed(const string& nameComment, bool tree=false);
-    static V3Hash nodeHash(AstNode* nodep) { return V3Hash(nodep->user4p()); }
+    V3Hash nodeHash(AstNode* nodep) const { return entry(nodep).m_hash; }
+    Key nodeKey(AstNode* nodep) const { return entry(nodep).m_key; }	// Key of hashed node in mmap()
 };
 
 #endif // Guard
@@ -35,15 +35,21 @@
 #include <unistd.h>
 #include <algorithm>
 #include <vector>
+#include <map>
+#include <fstream>
+#include <memory>
+#include <sstream>
 
 #include "V3Global.h"
 #include "V3Inline.h"
 #include "V3Inst.h"
 #include "V3Stats.h"
+#include "V3File.h"
 #include "V3Ast.h"
 
 // CONFIG
 static const int INLINE_MODS_SMALLER = 100;	// If a mod is < this # nodes, can always inline it
+static const double INLINE_HOT_PERCENT = 1.0;	// If a mod takes >= this % of profiled time, it is hot
 
 //######################################################################
 // Inline state, as a visitor of each AstNode
@@ -65,9 +71,18 @@ private:
 	  CIL_MAYBE};		// For user2, might inline
 
     // STATE
+    typedef map<AstNodeModule*,double> ModInstMap;
+    typedef map<string,double> ModShareMap;
     AstNodeModule*	m_modp;		// Flattened cell's containing module
     int			m_stmtCnt;	// Statements in module
+    int			m_workCnt;	// Statements in module evaluated each time it's scheduled
+    ModInstMap		m_modInsts;	// Instances of each module in the hierarchy
+    ModShareMap		m_profShares;	// Percent of profiled time in each module, by name
     V3Double0		m_statUnsup;	// Statistic tracking
+    V3Double0		m_statInlined;	// Statistic tracking
+    V3Double0		m_statHot;	// Statistic tracking
+    V3Double0		m_statBudget;	// Statistic tracking
+    V3Double0		m_statGrowth;	// Statistic tracking
 
     // METHODS
     static int debug() {
@@ -90,10 +105,53 @@ private:
 	}
     }
 
+    void readProfile(const string& filename) {
+	// Read per-function times written by --profile-counters, and total by module
+	// Functions are named {prefix}_{module}::{function}; the top module is
+	// never inlined so it's ignored
+	const VL_UNIQUE_PTR<ifstream> ifp (V3File::new_ifstream_nodepend(filename));
+	if (ifp->fail()) {
+	    v3fatal("Cannot open --inline-profile file: "<<filename);
+	    return;
+	}
+	string modPrefix = v3Global.opt.prefix()+"_";
+	double totalTicks = 0;
+	string line;
+	while (getline(*ifp, line)) {
+	    if (line.compare(0, 6, "cfunc ") != 0) continue;
+	    istringstream is (line.substr(6));
+	    double calls = 0; double selfTicks = 0; double ticks = 0;
+	    is>>calls>>selfTicks>>ticks;
+	    string name; getline(is, name);
+	    totalTicks += selfTicks;
+	    string::size_type pos = name.find("::");
+	    string::size_type start = name.find(modPrefix);
+	    if (pos != string::npos && start != string::npos && start < pos) {
+		start += modPrefix.length();
+		m_profShares[name.substr(start, pos-start)] += selfTicks;
+	    }
+	}
+	if (totalTicks == 0) {
+	    v3warn(EC_INFO, "No profile counters in --inline-profile file: "<<filename);
+	    return;
+	}
+	for (ModShareMap::iterator it = m_profShares.begin(); it != m_profShares.end(); ++it) {
+	    it->second = it->second * 100.0 / totalTicks;
+	}
+    }
+    bool isHot(AstNodeModule* nodep) const {
+	ModShareMap::const_iterator it = m_profShares.find(nodep->name());
+	return it != m_profShares.end() && it->second >= INLINE_HOT_PERCENT;
+    }
+
     // VISITORS
     virtual void visit(AstNodeModule* nodep) {
 	m_stmtCnt = 0;
+	m_workCnt = 0;
 	m_modp = nodep;
+	// Modules are in level order, so all cells instancing this one have been seen;
+	// if none it is a top module
+	if (m_modInsts.find(nodep) == m_modInsts.end()) m_modInsts[nodep] = 1;
 	m_modp->user2(CIL_MAYBE);
 	if (m_modp->castIface()) {
 	    // Inlining an interface means we no longer have a cell handle to resolve to.
@@ -107,24 +165,39 @@ private:
 	bool userinline = nodep->user1();
 	int allowed = nodep->user2();
 	int refs = nodep->user3();
+	double insts = m_modInsts[nodep];
 	// Should we automatically inline this module?
+	// Inlining makes a copy for each referencing cell, so costs refs*stmts new nodes.
 	// inlineMult = 2000 by default.  If a mod*#instances is < this # nodes, can inline it
+	// Hot modules, per --inline-profile, get the larger budget of --inline-mult-hot,
+	// as their calls cost the most time
+	bool hot = isHot(nodep);
+	int budget = hot ? v3Global.opt.inlineMultHot() : v3Global.opt.inlineMult();
+	bool inBudget = (refs==1
+			 || m_stmtCnt < INLINE_MODS_SMALLER
+			 || v3Global.opt.inlineMult() < 1
+			 || budget < 1
+			 || refs*m_stmtCnt < budget);
 	bool doit = ((allowed == CIL_NOTSOFT || allowed == CIL_MAYBE)
 		     && (userinline
-			 || ((allowed == CIL_MAYBE)
-			     && (refs==1
-				 || m_stmtCnt < INLINE_MODS_SMALLER
-				 || v3Global.opt.inlineMult() < 1
-				 || refs*m_stmtCnt < v3Global.opt.inlineMult()))));
+			 || ((allowed == CIL_MAYBE) && inBudget)));
 	// Packages aren't really "under" anything so they confuse this algorithm
 	if (nodep->castPackage()) doit = false;
 	UINFO(4, " Inline="<<doit<<" Possible="<<allowed<<" Usr="<<userinline<<" Refs="<<refs<<" Stmts="<<m_stmtCnt
-	      <<"  "<<nodep<<endl);
+	      <<" Insts="<<insts<<" Work="<<m_workCnt<<" Hot="<<hot<<"  "<<nodep<<endl);
+	if (doit) {
+	    ++m_statInlined;
+	    if (hot) ++m_statHot;
+	    m_statGrowth += (double)(refs-1) * m_stmtCnt;
+	} else if (allowed == CIL_MAYBE && !inBudget && !nodep->castPackage()) {
+	    ++m_statBudget;
+	}
 	nodep->user1(doit);
 	m_modp = NULL;
     }
     virtual void visit(AstCell* nodep) {
 	nodep->modp()->user3Inc();
+	m_modInsts[nodep->modp()] += m_modp ? m_modInsts[m_modp] : 1;
 	nodep->iterateChildren(*this);
     }
     virtual void visit(AstPragma* nodep) {
@@ -160,6 +233,7 @@ private:
     virtual void visit(AstAlways* nodep) {
 	nodep->iterateChildren(*this);
 	m_stmtCnt++;
+	m_workCnt++;
     }
     virtual void visit(AstNodeAssign* nodep) {
 	// Don't count assignments, as they'll likely flatten out
@@ -167,6 +241,7 @@ private:
 	int oldcnt = m_stmtCnt;
 	nodep->iterateChildren(*this);
 	m_stmtCnt = oldcnt;
+	m_workCnt++;
     }
     //--------------------
     // Default: Just iterate
@@ -180,10 +255,16 @@ public:
     explicit InlineMarkVisitor(AstNode* nodep) {
 	m_modp = NULL;
 	m_stmtCnt = 0;
+	m_workCnt = 0;
+	if (v3Global.opt.inlineProfile() != "") readProfile(v3Global.opt.inlineProfile());
 	nodep->accept(*this);
     }
     virtual ~InlineMarkVisitor() {
 	V3Stats::addStat("Optimizations, Inline unsupported", m_statUnsup);
+	V3Stats::addStat("Optimizations, Inlined modules", m_statInlined);
+	V3Stats::addStat("Optimizations, Inlined modules, hot", m_statHot);
+	V3Stats::addStat("Optimizations, Inline rejected, over budget", m_statBudget);
+	V3Stats::addStat("Optimizations, Inline estimated nodes added", m_statGrowth);
 	// Done with these, are not outputs
 	AstNode::user2ClearTree();
 	AstNode::user3ClearTree();
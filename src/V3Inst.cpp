@@ -159,7 +159,10 @@ class InstDeModVarVisitor : public AstNVisitor {
 private:
     // STATE
     typedef map<string,AstVar*> VarNameMap;
-    VarNameMap	m_modVarNameMap;	// Per module, name of cloned variables
+    typedef map<AstNodeModule*,VarNameMap> ModVarsMap;
+    ModVarsMap	m_modVarsMap;		// Per module, name of interface variables, reused across cells
+    VarNameMap*	m_modVarNameMapp;	// Current module's entry in m_modVarsMap
+    bool	m_dirty;		// Variables inserted since cache built, so rebuild
 
     static int debug() {
 	static int level = -1;
@@ -171,7 +174,7 @@ private:
     virtual void visit(AstVar* nodep) {
 	if (nodep->dtypep()->castIfaceRefDType()) {
 	    UINFO(8,"   dm-1-VAR    "<<nodep<<endl);
-	    insert(nodep);
+	    m_modVarNameMapp->insert(make_pair(nodep->name(), nodep));
 	}
 	nodep->iterateChildren(*this);
     }
@@ -185,27 +188,42 @@ public:
     // METHODS
     void insert(AstVar* nodep) {
 	UINFO(8,"    dmINSERT    "<<nodep<<endl);
-	m_modVarNameMap.insert(make_pair(nodep->name(), nodep));
+	m_modVarNameMapp->insert(make_pair(nodep->name(), nodep));
+	m_dirty = true;
     }
     AstVar* find(const string& name) {
-	VarNameMap::iterator it = m_modVarNameMap.find(name);
-	if (it != m_modVarNameMap.end()) {
+	VarNameMap::iterator it = m_modVarNameMapp->find(name);
+	if (it != m_modVarNameMapp->end()) {
 	    return it->second;
 	} else {
 	    return NULL;
 	}
     }
     void dump() {
-	for (VarNameMap::iterator it=m_modVarNameMap.begin(); it!=m_modVarNameMap.end(); ++it) {
+	for (VarNameMap::iterator it=m_modVarNameMapp->begin(); it!=m_modVarNameMapp->end(); ++it) {
 	    cout<<"-namemap: "<<it->first<<" -> "<<it->second<<endl;
 	}
     }
 public:
     // CONSTUCTORS
-    explicit InstDeModVarVisitor() {}
+    explicit InstDeModVarVisitor() {
+	m_modVarNameMapp = &m_modVarsMap[NULL];
+	m_dirty = false;
+    }
     void accept(AstNodeModule* nodep) {
+	// Many cells usually share a module, so only walk each module once
+	// unless a variable was since inserted, which may have changed the tree
+	if (m_dirty) {
+	    m_modVarsMap.clear();
+	    m_dirty = false;
+	}
+	ModVarsMap::iterator it = m_modVarsMap.find(nodep);
+	if (it != m_modVarsMap.end()) {
+	    m_modVarNameMapp = &it->second;
+	    return;
+	}
 	UINFO(8,"  dmMODULE    "<<nodep<<endl);
-	m_modVarNameMap.clear();
+	m_modVarNameMapp = &m_modVarsMap[nodep];
 	nodep->accept(*this);
     }
     virtual ~InstDeModVarVisitor() {}
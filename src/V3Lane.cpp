@@ -0,0 +1,515 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//*************************************************************************
+// DESCRIPTION: Verilator: Bit-parallel lane simulation
+//
+// Code available from: http://www.veripool.org/verilator
+//
+//*************************************************************************
+//
+// Copyright 2003-2017 by Wilson Snyder.  This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+//
+// Verilator is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+//*************************************************************************
+// V3Lane's Transformations:
+//
+// With --lanes, each 1-bit signal becomes 64 bits, bit N being the
+// signal's value in independent simulation N.  Signals must stay
+// 1-bit ("scalar", shared by all lanes) where a single value is
+// needed: clocks, selects, and the inputs of other statements, along
+// with any signal those are computed from.
+//
+// Mark:
+//	Find scalar signals, then propagate backwards through assignments
+//	and enclosing IF conditions.  Remaining 1-bit signals are widened.
+//
+// Each expression with a per-lane operand:
+//	AND/OR/XOR/XNOR/NOT	Widened, scalar operands replicated
+//	LOGAND/LOGOR/LOGNOT/LOGIF/LOGIFF/EQ/NEQ/LT/...
+//				Replaced with the bitwise equivalent
+//	REDOR/REDAND/REDXOR	Replaced with operand
+//	COND(lane, a, b)	OR(AND(lane,a), AND(NOT(lane),b))
+//	SEL(lane, 0, 1)		Replaced with operand
+//
+// IF(lane, then, else):
+//	ASSIGN(__Vlanemask, AND(outermask, lane))
+//	ASSIGN(__Vlanemask_else, AND(outermask, NOT(__Vlanemask)))
+//	then, with each ASSIGN(x, rhs)
+//	    -> ASSIGN(x, OR(AND(__Vlanemask, rhs), AND(NOT(__Vlanemask), x)))
+//	else, likewise under __Vlanemask_else
+//
+// This runs after V3Delayed, so nonblocking assignments are to the
+// __Vdly shadow, which already holds the value other lanes must keep.
+//
+//*************************************************************************
+
+#include "config_build.h"
+#include "verilatedos.h"
+#include <cstdio>
+#include <cstdarg>
+#include <unistd.h>
+#include <map>
+#include <vector>
+
+#include "V3Global.h"
+#include "V3Lane.h"
+#include "V3Ast.h"
+#include "V3Stats.h"
+
+//######################################################################
+
+class LaneBaseVisitor : public AstNVisitor {
+public:
+    enum { LANES = 64 };	// Simulations per signal
+
+    // METHODS
+    static int debug() {
+	static int level = -1;
+	if (VL_UNLIKELY(level < 0)) level = v3Global.opt.debugSrcLevel(__FILE__);
+	return level;
+    }
+    static bool isCandidate(AstVar* varp) {
+	// Could this variable hold one value per lane?
+	return (varp->dtypeSkipRefp()->castBasicDType()
+		&& varp->isBitLogic()
+		&& varp->width() == 1
+		&& !varp->isParam()
+		&& !varp->isFuncLocal()
+		&& !varp->isSc());
+    }
+};
+
+//######################################################################
+// Find the signals that must remain scalar
+
+class LaneMarkVisitor : public LaneBaseVisitor {
+private:
+    // NODE STATE
+    // Entire netlist (owned by LaneVisitor):
+    //  AstVar::user1()		-> bool.  Must stay scalar
+
+    // TYPES
+    typedef vector<AstVar*> VarList;
+    typedef map<AstVar*, VarList> DepMap;
+
+    // STATE
+    DepMap	m_deps;		// Variables each assigned variable is computed from
+    VarList	m_forced;	// Newly scalar variables, to propagate from
+    VarList	m_condVars;	// Variables read by enclosing IF conditions
+    VarList*	m_readsp;	// Variables read by current expression, or NULL
+    AstVar*	m_lhsVarp;	// Variable written by current assignment
+    bool	m_inForced;	// Under something that needs a single value
+    VarList&	m_candidates;	// Variables that may be widened
+
+    // METHODS
+    void force(AstVar* varp) {
+	if (!varp->user1()) {
+	    varp->user1(true);
+	    m_forced.push_back(varp);
+	}
+    }
+    void forceAll(const VarList& vars) {
+	for (VarList::const_iterator it = vars.begin(); it != vars.end(); ++it) force(*it);
+    }
+    void iterateForced(AstNode* nodep) {
+	bool lastForced = m_inForced;
+	m_inForced = true;
+	nodep->iterateAndNext(*this);
+	m_inForced = lastForced;
+    }
+    void propagate() {
+	while (!m_forced.empty()) {
+	    AstVar* varp = m_forced.back(); m_forced.pop_back();
+	    DepMap::iterator it = m_deps.find(varp);
+	    if (it != m_deps.end()) forceAll(it->second);
+	}
+    }
+
+    // VISITORS
+    virtual void visit(AstVar* nodep) {
+	if (isCandidate(nodep)) {
+	    m_candidates.push_back(nodep);
+	    if (nodep->isUsedClock()) force(nodep);
+	} else {
+	    force(nodep);  // Computed values must be scalar too
+	}
+    }
+    virtual void visit(AstNodeVarRef* nodep) {
+	AstVar* varp = nodep->varp();
+	if (m_inForced) force(varp);
+	else if (nodep->lvalue()) { if (!m_lhsVarp) m_lhsVarp = varp; }
+	else if (m_readsp) m_readsp->push_back(varp);
+    }
+    virtual void visit(AstNodeSenItem* nodep) {
+	iterateForced(nodep->op1p());
+	iterateForced(nodep->op2p());
+    }
+    virtual void visit(AstSel* nodep) {
+	nodep->fromp()->iterateAndNext(*this);
+	iterateForced(nodep->lsbp());
+	iterateForced(nodep->widthp());
+    }
+    virtual void visit(AstArraySel* nodep) {
+	nodep->fromp()->iterateAndNext(*this);
+	iterateForced(nodep->bitp());
+    }
+    virtual void visit(AstNodeAssign* nodep) {
+	VarList reads;
+	m_readsp = &reads;
+	m_lhsVarp = NULL;
+	nodep->iterateChildren(*this);
+	m_readsp = NULL;
+	if (!m_lhsVarp) return;
+	reads.insert(reads.end(), m_condVars.begin(), m_condVars.end());
+	if (m_lhsVarp->user1()) {
+	    forceAll(reads);  // Computing a scalar, so must be computed from scalars
+	}
+	VarList& deps = m_deps[m_lhsVarp];
+	deps.insert(deps.end(), reads.begin(), reads.end());
+	m_lhsVarp = NULL;
+    }
+    virtual void visit(AstNodeIf* nodep) {
+	VarList reads;
+	m_readsp = &reads;
+	nodep->condp()->iterateAndNext(*this);
+	m_readsp = NULL;
+	size_t lastSize = m_condVars.size();
+	m_condVars.insert(m_condVars.end(), reads.begin(), reads.end());
+	nodep->ifsp()->iterateAndNext(*this);
+	nodep->elsesp()->iterateAndNext(*this);
+	m_condVars.resize(lastSize);
+    }
+    virtual void visit(AstComment* nodep) {}
+    virtual void visit(AstNodeStmt* nodep) {
+	// $display, $finish, calls, loops etc. happen once, not per lane
+	forceAll(m_condVars);
+	iterateForced(nodep->op1p());
+	iterateForced(nodep->op2p());
+	iterateForced(nodep->op3p());
+	iterateForced(nodep->op4p());
+    }
+    //--------------------
+    virtual void visit(AstNode* nodep) {
+	nodep->iterateChildren(*this);
+    }
+
+public:
+    // CONSTUCTORS
+    LaneMarkVisitor(AstNetlist* nodep, VarList& candidates)
+	: m_candidates(candidates) {
+	m_readsp = NULL;
+	m_lhsVarp = NULL;
+	m_inForced = false;
+	nodep->accept(*this);
+	propagate();
+    }
+    virtual ~LaneMarkVisitor() {}
+};
+
+//######################################################################
+// Convert logic to operate on all lanes
+
+class LaneVisitor : public LaneBaseVisitor {
+private:
+    // NODE STATE
+    // Entire netlist:
+    //  AstVar::user1()		-> bool.  Must stay scalar (set by LaneMarkVisitor)
+    //  AstVar::user2()		-> bool.  Widened to lanes
+    //  AstNodeMath::user2()	-> bool.  Has a value per lane
+    AstUser1InUse	m_inuser1;
+    AstUser2InUse	m_inuser2;
+
+    // STATE
+    AstScope*		m_scopep;	// Current scope
+    AstVarScope*	m_maskVscp;	// Mask of lanes current statements apply to, or NULL
+    V3Double0		m_statWidened;	// Statistic tracking
+    V3Double0		m_statScalar;	// Statistic tracking
+    V3Double0		m_statIfs;	// Statistic tracking
+
+    // METHODS
+    static bool isLane(AstNode* nodep) { return nodep && nodep->user2(); }
+    static AstNode* setLane(AstNode* nodep) {
+	nodep->dtypeSetLogicSized(LANES, LANES, AstNumeric::UNSIGNED);
+	nodep->user2(true);
+	return nodep;
+    }
+    static AstConst* newLaneConst(FileLine* fl, bool value) {
+	V3Number num (fl, LANES, 0);
+	if (value) num.setAllBits1();
+	AstConst* constp = new AstConst(fl, num);
+	constp->user2(true);
+	return constp;
+    }
+    AstNode* newLaneRef(AstVarScope* vscp, bool lvalue) {
+	return setLane(new AstVarRef(vscp->fileline(), vscp, lvalue));
+    }
+    AstNode* liftp(AstNode* nodep, bool logical) {
+	// Replicate a scalar onto all lanes; nodep is unlinked
+	if (isLane(nodep)) return nodep;
+	FileLine* fl = nodep->fileline();
+	if (AstConst* constp = nodep->castConst()) {
+	    if (!constp->num().isFourState() && (logical || constp->width() == 1)) {
+		AstNode* newp = newLaneConst(fl, constp->num().isNeqZero());
+		pushDeletep(nodep); VL_DANGLING(nodep);
+		return newp;
+	    }
+	}
+	if (nodep->width() != 1) {
+	    if (!logical) {
+		nodep->v3error("Unsupported: --lanes: per-lane value used with "
+			       <<nodep->width()<<"-bit "<<nodep->prettyTypeName());
+		return nodep;
+	    }
+	    nodep = new AstRedOr(fl, nodep);
+	}
+	return setLane(new AstCond(fl, nodep, newLaneConst(fl, true), newLaneConst(fl, false)));
+    }
+    void liftChild(AstNode* childp, bool logical) {
+	if (!isLane(childp)) {
+	    AstNRelinker handle;
+	    childp->unlinkFrBack(&handle);
+	    handle.relink(liftp(childp, logical));
+	}
+    }
+    bool anyLane(AstNode* nodep) {
+	return (isLane(nodep->op1p()) || isLane(nodep->op2p())
+		|| isLane(nodep->op3p()) || isLane(nodep->op4p()));
+    }
+    void replaceLane(AstNode* nodep, AstNode* newp) {
+	setLane(newp);
+	nodep->replaceWith(newp); pushDeletep(nodep); VL_DANGLING(nodep);
+    }
+    AstVarScope* newMaskVscp(FileLine* fl) {
+	AstNodeModule* modp = m_scopep->modp();
+	string name = "__Vlanemask"+cvtToStr(modp->varNumGetInc());
+	AstVar* varp = new AstVar(fl, AstVarType::BLOCKTEMP, name, VFlagBitPacked(), LANES);
+	varp->user2(true);
+	modp->addStmtp(varp);
+	AstVarScope* vscp = new AstVarScope(fl, m_scopep, varp);
+	m_scopep->addVarp(vscp);
+	return vscp;
+    }
+
+    // Expressions
+    void visitBitwise(AstNode* nodep) {
+	nodep->iterateChildren(*this);
+	if (!anyLane(nodep)) return;
+	liftChild(nodep->op1p(), false);
+	if (nodep->op2p()) liftChild(nodep->op2p(), false);
+	setLane(nodep);
+    }
+    void visitReplace(AstNodeBiop* nodep, bool logical, bool invLhs, bool invRhs) {
+	// Replace with the bitwise operation newp, with the given inversions of its operands
+	nodep->iterateChildren(*this);
+	if (!anyLane(nodep)) return;
+	FileLine* fl = nodep->fileline();
+	AstNode* lhsp = liftp(nodep->lhsp()->unlinkFrBack(), logical);
+	AstNode* rhsp = liftp(nodep->rhsp()->unlinkFrBack(), logical);
+	if (invLhs) lhsp = setLane(new AstNot(fl, lhsp));
+	if (invRhs) rhsp = setLane(new AstNot(fl, rhsp));
+	AstNode* newp;
+	if (nodep->castLogAnd() || nodep->castLt() || nodep->castGt()) newp = new AstAnd(fl, lhsp, rhsp);
+	else if (nodep->castLogOr() || nodep->castLogIf()
+		 || nodep->castLte() || nodep->castGte()) newp = new AstOr(fl, lhsp, rhsp);
+	else if (nodep->castLogIff() || nodep->castEq() || nodep->castEqCase()) newp = new AstXnor(fl, lhsp, rhsp);
+	else newp = new AstXor(fl, lhsp, rhsp);
+	replaceLane(nodep, newp);
+    }
+    virtual void visit(AstAnd* nodep) { visitBitwise(nodep); }
+    virtual void visit(AstOr* nodep) { visitBitwise(nodep); }
+    virtual void visit(AstXor* nodep) { visitBitwise(nodep); }
+    virtual void visit(AstXnor* nodep) { visitBitwise(nodep); }
+    virtual void visit(AstNot* nodep) { visitBitwise(nodep); }
+    virtual void visit(AstLogAnd* nodep) { visitReplace(nodep, true, false, false); }
+    virtual void visit(AstLogOr* nodep) { visitReplace(nodep, true, false, false); }
+    virtual void visit(AstLogIf* nodep) { visitReplace(nodep, true, true, false); }
+    virtual void visit(AstLogIff* nodep) { visitReplace(nodep, true, false, false); }
+    virtual void visit(AstEq* nodep) { visitReplace(nodep, false, false, false); }
+    virtual void visit(AstEqCase* nodep) { visitReplace(nodep, false, false, false); }
+    virtual void visit(AstNeq* nodep) { visitReplace(nodep, false, false, false); }
+    virtual void visit(AstNeqCase* nodep) { visitReplace(nodep, false, false, false); }
+    virtual void visit(AstLt* nodep) { visitReplace(nodep, false, true, false); }
+    virtual void visit(AstLte* nodep) { visitReplace(nodep, false, true, false); }
+    virtual void visit(AstGt* nodep) { visitReplace(nodep, false, false, true); }
+    virtual void visit(AstGte* nodep) { visitReplace(nodep, false, false, true); }
+    virtual void visit(AstLogNot* nodep) {
+	nodep->iterateChildren(*this);
+	if (!anyLane(nodep)) return;
+	replaceLane(nodep, new AstNot(nodep->fileline(), nodep->lhsp()->unlinkFrBack()));
+    }
+    void visitReduce(AstNodeUniop* nodep, bool invert) {
+	nodep->iterateChildren(*this);
+	if (!anyLane(nodep)) return;
+	AstNode* lhsp = nodep->lhsp()->unlinkFrBack();  // Reduction of one bit
+	if (invert) lhsp = new AstNot(nodep->fileline(), lhsp);
+	replaceLane(nodep, lhsp);
+    }
+    virtual void visit(AstRedOr* nodep) { visitReduce(nodep, false); }
+    virtual void visit(AstRedAnd* nodep) { visitReduce(nodep, false); }
+    virtual void visit(AstRedXor* nodep) { visitReduce(nodep, false); }
+    virtual void visit(AstRedXnor* nodep) { visitReduce(nodep, true); }
+    virtual void visit(AstCond* nodep) {
+	nodep->iterateChildren(*this);
+	if (!anyLane(nodep)) return;
+	FileLine* fl = nodep->fileline();
+	if (!isLane(nodep->condp())) {
+	    liftChild(nodep->expr1p(), false);
+	    liftChild(nodep->expr2p(), false);
+	    setLane(nodep);
+	    return;
+	}
+	AstNode* condp = nodep->condp()->unlinkFrBack();
+	AstNode* expr1p = liftp(nodep->expr1p()->unlinkFrBack(), false);
+	AstNode* expr2p = liftp(nodep->expr2p()->unlinkFrBack(), false);
+	AstNode* ncondp = setLane(new AstNot(fl, condp->cloneTree(false)));
+	replaceLane(nodep, new AstOr(fl,
+				     setLane(new AstAnd(fl, condp, expr1p)),
+				     setLane(new AstAnd(fl, ncondp, expr2p))));
+    }
+    virtual void visit(AstSel* nodep) {
+	nodep->iterateChildren(*this);
+	if (!isLane(nodep->fromp())) return;
+	AstConst* lsbp = nodep->lsbp()->castConst();
+	if (!lsbp || lsbp->toUInt() != 0 || nodep->width() != 1) {
+	    nodep->v3error("Unsupported: --lanes: select of a per-lane signal");
+	    return;
+	}
+	replaceLane(nodep, nodep->fromp()->unlinkFrBack());
+    }
+    virtual void visit(AstNodeVarRef* nodep) {
+	if (nodep->varp()->user2()) {
+	    if (nodep->varScopep()) nodep->varScopep()->dtypeFrom(nodep->varp());
+	    nodep->dtypeFrom(nodep->varp());
+	    nodep->user2(true);
+	}
+    }
+    virtual void visit(AstConst* nodep) {}
+    virtual void visit(AstNodeMath* nodep) {
+	nodep->iterateChildren(*this);
+	if (anyLane(nodep)) {
+	    nodep->v3error("Unsupported: --lanes: per-lane value used in "<<nodep->prettyTypeName());
+	}
+    }
+
+    // Statements
+    virtual void visit(AstScope* nodep) {
+	AstScope* lastScopep = m_scopep;
+	m_scopep = nodep;
+	nodep->iterateChildren(*this);
+	m_scopep = lastScopep;
+    }
+    virtual void visit(AstVarScope* nodep) {
+	if (nodep->varp()->user2()) nodep->dtypeFrom(nodep->varp());
+    }
+    virtual void visit(AstNodeSenItem* nodep) {}  // Clocks are scalar
+    virtual void visit(AstNodeAssign* nodep) {
+	nodep->iterateChildren(*this);
+	if (!isLane(nodep->lhsp())) {
+	    if (isLane(nodep->rhsp())) {
+		nodep->v3error("Unsupported: --lanes: per-lane value assigned to a "
+			       <<nodep->lhsp()->width()<<"-bit signal");
+	    } else if (m_maskVscp) {
+		nodep->v3error("Unsupported: --lanes: assignment to a scalar signal under a per-lane condition");
+	    }
+	    return;
+	}
+	liftChild(nodep->rhsp(), false);
+	if (m_maskVscp) {
+	    AstVarRef* lhsp = nodep->lhsp()->castVarRef();
+	    if (!lhsp) nodep->v3fatalSrc("Per-lane assignment is not to a variable");
+	    FileLine* fl = nodep->fileline();
+	    AstNode* rhsp = nodep->rhsp()->unlinkFrBack();
+	    AstNode* keepp = newLaneRef(lhsp->varScopep(), false);
+	    AstNode* nmaskp = setLane(new AstNot(fl, newLaneRef(m_maskVscp, false)));
+	    nodep->rhsp(setLane(new AstOr(fl,
+					  setLane(new AstAnd(fl, newLaneRef(m_maskVscp, false), rhsp)),
+					  setLane(new AstAnd(fl, nmaskp, keepp)))));
+	}
+    }
+    virtual void visit(AstNodeIf* nodep) {
+	nodep->condp()->iterateAndNext(*this);
+	if (!isLane(nodep->condp())) {
+	    nodep->ifsp()->iterateAndNext(*this);
+	    nodep->elsesp()->iterateAndNext(*this);
+	    return;
+	}
+	// Everything executes, the assignments only affecting lanes the condition covers
+	UINFO(4,"  Lane IF "<<nodep<<endl);
+	++m_statIfs;
+	FileLine* fl = nodep->fileline();
+	if (!m_scopep) nodep->v3fatalSrc("Lane IF not under scope");
+	AstVarScope* thenVscp = newMaskVscp(fl);
+	AstNode* condp = nodep->condp()->unlinkFrBack();
+	if (m_maskVscp) condp = setLane(new AstAnd(fl, newLaneRef(m_maskVscp, false), condp));
+	AstNode* newp = new AstAssign(fl, newLaneRef(thenVscp, true), condp);
+	AstVarScope* elseVscp = NULL;
+	if (nodep->elsesp()) {
+	    elseVscp = newMaskVscp(fl);
+	    AstNode* econdp = setLane(new AstNot(fl, newLaneRef(thenVscp, false)));
+	    if (m_maskVscp) econdp = setLane(new AstAnd(fl, newLaneRef(m_maskVscp, false), econdp));
+	    newp->addNext(new AstAssign(fl, newLaneRef(elseVscp, true), econdp));
+	}
+	AstVarScope* lastMaskVscp = m_maskVscp;
+	m_maskVscp = thenVscp;
+	nodep->ifsp()->iterateAndNext(*this);
+	m_maskVscp = elseVscp;
+	nodep->elsesp()->iterateAndNext(*this);
+	m_maskVscp = lastMaskVscp;
+	if (nodep->ifsp()) newp->addNext(nodep->ifsp()->unlinkFrBackWithNext());
+	if (nodep->elsesp()) newp->addNext(nodep->elsesp()->unlinkFrBackWithNext());
+	nodep->replaceWith(newp); pushDeletep(nodep); VL_DANGLING(nodep);
+    }
+    virtual void visit(AstComment* nodep) {}
+    virtual void visit(AstNodeStmt* nodep) {
+	if (m_maskVscp) {
+	    nodep->v3error("Unsupported: --lanes: "<<nodep->prettyTypeName()<<" under a per-lane condition");
+	}
+	nodep->iterateChildren(*this);
+    }
+    //--------------------
+    virtual void visit(AstNode* nodep) {
+	nodep->iterateChildren(*this);
+    }
+
+public:
+    // CONSTUCTORS
+    explicit LaneVisitor(AstNetlist* nodep) {
+	m_scopep = NULL;
+	m_maskVscp = NULL;
+	vector<AstVar*> candidates;
+	{
+	    LaneMarkVisitor markVisitor (nodep, candidates);
+	}
+	for (vector<AstVar*>::iterator it = candidates.begin(); it != candidates.end(); ++it) {
+	    AstVar* varp = *it;
+	    if (varp->user1()) {
+		++m_statScalar;
+	    } else {
+		UINFO(8,"  Widen "<<varp<<endl);
+		setLane(varp);
+		++m_statWidened;
+	    }
+	}
+	nodep->accept(*this);
+    }
+    virtual ~LaneVisitor() {
+	V3Stats::addStat("Lanes, signals widened", m_statWidened);
+	V3Stats::addStat("Lanes, signals kept scalar", m_statScalar);
+	V3Stats::addStat("Lanes, IFs converted to masks", m_statIfs);
+    }
+};
+
+//######################################################################
+// Lane class functions
+
+void V3Lane::laneAll(AstNetlist* nodep) {
+    UINFO(2,__FUNCTION__<<": "<<endl);
+    LaneVisitor visitor (nodep);
+    V3Global::dumpCheckGlobalTree("lane.tree", 0, v3Global.opt.dumpTreeLevel(__FILE__) >= 3);
+}
@@ -23,7 +23,10 @@
 //	    ASSIGN(x,...), ASSIGN(x,...) => delete first one
 //	    We also track across if statements:
 //	    ASSIGN(X,...) IF( ..., ASSIGN(X,...), ASSIGN(X,...)) => deletes first
-//	    We don't do the opposite yet though (remove assigns in if followed by outside if)
+//	    And the opposite, an assignment last in an if branch:
+//	    IF( ..., ASSIGN(X,...)) ASSIGN(X,...) => deletes first
+//	    As CCALLs under _eval are followed, this removes assignments in one
+//	    function that are overwritten by a later function.
 //
 //*************************************************************************
 
@@ -53,6 +56,7 @@ class LifeState {
 public:
     V3Double0	m_statAssnDel;	// Statistic tracking
     V3Double0	m_statAssnCon;	// Statistic tracking
+    V3Double0	m_statAssnBranchDel;	// Statistic tracking
     vector<AstNode*>	m_unlinkps;
 
 public:
@@ -61,6 +65,7 @@ public:
     ~LifeState() {
 	V3Stats::addStatSum("Optimizations, Lifetime assign deletions", m_statAssnDel);
 	V3Stats::addStatSum("Optimizations, Lifetime constant prop", m_statAssnCon);
+	V3Stats::addStatSum("Optimizations, Lifetime branch assign deletions", m_statAssnBranchDel);
 	for (vector<AstNode*>::iterator it = m_unlinkps.begin(); it != m_unlinkps.end(); ++it) {
 	    (*it)->unlinkFrBack();
 	    (*it)->deleteTree();
@@ -74,13 +79,18 @@ public:
 // Structure for each variable encountered
 
 class LifeVarEntry {
+public:
+    typedef vector<AstNodeAssign*> AssignList;
+private:
     AstNodeAssign*	m_assignp;	// Last assignment to this varscope, NULL if no longer relevant
+    AssignList		m_branchAssignps;	// Last assignments in branches below, not yet used
     AstConst*		m_constp;	// Known constant value
     bool		m_setBeforeUse;	// First access was a set (and thus block above may have a set that can be deleted
     bool		m_everSet;	// Was ever assigned (and thus above block may not preserve constant propagation)
 
     inline void init (bool setBeforeUse) {
 	m_assignp = NULL;
+	m_branchAssignps.clear();
 	m_constp = NULL;
 	m_setBeforeUse = setBeforeUse;
 	m_everSet = false;
@@ -102,19 +112,26 @@ public:
     ~LifeVarEntry() {}
     inline void simpleAssign(AstNodeAssign* assp) { // New simple A=.... assignment
 	m_assignp = assp;
+	m_branchAssignps.clear();
 	m_constp = NULL;
 	m_everSet = true;
 	if (assp->rhsp()->castConst()) m_constp = assp->rhsp()->castConst();
     }
     inline void complexAssign() {  // A[x]=... or some complicated assignment
 	m_assignp = NULL;
+	m_branchAssignps.clear();
 	m_constp = NULL;
 	m_everSet = true;
     }
     inline void consumed() {  // Rvalue read of A
 	m_assignp = NULL;
+	m_branchAssignps.clear();
+    }
+    inline void branchAssign(AstNodeAssign* assp) {  // A=... was last in a branch below
+	m_branchAssignps.push_back(assp);
     }
     AstNodeAssign* assignp() const { return m_assignp; }
+    const AssignList& branchAssignps() const { return m_branchAssignps; }
     AstConst* constNodep() const { return m_constp; }
     bool setBeforeUse() const { return m_setBeforeUse; }
     bool everSet() const { return m_everSet; }
@@ -131,7 +148,9 @@ class LifeBlock {
     // LIFE MAP
     //  For each basic block, we'll make a new map of what variables that if/else is changing
     typedef std::map<AstVarScope*, LifeVarEntry> LifeMap;
+    typedef vector<pair<AstVarScope*,AstNodeAssign*> > LastAssignList;
     LifeMap	m_map;		// Current active lifetime map for current scope
+    LastAssignList m_lastAssignps;	// Unused assignments at the end of this block
     LifeBlock*	m_aboveLifep;	// Upper life, or NULL
     LifeState*	m_statep;	// Current global state
 
@@ -165,6 +184,17 @@ public:
 		m_statep->pushUnlinkDeletep(oldassp); VL_DANGLING(oldassp);
 		++m_statep->m_statAssnDel;
 	    }
+	    // Assignments last in branches of an earlier IF, overwritten here on every path
+	    const LifeVarEntry::AssignList& branchps = entp->branchAssignps();
+	    if (!branchps.empty()) {
+		for (LifeVarEntry::AssignList::const_iterator bit = branchps.begin();
+		     bit != branchps.end(); ++bit) {
+		    if (debug()>4) (*bit)->dumpTree(cout, "       REMOVE/BRANCH ");
+		    m_statep->pushUnlinkDeletep(*bit);
+		    ++m_statep->m_statAssnBranchDel;
+		}
+		entp->complexAssign();
+	    }
 	}
     }
     void simpleAssign(AstVarScope* nodep, AstNodeAssign* assp) {
@@ -232,6 +262,15 @@ public:
 	if (!m_aboveLifep) v3fatalSrc("Pushing life when already at the top level");
 	for (LifeMap::iterator it = m_map.begin(); it!=m_map.end(); ++it) {
 	    AstVarScope* nodep = it->first;
+	    // Remember assignments not yet used, for lastAssignsToAbove
+	    if (AstNodeAssign* assp = it->second.assignp()) {
+		m_lastAssignps.push_back(make_pair(nodep, assp));
+	    }
+	    const LifeVarEntry::AssignList& branchps = it->second.branchAssignps();
+	    for (LifeVarEntry::AssignList::const_iterator bit = branchps.begin();
+		 bit != branchps.end(); ++bit) {
+		m_lastAssignps.push_back(make_pair(nodep, *bit));
+	    }
 	    m_aboveLifep->complexAssignFind(nodep);
 	    if (it->second.everSet()) {
 		// Record there may be an assignment, so we don't constant propagate across the if.
@@ -242,6 +281,20 @@ public:
 	    }
 	}
     }
+    void lastAssignsToAbove() {
+	// After lifeToAbove of all branches of an IF; an assignment not used by
+	// the end of its branch may be deleted if the var is set again after the IF
+	for (LastAssignList::iterator it = m_lastAssignps.begin(); it!=m_lastAssignps.end(); ++it) {
+	    UINFO(4,"     lastAssign: "<<it->first<<endl);
+	    m_aboveLifep->branchAssignFind(it->first, it->second);
+	}
+	m_lastAssignps.clear();
+    }
+    void branchAssignFind(AstVarScope* nodep, AstNodeAssign* assp) {
+	LifeMap::iterator it = m_map.find(nodep);
+	if (it == m_map.end()) nodep->v3fatalSrc("Branch assignment without lifeToAbove");
+	it->second.branchAssign(assp);
+    }
     void dualBranch (LifeBlock* life1p, LifeBlock* life2p) {
 	// Find any common sets on both branches of IF and propagate upwards
 	//life1p->lifeDump();
@@ -365,6 +418,11 @@ private:
 	// For the next assignments, clear any variables that were read or written in the block
 	ifLifep->lifeToAbove();
 	elseLifep->lifeToAbove();
+	// Then unused assignments in each branch may be deleted by a later set
+	if (!m_noopt) {
+	    ifLifep->lastAssignsToAbove();
+	    elseLifep->lastAssignsToAbove();
+	}
 	delete ifLifep;
 	delete elseLifep;
     }
@@ -50,12 +50,10 @@ private:
 
     // TYPES
     typedef map <pair<void*,string>,AstTypedef*> ImplTypedefMap;
-    typedef set <FileLine*> FileLineSet;
 
     // STATE
     AstVar*		m_varp;		// Variable we're under
     ImplTypedefMap	m_implTypedef;	// Created typedefs for each <container,name>
-    FileLineSet		m_filelines;	// Filelines that have been seen
     bool		m_inAlways;	// Inside an always
     bool		m_inGenerate;	// Inside a generate
     bool		m_needStart;	// Need start marker on lower AstParse
@@ -73,16 +71,15 @@ private:
 
     void cleanFileline(AstNode* nodep) {
 	if (!nodep->user2SetOnce()) {  // Process once
-	    // We make all filelines unique per AstNode.  This allows us to
-	    // later turn off messages on a fileline when an issue is found
-	    // so that messages on replicated blocks occur only once,
+	    // We make filelines unique per AstNode for the nodes that later
+	    // passes turn off messages on (modifyWarnOff) when an issue is
+	    // found, so that messages on replicated blocks occur only once,
 	    // without suppressing other token's messages as a side effect.
-	    // We could have verilog.l create a new one on every token,
-	    // but that's a lot more structures than only doing AST nodes.
-	    if (m_filelines.find(nodep->fileline()) != m_filelines.end()) {
+	    // All other nodes keep sharing the parser's interned filelines,
+	    // as one per node is a lot of structures.
+	    if (nodep->castVar() || nodep->castAlways() || nodep->castIf() || nodep->castCaseItem()) {
 		nodep->fileline(new FileLine(nodep->fileline()));
 	    }
-	    m_filelines.insert(nodep->fileline());
 	}
     }
 
@@ -249,6 +246,11 @@ private:
 	    m_varp->attrSFormat(true);
 	    nodep->unlinkFrBack()->deleteTree(); VL_DANGLING(nodep);
 	}
+	else if (nodep->attrType() == AstAttrType::VAR_SPARSE) {
+	    if (!m_varp) nodep->v3fatalSrc("Attribute not attached to variable");
+	    m_varp->attrSparse(true);
+	    nodep->unlinkFrBack()->deleteTree(); VL_DANGLING(nodep);
+	}
 	else if (nodep->attrType() == AstAttrType::VAR_SC_BV) {
 	    if (!m_varp) nodep->v3fatalSrc("Attribute not attached to variable");
 	    m_varp->attrScBv(true);
@@ -23,6 +23,8 @@
 //	       if only referenced in a CFUNC, make it local to that CFUNC
 //	    VAR(others
 //	       if non-public, set before used, and in signle CFUNC, make it local
+//	       "Set before used" follows the CFUNC's control flow, as V3Life does;
+//	       a variable set in both branches of an IF is set after the IF.
 //
 //*************************************************************************
 
@@ -32,6 +34,7 @@
 #include <cstdarg>
 #include <unistd.h>
 #include <vector>
+#include <set>
 
 #include "V3Global.h"
 #include "V3Localize.h"
@@ -47,7 +50,6 @@ protected:
     // Cleared on entire tree
     //  AstVar::user1p()	-> CFunc which references the variable
     //  AstVar::user2()		-> VarFlags.  Flag state
-    //  AstVar::user4()		-> AstVarRef*.  First place signal set; must be first assignment
 
     // METHODS
     static int debug() {
@@ -70,6 +72,14 @@ protected:
 	VarFlags(AstNode* nodep) { m_flags = nodep->user2(); }
 	void setNodeFlags(AstNode* nodep) { nodep->user2(m_flags); }
     };
+
+    // METHODS
+    void clearStdOptimizable(AstVar* nodep, const char* reason) {
+	UINFO(4,"       NoStd "<<reason<<" "<<nodep<<endl);
+	VarFlags flags (nodep);
+	flags.m_notStd = true;
+	flags.setNodeFlags(nodep);
+    }
 };
 
 //######################################################################
@@ -99,6 +109,119 @@ public:
     virtual ~LocalizeDehierVisitor() {}
 };
 
+//######################################################################
+// Variables set on every path reaching a statement
+
+class LocalizeFlowBlock {
+    // Vars set in this block, in addition to those set in the blocks above it
+    set<AstVar*>	m_setps;	// Variables always set by the end of this block
+    LocalizeFlowBlock*	m_aboveFlowp;	// Enclosing block, or NULL if top of function
+public:
+    explicit LocalizeFlowBlock(LocalizeFlowBlock* aboveFlowp) : m_aboveFlowp(aboveFlowp) {}
+    ~LocalizeFlowBlock() {}
+    void setVar(AstVar* varp) { m_setps.insert(varp); }
+    bool isSet(AstVar* varp) const {
+	for (const LocalizeFlowBlock* flowp = this; flowp; flowp = flowp->m_aboveFlowp) {
+	    if (flowp->m_setps.find(varp) != flowp->m_setps.end()) return true;
+	}
+	return false;
+    }
+    void dualBranch(LocalizeFlowBlock* flow1p, LocalizeFlowBlock* flow2p) {
+	// Variables set in both branches are set after them
+	for (set<AstVar*>::iterator it = flow1p->m_setps.begin(); it != flow1p->m_setps.end(); ++it) {
+	    if (flow2p->m_setps.find(*it) != flow2p->m_setps.end()) setVar(*it);
+	}
+    }
+};
+
+class LocalizeFlowVisitor : public LocalizeBaseVisitor {
+private:
+    // NODE STATE/TYPES
+    // See above
+
+    // STATE
+    LocalizeFlowBlock*	m_flowp;	// Current block
+
+    // METHODS
+    void iterateNewBlock(AstNode* nodep) {
+	// Iterate a block whose sets don't reach the statements after it
+	LocalizeFlowBlock* prevFlowp = m_flowp;
+	LocalizeFlowBlock newFlow (prevFlowp);
+	m_flowp = &newFlow;
+	nodep->iterateAndNext(*this);
+	m_flowp = prevFlowp;
+    }
+
+    // VISITORS
+    virtual void visit(AstNodeAssign* nodep) {
+	nodep->rhsp()->iterateAndNext(*this);
+	if (AstVarRef* varrefp = nodep->lhsp()->castVarRef()) {
+	    if (!varrefp->lvalue()) varrefp->v3fatalSrc("LHS assignment not lvalue");
+	    UINFO(4,"      FuncAsn "<<varrefp<<endl);
+	    m_flowp->setVar(varrefp->varp());
+	    VarFlags flags (varrefp->varp());
+	    flags.m_stdFuncAsn = true;
+	    flags.setNodeFlags(varrefp->varp());
+	} else {
+	    nodep->lhsp()->iterateAndNext(*this);
+	}
+    }
+    virtual void visit(AstAssignDly* nodep) {
+	// Not set until later
+	nodep->iterateChildren(*this);
+    }
+    virtual void visit(AstVarRef* nodep) {
+	// Not a whole assignment, so it reads, or writes only part, of the old value
+	if (!nodep->varp()->isMovableToBlock()
+	    && !m_flowp->isSet(nodep->varp())) {
+	    clearStdOptimizable(nodep->varp(), "notSetBefore");
+	}
+    }
+    virtual void visit(AstNodeIf* nodep) {
+	nodep->condp()->iterateAndNext(*this);
+	LocalizeFlowBlock* prevFlowp = m_flowp;
+	LocalizeFlowBlock ifFlow (prevFlowp);
+	LocalizeFlowBlock elseFlow (prevFlowp);
+	m_flowp = &ifFlow;
+	nodep->ifsp()->iterateAndNext(*this);
+	m_flowp = &elseFlow;
+	nodep->elsesp()->iterateAndNext(*this);
+	m_flowp = prevFlowp;
+	m_flowp->dualBranch(&ifFlow, &elseFlow);
+    }
+    virtual void visit(AstWhile* nodep) {
+	// The body may run zero times
+	iterateNewBlock(nodep->precondsp());
+	iterateNewBlock(nodep->condp());
+	LocalizeFlowBlock* prevFlowp = m_flowp;
+	LocalizeFlowBlock bodyFlow (prevFlowp);
+	m_flowp = &bodyFlow;
+	nodep->bodysp()->iterateAndNext(*this);
+	nodep->incsp()->iterateAndNext(*this);
+	m_flowp = prevFlowp;
+    }
+    virtual void visit(AstJumpLabel* nodep) {
+	// A JumpGo may skip any of the sets
+	iterateNewBlock(nodep->stmtsp());
+    }
+    virtual void visit(AstVar*) {}	// Don't want varrefs under it
+    virtual void visit(AstNode* nodep) {
+	nodep->iterateChildren(*this);
+    }
+public:
+    // CONSTRUCTORS
+    explicit LocalizeFlowVisitor(AstCFunc* nodep) {
+	LocalizeFlowBlock topFlow (NULL);
+	m_flowp = &topFlow;
+	nodep->argsp()->iterateAndNext(*this);
+	nodep->initsp()->iterateAndNext(*this);
+	nodep->stmtsp()->iterateAndNext(*this);
+	nodep->finalsp()->iterateAndNext(*this);
+	m_flowp = NULL;
+    }
+    virtual ~LocalizeFlowVisitor() {}
+};
+
 //######################################################################
 // Localize class functions
 
@@ -108,7 +231,6 @@ private:
     // See above
     AstUser1InUse	m_inuser1;
     AstUser2InUse	m_inuser2;
-    AstUser4InUse	m_inuser4;
 
     // STATE
     V3Double0	m_statLocVars;	// Statistic tracking
@@ -122,12 +244,6 @@ private:
 	flags.m_notOpt = true;
 	flags.setNodeFlags(nodep);
     }
-    void clearStdOptimizable(AstVar* nodep, const char* reason) {
-	UINFO(4,"       NoStd "<<reason<<" "<<nodep<<endl);
-	VarFlags flags (nodep);
-	flags.m_notStd = true;
-	flags.setNodeFlags(nodep);
-    }
     void moveVars() {
 	for (vector<AstVar*>::iterator it = m_varps.begin(); it != m_varps.end(); ++it) {
 	    AstVar* nodep = *it;
@@ -162,34 +278,11 @@ private:
     virtual void visit(AstCFunc* nodep) {
 	UINFO(4,"  CFUNC "<<nodep<<endl);
 	m_cfuncp = nodep;
-	searchFuncStmts(nodep->argsp());
-	searchFuncStmts(nodep->initsp());
-	searchFuncStmts(nodep->stmtsp());
-	searchFuncStmts(nodep->finalsp());
+	// Find variables always set before they are used
+	LocalizeFlowVisitor flowVisitor (nodep);
 	nodep->iterateChildren(*this);
 	m_cfuncp = NULL;
     }
-    void searchFuncStmts(AstNode* nodep) {
-	// Search for basic assignments to allow moving non-blocktemps
-	// For now we only find simple assignments not under any other statement.
-	// This could be more complicated; allow always-set under both branches of a IF.
-	// If so, check for ArrayRef's and such, as they aren't acceptable.
-	for (; nodep; nodep=nodep->nextp()) {
-	    if (nodep->castNodeAssign()) {
-		if (AstVarRef* varrefp = nodep->castNodeAssign()->lhsp()->castVarRef()) {
-		    if (!varrefp->lvalue()) varrefp->v3fatalSrc("LHS assignment not lvalue");
-		    if (!varrefp->varp()->user4p()) {
-			UINFO(4,"      FuncAsn "<<varrefp<<endl);
-			varrefp->varp()->user4p(varrefp);
-			VarFlags flags (varrefp->varp());
-			flags.m_stdFuncAsn = true;
-			flags.setNodeFlags(varrefp->varp());
-		    }
-		}
-	    }
-	}
-    }
-
     virtual void visit(AstVar* nodep) {
 	if (!nodep->isSigPublic()
 	    && !nodep->isPrimaryIO()
@@ -218,12 +311,6 @@ private:
 		    // Used in multiple functions
 		    clearOptimizable(nodep->varp(),"BVmultiF");
 		}
-		// First varref in function must be assignment found earlier
-		AstVarRef* firstasn = (AstVarRef*)(nodep->varp()->user4p());
-		if (firstasn && nodep!=firstasn) {
-		    clearStdOptimizable(nodep->varp(),"notFirstAsn");
-		    nodep->varp()->user4p(NULL);
-		}
 	    }
 	}
 	// No iterate; Don't want varrefs under it
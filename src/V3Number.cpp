@@ -278,7 +278,7 @@ V3Number& V3Number::setZero() {
 V3Number& V3Number::setQuad(vluint64_t value) {
     for (int i=0; i<words(); i++) m_value[i]=m_valueX[i] = 0;
     m_value[0] = value & VL_ULL(0xffffffff);
-    m_value[1] = (value>>VL_ULL(32)) & VL_ULL(0xffffffff);
+    if (words()>1) m_value[1] = (value>>VL_ULL(32)) & VL_ULL(0xffffffff);
     opCleanThis();
     return *this;
 }
@@ -974,6 +974,19 @@ V3Number& V3Number::opConcat (const V3Number& lhs, const V3Number& rhs) {
     return *this;
 }
 
+V3Number& V3Number::opPext (const V3Number& lhs, const V3Number& rhs) {
+    // Bits of lhs where rhs is one, packed into the LSBs
+    setZero();
+    int obit = 0;
+    for(int bit=0; bit<rhs.width() && obit<width(); bit++) {
+	if (rhs.bitIs1(bit)) {
+	    setBit(obit,lhs.bitIs(bit));
+	    obit++;
+	}
+    }
+    return *this;
+}
+
 V3Number& V3Number::opRepl (const V3Number& lhs, const V3Number& rhs) {	// rhs is # of times to replicate
     // Hopefully the using routine has a error check too.
     // See also error in V3Width
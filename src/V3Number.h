@@ -29,6 +29,78 @@
 
 //============================================================================
 
+class V3NumberWords {
+    // Word storage for a V3Number, like a vector<uint32_t>.
+    // Most numbers are narrow, so small ones are held inline, avoiding a
+    // heap allocation for every constant made or copied.
+    enum { INLINE_WORDS = 5 };	// 128 bits, plus the spare word V3Number keeps
+    uint32_t*	m_datap;		// Words, m_inline unless on heap
+    uint32_t	m_size;			// Number of words in use
+    uint32_t	m_capacity;		// Number of words allocated
+    uint32_t	m_inline[INLINE_WORDS];	// Inline storage
+    bool onHeap() const { return m_datap != m_inline; }
+    void assign(const V3NumberWords& rhs) {
+	if (rhs.m_size > m_capacity) {
+	    if (onHeap()) delete[] m_datap;
+	    m_datap = new uint32_t[rhs.m_size];
+	    m_capacity = rhs.m_size;
+	}
+	for (uint32_t i=0; i<rhs.m_size; ++i) m_datap[i] = rhs.m_datap[i];
+	m_size = rhs.m_size;
+    }
+public:
+    V3NumberWords() : m_datap(m_inline), m_size(0), m_capacity(INLINE_WORDS) {}
+    V3NumberWords(const V3NumberWords& rhs) : m_datap(m_inline), m_size(0), m_capacity(INLINE_WORDS) {
+	assign(rhs);
+    }
+    V3NumberWords& operator=(const V3NumberWords& rhs) {
+	if (this != &rhs) assign(rhs);
+	return *this;
+    }
+#ifdef VL_HAS_MOVE
+    V3NumberWords(V3NumberWords&& rhs) : m_datap(m_inline), m_size(0), m_capacity(INLINE_WORDS) {
+	swap(rhs);
+    }
+    V3NumberWords& operator=(V3NumberWords&& rhs) {
+	swap(rhs);
+	return *this;
+    }
+#endif
+    ~V3NumberWords() { if (onHeap()) delete[] m_datap; }
+    size_t size() const { return m_size; }
+    uint32_t& operator[](size_t i) { return m_datap[i]; }
+    const uint32_t& operator[](size_t i) const { return m_datap[i]; }
+    void resize(size_t size) {
+	// New words are zeroed
+	if (size > m_capacity) {
+	    uint32_t* newp = new uint32_t[size];
+	    for (uint32_t i=0; i<m_size; ++i) newp[i] = m_datap[i];
+	    if (onHeap()) delete[] m_datap;
+	    m_datap = newp;
+	    m_capacity = size;
+	}
+	for (uint32_t i=m_size; i<size; ++i) m_datap[i] = 0;
+	m_size = size;
+    }
+    void swap(V3NumberWords& rhs) {
+	if (onHeap() && rhs.onHeap()) {
+	    uint32_t* tp = m_datap; m_datap = rhs.m_datap; rhs.m_datap = tp;
+	} else {
+	    for (int i=0; i<INLINE_WORDS; ++i) {
+		uint32_t t = m_inline[i]; m_inline[i] = rhs.m_inline[i]; rhs.m_inline[i] = t;
+	    }
+	    uint32_t* lp = onHeap() ? m_datap : rhs.m_inline;  // Where each side's words now are
+	    uint32_t* rp = rhs.onHeap() ? rhs.m_datap : m_inline;
+	    m_datap = rp;
+	    rhs.m_datap = lp;
+	}
+	uint32_t t = m_size; m_size = rhs.m_size; rhs.m_size = t;
+	t = m_capacity; m_capacity = rhs.m_capacity; rhs.m_capacity = t;
+    }
+};
+
+//============================================================================
+
 class V3Number {
     // Large 4-state number handling
     int		m_width;	// Width as specified/calculated.
@@ -39,8 +111,8 @@ class V3Number {
     bool	m_fromString:1;	// True if from string literal
     bool	m_autoExtend:1;	// True if SystemVerilog extend-to-any-width
     FileLine*	m_fileline;
-    vector<uint32_t>	m_value;	// The Value, with bit 0 being in bit 0 of this vector (unless X/Z)
-    vector<uint32_t>	m_valueX;	// Each bit is true if it's X or Z, 10=z, 11=x
+    V3NumberWords	m_value;	// The Value, with bit 0 being in bit 0 of this vector (unless X/Z)
+    V3NumberWords	m_valueX;	// Each bit is true if it's X or Z, 10=z, 11=x
     string		m_stringVal;	// If isString, the value of the string
     // METHODS
     V3Number& setSingleBits(char value);
@@ -240,6 +312,7 @@ public:
     V3Number& opCLog2	(const V3Number& lhs);
     V3Number& opClean	(const V3Number& lhs, uint32_t bits);
     V3Number& opConcat	(const V3Number& lhs, const V3Number& rhs);
+    V3Number& opPext	(const V3Number& lhs, const V3Number& rhs);
     V3Number& opRepl	(const V3Number& lhs, const V3Number& rhs);
     V3Number& opRepl	(const V3Number& lhs, uint32_t rhs);
     V3Number& opStreamL	(const V3Number& lhs, const V3Number& rhs);
@@ -51,6 +51,7 @@ class V3OptionsImp {
 public:
     // TYPES
     typedef std::map<string,set<string> > DirMap;	// Directory listing
+    typedef std::map<string,string> FilePathMap;	// Module name -> file found
 
     // STATE
     list<string>	m_allArgs;	// List of every argument encountered
@@ -62,6 +63,7 @@ public:
     list<string>	m_libExtVs;	// Library extensions (ordered)
     set<string>		m_libExtVSet;	// Library extensions (for removing duplicates)
     DirMap		m_dirMap;	// Directory listing
+    FilePathMap		m_filePathMap;	// Earlier filePath results, until search path changes
 
     // ACCESSOR METHODS
     void addIncDirUser(const string& incdir) {
@@ -70,6 +72,7 @@ public:
 	    m_incDirUsers.push_back(incdir);
 	    m_incDirFallbacks.remove(incdir);  // User has priority over Fallback
 	    m_incDirFallbackSet.erase(incdir);  // User has priority over Fallback
+	    m_filePathMap.clear();
 	}
     }
     void addIncDirFallback(const string& incdir) {
@@ -77,6 +80,7 @@ public:
 	    if (m_incDirFallbackSet.find(incdir) == m_incDirFallbackSet.end()) {
 		m_incDirFallbackSet.insert(incdir);
 		m_incDirFallbacks.push_back(incdir);
+		m_filePathMap.clear();
 	    }
 	}
     }
@@ -90,6 +94,7 @@ public:
 	if (m_libExtVSet.find(libext) == m_libExtVSet.end()) {
 	    m_libExtVSet.insert(libext);
 	    m_libExtVs.push_back(libext);
+	    m_filePathMap.clear();
 	}
     }
     V3OptionsImp() {}
@@ -220,6 +225,14 @@ void V3Options::addNoClocker(const string& signame) {
 	m_noClockers.insert(signame);
     }
 }
+bool V3Options::isLazyOutput(const string& signame) const {
+    return m_lazyOutputs.find(signame) != m_lazyOutputs.end();
+}
+void V3Options::addLazyOutput(const string& signame) {
+    if (m_lazyOutputs.find(signame) == m_lazyOutputs.end()) {
+	m_lazyOutputs.insert(signame);
+    }
+}
 void V3Options::addVFile(const string& filename) {
     // We use a list for v files, because it's legal to have includes
     // in a specific order and multiple of them.
@@ -335,8 +348,7 @@ string V3Options::filePathCheckOneDir(const string& modname, const string& dirna
     return "";
 }
 
-string V3Options::filePath (FileLine* fl, const string& modname, const string& lastpath,
-			    const string& errmsg) {   // Error prefix or "" to suppress error
+string V3Options::filePathSearch(const string& modname, const string& lastpath) {
     // Find a filename to read the specified module name,
     // using the incdir and libext's.
     // Return "" if not found.
@@ -355,6 +367,21 @@ string V3Options::filePath (FileLine* fl, const string& modname, const string& l
 	string exists = filePathCheckOneDir(modname, lastpath);
 	if (exists!="") return V3Os::filenameRealPath(exists);
     }
+    return "";
+}
+
+string V3Options::filePath (FileLine* fl, const string& modname, const string& lastpath,
+			    const string& errmsg) {   // Error prefix or "" to suppress error
+    // Find a filename to read the specified module name, remembering the
+    // answer, as with many -y directories each search tries every
+    // directory and extension
+    string key = modname;
+    if (m_relativeIncludes) key += "\n"+lastpath;  // Only then does lastpath matter
+    V3OptionsImp::FilePathMap::iterator it = m_impp->m_filePathMap.find(key);
+    if (it == m_impp->m_filePathMap.end()) {
+	it = m_impp->m_filePathMap.insert(make_pair(key, filePathSearch(modname, lastpath))).first;
+    }
+    if (it->second != "") return it->second;
 
     // Warn and return not found
     if (errmsg != "") {
@@ -639,6 +666,7 @@ void V3Options::parseOptsList(FileLine* fl, const string& optdir, int argc, char
 	    else if ( onoff   (sw, "-bbox-unsup", flag/*ref*/) ) { m_bboxUnsup = flag; }
 	    else if ( !strcmp (sw, "-cc") )			{ m_outFormatOk = true; m_systemC = false; }
 	    else if ( onoff   (sw, "-cdc", flag/*ref*/) )	{ m_cdc = flag; }
+	    else if ( onoff   (sw, "-combine-instances", flag/*ref*/) ) { m_combineInstances = flag; }
 	    else if ( onoff   (sw, "-coverage", flag/*ref*/) )	{ coverage(flag); }
 	    else if ( onoff   (sw, "-coverage-line", flag/*ref*/) ){ m_coverageLine = flag; }
 	    else if ( onoff   (sw, "-coverage-toggle", flag/*ref*/) ){ m_coverageToggle = flag; }
@@ -651,29 +679,58 @@ void V3Options::parseOptsList(FileLine* fl, const string& optdir, int argc, char
 	    else if ( !strcmp (sw, "-debug-fatalsrc") )		{ v3fatalSrc("--debug-fatal-src"); }  // Undocumented, see also --debug-abort
 	    else if ( onoff   (sw, "-decoration", flag/*ref*/) ) { m_decoration = flag; }
 	    else if ( onoff   (sw, "-dump-tree", flag/*ref*/) )	{ m_dumpTree = flag ? 3 : 0; }  // Also see --dump-treei
+	    else if ( onoff   (sw, "-dump-tree-binary", flag/*ref*/) ) { m_dumpTreeBinary = flag; }
+	    else if ( onoff   (sw, "-eval-domains", flag/*ref*/) )	{ m_evalDomains = flag; }
+	    else if ( onoff   (sw, "-eval-sparse", flag/*ref*/) )	{ m_evalSparse = flag; }
 	    else if ( onoff   (sw, "-exe", flag/*ref*/) )	{ m_exe = flag; }
 	    else if ( onoff   (sw, "-ignc", flag/*ref*/) )	{ m_ignc = flag; }
 	    else if ( onoff   (sw, "-inhibit-sim", flag/*ref*/)){ m_inhibitSim = flag; }
+	    else if ( onoff   (sw, "-lanes", flag/*ref*/) )	{ m_lanes = flag; }
+	    else if ( onoff   (sw, "-layout-hot-cold", flag/*ref*/) ) { m_layoutHotCold = flag; }
+	    else if ( onoff   (sw, "-line-directives", flag/*ref*/) ) { m_lineDirectives = flag; }
+	    else if ( onoff   (sw, "-link-ports", flag/*ref*/) )	{ m_linkPorts = flag; }
 	    else if ( onoff   (sw, "-lint-only", flag/*ref*/) )	{ m_lintOnly = flag; }
 	    else if ( !strcmp (sw, "-no-pins64") )		{ m_pinsBv = 33; }
 	    else if ( onoff   (sw, "-order-clock-delay", flag/*ref*/) )	{ m_orderClockDly = flag; }
+	    else if ( onoff   (sw, "-order-locality", flag/*ref*/) )	{ m_orderLocality = flag; }
+	    else if ( onoff   (sw, "-output-keep-unchanged", flag/*ref*/) ) { m_outputKeepUnchanged = flag; }
+	    else if ( onoff   (sw, "-output-min-includes", flag/*ref*/) ) { m_outputMinIncludes = flag; }
+	    else if ( onoff   (sw, "-output-split-balance", flag/*ref*/) ) { m_outputSplitBalance = flag; }
+	    else if ( onoff   (sw, "-output-split-stable", flag/*ref*/) ) { m_outputSplitStable = flag; }
+	    else if ( onoff   (sw, "-param-share-unused", flag/*ref*/) ) { m_paramShareUnused = flag; }
 	    else if ( !strcmp (sw, "-pins64") )			{ m_pinsBv = 65; }
+	    else if ( onoff   (sw, "-pins-changed", flag/*ref*/) )	{ m_pinsChanged = flag; }
 	    else if ( onoff   (sw, "-pins-sc-uint", flag/*ref*/) ){ m_pinsScUint = flag; if (!m_pinsScBigUint) m_pinsBv = 65; }
 	    else if ( onoff   (sw, "-pins-sc-biguint", flag/*ref*/) ){ m_pinsScBigUint = flag; m_pinsBv = 513; }
 	    else if ( onoff   (sw, "-pins-uint8", flag/*ref*/) ){ m_pinsUint8 = flag; }
 	    else if ( !strcmp (sw, "-private") )		{ m_public = false; }
 	    else if ( onoff   (sw, "-profile-cfuncs", flag/*ref*/) )	{ m_profileCFuncs = flag; }
+	    else if ( onoff   (sw, "-profile-activity", flag/*ref*/) )	{ m_profileActivity = flag; }
+	    else if ( onoff   (sw, "-profile-branches", flag/*ref*/) )	{ m_profileBranches = flag; }
+	    else if ( onoff   (sw, "-profile-converge", flag/*ref*/) )	{ m_profileConverge = flag; }
+	    else if ( onoff   (sw, "-profile-counters", flag/*ref*/) )	{ m_profileCounters = flag; if (flag) m_profileCFuncs = true; }
 	    else if ( onoff   (sw, "-public", flag/*ref*/) )		{ m_public = flag; }
+	    else if ( onoff   (sw, "-quick-build", flag/*ref*/) )	{ m_quickBuild = flag;
+		if (flag) { m_outputKeepUnchanged = true; m_outputMinIncludes = true;
+		    m_outputSplitStable = true;
+		    if (!m_outputSplit) m_outputSplit = 20000; } }
             else if ( !strncmp(sw, "-pvalue+", strlen("-pvalue+")))	{ addParameter(string(sw+strlen("-pvalue+")), false); }
 	    else if ( onoff   (sw, "-report-unoptflat", flag/*ref*/) )	{ m_reportUnoptflat = flag; }
 	    else if ( onoff   (sw, "-relative-includes", flag/*ref*/) )	{ m_relativeIncludes = flag; }
+	    else if ( onoff   (sw, "-restrict-wide", flag/*ref*/) )	{ m_restrictWide = flag; }
+	    else if ( onoff   (sw, "-reset-tables", flag/*ref*/) )	{ m_resetTables = flag; }
 	    else if ( onoff   (sw, "-savable", flag/*ref*/) )		{ m_savable = flag; }
 	    else if ( !strcmp (sw, "-sc") )				{ m_outFormatOk = true; m_systemC = true; }
+	    else if ( onoff   (sw, "-sc-sensitive-clocks", flag/*ref*/) ) { m_scSensitiveClocks = flag; }
+	    else if ( onoff   (sw, "-seq-gate", flag/*ref*/) )		{ m_seqGate = flag; }
 	    else if ( onoff   (sw, "-skip-identical", flag/*ref*/) )	{ m_skipIdentical = flag; }
+	    else if ( onoff   (sw, "-split-loop-vars", flag/*ref*/) )	{ m_splitLoopVars = flag; }
 	    else if ( onoff   (sw, "-stats", flag/*ref*/) )		{ m_stats = flag; }
 	    else if ( onoff   (sw, "-stats-vars", flag/*ref*/) )	{ m_statsVars = flag; m_stats |= flag; }
 	    else if ( !strcmp (sw, "-sv") )				{ m_defaultLanguage = V3LangCode::L1800_2005; }
+	    else if ( onoff   (sw, "-time-context", flag/*ref*/) )	{ m_timeContext = flag; }
 	    else if ( onoff   (sw, "-trace", flag/*ref*/) )		{ m_trace = flag; }
+	    else if ( onoff   (sw, "-trace-bin", flag/*ref*/) )		{ m_traceBin = flag; m_trace |= flag; }
 	    else if ( onoff   (sw, "-trace-dups", flag/*ref*/) )	{ m_traceDups = flag; }
 	    else if ( onoff   (sw, "-trace-params", flag/*ref*/) )	{ m_traceParams = flag; }
 	    else if ( onoff   (sw, "-trace-structs", flag/*ref*/) )	{ m_traceStructs = flag; }
@@ -681,6 +738,7 @@ void V3Options::parseOptsList(FileLine* fl, const string& optdir, int argc, char
 	    else if ( onoff   (sw, "-underline-zero", flag/*ref*/) )	{ m_underlineZero = flag; }  // Undocumented, old Verilator-2
 	    else if ( onoff   (sw, "-vpi", flag/*ref*/) )		{ m_vpi = flag; }
 	    else if ( onoff   (sw, "-x-initial-edge", flag/*ref*/) )	{ m_xInitialEdge = flag; }
+	    else if ( onoff   (sw, "-xml-compact", flag/*ref*/) )	{ m_xmlCompact = flag; }  // Undocumented, still experimental
 	    else if ( onoff   (sw, "-xml-only", flag/*ref*/) )		{ m_xmlOnly = flag; }  // Undocumented, still experimental
 	    // Optimization
 	    else if ( !strncmp (sw, "-O", 2) ) {
@@ -696,17 +754,23 @@ void V3Options::parseOptsList(FileLine* fl, const string& optdir, int argc, char
 		    case 'c': m_oConst = flag; break;
 		    case 'd': m_oDedupe = flag; break;
 		    case 'm': m_oAssemble = flag; break;
+		    case 'n': m_oConstIncr = flag; break;
 		    case 'e': m_oCase = flag; break;
 		    case 'f': m_oFlopGater = flag; break;
 		    case 'g': m_oGate = flag; break;
+		    case 'h': m_oCse = flag; break;
 		    case 'i': m_oInline = flag; break;
+		    case 'j': m_oInterleave = flag; break;
 		    case 'k': m_oSubstConst = flag; break;
 		    case 'l': m_oLife = flag; break;
 		    case 'p': m_public = !flag; break;  //With -Op so flag=0, we want public on so few optimizations done
+		    case 'q': m_oResetFast = flag; break;
 		    case 'r': m_oReorder = flag; break;
 		    case 's': m_oSplit = flag; break;
 		    case 't': m_oLifePost = flag; break;
 		    case 'u': m_oSubst = flag; break;
+		    case 'v': m_oActiveMerge = flag; break;
+		    case 'w': m_oTempReuse = flag; break;
 		    case 'x': m_oExpand = flag; break;
 		    case 'y': m_oAcycSimp = flag; break;
 		    case 'z': m_oLocalize = flag; break;
@@ -733,6 +797,11 @@ void V3Options::parseOptsList(FileLine* fl, const string& optdir, int argc, char
 	    else if ( !strcmp (sw, "-debug") ) {
 		setDebugMode(3);
 	    }
+	    else if ( !strcmp (sw, "-debug-check-sample") && (i+1)<argc ) {
+		shift;
+		m_debugCheckSample = atoi(argv[i]);
+		if (m_debugCheckSample < 1) fl->v3fatal("--debug-check-sample must be >= 1: "<<argv[i]);
+	    }
 	    else if ( !strcmp (sw, "-debugi") && (i+1)<argc ) {
 		shift;
 		setDebugMode(atoi(argv[i]));
@@ -751,10 +820,20 @@ void V3Options::parseOptsList(FileLine* fl, const string& optdir, int argc, char
 		shift;
 		setDumpTreeLevel(src, atoi(argv[i]));
 	    }
+	    else if ( !strcmp (sw, "-acyclic-fast") && (i+1)<argc ) {
+		shift;
+		m_acyclicFast = atoi(argv[i]);
+		if (m_acyclicFast < 0) fl->v3fatal("--acyclic-fast must be >= 0: "<<argv[i]);
+	    }
 	    else if ( !strcmp (sw, "-error-limit") && (i+1)<argc ) {
 		shift;
 		V3Error::errorLimit(atoi(argv[i]));
 	    }
+	    else if ( !strcmp (sw, "-expand-limit") && (i+1)<argc ) {
+		shift;
+		m_expandLimit = atoi(argv[i]);
+		if (m_expandLimit < 0) fl->v3fatal("--expand-limit must be >= 0: "<<argv[i]);
+	    }
 	    else if ( !strcmp (sw, "-FI") && (i+1)<argc ) {
 		shift;
 		addForceInc(parseFileArg(optdir, string (argv[i])));
@@ -773,6 +852,26 @@ void V3Options::parseOptsList(FileLine* fl, const string& optdir, int argc, char
 		shift;
 		m_inlineMult = atoi(argv[i]);
 	    }
+	    else if ( !strcmp (sw, "-inline-mult-hot") && (i+1)<argc ) {
+		shift;
+		m_inlineMultHot = atoi(argv[i]);
+	    }
+	    else if ( !strcmp (sw, "-inline-mult-task") && (i+1)<argc ) {
+		shift;
+		m_inlineMultTask = atoi(argv[i]);
+	    }
+	    else if ( !strcmp (sw, "-inline-profile") && (i+1)<argc ) {
+		shift;
+		m_inlineProfile = argv[i];
+	    }
+	    else if ( !strcmp (sw, "-branch-profile") && (i+1)<argc ) {
+		shift;
+		m_branchProfile = argv[i];
+	    }
+	    else if ( !strcmp (sw, "-mtask-profile") && (i+1)<argc ) {
+		shift;
+		m_mtaskProfile = argv[i];
+	    }
 	    else if ( !strcmp (sw, "-LDFLAGS") && (i+1)<argc ) {
 		shift;
 		addLdLibs(argv[i]);
@@ -804,10 +903,20 @@ void V3Options::parseOptsList(FileLine* fl, const string& optdir, int argc, char
 	    else if ( !strcmp (sw, "-o") && (i+1)<argc ) {
 		shift; m_exeName = argv[i];
 	    }
+	    else if ( !strcmp (sw, "-output-groups") && (i+1)<argc ) {
+		shift;
+		m_outputGroups = atoi(argv[i]);
+		if (m_outputGroups < 0) fl->v3fatal("--output-groups must be >= 0: "<<argv[i]);
+	    }
 	    else if ( !strcmp (sw, "-output-split") && (i+1)<argc ) {
 		shift;
 		m_outputSplit = atoi(argv[i]);
 	    }
+	    else if ( !strcmp (sw, "-output-split-ccost") && (i+1)<argc ) {
+		shift;
+		m_outputSplitCCost = atoi(argv[i]);
+		if (m_outputSplitCCost < 0) fl->v3fatal("--output-split-ccost must be >= 0: "<<argv[i]);
+	    }
 	    else if ( !strcmp (sw, "-output-split-cfuncs") && (i+1)<argc ) {
 		shift;
 		m_outputSplitCFuncs = atoi(argv[i]);
@@ -820,6 +929,31 @@ void V3Options::parseOptsList(FileLine* fl, const string& optdir, int argc, char
 		shift;
 		m_outputSplitCTrace = atoi(argv[i]);
 	    }
+	    else if ( !strcmp (sw, "-sparse-mem-min") && (i+1)<argc ) {
+		shift;
+		m_sparseMemMin = atoi(argv[i]);
+		if (m_sparseMemMin < 0) fl->v3fatal("--sparse-mem-min must be >= 0: "<<argv[i]);
+	    }
+	    else if ( !strcmp (sw, "-stats-budget-memory") && (i+1)<argc ) {
+		shift;
+		m_statsBudgetMemory = atoi(argv[i]);
+		if (m_statsBudgetMemory < 0) fl->v3fatal("--stats-budget-memory must be >= 0: "<<argv[i]);
+	    }
+	    else if ( !strcmp (sw, "-stats-budget-time") && (i+1)<argc ) {
+		shift;
+		m_statsBudgetTime = atoi(argv[i]);
+		if (m_statsBudgetTime < 0) fl->v3fatal("--stats-budget-time must be >= 0: "<<argv[i]);
+	    }
+	    else if ( !strcmp (sw, "-table-cache") && (i+1)<argc ) {
+		shift;
+		m_tableCache = atoi(argv[i]);
+		if (m_tableCache < 1) fl->v3fatal("--table-cache must be >= 1: "<<argv[i]);
+	    }
+	    else if ( !strcmp (sw, "-threads") && (i+1)<argc ) {
+		shift;
+		m_threads = atoi(argv[i]);
+		if (m_threads < 0) fl->v3fatal("--threads must be >= 0: "<<argv[i]);
+	    }
 	    else if ( !strcmp (sw, "-trace-depth") && (i+1)<argc ) {
 		shift;
 		m_traceDepth = atoi(argv[i]);
@@ -839,10 +973,19 @@ void V3Options::parseOptsList(FileLine* fl, const string& optdir, int argc, char
 		shift;
 		m_unrollCount = atoi(argv[i]);
 	    }
+	    else if ( !strcmp (sw, "-unroll-keep") && (i+1)<argc ) {
+		shift;
+		m_unrollKeep = atoi(argv[i]);
+	    }
 	    else if ( !strcmp (sw, "-unroll-stmts") ) {	// Undocumented optimization tweak
 		shift;
 		m_unrollStmts = atoi(argv[i]);
 	    }
+	    else if ( !strcmp (sw, "-verilate-jobs") && (i+1)<argc ) {
+		shift;
+		m_verilateJobs = atoi(argv[i]);
+		if (m_verilateJobs < 1) fl->v3fatal("--verilate-jobs must be >= 1: "<<argv[i]);
+	    }
 	    else if ( !strcmp (sw, "-v") && (i+1)<argc ) {
 		shift;
 		V3Options::addLibraryFile(parseFileArg(optdir,argv[i]));
@@ -932,6 +1075,9 @@ void V3Options::parseOptsList(FileLine* fl, const string& optdir, int argc, char
 		    fl->v3fatal("Unknown setting for --compiler: "<<argv[i]);
 		}
 	    }
+	    else if ( !strcmp (sw, "-eval-cycles") && (i+1)<argc ) {
+		shift; m_evalCycles = argv[i];
+	    }
 	    else if ( !strcmp (sw, "-F") && (i+1)<argc ) {
 		shift;
 		parseOptsFile(fl, parseFileArg(optdir,argv[i]), true);
@@ -946,6 +1092,10 @@ void V3Options::parseOptsList(FileLine* fl, const string& optdir, int argc, char
 	    else if ( !strcmp (sw, "-gdbbt")) {
 		// Used only in perl shell
 	    }
+	    else if ( !strcmp (sw, "-lazy-output") && (i+1)<argc ) {
+		shift;
+		V3Options::addLazyOutput(argv[i]);
+	    }
 	    else if ( !strcmp (sw, "-mod-prefix") && (i+1)<argc ) {
 		shift; m_modPrefix = argv[i];
 	    }
@@ -956,6 +1106,9 @@ void V3Options::parseOptsList(FileLine* fl, const string& optdir, int argc, char
 	    else if ( !strcmp (sw, "-pipe-filter") && (i+1)<argc ) {
 		shift; m_pipeFilter = argv[i];
 	    }
+	    else if ( !strcmp (sw, "-preproc-cache") && (i+1)<argc ) {
+		shift; m_preprocCache = argv[i];
+	    }
 	    else if ( !strcmp (sw, "-prefix") && (i+1)<argc ) {
 		shift; m_prefix = argv[i];
 		if (m_modPrefix=="") m_modPrefix = m_prefix;
@@ -1155,36 +1308,63 @@ V3Options::V3Options() {
     m_bboxSys = false;
     m_bboxUnsup = false;
     m_cdc = false;
+    m_combineInstances = false;
     m_coverageLine = false;
     m_coverageToggle = false;
     m_coverageUnderscore = false;
     m_coverageUser = false;
     m_debugCheck = false;
     m_decoration = true;
+    m_dumpTreeBinary = false;
+    m_evalDomains = false;
+    m_evalSparse = false;
     m_exe = false;
     m_ignc = false;
     m_inhibitSim = false;
+    m_lanes = false;
+    m_layoutHotCold = false;
+    m_lineDirectives = false;
+    m_linkPorts = false;
     m_lintOnly = false;
     m_makeDepend = true;
     m_makePhony = false;
     m_orderClockDly = true;
+    m_orderLocality = false;
+    m_outputKeepUnchanged = false;
+    m_outputMinIncludes = false;
+    m_outputSplitBalance = false;
+    m_outputSplitStable = false;
     m_outFormatOk = false;
+    m_paramShareUnused = false;
     m_pinsBv = 65;
+    m_pinsChanged = false;
     m_pinsScUint = false;
     m_pinsScBigUint = false;
     m_pinsUint8 = false;
     m_profileCFuncs = false;
+    m_profileActivity = false;
+    m_profileBranches = false;
+    m_profileConverge = false;
+    m_profileCounters = false;
     m_preprocOnly = false;
     m_preprocNoLine = false;
     m_public = false;
+    m_quickBuild = false;
     m_reportUnoptflat = false;
     m_relativeIncludes = false;
+    m_restrictWide = false;
+    m_resetTables = false;
     m_savable = false;
+    m_scSensitiveClocks = false;
+    m_seqGate = false;
     m_skipIdentical = true;
+    m_splitLoopVars = false;
     m_stats = false;
     m_statsVars = false;
     m_systemC = false;
+    m_timeContext = false;
     m_trace = false;
+    m_traceBin = false;
     m_traceDups = false;
     m_traceParams = true;
     m_traceStructs = false;
@@ -1192,26 +1372,42 @@ V3Options::V3Options() {
     m_underlineZero = false;
     m_vpi = false;
     m_xInitialEdge = false;
+    m_xmlCompact = false;
     m_xmlOnly = false;
 
+    m_acyclicFast = 20000;
     m_convergeLimit = 100;
+    m_debugCheckSample = 1;
     m_dumpTree = 0;
+    m_expandLimit = 0;
     m_ifDepth = 0;
     m_inlineMult = 2000;
+    m_inlineMultHot = 20000;
+    m_inlineMultTask = 20000;
+    m_outputGroups = 0;
     m_outputSplit = 0;
+    m_outputSplitCCost = 0;
     m_outputSplitCFuncs = 0;
     m_outputSplitCTrace = 0;
+    m_sparseMemMin = 65536;
+    m_statsBudgetMemory = 0;
+    m_statsBudgetTime = 0;
+    m_tableCache = 256;
+    m_threads = 0;
     m_traceDepth = 0;
     m_traceMaxArray = 32;
     m_traceMaxWidth = 256;
     m_unrollCount = 64;
+    m_unrollKeep = 0;
     m_unrollStmts = 30000;
+    m_verilateJobs = 1;
 
     m_compLimitParens = 0;
     m_compLimitBlocks = 0;
 
     m_makeDir = "obj_dir";
     m_bin = "";
+    m_evalCycles = "";
     m_flags = "";
     m_l2Name = "";
     m_unusedRegexp = "*unused*";
@@ -1288,25 +1484,33 @@ void V3Options::optimize(int level) {
     // Set all optimizations to on/off
     bool flag = level > 0;
     m_oAcycSimp = flag;
+    m_oActiveMerge = flag;
     m_oCase = flag;
     m_oCombine = flag;
     m_oConst = flag;
+    m_oConstIncr = false;  // Experimental, only with -ON
+    m_oCse = flag;
     m_oExpand = flag;
     m_oFlopGater = flag;
     m_oGate = flag;
     m_oInline = flag;
+    m_oInterleave = flag;
     m_oLife = flag;
     m_oLifePost = flag;
     m_oLocalize = flag;
     m_oReorder = flag;
+    m_oResetFast = flag;
     m_oSplit = flag;
     m_oSubst = flag;
     m_oSubstConst = flag;
     m_oTable = flag;
+    m_oTempReuse = flag;
     m_oDedupe = flag;
     m_oAssemble = flag;
     // And set specific optimization levels
     if (level >= 3) {
 	m_inlineMult = -1;	// Maximum inlining
+	m_inlineMultHot = -1;
+	m_inlineMultTask = -1;
     }
 }
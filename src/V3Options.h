@@ -55,6 +55,7 @@ class V3Options {
     V3StringSet	m_libraryFiles;	// argument: Verilog -v files
     V3StringSet	m_clockers;	// argument: Verilog -clk signals
     V3StringSet	m_noClockers;	// argument: Verilog -noclk signals
+    V3StringSet	m_lazyOutputs;	// argument: --lazy-output signals
     V3StringList m_vFiles;	// argument: Verilog files to read
     V3StringList m_forceIncs;	// argument: -FI
     DebugSrcMap m_debugSrcs;	// argument: --debugi-<srcfile>=<level>
@@ -71,31 +72,58 @@ class V3Options {
     bool	m_bboxSys;	// main switch: --bbox-sys
     bool	m_bboxUnsup;	// main switch: --bbox-unsup
     bool	m_cdc;		// main switch: --cdc
+    bool	m_combineInstances; // main switch: --combine-instances
     bool	m_coverageLine;	// main switch: --coverage-block
     bool	m_coverageToggle;// main switch: --coverage-toggle
     bool	m_coverageUnderscore;// main switch: --coverage-underscore
     bool	m_coverageUser;	// main switch: --coverage-func
     bool	m_debugCheck;	// main switch: --debug-check
     bool	m_decoration;	// main switch: --decoration
+    bool	m_dumpTreeBinary; // main switch: --dump-tree-binary
+    bool	m_evalDomains;	// main switch: --eval-domains
+    bool	m_evalSparse;	// main switch: --eval-sparse
     bool	m_exe;		// main switch: --exe
     bool	m_ignc;		// main switch: --ignc
     bool	m_inhibitSim;	// main switch: --inhibit-sim
+    bool	m_lanes;	// main switch: --lanes
+    bool	m_layoutHotCold;// main switch: --layout-hot-cold
+    bool	m_lineDirectives;// main switch: --line-directives
+    bool	m_linkPorts;	// main switch: --link-ports
     bool	m_lintOnly;	// main switch: --lint-only
     bool	m_orderClockDly;// main switch: --order-clock-delay
+    bool	m_orderLocality;// main switch: --order-locality
     bool	m_outFormatOk;	// main switch: --cc, --sc or --sp was specified
+    bool	m_outputKeepUnchanged; // main switch: --output-keep-unchanged
+    bool	m_outputMinIncludes; // main switch: --output-min-includes
+    bool	m_outputSplitBalance; // main switch: --output-split-balance
+    bool	m_outputSplitStable; // main switch: --output-split-stable
+    bool	m_paramShareUnused; // main switch: --param-share-unused
+    bool	m_pinsChanged;	// main switch: --pins-changed
     bool	m_pinsScUint;   // main switch: --pins-sc-uint
     bool	m_pinsScBigUint;// main switch: --pins-sc-biguint
     bool	m_pinsUint8;	// main switch: --pins-uint8
+    bool	m_profileActivity;// main switch: --profile-activity
+    bool	m_profileBranches;// main switch: --profile-branches
     bool	m_profileCFuncs;// main switch: --profile-cfuncs
+    bool	m_profileConverge;// main switch: --profile-converge
+    bool	m_profileCounters;// main switch: --profile-counters
     bool	m_public;	// main switch: --public
+    bool	m_quickBuild;	// main switch: --quick-build
     bool	m_reportUnoptflat; // main switch: --report-unoptflat
     bool	m_relativeIncludes; // main switch: --relative-includes
+    bool	m_restrictWide;	// main switch: --restrict-wide
+    bool	m_resetTables;	// main switch: --reset-tables
     bool	m_savable;	// main switch: --savable
+    bool	m_scSensitiveClocks; // main switch: --sc-sensitive-clocks
+    bool	m_seqGate;	// main switch: --seq-gate
     bool	m_systemC;	// main switch: --sc: System C instead of simple C++
     bool	m_skipIdentical;// main switch: --skip-identical
+    bool	m_splitLoopVars;// main switch: --split-loop-vars
     bool	m_stats;	// main switch: --stats
     bool	m_statsVars;	// main switch: --stats-vars
+    bool	m_timeContext;	// main switch: --time-context
     bool	m_trace;	// main switch: --trace
+    bool	m_traceBin;	// main switch: --trace-bin
     bool	m_traceDups;	// main switch: --trace-dups
     bool	m_traceParams;	// main switch: --trace-params
     bool	m_traceStructs;	// main switch: --trace-structs
@@ -103,26 +131,42 @@ class V3Options {
     bool	m_underlineZero;// main switch: --underline-zero; undocumented old Verilator 2
     bool	m_vpi;		// main switch: --vpi
     bool	m_xInitialEdge;	// main switch: --x-initial-edge
+    bool	m_xmlCompact;	// main switch: --xml-compact
     bool	m_xmlOnly;	// main switch: --xml-netlist
 
+    int		m_acyclicFast;	// main switch: --acyclic-fast
     int		m_convergeLimit;// main switch: --converge-limit
+    int		m_debugCheckSample; // main switch: --debug-check-sample
     int		m_dumpTree;	// main switch: --dump-tree
+    int		m_expandLimit;	// main switch: --expand-limit
     int		m_ifDepth;	// main switch: --if-depth
     int		m_inlineMult;	// main switch: --inline-mult
+    int		m_inlineMultHot; // main switch: --inline-mult-hot
+    int		m_inlineMultTask; // main switch: --inline-mult-task
+    int		m_outputGroups;	// main switch: --output-groups
     int		m_outputSplit;	// main switch: --output-split
+    int		m_outputSplitCCost;// main switch: --output-split-ccost
     int		m_outputSplitCFuncs;// main switch: --output-split-cfuncs
     int		m_outputSplitCTrace;// main switch: --output-split-ctrace
     int		m_pinsBv;	// main switch: --pins-bv
+    int		m_sparseMemMin;	// main switch: --sparse-mem-min
+    int		m_statsBudgetMemory;// main switch: --stats-budget-memory
+    int		m_statsBudgetTime;// main switch: --stats-budget-time
+    int		m_tableCache;	// main switch: --table-cache
+    int		m_threads;	// main switch: --threads
     int		m_traceDepth;	// main switch: --trace-depth
     int		m_traceMaxArray;// main switch: --trace-max-array
     int		m_traceMaxWidth;// main switch: --trace-max-width
     int		m_unrollCount;	// main switch: --unroll-count
+    int		m_unrollKeep;	// main switch: --unroll-keep
     int		m_unrollStmts;	// main switch: --unroll-stmts
+    int		m_verilateJobs;	// main switch: --verilate-jobs
 
     int		m_compLimitBlocks;	// compiler selection options
     int		m_compLimitParens;	// compiler selection options
 
     string	m_bin;		// main switch: --bin {binary}
+    string	m_evalCycles;	// main switch: --eval-cycles {clock}
     string	m_exeName;	// main switch: -o {name}
     string	m_flags;	// main switch: -f {name}
     string	m_l2Name;	// main switch: --l2name; "" for top-module's name
@@ -130,6 +174,10 @@ class V3Options {
     string	m_modPrefix;	// main switch: --mod-prefix
     string	m_pipeFilter;	// main switch: --pipe-filter
     string	m_prefix;	// main switch: --prefix
+    string	m_inlineProfile; // main switch: --inline-profile
+    string	m_branchProfile; // main switch: --branch-profile
+    string	m_mtaskProfile;	// main switch: --mtask-profile
+    string	m_preprocCache;	// main switch: --preproc-cache
     string	m_topModule;	// main switch: --top-module
     string	m_unusedRegexp;	// main switch: --unused-regexp
     string	m_xAssign;	// main switch: --x-assign
@@ -140,10 +188,13 @@ class V3Options {
 
     // MEMBERS (optimizations)
     //				// main switch: -Op: --public
+    bool	m_oActiveMerge;	// main switch: -Ov: merge same sensitivity actives
     bool	m_oAcycSimp;	// main switch: -Oy: acyclic pre-optimizations
     bool	m_oCase;	// main switch: -Oe: case tree conversion
     bool	m_oCombine;	// main switch: -Ob: common icode packing
     bool	m_oConst;	// main switch: -Oc: constant folding
+    bool	m_oConstIncr;	// main switch: -ON: incremental constant folding (off by default)
+    bool	m_oCse;		// main switch: -Oh: common subexpression elimination
     bool	m_oDedupe;	// main switch: -Od: logic deduplication
     bool	m_oAssemble;	// main switch: -Om: assign assemble 
     bool	m_oExpand;	// main switch: -Ox: expansion of C macros
@@ -153,11 +204,14 @@ class V3Options {
     bool	m_oLifePost;	// main switch: -Ot: delayed assignment elimination
     bool	m_oLocalize;	// main switch: -Oz: convert temps to local variables
     bool	m_oInline;	// main switch: -Oi: module inlining
+    bool	m_oInterleave;	// main switch: -Oj: interleave independent statements
+    bool	m_oResetFast;	// main switch: -Oq: async reset fast path
     bool	m_oReorder;	// main switch: -Or: reorder assignments in blocks
     bool	m_oSplit;	// main switch: -Os: always assignment splitting
     bool	m_oSubst;	// main switch: -Ou: substitute expression temp values
     bool	m_oSubstConst;	// main switch: -Ok: final constant substitution
     bool	m_oTable;	// main switch: -Oa: lookup table creation
+    bool	m_oTempReuse;	// main switch: -Ow: wide temporary reuse
 
   private:
     // METHODS
@@ -177,6 +231,7 @@ class V3Options {
     string parseFileArg(const string& optdir, const string& relfilename);
     bool parseLangExt(const char* swp, const char* langswp, const V3LangCode& lc);
     string filePathCheckOneDir(const string& modname, const string& dirname);
+    string filePathSearch(const string& modname, const string& lastpath);
 
     V3Options(const V3Options&); ///< N/A, no copy constructor
 
@@ -197,6 +252,7 @@ class V3Options {
     void addLibraryFile(const string& filename);
     void addClocker(const string& signame);
     void addNoClocker(const string& signame);
+    void addLazyOutput(const string& signame);
     void addVFile(const string& filename);
     void addForceInc(const string& filename);
 
@@ -211,66 +267,114 @@ class V3Options {
     bool systemC() const { return m_systemC; }
     bool usingSystemCLibs() const { return !lintOnly() && systemC(); }
     bool savable() const { return m_savable; }
+    bool scSensitiveClocks() const { return m_scSensitiveClocks; }
+    bool seqGate() const { return m_seqGate; }
     bool skipIdentical() const { return m_skipIdentical; }
+    bool splitLoopVars() const { return m_splitLoopVars; }
     bool stats() const { return m_stats; }
     bool statsVars() const { return m_statsVars; }
+    bool timeContext() const { return m_timeContext; }
+    int statsBudgetMemory() const { return m_statsBudgetMemory; }
+    int statsBudgetTime() const { return m_statsBudgetTime; }
     bool assertOn() const { return m_assert; }  // assertOn as __FILE__ may be defined
     bool autoflush() const { return m_autoflush; }
     bool bboxSys() const { return m_bboxSys; }
     bool bboxUnsup() const { return m_bboxUnsup; }
     bool cdc() const { return m_cdc; }
+    bool combineInstances() const { return m_combineInstances; }
     bool coverage() const { return m_coverageLine || m_coverageToggle || m_coverageUser; }
     bool coverageLine() const { return m_coverageLine; }
     bool coverageToggle() const { return m_coverageToggle; }
     bool coverageUnderscore() const { return m_coverageUnderscore; }
     bool coverageUser() const { return m_coverageUser; }
     bool debugCheck() const { return m_debugCheck; }
+    bool dumpTreeBinary() const { return m_dumpTreeBinary; }
     bool decoration() const { return m_decoration; }
+    bool evalDomains() const { return m_evalDomains; }
+    bool evalSparse() const { return m_evalSparse; }
     bool exe() const { return m_exe; }
+    bool lanes() const { return m_lanes; }
     bool trace() const { return m_trace; }
+    bool traceBin() const { return m_traceBin; }
     bool traceDups() const { return m_traceDups; }
     bool traceParams() const { return m_traceParams; }
     bool traceStructs() const { return m_traceStructs; }
     bool traceUnderscore() const { return m_traceUnderscore; }
+    bool layoutHotCold() const { return m_layoutHotCold; }
     bool orderClockDly() const { return m_orderClockDly; }
+    bool orderLocality() const { return m_orderLocality; }
     bool outFormatOk() const { return m_outFormatOk; }
+    bool outputKeepUnchanged() const { return m_outputKeepUnchanged; }
+    bool outputMinIncludes() const { return m_outputMinIncludes; }
+    bool outputSplitBalance() const { return m_outputSplitBalance; }
+    bool outputSplitStable() const { return m_outputSplitStable; }
+    bool paramShareUnused() const { return m_paramShareUnused; }
     bool keepTempFiles() const { return (V3Error::debugDefault()!=0); }
+    bool pinsChanged() const { return m_pinsChanged; }
     bool pinsScUint() const { return m_pinsScUint; }
     bool pinsScBigUint() const { return m_pinsScBigUint; }
     bool pinsUint8() const { return m_pinsUint8; }
+    bool profileActivity() const { return m_profileActivity; }
+    bool profileBranches() const { return m_profileBranches; }
     bool profileCFuncs() const { return m_profileCFuncs; }
+    bool profileConverge() const { return m_profileConverge; }
+    bool profileCounters() const { return m_profileCounters; }
     bool allPublic() const { return m_public; }
+    bool quickBuild() const { return m_quickBuild; }
     bool lintOnly() const { return m_lintOnly; }
+    bool lineDirectives() const { return m_lineDirectives; }
+    bool linkPorts() const { return m_linkPorts; }
     bool ignc() const { return m_ignc; }
     bool inhibitSim() const { return m_inhibitSim; }
     bool reportUnoptflat() const { return m_reportUnoptflat; }
+    bool restrictWide() const { return m_restrictWide; }
+    bool resetTables() const { return m_resetTables; }
     bool vpi() const { return m_vpi; }
     bool xInitialEdge() const { return m_xInitialEdge; }
+    bool xmlCompact() const { return m_xmlCompact; }
     bool xmlOnly() const { return m_xmlOnly; }
 
+    int	   acyclicFast() const { return m_acyclicFast; }
     int	   convergeLimit() const { return m_convergeLimit; }
+    int	   debugCheckSample() const { return m_debugCheckSample; }
     int    dumpTree() const { return m_dumpTree; }
+    int	   expandLimit() const { return m_expandLimit; }
     int	   ifDepth() const { return m_ifDepth; }
     int	   inlineMult() const { return m_inlineMult; }
+    int	   inlineMultHot() const { return m_inlineMultHot; }
+    int	   inlineMultTask() const { return m_inlineMultTask; }
+    int	   outputGroups() const { return m_outputGroups; }
     int	   outputSplit() const { return m_outputSplit; }
+    int	   outputSplitCCost() const { return m_outputSplitCCost; }
     int	   outputSplitCFuncs() const { return m_outputSplitCFuncs; }
     int	   outputSplitCTrace() const { return m_outputSplitCTrace; }
     int	   pinsBv() const { return m_pinsBv; }
+    int	   sparseMemMin() const { return m_sparseMemMin; }
+    int	   tableCache() const { return m_tableCache; }
+    int	   threads() const { return m_threads; }
+    bool   mtasks() const { return m_threads > 1; }
     int	   traceDepth() const { return m_traceDepth; }
     int	   traceMaxArray() const { return m_traceMaxArray; }
     int	   traceMaxWidth() const { return m_traceMaxWidth; }
     int	   unrollCount() const { return m_unrollCount; }
+    int	   unrollKeep() const { return m_unrollKeep; }
     int	   unrollStmts() const { return m_unrollStmts; }
+    int	   verilateJobs() const { return m_verilateJobs; }
 
     int    compLimitBlocks() const { return m_compLimitBlocks; }
     int    compLimitParens() const { return m_compLimitParens; }
 
+    string evalCycles() const { return m_evalCycles; }
     string exeName() const { return m_exeName!="" ? m_exeName : prefix(); }
     string l2Name() const { return m_l2Name; }
     string makeDir() const { return m_makeDir; }
     string modPrefix() const { return m_modPrefix; }
     string pipeFilter() const { return m_pipeFilter; }
+    string preprocCache() const { return m_preprocCache; }
     string prefix() const { return m_prefix; }
+    string inlineProfile() const { return m_inlineProfile; }
+    string branchProfile() const { return m_branchProfile; }
+    string mtaskProfile() const { return m_mtaskProfile; }
     string topModule() const { return m_topModule; }
     string unusedRegexp() const { return m_unusedRegexp; }
     string xAssign() const { return m_xAssign; }
@@ -291,12 +395,17 @@ class V3Options {
     bool isLibraryFile(const string& filename) const;
     bool isClocker(const string& signame) const;
     bool isNoClocker(const string& signame) const;
+    bool isLazyOutput(const string& signame) const;
+    bool lazyOutputs() const { return !m_lazyOutputs.empty(); }
 
     // ACCESSORS (optimization options)
+    bool oActiveMerge() const { return m_oActiveMerge; }
     bool oAcycSimp() const { return m_oAcycSimp; }
     bool oCase() const { return m_oCase; }
     bool oCombine() const { return m_oCombine; }
     bool oConst() const { return m_oConst; }
+    bool oConstIncr() const { return m_oConstIncr; }
+    bool oCse() const { return m_oCse; }
     bool oDedupe() const { return m_oDedupe; }
     bool oAssemble() const { return m_oAssemble; }
     bool oExpand() const { return m_oExpand; }
@@ -307,14 +416,17 @@ class V3Options {
     bool oLifePost() const { return m_oLifePost; }
     bool oLocalize() const { return m_oLocalize; }
     bool oInline() const { return m_oInline; }
+    bool oInterleave() const { return m_oInterleave; }
+    bool oResetFast() const { return m_oResetFast; }
     bool oReorder() const { return m_oReorder; }
     bool oSplit() const { return m_oSplit; }
     bool oSubst() const { return m_oSubst; }
     bool oSubstConst() const { return m_oSubstConst; }
     bool oTable() const { return m_oTable; }
+    bool oTempReuse() const { return m_oTempReuse; }
 
     // METHODS (uses above)
-    string traceClassBase() const { return "VerilatedVcd"; }
+    string traceClassBase() const { return traceBin() ? "VerilatedBin" : "VerilatedVcd"; }
 
     // METHODS (from main)
     static string version();
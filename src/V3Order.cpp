@@ -66,6 +66,9 @@
 //
 //   Rank the graph starting at INPUTS (see V3Graph)
 //
+//   With --lazy-output, comb logic that only feeds those outputs
+//   moves to a domain sensitive to __Vlazy_req, set by evalLazy()
+//
 //   Visit the graph's logic vertices in ranked order
 //	For all logic vertices with all inputs already ordered
 //	   Make ordered block for this module
@@ -80,6 +83,7 @@
 #include "verilatedos.h"
 #include <cstdio>
 #include <cstdarg>
+#include <climits>
 #include <unistd.h>
 #include <algorithm>
 #include <vector>
@@ -105,6 +109,11 @@
 
 class OrderMoveDomScope;
 
+// --order-locality: ready vertices examined per pick, and how many recently
+// moved statements count as "recent" when scoring shared variables
+static const int ORDER_LOCALITY_SCAN = 32;
+static const int ORDER_LOCALITY_WINDOW = 16;
+
 //######################################################################
 // Functions for above graph classes
 
@@ -421,6 +430,39 @@ public:
 };
 
 
+//######################################################################
+// The class used to check logic has no effect besides its assignments,
+// so may be evaluated lazily
+
+class OrderLazyCheckVisitor : public AstNVisitor {
+private:
+    bool m_pure;	// No side effects seen
+
+    // VISITORS
+    virtual void visit(AstAlways* nodep) { nodep->bodysp()->iterateAndNext(*this); }
+    virtual void visit(AstNodeAssign* nodep) { nodep->iterateChildren(*this); }
+    virtual void visit(AstNodeIf* nodep) { nodep->iterateChildren(*this); }
+    virtual void visit(AstWhile* nodep) { nodep->iterateChildren(*this); }
+    virtual void visit(AstBegin* nodep) { nodep->iterateChildren(*this); }
+    virtual void visit(AstComment*) {}
+    virtual void visit(AstCMath*) { m_pure = false; }
+    virtual void visit(AstUCFunc*) { m_pure = false; }
+    virtual void visit(AstRand*) { m_pure = false; }
+    virtual void visit(AstNodeMath* nodep) { nodep->iterateChildren(*this); }
+    virtual void visit(AstNode*) { m_pure = false; }	// Calls, displays, and so on
+
+public:
+    // CONSTUCTORS
+    explicit OrderLazyCheckVisitor(AstNode* nodep) {
+	m_pure = true;
+	nodep->accept(*this);
+    }
+    virtual ~OrderLazyCheckVisitor() {}
+
+    // METHODS
+    bool isPure() const { return m_pure; }
+};
+
 //######################################################################
 // Order class functions
 
@@ -449,6 +491,7 @@ private:
     AstSenTree*		m_comboDomainp;	// Combo activation tree
     AstSenTree*		m_deleteDomainp;// Delete this from tree
     AstSenTree*		m_settleDomainp;// Initial activation tree
+    AstSenTree*		m_lazyDomainp;	// Lazy activation tree, with --lazy-output
     OrderInputsVertex*	m_inputsVxp;	// Top level vertex all inputs point from
     OrderSettleVertex*	m_settleVxp;	// Top level vertex all settlement vertexes point from
     OrderLogicVertex*	m_logicVxp;	// Current statement being tracked, NULL=ignored
@@ -470,8 +513,18 @@ private:
     vector<OrderLoopBeginVertex*> m_pomLoopMoveps;// processMoveLoop: Loops next nodes are under
     AstCFunc*			m_pomNewFuncp;	// Current function being created
     int				m_pomNewStmts;	// Statements in function being created
+    int				m_pomNewCost;	// Estimated cost of function being created
     V3Graph			m_pomGraph;	// Graph of logic elements to move
     V3List<OrderMoveVertex*>	m_pomWaiting;	// List of nodes needing inputs to become ready
+    int				m_mtaskNum;	// Number of macro-task functions created
+    typedef std::map<string,double> MTaskProfMap;
+    MTaskProfMap		m_mtaskProf;	// Ticks per call of each cluster, from --mtask-profile
+    // STATE... for --order-locality
+    typedef std::map<AstVarScope*,int> LocalityStampMap;
+    typedef std::map<AstVar*,int> LocalityRankMap;
+    LocalityStampMap		m_pomVarStamp;	// Statement number each varscope was last used by
+    LocalityRankMap		m_pomVarRank;	// Order each var was first used in
+    int				m_pomStamp;	// Statements moved so far
 protected:
     friend class OrderMoveDomScope;
     V3List<OrderMoveDomScope*>  m_pomReadyDomScope;	// List of ready domain/scope pairs, by loopId
@@ -480,6 +533,12 @@ protected:
 private:
     // STATS
     V3Double0		m_statCut[OrderVEdgeType::_ENUM_END];	// Count of each edge type cut
+    V3Double0		m_statMTasks;	// Macro-tasks created
+    V3Double0		m_statMTaskGroups;	// Concurrent macro-task groups created
+    V3Double0		m_statMTaskProfiled;	// Clusters costed from --mtask-profile
+    V3Double0		m_statLocalityPicks;	// Statements moved ahead for locality
+    V3Double0		m_statLocalityVars;	// Variables placed in first-use order
+    V3Double0		m_statLazy;	// Logic blocks moved to the lazy domain
 
     // TYPES
     enum VarUsage { VU_NONE=0, VU_CON=1, VU_GEN=2 };
@@ -554,6 +613,8 @@ private:
     void processSensitive();
     void processDomains();
     void processDomainsIterate(OrderEitherVertex* vertexp);
+    void processLazy();
+    bool processLazyVar(OrderVarVertex* vvertexp, int depth);
     void processEdgeReport();
 
     void processMove();
@@ -565,11 +626,36 @@ private:
     void processMoveReadyOne(OrderMoveVertex* vertexp);
     void processMoveDoneOne(OrderMoveVertex* vertexp);
     void processMoveOne(OrderMoveVertex* vertexp, OrderMoveDomScope* domScopep, int level);
+    void processMoveLocalityVars(OrderMoveVertex* vertexp, vector<AstVarScope*>& varscps);
+    OrderMoveVertex* processMoveLocalityPick(OrderMoveDomScope* domScopep);
+    void processMoveLocalityTouch(OrderMoveVertex* vertexp);
+    void processMoveLocalityPlace(AstNetlist* netlistp);
+    typedef vector<OrderMoveVertex*> MoveVec;
+    void processMTasks();
+    void processMTasksDomain(AstSenTree* domainp, const MoveVec& vertices);
+    void processMTasksMove(AstSenTree* domainp, const MoveVec& vertices, AstNode* callUnderp);
+    void processMTasksProfile(const vector<MoveVec>& clusters, vector<int>& costs);
+    void readMTaskProfile(const string& filename);
+    static string mtaskClusterName(const MoveVec& cluster) {
+	// Named by the first logic's source line, so it's found again after re-Verilation
+	FileLine* fl = cluster.front()->logicp()->nodep()->fileline();
+	return "mtask_cluster "+fl->filename()+":"+cvtToStr(fl->lineno());
+    }
     void processMoveLoopPush(OrderLoopBeginVertex* beginp);
     void processMoveLoopPop(OrderLoopBeginVertex* beginp);
     void processMoveLoopStmt(AstNode* newSubnodep);
     OrderLoopId processMoveLoopCurrent();
 
+    static bool splitCounting() {
+	return v3Global.opt.outputSplitCFuncs() || v3Global.opt.outputSplitCCost();
+    }
+    static bool splitNeeded(int stmts, int cost) {
+	// Statements are split only between logic vertices, where no values are
+	// live across the call, so only the size of the function matters
+	return ((v3Global.opt.outputSplitCFuncs() && v3Global.opt.outputSplitCFuncs() < stmts)
+		|| (v3Global.opt.outputSplitCCost() && v3Global.opt.outputSplitCCost() < cost));
+    }
+
     string cfuncName(AstNodeModule* modp, AstSenTree* domainp, AstScope* scopep, AstNode* forWhatp) {
 	modp->user3Inc();
 	int funcnum = modp->user3();
@@ -1011,6 +1097,7 @@ public:
 	m_comboDomainp = NULL;
 	m_deleteDomainp = NULL;
 	m_settleDomainp = NULL;
+	m_lazyDomainp = NULL;
 	m_settleVxp = NULL;
 	m_inputsVxp = NULL;
 	m_activeSenVxp = NULL;
@@ -1018,7 +1105,13 @@ public:
 	m_pomNewFuncp = NULL;
 	m_loopIdMax = LOOPID_FIRST;
 	m_pomNewStmts = 0;
+	m_pomNewCost = 0;
+	m_mtaskNum = 0;
+	m_pomStamp = 0;
 	if (debug()) m_graph.debug(5); // 3 is default if global debug; we want acyc debugging
+	if (v3Global.opt.mtasks() && v3Global.opt.mtaskProfile() != "") {
+	    readMTaskProfile(v3Global.opt.mtaskProfile());
+	}
     }
     virtual ~OrderVisitor() {
 	// Stats
@@ -1027,6 +1120,18 @@ public:
 		V3Stats::addStat(string("Order, cut, ")+OrderVEdgeType(type).ascii(), count);
 	    }
 	}
+	if (v3Global.opt.mtasks()) {
+	    V3Stats::addStat("Order, MTask, macro-tasks", m_statMTasks);
+	    V3Stats::addStat("Order, MTask, concurrent groups", m_statMTaskGroups);
+	    V3Stats::addStat("Order, MTask, profiled clusters", m_statMTaskProfiled);
+	}
+	if (v3Global.opt.lazyOutputs()) {
+	    V3Stats::addStat("Order, Lazy logic blocks", m_statLazy);
+	}
+	if (v3Global.opt.orderLocality()) {
+	    V3Stats::addStat("Order, Locality statements moved ahead", m_statLocalityPicks);
+	    V3Stats::addStat("Order, Locality variables placed", m_statLocalityVars);
+	}
 	// Destruction
 	for (deque<OrderUser*>::iterator it=m_orderUserps.begin(); it!=m_orderUserps.end(); ++it) {
 	    delete *it;
@@ -1287,6 +1392,82 @@ void OrderVisitor::processDomainsIterate(OrderEitherVertex* vertexp) {
     }
 }
 
+//######################################################################
+// Lazy outputs
+
+bool OrderVisitor::processLazyVar(OrderVarVertex* vvertexp, int depth) {
+    // True if the variable is only read by lazy logic, or is a lazy output
+    AstVarScope* vscp = vvertexp->varScp();
+    AstVar* varp = vscp->varp();
+    bool lazyOut = (vscp->scopep() == m_scopetopp && varp->isOutput()
+		    && v3Global.opt.isLazyOutput(varp->name()));
+    if (depth > 8 || vscp->isCircular()) return false;
+    if (!lazyOut && (varp->isIO() || varp->isSigPublic()
+		     || (v3Global.opt.trace() && varp->isTrace()))) return false;
+    bool used = lazyOut;
+    for (V3GraphEdge* edgep = vvertexp->outBeginp(); edgep; edgep=edgep->outNextp()) {
+	if (OrderVarVertex* toVVertexp = dynamic_cast<OrderVarVertex*>(edgep->top())) {
+	    if (!processLazyVar(toVVertexp, depth+1)) return false;
+	} else {
+	    OrderLogicVertex* toLVertexp = dynamic_cast<OrderLogicVertex*>(edgep->top());
+	    if (!toLVertexp || !toLVertexp->user()) return false;
+	    used = true;
+	}
+    }
+    return used;
+}
+
+void OrderVisitor::processLazy() {
+    // Move combo logic that only feeds lazy outputs into a domain evaluated on request.
+    // Start with all pure combo logic as candidates, then drop any whose results reach
+    // other logic, until none change.
+    if (!v3Global.opt.lazyOutputs()) return;
+    m_graph.userClearVertices();  // Vertex::user()   // 1 if lazy candidate
+    for (V3GraphVertex* itp = m_graph.verticesBeginp(); itp; itp=itp->verticesNextp()) {
+	OrderLogicVertex* lvertexp = dynamic_cast<OrderLogicVertex*>(itp);
+	if (lvertexp && lvertexp->type() == OrderVEdgeType::VERTEX_LOGIC
+	    && lvertexp->domainp() == m_comboDomainp
+	    && lvertexp->inLoop() == LOOPID_NOTLOOPED
+	    && lvertexp->outBeginp()
+	    && OrderLazyCheckVisitor(lvertexp->nodep()).isPure()) {
+	    lvertexp->user(1);
+	}
+    }
+    for (bool changed = true; changed; ) {
+	changed = false;
+	for (V3GraphVertex* itp = m_graph.verticesBeginp(); itp; itp=itp->verticesNextp()) {
+	    if (!itp->user()) continue;
+	    for (V3GraphEdge* edgep = itp->outBeginp(); edgep; edgep=edgep->outNextp()) {
+		OrderVarVertex* vvertexp = dynamic_cast<OrderVarVertex*>(edgep->top());
+		if (!vvertexp || !processLazyVar(vvertexp, 0)) {
+		    itp->user(0);
+		    changed = true;
+		    break;
+		}
+	    }
+	}
+    }
+    for (V3GraphVertex* itp = m_graph.verticesBeginp(); itp; itp=itp->verticesNextp()) {
+	if (!itp->user()) continue;
+	OrderLogicVertex* lvertexp = static_cast<OrderLogicVertex*>(itp);
+	if (!m_lazyDomainp) {
+	    // Created only when needed; V3EmitC's evalLazy() sets it
+	    FileLine* fl = m_scopetopp->fileline();
+	    AstVar* varp = new AstVar(fl, AstVarType::MODULETEMP, "__Vlazy_req", VFlagLogicPacked(), 1);
+	    m_scopetopp->modp()->addStmtp(varp);
+	    AstVarScope* vscp = new AstVarScope(fl, m_scopetopp, varp);
+	    m_scopetopp->addVarp(vscp);
+	    AstSenTree* lazyp = new AstSenTree(fl, new AstSenItem(fl, AstEdgeType::ET_HIGHEDGE,
+								  new AstVarRef(fl, vscp, false)));
+	    m_lazyDomainp = m_finder.getSenTree(fl, lazyp);
+	    pushDeletep(lazyp);  // Cleanup when done
+	}
+	UINFO(5,"    Lazy "<<lvertexp<<endl);
+	lvertexp->domainp(m_lazyDomainp);
+	++m_statLazy;
+    }
+}
+
 //######################################################################
 // Move graph construction
 
@@ -1406,8 +1587,15 @@ void OrderVisitor::processMove() {
 	    UINFO(6,"   MoveDomain l="<<domScopep->domainp()<<endl);
 	    // Process all nodes ready under same domain & scope
 	    m_pomNewFuncp = NULL;
-	    while (OrderMoveVertex* vertexp = domScopep->readyVertices().begin()) { // lintok-begin-on-ref
-		processMoveOne(vertexp, domScopep, 1);
+	    if (v3Global.opt.orderLocality()) {
+		while (OrderMoveVertex* vertexp = processMoveLocalityPick(domScopep)) {
+		    processMoveLocalityTouch(vertexp);
+		    processMoveOne(vertexp, domScopep, 1);
+		}
+	    } else {
+		while (OrderMoveVertex* vertexp = domScopep->readyVertices().begin()) { // lintok-begin-on-ref
+		    processMoveOne(vertexp, domScopep, 1);
+		}
 	    }
 	    // Done with scope/domain pair, pick new scope under same domain, or NULL if none left
 	    OrderMoveDomScope* domScopeNextp = NULL;
@@ -1424,6 +1612,111 @@ void OrderVisitor::processMove() {
     UASSERT (m_pomWaiting.empty(), "Didn't converge; nodes waiting, none ready, perhaps some input activations lost.");
     // Cleanup memory
     processMoveClear();
+    if (v3Global.opt.orderLocality()) processMoveLocalityPlace(v3Global.rootp());
+}
+
+//######################################################################
+// Locality ordering (--order-locality)
+
+void OrderVisitor::processMoveLocalityVars(OrderMoveVertex* vertexp, vector<AstVarScope*>& varscps) {
+    // Variables the logic under this move vertex reads or writes
+    varscps.clear();
+    OrderLogicVertex* lvertexp = vertexp->logicp();
+    for (V3GraphEdge* edgep = lvertexp->inBeginp(); edgep; edgep=edgep->inNextp()) {
+	if (OrderVarVertex* vvertexp = dynamic_cast<OrderVarVertex*>(edgep->fromp())) {
+	    varscps.push_back(vvertexp->varScp());
+	}
+    }
+    for (V3GraphEdge* edgep = lvertexp->outBeginp(); edgep; edgep=edgep->outNextp()) {
+	if (OrderVarVertex* vvertexp = dynamic_cast<OrderVarVertex*>(edgep->top())) {
+	    varscps.push_back(vvertexp->varScp());
+	}
+    }
+}
+
+OrderMoveVertex* OrderVisitor::processMoveLocalityPick(OrderMoveDomScope* domScopep) {
+    // Among the first few vertices ready under this domain & scope, pick the one
+    // touching the most variables used by recently moved statements.
+    // Ties keep the normal (ranked, depth first) order.
+    OrderMoveVertex* bestp = domScopep->readyVertices().begin(); // lintok-begin-on-ref
+    if (!bestp || !bestp->readyVerticesNextp()) return bestp;
+    int bestScore = -1;
+    int scanned = 0;
+    vector<AstVarScope*> varscps;
+    for (OrderMoveVertex* vertexp = bestp;
+	 vertexp && scanned < ORDER_LOCALITY_SCAN;
+	 vertexp = vertexp->readyVerticesNextp(), ++scanned) {
+	int score = 0;
+	processMoveLocalityVars(vertexp, varscps);
+	for (vector<AstVarScope*>::iterator it = varscps.begin(); it != varscps.end(); ++it) {
+	    LocalityStampMap::iterator sit = m_pomVarStamp.find(*it);
+	    if (sit != m_pomVarStamp.end()
+		&& sit->second > m_pomStamp - ORDER_LOCALITY_WINDOW) {
+		++score;
+	    }
+	}
+	if (score > bestScore) {
+	    bestScore = score;
+	    bestp = vertexp;
+	}
+    }
+    if (bestp != domScopep->readyVertices().begin()) ++m_statLocalityPicks; // lintok-begin-on-ref
+    return bestp;
+}
+
+void OrderVisitor::processMoveLocalityTouch(OrderMoveVertex* vertexp) {
+    // Record the variables of a vertex about to be moved
+    ++m_pomStamp;
+    vector<AstVarScope*> varscps;
+    processMoveLocalityVars(vertexp, varscps);
+    for (vector<AstVarScope*>::iterator it = varscps.begin(); it != varscps.end(); ++it) {
+	m_pomVarStamp[*it] = m_pomStamp;
+	AstVar* varp = (*it)->varp();
+	if (m_pomVarRank.find(varp) == m_pomVarRank.end()) {
+	    int rank = m_pomVarRank.size();
+	    m_pomVarRank.insert(make_pair(varp, rank));
+	}
+    }
+}
+
+struct OrderLocalityRankCmp {
+    const std::map<AstVar*,int>& m_rankMap;
+    explicit OrderLocalityRankCmp(const std::map<AstVar*,int>& rankMap) : m_rankMap(rankMap) {}
+    int rank(AstVar* varp) const {
+	std::map<AstVar*,int>::const_iterator it = m_rankMap.find(varp);
+	return (it == m_rankMap.end()) ? INT_MAX : it->second;
+    }
+    inline bool operator () (AstVar* lhsp, AstVar* rhsp) const {
+	return rank(lhsp) < rank(rhsp);
+    }
+};
+
+void OrderVisitor::processMoveLocalityPlace(AstNetlist* netlistp) {
+    // Declare each module's variables in the order the moved logic first uses them,
+    // so the members consecutive statements touch sit near each other.
+    // EmitC keeps this order within each of its size groups.
+    // IO keeps its declared order; variables never used by moved logic go last.
+    for (AstNodeModule* modp = netlistp->modulesp(); modp; modp=modp->nextp()->castNodeModule()) {
+	vector<AstVar*> vars;
+	for (AstNode* nodep = modp->stmtsp(); nodep; nodep=nodep->nextp()) {
+	    if (AstVar* varp = nodep->castVar()) {
+		if (!varp->isIO()) vars.push_back(varp);
+	    }
+	}
+	if (vars.size() < 2) continue;
+	vector<AstVar*> sorted = vars;
+	stable_sort(sorted.begin(), sorted.end(), OrderLocalityRankCmp(m_pomVarRank));
+	if (sorted == vars) continue;
+	UINFO(4,"  Locality placing vars in "<<modp<<endl);
+	AstNode* newp = NULL;
+	for (vector<AstVar*>::iterator it = sorted.begin(); it != sorted.end(); ++it) {
+	    (*it)->unlinkFrBack();
+	    newp = newp ? newp->addNext(*it) : *it;
+	    if (m_pomVarRank.find(*it) != m_pomVarRank.end()) ++m_statLocalityVars;
+	}
+	if (modp->stmtsp()) modp->stmtsp()->addHereThisAsNext(newp);
+	else modp->addStmtp(newp);
+    }
 }
 
 void OrderVisitor::processMovePrepScopes() {
@@ -1503,8 +1796,7 @@ void OrderVisitor::processMoveOne(OrderMoveVertex* vertexp, OrderMoveDomScope* d
     else {  // Normal logic
 	// Make or borrow a CFunc to contain the new statements
 	if (v3Global.opt.profileCFuncs()
-	    || (v3Global.opt.outputSplitCFuncs()
-		&& v3Global.opt.outputSplitCFuncs() < m_pomNewStmts)) {
+	    || splitNeeded(m_pomNewStmts, m_pomNewCost)) {
 	    // Put every statement into a unique function to ease profiling or reduce function size
 	    m_pomNewFuncp = NULL;
 	}
@@ -1514,6 +1806,7 @@ void OrderVisitor::processMoveOne(OrderMoveVertex* vertexp, OrderMoveDomScope* d
 	    m_pomNewFuncp->argTypes(EmitCBaseVisitor::symClassVar());
 	    m_pomNewFuncp->symProlog(true);
 	    m_pomNewStmts = 0;
+	    m_pomNewCost = 0;
 	    if (domainp->hasInitial() || domainp->hasSettle()) m_pomNewFuncp->slow(true);
 	    scopep->addActivep(m_pomNewFuncp);
 	    // Where will we be adding the call?
@@ -1533,16 +1826,280 @@ void OrderVisitor::processMoveOne(OrderMoveVertex* vertexp, OrderMoveDomScope* d
 	    pushDeletep(nodep); VL_DANGLING(nodep);
 	} else {
 	    m_pomNewFuncp->addStmtsp(nodep);
-	    if (v3Global.opt.outputSplitCFuncs()) {
+	    if (splitCounting()) {
 		// Add in the number of nodes we're adding
 		EmitCBaseCounterVisitor visitor(nodep);
 		m_pomNewStmts += visitor.count();
+		m_pomNewCost += visitor.cost();
 	    }
 	}
     }
     processMoveDoneOne (vertexp);
 }
 
+//######################################################################
+// Macro-task partitioning (--threads)
+
+void OrderVisitor::processMTasks() {
+    // The move graph is acyclic, so rank each vertex by its longest path from
+    // a source. Vertices of equal rank have no path between them (else the
+    // later would have a greater rank), so sets of same-ranked logic can be
+    // evaluated concurrently, with the ranks themselves evaluated in order.
+    //   For each rank
+    //     For each domain with logic in this rank, in order of appearance
+    //       Cluster logic writing common variables, as they may not run concurrently
+    //       Pack the clusters into at most --threads macro-tasks
+    //       Make an AstExecMTasks that calls each macro-task's function
+    UINFO(5,"  MTasks\n");
+    m_pomGraph.rank();
+    typedef map<uint32_t, MoveVec> RankMap;
+    RankMap ranks;
+    // Vertices are already sorted, so this preserves the serial ordering within a rank
+    for (V3GraphVertex* itp = m_pomGraph.verticesBeginp(); itp; itp=itp->verticesNextp()) {
+	OrderMoveVertex* vertexp = static_cast<OrderMoveVertex*>(itp);
+	ranks[vertexp->rank()].push_back(vertexp);
+    }
+    for (RankMap::iterator it = ranks.begin(); it != ranks.end(); ++it) {
+	vector<AstSenTree*> domains;
+	map<AstSenTree*, MoveVec> domainVertices;
+	for (MoveVec::iterator vit = it->second.begin(); vit != it->second.end(); ++vit) {
+	    AstSenTree* domainp = (*vit)->logicp()->domainp();
+	    if (domainVertices.find(domainp) == domainVertices.end()) domains.push_back(domainp);
+	    domainVertices[domainp].push_back(*vit);
+	}
+	for (vector<AstSenTree*>::iterator dit = domains.begin(); dit != domains.end(); ++dit) {
+	    processMTasksDomain(*dit, domainVertices[*dit]);
+	}
+    }
+    processMoveClear();
+}
+
+void OrderVisitor::processMTasksDomain(AstSenTree* domainp, const MoveVec& vertices) {
+    MoveVec logics;
+    for (MoveVec::const_iterator it = vertices.begin(); it != vertices.end(); ++it) {
+	AstNode* nodep = (*it)->logicp()->nodep();
+	if (nodep->castUntilStable()) {
+	    nodep->v3fatalSrc("Not implemented");
+	}
+	else if (nodep->castSenTree()) {
+	    // Just ignore sensitivities, we'll deal with them when we move statements that need them
+	}
+	else if (domainp == m_deleteDomainp) {
+	    UINFO(4," Ordering deleting pre-settled "<<nodep<<endl);
+	    nodep->unlinkFrBack();
+	    pushDeletep(nodep); VL_DANGLING(nodep);
+	}
+	else {
+	    logics.push_back(*it);
+	}
+    }
+    if (logics.empty()) return;
+
+    // Union-find logic that shares a generated variable, or is on either side
+    // of a cut (circular) edge, so that all such logic lands in one macro-task
+    vector<size_t> parent (logics.size());
+    for (size_t i=0; i<logics.size(); ++i) parent[i] = i;
+    map<AstVarScope*, size_t> varOwner;
+    for (size_t i=0; i<logics.size(); ++i) {
+	OrderLogicVertex* lvertexp = logics[i]->logicp();
+	vector<AstVarScope*> varscps;
+	for (V3GraphEdge* edgep = lvertexp->outBeginp(); edgep; edgep=edgep->outNextp()) {
+	    if (OrderVarVertex* vvertexp = dynamic_cast<OrderVarVertex*>(edgep->top())) {
+		varscps.push_back(vvertexp->varScp());
+	    }
+	}
+	for (V3GraphEdge* edgep = lvertexp->inBeginp(); edgep; edgep=edgep->inNextp()) {
+	    if (edgep->weight()==0) {  // was cut
+		if (OrderVarVertex* vvertexp = dynamic_cast<OrderVarVertex*>(edgep->fromp())) {
+		    varscps.push_back(vvertexp->varScp());
+		}
+	    }
+	}
+	for (vector<AstVarScope*>::iterator vit = varscps.begin(); vit != varscps.end(); ++vit) {
+	    map<AstVarScope*, size_t>::iterator oit = varOwner.find(*vit);
+	    if (oit == varOwner.end()) {
+		varOwner.insert(make_pair(*vit, i));
+	    } else {
+		size_t a = i;  while (parent[a] != a) a = parent[a];
+		size_t b = oit->second;  while (parent[b] != b) b = parent[b];
+		if (a != b) parent[a<b ? b : a] = (a<b ? a : b);  // Lowest index is root, so clusters stay ordered
+	    }
+	}
+    }
+
+    // Collect clusters, with their costs, in order of first member
+    vector<MoveVec> clusters;
+    vector<int> costs;
+    vector<int> clusterOf (logics.size());
+    for (size_t i=0; i<logics.size(); ++i) {
+	size_t root = i;  while (parent[root] != root) root = parent[root];
+	if (root == i) {
+	    clusterOf[i] = clusters.size();
+	    clusters.push_back(MoveVec());
+	    costs.push_back(0);
+	} else {
+	    clusterOf[i] = clusterOf[root];
+	}
+	clusters[clusterOf[i]].push_back(logics[i]);
+	EmitCBaseCounterVisitor visitor(logics[i]->logicp()->nodep());
+	costs[clusterOf[i]] += visitor.count();
+    }
+    if (!m_mtaskProf.empty()) processMTasksProfile(clusters, costs);
+
+    // Longest processing time first onto the least loaded macro-task
+    size_t ntasks = clusters.size();
+    if (ntasks > (size_t)v3Global.opt.threads()) ntasks = v3Global.opt.threads();
+    if (domainp->hasInitial() || domainp->hasSettle()) ntasks = 1;  // Called once; not worth it
+    vector<size_t> byCost;
+    for (size_t c=0; c<clusters.size(); ++c) byCost.push_back(c);
+    // Small clusters so a simple insertion sort; stable so output is deterministic
+    for (size_t i=1; i<byCost.size(); ++i) {
+	for (size_t j=i; j>0 && costs[byCost[j-1]] < costs[byCost[j]]; --j) {
+	    std::swap(byCost[j-1], byCost[j]);
+	}
+    }
+    vector<vector<size_t> > taskClusters (ntasks);
+    vector<int> taskLoad (ntasks, 0);
+    for (vector<size_t>::iterator it = byCost.begin(); it != byCost.end(); ++it) {
+	size_t best = 0;
+	for (size_t t=1; t<ntasks; ++t) if (taskLoad[t] < taskLoad[best]) best = t;
+	taskClusters[best].push_back(*it);
+	taskLoad[best] += costs[*it];
+    }
+
+    FileLine* fl = logics.front()->logicp()->nodep()->fileline();
+    if (ntasks == 1) {
+	// Nothing to run concurrently; same as the serial path
+	AstActive* activep = new AstActive(fl, "mtask", domainp);
+	processMoveLoopStmt(activep);
+	processMTasksMove(domainp, logics, activep);
+	return;
+    }
+    AstExecMTasks* execp = new AstExecMTasks(fl, NULL);
+    AstActive* activep = new AstActive(fl, "mtasks", domainp);
+    activep->addStmtsp(execp);
+    processMoveLoopStmt(activep);
+    ++m_statMTaskGroups;
+    for (size_t t=0; t<ntasks; ++t) {
+	// Keep the graph's ordering inside a task; it's better for the d-cache
+	std::sort(taskClusters[t].begin(), taskClusters[t].end());
+	// The task entry is static and takes an opaque symbol table, so the thread pool can call it
+	AstCFunc* taskFuncp = new AstCFunc(fl, "_mtask__"+cvtToStr(++m_mtaskNum), m_scopetopp);
+	taskFuncp->argTypes("VlThrSymTab __Vsymtab");
+	taskFuncp->dontCombine(true);
+	taskFuncp->addInitsp(new AstCStmt(fl, EmitCBaseVisitor::symClassVar()
+					  +" = static_cast<"+EmitCBaseVisitor::symClassName()
+					  +"*>(__Vsymtab);\n"));
+	taskFuncp->addInitsp(new AstCStmt(fl, EmitCBaseVisitor::symTopAssign()+"\n"));
+	m_scopetopp->addActivep(taskFuncp);
+	execp->addCallsp(new AstCCall(fl, taskFuncp));
+	if (v3Global.opt.profileCounters()) {
+	    // Time each cluster, for a later Verilation with --mtask-profile
+	    for (vector<size_t>::iterator it = taskClusters[t].begin(); it != taskClusters[t].end(); ++it) {
+		taskFuncp->addStmtsp(new AstCStmt(fl, "{ static VerilatedProfCFunc __Vprof (\""
+						  +mtaskClusterName(clusters[*it])+"\");\n"
+						  +"VerilatedProfScope __Vprofscope (__Vprof);\n"));
+		processMTasksMove(domainp, clusters[*it], taskFuncp);
+		taskFuncp->addStmtsp(new AstCStmt(fl, "}\n"));
+	    }
+	} else {
+	    MoveVec taskVertices;
+	    for (vector<size_t>::iterator it = taskClusters[t].begin(); it != taskClusters[t].end(); ++it) {
+		taskVertices.insert(taskVertices.end(), clusters[*it].begin(), clusters[*it].end());
+	    }
+	    processMTasksMove(domainp, taskVertices, taskFuncp);
+	}
+	++m_statMTasks;
+    }
+}
+
+void OrderVisitor::readMTaskProfile(const string& filename) {
+    // Read per-cluster times written by --profile-counters with --threads
+    const VL_UNIQUE_PTR<ifstream> ifp (V3File::new_ifstream_nodepend(filename));
+    if (ifp->fail()) {
+	v3fatal("Cannot open --mtask-profile file: "<<filename);
+	return;
+    }
+    string line;
+    while (getline(*ifp, line)) {
+	if (line.compare(0, 6, "cfunc ") != 0) continue;
+	istringstream is (line.substr(6));
+	double calls = 0; double selfTicks = 0; double ticks = 0;
+	is>>calls>>selfTicks>>ticks;
+	string name; getline(is, name);
+	if (name.length() && name[0]==' ') name.erase(0,1);
+	if (calls > 0 && name.compare(0, 14, "mtask_cluster ") == 0) {
+	    m_mtaskProf[name] += ticks / calls;
+	}
+    }
+    if (m_mtaskProf.empty()) {
+	v3warn(EC_INFO, "No macro-task clusters in --mtask-profile file: "<<filename);
+    }
+}
+
+void OrderVisitor::processMTasksProfile(const vector<MoveVec>& clusters, vector<int>& costs) {
+    // Replace estimated costs with measured time where the cluster was profiled.
+    // Ticks are scaled so the profiled clusters keep their total estimated cost,
+    // so they still balance against clusters that weren't profiled.
+    vector<double> ticks (clusters.size(), -1);
+    double estSum = 0;
+    double tickSum = 0;
+    for (size_t c=0; c<clusters.size(); ++c) {
+	MTaskProfMap::const_iterator it = m_mtaskProf.find(mtaskClusterName(clusters[c]));
+	if (it != m_mtaskProf.end()) {
+	    ticks[c] = it->second;
+	    estSum += costs[c];
+	    tickSum += it->second;
+	}
+    }
+    if (tickSum <= 0) return;
+    for (size_t c=0; c<clusters.size(); ++c) {
+	if (ticks[c] >= 0) {
+	    costs[c] = (int)(ticks[c] * estSum / tickSum) + 1;
+	    ++m_statMTaskProfiled;
+	}
+    }
+}
+
+void OrderVisitor::processMTasksMove(AstSenTree* domainp, const MoveVec& vertices, AstNode* callUnderp) {
+    // Move vertices' logic into functions, with a call to each under callUnderp
+    AstCFunc* newFuncp = NULL;
+    AstScope* lastScopep = NULL;
+    int newStmts = 0;
+    int newCost = 0;
+    for (MoveVec::const_iterator it = vertices.begin(); it != vertices.end(); ++it) {
+	OrderLogicVertex* lvertexp = (*it)->logicp();
+	AstScope* scopep = lvertexp->scopep();
+	AstNode* nodep = lvertexp->nodep();
+	if (!newFuncp || scopep != lastScopep
+	    || v3Global.opt.profileCFuncs()
+	    || splitNeeded(newStmts, newCost)) {
+	    AstNodeModule* modp = scopep->user1p()->castNodeModule();  UASSERT(modp,"NULL"); // Stashed by visitor func
+	    string name = cfuncName(modp, domainp, scopep, nodep);
+	    newFuncp = new AstCFunc(nodep->fileline(), name, scopep);
+	    newFuncp->argTypes(EmitCBaseVisitor::symClassVar());
+	    newFuncp->symProlog(true);
+	    if (domainp->hasInitial() || domainp->hasSettle()) newFuncp->slow(true);
+	    scopep->addActivep(newFuncp);
+	    AstCCall* callp = new AstCCall(nodep->fileline(), newFuncp);
+	    callp->argTypes("vlSymsp");
+	    if (AstActive* activep = callUnderp->castActive()) activep->addStmtsp(callp);
+	    else callUnderp->castCFunc()->addStmtsp(callp);
+	    lastScopep = scopep;
+	    newStmts = 0;
+	    newCost = 0;
+	    UINFO(6,"      New "<<newFuncp<<endl);
+	}
+	nodep->unlinkFrBack();
+	newFuncp->addStmtsp(nodep);
+	if (splitCounting()) {
+	    EmitCBaseCounterVisitor visitor(nodep);
+	    newStmts += visitor.count();
+	    newCost += visitor.cost();
+	}
+    }
+}
+
 inline void OrderVisitor::processMoveLoopPush(OrderLoopBeginVertex* beginp) {
     UINFO(6,"      LoopPush  "<<beginp<<endl);
     m_pomLoopMoveps.push_back(beginp);
@@ -1625,6 +2182,7 @@ void OrderVisitor::process() {
     // Assign logic verticesto new domains
     UINFO(2,"  Domains...\n");
     processDomains();
+    processLazy();
     m_graph.dumpDotFilePrefixed("orderg_domain");
 
     if (debug() && v3Global.opt.dumpTree()) processEdgeReport();
@@ -1636,7 +2194,11 @@ void OrderVisitor::process() {
     m_pomGraph.dumpDotFilePrefixed("ordermv_simpl");
 
     UINFO(2,"  Move...\n");
-    processMove();
+    if (v3Global.opt.mtasks()) {
+	processMTasks();
+    } else {
+	processMove();
+    }
 
     // Any SC inputs feeding a combo domain must be marked, so we can make them sc_sensitive
     UINFO(2,"  Sensitive...\n");
@@ -425,6 +425,7 @@ public:
     }
     OrderMoveDomScope* domScopep() const { return m_domScopep; }
     OrderMoveVertex* pomWaitingNextp() const { return m_pomWaitingE.nextp(); }
+    OrderMoveVertex* readyVerticesNextp() const { return m_readyVerticesE.nextp(); }
     void domScopep(OrderMoveDomScope* ds) { m_domScopep=ds; }
 };
 
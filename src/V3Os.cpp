@@ -31,9 +31,13 @@
 #include <fcntl.h>
 #include <iomanip>
 #include <memory>
+#include <ctime>
+#include <sys/time.h>
 
 #if defined(WIN32) || defined(__MINGW32__)
 # include <direct.h>  // mkdir
+#else
+# include <sys/resource.h>  // getrusage
 #endif
 
 #include "V3Global.h"
@@ -186,3 +190,52 @@ void V3Os::unlinkRegexp(const string& dir, const string& regexp) {
 	closedir(dirp);
     }
 }
+
+//######################################################################
+// Resource usage
+
+double V3Os::timeWall() {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (double)tv.tv_sec + (double)tv.tv_usec * 1.0e-6;
+}
+
+double V3Os::timeCpu() {
+#if defined(_WIN32) || defined(__MINGW32__)
+    return (double)clock() / CLOCKS_PER_SEC;
+#else
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return ((double)ru.ru_utime.tv_sec + (double)ru.ru_utime.tv_usec * 1.0e-6
+	    + (double)ru.ru_stime.tv_sec + (double)ru.ru_stime.tv_usec * 1.0e-6);
+#endif
+}
+
+vluint64_t V3Os::memUsageBytes() {
+    // Current resident set size, or 0 if unknown
+#if defined(__linux__)
+    vluint64_t size = 0, resident = 0;
+    if (FILE* fp = fopen("/proc/self/statm", "r")) {
+	if (fscanf(fp, "%" VL_PRI64 "u %" VL_PRI64 "u", &size, &resident) != 2) resident = 0;
+	fclose(fp);
+    }
+    return resident * (vluint64_t)sysconf(_SC_PAGESIZE);
+#else
+    return memPeakBytes();
+#endif
+}
+
+vluint64_t V3Os::memPeakBytes() {
+    // Peak resident set size, or 0 if unknown
+#if defined(_WIN32) || defined(__MINGW32__)
+    return 0;
+#else
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+# if defined(__APPLE__)
+    return (vluint64_t)ru.ru_maxrss;  // Bytes
+# else
+    return (vluint64_t)ru.ru_maxrss * VL_ULL(1024);  // Kilobytes
+# endif
+#endif
+}
@@ -47,6 +47,12 @@ public:
     // METHODS (directory utilities)
     static void createDir(const string& dirname);
     static void unlinkRegexp(const string& dir, const string& regexp);
+
+    // METHODS (resource usage)
+    static double timeWall();	///< Wall clock time, in seconds
+    static double timeCpu();	///< CPU time used by this process, in seconds
+    static vluint64_t memUsageBytes();	///< Current resident memory, or 0 if unknown
+    static vluint64_t memPeakBytes();	///< Peak resident memory, or 0 if unknown
 };
 
 #endif // Guard
@@ -56,6 +56,7 @@
 #include <map>
 #include <vector>
 #include <deque>
+#include <set>
 
 #include "V3Global.h"
 #include "V3Param.h"
@@ -64,6 +65,39 @@
 #include "V3Const.h"
 #include "V3Width.h"
 #include "V3Unroll.h"
+#include "V3Stats.h"
+
+//######################################################################
+// Find variables referenced in a module, for --param-share-unused
+
+class ParamRefVisitor : public AstNVisitor {
+private:
+    // STATE
+    set<AstNode*>*	m_refsp;	// Variables referenced
+    bool		m_unknown;	// Reference that can't be resolved yet, so any may be used
+
+    // VISITORS
+    virtual void visit(AstNodeVarRef* nodep) {
+	if (nodep->castVarXRef() || !nodep->varp()) m_unknown = true;
+	else m_refsp->insert(nodep->varp());
+	nodep->iterateChildren(*this);
+    }
+    virtual void visit(AstParseRef* nodep) { m_unknown = true; }
+    virtual void visit(AstDot* nodep) { m_unknown = true; }
+    virtual void visit(AstUnlinkedRef* nodep) { m_unknown = true; }
+    virtual void visit(AstNode* nodep) {
+	nodep->iterateChildren(*this);
+    }
+public:
+    // CONSTRUCTORS
+    ParamRefVisitor(AstNodeModule* nodep, set<AstNode*>* refsp) {
+	m_refsp = refsp;
+	m_unknown = false;
+	nodep->accept(*this);
+    }
+    virtual ~ParamRefVisitor() {}
+    bool unknown() const { return m_unknown; }
+};
 
 //######################################################################
 // Param state, as a visitor of each AstNode
@@ -99,8 +133,17 @@ private:
 
     typedef map<AstNode*,int> ValueMap;
     typedef map<int,int> NextValueMap;
+    typedef multimap<int,pair<AstNode*,int> > ValueRepMap;
     ValueMap	m_valueMap;	// Hash of node to param value
     NextValueMap m_nextValueMap;// Hash of param value to next value to be used
+    ValueRepMap	m_valueRepMap;	// Hash of bucket to copy of each value given a number, and its number
+
+    typedef map<AstNodeModule*,set<AstNode*> > ModRefsMap;
+    ModRefsMap	m_modRefsMap;	// Variables referenced by each module, or empty if unknown
+
+    V3Double0	m_statClones;	// Statistic tracking
+    V3Double0	m_statReused;	// Statistic tracking
+    V3Double0	m_statUnused;	// Statistic tracking
 
     typedef multimap<int,AstNodeModule*> LevelModMap;
     LevelModMap	m_todoModps;	// Modules left to process
@@ -153,22 +196,53 @@ private:
 	// Ideally would be relatively stable if design changes (not use pointer value),
 	// and must return same value given same input node
 	// Return must presently be numeric so doesn't collide with 'small' alphanumeric parameter names
+	// Values are canonical, so equal values from different cells share a number,
+	// and so share one module; interfaces are identified by the node itself
+	// 'z' just to make sure we don't collide with a normal non-hashed number
 	ValueMap::iterator it = m_valueMap.find(nodep);
-	if (it != m_valueMap.end()) {
-	    return cvtToStr(it->second);
+	if (it != m_valueMap.end()) return (string)"z"+cvtToStr(it->second);
+	static int BUCKETS = 1000;
+	V3Hash hash (nodep->name());
+	int bucket = hash.hshval() % BUCKETS;
+	bool byValue = !nodep->castIfaceRefDType();
+	if (byValue) {
+	    for (ValueRepMap::iterator rit = m_valueRepMap.lower_bound(bucket);
+		 rit != m_valueRepMap.end() && rit->first == bucket; ++rit) {
+		if (rit->second.first->sameTree(nodep)) {
+		    return (string)"z"+cvtToStr(rit->second.second);
+		}
+	    }
+	}
+	int offset = 0;
+	NextValueMap::iterator nit = m_nextValueMap.find(bucket);
+	if (nit != m_nextValueMap.end()) { offset = nit->second; nit->second = offset + 1; }
+	else { m_nextValueMap.insert(make_pair(bucket, offset + 1)); }
+	int num = bucket + offset * BUCKETS;
+	if (byValue) {
+	    // Keep a copy, as the cell's parameter is deleted once the cell is done
+	    m_valueRepMap.insert(make_pair(bucket, make_pair(nodep->cloneTree(false), num)));
 	} else {
-	    static int BUCKETS = 1000;
-	    V3Hash hash (nodep->name());
-	    int bucket = hash.hshval() % BUCKETS;
-	    int offset = 0;
-	    NextValueMap::iterator it = m_nextValueMap.find(bucket);
-	    if (it != m_nextValueMap.end()) { offset = it->second; it->second = offset + 1; }
-	    else { m_nextValueMap.insert(make_pair(bucket, offset + 1)); }
-	    int num = bucket + offset * BUCKETS;
 	    m_valueMap.insert(make_pair(nodep, num));
-	    // 'z' just to make sure we don't collide with a normal non-hashed number
-	    return (string)"z"+cvtToStr(num);
 	}
+	return (string)"z"+cvtToStr(num);
+    }
+    const set<AstNode*>& modRefs(AstNodeModule* modp) {
+	// Must first be called before the module is processed, as that folds
+	// the parameters into constants, so the references disappear
+	ModRefsMap::iterator it = m_modRefsMap.find(modp);
+	if (it == m_modRefsMap.end()) {
+	    it = m_modRefsMap.insert(make_pair(modp, set<AstNode*>())).first;
+	    ParamRefVisitor refVisitor (modp, &(it->second));
+	    if (refVisitor.unknown()) it->second.clear();
+	}
+	return it->second;
+    }
+    bool paramReferenced(AstNodeModule* modp, AstVar* varp) {
+	// Does anything use this parameter's value, so changing it needs a new module?
+	if (varp->isSigPublic()) return true;
+	const set<AstNode*>& refs = modRefs(modp);
+	if (refs.empty()) return true;  // Unknown
+	return refs.find(varp) != refs.end();
     }
     void collectPins(CloneMap* clonemapp, AstNodeModule* modp) {
 	// Grab all I/O so we can remap our pins later
@@ -219,6 +293,7 @@ private:
 	    m_todoModps.erase(it);
 	    if (!nodep->user5SetOnce()) {  // Process once; note clone() must clear so we do it again
 		UINFO(4," MOD   "<<nodep<<endl);
+		if (v3Global.opt.paramShareUnused()) modRefs(nodep);
 		nodep->iterateChildren(*this);
 		// Note above iterate may add to m_todoModps
 		//
@@ -514,7 +589,14 @@ public:
 	//
 	nodep->accept(*this);
     }
-    virtual ~ParamVisitor() {}
+    virtual ~ParamVisitor() {
+	for (ValueRepMap::iterator it = m_valueRepMap.begin(); it != m_valueRepMap.end(); ++it) {
+	    it->second.first->deleteTree();
+	}
+	V3Stats::addStat("Param, Modules specialized", m_statClones);
+	V3Stats::addStat("Param, Cells reusing specialization", m_statReused);
+	V3Stats::addStat("Param, Unused overrides shared", m_statUnused);
+    }
 };
 
 //----------------------------------------------------------------------
@@ -562,6 +644,11 @@ void ParamVisitor::visitCell(AstCell* nodep) {
 			// Setting parameter to its default value.  Just ignore it.
 			// This prevents making additional modules, and makes coverage more
 			// obvious as it won't show up under a unique module page name.
+		    } else if (v3Global.opt.paramShareUnused()
+			       && !paramReferenced(nodep->modp(), modvarp)) {
+			// Nothing reads the value, so every value makes the same module
+			UINFO(8,"Parameter unused, sharing module: "<<modvarp<<endl);
+			++m_statUnused;
 		    } else if (exprp->num().isDouble()
 			       || exprp->num().isString()
 			       ||  exprp->num().isFourState()) {
@@ -676,6 +763,7 @@ void ParamVisitor::visitCell(AstCell* nodep) {
 		// Note all module internal variables will be re-linked to the new modules by clone
 		// However links outside the module (like on the upper cells) will not.
 		modp = nodep->modp()->cloneTree(false);
+		++m_statClones;
 		modp->name(newname);
 		modp->user5(false); // We need to re-recurse this module once changed
 		nodep->modp()->addNextHere(modp);  // Keep tree sorted by cell occurrences
@@ -729,6 +817,7 @@ void ParamVisitor::visitCell(AstCell* nodep) {
 
 	    } else {
 		UINFO(4,"     De-parameterize to old: "<<modp<<endl);
+		++m_statReused;
 	    }
 
 	    // Have child use this module instead.
@@ -29,6 +29,7 @@
 #include <stack>
 
 #include "V3Error.h"
+#include "V3File.h"
 #include "V3FileLine.h"
 
 //======================================================================
@@ -128,17 +129,21 @@ public:
     FileLine*		m_curFilelinep;	// Current processing point (see also m_tokFilelinep)
     V3PreLex*		m_lexp;		// Lexer, for resource tracking
     deque<string>	m_buffers;	// Buffer of characters to process
+    V3InFilterView*	m_viewp;	// File contents to process after m_buffers, or NULL
+    size_t		m_viewPos;	// Characters of m_viewp processed
     int			m_ignNewlines;	// Ignore multiline newlines
     bool		m_eof;		// "EOF" buffer
     bool		m_file;		// Buffer is start of new file
     int			m_termState;	// Termination fsm
     VPreStream(FileLine* fl, V3PreLex* lexp)
 	: m_curFilelinep(fl), m_lexp(lexp),
+	  m_viewp(NULL), m_viewPos(0),
 	  m_ignNewlines(0),
 	  m_eof(false), m_file(false), m_termState(0) {
 	lexStreamDepthAdd(1);
     }
     ~VPreStream() {
+	if (m_viewp) { delete m_viewp; m_viewp=NULL; }
 	lexStreamDepthAdd(-1);
     }
 private:
@@ -206,6 +211,7 @@ class V3PreLex {
     void scanNewFile(FileLine* filelinep);
     void scanBytes(const string& str);
     void scanBytesBack(const string& str);
+    void scanView(V3InFilterView* viewp);
     size_t inputToLex(char* buf, size_t max_size);
     /// Called by V3PreProc.cpp to get data from lexer
     YY_BUFFER_STATE currentBuffer();
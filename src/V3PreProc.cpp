@@ -55,13 +55,20 @@ class V3Define {
     string	m_value;	// Value of define
     string	m_params;	// Parameters
     bool	m_cmdline;	// Set on command line, don't `undefineall
+    bool	m_split;	// m_texts/m_names computed
+    vector<string> m_texts;	// Value split before each identifier, then trailing text
+    vector<string> m_names;	// Identifiers in value, perhaps formal arguments
 public:
     V3Define(FileLine* fl, const string& value, const string& params, bool cmdline)
-	: m_fileline(fl), m_value(value), m_params(params), m_cmdline(cmdline) {}
+	: m_fileline(fl), m_value(value), m_params(params), m_cmdline(cmdline), m_split(false) {}
     FileLine* fileline() const { return m_fileline; }
     string value() const { return m_value; }
     string params() const { return m_params; }
     bool cmdline() const { return m_cmdline; }
+    bool split() const { return m_split; }
+    void split(bool flag) { m_split = flag; }
+    vector<string>& texts() { return m_texts; }
+    vector<string>& names() { return m_names; }
 };
 
 //*************************************************************************
@@ -182,6 +189,7 @@ private:
     // Internal methods
     void endOfOneFile();
     string defineSubst(V3DefineRef* refp);
+    void defineSplit(V3Define& def);
 
     bool defExists(const string& name);
     string defValue(const string& name);
@@ -235,6 +243,8 @@ public:
     virtual void define (FileLine* fl, const string& name, const string& value,
 			 const string& params, bool cmdline);
     virtual string removeDefines(const string& text);	// Remove defines in a text string
+    virtual void definesSave(ostream& os) const;
+    virtual bool definesLoad(istream& is);
 
     // CONSTRUCTORS
     V3PreProcImp() : V3PreProc() {
@@ -321,16 +331,54 @@ FileLine* V3PreProcImp::defFileline(const string& name) {
 void V3PreProcImp::define(FileLine* fl, const string& name, const string& value,
 			  const string& params, bool cmdline) {
     UINFO(4,"DEFINE '"<<name<<"' as '"<<value<<"' params '"<<params<<"'"<<endl);
-    if (defExists(name)) {
-	if (!(defValue(name)==value && defParams(name)==params)) {  // Duplicate defs are OK
+    DefinesMap::iterator iter = m_defines.find(name);
+    if (iter != m_defines.end()) {
+	const V3Define& olddef = iter->second;
+	if (!(olddef.value()==value && olddef.params()==params)) {  // Duplicate defs are OK
 	    fl->v3warn(REDEFMACRO,"Redefining existing define: "<<name<<", with different value: "<<value<<" "<<params);
-	    defFileline(name)->v3warn(REDEFMACRO,"Previous definition is here, with value: "<<defValue(name)<<" "<<defParams(name));
+	    olddef.fileline()->v3warn(REDEFMACRO,"Previous definition is here, with value: "<<olddef.value()<<" "<<olddef.params());
 	}
-	undef(name);
+	m_defines.erase(iter);
     }
     m_defines.insert(make_pair(name, V3Define(fl, value, params, cmdline)));
 }
 
+void V3PreProcImp::definesSave(ostream& os) const {
+    os<<m_defines.size()<<"\n";
+    for (DefinesMap::const_iterator it = m_defines.begin(); it != m_defines.end(); ++it) {
+	saveString(os, it->first);
+	saveString(os, it->second.value());
+	saveString(os, it->second.params());
+	saveString(os, it->second.fileline()->filename());
+	os<<" "<<it->second.fileline()->lineno()<<" "<<(it->second.cmdline()?1:0)<<"\n";
+    }
+}
+bool V3PreProcImp::definesLoad(istream& is) {
+    size_t count = 0;
+    if (!(is>>count)) return false;
+    DefinesMap defines;
+    for (size_t i=0; i<count; ++i) {
+	string name, value, params, filename;
+	int lineno = 0;
+	int cmdline = 0;
+	if (!(loadString(is, name) && loadString(is, value) && loadString(is, params)
+	      && loadString(is, filename) && (is>>lineno>>cmdline))) return false;
+	defines.insert(make_pair(name, V3Define(new FileLine(filename, lineno),
+						value, params, cmdline)));
+    }
+    m_defines.swap(defines);
+    return true;
+}
+bool V3PreProc::loadString(istream& is, string& str) {
+    // Read a string written by saveString
+    size_t len = 0;
+    char colon = 0;
+    if (!(is>>len) || !is.get(colon) || colon!=':') return false;
+    str.resize(len);
+    if (len && !is.read(&str[0], len)) return false;
+    return true;
+}
+
 string V3PreProcImp::removeDefines(const string& sym) {
     string val = "0_never_match";
     string rtnsym = sym;
@@ -533,22 +581,114 @@ string V3PreProcImp::trimWhitespace(const string& strg, bool trailing) {
     return out;
 }
 
+void V3PreProcImp::defineSplit(V3Define& def) {
+    // Split define value at each identifier, which defineSubst replaces
+    // if it names an argument.  Other escapes are handled here once.
+    string out = "";
+    {
+	string value = def.value();  // Must keep in scope
+	string argName;
+	bool quote = false;
+	bool backslashesc = false;  // In \.....{space} block
+	// Note we go through the loop once more at the NULL end-of-string
+	for (const char* cp=value.c_str(); (*cp) || argName!=""; cp=(*cp?cp+1:cp)) {
+	    //UINFO(4, "CH "<<*cp<<"  an "<<argName<<endl);
+	    if (!quote && *cp == '\\') { backslashesc = true; }
+	    else if (isspace(*cp)) { backslashesc = false; }
+	    // We don't check for quotes; some simulators expand even inside quotes
+	    if ( isalpha(*cp) || *cp=='_'
+		 || *cp=='$' // Won't replace system functions, since no $ in argValueByName
+		 || (argName!="" && (isdigit(*cp) || *cp=='$'))) {
+		argName += *cp;
+		continue;
+	    }
+	    if (argName != "") {
+		// Found a possible variable substitution
+		def.texts().push_back(out);
+		def.names().push_back(argName);
+		out = "";
+		argName = "";
+	    }
+	    if (!quote) {
+		// Check for `` only after we've detected end-of-argname
+		if (cp[0]=='`' && cp[1]=='`') {
+		    if (backslashesc) {
+			// Don't put out the ``, we're forming an escape which will not expand further later
+		    } else {
+			out += "``";   // `` must get removed later, as `FOO```BAR must pre-expand FOO and BAR
+		    }
+		    cp++;
+		    continue;
+		}
+		else if (cp[0]=='`' && cp[1]=='"') {
+		    out += "`\"";  // `" means to put out a " without enabling quote mode (sort of)
+		    // however we must expand any macro calls inside it first.
+		    // So keep it `", so we don't enter quote mode.
+		    cp++;
+		    continue;
+		}
+		else if (cp[0]=='`' && cp[1]=='\\' && cp[2]=='`' && cp[3]=='"') {
+		    out += "`\\`\"";   // `\`" means to put out a backslash quote
+		    // Leave it literal until we parse the VP_STRIFY string
+		    cp+=3;
+		    continue;
+		}
+		else if (cp[0]=='`' && cp[1]=='\\') {
+		    out += '\\';   // `\ means to put out a backslash
+		    cp++;
+		    continue;
+		}
+		else if (cp[0]=='\\' && cp[1]=='\n') {
+		    // We kept the \\n when we lexed because we don't want whitespace
+		    // trimming to mis-drop the final \\n
+		    // At replacement time we need the standard newline.
+		    out += "\n";	 // \\n newline
+		    cp++;
+		    continue;
+		}
+	    }
+	    if (cp[0]=='\\' && cp[1]=='\"') {
+		out += cp[0]; // \{any} Put out literal next character
+		out += cp[1];
+		cp++;
+		continue;
+	    }
+	    else if (cp[0]=='\\') {
+		// Normally \{any} would put out literal next character
+		// Instead we allow "`define A(nm) \nm" to expand, per proposed mantis1537
+		out += cp[0];
+		continue;
+	    }
+	    if (*cp=='"') quote=!quote;
+	    if (*cp) out += *cp;
+	}
+    }
+    def.texts().push_back(out);
+    def.split(true);
+}
+
 string V3PreProcImp::defineSubst(V3DefineRef* refp) {
     // Substitute out defines in a define reference.
     // (We also need to call here on non-param defines to handle `")
     // We could push the define text back into the lexer, but that's slow
     // and would make recursive definitions and parameter handling nasty.
     //
-    // Note we parse the definition parameters and value here.  If a
-    // parametrized define is used many, many times, we could cache the
-    // parsed result.
+    // Note we parse the definition parameters here, but the value is
+    // only parsed on the first use, as register maps and the like use the
+    // same define many, many times.
     UINFO(4,"defineSubstIn  `"<<refp->name()<<" "<<refp->params()<<endl);
     for (unsigned i=0; i<refp->args().size(); i++) {
 	UINFO(4,"defineArg["<<i<<"] = '"<<refp->args()[i]<<"'"<<endl);
     }
     // Grab value
-    string value = defValue(refp->name());
-    UINFO(4,"defineValue    '"<<V3PreLex::cleanDbgStrg(value)<<"'"<<endl);
+    DefinesMap::iterator defIter = m_defines.find(refp->name());
+    if (defIter == m_defines.end()) {
+	fileline()->v3error("Define or directive not defined: `"+refp->name());
+	return "";
+    }
+    V3Define& def = defIter->second;
+    UINFO(4,"defineValue    '"<<V3PreLex::cleanDbgStrg(def.value())<<"'"<<endl);
+    if (!def.split()) defineSplit(def);
 
     map<string,string> argValueByName;
     {   // Parse argument list into map
@@ -619,87 +759,20 @@ string V3PreProcImp::defineSubst(V3DefineRef* refp) {
     }
 
     string out = "";
-    {   // Parse substitution define using arguments
-	string argName;
-	bool quote = false;
-	bool backslashesc = false;  // In \.....{space} block
-	// Note we go through the loop once more at the NULL end-of-string
-	for (const char* cp=value.c_str(); (*cp) || argName!=""; cp=(*cp?cp+1:cp)) {
-	    //UINFO(4, "CH "<<*cp<<"  an "<<argName<<endl);
-	    if (!quote && *cp == '\\') { backslashesc = true; }
-	    else if (isspace(*cp)) { backslashesc = false; }
-	    // We don't check for quotes; some simulators expand even inside quotes
-	    if ( isalpha(*cp) || *cp=='_'
-		 || *cp=='$' // Won't replace system functions, since no $ in argValueByName
-		 || (argName!="" && (isdigit(*cp) || *cp=='$'))) {
-		argName += *cp;
-		continue;
-	    }
-	    if (argName != "") {
-		// Found a possible variable substitution
-		map<string,string>::iterator iter = argValueByName.find(argName);
-		if (iter != argValueByName.end()) {
-		    // Substitute
-		    string subst = iter->second;
-		    out += subst;
-		} else {
-		    out += argName;
-		}
-		argName = "";
-	    }
-	    if (!quote) {
-		// Check for `` only after we've detected end-of-argname
-		if (cp[0]=='`' && cp[1]=='`') {
-		    if (backslashesc) {
-			// Don't put out the ``, we're forming an escape which will not expand further later
-		    } else {
-			out += "``";   // `` must get removed later, as `FOO```BAR must pre-expand FOO and BAR
-		    }
-		    cp++;
-		    continue;
-		}
-		else if (cp[0]=='`' && cp[1]=='"') {
-		    out += "`\"";  // `" means to put out a " without enabling quote mode (sort of)
-		    // however we must expand any macro calls inside it first.
-		    // So keep it `", so we don't enter quote mode.
-		    cp++;
-		    continue;
-		}
-		else if (cp[0]=='`' && cp[1]=='\\' && cp[2]=='`' && cp[3]=='"') {
-		    out += "`\\`\"";   // `\`" means to put out a backslash quote
-		    // Leave it literal until we parse the VP_STRIFY string
-		    cp+=3;
-		    continue;
-		}
-		else if (cp[0]=='`' && cp[1]=='\\') {
-		    out += '\\';   // `\ means to put out a backslash
-		    cp++;
-		    continue;
-		}
-		else if (cp[0]=='\\' && cp[1]=='\n') {
-		    // We kept the \\n when we lexed because we don't want whitespace
-		    // trimming to mis-drop the final \\n
-		    // At replacement time we need the standard newline.
-		    out += "\n";	 // \\n newline
-		    cp++;
-		    continue;
-		}
-	    }
-	    if (cp[0]=='\\' && cp[1]=='\"') {
-		out += cp[0]; // \{any} Put out literal next character
-		out += cp[1];
-		cp++;
-		continue;
-	    }
-	    else if (cp[0]=='\\') {
-		// Normally \{any} would put out literal next character
-		// Instead we allow "`define A(nm) \nm" to expand, per proposed mantis1537
-		out += cp[0];
-		continue;
+    {   // Substitute arguments into the value as split by defineSplit
+	vector<string>& texts = def.texts();
+	vector<string>& names = def.names();
+	for (size_t i=0; i<names.size(); ++i) {
+	    out += texts[i];
+	    map<string,string>::iterator iter = argValueByName.find(names[i]);
+	    if (iter != argValueByName.end()) {
+		// Substitute
+		out += iter->second;
+	    } else {
+		out += names[i];
 	    }
-	    if (*cp=='"') quote=!quote;
-	    if (*cp) out += *cp;
 	}
+	out += texts.back();
     }
 
     UINFO(4,"defineSubstOut '"<<V3PreLex::cleanDbgStrg(out)<<"'"<<endl);
@@ -713,10 +786,9 @@ void V3PreProcImp::openFile(FileLine* fl, V3InFilter* filterp, const string& fil
     // Open a new file, possibly overriding the current one which is active.
     V3File::addSrcDepend(filename);
 
-    // Read a list<string> with the whole file.
-    StrList wholefile;
-    bool ok = filterp->readWholefile(filename, wholefile/*ref*/);
-    if (!ok) {
+    // Read the whole file, memory mapped if large.
+    V3InFilterView* viewp = filterp->readView(filename);
+    if (!viewp) {
 	error("File not found: "+filename+"\n");
 	return;
     }
@@ -726,6 +798,7 @@ void V3PreProcImp::openFile(FileLine* fl, V3InFilter* filterp, const string& fil
 	// up, with guards preventing a real recursion.
 	if (m_lexp->m_streampStack.size()>V3PreProc::INCLUDE_DEPTH_MAX) {
 	    error("Recursive inclusion of file: "+filename);
+	    delete viewp;
 	    return;
 	}
 	// There's already a file active.  Push it to work on the new one.
@@ -738,31 +811,28 @@ void V3PreProcImp::openFile(FileLine* fl, V3InFilter* filterp, const string& fil
 
     // Filter all DOS CR's en-mass.  This avoids bugs with lexing CRs in the wrong places.
     // This will also strip them from strings, but strings aren't supposed to be multi-line without a "\"
-    for (StrList::iterator it=wholefile.begin(); it!=wholefile.end(); ++it) {
-	// We don't end-loop at \0 as we allow and strip mid-string '\0's (for now).
-	bool strip = false;
-	const char* sp = it->data();
-	const char* ep = sp + it->length();
-	// Only process if needed, as saves extra string allocations
-	for (const char* cp=sp; cp<ep; cp++) {
-	    if (VL_UNLIKELY(*cp == '\r' || *cp == '\0')) {
-		strip = true; break;
-	    }
+    // We don't end-loop at \0 as we allow and strip mid-string '\0's (for now).
+    bool strip = false;
+    const char* sp = viewp->data();
+    const char* ep = sp + viewp->size();
+    // Only copy if needed, else the lexer reads the view directly
+    for (const char* cp=sp; cp<ep; cp++) {
+	if (VL_UNLIKELY(*cp == '\r' || *cp == '\0')) {
+	    strip = true; break;
 	}
-	if (strip) {
-	    string out;  out.reserve(it->length());
-	    for (const char* cp=sp; cp<ep; cp++) {
-		if (!(*cp == '\r' || *cp == '\0')) {
-		    out += *cp;
-		}
+    }
+    if (strip) {
+	string out;  out.reserve(viewp->size());
+	for (const char* cp=sp; cp<ep; cp++) {
+	    if (!(*cp == '\r' || *cp == '\0')) {
+		out += *cp;
 	    }
-	    *it = out;
 	}
-
+	delete viewp; VL_DANGLING(viewp);
 	// Push the data to an internal buffer.
-	m_lexp->scanBytesBack(*it);
-	// Reclaim memory; the push saved the string contents for us
-	*it = "";
+	m_lexp->scanBytesBack(out);
+    } else {
+	m_lexp->scanView(viewp); VL_DANGLING(viewp);
     }
 }
 
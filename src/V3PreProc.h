@@ -89,6 +89,12 @@ public:
     }
     virtual string removeDefines(const string& text)=0;	// Remove defines in a text string
 
+    // Save or replace all defines, for V3PreShell's --preproc-cache
+    virtual void definesSave(ostream& os) const = 0;
+    virtual bool definesLoad(istream& is) = 0;	// Returns false if corrupt, leaving defines unchanged
+    static void saveString(ostream& os, const string& str) { os<<str.length()<<":"<<str; }
+    static bool loadString(istream& is, string& str);
+
     // UTILITIES
     void error(const string& msg) { fileline()->v3error(msg); }	///< Report a error
     void fatal(const string& msg) { fileline()->v3fatalSrc(msg); }	///< Report a fatal error
@@ -27,6 +27,9 @@
 #include <algorithm>
 #include <list>
 #include <set>
+#include <fstream>
+#include <sstream>
+#include <memory>
 
 #include "V3Global.h"
 #include "V3PreShell.h"
@@ -34,6 +37,7 @@
 #include "V3File.h"
 #include "V3Parse.h"
 #include "V3Os.h"
+#include "V3Stats.h"
 
 //######################################################################
 
@@ -45,6 +49,15 @@ protected:
     static V3PreProc*	s_preprocp;
     static V3InFilter*	s_filterp;
 
+    // For --preproc-cache, each file opened while preprocessing one top file
+    struct CacheFile {
+	string	m_modname;	// Name given to `include, defines removed
+	string	m_lastpath;	// Directory of includer
+	string	m_filename;	// Resolved filename
+    };
+    bool		m_cacheRecording;	// Recording into m_cacheFiles
+    deque<CacheFile>	m_cacheFiles;		// Files opened
+
     //---------------------------------------
     // METHODS
 
@@ -103,16 +116,109 @@ protected:
 
 	// Preprocess
 	s_filterp = filterp;
+	string cacheFilename = cacheName(fl, modname);
+	if (cacheFilename != "" && cacheLoad(fl, cacheFilename, parsep)) return true;
+	int errs = V3Error::errorOrWarnCount();
+	m_cacheFiles.clear();
+	m_cacheRecording = (cacheFilename != "");
 	bool ok = preprocOpen(fl, s_filterp, modname, "", errmsg);
-	if (!ok) return false;
+	if (!ok) { m_cacheRecording = false; return false; }
 
+	string text;
 	while (!s_preprocp->isEof()) {
 	    string line = s_preprocp->getline();
 	    V3Parse::ppPushText(parsep, line);
+	    if (m_cacheRecording) text += line;
+	}
+	m_cacheRecording = false;
+	// Messages wouldn't be repeated on a cache hit, so only clean results are cached
+	if (cacheFilename != "" && errs == V3Error::errorOrWarnCount()) {
+	    cacheSave(cacheFilename, text);
 	}
 	return true;
     }
 
+    // Preprocessor cache, for --preproc-cache.  Every top file's output
+    // is keyed by its name and the defines on entry, and is valid while
+    // each file it read still resolves to the same name and contents.
+    // The defines on exit are saved too, as they carry to the next file.
+    string cacheName(FileLine* fl, const string& modname) {
+	// Return cache filename for this top file, or "" to not cache
+	if (v3Global.opt.preprocCache() == "" || v3Global.opt.pipeFilter() != "") return "";
+	string filename = v3Global.opt.filePath(fl, s_preprocp->removeDefines(modname), "", "");
+	if (filename == "") return "";
+	ostringstream key;
+	key<<"VERILATOR_PPCACHE "<<V3Options::version()<<"\n";
+	V3PreProc::saveString(key, filename);
+	key<<" "<<(V3PreProc::lineDirectives()?1:0)<<"\n";
+	s_preprocp->definesSave(key);
+	return v3Global.opt.preprocCache()+"/"+V3File::stringHash(key.str())+".vppc";
+    }
+    bool cacheLoad(FileLine* fl, const string& cacheFilename, V3ParseImp* parsep) {
+	const VL_UNIQUE_PTR<ifstream> ifp (V3File::new_ifstream_nodepend(cacheFilename));
+	if (ifp->fail()) return false;
+	string header;
+	getline(*ifp, header);
+	if (header != "VERILATOR_PPCACHE "+V3Options::version()) return false;
+	size_t nfiles = 0;
+	if (!(*ifp>>nfiles)) return false;
+	deque<string> filenames;
+	for (size_t i=0; i<nfiles; ++i) {
+	    string modname, lastpath, filename, hash;
+	    if (!(V3PreProc::loadString(*ifp, modname) && V3PreProc::loadString(*ifp, lastpath)
+		  && V3PreProc::loadString(*ifp, filename) && V3PreProc::loadString(*ifp, hash))) {
+		return false;
+	    }
+	    if (v3Global.opt.filePath(fl, modname, lastpath, "") != filename
+		|| V3File::contentsHash(filename) != hash) {
+		UINFO(2,"    Preprocessor cache stale due to "<<filename<<endl);
+		V3Stats::addStatSum("Preprocessor cache, stale", 1);
+		return false;
+	    }
+	    filenames.push_back(filename);
+	}
+	string defines, text;
+	if (!(V3PreProc::loadString(*ifp, defines) && V3PreProc::loadString(*ifp, text))) return false;
+	istringstream definesis (defines);
+	if (!s_preprocp->definesLoad(definesis)) return false;
+
+	UINFO(2,"    Preprocessor cache hit "<<cacheFilename<<endl);
+	V3Stats::addStatSum("Preprocessor cache, hits", 1);
+	for (deque<string>::iterator it = filenames.begin(); it != filenames.end(); ++it) {
+	    V3File::addSrcDepend(*it);
+	}
+	V3Parse::ppPushText(parsep, text);
+	return true;
+    }
+    void cacheSave(const string& cacheFilename, const string& text) {
+	V3Stats::addStatSum("Preprocessor cache, misses", 1);
+	V3Os::createDir(v3Global.opt.preprocCache());
+	// Write then rename, so a concurrent or interrupted run never sees part of a file
+	string tmpFilename = cacheFilename+".tmp"+cvtToStr(getpid());
+	{
+	    const VL_UNIQUE_PTR<ofstream> ofp (new ofstream(tmpFilename.c_str(), ios::binary));
+	    if (ofp->fail()) return;  // Cache is optional
+	    *ofp<<"VERILATOR_PPCACHE "<<V3Options::version()<<"\n";
+	    *ofp<<m_cacheFiles.size()<<"\n";
+	    for (deque<CacheFile>::iterator it = m_cacheFiles.begin(); it != m_cacheFiles.end(); ++it) {
+		V3PreProc::saveString(*ofp, it->m_modname);
+		V3PreProc::saveString(*ofp, it->m_lastpath);
+		V3PreProc::saveString(*ofp, it->m_filename);
+		V3PreProc::saveString(*ofp, V3File::contentsHash(it->m_filename));
+		*ofp<<"\n";
+	    }
+	    ostringstream defines;
+	    s_preprocp->definesSave(defines);
+	    V3PreProc::saveString(*ofp, defines.str());
+	    *ofp<<"\n";
+	    V3PreProc::saveString(*ofp, text);
+	    *ofp<<"\n";
+	    if (ofp->fail()) { unlink(tmpFilename.c_str()); return; }
+	}
+	if (rename(tmpFilename.c_str(), cacheFilename.c_str()) != 0) unlink(tmpFilename.c_str());
+	UINFO(2,"    Preprocessor cache wrote "<<cacheFilename<<endl);
+    }
+
     void preprocInclude (FileLine* fl, const string& modname) {
 	if (modname[0]=='/' || modname[0]=='\\') {
 	    fl->v3warn(INCABSPATH,"Suggest `include with absolute path be made relative, and use +include: "<<modname);
@@ -132,12 +238,19 @@ protected:
 	if (filename=="") return false;  // Not found
 
 	UINFO(2,"    Reading "<<filename<<endl);
+	if (m_cacheRecording) {
+	    CacheFile cf;
+	    cf.m_modname = ppmodname;
+	    cf.m_lastpath = lastpath;
+	    cf.m_filename = filename;
+	    m_cacheFiles.push_back(cf);
+	}
 	s_preprocp->openFile(fl, filterp, filename);
 	return true;
     }
 
     // CONSTRUCTORS
-    V3PreShellImp() {}
+    V3PreShellImp() { m_cacheRecording = false; }
     ~V3PreShellImp() {}
 };
 
@@ -26,6 +26,14 @@
 // Each display (independant transformation; here as Premit is a good point)
 //	If autoflush, insert a flush
 //
+// Reuse of temporaries, after V3Subst and V3Cse have removed those they can:
+//	For each CFUNC, number its statements, giving each wide STMTTEMP a
+//	lifetime from its first reference, which must set it, to its last.
+//	A reference inside a loop that doesn't also contain that first set
+//	keeps the temporary alive to the end of the loop.
+//	Temporaries of the same number of words with lifetimes that don't
+//	share a statement are replaced with one temporary.
+//
 //*************************************************************************
 
 #include "config_build.h"
@@ -35,9 +43,12 @@
 #include <unistd.h>
 #include <algorithm>
 #include <list>
+#include <map>
+#include <vector>
 
 #include "V3Global.h"
 #include "V3Premit.h"
+#include "V3Stats.h"
 #include "V3Ast.h"
 
 
@@ -340,6 +351,20 @@ private:
 	checkNode(nodep); }
     virtual void visit(AstConst* nodep) {
 	nodep->iterateChildren(*this); checkNode(nodep); }
+    void visitDiv(AstNodeBiop* nodep) {
+	// Wide division by a constant that fits in a word keeps the constant,
+	// so V3EmitC can pass it as a literal to VL_DIV_WWI/VL_MODDIV_WWI
+	AstConst* constp = nodep->rhsp()->castConst();
+	nodep->lhsp()->iterateAndNext(*this);
+	if (!(nodep->isWide() && constp
+	      && !constp->num().isFourState()
+	      && constp->num().mostSetBitP1() <= VL_WORDSIZE)) {
+	    nodep->rhsp()->iterateAndNext(*this);
+	}
+	checkNode(nodep);
+    }
+    virtual void visit(AstDiv* nodep) { visitDiv(nodep); }
+    virtual void visit(AstModDiv* nodep) { visitDiv(nodep); }
     virtual void visit(AstNodeCond* nodep) {
 	nodep->iterateChildren(*this);
 	if (nodep->expr1p()->isWide()
@@ -403,6 +428,149 @@ public:
     virtual ~PremitVisitor() {}
 };
 
+//######################################################################
+// Reuse temporaries with non-overlapping lifetimes
+
+class PremitReuseVisitor : public AstNVisitor {
+private:
+    // NODE STATE
+    //  AstVar::user1()		-> int.  1 + index into m_temps, if a candidate
+    AstUser1InUse	m_inuser1;
+
+    // TYPES
+    struct Temp {
+	AstVar*		m_varp;		// Temporary
+	int		m_first;	// Statement of first reference
+	int		m_last;		// Statement of last reference
+	AstWhile*	m_loopp;	// Outermost loop it must live through, or NULL
+	bool		m_ok;		// First reference sets it
+	vector<AstVarRef*> m_refps;	// All references
+    };
+    struct LoopInfo {
+	AstWhile*	m_loopp;	// Loop
+	int		m_start;	// Statement number of the loop itself
+    };
+
+    // STATE
+    vector<Temp>	m_temps;	// Candidates in this function
+    vector<LoopInfo>	m_loops;	// Loops we are under, outermost first
+    map<AstWhile*,int>	m_loopEnds;	// Last statement number in each loop
+    int			m_stmtNum;	// Number of current statement
+    V3Double0		m_statReused;	// Statistic tracking
+
+    // METHODS
+    static int debug() {
+	static int level = -1;
+	if (VL_UNLIKELY(level < 0)) level = v3Global.opt.debugSrcLevel(__FILE__);
+	return level;
+    }
+
+    static bool lessFirst(const Temp* ap, const Temp* bp) { return ap->m_first < bp->m_first; }
+
+    void reuseTemps() {
+	// Greedy interval allocation, separately for each number of words
+	vector<Temp*> ordered;
+	for (size_t i=0; i<m_temps.size(); ++i) {
+	    Temp& temp = m_temps[i];
+	    if (!temp.m_ok || temp.m_refps.empty()) continue;
+	    if (temp.m_loopp) temp.m_last = max(temp.m_last, m_loopEnds[temp.m_loopp]);
+	    ordered.push_back(&temp);
+	}
+	stable_sort(ordered.begin(), ordered.end(), lessFirst);
+	map<int, vector<Temp*> > slots;  // Words -> temporaries kept, holding the last user's lifetime
+	for (vector<Temp*>::iterator it = ordered.begin(); it != ordered.end(); ++it) {
+	    Temp* tempp = *it;
+	    vector<Temp*>& wslots = slots[tempp->m_varp->widthWords()];
+	    Temp* slotp = NULL;
+	    for (vector<Temp*>::iterator sit = wslots.begin(); sit != wslots.end(); ++sit) {
+		if ((*sit)->m_last < tempp->m_first) { slotp = *sit; break; }
+	    }
+	    if (!slotp) {
+		wslots.push_back(tempp);
+		continue;
+	    }
+	    UINFO(8,"  Reuse "<<slotp->m_varp->name()<<" for "<<tempp->m_varp<<endl);
+	    for (vector<AstVarRef*>::iterator rit = tempp->m_refps.begin();
+		 rit != tempp->m_refps.end(); ++rit) {
+		(*rit)->varp(slotp->m_varp);
+		(*rit)->name(slotp->m_varp->name());
+	    }
+	    slotp->m_last = tempp->m_last;
+	    tempp->m_varp->unlinkFrBack()->deleteTree(); VL_DANGLING(tempp->m_varp);
+	    ++m_statReused;
+	}
+    }
+
+    // VISITORS
+    virtual void visit(AstCFunc* nodep) {
+	m_temps.clear();
+	m_loopEnds.clear();
+	m_stmtNum = 0;
+	for (AstNode* stmtp = nodep->initsp(); stmtp; stmtp = stmtp->nextp()) {
+	    AstVar* varp = stmtp->castVar();
+	    if (varp && varp->varType() == AstVarType::STMTTEMP
+		&& varp->isWide() && !varp->noSubst()) {
+		Temp temp;
+		temp.m_varp = varp;
+		temp.m_first = temp.m_last = 0;
+		temp.m_loopp = NULL;
+		temp.m_ok = false;
+		m_temps.push_back(temp);
+		varp->user1(m_temps.size());
+	    }
+	}
+	if (m_temps.size() < 2) return;
+	nodep->iterateChildren(*this);
+	reuseTemps();
+	for (AstNode* stmtp = nodep->initsp(); stmtp; stmtp = stmtp->nextp()) {
+	    stmtp->user1(0);
+	}
+    }
+    virtual void visit(AstWhile* nodep) {
+	LoopInfo loop;
+	loop.m_loopp = nodep;
+	loop.m_start = ++m_stmtNum;
+	m_loops.push_back(loop);
+	nodep->iterateChildren(*this);
+	m_loops.pop_back();
+	m_loopEnds[nodep] = m_stmtNum;
+    }
+    virtual void visit(AstNodeStmt* nodep) {
+	++m_stmtNum;
+	nodep->iterateChildren(*this);
+    }
+    virtual void visit(AstVarRef* nodep) {
+	if (!nodep->varp()->user1()) return;
+	Temp& temp = m_temps[nodep->varp()->user1() - 1];
+	if (temp.m_refps.empty()) {
+	    temp.m_first = m_stmtNum;
+	    temp.m_ok = nodep->lvalue();
+	}
+	temp.m_last = m_stmtNum;
+	temp.m_refps.push_back(nodep);
+	if (!temp.m_loopp) {
+	    // Loops entered after the first reference repeat, so keep it to their end
+	    for (vector<LoopInfo>::iterator it = m_loops.begin(); it != m_loops.end(); ++it) {
+		if (it->m_start > temp.m_first) { temp.m_loopp = it->m_loopp; break; }
+	    }
+	}
+    }
+    virtual void visit(AstVar*) {}
+    virtual void visit(AstNode* nodep) {
+	nodep->iterateChildren(*this);
+    }
+
+public:
+    // CONSTUCTORS
+    explicit PremitReuseVisitor(AstNetlist* nodep) {
+	m_stmtNum = 0;
+	nodep->accept(*this);
+    }
+    virtual ~PremitReuseVisitor() {
+	V3Stats::addStat("Optimizations, Premit temporaries reused", m_statReused);
+    }
+};
+
 //----------------------------------------------------------------------
 // Top loop
 
@@ -414,3 +582,9 @@ void V3Premit::premitAll(AstNetlist* nodep) {
     PremitVisitor visitor (nodep);
     V3Global::dumpCheckGlobalTree("premit.tree", 0, v3Global.opt.dumpTreeLevel(__FILE__) >= 3);
 }
+
+void V3Premit::reuseTempsAll(AstNetlist* nodep) {
+    UINFO(2,__FUNCTION__<<": "<<endl);
+    PremitReuseVisitor visitor (nodep);
+    V3Global::dumpCheckGlobalTree("premit_reuse.tree", 0, v3Global.opt.dumpTreeLevel(__FILE__) >= 3);
+}
@@ -0,0 +1,361 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//*************************************************************************
+// DESCRIPTION: Verilator: Skip sequential blocks whose inputs are unchanged
+//
+// Code available from: http://www.veripool.org/verilator
+//
+//*************************************************************************
+//
+// Copyright 2003-2017 by Wilson Snyder.  This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+//
+// Verilator is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+//*************************************************************************
+// V3SeqGate's Transformations:
+//
+//	For each ALWAYS under a clocked ACTIVE, find the variables it reads
+//	    and writes.  It may be gated if it has no side effects, reads no
+//	    memories, and no other logic writes its outputs.  Then given the
+//	    same inputs as when it last ran, it would write the values its
+//	    outputs already hold.
+//	Partition gateable ALWAYS under the same ACTIVE by their input set
+//	    Move the statements of each partition into its first ALWAYS
+//	For each partition, make a shadow of each input and a valid flag
+//	    (cleared by an INITIAL), and make the ALWAYS:
+//		if (!valid || in != shadow || ...) {
+//		    valid = 1; shadow = in; ...
+//		    statements...
+//		}
+//
+//*************************************************************************
+
+#include "config_build.h"
+#include "verilatedos.h"
+#include <cstdio>
+#include <cstdarg>
+#include <unistd.h>
+#include <algorithm>
+#include <vector>
+#include <map>
+#include <set>
+
+#include "V3Global.h"
+#include "V3SeqGate.h"
+#include "V3Stats.h"
+#include "V3Ast.h"
+
+// CONFIG
+static const int SEQGATE_INPUTS_MAX = 16;	// Most input variables to check per block
+static const int SEQGATE_COST_PER_WORD = 4;	// Least nodes in a block per input word checked
+
+//######################################################################
+// Per-block access information
+
+class SeqGateInfo {
+public:
+    // MEMBERS
+    AstAlways*		m_alwaysp;	// Block being checked
+    AstActive*		m_activep;	// Active it is under
+    AstScope*		m_scopep;	// Scope it is under
+    const char*		m_badp;		// Reason can't be gated, or NULL
+    vector<AstVarScope*> m_inputs;	// Variables read, in first read order
+    vector<AstVarScope*> m_outputs;	// Variables written
+    set<AstVarScope*>	m_inputSet;	// Variables read
+    set<AstVarScope*>	m_outputSet;	// Variables written
+    set<AstVarScope*>	m_blockingSet;	// Variables written by blocking assignment
+    int			m_cost;		// Nodes in the block
+    // CONSTRUCTORS
+    SeqGateInfo(AstAlways* alwaysp, AstActive* activep, AstScope* scopep)
+	: m_alwaysp(alwaysp), m_activep(activep), m_scopep(scopep), m_badp(NULL), m_cost(0) {}
+    ~SeqGateInfo() {}
+    void bad(const char* reasonp) { if (!m_badp) m_badp = reasonp; }
+    bool blockingToInput() const {
+	for (set<AstVarScope*>::const_iterator it = m_blockingSet.begin(); it != m_blockingSet.end(); ++it) {
+	    if (m_inputSet.find(*it) != m_inputSet.end()) return true;
+	}
+	return false;
+    }
+    vector<AstVarScope*> inputKey() const {
+	return vector<AstVarScope*>(m_inputSet.begin(), m_inputSet.end());
+    }
+};
+
+//######################################################################
+// Gate state, as a visitor of each AstNode
+
+class SeqGateVisitor : public AstNVisitor {
+private:
+    // NODE STATE
+    //  AstVarScope::user1p()	// AstNode*, logic statement writing it
+    //  AstVarScope::user2()	// bool, written by more than one statement
+    AstUser1InUse	m_inuser1;
+    AstUser2InUse	m_inuser2;
+
+    // TYPES
+    typedef vector<SeqGateInfo*> Partition;
+    typedef map<pair<AstActive*, vector<AstVarScope*> >, int> PartitionMap;
+    typedef map<pair<AstNodeModule*,string>, AstVar*> VarMap;
+
+    // STATE
+    vector<SeqGateInfo*> m_infos;	// All block information, for cleanup
+    VarMap		m_modVarMap;	// Shadow AstVars already created, per module
+    map<AstScope*,AstActive*> m_initActives;	// Initial active created per scope
+    map<AstScope*,int>	m_scopePartNum;	// Partitions made per scope, for naming
+    SeqGateInfo*	m_infop;	// Current block being checked, or NULL
+    AstNode*		m_stmtp;	// Current logic statement, or NULL
+    AstScope*		m_scopep;	// Current scope
+    bool		m_inInitial;	// Under an initial active
+    bool		m_inSens;	// Under a sensitivity item
+    bool		m_inDly;	// Under a delayed assignment
+    V3Double0		m_statParts;	// Statistic tracking
+    V3Double0		m_statGated;	// Statistic tracking
+    V3Double0		m_statUngated;	// Statistic tracking
+
+    // METHODS
+    static int debug() {
+	static int level = -1;
+	if (VL_UNLIKELY(level < 0)) level = v3Global.opt.debugSrcLevel(__FILE__);
+	return level;
+    }
+
+    static bool sideEffect(AstNode* nodep) {
+	// Node does more than compute from its inputs
+	return (!nodep->isPure() || nodep->isOutputter()
+		|| nodep->castRand() || nodep->castTime() || nodep->castTimeD()
+		|| nodep->castNodeFTaskRef() || nodep->castCMath() || nodep->castCStmt()
+		|| nodep->castTestPlusArgs() || nodep->castValuePlusArgs());
+    }
+
+    const char* cantGate(SeqGateInfo* infop) {
+	// Reason block can't be gated, given all references are known
+	if (infop->m_badp) return infop->m_badp;
+	for (vector<AstVarScope*>::iterator it = infop->m_outputs.begin(); it != infop->m_outputs.end(); ++it) {
+	    if ((*it)->user2()) return "output has other writers";
+	}
+	if ((int)infop->m_inputs.size() > SEQGATE_INPUTS_MAX) return "too many inputs";
+	int words = 1;
+	for (vector<AstVarScope*>::iterator it = infop->m_inputs.begin(); it != infop->m_inputs.end(); ++it) {
+	    words += (*it)->varp()->widthWords();
+	}
+	if (infop->m_cost < words * SEQGATE_COST_PER_WORD) return "too small";
+	return NULL;
+    }
+
+    AstVarScope* createVar(AstScope* scopep, FileLine* fl, const string& name, AstVarScope* examplep) {
+	// As scoped, need both an AstVar per module, and an AstVarScope per scope.
+	// Scopes of one module usually make the same partitions, so share by name.
+	AstNodeModule* addmodp = scopep->modp();
+	int width = examplep ? examplep->varp()->width() : 1;
+	string varname = name;
+	AstVar* varp = NULL;
+	for (int n=0; ; ++n) {
+	    if (n) varname = name+"__"+cvtToStr(n);
+	    VarMap::iterator it = m_modVarMap.find(make_pair(addmodp, varname));
+	    if (it == m_modVarMap.end()) break;
+	    if (it->second->width() == width) { varp = it->second; break; }
+	}
+	if (!varp) {
+	    if (examplep) {
+		varp = new AstVar(fl, AstVarType::MODULETEMP, varname, examplep->varp());
+	    } else {
+		varp = new AstVar(fl, AstVarType::MODULETEMP, varname, VFlagBitPacked(), 1);
+	    }
+	    addmodp->addStmtp(varp);
+	    m_modVarMap.insert(make_pair(make_pair(addmodp, varname), varp));
+	}
+	AstVarScope* vscp = new AstVarScope(fl, scopep, varp);
+	scopep->addVarp(vscp);
+	return vscp;
+    }
+
+    void addInitial(AstScope* scopep, AstNode* stmtp) {
+	AstActive*& activep = m_initActives[scopep];
+	if (!activep) {
+	    FileLine* fl = stmtp->fileline();
+	    activep = new AstActive(fl, "initial",
+				    new AstSenTree(fl, new AstSenItem(fl, AstSenItem::Initial())));
+	    activep->sensesStorep(activep->sensesp());
+	    scopep->addActivep(activep);
+	}
+	activep->addStmtsp(new AstInitial(stmtp->fileline(), stmtp));
+    }
+
+    void gatePartition(const Partition& part) {
+	SeqGateInfo* firstp = part[0];
+	AstAlways* alwaysp = firstp->m_alwaysp;
+	AstScope* scopep = firstp->m_scopep;
+	FileLine* fl = alwaysp->fileline();
+	UINFO(4,"  Gate partition of "<<part.size()<<": "<<alwaysp<<endl);
+	// Gather the statements
+	AstNode* bodysp = NULL;
+	for (Partition::const_iterator it = part.begin(); it != part.end(); ++it) {
+	    AstAlways* fromp = (*it)->m_alwaysp;
+	    if (fromp->bodysp()) {
+		AstNode* stmtsp = fromp->bodysp()->unlinkFrBackWithNext();
+		bodysp = bodysp ? bodysp->addNext(stmtsp) : stmtsp;
+	    }
+	    if (fromp != alwaysp) {
+		fromp->unlinkFrBack(); pushDeletep(fromp); VL_DANGLING(fromp);
+	    }
+	}
+	// Build the check
+	string prefix = "__Vseqgate"+cvtToStr(m_scopePartNum[scopep]++);
+	AstVarScope* validp = createVar(scopep, fl, prefix+"__Vvalid", NULL);
+	addInitial(scopep, new AstAssign(fl, new AstVarRef(fl, validp, true),
+					 new AstConst(fl, AstConst::LogicFalse())));
+	AstNode* condp = new AstLogNot(fl, new AstVarRef(fl, validp, false));
+	AstNode* stmtsp = new AstAssign(fl, new AstVarRef(fl, validp, true),
+					new AstConst(fl, AstConst::LogicTrue()));
+	int inputNum = 0;
+	for (vector<AstVarScope*>::iterator it = firstp->m_inputs.begin(); it != firstp->m_inputs.end(); ++it) {
+	    AstVarScope* invscp = *it;
+	    // Number too, as inputs from different scopes may share a name
+	    AstVarScope* shadowp = createVar(scopep, fl, (prefix+"__"+cvtToStr(inputNum++)
+							  +"__"+invscp->varp()->shortName()), invscp);
+	    condp = new AstLogOr(fl, condp, new AstNeq(fl, new AstVarRef(fl, invscp, false),
+						       new AstVarRef(fl, shadowp, false)));
+	    stmtsp->addNext(new AstAssign(fl, new AstVarRef(fl, shadowp, true),
+					  new AstVarRef(fl, invscp, false)));
+	}
+	if (bodysp) stmtsp->addNext(bodysp);
+	alwaysp->addStmtp(new AstIf(fl, condp, stmtsp, NULL));
+	++m_statParts;
+    }
+
+    void gateAll() {
+	// Partition the gateable blocks, and gate each partition
+	vector<Partition> parts;
+	PartitionMap partMap;
+	for (vector<SeqGateInfo*>::iterator it = m_infos.begin(); it != m_infos.end(); ++it) {
+	    SeqGateInfo* infop = *it;
+	    if (const char* reasonp = cantGate(infop)) {
+		UINFO(4,"  Can't gate, "<<reasonp<<": "<<infop->m_alwaysp<<endl);
+		++m_statUngated;
+		continue;
+	    }
+	    ++m_statGated;
+	    // Blocks assigning an input blocking would change what other blocks read
+	    if (!infop->blockingToInput()) {
+		PartitionMap::key_type key = make_pair(infop->m_activep, infop->inputKey());
+		PartitionMap::iterator pit = partMap.find(key);
+		if (pit != partMap.end()) {
+		    parts[pit->second].push_back(infop);
+		    continue;
+		}
+		partMap.insert(make_pair(key, (int)parts.size()));
+	    }
+	    parts.push_back(Partition(1, infop));
+	}
+	for (vector<Partition>::iterator it = parts.begin(); it != parts.end(); ++it) {
+	    gatePartition(*it);
+	}
+    }
+
+    // VISITORS
+    virtual void visit(AstNetlist* nodep) {
+	nodep->iterateChildren(*this);
+	gateAll();
+    }
+    virtual void visit(AstScope* nodep) {
+	m_scopep = nodep;
+	nodep->iterateChildren(*this);
+	m_scopep = NULL;
+    }
+    virtual void visit(AstActive* nodep) {
+	AstSenTree* sensesp = nodep->sensesp();
+	bool clocked = (sensesp->hasClocked() && !sensesp->hasCombo()
+			&& !sensesp->hasInitial() && !sensesp->hasSettle());
+	m_inInitial = sensesp->hasInitial();
+	if (nodep->sensesStorep()) nodep->sensesStorep()->accept(*this);
+	for (AstNode* stmtp = nodep->stmtsp(); stmtp; stmtp=stmtp->nextp()) {
+	    m_stmtp = stmtp;
+	    if (clocked && stmtp->castAlways()) {
+		m_infop = new SeqGateInfo(stmtp->castAlways(), nodep, m_scopep);
+		m_infos.push_back(m_infop);
+	    }
+	    stmtp->accept(*this);
+	    m_infop = NULL;
+	}
+	m_stmtp = NULL;
+	m_inInitial = false;
+    }
+    virtual void visit(AstNodeSenItem* nodep) {
+	m_inSens = true;
+	nodep->iterateChildren(*this);
+	m_inSens = false;
+    }
+    virtual void visit(AstAssignDly* nodep) {
+	if (m_infop) m_infop->m_cost++;
+	m_inDly = true;
+	nodep->iterateChildren(*this);
+	m_inDly = false;
+    }
+    virtual void visit(AstVarRef* nodep) {
+	if (m_inSens) return;
+	AstVarScope* vscp = nodep->varScopep();
+	if (!vscp) nodep->v3fatalSrc("Not linked");
+	AstVar* varp = vscp->varp();
+	if (nodep->lvalue() && !m_inInitial) {
+	    // Initial blocks run before any clock, so the first gated run still happens
+	    if (!m_stmtp || (vscp->user1p() && vscp->user1p() != m_stmtp)) vscp->user2(true);
+	    vscp->user1p(m_stmtp);
+	}
+	if (m_infop) {
+	    m_infop->m_cost++;
+	    if (nodep->lvalue()) {
+		if (varp->isSigUserRWPublic()) m_infop->bad("public output");
+		if (m_infop->m_outputSet.insert(vscp).second) m_infop->m_outputs.push_back(vscp);
+		if (!m_inDly) m_infop->m_blockingSet.insert(vscp);
+	    } else {
+		if (varp->dtypeSkipRefp()->castUnpackArrayDType()) m_infop->bad("memory read");
+		else if (varp->isDouble() || varp->isString()) m_infop->bad("not integral");
+		else if (!varp->basicp()) m_infop->bad("not basic");
+		if (m_infop->m_inputSet.insert(vscp).second) m_infop->m_inputs.push_back(vscp);
+	    }
+	}
+    }
+
+    //--------------------
+    virtual void visit(AstNode* nodep) {
+	if (m_infop) {
+	    m_infop->m_cost++;
+	    if (sideEffect(nodep)) m_infop->bad("side effect");
+	}
+	nodep->iterateChildren(*this);
+    }
+
+public:
+    // CONSTUCTORS
+    explicit SeqGateVisitor(AstNetlist* nodep) {
+	m_infop = NULL;
+	m_stmtp = NULL;
+	m_scopep = NULL;
+	m_inInitial = false;
+	m_inSens = false;
+	m_inDly = false;
+	nodep->accept(*this);
+    }
+    virtual ~SeqGateVisitor() {
+	for (vector<SeqGateInfo*>::iterator it = m_infos.begin(); it != m_infos.end(); ++it) {
+	    delete *it;
+	}
+	V3Stats::addStat("Optimizations, Seq gate partitions", m_statParts);
+	V3Stats::addStat("Optimizations, Seq gate blocks gated", m_statGated);
+	V3Stats::addStat("Optimizations, Seq gate blocks not gated", m_statUngated);
+    }
+};
+
+//######################################################################
+// SeqGate class functions
+
+void V3SeqGate::seqGateAll(AstNetlist* nodep) {
+    UINFO(2,__FUNCTION__<<": "<<endl);
+    SeqGateVisitor visitor (nodep);
+    V3Global::dumpCheckGlobalTree("seqgate.tree", 0, v3Global.opt.dumpTreeLevel(__FILE__) >= 3);
+}
@@ -0,0 +1,352 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//*************************************************************************
+// DESCRIPTION: Verilator: Compiled evaluation of simulatable code
+//
+// Code available from: http://www.veripool.org/verilator
+//
+//*************************************************************************
+//
+// Copyright 2003-2017 by Wilson Snyder.  This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+//
+// Verilator is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+//*************************************************************************
+// SIMULATE CODE:
+//	Lower the always block once into a flat instruction list:
+//	    Each expression node gets a register, constants are preloaded
+//	    Each variable read gets a register, set by input()
+//	    Each assigned variable gets an output slot, set by OP_STORE
+//	    If/case become conditional jumps
+//	Then each run() is a single loop over the instructions, rather than
+//	a visitor walk allocating V3Numbers for every node.
+//
+//	Semantics follow SimulateVisitor in table mode: reads always see the
+//	input value, as earlier checks reject reading a variable also written.
+//
+//*************************************************************************
+
+#include "config_build.h"
+#include "verilatedos.h"
+#include <cstdio>
+#include <cstdarg>
+
+#include "V3Global.h"
+#include "V3SimulateCode.h"
+
+//######################################################################
+
+int SimulateCode::debug() {
+    static int level = -1;
+    if (VL_UNLIKELY(level < 0)) level = v3Global.opt.debugSrcLevel(__FILE__);
+    return level;
+}
+
+SimulateCode::SimulateCode(AstNode* nodep) {
+    m_ok = true;
+    m_whyNotNodep = NULL;
+    if (AstAlways* alwaysp = nodep->castAlways()) {
+	if (!alwaysp->isPredictOptimizable()) fail(alwaysp);
+	compileStmts(alwaysp->bodysp());
+    } else {
+	fail(nodep);
+    }
+    m_outs.resize(m_outSlots.size(), 0);
+    m_outSet.resize(m_outSlots.size(), 0);
+    if (m_ok) {
+	UINFO(8,"  Compiled "<<m_insns.size()<<" insns, "<<m_regs.size()<<" regs: "<<nodep<<endl);
+    } else {
+	UINFO(8,"  Not compiled, at "<<m_whyNotNodep<<endl);
+    }
+}
+
+void SimulateCode::fail(AstNode* nodep) {
+    if (m_ok) {
+	m_ok = false;
+	m_whyNotNodep = nodep;
+    }
+}
+
+bool SimulateCode::widthOk(AstNode* nodep) {
+    if (!nodep->dtypep() || nodep->isDouble() || nodep->isString()
+	|| nodep->width() < 1 || nodep->width() > VL_QUADSIZE) {
+	fail(nodep);
+	return false;
+    }
+    return true;
+}
+
+uint32_t SimulateCode::emit(Op op, AstNode* nodep, uint32_t lhs, uint32_t rhs, uint32_t ths, uint32_t imm) {
+    uint32_t dst = newReg();
+    m_insns.push_back(Insn(op, dst, lhs, rhs, ths, imm, VL_MASK_Q(nodep->width())));
+    return dst;
+}
+
+//######################################################################
+// Statements
+
+void SimulateCode::compileStmts(AstNode* nodep) {
+    for (; nodep && m_ok; nodep = nodep->nextp()) compileStmt(nodep);
+}
+
+void SimulateCode::compileStmt(AstNode* nodep) {
+    if (nodep->castComment()) return;
+    if (!nodep->isPredictOptimizable()) { fail(nodep); return; }
+    if (AstNodeAssign* assp = nodep->castNodeAssign()) {
+	AstVarRef* varrefp = assp->lhsp()->castVarRef();
+	if ((!assp->castAssign() && !assp->castAssignDly())
+	    || !varrefp || !varrefp->varScopep() || !widthOk(varrefp)) {
+	    fail(nodep); return;
+	}
+	uint32_t value = compileExpr(assp->rhsp());
+	if (!m_ok) return;
+	uint32_t slot;
+	VarSlotMap::iterator it = m_outSlots.find(varrefp->varScopep());
+	if (it != m_outSlots.end()) {
+	    slot = it->second;
+	} else {
+	    slot = m_outSlots.size();
+	    m_outSlots.insert(make_pair(varrefp->varScopep(), slot));
+	}
+	m_insns.push_back(Insn(OP_STORE, slot, value, 0, 0, 0, VL_MASK_Q(varrefp->width())));
+    }
+    else if (AstNodeIf* ifp = nodep->castNodeIf()) {
+	uint32_t cond = compileExpr(ifp->condp());
+	if (!m_ok) return;
+	size_t jumpElse = m_insns.size();
+	m_insns.push_back(Insn(OP_JUMPZ, 0, cond, 0, 0, 0, 0));
+	compileStmts(ifp->ifsp());
+	size_t jumpEnd = m_insns.size();
+	m_insns.push_back(Insn(OP_JUMP, 0, 0, 0, 0, 0, 0));
+	m_insns[jumpElse].m_imm = m_insns.size();
+	compileStmts(ifp->elsesp());
+	m_insns[jumpEnd].m_imm = m_insns.size();
+    }
+    else if (AstNodeCase* casep = nodep->castNodeCase()) {
+	// Compare each item in order, jumping to the first match's body;
+	// if none match fall through to the default, as SimulateVisitor does
+	uint32_t expr = compileExpr(casep->exprp());
+	vector<size_t> jumpBodies;  // Per item, jumps needing its body's address
+	vector<AstCaseItem*> items;
+	for (AstCaseItem* itemp = casep->itemsp(); itemp && m_ok; itemp=itemp->nextp()->castCaseItem()) {
+	    if (itemp->isDefault()) continue;
+	    items.push_back(itemp);
+	    for (AstNode* ep = itemp->condsp(); ep && m_ok; ep=ep->nextp()) {
+		uint32_t cond = compileExpr(ep);
+		if (!m_ok) return;
+		uint32_t match = emit(OP_EQ, ep, expr, cond);
+		m_insns.back().m_mask = 1;
+		jumpBodies.push_back(m_insns.size());
+		m_insns.push_back(Insn(OP_JUMPNZ, 0, match, 0, items.size()-1, 0, 0));
+	    }
+	}
+	if (!m_ok) return;
+	vector<size_t> jumpEnds;
+	for (AstCaseItem* itemp = casep->itemsp(); itemp; itemp=itemp->nextp()->castCaseItem()) {
+	    if (itemp->isDefault()) { compileStmts(itemp->bodysp()); break; }
+	}
+	jumpEnds.push_back(m_insns.size());
+	m_insns.push_back(Insn(OP_JUMP, 0, 0, 0, 0, 0, 0));
+	vector<size_t> bodyStarts;
+	for (vector<AstCaseItem*>::iterator it = items.begin(); it != items.end(); ++it) {
+	    bodyStarts.push_back(m_insns.size());
+	    compileStmts((*it)->bodysp());
+	    jumpEnds.push_back(m_insns.size());
+	    m_insns.push_back(Insn(OP_JUMP, 0, 0, 0, 0, 0, 0));
+	}
+	for (vector<size_t>::iterator it = jumpBodies.begin(); it != jumpBodies.end(); ++it) {
+	    m_insns[*it].m_imm = bodyStarts[m_insns[*it].m_ths];
+	}
+	for (vector<size_t>::iterator it = jumpEnds.begin(); it != jumpEnds.end(); ++it) {
+	    m_insns[*it].m_imm = m_insns.size();
+	}
+    }
+    else if (AstBegin* beginp = nodep->castBegin()) {
+	compileStmts(beginp->stmtsp());
+    }
+    else {
+	fail(nodep);
+    }
+}
+
+//######################################################################
+// Expressions
+
+uint32_t SimulateCode::compileBiop(Op op, AstNodeBiop* nodep, bool swap) {
+    uint32_t lhs = compileExpr(nodep->lhsp());
+    uint32_t rhs = compileExpr(nodep->rhsp());
+    if (!m_ok) return 0;
+    if (swap) return emit(op, nodep, rhs, lhs);
+    else return emit(op, nodep, lhs, rhs);
+}
+
+uint32_t SimulateCode::compileExpr(AstNode* nodep) {
+    if (!m_ok) return 0;
+    if (!nodep->isPredictOptimizable() || !widthOk(nodep)) { fail(nodep); return 0; }
+    if (AstConst* constp = nodep->castConst()) {
+	if (constp->num().isFourState() || constp->num().isDouble() || constp->num().isString()) {
+	    fail(nodep); return 0;
+	}
+	return newReg(constp->num().toUQuad() & VL_MASK_Q(nodep->width()));
+    }
+    else if (AstVarRef* varrefp = nodep->castVarRef()) {
+	AstVarScope* vscp = varrefp->varScopep();
+	if (!vscp || varrefp->lvalue() || varrefp->varp()->isParam()) { fail(nodep); return 0; }
+	VarSlotMap::iterator it = m_inSlots.find(vscp);
+	if (it != m_inSlots.end()) return it->second;
+	uint32_t reg = newReg();
+	m_inSlots.insert(make_pair(vscp, reg));
+	return reg;
+    }
+    // Unary
+    else if (AstNot* np = nodep->castNot()) {
+	return emit(OP_NOT, np, compileExpr(np->lhsp()));
+    }
+    else if (AstNegate* np = nodep->castNegate()) {
+	return emit(OP_NEGATE, np, compileExpr(np->lhsp()));
+    }
+    else if (AstRedAnd* np = nodep->castRedAnd()) {
+	return emit(OP_REDAND, np, compileExpr(np->lhsp()), 0, 0, np->lhsp()->width());
+    }
+    else if (AstRedOr* np = nodep->castRedOr()) {
+	return emit(OP_REDOR, np, compileExpr(np->lhsp()));
+    }
+    else if (AstRedXor* np = nodep->castRedXor()) {
+	return emit(OP_REDXOR, np, compileExpr(np->lhsp()));
+    }
+    else if (AstLogNot* np = nodep->castLogNot()) {
+	return emit(OP_LOGNOT, np, compileExpr(np->lhsp()));
+    }
+    else if (AstExtend* np = nodep->castExtend()) {
+	return emit(OP_COPY, np, compileExpr(np->lhsp()));
+    }
+    else if (AstExtendS* np = nodep->castExtendS()) {
+	return emit(OP_EXTENDS, np, compileExpr(np->lhsp()), 0, 0, np->lhsp()->widthMinV());
+    }
+    // Binary
+    else if (nodep->castAnd()) return compileBiop(OP_AND, nodep->castNodeBiop());
+    else if (nodep->castOr()) return compileBiop(OP_OR, nodep->castNodeBiop());
+    else if (nodep->castXor()) return compileBiop(OP_XOR, nodep->castNodeBiop());
+    else if (nodep->castAdd()) return compileBiop(OP_ADD, nodep->castNodeBiop());
+    else if (nodep->castSub()) return compileBiop(OP_SUB, nodep->castNodeBiop());
+    else if (nodep->castMul()) return compileBiop(OP_MUL, nodep->castNodeBiop());
+    else if (nodep->castEq() || nodep->castEqCase()) return compileBiop(OP_EQ, nodep->castNodeBiop());
+    else if (nodep->castNeq() || nodep->castNeqCase()) return compileBiop(OP_NEQ, nodep->castNodeBiop());
+    else if (nodep->castLt()) return compileBiop(OP_LT, nodep->castNodeBiop());
+    else if (nodep->castLte()) return compileBiop(OP_LTE, nodep->castNodeBiop());
+    else if (nodep->castGt()) return compileBiop(OP_LT, nodep->castNodeBiop(), true);
+    else if (nodep->castGte()) return compileBiop(OP_LTE, nodep->castNodeBiop(), true);
+    else if (nodep->castLtS() || nodep->castLteS() || nodep->castGtS() || nodep->castGteS()) {
+	// V3Number's signed compares are only exact for equal operand widths
+	AstNodeBiop* np = nodep->castNodeBiop();
+	if (np->lhsp()->width() != np->rhsp()->width()) { fail(nodep); return 0; }
+	bool lte = nodep->castLteS() || nodep->castGteS();
+	bool swap = nodep->castGtS() || nodep->castGteS();
+	uint32_t dst = compileBiop(lte ? OP_LTES : OP_LTS, np, swap);
+	if (m_ok) m_insns.back().m_imm = np->lhsp()->width();
+	return dst;
+    }
+    else if (nodep->castShiftL()) return compileBiop(OP_SHIFTL, nodep->castNodeBiop());
+    else if (nodep->castShiftR()) return compileBiop(OP_SHIFTR, nodep->castNodeBiop());
+    else if (nodep->castLogAnd()) return compileBiop(OP_LOGAND, nodep->castNodeBiop());
+    else if (nodep->castLogOr()) return compileBiop(OP_LOGOR, nodep->castNodeBiop());
+    else if (AstConcat* np = nodep->castConcat()) {
+	uint32_t dst = compileBiop(OP_CONCAT, np);
+	if (m_ok) m_insns.back().m_imm = np->rhsp()->width();
+	return dst;
+    }
+    // Ternary
+    else if (AstSel* np = nodep->castSel()) {
+	uint32_t from = compileExpr(np->fromp());
+	uint32_t lsb = compileExpr(np->lsbp());
+	if (!m_ok) return 0;
+	// ths is the width of the source, not a register
+	return emit(OP_SEL, np, from, lsb, np->fromp()->width(), np->widthConst());
+    }
+    else if (AstNodeCond* np = nodep->castNodeCond()) {
+	uint32_t cond = compileExpr(np->condp());
+	uint32_t lhs = compileExpr(np->expr1p());
+	uint32_t rhs = compileExpr(np->expr2p());
+	if (!m_ok) return 0;
+	return emit(OP_COND, np, lhs, rhs, cond);
+    }
+    fail(nodep);
+    return 0;
+}
+
+//######################################################################
+// Evaluation
+
+static inline vlsint64_t simulateCodeSigned(vluint64_t value, uint32_t width) {
+    if (width < VL_QUADSIZE && ((value >> (width-1)) & 1ULL)) value |= ~VL_MASK_Q(width);
+    return (vlsint64_t)value;
+}
+
+bool SimulateCode::run() {
+    for (vector<uint8_t>::iterator it = m_outSet.begin(); it != m_outSet.end(); ++it) *it = 0;
+    if (m_insns.empty()) return true;
+    vluint64_t* regs = &m_regs[0];
+    size_t pc = 0;
+    size_t end = m_insns.size();
+    while (pc < end) {
+	const Insn& in = m_insns[pc++];
+	const vluint64_t l = regs[in.m_lhs];
+	const vluint64_t r = regs[in.m_rhs];
+	vluint64_t out;
+	switch (in.m_op) {
+	case OP_AND:	out = l & r; break;
+	case OP_OR:	out = l | r; break;
+	case OP_XOR:	out = l ^ r; break;
+	case OP_NOT:	out = ~l; break;
+	case OP_NEGATE:	out = 0ULL - l; break;
+	case OP_ADD:	out = l + r; break;
+	case OP_SUB:	out = l - r; break;
+	case OP_MUL:	out = l * r; break;
+	case OP_EQ:	out = (l == r); break;
+	case OP_NEQ:	out = (l != r); break;
+	case OP_LT:	out = (l < r); break;
+	case OP_LTE:	out = (l <= r); break;
+	case OP_LTS:	out = (simulateCodeSigned(l, in.m_imm) < simulateCodeSigned(r, in.m_imm)); break;
+	case OP_LTES:	out = (simulateCodeSigned(l, in.m_imm) <= simulateCodeSigned(r, in.m_imm)); break;
+	case OP_SHIFTL:	out = (r >= VL_QUADSIZE) ? 0 : (l << r); break;
+	case OP_SHIFTR:	out = (r >= VL_QUADSIZE) ? 0 : (l >> r); break;
+	case OP_REDAND:	out = (l == VL_MASK_Q(in.m_imm)); break;
+	case OP_REDOR:	out = (l != 0); break;
+	case OP_REDXOR: {
+	    vluint64_t v = l;
+	    v ^= v >> 32; v ^= v >> 16; v ^= v >> 8; v ^= v >> 4; v ^= v >> 2; v ^= v >> 1;
+	    out = v & 1ULL;
+	    break;
+	}
+	case OP_LOGNOT:	out = (l == 0); break;
+	case OP_LOGAND:	out = l ? r : l; break;
+	case OP_LOGOR:	out = l ? l : r; break;
+	case OP_SEL:
+	    // Bits beyond the source are X
+	    if (r > in.m_ths || r + in.m_imm > in.m_ths) return false;
+	    out = l >> r;
+	    break;
+	case OP_CONCAT:	out = (l << in.m_imm) | r; break;
+	case OP_EXTENDS: out = simulateCodeSigned(l & VL_MASK_Q(in.m_imm), in.m_imm); break;
+	case OP_COND:	out = regs[in.m_ths] ? l : r; break;
+	case OP_COPY:	out = l; break;
+	case OP_STORE:
+	    m_outs[in.m_dst] = l & in.m_mask;
+	    m_outSet[in.m_dst] = 1;
+	    continue;
+	case OP_JUMP:	pc = in.m_imm; continue;
+	case OP_JUMPZ:	if (!l) pc = in.m_imm; continue;
+	case OP_JUMPNZ:	if (l) pc = in.m_imm; continue;
+	default:
+	    v3fatalSrc("Unknown SimulateCode op");
+	    return false;
+	}
+	regs[in.m_dst] = out & in.m_mask;
+    }
+    return true;
+}
@@ -0,0 +1,127 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//*************************************************************************
+// DESCRIPTION: Verilator: Compiled evaluation of simulatable code
+//
+// Code available from: http://www.veripool.org/verilator
+//
+//*************************************************************************
+//
+// Copyright 2003-2017 by Wilson Snyder.  This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+//
+// Verilator is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+//*************************************************************************
+//
+// void example_usage() {
+//	SimulateCode code (nodep);
+//	if (code.ok()) {
+//	    for (...) code.input(code.inputSlot(invscp), #);
+//	    if (code.run()) {
+//		int slot = code.outputSlot(outvscp);
+//		if (slot >= 0 && code.outputSet(slot)) ... code.outputValue(slot)
+//	    } else {
+//		// An X resulted, use SimulateVisitor for this evaluation
+//	    }
+//	}
+//
+//*************************************************************************
+
+#ifndef _V3SIMULATECODE_H_
+#define _V3SIMULATECODE_H_ 1
+#include "config_build.h"
+#include "verilatedos.h"
+#include "V3Error.h"
+#include "V3Ast.h"
+
+#include <map>
+#include <vector>
+
+//============================================================================
+
+class SimulateCode {
+    // Evaluates an always block as SimulateVisitor::mainTableEmulate would,
+    // after lowering it once to linear code over 64-bit registers.
+    // Only two-state, 64 bit or narrower code is compiled; else ok() is false.
+    // Every register holds its node's value masked to the node's width.
+public:
+    enum Op {
+	OP_AND, OP_OR, OP_XOR, OP_NOT, OP_NEGATE,
+	OP_ADD, OP_SUB, OP_MUL,
+	OP_EQ, OP_NEQ, OP_LT, OP_LTE, OP_LTS, OP_LTES,
+	OP_SHIFTL, OP_SHIFTR,
+	OP_REDAND, OP_REDOR, OP_REDXOR,
+	OP_LOGNOT, OP_LOGAND, OP_LOGOR,
+	OP_SEL, OP_CONCAT, OP_EXTENDS, OP_COND, OP_COPY,
+	OP_STORE, OP_JUMP, OP_JUMPZ, OP_JUMPNZ
+    };
+private:
+    struct Insn {
+	uint8_t		m_op;		// Op
+	uint32_t	m_dst;		// Destination register (or output for OP_STORE)
+	uint32_t	m_lhs;		// Operand registers
+	uint32_t	m_rhs;
+	uint32_t	m_ths;
+	uint32_t	m_imm;		// Width, shift, or jump target
+	vluint64_t	m_mask;		// Mask of destination width
+	Insn(Op op, uint32_t dst, uint32_t lhs, uint32_t rhs, uint32_t ths,
+	     uint32_t imm, vluint64_t mask)
+	    : m_op(op), m_dst(dst), m_lhs(lhs), m_rhs(rhs), m_ths(ths), m_imm(imm), m_mask(mask) {}
+    };
+    typedef map<AstVarScope*,uint32_t> VarSlotMap;
+
+    // MEMBERS
+    bool		m_ok;		// Compiled successfully
+    AstNode*		m_whyNotNodep;	// First node not compiled
+    vector<Insn>	m_insns;	// Code
+    vector<vluint64_t>	m_regs;		// Registers; constants are loaded at compile time
+    vector<vluint64_t>	m_outs;		// Output values
+    vector<uint8_t>	m_outSet;	// True if output was assigned
+    VarSlotMap		m_inSlots;	// Register of each input variable
+    VarSlotMap		m_outSlots;	// Output slot of each output variable
+
+    static int debug();
+
+    // METHODS
+    uint32_t newReg(vluint64_t value=0) { m_regs.push_back(value); return m_regs.size()-1; }
+    uint32_t emit(Op op, AstNode* nodep, uint32_t lhs, uint32_t rhs=0, uint32_t ths=0, uint32_t imm=0);
+    void fail(AstNode* nodep);
+    bool widthOk(AstNode* nodep);
+    void compileStmts(AstNode* nodep);
+    void compileStmt(AstNode* nodep);
+    uint32_t compileExpr(AstNode* nodep);
+    uint32_t compileBiop(Op op, AstNodeBiop* nodep, bool swap=false);
+public:
+    // CONSTRUCTORS
+    explicit SimulateCode(AstNode* nodep);
+    ~SimulateCode() {}
+
+    // ACCESSORS
+    bool ok() const { return m_ok; }
+    AstNode* whyNotNodep() const { return m_whyNotNodep; }
+    size_t size() const { return m_insns.size(); }
+    // Register of input variable, or -1 if not read
+    int inputSlot(AstVarScope* vscp) const {
+	VarSlotMap::const_iterator it = m_inSlots.find(vscp);
+	return (it == m_inSlots.end()) ? -1 : (int)it->second;
+    }
+    // Output slot of output variable, or -1 if never assigned
+    int outputSlot(AstVarScope* vscp) const {
+	VarSlotMap::const_iterator it = m_outSlots.find(vscp);
+	return (it == m_outSlots.end()) ? -1 : (int)it->second;
+    }
+    void input(int slot, vluint64_t value) { if (slot >= 0) m_regs[slot] = value; }
+    bool outputSet(int slot) const { return m_outSet[slot]; }
+    vluint64_t outputValue(int slot) const { return m_outs[slot]; }
+
+    // METHODS
+    // Evaluate; false if a value would be X, and SimulateVisitor is needed instead
+    bool run();
+};
+
+#endif // Guard
@@ -29,6 +29,7 @@
 //	    SEL, EXTEND
 //	      We might be assigning a 1-D packed array to a 2-D packed array,
 //	      this is unsupported.
+//	    ASSIGN of whole large arrays: replaced with a loop copying each element
 //	    SliceCloneVisitor (called if this node is a slice):
 //	      NODEASSIGN
 //	        Clone and iterate the clone:
@@ -45,6 +46,7 @@
 #include "V3Global.h"
 #include "V3Slice.h"
 #include "V3Ast.h"
+#include "V3Stats.h"
 #include <vector>
 
 class SliceCloneVisitor : public AstNVisitor {
@@ -210,10 +212,13 @@ class SliceVisitor : public AstNVisitor {
     typedef pair<uint32_t, uint32_t> ArrayDimensions;	// Array Dimensions (packed, unpacked)
 
     // STATE
+    AstScope*		m_scopep;	// Current scope
     AstNode*		m_assignp;	// Assignment we are under
     AstNodeVarRef*	m_lhsVarRefp;	// Var on the LHS
     bool		m_extend;	// We have found an extend node
     bool		m_assignError;	// True if the current assign already has an error
+    int			m_loopNum;	// Number of array copy loops created
+    V3Double0		m_statLoops;	// Statistic tracking
 
     // METHODS
     static int debug() {
@@ -288,7 +293,66 @@ class SliceVisitor : public AstNVisitor {
 	return topp->castArraySel();
     }
 
+    bool copyLoop(AstNodeAssign* nodep) {
+	// Replace a blocking copy of a whole large array with a loop, rather than
+	// a statement per element.  Delayed assignments are left as statements,
+	// as V3Delayed commits each element's index separately.
+	// Return true if replaced.
+	if (!nodep->castAssign() || !m_scopep) return false;
+	AstVarRef* lhsp = nodep->lhsp()->castVarRef();
+	AstVarRef* rhsp = nodep->rhsp()->castVarRef();
+	if (!lhsp || !rhsp || !lhsp->varScopep() || !rhsp->varScopep()) return false;
+	if (lhsp->varp() == rhsp->varp()) return false;
+	AstUnpackArrayDType* ladtypep = lhsp->dtypep()->skipRefp()->castUnpackArrayDType();
+	AstUnpackArrayDType* radtypep = rhsp->dtypep()->skipRefp()->castUnpackArrayDType();
+	if (!ladtypep || !radtypep) return false;
+	if (ladtypep->subDTypep()->skipRefp()->castUnpackArrayDType()
+	    || radtypep->subDTypep()->skipRefp()->castUnpackArrayDType()) return false;  // Single dimension only
+	int elements = ladtypep->elementsConst();
+	if (elements != radtypep->elementsConst()
+	    || ladtypep->subDTypep()->width() != radtypep->subDTypep()->width()
+	    // Same endianness, so element N of each side is the same index
+	    || ladtypep->rangep()->littleEndian() != radtypep->rangep()->littleEndian()) return false;
+	if (elements <= v3Global.opt.unrollCount()) return false;  // Would be unrolled anyways
+	UINFO(4,"  Array copy loop "<<nodep<<endl);
+	FileLine* fl = nodep->fileline();
+	// Loop index
+	AstVar* varp = new AstVar(fl, AstVarType::BLOCKTEMP, "__Vslice"+cvtToStr(m_loopNum++),
+				  VFlagBitPacked(), 32);
+	m_scopep->modp()->addStmtp(varp);
+	AstVarScope* varscp = new AstVarScope(fl, m_scopep, varp);
+	m_scopep->addVarp(varscp);
+	// for (i=0; i<elements; i=i+1) lhs[i] = rhs[i];
+	AstNode* initp = new AstAssign(fl, new AstVarRef(fl, varscp, true),
+				       new AstConst(fl, 0));
+	AstNode* bodyp = new AstAssign(fl,
+				       new AstArraySel(fl, lhsp->cloneTree(false),
+						       new AstVarRef(fl, varscp, false)),
+				       new AstArraySel(fl, rhsp->cloneTree(false),
+						       new AstVarRef(fl, varscp, false)));
+	AstNode* incp = new AstAssign(fl, new AstVarRef(fl, varscp, true),
+				      new AstAdd(fl, new AstVarRef(fl, varscp, false),
+						 new AstConst(fl, 1)));
+	initp->user1(true);  // Already done, don't slice
+	bodyp->user1(true);
+	incp->user1(true);
+	AstWhile* whilep = new AstWhile(fl, new AstLt(fl, new AstVarRef(fl, varscp, false),
+						      new AstConst(fl, elements)),
+					bodyp, incp);
+	whilep->loops(elements);
+	++m_statLoops;
+	initp->addNext(whilep);
+	nodep->replaceWith(initp);
+	pushDeletep(nodep); VL_DANGLING(nodep);
+	return true;
+    }
+
     // VISITORS
+    virtual void visit(AstScope* nodep) {
+	m_scopep = nodep;
+	nodep->iterateChildren(*this);
+	m_scopep = NULL;
+    }
     virtual void visit(AstVarRef* nodep) {
 	// The LHS/RHS of an Assign may be to a Var that is an array. In this
 	// case we need to create a slice across the entire Var
@@ -432,6 +496,7 @@ class SliceVisitor : public AstNVisitor {
 		pushDeletep(nodep); VL_DANGLING(nodep);
 		return;  // Will iterate in a moment
 	    }
+	    if (copyLoop(nodep)) return;
 	    // Hasn't been searched for implicit slices yet
 	    findImplicit(nodep);
 	}
@@ -535,11 +600,15 @@ class SliceVisitor : public AstNVisitor {
 public:
     // CONSTUCTORS
     explicit SliceVisitor(AstNetlist* rootp) {
+	m_scopep = NULL;
 	m_assignp = NULL;
 	m_lhsVarRefp = NULL;
+	m_loopNum = 0;
 	rootp->accept(*this);
     }
-    virtual ~SliceVisitor() {}
+    virtual ~SliceVisitor() {
+	V3Stats::addStat("Optimizations, Slice array copy loops", m_statLoops);
+    }
 };
 
 //######################################################################
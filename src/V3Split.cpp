@@ -96,11 +96,14 @@ protected:
 
 class SplitLogicVertex : public SplitNodeVertex {
     uint32_t	m_splitColor;	// Copied from color() when determined
+    uint32_t	m_stmtOrder;	// Position in block, when interleaving
 public:
     SplitLogicVertex(V3Graph* graphp, AstNode* nodep)
-	: SplitNodeVertex(graphp,nodep), m_splitColor(0) {}
+	: SplitNodeVertex(graphp,nodep), m_splitColor(0), m_stmtOrder(0) {}
     void splitColor(uint32_t flag) { m_splitColor=flag; }
     uint32_t splitColor() const { return m_splitColor; }
+    void stmtOrder(uint32_t order) { m_stmtOrder=order; }
+    uint32_t stmtOrder() const { return m_stmtOrder; }
     virtual ~SplitLogicVertex() {}
     virtual string dotColor() const { return "yellow"; }
 };
@@ -208,6 +211,21 @@ public:
     virtual string dotStyle() const { return ignoreThisStep()?"dotted":V3GraphEdge::dotStyle(); }
 };
 
+//######################################################################
+// Sorting
+
+struct SplitStmtOrderCmp {
+    inline bool operator() (const SplitLogicVertex* lhsp, const SplitLogicVertex* rhsp) const {
+	return lhsp->stmtOrder() < rhsp->stmtOrder();
+    }
+};
+
+struct SplitRankDescCmp {
+    inline bool operator() (const V3GraphVertex* lhsp, const V3GraphVertex* rhsp) const {
+	return lhsp->rank() > rhsp->rank();
+    }
+};
+
 //######################################################################
 // Split class functions
 
@@ -234,6 +252,7 @@ private:
     V3Graph		m_graph;	// Scoreboard of var usages/dependencies
     bool		m_inDly;	// Inside ASSIGNDLY
     V3Double0		m_statSplits;	// Statistic tracking
+    V3Double0		m_statInterleaved;	// Statistic tracking
 
     // METHODS
     static int debug() {
@@ -342,17 +361,21 @@ private:
 	// Add hard orderings between all nodes of same color, in the order they appeared
 	vector<SplitLogicVertex*> lastOfColor;  lastOfColor.resize(numVertexes);
 	for (uint32_t i=0; i<numVertexes; i++) lastOfColor[i] = NULL;
+	uint32_t stmtOrder = 0;
 	for (AstNode* nextp=nodep; nextp; nextp=nextp->nextp()) {
 	    SplitLogicVertex* vvertexp = (SplitLogicVertex*)nextp->user3p();
 	    vvertexp->splitColor(vvertexp->color());
+	    vvertexp->stmtOrder(++stmtOrder);
 	    uint32_t color = vvertexp->splitColor();
 	    if (color >= numVertexes) nextp->v3fatalSrc("More colors than vertexes");
 	    if (!color) nextp->v3fatalSrc("No node color assigned");
+	    if (interleave()) continue;  // Ordered by dependencies below instead
 	    if (lastOfColor[color]) {
 		new SplitStrictEdge(&m_graph, lastOfColor[color], vvertexp);
 	    }
 	    lastOfColor[color] = vvertexp;
 	}
+	if (interleave()) strictDependencies();
 
 	// And a real ordering to get the statements into something reasonable
 	// We don't care if there's cutable violations here...
@@ -360,15 +383,66 @@ private:
 	if (debug()>=9) m_graph.dumpDotFilePrefixed((string)"splitg_preo", false);
 	m_graph.acyclic(&SplitEdge::followCyclic);
 	m_graph.rank(&SplitEdge::followCyclic);  // Or order(), but that's more expensive
+	if (interleave()) criticalPaths();
 	if (debug()>=9) m_graph.dumpDotFilePrefixed((string)"splitg_opt", false);
     }
 
+    bool interleave() const { return m_reorder && v3Global.opt.oInterleave(); }
+
+    void strictDependencies() {
+	// Rather than keeping each color in its original order, only order
+	// statements sharing a variable (or PLI), so independent dependency
+	// chains within a color may be interleaved.  Each variable orders all
+	// the statements using it, in the order they appeared.
+	vector<SplitLogicVertex*> users;
+	for (V3GraphVertex* vertexp = m_graph.verticesBeginp(); vertexp; vertexp=vertexp->verticesNextp()) {
+	    if (dynamic_cast<SplitLogicVertex*>(vertexp)) continue;
+	    users.clear();
+	    for (V3GraphEdge* edgep = vertexp->inBeginp(); edgep; edgep=edgep->inNextp()) {
+		SplitLogicVertex* lvertexp = dynamic_cast<SplitLogicVertex*>(edgep->fromp());
+		if (lvertexp && lvertexp->user() && SplitEdge::followCyclic(edgep)) users.push_back(lvertexp);
+	    }
+	    for (V3GraphEdge* edgep = vertexp->outBeginp(); edgep; edgep=edgep->outNextp()) {
+		SplitLogicVertex* lvertexp = dynamic_cast<SplitLogicVertex*>(edgep->top());
+		if (lvertexp && lvertexp->user() && SplitEdge::followCyclic(edgep)) users.push_back(lvertexp);
+	    }
+	    sort(users.begin(), users.end(), SplitStmtOrderCmp());
+	    users.erase(unique(users.begin(), users.end()), users.end());
+	    for (size_t i=1; i<users.size(); ++i) {
+		new SplitStrictEdge(&m_graph, users[i-1], users[i]);
+	    }
+	}
+    }
+
+    void criticalPaths() {
+	// Set each vertex's user() to its longest path to the end of the block.
+	// Among statements of the same rank, those heading the longest chains
+	// go first, so each chain's next statement follows others' work.
+	vector<V3GraphVertex*> vertices;
+	for (V3GraphVertex* vertexp = m_graph.verticesBeginp(); vertexp; vertexp=vertexp->verticesNextp()) {
+	    vertices.push_back(vertexp);
+	}
+	stable_sort(vertices.begin(), vertices.end(), SplitRankDescCmp());
+	for (vector<V3GraphVertex*>::iterator it = vertices.begin(); it != vertices.end(); ++it) {
+	    V3GraphVertex* vertexp = *it;
+	    uint32_t height = 0;
+	    for (V3GraphEdge* edgep = vertexp->outBeginp(); edgep; edgep=edgep->outNextp()) {
+		if (edgep->weight() && SplitEdge::followCyclic(edgep)
+		    && edgep->top()->rank() > vertexp->rank()) {
+		    height = max(height, (uint32_t)edgep->top()->user() + 1);
+		}
+	    }
+	    vertexp->user(height);
+	}
+    }
+
     void reorderBlock(AstNode* nodep) {
 	// Reorder statements in the completed graph
 	AstAlways* splitAlwaysp = nodep->backp()->castAlways();
 
-	// Map the rank numbers into nodes they associate with
-	typedef multimap<uint32_t,AstNode*> RankNodeMap;
+	// Map the rank numbers into nodes they associate with.  When
+	// interleaving, longer critical paths go first within a rank.
+	typedef multimap<pair<uint32_t,uint32_t>,AstNode*> RankNodeMap;
 	typedef map<uint32_t,RankNodeMap> ColorRankMap;
 	ColorRankMap colorRankMap;
 	uint32_t firstColor = 0;  bool multiColors = false;
@@ -377,7 +451,8 @@ private:
 	    SplitLogicVertex* vvertexp = (SplitLogicVertex*)nextp->user3p();
 	    if (!splitAlwaysp) vvertexp->splitColor(1);  // All blocks remain as-is
 	    RankNodeMap& rankMap = colorRankMap[vvertexp->splitColor()];
-	    rankMap.insert(make_pair(vvertexp->rank(), nextp));
+	    uint32_t height = interleave() ? vvertexp->user() : 0;
+	    rankMap.insert(make_pair(make_pair(vvertexp->rank(), ~height), nextp));
 	    if (firstColor && firstColor != vvertexp->splitColor()) multiColors = true;
 	    firstColor = vvertexp->splitColor();
 	    nextp->user4(++currOrder);   // Record current ordering
@@ -399,6 +474,8 @@ private:
 	if (leaveAlone) {
 	    UINFO(6,"   No changes\n");
 	} else {
+	    // Without interleaving, a single color keeps its original order
+	    if (interleave() && !splitAlwaysp) ++m_statInterleaved;
 	    AstNRelinker replaceHandle;	// Where to add the list
 	    AstNode* addAfterp = splitAlwaysp;
 
@@ -570,6 +647,7 @@ public:
     }
     virtual ~SplitVisitor() {
 	V3Stats::addStat("Optimizations, Split always", m_statSplits);
+	if (m_reorder) V3Stats::addStat("Optimizations, Split interleaved blocks", m_statInterleaved);
     }
 };
 
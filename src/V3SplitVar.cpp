@@ -0,0 +1,372 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//*************************************************************************
+// DESCRIPTION: Verilator: Split variables that form false combinational loops
+//
+// Code available from: http://www.veripool.org/verilator
+//
+//*************************************************************************
+//
+// Copyright 2003-2017 by Wilson Snyder.  This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License
+// Version 2.0.
+//
+// Verilator is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+//*************************************************************************
+// V3SplitVar's Transformations:
+//
+//	Build a graph of combinational logic and the variables it reads and writes
+//	Find variables in a strongly connected component, that is a loop which
+//	V3Order would report as UNOPTFLAT
+//	For each such vector where every write is to a constant select,
+//	    Break at the boundaries of the writes into a variable per piece
+//	    Replace writes with the piece, reads with the pieces concatenated
+//	For each such unpacked array where every access is a constant index,
+//	    Make a variable per element
+//	If the loop was only through different bits, V3Order now finds no loop.
+//
+//*************************************************************************
+
+#include "config_build.h"
+#include "verilatedos.h"
+#include <cstdio>
+#include <cstdarg>
+#include <unistd.h>
+#include <algorithm>
+#include <vector>
+#include <map>
+#include <set>
+
+#include "V3Global.h"
+#include "V3SplitVar.h"
+#include "V3Graph.h"
+#include "V3Stats.h"
+#include "V3Ast.h"
+
+// CONFIG
+static const int SPLITVAR_ELEMENTS_MAX = 256;	// Most elements or pieces to split into
+
+//######################################################################
+// Graph of combo logic, and per-variable access information
+
+class SplitVarVertex : public V3GraphVertex {
+    AstNode*	m_nodep;	// Logic statement or AstVarScope
+public:
+    SplitVarVertex(V3Graph* graphp, AstNode* nodep)
+	: V3GraphVertex(graphp), m_nodep(nodep) {}
+    virtual ~SplitVarVertex() {}
+    virtual string name() const { return cvtToStr((void*)m_nodep)+" "+m_nodep->prettyTypeName(); }
+};
+
+class SplitVarInfo {
+public:
+    // MEMBERS
+    AstVarScope*	m_vscp;		// Variable being checked
+    const char*		m_badp;		// Reason can't be split, or NULL
+    vector<AstVarRef*>	m_refs;		// All references
+    vector<pair<int,int> > m_writes;	// Lsb and width of each write
+    SplitVarVertex*	m_vertexp;	// Graph vertex, if in combo logic
+    // CONSTRUCTORS
+    explicit SplitVarInfo(AstVarScope* vscp)
+	: m_vscp(vscp), m_badp(NULL), m_vertexp(NULL) {}
+    ~SplitVarInfo() {}
+    void bad(const char* reasonp) { if (!m_badp) m_badp = reasonp; }
+};
+
+//######################################################################
+// Split state, as a visitor of each AstNode
+
+class SplitVarVisitor : public AstNVisitor {
+private:
+    // NODE STATE
+    //  AstVarScope::user1p()	// SplitVarInfo*, access information
+    AstUser1InUse	m_inuser1;
+
+    // TYPES
+    struct Piece {
+	int		m_lsb;		// Lowest bit, or element index for arrays
+	int		m_width;	// Width, or 1 for array elements
+	AstVarScope*	m_vscp;		// Piece's variable
+	Piece(int lsb, int width) : m_lsb(lsb), m_width(width), m_vscp(NULL) {}
+    };
+    typedef vector<Piece> Pieces;
+    typedef map<pair<AstNodeModule*,string>, AstVar*> VarMap;
+
+    // STATE
+    V3Graph		m_graph;	// Combo logic and variables
+    vector<SplitVarInfo*> m_infos;	// All variable information, for cleanup
+    VarMap		m_modVarMap;	// Pieces' AstVars already created, per module
+    SplitVarVertex*	m_logicVertexp;	// Current combo logic statement, or NULL
+    AstActive*		m_activep;	// Current active
+    bool		m_inSens;	// Under a sensitivity item
+    V3Double0		m_statVars;	// Statistic tracking
+    V3Double0		m_statPieces;	// Statistic tracking
+
+    // METHODS
+    static int debug() {
+	static int level = -1;
+	if (VL_UNLIKELY(level < 0)) level = v3Global.opt.debugSrcLevel(__FILE__);
+	return level;
+    }
+
+    SplitVarInfo* getInfo(AstVarScope* vscp) {
+	if (!vscp->user1p()) {
+	    SplitVarInfo* infop = new SplitVarInfo(vscp);
+	    m_infos.push_back(infop);
+	    vscp->user1p(infop);
+	}
+	return (SplitVarInfo*)(vscp->user1p());
+    }
+    static AstNodeDType* arrayDTypep(AstVar* varp) {
+	return varp->dtypeSkipRefp()->castUnpackArrayDType();
+    }
+
+    const char* varCantSplit(AstVar* varp) {
+	// Reason variable can't be split, independent of references
+	if (varp->isIO()) return "port";
+	if (varp->isSigPublic()) return "public";
+	if (varp->isParam()) return "parameter";
+	if (varp->isUsedClock()) return "clock";
+	if (varp->attrIsolateAssign()) return "isolate_assignments";
+	if (varp->isDouble() || varp->isString()) return "not integral";
+	if (AstUnpackArrayDType* adtypep = varp->dtypeSkipRefp()->castUnpackArrayDType()) {
+	    if (adtypep->elementsConst() > SPLITVAR_ELEMENTS_MAX) return "array too large";
+	} else if (varp->width() < 2) {
+	    return "single bit";
+	}
+	return NULL;
+    }
+
+    bool makePieces(SplitVarInfo* infop, Pieces& pieces) {
+	// Determine pieces; false if can't split
+	AstVar* varp = infop->m_vscp->varp();
+	if (AstUnpackArrayDType* adtypep = varp->dtypeSkipRefp()->castUnpackArrayDType()) {
+	    for (int i=0; i<adtypep->elementsConst(); ++i) pieces.push_back(Piece(i,1));
+	    return true;
+	}
+	// Break at the boundaries of every write
+	set<int> bounds;
+	bounds.insert(0);
+	bounds.insert(varp->width());
+	for (vector<pair<int,int> >::iterator it = infop->m_writes.begin(); it != infop->m_writes.end(); ++it) {
+	    bounds.insert(it->first);
+	    bounds.insert(it->first + it->second);
+	}
+	// Each write must then be exactly one piece
+	for (vector<pair<int,int> >::iterator it = infop->m_writes.begin(); it != infop->m_writes.end(); ++it) {
+	    set<int>::iterator bit = bounds.upper_bound(it->first);
+	    if (bit == bounds.end() || *bit != it->first + it->second) {
+		infop->bad("overlapping writes");
+		return false;
+	    }
+	}
+	int lsb = 0;
+	for (set<int>::iterator it = bounds.begin(); it != bounds.end(); ++it) {
+	    if (*it == 0) continue;
+	    pieces.push_back(Piece(lsb, *it - lsb));
+	    lsb = *it;
+	}
+	if (pieces.size() < 2) { infop->bad("written whole"); return false; }
+	if ((int)pieces.size() > SPLITVAR_ELEMENTS_MAX) { infop->bad("too many pieces"); return false; }
+	return true;
+    }
+
+    AstVarScope* createPiece(AstVarScope* oldvscp, const string& name, AstNodeDType* dtypep, int width) {
+	// As scoped, need both an AstVar per module, and an AstVarScope per scope
+	AstNodeModule* addmodp = oldvscp->scopep()->modp();
+	AstVar* varp;
+	VarMap::iterator it = m_modVarMap.find(make_pair(addmodp, name));
+	if (it != m_modVarMap.end()) {
+	    varp = it->second;
+	} else {
+	    if (dtypep) {
+		varp = new AstVar(oldvscp->fileline(), AstVarType::MODULETEMP, name, dtypep);
+	    } else {
+		varp = new AstVar(oldvscp->fileline(), AstVarType::MODULETEMP, name, VFlagBitPacked(), width);
+	    }
+	    addmodp->addStmtp(varp);
+	    m_modVarMap.insert(make_pair(make_pair(addmodp, name), varp));
+	}
+	AstVarScope* vscp = new AstVarScope(oldvscp->fileline(), oldvscp->scopep(), varp);
+	oldvscp->scopep()->addVarp(vscp);
+	return vscp;
+    }
+
+    AstNode* readPieces(FileLine* fl, const Pieces& pieces, int lsb, int width) {
+	// Expression reading bits [lsb+width-1:lsb] from the pieces, most significant first
+	AstNode* exprp = NULL;
+	for (Pieces::const_reverse_iterator it = pieces.rbegin(); it != pieces.rend(); ++it) {
+	    int lo = max(lsb, it->m_lsb);
+	    int hi = min(lsb+width, it->m_lsb+it->m_width);
+	    if (lo >= hi) continue;
+	    AstNode* termp = new AstVarRef(fl, it->m_vscp, false);
+	    if (lo != it->m_lsb || hi != it->m_lsb+it->m_width) {
+		termp = new AstSel(fl, termp, lo - it->m_lsb, hi - lo);
+	    }
+	    exprp = exprp ? new AstConcat(fl, exprp, termp) : termp;
+	}
+	return exprp;
+    }
+    const Piece& findPiece(const Pieces& pieces, int lsb) {
+	for (Pieces::const_iterator it = pieces.begin(); it != pieces.end(); ++it) {
+	    if (it->m_lsb == lsb) return *it;
+	}
+	v3fatalSrc("Write not on a piece boundary");
+	return pieces[0];
+    }
+
+    void splitVar(SplitVarInfo* infop) {
+	AstVarScope* vscp = infop->m_vscp;
+	AstVar* varp = vscp->varp();
+	Pieces pieces;
+	if (!makePieces(infop, pieces)) {
+	    UINFO(4,"  Can't split, "<<infop->m_badp<<": "<<vscp<<endl);
+	    return;
+	}
+	UINFO(4,"  Split into "<<pieces.size()<<": "<<vscp<<endl);
+	AstUnpackArrayDType* adtypep = varp->dtypeSkipRefp()->castUnpackArrayDType();
+	for (Pieces::iterator it = pieces.begin(); it != pieces.end(); ++it) {
+	    string name;
+	    if (adtypep || it->m_width == 1) {
+		name = varp->name()+"__BRA__"+cvtToStr(it->m_lsb)+"__KET__";
+	    } else {
+		name = (varp->name()+"__BRA__"+cvtToStr(it->m_lsb+it->m_width-1)
+			+"__03a"+cvtToStr(it->m_lsb)+"__KET__");
+	    }
+	    it->m_vscp = createPiece(vscp, name, adtypep ? adtypep->subDTypep() : NULL, it->m_width);
+	}
+	for (vector<AstVarRef*>::iterator it = infop->m_refs.begin(); it != infop->m_refs.end(); ++it) {
+	    AstVarRef* refp = *it;
+	    FileLine* fl = refp->fileline();
+	    if (adtypep) {
+		AstArraySel* selp = refp->backp()->castArraySel();
+		int index = selp->bitp()->castConst()->toSInt();
+		AstNode* newp = new AstVarRef(fl, pieces[index].m_vscp, refp->lvalue());
+		selp->replaceWith(newp); pushDeletep(selp); VL_DANGLING(selp);
+	    } else if (AstSel* selp = refp->backp()->castSel()) {
+		AstNode* newp;
+		if (refp->lvalue()) {
+		    newp = new AstVarRef(fl, findPiece(pieces, selp->lsbConst()).m_vscp, true);
+		} else {
+		    newp = readPieces(fl, pieces, selp->lsbConst(), selp->widthConst());
+		}
+		selp->replaceWith(newp); pushDeletep(selp); VL_DANGLING(selp);
+	    } else {
+		AstNode* newp = readPieces(fl, pieces, 0, varp->width());
+		refp->replaceWith(newp); pushDeletep(refp); VL_DANGLING(refp);
+	    }
+	}
+	++m_statVars;
+	m_statPieces += pieces.size();
+    }
+
+    void splitLoops() {
+	// Find variables in loops, and split those we can
+	m_graph.stronglyConnected(&V3GraphEdge::followAlwaysTrue);
+	if (debug()>=6) m_graph.dumpDotFilePrefixed("splitvar");
+	for (vector<SplitVarInfo*>::iterator it = m_infos.begin(); it != m_infos.end(); ++it) {
+	    SplitVarInfo* infop = *it;
+	    if (!infop->m_vertexp || !infop->m_vertexp->color()) continue;  // Not in a loop
+	    if (infop->m_badp) {
+		UINFO(4,"  Can't split, "<<infop->m_badp<<": "<<infop->m_vscp<<endl);
+		continue;
+	    }
+	    splitVar(infop);
+	}
+    }
+
+    // VISITORS
+    virtual void visit(AstNetlist* nodep) {
+	nodep->iterateChildren(*this);
+	splitLoops();
+    }
+    virtual void visit(AstActive* nodep) {
+	m_activep = nodep;
+	bool combo = nodep->sensesp()->hasCombo();
+	if (nodep->sensesStorep()) nodep->sensesStorep()->accept(*this);
+	for (AstNode* stmtp = nodep->stmtsp(); stmtp; stmtp=stmtp->nextp()) {
+	    m_logicVertexp = combo ? new SplitVarVertex(&m_graph, stmtp) : NULL;
+	    stmtp->accept(*this);
+	}
+	m_logicVertexp = NULL;
+	m_activep = NULL;
+    }
+    virtual void visit(AstNodeSenItem* nodep) {
+	m_inSens = true;
+	nodep->iterateChildren(*this);
+	m_inSens = false;
+    }
+    virtual void visit(AstVarRef* nodep) {
+	AstVarScope* vscp = nodep->varScopep();
+	if (!vscp) nodep->v3fatalSrc("Not linked");
+	SplitVarInfo* infop = getInfo(vscp);
+	infop->m_refs.push_back(nodep);
+	if (infop->m_refs.size() == 1) {
+	    if (const char* reasonp = varCantSplit(vscp->varp())) infop->bad(reasonp);
+	}
+	if (m_inSens) infop->bad("sensitivity");
+	else if (!m_activep) infop->bad("referenced outside logic");
+	// Classify the access
+	AstNode* backp = nodep->backp();
+	if (arrayDTypep(vscp->varp())) {
+	    AstArraySel* selp = backp->castArraySel();
+	    AstConst* indexp = selp ? selp->bitp()->castConst() : NULL;
+	    if (!selp || selp->fromp() != nodep || !indexp
+		|| indexp->toSInt() < 0
+		|| indexp->toSInt() >= arrayDTypep(vscp->varp())->castUnpackArrayDType()->elementsConst()) {
+		infop->bad("not constant index");
+	    }
+	} else {
+	    AstSel* selp = backp->castSel();
+	    if (selp && selp->fromp() == nodep
+		&& selp->lsbp()->castConst() && selp->widthp()->castConst()
+		&& selp->lsbConst() >= 0 && selp->msbConst() < vscp->varp()->width()) {
+		if (nodep->lvalue()) infop->m_writes.push_back(make_pair(selp->lsbConst(), selp->widthConst()));
+	    } else if (nodep->lvalue()) {
+		infop->bad("not constant select write");
+	    } else if (vscp->varp()->isSigned()) {
+		infop->bad("signed read");
+	    }
+	}
+	// Graph the dependency
+	if (m_logicVertexp) {
+	    if (!infop->m_vertexp) infop->m_vertexp = new SplitVarVertex(&m_graph, vscp);
+	    if (nodep->lvalue()) new V3GraphEdge(&m_graph, m_logicVertexp, infop->m_vertexp, 1);
+	    else new V3GraphEdge(&m_graph, infop->m_vertexp, m_logicVertexp, 1);
+	}
+    }
+
+    //--------------------
+    virtual void visit(AstNode* nodep) {
+	nodep->iterateChildren(*this);
+    }
+
+public:
+    // CONSTUCTORS
+    explicit SplitVarVisitor(AstNetlist* nodep) {
+	m_logicVertexp = NULL;
+	m_activep = NULL;
+	m_inSens = false;
+	nodep->accept(*this);
+    }
+    virtual ~SplitVarVisitor() {
+	for (vector<SplitVarInfo*>::iterator it = m_infos.begin(); it != m_infos.end(); ++it) {
+	    delete *it;
+	}
+	V3Stats::addStat("Optimizations, Split loop variables", m_statVars);
+	V3Stats::addStat("Optimizations, Split loop variable pieces", m_statPieces);
+    }
+};
+
+//######################################################################
+// SplitVar class functions
+
+void V3SplitVar::splitVarAll(AstNetlist* nodep) {
+    UINFO(2,__FUNCTION__<<": "<<endl);
+    SplitVarVisitor visitor (nodep);
+    V3Global::dumpCheckGlobalTree("splitvar.tree", 0, v3Global.opt.dumpTreeLevel(__FILE__) >= 3);
+}
@@ -30,6 +30,7 @@
 #include "V3Stats.h"
 #include "V3Ast.h"
 #include "V3File.h"
+#include "V3EmitCBase.h"
 
 // This visitor does not edit nodes, and is called at error-exit, so should use constant iterators
 #include "V3AstConstOnly.h"
@@ -256,6 +257,83 @@ public:
     }
 };
 
+//######################################################################
+// Memory stats class functions
+
+class StatsMemoryVisitor : public EmitCBaseVisitor {
+private:
+    // STATE
+    AstNodeModule*	m_modp;		// Current module
+    double		m_instances;	// Scopes of current module
+    V3Double0		m_statBytes;	// Statistic tracking
+    V3Double0		m_statArrayBytes;	// Statistic tracking
+    V3Double0		m_statSparseBytes;	// Statistic tracking
+    V3Double0		m_statShadowBytes;	// Statistic tracking
+    V3Double0		m_statTraceBytes;	// Statistic tracking
+
+    // VISITORS
+    virtual void visit(AstNodeModule* nodep) {
+	// Same members as the module's generated __Vmemory table, times its instances
+	m_modp = nodep;
+	m_instances = 0;
+	nodep->iterateChildrenConst(*this);
+	double bytes = 0;
+	double arrayBytes = 0;
+	double shadowBytes = 0;
+	for (AstNode* stmtp=nodep->stmtsp(); stmtp; stmtp = stmtp->nextp()) {
+	    if (AstVar* varp = stmtp->castVar()) {
+		if (!classMemberVar(varp)) continue;
+		double varbytes = varBytes(varp);
+		if (sparseArray(varp)) {  // Pages are allocated on use
+		    m_statSparseBytes += varbytes * m_instances;
+		    continue;
+		}
+		bytes += varbytes;
+		if (varp->isShadow()) {
+		    shadowBytes += varbytes;
+		} else if (varp->dtypeSkipRefp()->castUnpackArrayDType()) {
+		    arrayBytes += varbytes;
+		    if (v3Global.opt.statsVars()) {
+			V3Stats::addStat("Final", "Memory, array "+nodep->prettyName()+"."+varp->prettyName()
+					 +", bytes", varbytes * m_instances);
+		    }
+		}
+	    }
+	}
+	if (bytes && m_instances) {
+	    V3Stats::addStat("Final", "Memory, module "+nodep->prettyName()+", bytes", bytes * m_instances);
+	    m_statBytes += bytes * m_instances;
+	    m_statArrayBytes += arrayBytes * m_instances;
+	    m_statShadowBytes += shadowBytes * m_instances;
+	}
+	m_modp = NULL;
+    }
+    virtual void visit(AstScope* nodep) {
+	++m_instances;
+    }
+    virtual void visit(AstTraceDecl* nodep) {
+	m_statTraceBytes += nodep->codeInc() * sizeof(vluint32_t);
+    }
+    virtual void visit(AstNodeMath*) {}  // Accelerate
+    virtual void visit(AstNode* nodep) {
+	nodep->iterateChildrenConst(*this);
+    }
+public:
+    // CONSTRUCTORS
+    explicit StatsMemoryVisitor(AstNetlist* nodep) {
+	m_modp = NULL;
+	m_instances = 0;
+	nodep->accept(*this);
+    }
+    virtual ~StatsMemoryVisitor() {
+	V3Stats::addStat("Final", "Memory, TOTAL, bytes", m_statBytes);
+	V3Stats::addStat("Final", "Memory, arrays, bytes", m_statArrayBytes);
+	V3Stats::addStat("Final", "Memory, sparse arrays, maximum bytes", m_statSparseBytes);
+	V3Stats::addStat("Final", "Memory, shadow copies, bytes", m_statShadowBytes);
+	V3Stats::addStat("Final", "Memory, trace old values, bytes", m_statTraceBytes);
+    }
+};
+
 //######################################################################
 // Top Stats class
 
@@ -266,4 +344,5 @@ void V3Stats::statsStageAll(AstNetlist* nodep, const string& stage, bool fast) {
 void V3Stats::statsFinalAll(AstNetlist* nodep) {
     statsStageAll(nodep, "Final");
     statsStageAll(nodep, "Final_Fast", true);
+    StatsMemoryVisitor memVisitor (nodep);
 }
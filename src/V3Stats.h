@@ -90,6 +90,8 @@ public:
     /// Called by the top level to collect statistics
     static void statsStageAll(AstNetlist* nodep, const string& stage, bool fast=false);
     static void statsFinalAll(AstNetlist* nodep);
+    /// Called at the end of each pass, to record its time and memory
+    static void statsPass(const string& name);
     /// Called by the top level to dump the statistics
     static void statsReport();
 };
@@ -30,6 +30,63 @@
 #include "V3Stats.h"
 #include "V3Ast.h"
 #include "V3File.h"
+#include "V3Os.h"
+
+//######################################################################
+// Pass timing
+
+class StatsPasses {
+public:
+    // TYPES
+    struct Pass {
+	string		m_name;		// Pass name, from its tree dump filename
+	double		m_wall;		// Wall seconds in pass
+	double		m_cpu;		// CPU seconds in pass
+	vluint64_t	m_memBytes;	// Resident memory at end of pass
+	vluint64_t	m_peakBytes;	// Peak resident memory at end of pass
+    };
+    typedef vector<Pass> PassColl;
+
+    // STATE
+    static PassColl	s_passes;	///< All passes, in order run
+    static double	s_lastWall;	///< Wall time at end of last pass
+    static double	s_lastCpu;	///< CPU time at end of last pass
+    static bool		s_memWarned;	///< Reported going over --stats-budget-memory
+
+    // METHODS
+    static double toMB(vluint64_t bytes) { return (double)bytes / (1024.0*1024.0); }
+    static void addPass(const string& name) {
+	Pass pass;
+	double wall = V3Os::timeWall();
+	double cpu = V3Os::timeCpu();
+	pass.m_name = name;
+	pass.m_wall = wall - s_lastWall;
+	pass.m_cpu = cpu - s_lastCpu;
+	pass.m_memBytes = V3Os::memUsageBytes();
+	pass.m_peakBytes = V3Os::memPeakBytes();
+	s_lastWall = wall;
+	s_lastCpu = cpu;
+	s_passes.push_back(pass);
+	UINFO(5,"Pass "<<name<<" wall="<<pass.m_wall<<" cpu="<<pass.m_cpu
+	      <<" mem="<<pass.m_memBytes<<endl);
+	if (v3Global.opt.statsBudgetTime()
+	    && pass.m_wall > v3Global.opt.statsBudgetTime()) {
+	    v3info("Pass "<<name<<" took "<<fixed<<setprecision(1)<<pass.m_wall
+		   <<" seconds, over --stats-budget-time "<<v3Global.opt.statsBudgetTime());
+	}
+	if (v3Global.opt.statsBudgetMemory() && !s_memWarned
+	    && toMB(pass.m_memBytes) > v3Global.opt.statsBudgetMemory()) {
+	    s_memWarned = true;
+	    v3info("Pass "<<name<<" grew memory to "<<fixed<<setprecision(1)<<toMB(pass.m_memBytes)
+		   <<" MB, over --stats-budget-memory "<<v3Global.opt.statsBudgetMemory());
+	}
+    }
+};
+
+StatsPasses::PassColl	StatsPasses::s_passes;
+double	StatsPasses::s_lastWall = V3Os::timeWall();
+double	StatsPasses::s_lastCpu = V3Os::timeCpu();
+bool	StatsPasses::s_memWarned = false;
 
 //######################################################################
 // Stats dumping
@@ -170,11 +227,82 @@ class StatsReport {
 	os<<endl;
     }
 
+    void passes() {
+	os<<"Pass Statistics:\n";
+	os<<endl;
+	const StatsPasses::PassColl& passes = StatsPasses::s_passes;
+	size_t maxWidth = 4;
+	for (StatsPasses::PassColl::const_iterator it = passes.begin(); it!=passes.end(); ++it) {
+	    if (maxWidth < it->m_name.length()) maxWidth = it->m_name.length();
+	}
+	os<<"  #    "<<left<<setw(maxWidth)<<"Pass"
+	  <<"  "<<right<<setw(9)<<"Wall s"<<"  "<<setw(9)<<"CPU s"
+	  <<"  "<<setw(9)<<"Mem MB"<<"  "<<setw(9)<<"Peak MB"<<endl;
+	double wall = 0;
+	double cpu = 0;
+	int num = 0;
+	for (StatsPasses::PassColl::const_iterator it = passes.begin(); it!=passes.end(); ++it) {
+	    wall += it->m_wall;
+	    cpu += it->m_cpu;
+	    os<<"  "<<left<<setw(3)<<++num<<"  "<<setw(maxWidth)<<it->m_name
+	      <<"  "<<right<<fixed<<setprecision(3)<<setw(9)<<it->m_wall
+	      <<"  "<<setw(9)<<it->m_cpu
+	      <<"  "<<setprecision(1)<<setw(9)<<StatsPasses::toMB(it->m_memBytes)
+	      <<"  "<<setw(9)<<StatsPasses::toMB(it->m_peakBytes)<<endl;
+	}
+	os<<"       "<<left<<setw(maxWidth)<<"Total"
+	  <<"  "<<right<<fixed<<setprecision(3)<<setw(9)<<wall
+	  <<"  "<<setw(9)<<cpu<<endl;
+	os<<endl;
+    }
+
 public:
     // METHODS
     static void addStat(const V3Statistic& stat) {
 	s_allStats.push_back(stat);
     }
+    static string jsonString(const string& str) {
+	string out = "\"";
+	for (string::const_iterator it = str.begin(); it != str.end(); ++it) {
+	    if (*it == '"' || *it == '\\') {
+		out += '\\'; out += *it;
+	    } else if ((unsigned char)(*it) < 0x20) {
+		char buf[10]; sprintf(buf, "\\u%04x", (unsigned char)(*it));
+		out += buf;
+	    } else {
+		out += *it;
+	    }
+	}
+	return out+"\"";
+    }
+    static void json(ofstream& os) {
+	// Machine readable copy of the report, for tracking Verilation cost
+	os<<"{\n";
+	os<<"  \"version\": "<<jsonString(v3Global.opt.version())<<",\n";
+	os<<"  \"passes\": [";
+	const StatsPasses::PassColl& passes = StatsPasses::s_passes;
+	for (StatsPasses::PassColl::const_iterator it = passes.begin(); it!=passes.end(); ++it) {
+	    os<<(it==passes.begin() ? "\n" : ",\n");
+	    os<<"    {\"name\": "<<jsonString(it->m_name)
+	      <<", \"wall\": "<<fixed<<setprecision(6)<<it->m_wall
+	      <<", \"cpu\": "<<it->m_cpu
+	      <<", \"mem_bytes\": "<<it->m_memBytes
+	      <<", \"peak_bytes\": "<<it->m_peakBytes<<"}";
+	}
+	os<<"\n  ],\n";
+	os<<"  \"stats\": [";
+	bool first = true;
+	for (StatColl::iterator it = s_allStats.begin(); it!=s_allStats.end(); ++it) {
+	    if (!it->printit()) continue;
+	    os<<(first ? "\n" : ",\n");
+	    first = false;
+	    os<<"    {\"stage\": "<<jsonString(it->stage())
+	      <<", \"name\": "<<jsonString(it->name())
+	      <<", \"count\": "<<fixed<<setprecision(0)<<it->count()<<"}";
+	}
+	os<<"\n  ]\n";
+	os<<"}\n";
+    }
 
     // CONSTRUCTORS
     explicit StatsReport(ofstream* aofp)
@@ -183,6 +311,7 @@ public:
 	sumit();
 	stars();
 	stages();
+	passes();
     }
     ~StatsReport() {}
 };
@@ -211,8 +340,24 @@ void V3Stats::statsReport() {
     ofstream* ofp (V3File::new_ofstream(filename));
     if (ofp->fail()) v3fatalSrc("Can't write "<<filename);
 
-    StatsReport reporter (ofp);
+    {
+	StatsReport reporter (ofp);
+    }
 
     // Cleanup
     ofp->close(); delete ofp; VL_DANGLING(ofp);
+
+    // JSON copy, after the text report combined any summed statistics
+    filename = v3Global.opt.makeDir()+"/"+v3Global.opt.prefix()+"__stats.json";
+    ofp = V3File::new_ofstream(filename);
+    if (ofp->fail()) v3fatalSrc("Can't write "<<filename);
+    StatsReport::json(*ofp);
+    ofp->close(); delete ofp; VL_DANGLING(ofp);
+}
+
+void V3Stats::statsPass(const string& name) {
+    if (!v3Global.opt.stats()
+	&& !v3Global.opt.statsBudgetTime()
+	&& !v3Global.opt.statsBudgetMemory()) return;
+    StatsPasses::addPass(name);
 }
@@ -29,6 +29,65 @@
 size_t VName::s_minLength = 32;
 size_t VName::s_maxLength = 0;	// Disabled
 
+//######################################################################
+// VIdent pool
+
+class VIdentPool {
+    // Open addressed hash table of pooled strings, kept under half full
+    // Strings are never freed, as identifiers may be held anywhere
+    vector<const string*> m_table;
+    size_t	m_size;		// Entries used
+    size_t	m_bytes;	// Characters stored
+    static size_t hash(const string& str) {
+	size_t h = 2166136261UL;  // FNV-1a
+	for (string::const_iterator it=str.begin(); it!=str.end(); ++it) {
+	    h = (h ^ (unsigned char)(*it)) * 16777619UL;
+	}
+	return h;
+    }
+    size_t slot(const string& str) const {
+	size_t mask = m_table.size()-1;
+	size_t i = hash(str) & mask;
+	while (m_table[i] && *m_table[i] != str) i = (i+1) & mask;
+	return i;
+    }
+    void rehash() {
+	vector<const string*> old; old.swap(m_table);
+	m_table.resize(old.size()*2, NULL);
+	for (vector<const string*>::iterator it=old.begin(); it!=old.end(); ++it) {
+	    if (*it) m_table[slot(**it)] = *it;
+	}
+    }
+public:
+    VIdentPool() : m_table(1024, NULL), m_size(0), m_bytes(0) {}
+    const string* find(const string& str) const { return m_table[slot(str)]; }
+    const string* intern(const string& str) {
+	size_t i = slot(str);
+	if (!m_table[i]) {
+	    m_table[i] = new string(str);
+	    ++m_size; m_bytes += str.length();
+	    if (m_size*2 > m_table.size()) rehash();
+	    return find(str);
+	}
+	return m_table[i];
+    }
+    size_t size() const { return m_size; }
+    size_t bytes() const { return m_bytes; }
+    static VIdentPool& singleton() {
+	static VIdentPool s_pool;  // Constructed on first use, as VIdents may be static
+	return s_pool;
+    }
+};
+
+const string* VIdent::intern(const string& str) { return VIdentPool::singleton().intern(str); }
+const string* VIdent::lookup(const string& str) { return VIdentPool::singleton().find(str); }
+const string* VIdent::emptyp() {
+    static const string* s_emptyp = intern("");
+    return s_emptyp;
+}
+size_t VIdent::poolSize() { return VIdentPool::singleton().size(); }
+size_t VIdent::poolBytes() { return VIdentPool::singleton().bytes(); }
+
 //######################################################################
 // Wildcard
 
@@ -105,6 +105,56 @@ public:
     static size_t maxLength() { return s_maxLength; }
 };
 
+//######################################################################
+// VIdent - interned identifier
+// Each distinct string is stored once in a global pool, so identifiers
+// share storage, copy as a pointer, and compare equal by pointer.
+
+class VIdent {
+    const string* m_strp;		// Pooled string, never freed
+    explicit VIdent(const string* strp) : m_strp(strp) {}
+    static const string* intern(const string& str);
+    static const string* lookup(const string& str);
+public:
+    // CONSTRUCTORS
+    VIdent() : m_strp(emptyp()) {}
+    VIdent(const string& str) : m_strp(intern(str)) {}  // Implicit, as a string
+    VIdent(const char* strp) : m_strp(intern(strp)) {}
+    ~VIdent() {}
+    VIdent& operator=(const string& str) { m_strp = intern(str); return *this; }
+    VIdent& operator=(const char* strp) { m_strp = intern(strp); return *this; }
+    // METHODS
+    /// Identifier with the given name if one was ever made, else VIdent::none()
+    /// Use for lookups, so misses never grow the pool
+    static VIdent find(const string& str) { return VIdent(lookup(str)); }
+    static VIdent none() { return VIdent((const string*)NULL); }
+    bool isNone() const { return m_strp==NULL; }
+    size_t hash() const { return ((size_t)m_strp >> 3) * 2654435761UL; }  // Hash of identity
+    const string& str() const { return *m_strp; }
+    operator const string&() const { return *m_strp; }
+    const char* c_str() const { return m_strp->c_str(); }
+    bool empty() const { return m_strp->empty(); }
+    size_t length() const { return m_strp->length(); }
+    bool operator==(const VIdent& rhs) const { return m_strp==rhs.m_strp; }
+    bool operator!=(const VIdent& rhs) const { return m_strp!=rhs.m_strp; }
+    bool operator==(const string& rhs) const { return *m_strp==rhs; }
+    bool operator!=(const string& rhs) const { return *m_strp!=rhs; }
+    bool operator==(const char* rhsp) const { return *m_strp==rhsp; }
+    bool operator!=(const char* rhsp) const { return *m_strp!=rhsp; }
+    /// Pointer ordering; fast but not alphabetical, so never use to order output
+    bool operator<(const VIdent& rhs) const { return m_strp<rhs.m_strp; }
+    // STATIC METHODS
+    static const string* emptyp();	// Pooled empty string
+    static size_t poolSize();		// Number of distinct identifiers
+    static size_t poolBytes();		// Characters stored in the pool
+};
+
+inline string operator+(const VIdent& lhs, const string& rhs) { return lhs.str()+rhs; }
+inline string operator+(const string& lhs, const VIdent& rhs) { return lhs+rhs.str(); }
+inline string operator+(const VIdent& lhs, const char* rhsp) { return lhs.str()+rhsp; }
+inline string operator+(const char* lhsp, const VIdent& rhs) { return lhsp+rhs.str(); }
+inline ostream& operator<<(ostream& os, const VIdent& rhs) { return os<<rhs.str(); }
+
 //######################################################################
 
 #endif // guard
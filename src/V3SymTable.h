@@ -29,10 +29,12 @@
 #include <map>
 #include <iomanip>
 #include <memory>
+#include <algorithm>
 
 #include "V3Global.h"
 #include "V3Ast.h"
 #include "V3File.h"
+#include "V3String.h"
 
 class VSymGraph;
 class VSymEnt;
@@ -42,11 +44,79 @@ class VSymEnt;
 
 typedef set<VSymEnt*> VSymMap;
 
+class VSymIdTable {
+    // Children of a symbol table by interned name
+    // Entries are kept in insertion order, with an open addressed index of
+    // entry numbers once there are more than a few entries
+    // Unnamed ("") entries may repeat; lookup finds the first
+public:
+    typedef vector<pair<VIdent,VSymEnt*> > Entries;
+    typedef Entries::const_iterator const_iterator;
+private:
+    enum { SCAN_MAX = 8 };	// Linear search up to this many entries, as most tables are small
+    Entries		m_entries;	// Entries, in insertion order
+    vector<size_t>	m_slots;	// Index into m_entries plus one, 0 if empty; sized power of two
+    size_t slotFor(VIdent id) const {
+	size_t mask = m_slots.size()-1;
+	size_t i = id.hash() & mask;
+	while (m_slots[i] && m_entries[m_slots[i]-1].first != id) i = (i+1) & mask;
+	return i;
+    }
+    void rehash(size_t minEntries) {
+	size_t size = 32;
+	while (size < minEntries*2) size *= 2;
+	if (size <= m_slots.size()) return;
+	m_slots.assign(size, 0);
+	for (size_t e=0; e<m_entries.size(); ++e) {
+	    size_t i = slotFor(m_entries[e].first);
+	    if (!m_slots[i]) m_slots[i] = e+1;  // Else repeat of an unnamed entry
+	}
+    }
+public:
+    VSymIdTable() {}
+    ~VSymIdTable() {}
+    const_iterator begin() const { return m_entries.begin(); }
+    const_iterator end() const { return m_entries.end(); }
+    size_t size() const { return m_entries.size(); }
+    void reserve(size_t entries) {
+	// Size the index for a batch of inserts, so it is rebuilt at most once
+	if (entries > SCAN_MAX) rehash(entries);
+    }
+    VSymEnt** findp(VIdent id) {
+	if (m_slots.empty()) {
+	    for (Entries::iterator it=m_entries.begin(); it!=m_entries.end(); ++it) {
+		if (it->first == id) return &(it->second);
+	    }
+	    return NULL;
+	}
+	size_t i = slotFor(id);
+	return m_slots[i] ? &(m_entries[m_slots[i]-1].second) : NULL;
+    }
+    VSymEnt* find(VIdent id) const {
+	VSymEnt** entpp = const_cast<VSymIdTable*>(this)->findp(id);
+	return entpp ? *entpp : NULL;
+    }
+    void insert(VIdent id, VSymEnt* entp) {
+	m_entries.push_back(make_pair(id, entp));
+	if (m_slots.empty()) {
+	    if (m_entries.size() > SCAN_MAX) rehash(m_entries.size());
+	} else if (m_entries.size()*2 > m_slots.size()) {
+	    rehash(m_entries.size());
+	} else {
+	    size_t i = slotFor(id);
+	    if (!m_slots[i]) m_slots[i] = m_entries.size();
+	}
+    }
+};
+
 class VSymEnt {
     // Symbol table that can have a "superior" table for resolving upper references
 private:
     // MEMBERS
-    typedef std::multimap<string,VSymEnt*> IdNameMap;
+    // Keyed by interned name, so lookups compare pointers, not strings;
+    // the order is not alphabetical, so sort anything that is printed
+    typedef VSymIdTable IdNameMap;
+    typedef vector<pair<string,VSymEnt*> > SortedNames;
     IdNameMap	m_idNameMap;	// Hash of variables by name
     AstNode*	m_nodep;	// Node that entry belongs to
     VSymEnt*	m_fallbackp;	// Table "above" this one in name scope, for fallback resolution
@@ -64,6 +134,26 @@ private:
 #else
     static inline int debug() { return 0; }  // NOT runtime, too hot of a function
 #endif
+    VSymEnt* findIdFlatId(VIdent id) const {
+	VSymEnt* entp = m_idNameMap.find(id);
+	UINFO(9, "     SymFind   se"<<(void*)this<<" '"<<id
+	      <<"' -> "<<(!entp ? "NONE"
+			  : "se"+cvtToStr((void*)(entp))+" n="+cvtToStr((void*)(entp->nodep())))<<endl);
+	return entp;
+    }
+    SortedNames sortedNames() const {
+	SortedNames names;
+	for (IdNameMap::const_iterator it=m_idNameMap.begin(); it!=m_idNameMap.end(); ++it) {
+	    names.push_back(make_pair(it->first.str(), it->second));
+	}
+	std::stable_sort(names.begin(), names.end(), SortedNamesCmp());
+	return names;
+    }
+    struct SortedNamesCmp {
+	bool operator() (const pair<string,VSymEnt*>& lhs, const pair<string,VSymEnt*>& rhs) const {
+	    return lhs.first < rhs.first;
+	}
+    };
 public:
     void dumpIterate(ostream& os, VSymMap& doneSymsr, const string& indent, int numLevels, const string& searchName) {
 	os<<indent<<"+ "<<left<<setw(30)<<(searchName==""?"\"\"":searchName)<<setw(0)<<right;
@@ -75,7 +165,8 @@ public:
 	    os<<indent<<"| ^ duplicate, so no children printed\n";
 	} else {
 	    doneSymsr.insert(this);
-	    for (IdNameMap::const_iterator it=m_idNameMap.begin(); it!=m_idNameMap.end(); ++it) {
+	    SortedNames names = sortedNames();
+	    for (SortedNames::const_iterator it=names.begin(); it!=names.end(); ++it) {
 		if (numLevels >= 1) {
 		    it->second->dumpIterate(os, doneSymsr, indent+"| ", numLevels-1, it->first);
 		}
@@ -116,20 +207,21 @@ public:
     void imported(bool flag) { m_imported = flag; }
     void insert(const string& name, VSymEnt* entp) {
 	UINFO(9, "     SymInsert se"<<(void*)this<<" '"<<name<<"' se"<<(void*)entp<<"  "<<entp->nodep()<<endl);
-	if (name != "" && m_idNameMap.find(name) != m_idNameMap.end()) {
+	VIdent id (name);
+	if (name != "" && m_idNameMap.find(id)) {
 	    if (!V3Error::errorCount()) {   // Else may have just reported warning
 		if (debug()>=9 || V3Error::debugDefault()) dump(cout,"- err-dump: ", 1);
 		entp->nodep()->v3fatalSrc("Inserting two symbols with same name: "<<name<<endl);
 	    }
 	} else {
-	    m_idNameMap.insert(make_pair(name, entp));
+	    m_idNameMap.insert(id, entp);
 	}
     }
     void reinsert(const string& name, VSymEnt* entp) {
-	IdNameMap::iterator it = m_idNameMap.find(name);
-	if (name!="" && it != m_idNameMap.end()) {
+	VSymEnt** entpp = m_idNameMap.findp(VIdent(name));
+	if (name!="" && entpp) {
 	    UINFO(9, "     SymReinsert se"<<(void*)this<<" '"<<name<<"' se"<<(void*)entp<<"  "<<entp->nodep()<<endl);
-	    it->second = entp;  // Replace
+	    *entpp = entp;  // Replace
 	} else {
 	    insert(name,entp);
 	}
@@ -137,19 +229,19 @@ public:
     VSymEnt* findIdFlat(const string& name) const {
 	// Find identifier without looking upward through symbol hierarchy
 	// First, scan this begin/end block or module for the name
-	IdNameMap::const_iterator it = m_idNameMap.find(name);
-	UINFO(9, "     SymFind   se"<<(void*)this<<" '"<<name
-	      <<"' -> "<<(it == m_idNameMap.end() ? "NONE"
-			  : "se"+cvtToStr((void*)(it->second))+" n="+cvtToStr((void*)(it->second->nodep())))<<endl);
-	if (it != m_idNameMap.end()) return (it->second);
-	return NULL;
+	// A name never interned can't be in any table, so don't intern it
+	VIdent id = VIdent::find(name);
+	if (id.isNone()) return NULL;
+	return findIdFlatId(id);
     }
     VSymEnt* findIdFallback(const string& name) const {
 	// Find identifier looking upward through symbol hierarchy
-	// First, scan this begin/end block or module for the name
-	if (VSymEnt* entp = findIdFlat(name)) return entp;
-	// Then scan the upper begin/end block or module for the name
-	if (m_fallbackp) return m_fallbackp->findIdFallback(name);
+	VIdent id = VIdent::find(name);  // Once, rather than at each level
+	if (id.isNone()) return NULL;
+	// Scan this begin/end block or module for the name, then the upper ones
+	for (const VSymEnt* symp = this; symp; symp = symp->m_fallbackp) {
+	    if (VSymEnt* entp = symp->findIdFlatId(id)) return entp;
+	}
 	return NULL;
     }
 private:
@@ -171,12 +263,12 @@ public:
 	// Returns true if successful
 	bool any = false;
 	if (id_or_star != "*") {
-	    IdNameMap::const_iterator it = srcp->m_idNameMap.find(id_or_star);
-	    if (it != m_idNameMap.end()) {
-		importOneSymbol(graphp, it->first, it->second);
+	    if (VSymEnt* impp = srcp->findIdFlat(id_or_star)) {
+		importOneSymbol(graphp, id_or_star, impp);
 	    }
 	    any = true;  // Legal, though perhaps lint questionable to import nothing
 	} else {
+	    m_idNameMap.reserve(m_idNameMap.size() + srcp->m_idNameMap.size());  // Index resized once
 	    for (IdNameMap::const_iterator it=srcp->m_idNameMap.begin(); it!=srcp->m_idNameMap.end(); ++it) {
 		if (importOneSymbol(graphp, it->first, it->second)) any = true;
 	    }
@@ -186,6 +278,7 @@ public:
     void importFromIface(VSymGraph* graphp, const VSymEnt* srcp, bool onlyUnmodportable = false) {
 	// Import interface tokens from source symbol table into this symbol table, recursively
 	UINFO(9, "     importIf  se"<<(void*)this<<" from se"<<(void*)srcp<<endl);
+	m_idNameMap.reserve(m_idNameMap.size() + srcp->m_idNameMap.size());
 	for (IdNameMap::const_iterator it=srcp->m_idNameMap.begin(); it!=srcp->m_idNameMap.end(); ++it) {
 	    const string& name = it->first;
 	    VSymEnt* subSrcp = it->second;
@@ -201,7 +294,8 @@ public:
     void cellErrorScopes(AstNode* lookp, string prettyName="") {
 	if (prettyName=="") prettyName = lookp->prettyName();
 	string scopes;
-	for (IdNameMap::iterator it = m_idNameMap.begin(); it!=m_idNameMap.end(); ++it) {
+	SortedNames names = sortedNames();
+	for (SortedNames::const_iterator it=names.begin(); it!=names.end(); ++it) {
 	    AstNode* nodep = it->second->nodep();
 	    if (nodep->castCell()
 		|| (nodep->castModule() && nodep->castModule()->isTop())) {
@@ -36,6 +36,7 @@
 #include "V3Global.h"
 #include "V3Table.h"
 #include "V3Simulate.h"
+#include "V3SimulateCode.h"
 #include "V3Stats.h"
 #include "V3Ast.h"
 
@@ -43,10 +44,12 @@
 // Table class functions
 
 // CONFIG
-static const double TABLE_MAX_BYTES = 1*1024*1024;	// 1MB is max table size (better be lots of instructs to be worth it!)
+// Maximum table size comes from --table-cache, tables must fit in the target cache
+static const double TABLE_RESIDENT_DIV = 8;		// Tables under 1/8th of the target cache assumed to stay resident
 static const double TABLE_TOTAL_BYTES = 64*1024*1024;	// 64MB is close to max memory of some systems (256MB or so), so don't get out of control
 static const double TABLE_SPACE_TIME_MULT = 8;		// Worth 8 bytes of data to replace a instruction
 static const int TABLE_MIN_NODE_COUNT = 32;	// If < 32 instructions, not worth the effort
+static const int TABLE_PACK_MAX_BITS = 32;	// Most single bit outputs to pack into one table
 
 //######################################################################
 
@@ -77,6 +80,14 @@ private:
     // STATE
     double	m_totalBytes;		// Total bytes in tables created
     V3Double0	m_statTablesCre;	// Statistic tracking
+    V3Double0	m_statTableBytes;	// Statistic tracking
+    V3Double0	m_statTablesPacked;	// Statistic tracking
+    V3Double0	m_statOutsPacked;	// Statistic tracking
+    V3Double0	m_statTablesCompiled;	// Statistic tracking
+    V3Double0	m_statRejFew;		// Statistic tracking
+    V3Double0	m_statRejCache;		// Statistic tracking
+    V3Double0	m_statRejTradeoff;	// Statistic tracking
+    V3Double0	m_statRejMemory;	// Statistic tracking
 
     //  State cleared on each module
     AstNodeModule*	m_modp;		// Current MODULE
@@ -93,9 +104,13 @@ private:
     deque<AstVarScope*> m_inVarps;	// Input variable list
     deque<AstVarScope*> m_outVarps;	// Output variable list
     deque<bool>    m_outNotSet;		// True if output variable is not set at some point
+    int		m_packOuts;		// Number of single bit outputs to bit-pack
 
     // When creating a table
-    deque<AstVarScope*> m_tableVarps;	// Table being created
+    deque<AstVarScope*> m_tableVarps;	// Tables being created
+    deque<int>	m_outTables;		// Per output, index into m_tableVarps
+    deque<int>	m_outBits;		// Per output, bit in packed table, or -1 if not packed
+    deque<bool>	m_tablePacked;		// Per table, true if bit-packed
 
     // METHODS
     static int debug() {
@@ -104,10 +119,22 @@ private:
 	return level;
     }
 
+    static bool packable(AstVarScope* vscp) {
+	// Single bit outputs are bit-packed together, rather than using a byte each
+	return vscp->varp()->dtypeSkipRefp()->castBasicDType() && vscp->width()==1;
+    }
+    static double packedBytes(int bits) {
+	// Natural storage of a packed table element, what the C++ type will be
+	if (bits <= 8) return 1;
+	else if (bits <= 16) return 2;
+	else return 4;
+    }
+
     bool treeTest(AstAlways* nodep) {
 	// Process alw/assign tree
 	m_inWidth = 0;
 	m_outWidth = 0;
+	m_packOuts = 0;
 	m_inVarps.clear();
 	m_outVarps.clear();
 	m_outNotSet.clear();
@@ -120,38 +147,66 @@ private:
 	// Also sets m_outWidth
 	// Also sets m_inVarps
 	// Also sets m_outVarps
+	bool simOk = chkvis.optimizable();
+
+	// Single bit outputs share bit-packed tables
+	double outBytes = m_outWidth;
+	for (deque<AstVarScope*>::iterator it = m_outVarps.begin(); it!=m_outVarps.end(); ++it) {
+	    if (packable(*it)) m_packOuts++;
+	}
+	if (m_packOuts < 2) m_packOuts = 0;
+	if (m_packOuts) {
+	    outBytes -= m_packOuts;  // Each was a byte unpacked
+	    for (int bits = m_packOuts; bits > 0; bits -= TABLE_PACK_MAX_BITS) {
+		outBytes += packedBytes(min(bits, TABLE_PACK_MAX_BITS));
+	    }
+	}
 
 	// Calc data storage in bytes
 	size_t chgWidth = m_outVarps.size();	// Width of one change-it-vector
 	if (chgWidth<8) chgWidth = 8;
 	double space = (pow((double)2,((double)(m_inWidth)))
-			*(double)(m_outWidth+chgWidth));
+			*(double)(outBytes+chgWidth));
 	// Instruction count bytes (ok, it's space also not time :)
 	double bytesPerInst = 4;
 	double time  = (chkvis.instrCount()*bytesPerInst + chkvis.dataCount()) + 1;  // +1 so won't div by zero
+	// Tables that take a good part of the cache will often miss, and a
+	// miss costs more than the logic, so they need to save more to be worth it.
+	double cacheBytes = (double)v3Global.opt.tableCache() * 1024;
+	double residentBytes = cacheBytes / TABLE_RESIDENT_DIV;
+	double spaceTimeMult = TABLE_SPACE_TIME_MULT;
+	if (space > residentBytes) {
+	    spaceTimeMult *= (cacheBytes - space) / (cacheBytes - residentBytes);
+	}
 	if (chkvis.instrCount() < TABLE_MIN_NODE_COUNT) {
 	    chkvis.clearOptimizable(nodep,"Table has too few nodes involved");
+	    if (simOk) ++m_statRejFew;
 	}
-	if (space > TABLE_MAX_BYTES) {
+	else if (space > cacheBytes) {
 	    chkvis.clearOptimizable(nodep,"Table takes too much space");
+	    if (simOk) ++m_statRejCache;
 	}
-	if (space > time * TABLE_SPACE_TIME_MULT) {
+	else if (space > time * spaceTimeMult) {
 	    chkvis.clearOptimizable(nodep,"Table has bad tradeoff");
+	    if (simOk) ++m_statRejTradeoff;
 	}
-	if (m_totalBytes > TABLE_TOTAL_BYTES) {
+	else if (m_totalBytes > TABLE_TOTAL_BYTES) {
 	    chkvis.clearOptimizable(nodep,"Table out of memory");
+	    if (simOk) ++m_statRejMemory;
 	}
 	if (!m_outWidth || !m_inWidth) {
 	    chkvis.clearOptimizable(nodep,"Table has no outputs");
 	}
 	UINFO(4, "  Test: Opt="<<(chkvis.optimizable()?"OK":"NO")
 	      <<", Instrs="<<chkvis.instrCount()<<" Data="<<chkvis.dataCount()
-	      <<" inw="<<m_inWidth<<" outw="<<m_outWidth
+	      <<" inw="<<m_inWidth<<" outw="<<m_outWidth<<" packed="<<m_packOuts
 	      <<" Spacetime="<<(space/time)<<"("<<space<<"/"<<time<<")"
+	      <<" Mult="<<spaceTimeMult
 	      <<": "<<nodep<<endl);
 	if (chkvis.optimizable()) {
 	    UINFO(3, " Table Optimize spacetime="<<(space/time)<<" "<<nodep<<endl);
 	    m_totalBytes += space;
+	    m_statTableBytes += space;
 	}
 	return chkvis.optimizable();
     }
@@ -228,29 +283,60 @@ private:
 
 	// Cleanup internal structures
 	m_tableVarps.clear();
+	m_outTables.clear();
+	m_outBits.clear();
+	m_tablePacked.clear();
+    }
+
+    AstVarScope* createTableVar(AstNode* nodep, AstNodeDType* subDTypep, const string& suffix) {
+	FileLine* fl = nodep->fileline();
+	AstNodeArrayDType* dtypep
+	    = new AstUnpackArrayDType (fl, subDTypep,
+				       new AstRange (fl, VL_MASK_I(m_inWidth), 0));
+	v3Global.rootp()->typeTablep()->addTypesp(dtypep);
+	AstVar* tablevarp
+	    = new AstVar (fl, AstVarType::MODULETEMP,
+			  "__Vtable" + cvtToStr(m_modTables) +"_"+suffix,
+			  dtypep);
+	tablevarp->isConst(true);
+	tablevarp->isStatic(true);
+	tablevarp->valuep(new AstInitArray (nodep->fileline(), dtypep, NULL));
+	m_modp->addStmtp(tablevarp);
+	AstVarScope* tablevscp = new AstVarScope(tablevarp->fileline(), m_scopep, tablevarp);
+	m_scopep->addVarp(tablevscp);
+	m_tableVarps.push_back(tablevscp);
+	return tablevscp;
     }
 
     void createTableVars(AstNode* nodep) {
-	// Create table for each output
+	// Create table for each output, except single bit outputs,
+	// which are packed TABLE_PACK_MAX_BITS to a table
+	int packLeft = m_packOuts;
+	int packTable = -1;
+	int packBit = 0;
 	for (deque<AstVarScope*>::iterator it = m_outVarps.begin(); it!=m_outVarps.end(); ++it) {
 	    AstVarScope* outvscp = *it;
 	    AstVar* outvarp = outvscp->varp();
-	    FileLine* fl = nodep->fileline();
-	    AstNodeArrayDType* dtypep
-		= new AstUnpackArrayDType (fl, outvarp->dtypep(),
-					   new AstRange (fl, VL_MASK_I(m_inWidth), 0));
-	    v3Global.rootp()->typeTablep()->addTypesp(dtypep);
-	    AstVar* tablevarp
-		= new AstVar (fl, AstVarType::MODULETEMP,
-			      "__Vtable" + cvtToStr(m_modTables) +"_"+outvarp->name(),
-			      dtypep);
-	    tablevarp->isConst(true);
-	    tablevarp->isStatic(true);
-	    tablevarp->valuep(new AstInitArray (nodep->fileline(), dtypep, NULL));
-	    m_modp->addStmtp(tablevarp);
-	    AstVarScope* tablevscp = new AstVarScope(tablevarp->fileline(), m_scopep, tablevarp);
-	    m_scopep->addVarp(tablevscp);
-	    m_tableVarps.push_back(tablevscp);
+	    if (m_packOuts && packable(outvscp)) {
+		if (packTable < 0 || packBit >= TABLE_PACK_MAX_BITS) {
+		    int bits = min(packLeft, TABLE_PACK_MAX_BITS);
+		    packTable = m_tableVarps.size();
+		    packBit = 0;
+		    createTableVar(nodep, nodep->findBitDType(bits, bits, AstNumeric::UNSIGNED),
+				   "_Vpack"+cvtToStr(packTable));
+		    m_tablePacked.push_back(true);
+		    ++m_statTablesPacked;
+		}
+		m_outTables.push_back(packTable);
+		m_outBits.push_back(packBit++);
+		--packLeft;
+		++m_statOutsPacked;
+	    } else {
+		m_outTables.push_back(m_tableVarps.size());
+		m_outBits.push_back(-1);
+		createTableVar(nodep, outvarp->dtypep(), outvarp->name());
+		m_tablePacked.push_back(false);
+	    }
 	}
     }
 
@@ -283,54 +369,103 @@ private:
 	}
 	uint32_t inValueNextInitArray=0;
 	TableSimulateVisitor simvis (this);
+	// Evaluating the compiled form is much faster than walking the tree per
+	// input value; any value it can't represent falls back to simvis
+	SimulateCode code (nodep);
+	if (code.ok()) ++m_statTablesCompiled;
+	vector<int> inSlots;
+	for (deque<AstVarScope*>::iterator it = m_inVarps.begin(); it!=m_inVarps.end(); ++it) {
+	    inSlots.push_back(code.inputSlot(*it));
+	}
 	for (uint32_t inValue=0; inValue <= VL_MASK_I(m_inWidth); inValue++) {
 	    // Make a new simulation structure so we can set new input values
 	    UINFO(8," Simulating "<<hex<<inValue<<endl);
 
-	    // Above simulateVisitor clears user 3, so
-	    // all outputs default to NULL to mean 'recirculating'.
-	    simvis.clear();
-
-	    // Set all inputs to the constant
-	    uint32_t shift = 0;
-	    for (deque<AstVarScope*>::iterator it = m_inVarps.begin(); it!=m_inVarps.end(); ++it) {
-		AstVarScope* invscp = *it;
-		// LSB is first variable, so extract it that way
-		simvis.newNumber(invscp, VL_MASK_I(invscp->width()) & (inValue>>shift));
-		shift += invscp->width();
-		// We're just using32 bit arithmetic, because there's no way the input table can be 2^32 bytes!
-		if (shift>31) nodep->v3fatalSrc("shift overflow");
-		UINFO(8,"   Input "<<invscp->name()<<" = "<<*(simvis.fetchNumber(invscp))<<endl);
+	    bool compiled = false;
+	    if (code.ok()) {
+		uint32_t shift = 0;
+		for (size_t in = 0; in < m_inVarps.size(); ++in) {
+		    code.input(inSlots[in], VL_MASK_I(m_inVarps[in]->width()) & (inValue>>shift));
+		    shift += m_inVarps[in]->width();
+		}
+		compiled = code.run();
 	    }
+	    if (!compiled) {
+		// Above simulateVisitor clears user 3, so
+		// all outputs default to NULL to mean 'recirculating'.
+		simvis.clear();
+
+		// Set all inputs to the constant
+		uint32_t shift = 0;
+		for (deque<AstVarScope*>::iterator it = m_inVarps.begin(); it!=m_inVarps.end(); ++it) {
+		    AstVarScope* invscp = *it;
+		    // LSB is first variable, so extract it that way
+		    simvis.newNumber(invscp, VL_MASK_I(invscp->width()) & (inValue>>shift));
+		    shift += invscp->width();
+		    // We're just using32 bit arithmetic, because there's no way the input table can be 2^32 bytes!
+		    if (shift>31) nodep->v3fatalSrc("shift overflow");
+		    UINFO(8,"   Input "<<invscp->name()<<" = "<<*(simvis.fetchNumber(invscp))<<endl);
+		}
 
-	    // Simulate
-	    simvis.mainTableEmulate(nodep);
-	    if (!simvis.optimizable()) simvis.whyNotNodep()->v3fatalSrc("Optimizable cleared, even though earlier test run said not: "<<simvis.whyNotMessage());
+		// Simulate
+		simvis.mainTableEmulate(nodep);
+		if (!simvis.optimizable()) simvis.whyNotNodep()->v3fatalSrc("Optimizable cleared, even though earlier test run said not: "<<simvis.whyNotMessage());
+	    }
 
 	    // If a output changed, add it to table
 	    int outnum = 0;
 	    V3Number outputChgMask (nodep->fileline(), m_outVarps.size(), 0);
+	    deque<V3Number> packNums;  // Per table, value if a packed table
+	    for (deque<AstVarScope*>::iterator it = m_tableVarps.begin(); it!=m_tableVarps.end(); ++it) {
+		packNums.push_back(V3Number(nodep->fileline(), (*it)->varp()->dtypep()->castNodeArrayDType()->subDTypep()->width(), 0));
+	    }
 	    for (deque<AstVarScope*>::iterator it = m_outVarps.begin(); it!=m_outVarps.end(); ++it) {
 		AstVarScope* outvscp = *it;
-		V3Number* outnump = simvis.fetchOutNumberNull(outvscp);
-		AstNode* setp;
+		V3Number* outnump = NULL;
+		V3Number codenum (outvscp->fileline(), outvscp->width());
+		if (!compiled) {
+		    outnump = simvis.fetchOutNumberNull(outvscp);
+		} else {
+		    int slot = code.outputSlot(outvscp);
+		    if (slot >= 0 && code.outputSet(slot)) {
+			codenum.setQuad(code.outputValue(slot));
+			outnump = &codenum;
+		    }
+		}
+		int table = m_outTables[outnum];
+		int packBit = m_outBits[outnum];
+		AstNode* setp = NULL;
 		if (!outnump) {
 		    UINFO(8,"   Output "<<outvscp->name()<<" never set\n");
 		    m_outNotSet[outnum] = true;
 		    // Value in table is arbitrary, but we need something
-		    setp = new AstConst (outvscp->fileline(),
-					 V3Number(outvscp->fileline(), outvscp->width(), 0));
+		    if (packBit < 0) {
+			setp = new AstConst (outvscp->fileline(),
+					     V3Number(outvscp->fileline(), outvscp->width(), 0));
+		    }
 		} else {
 		    UINFO(8,"   Output "<<outvscp->name()<<" = "<<*outnump<<endl);
 		    //  m_tableVarps[inValue] = num;
 		    // Mark changed bit, too
 		    outputChgMask.setBit(outnum, 1);
-		    setp = new AstConst (outnump->fileline(), *outnump);
+		    if (packBit < 0) {
+			setp = new AstConst (outnump->fileline(), *outnump);
+		    } else if (outnump->isNeqZero()) {
+			packNums[table].setBit(packBit, 1);
+		    }
+		}
+		if (setp) {
+		    // Note InitArray requires us to have the values in inValue order
+		    m_tableVarps[table]->varp()->valuep()->castInitArray()->addValuep(setp);
 		}
-		// Note InitArray requires us to have the values in inValue order
-		m_tableVarps[outnum]->varp()->valuep()->castInitArray()->addValuep(setp);
 		outnum++;
 	    }
+	    for (int table = 0; table < (int)m_tableVarps.size(); ++table) {
+		if (m_tablePacked[table]) {
+		    AstNode* setp = new AstConst (nodep->fileline(), packNums[table]);
+		    m_tableVarps[table]->varp()->valuep()->castInitArray()->addValuep(setp);
+		}
+	    }
 
 	    {   // Set changed table
 		if (inValue != inValueNextInitArray++)
@@ -375,8 +510,11 @@ private:
 	    AstVarScope* outvscp = *it;
 	    AstNode* alhsp = new AstVarRef(nodep->fileline(), outvscp, true);
 	    AstNode* arhsp = new AstArraySel(nodep->fileline(),
-					     new AstVarRef(nodep->fileline(), m_tableVarps[outnum], false),
+					     new AstVarRef(nodep->fileline(), m_tableVarps[m_outTables[outnum]], false),
 					     new AstVarRef(nodep->fileline(), indexVscp, false));
+	    if (m_outBits[outnum] >= 0) {
+		arhsp = new AstSel(nodep->fileline(), arhsp, m_outBits[outnum], 1);
+	    }
 	    AstNode* outasnp = (m_assignDly
 				? (AstNode*)(new AstAssignDly (nodep->fileline(), alhsp, arhsp))
 				: (AstNode*)(new AstAssign (nodep->fileline(), alhsp, arhsp)));
@@ -444,11 +582,20 @@ public:
 	m_assignDly = 0;
 	m_inWidth = 0;
 	m_outWidth = 0;
+	m_packOuts = 0;
 	m_totalBytes = 0;
 	nodep->accept(*this);
     }
     virtual ~TableVisitor() {
 	V3Stats::addStat("Optimizations, Tables created", m_statTablesCre);
+	V3Stats::addStat("Optimizations, Tables created, bytes", m_statTableBytes);
+	V3Stats::addStat("Optimizations, Tables created, bit-packed", m_statTablesPacked);
+	V3Stats::addStat("Optimizations, Tables created, bit-packed outputs", m_statOutsPacked);
+	V3Stats::addStat("Optimizations, Tables created, compiled evaluation", m_statTablesCompiled);
+	V3Stats::addStat("Optimizations, Tables rejected, too few nodes", m_statRejFew);
+	V3Stats::addStat("Optimizations, Tables rejected, exceeds cache", m_statRejCache);
+	V3Stats::addStat("Optimizations, Tables rejected, bad tradeoff", m_statRejTradeoff);
+	V3Stats::addStat("Optimizations, Tables rejected, out of memory", m_statRejMemory);
     }
 };
 
@@ -41,22 +41,29 @@
 #include "V3EmitCBase.h"
 #include "V3Graph.h"
 #include "V3LinkLValue.h"
+#include "V3Stats.h"
+
+// Functions smaller than this are always inlined
+#define TASK_INLINE_SMALLER 50
 
 //######################################################################
 // Graph subclasses
 
 class TaskBaseVertex : public V3GraphVertex {
     AstNode*	m_impurep;	// Node causing impure function w/ outside references
-    bool	m_noInline;	// Marked with pragma
+    bool	m_noInline;	// Marked with pragma, or too large to inline
+    int		m_nodeCount;	// Nodes in the function, for inlining cost
 public:
     explicit TaskBaseVertex(V3Graph* graphp)
-	: V3GraphVertex(graphp), m_impurep(NULL), m_noInline(false) {}
+	: V3GraphVertex(graphp), m_impurep(NULL), m_noInline(false), m_nodeCount(0) {}
     virtual ~TaskBaseVertex() {}
     bool pure() const { return m_impurep==NULL; }
     AstNode* impureNode() const { return m_impurep; }
     void impure(AstNode* nodep) { m_impurep = nodep; }
     bool noInline() const { return m_noInline; }
     void noInline(bool flag) { m_noInline = flag; }
+    int nodeCount() const { return m_nodeCount; }
+    void nodeCountInc() { m_nodeCount++; }
 };
 
 class TaskFTaskVertex : public TaskBaseVertex {
@@ -114,6 +121,7 @@ private:
     AstAssignW*		m_assignwp;		// Current assignment
     V3Graph		m_callGraph;		// Task call graph
     TaskBaseVertex*	m_curVxp;		// Current vertex we're adding to
+    V3Double0		m_statNoInline;		// Statistic tracking
 
 public:
     // METHODS
@@ -151,6 +159,45 @@ public:
 	}
     }
 private:
+    bool pureCalls(TaskBaseVertex* vxp) {
+	// True if the task and all tasks it calls are pure
+	if (!vxp->pure()) return false;
+	for (V3GraphEdge* edgep = vxp->outBeginp(); edgep; edgep=edgep->outNextp()) {
+	    if (!pureCalls(static_cast<TaskBaseVertex*>(edgep->top()))) return false;
+	}
+	return true;
+    }
+    void chooseNoInline() {
+	// Inlining copies a function into each call, so costs calls*nodes new nodes.
+	// If over the --inline-mult-task budget, keep it as a C function instead,
+	// where that's supported.
+	int budget = v3Global.opt.inlineMultTask();
+	if (budget < 1) return;
+	for (V3GraphVertex* itp = m_callGraph.verticesBeginp(); itp; itp=itp->verticesNextp()) {
+	    TaskFTaskVertex* vxp = dynamic_cast<TaskFTaskVertex*>(itp);
+	    if (!vxp || vxp->noInline()) continue;
+	    AstNodeFTask* nodep = vxp->nodep();
+	    if (nodep->dpiExport() || nodep->taskPublic()) continue;  // Already a C function
+	    double calls = 0;
+	    for (V3GraphEdge* edgep = vxp->inBeginp(); edgep; edgep=edgep->inNextp()) {
+		calls += edgep->weight();
+	    }
+	    if (calls < 2 || vxp->nodeCount() < TASK_INLINE_SMALLER
+		|| calls * vxp->nodeCount() < budget) continue;
+	    // Non-inlined functions can't reference outside variables, nor have non-variable inouts
+	    if (!pureCalls(vxp)) continue;
+	    bool inout = false;
+	    for (AstNode* stmtp = nodep->stmtsp(); stmtp; stmtp=stmtp->nextp()) {
+		if (AstVar* portp = stmtp->castVar()) {
+		    if (portp->isInout()) inout = true;
+		}
+	    }
+	    if (inout) continue;
+	    UINFO(4, "  NoInline, calls="<<calls<<" nodes="<<vxp->nodeCount()<<" "<<nodep<<endl);
+	    vxp->noInline(true);
+	    ++m_statNoInline;
+	}
+    }
     TaskFTaskVertex* getFTaskVertex(AstNodeFTask* nodep) {
 	if (!nodep->user4p()) {
 	    nodep->user4p(new TaskFTaskVertex(&m_callGraph, nodep));
@@ -220,6 +267,7 @@ private:
     }
     virtual void visit(AstVarRef* nodep) {
 	nodep->iterateChildren(*this);
+	m_curVxp->nodeCountInc();
 	if (nodep->varp()->user4u().toGraphVertex() != m_curVxp) {
 	    if (m_curVxp->pure()
 		&& !nodep->varp()->isXTemp()) {
@@ -231,6 +279,7 @@ private:
     // Default: Just iterate
     virtual void visit(AstNode* nodep) {
 	nodep->iterateChildren(*this);
+	m_curVxp->nodeCountInc();
     }
 public:
     // CONSTUCTORS
@@ -244,8 +293,12 @@ public:
 	//
 	m_callGraph.removeRedundantEdgesSum(&TaskEdge::followAlwaysTrue);
 	m_callGraph.dumpDotFilePrefixed("task_call");
+	chooseNoInline();
+    }
+    virtual ~TaskStateVisitor() {
+	V3Stats::addStat("Optimizations, Task inline budget (--inline-mult-task)", v3Global.opt.inlineMultTask());
+	V3Stats::addStat("Optimizations, Tasks not inlined, over budget", m_statNoInline);
     }
-    virtual ~TaskStateVisitor() {}
 };
 
 //######################################################################
@@ -409,6 +462,7 @@ private:
 		    AstAssign* assp = new AstAssign (pinp->fileline(),
 						     pinp,
 						     new AstVarRef(outvscp->fileline(), outvscp, false));
+		    assp->fileline(new FileLine(assp->fileline()));  // Don't share the pin's
 		    assp->fileline()->modifyWarnOff(V3ErrorCode::BLKSEQ, true);  // Ok if in <= block
 		    // Put assignment BEHIND of all other statements
 		    beginp->addNext(assp);
@@ -420,6 +474,7 @@ private:
 		    AstAssign* assp = new AstAssign (pinp->fileline(),
 						     new AstVarRef(inVscp->fileline(), inVscp, true),
 						     pinp);
+		    assp->fileline(new FileLine(assp->fileline()));  // Don't share the pin's
 		    assp->fileline()->modifyWarnOff(V3ErrorCode::BLKSEQ, true);  // Ok if in <= block
 		    // Put assignment in FRONT of all other statements
 		    if (AstNode* afterp = beginp->nextp()) {
@@ -510,6 +565,7 @@ private:
 		    AstAssign* assp = new AstAssign (pinp->fileline(),
 						     pinp,
 						     new AstVarRef(outvscp->fileline(), outvscp, false));
+		    assp->fileline(new FileLine(assp->fileline()));  // Don't share the pin's
 		    assp->fileline()->modifyWarnOff(V3ErrorCode::BLKSEQ, true);  // Ok if in <= block
 		    // Put assignment BEHIND of all other statements
 		    beginp->addNext(assp);
@@ -649,9 +705,10 @@ private:
 	return newp;
     }
 
-    AstCFunc* makeDpiExportWrapper(AstNodeFTask* nodep, AstVar* rtnvarp) {
+    AstCFunc* makeDpiExportWrapper(AstNodeFTask* nodep, AstVar* rtnvarp, bool bound) {
+	// If bound, make {cname}__Vbound, taking a VerilatedDpiExport resolved by the caller
 	AstCFunc* dpip = new AstCFunc(nodep->fileline(),
-				      nodep->cname(),
+				      nodep->cname()+(bound ? "__Vbound" : ""),
 				      m_scopep,
 				      (rtnvarp ? rtnvarp->dpiArgType(true,true) : ""));
 	dpip->dontCombine(true);
@@ -659,10 +716,17 @@ private:
 	dpip->isStatic(true);
 	dpip->dpiExportWrapper(true);
 	dpip->cname(nodep->cname());
+	if (bound) dpip->argTypes("const VerilatedDpiExport& __Vexport");
 	// Add DPI reference to top, since it's a global function
 	m_topScopep->scopep()->addActivep(dpip);
 
-	{// Create dispatch wrapper
+	string cbtype = v3Global.opt.prefix()+"__Vcb_"+nodep->cname()+"_t";
+	if (bound) {
+	    string stmt;
+	    stmt += "const VerilatedScope* __Vscopep = __Vexport.scopep();\n";
+	    stmt += cbtype+" __Vcb = ("+cbtype+")(__Vexport.cbp());\n";
+	    dpip->addStmtsp(new AstCStmt(nodep->fileline(), stmt));
+	} else {// Create dispatch wrapper
 	    // Note this function may dispatch to myfunc on a different class.
 	    // Thus we need to be careful not to assume a particular function layout.
 	    //
@@ -678,7 +742,6 @@ private:
 	    // If the find fails, it will throw an error
 	    stmt += "const VerilatedScope* __Vscopep = Verilated::dpiScope();\n";
 	    // If dpiScope is fails and is null; the exportFind function throws and error
-	    string cbtype = v3Global.opt.prefix()+"__Vcb_"+nodep->cname()+"_t";
 	    stmt += cbtype+" __Vcb = ("+cbtype+")(VerilatedScope::exportFind(__Vscopep, __Vfuncnum));\n";  // Can't use static_cast
 	    // If __Vcb is null the exportFind function throws and error
 	    dpip->addStmtsp(new AstCStmt(nodep->fileline(), stmt));
@@ -781,6 +844,11 @@ private:
 		    bool bitvec = (portp->basicp()->isBitLogic() && portp->width() > 32);
 
 		    if (args != "") { args+= ", "; }
+		    if (bitvec && portp->isWide() && portp->isInOnly()) {
+			// WData is clean and laid out as svBitVecVal, so pass it without a copy
+			args += portp->name();
+			continue;
+		    }
 		    if (bitvec) {}
 		    else if (portp->isOutput()) args += "&";
 		    else if (portp->basicp() && portp->basicp()->isBitLogic() && portp->width() != 1) args += "&";  // it's a svBitVecVal
@@ -911,7 +979,8 @@ private:
 		if (nodep->dpiImport()) {
 		    dpip = makeDpiImportWrapper(nodep, rtnvarp);
 		} else if (nodep->dpiExport()) {
-		    dpip = makeDpiExportWrapper(nodep, rtnvarp);
+		    dpip = makeDpiExportWrapper(nodep, rtnvarp, false);
+		    makeDpiExportWrapper(nodep, rtnvarp, true);
 		    cfuncp->addInitsp(new AstComment(dpip->fileline(), (string)("Function called from: ")+dpip->cname()));
 		}
 
@@ -32,6 +32,9 @@
 //	For each CFUNC with unique callReason
 //		Make vertex
 //		For each var it sets, make vertex and edge from cfunc vertex
+//	For each large fast CFUNC, split statements into groups
+//		Make activity vertex for each group, set after its last statement
+//		For each var it sets, make edge from group vertex instead
 //
 //	For each CFUNC in graph
 //		Add ASSIGN(SEL(__Vm_traceActivity,activityNumber++),1)
@@ -43,6 +46,10 @@
 //	Assign trace codes:
 //		If from a VARSCOPE, record the trace->varscope map
 //		Else, assign trace codes to each variable
+//	If --combine-instances
+//		Assign codes in declaration order, each instance's together
+//		Where instances' declaration functions match but for the codes,
+//		call the first with a code offset instead
 //
 //*************************************************************************
 
@@ -146,6 +153,133 @@ public:
     virtual string dotColor() const { return "skyblue"; }
 };
 
+//######################################################################
+// Find macro-task groups, which must be handled before the calls in them
+
+class TraceMTaskFindVisitor : public AstNVisitor {
+private:
+    vector<AstExecMTasks*>	m_execps;	// Macro-task groups found
+    // VISITORS
+    virtual void visit(AstExecMTasks* nodep) {
+	m_execps.push_back(nodep);
+    }
+    virtual void visit(AstNodeMath*) {}  // Short circuit
+    virtual void visit(AstNode* nodep) {
+	nodep->iterateChildren(*this);
+    }
+public:
+    // CONSTUCTORS
+    explicit TraceMTaskFindVisitor(AstNetlist* nodep) {
+	nodep->accept(*this);
+    }
+    virtual ~TraceMTaskFindVisitor() {}
+    const vector<AstExecMTasks*>& execps() const { return m_execps; }
+};
+
+//######################################################################
+// Find signals that are combinational copies of another signal
+
+class TraceAliasVisitor : public AstNVisitor {
+private:
+    // A variable is an alias of another if every write of it is a whole
+    // variable copy "lhs = rhs" at the top level of a combo or settle
+    // function.  Eval only returns once combo logic has settled, so at every
+    // dump the alias has the value of its source, and it can be traced with
+    // the source's value, letting detectDuplicates share their codes.
+    // TYPES
+    typedef map<AstVarScope*,AstVarScope*> AliasMap;
+    // STATE
+    AliasMap	m_aliases;	// Source of each written variable, or NULL if not an alias
+    AstCFunc*	m_funcp;	// Current function
+    bool	m_comboFunc;	// Current function is combo or settle logic
+    // METHODS
+    static bool isTopStmt(AstNode* nodep, AstCFunc* funcp) {
+	// Statement is directly under the function, not conditional
+	while (nodep->backp() && nodep->backp()->nextp() == nodep) nodep = nodep->backp();
+	return nodep->backp() == funcp;
+    }
+    AstVarScope* sourcep(AstVarRef* nodep) {
+	if (!m_comboFunc) return NULL;
+	AstNodeAssign* assp = nodep->backp()->castNodeAssign();
+	if (!assp || assp->lhsp() != nodep || !isTopStmt(assp, m_funcp)) return NULL;
+	AstVarRef* rhsp = assp->rhsp()->castVarRef();
+	if (!rhsp || !rhsp->varScopep() || rhsp->varScopep() == nodep->varScopep()) return NULL;
+	if (rhsp->width() != nodep->width() || rhsp->isDouble() || nodep->isDouble()) return NULL;
+	if (nodep->varp()->isSigUserRWPublic()) return NULL;	// Can be written from C++
+	return rhsp->varScopep();
+    }
+    // VISITORS
+    virtual void visit(AstCFunc* nodep) {
+	m_funcp = nodep;
+	m_comboFunc = (nodep->name().substr(0,8) == "_combo__"
+		       || nodep->name().substr(0,9) == "_settle__");
+	nodep->iterateChildren(*this);
+	m_funcp = NULL;
+	m_comboFunc = false;
+    }
+    virtual void visit(AstVarRef* nodep) {
+	if (nodep->lvalue() && nodep->varScopep()) {
+	    AstVarScope* srcp = sourcep(nodep);
+	    AliasMap::iterator it = m_aliases.find(nodep->varScopep());
+	    if (it == m_aliases.end()) {
+		m_aliases.insert(make_pair(nodep->varScopep(), srcp));
+	    } else if (it->second != srcp) {
+		it->second = NULL;  // Written differently elsewhere
+	    }
+	}
+    }
+    virtual void visit(AstNode* nodep) {
+	nodep->iterateChildren(*this);
+    }
+public:
+    // CONSTUCTORS
+    explicit TraceAliasVisitor(AstNetlist* nodep) {
+	m_funcp = NULL;
+	m_comboFunc = false;
+	nodep->accept(*this);
+    }
+    virtual ~TraceAliasVisitor() {}
+    // METHODS
+    // Return the signal that always has the same value as vscp, or vscp itself
+    AstVarScope* rootp(AstVarScope* vscp) const {
+	for (size_t depth = 0; depth < m_aliases.size(); ++depth) {  // Bound protects against loops
+	    AliasMap::const_iterator it = m_aliases.find(vscp);
+	    if (it == m_aliases.end() || !it->second) break;
+	    vscp = it->second;
+	}
+	return vscp;
+    }
+};
+
+//######################################################################
+// Count writes of traced variables, to size activity groups
+
+class TraceWriteCountVisitor : public AstNVisitor {
+private:
+    // NODE STATE
+    // Entire netlist (from TraceVisitor):
+    //  AstVarScope::user1()		// V3GraphVertex* if traced
+    int		m_writes;	// Writes of traced variables found
+    // VISITORS
+    virtual void visit(AstVarRef* nodep) {
+	if (nodep->lvalue() && nodep->varScopep()
+	    && nodep->varScopep()->user1u().toGraphVertex()) {
+	    ++m_writes;
+	}
+    }
+    virtual void visit(AstNode* nodep) {
+	nodep->iterateChildren(*this);
+    }
+public:
+    // CONSTUCTORS
+    explicit TraceWriteCountVisitor(AstNode* nodep) {
+	m_writes = 0;
+	nodep->accept(*this);
+    }
+    virtual ~TraceWriteCountVisitor() {}
+    int writes() const { return m_writes; }
+};
+
 //######################################################################
 // Trace state, as a visitor of each AstNode
 
@@ -158,7 +292,7 @@ private:
     //  AstCFunc::user1()		// V3GraphVertex* for this node
     //  AstTraceInc::user1()		// V3GraphVertex* for this node
     //  AstVarScope::user1()		// V3GraphVertex* for this node
-    //  AstCCall::user2()		// bool; walked next list for other ccalls
+    //  AstCCall::user2()		// bool; walked next list for other ccalls, or under macro-task
     //  Ast*::user3()			// TraceActivityVertex* for this node
     AstUser1InUse	m_inuser1;
     AstUser2InUse	m_inuser2;
@@ -184,10 +318,22 @@ private:
     TraceActivityVertex* m_alwaysVtxp;	// "Always trace" vertex
     bool		m_finding;	// Pass one of algorithm?
     int			m_funcNum;	// Function number being built
+    TraceActivityVertex* m_groupVtxp;	// Activity of statement group adding to graph, or NULL
+    map<AstCFunc*,pair<uint32_t,uint32_t> > m_initCodes;  // Codes assigned in each declaration function
+
+    // Activity groups cost a bit set when the group runs, and in the change
+    // function a test per distinct set of bits; so only big functions are
+    // split, into groups writing a minimum number of traced variables.
+    enum { GROUP_MIN_WRITES = 16 };	// Minimum traced writes per statement group
+    enum { GROUP_MAX_GROUPS = 32 };	// Maximum groups per function
 
     V3Double0		m_statChgSigs;	// Statistic tracking
     V3Double0		m_statUniqSigs;	// Statistic tracking
     V3Double0		m_statUniqCodes;// Statistic tracking
+    V3Double0		m_statGroupFuncs;// Statistic tracking
+    V3Double0		m_statGroups;	// Statistic tracking
+    V3Double0		m_statAliases;	// Statistic tracking
+    V3Double0		m_statInstShared;// Statistic tracking
 
     // METHODS
     static int debug() {
@@ -196,6 +342,23 @@ private:
 	return level;
     }
 
+    void replaceAliases(const TraceAliasVisitor& aliases) {
+	// Trace each alias with its source's value, so detectDuplicates finds them
+	for (V3GraphVertex* itp = m_graph.verticesBeginp(); itp; itp=itp->verticesNextp()) {
+	    if (TraceTraceVertex* vvertexp = dynamic_cast<TraceTraceVertex*>(itp)) {
+		AstTraceInc* nodep = vvertexp->nodep();
+		AstVarRef* refp = nodep->valuep() ? nodep->valuep()->castVarRef() : NULL;
+		if (!refp || !refp->varScopep()) continue;
+		AstVarScope* rootp = aliases.rootp(refp->varScopep());
+		if (rootp == refp->varScopep()) continue;
+		UINFO(8,"  Alias "<<refp->varScopep()<<" of "<<rootp<<endl);
+		refp->replaceWith(new AstVarRef(refp->fileline(), rootp, false));
+		pushDeletep(refp); VL_DANGLING(refp);
+		++m_statAliases;
+	    }
+	}
+    }
+
     void detectDuplicates() {
 	UINFO(9,"Finding duplicates\n");
 	// Note uses user4
@@ -488,6 +651,92 @@ private:
 	return nodep->code();
     }
 
+    void assignInitCodes() {
+	// Assign codes in declaration order, so each instance's signals have
+	// a range of codes, laid out alike in identical instances
+	map<AstTraceDecl*,TraceTraceVertex*> declVertexps;
+	for (V3GraphVertex* itp = m_graph.verticesBeginp(); itp; itp=itp->verticesNextp()) {
+	    if (TraceTraceVertex* vvertexp = dynamic_cast<TraceTraceVertex*>(itp)) {
+		declVertexps[vvertexp->nodep()->declp()] = vvertexp;
+	    }
+	}
+	for (AstNode* stmtp = m_initFuncp->stmtsp(); stmtp; stmtp=stmtp->nextp()) {
+	    AstCCall* callp = stmtp->castCCall();
+	    if (!callp) continue;
+	    uint32_t firstCode = m_code;
+	    for (AstNode* declStmtp = callp->funcp()->stmtsp(); declStmtp; declStmtp=declStmtp->nextp()) {
+		AstTraceDecl* declp = declStmtp->castTraceDecl();
+		if (!declp) continue;
+		map<AstTraceDecl*,TraceTraceVertex*>::iterator it = declVertexps.find(declp);
+		if (it == declVertexps.end()) continue;
+		if (TraceTraceVertex* dupvertexp = it->second->duplicatep()) {
+		    declp->code(assignDeclCode(dupvertexp->nodep()->declp()));
+		} else {
+		    assignDeclCode(declp);
+		}
+	    }
+	    m_initCodes[callp->funcp()] = make_pair(firstCode, m_code);
+	}
+    }
+
+    void shareInitFuncs() {
+	// Once codes are final, an instance's declaration function is
+	// the same as an earlier instance's at an offset; call that instead
+	map<string,AstCFunc*> sigFuncps;  // First function with each layout
+	for (AstNode* nextp, *stmtp = m_initFuncp->stmtsp(); stmtp; stmtp=nextp) {
+	    nextp = stmtp->nextp();
+	    AstCCall* callp = stmtp->castCCall();
+	    if (!callp || m_initCodes.find(callp->funcp()) == m_initCodes.end()) continue;
+	    AstCFunc* funcp = callp->funcp();
+	    uint32_t firstCode = m_initCodes[funcp].first;
+	    uint32_t endCode = m_initCodes[funcp].second;
+	    // Signals sharing a code of another instance stay with the caller,
+	    // and the rest form the layout, relative to the first code
+	    string sig;
+	    for (AstNode* nextDeclp, *declStmtp = funcp->stmtsp(); declStmtp; declStmtp=nextDeclp) {
+		nextDeclp = declStmtp->nextp();
+		if (AstTraceDecl* declp = declStmtp->castTraceDecl()) {
+		    if (declp->code() < firstCode || declp->code() >= endCode) {
+			callp->addHereThisAsNext(declp->unlinkFrBack());
+			continue;
+		    }
+		    sig += (declp->isWide() ? "W" : declp->isQuad() ? "Q"
+			    : declp->dtypep()->basicp()->isDouble() ? "D" : "I");
+		    sig += cvtToStr(declp->code() - firstCode)+" "+cvtToStr(declp->widthMin());
+		    if (declp->bitRange().ranged()) {
+			sig += "["+cvtToStr(declp->bitRange().left())+":"+cvtToStr(declp->bitRange().right())+"]";
+		    }
+		    if (declp->arrayRange().ranged()) {
+			sig += "("+cvtToStr(declp->arrayRange().left())+":"+cvtToStr(declp->arrayRange().right())+")";
+		    }
+		}
+		sig += " "+declStmtp->name()+"\n";
+	    }
+	    if (sig == "") continue;
+	    map<string,AstCFunc*>::iterator it = sigFuncps.find(sig);
+	    if (it == sigFuncps.end()) {
+		sigFuncps.insert(make_pair(sig, funcp));
+		continue;
+	    }
+	    AstCFunc* sharedp = it->second;
+	    UINFO(8,"  Share "<<sharedp<<" for "<<funcp<<endl);
+	    AstCCall* newp = new AstCCall(callp, sharedp);
+	    newp->argTypes("vlSymsp, vcdp, code+"+cvtToStr(firstCode - m_initCodes[sharedp].first));
+	    callp->replaceWith(newp);
+	    pushDeletep(callp); VL_DANGLING(callp);
+	    // The declarations remain, unemitted, for the traces of their values
+	    for (AstNode* nextDeclp, *declStmtp = funcp->stmtsp(); declStmtp; declStmtp=nextDeclp) {
+		nextDeclp = declStmtp->nextp();
+		if (AstTraceDecl* declp = declStmtp->castTraceDecl()) {
+		    declp->instShared(true);
+		    newp->addNextHere(declp->unlinkFrBack());
+		}
+	    }
+	    funcp->unlinkFrBack(); pushDeletep(funcp); VL_DANGLING(funcp);
+	    ++m_statInstShared;
+	}
+    }
+
     AstNode* assignTraceCode(TraceTraceVertex* vvertexp, AstTraceInc* nodep, bool needChg) {
 	// Assign trace code, add to tree, return node for change tree or null
 	// Look for identical copies
@@ -555,6 +804,70 @@ private:
 	vertexp->slow(slow);
 	return vertexp;
     }
+    void mtaskCalls(AstNode* nodep, TraceActivityVertex* activityVtxp) {
+	// Calls made by a macro-task run concurrently with other macro-tasks,
+	// so instead of each setting activity, the macro-task group sets it once
+	for (; nodep; nodep=nodep->nextp()) {
+	    if (AstCCall* ccallp = nodep->castCCall()) {
+		if (!ccallp->user2()) {
+		    ccallp->user2(true); // Processed
+		    UINFO(8,"     MTaskCCALL "<<ccallp<<endl);
+		    new V3GraphEdge (&m_graph, activityVtxp, getCFuncVertexp(ccallp->funcp()), 1);
+		    mtaskCalls(ccallp->funcp()->stmtsp(), activityVtxp);
+		}
+	    }
+	    mtaskCalls(nodep->op1p(), activityVtxp);
+	    mtaskCalls(nodep->op2p(), activityVtxp);
+	    mtaskCalls(nodep->op3p(), activityVtxp);
+	    mtaskCalls(nodep->op4p(), activityVtxp);
+	}
+    }
+    void mtaskActivity(AstNetlist* nodep) {
+	TraceMTaskFindVisitor findVisitor (nodep);
+	for (vector<AstExecMTasks*>::const_iterator it = findVisitor.execps().begin();
+	     it != findVisitor.execps().end(); ++it) {
+	    AstExecMTasks* execp = *it;
+	    TraceActivityVertex* activityVtxp = getActivityVertexp(execp, execp->callsp()->funcp()->slow());
+	    mtaskCalls(execp->callsp(), activityVtxp);
+	}
+    }
+
+    bool groupStmts(AstCFunc* nodep) {
+	// Add vertexes for activity of each group of the function's statements,
+	// and edges from them to the VARs they set.  Returns false if not worth it.
+	if (nodep->slow() || nodep->funcType().isTrace()
+	    || nodep->rtnTypeVoid() != "void"  // A return may skip setting the bits
+	    || v3Global.opt.mtasks()  // Threads would race setting the activity bits
+	    || !nodep->stmtsp() || !nodep->stmtsp()->nextp()) return false;
+	vector<AstNode*> stmtps;
+	vector<int> writes;
+	int totalWrites = 0;
+	for (AstNode* stmtp = nodep->stmtsp(); stmtp; stmtp=stmtp->nextp()) {
+	    stmtps.push_back(stmtp);
+	    writes.push_back(TraceWriteCountVisitor(stmtp).writes());
+	    totalWrites += writes.back();
+	}
+	int minWrites = max((int)GROUP_MIN_WRITES, (totalWrites + GROUP_MAX_GROUPS - 1) / GROUP_MAX_GROUPS);
+	if (totalWrites < 2*minWrites) return false;
+	UINFO(8,"   Grouping "<<nodep<<endl);
+	++m_statGroupFuncs;
+	for (size_t first = 0; first < stmtps.size(); ) {
+	    // Group statements until enough writes; a small remainder joins the last group
+	    size_t last = first;
+	    int groupWrites = writes[last];
+	    while (last+1 < stmtps.size() && groupWrites < minWrites) groupWrites += writes[++last];
+	    int restWrites = 0;
+	    for (size_t i = last+1; i < stmtps.size(); ++i) restWrites += writes[i];
+	    if (restWrites < minWrites) last = stmtps.size()-1;
+	    // The activity bit is set after the group's last statement
+	    m_groupVtxp = getActivityVertexp(stmtps[last], false);
+	    ++m_statGroups;
+	    for (size_t i = first; i <= last; ++i) stmtps[i]->accept(*this);
+	    m_groupVtxp = NULL;
+	    first = last+1;
+	}
+	return true;
+    }
 
     // VISITORS
     virtual void visit(AstNetlist* nodep) {
@@ -564,6 +877,9 @@ private:
 	// Make a always vertex
 	m_alwaysVtxp = new TraceActivityVertex(&m_graph, TraceActivityVertex::ACTIVITY_ALWAYS);
 
+	// Add activity for macro-task groups before their calls are seen
+	mtaskActivity(nodep);
+
 	// Add vertexes for all TRACES, and edges from VARs each trace looks at
 	m_finding = false;
 	nodep->iterateChildren(*this);
@@ -574,6 +890,8 @@ private:
 	m_finding = false;
 
 	// Detect and remove duplicate values
+	TraceAliasVisitor aliases (nodep);
+	replaceAliases(aliases);
 	detectDuplicates();
 
 	// Simplify it
@@ -582,8 +900,10 @@ private:
 	if (debug()>=6) m_graph.dumpDotFilePrefixed("trace_opt");
 
 	// Create new TRACEINCs
+	if (v3Global.opt.combineInstances()) assignInitCodes();
 	assignActivity();
 	putTracesIntoTree();
+	if (v3Global.opt.combineInstances()) shareInitFuncs();
     }
     virtual void visit(AstNodeModule* nodep) {
 	if (nodep->isTop()) m_topModp = nodep;
@@ -633,7 +953,13 @@ private:
 	    }
 	}
 	m_funcp = nodep;
-	nodep->iterateChildren(*this);
+	if (m_finding && groupStmts(nodep)) {
+	    nodep->argsp()->iterateAndNext(*this);
+	    nodep->initsp()->iterateAndNext(*this);
+	    nodep->finalsp()->iterateAndNext(*this);
+	} else {
+	    nodep->iterateChildren(*this);
+	}
 	m_funcp = NULL;
     }
     virtual void visit(AstTraceInc* nodep) {
@@ -667,7 +993,8 @@ private:
 	}
 	else if (m_funcp && m_finding && nodep->lvalue()) {
 	    if (!nodep->varScopep()) nodep->v3fatalSrc("No var scope?");
-	    V3GraphVertex* funcVtxp = getCFuncVertexp(m_funcp);
+	    V3GraphVertex* funcVtxp = (m_groupVtxp ? (V3GraphVertex*)m_groupVtxp
+				       : (V3GraphVertex*)getCFuncVertexp(m_funcp));
 	    V3GraphVertex* varVtxp = nodep->varScopep()->user1u().toGraphVertex();
 	    if (varVtxp) { // else we're not tracing this signal
 		new V3GraphEdge(&m_graph, funcVtxp, varVtxp, 1);
@@ -698,12 +1025,17 @@ public:
 	m_chgSubParentp = NULL;
 	m_chgSubStmts = 0;
 	m_funcNum = 0;
+	m_groupVtxp = NULL;
 	nodep->accept(*this);
     }
     virtual ~TraceVisitor() {
 	V3Stats::addStat("Tracing, Unique changing signals", m_statChgSigs);
 	V3Stats::addStat("Tracing, Unique traced signals", m_statUniqSigs);
 	V3Stats::addStat("Tracing, Unique trace codes", m_statUniqCodes);
+	V3Stats::addStat("Tracing, Activity grouped functions", m_statGroupFuncs);
+	V3Stats::addStat("Tracing, Activity statement groups", m_statGroups);
+	V3Stats::addStat("Tracing, Aliased signals", m_statAliases);
+	V3Stats::addStat("Tracing, Instance declarations shared", m_statInstShared);
     }
 };
 
@@ -21,6 +21,9 @@
 //	Create trace CFUNCs
 //	For each VARSCOPE
 //	    If appropriate type of signal, create a TRACE
+//	If --combine-instances
+//	    Declare each instance's signals in a function of its own,
+//	    named relative to the instance, so V3Trace may share them
 //
 //*************************************************************************
 
@@ -29,6 +32,8 @@
 #include <cstdio>
 #include <cstdarg>
 #include <unistd.h>
+#include <map>
+#include <vector>
 
 #include "V3Global.h"
 #include "V3TraceDecl.h"
@@ -49,7 +54,10 @@ private:
     int			m_initSubStmts;	// Number of statements in function
     AstCFunc*		m_fullFuncp;	// Trace function being built
     AstCFunc*		m_chgFuncp;	// Trace function being built
+    AstCFunc*		m_instFuncp;	// Trace function of current signal's instance, or NULL
     int			m_funcNum;	// Function number being built
+    map<string,AstCFunc*> m_instFuncps;	// Trace function of each instance, by hierarchy
+    vector<string>	m_instNames;	// Instance hierarchies, in order found
     AstVarScope*	m_traVscp;	// Signal being trace constructed
     AstNode*		m_traValuep;	// Signal being traced's value to trace in it
     string		m_traShowname;	// Signal being traced's component name
@@ -108,6 +116,31 @@ private:
 	basep->addStmtsp(callp);
 	return funcp;
     }
+    AstCFunc* instFuncp(const string& instName) {
+	// Function declaring the signals of the given instance, called after the others
+	map<string,AstCFunc*>::iterator it = m_instFuncps.find(instName);
+	if (it != m_instFuncps.end()) return it->second;
+	AstCFunc* funcp = newCFunc(AstCFuncType::TRACE_INIT_SUB,
+				   m_initFuncp->name()+"__"+cvtToStr(++m_funcNum), true);
+	m_instFuncps.insert(make_pair(instName, funcp));
+	m_instNames.push_back(instName);
+	return funcp;
+    }
+    void addInstCalls() {
+	// Call each instance's function with the instance as the module name,
+	// so its signals' names are relative and identical instances match
+	FileLine* fl = m_initFuncp->fileline();
+	for (vector<string>::iterator it = m_instNames.begin(); it != m_instNames.end(); ++it) {
+	    m_initFuncp->addStmtsp(new AstCStmt(fl, "vcdp->module(std::string(vlSymsp->name())+\" "
+						+V3Number::quoteNameControls(*it)+"\");\n"));
+	    AstCCall* callp = new AstCCall(fl, m_instFuncps[*it]);
+	    callp->argTypes("vlSymsp, vcdp, code");
+	    m_initFuncp->addStmtsp(callp);
+	}
+	if (!m_instNames.empty()) {
+	    m_initFuncp->addStmtsp(new AstCStmt(fl, "vcdp->module(vlSymsp->name());\n"));
+	}
+    }
     void addTraceDecl(const VNumRange& arrayRange,
 		      int widthOverride) {  // If !=0, is packed struct/array where basicp size misreflects one element
 	VNumRange bitRange;
@@ -118,21 +151,24 @@ private:
 					       bitRange, arrayRange);
 	UINFO(9,"Decl "<<declp<<endl);
 
-	if (m_initSubStmts && v3Global.opt.outputSplitCTrace()
-	    && m_initSubStmts > v3Global.opt.outputSplitCTrace()) {
-	    m_initSubFuncp = newCFuncSub(m_initFuncp);
-	    m_initSubStmts = 0;
+	if (m_instFuncp) {  // Not split, so identical instances' functions stay whole
+	    m_instFuncp->addStmtsp(declp);
+	} else {
+	    if (m_initSubStmts && v3Global.opt.outputSplitCTrace()
+		&& m_initSubStmts > v3Global.opt.outputSplitCTrace()) {
+		m_initSubFuncp = newCFuncSub(m_initFuncp);
+		m_initSubStmts = 0;
+	    }
+	    m_initSubFuncp->addStmtsp(declp);
+	    m_initSubStmts += EmitCBaseCounterVisitor(declp).count();
 	}
 
-	m_initSubFuncp->addStmtsp(declp);
-	m_initSubStmts += EmitCBaseCounterVisitor(declp).count();
-
 	m_chgFuncp->addStmtsp(new AstTraceInc(m_traVscp->fileline(), declp, m_traValuep->cloneTree(true)));
 	// The full version will get constructed in V3Trace
     }
     void addIgnore(const char* why) {
 	++m_statIgnSigs;
-	m_initSubFuncp->addStmtsp(
+	(m_instFuncp ? m_instFuncp : m_initSubFuncp)->addStmtsp(
 	    new AstComment(m_traVscp->fileline(), "Tracing: "+m_traShowname+" // Ignored: "+why));
     }
 
@@ -147,6 +183,7 @@ private:
 	m_initSubFuncp = newCFuncSub(m_initFuncp);
 	// And find variables
 	nodep->iterateChildren(*this);
+	addInstCalls();
     }
     virtual void visit(AstVarScope* nodep) {
 	nodep->iterateChildren(*this);
@@ -161,6 +198,18 @@ private:
 	    m_traShowname = AstNode::vcdName(scopep->name() + " " + varp->name());
 	    if (m_traShowname.substr(0,4) == "TOP ") m_traShowname.replace(0,4,"");
 	    if (!m_initSubFuncp) nodep->v3fatalSrc("NULL");
+	    if (v3Global.opt.combineInstances()) {
+		// Inlined instances' signals are named within the instance too
+		string::size_type pos = varp->name().rfind("__DOT__");
+		string instName = scopep->name();
+		if (pos != string::npos) instName += "."+varp->name().substr(0,pos);
+		instName = AstNode::vcdName(instName);
+		if (instName.substr(0,4) == "TOP ") {
+		    m_instFuncp = instFuncp(instName.substr(4));
+		    m_traShowname = AstNode::vcdName(pos == string::npos ? varp->name()
+						     : varp->name().substr(pos+7));
+		}
+	    }
 
 	    m_traVscp = nodep;
 	    m_traValuep = NULL;
@@ -180,6 +229,7 @@ private:
 	    m_traVscp = NULL;
 	    m_traValuep = NULL;
 	    m_traShowname = "";
+	    m_instFuncp = NULL;
 	}
     }
     // VISITORS - Data types when tracing
@@ -309,6 +359,7 @@ public:
 	m_initSubStmts = 0;
 	m_fullFuncp = NULL;
 	m_chgFuncp = NULL;
+	m_instFuncp = NULL;
 	m_funcNum = 0;
 	m_traVscp = NULL;
 	m_traValuep = NULL;
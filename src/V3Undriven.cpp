@@ -20,7 +20,7 @@
 // V3Undriven's Transformations:
 //
 // Each module:
-//      Make vector for all variables
+//      Make ranges of used and driven bits for all variables
 //	SEL(VARREF(...))) mark only some bits as used/driven
 //	else VARREF(...) mark all bits as used/driven
 //	Report unused/undriven nets
@@ -33,6 +33,7 @@
 #include <cstdarg>
 #include <unistd.h>
 #include <algorithm>
+#include <map>
 #include <vector>
 
 #include "V3Global.h"
@@ -40,17 +41,64 @@
 #include "V3Undriven.h"
 #include "V3Ast.h"
 
+//######################################################################
+// Set of bit numbers, as ranges
+
+class UndrivenRanges {
+    // MEMBERS
+    typedef map<int,int> RangeMap;
+    RangeMap		m_ranges;	// Disjoint, non-adjacent [lsb, msb+1) ranges, by lsb
+public:
+    // METHODS
+    void add(int lsb, int end) {  // Bits [lsb, end)
+	if (lsb >= end) return;
+	// Merge with any range overlapping or touching this one
+	RangeMap::iterator it = m_ranges.upper_bound(lsb);
+	if (it != m_ranges.begin()) {
+	    RangeMap::iterator prevIt = it;  --prevIt;
+	    if (prevIt->second >= lsb) it = prevIt;
+	}
+	while (it != m_ranges.end() && it->first <= end) {
+	    lsb = min(lsb, it->first);
+	    end = max(end, it->second);
+	    m_ranges.erase(it++);
+	}
+	m_ranges.insert(make_pair(lsb, end));
+    }
+    bool contains(int bit) const {
+	RangeMap::const_iterator it = m_ranges.upper_bound(bit);
+	if (it == m_ranges.begin()) return false;
+	--it;
+	return bit < it->second;
+    }
+    void addBounds(vector<int>& boundsr) const {
+	for (RangeMap::const_iterator it = m_ranges.begin(); it != m_ranges.end(); ++it) {
+	    boundsr.push_back(it->first);
+	    boundsr.push_back(it->second);
+	}
+    }
+};
+
 //######################################################################
 // Class for every variable we may process
 
 class UndrivenVarEntry {
+    // TYPES
+    struct Segment {	// Bits with the same used/driven state
+	int	m_lsb;
+	int	m_msb;
+	bool	m_used;
+	bool	m_driven;
+    };
+    typedef vector<Segment> Segments;
+
     // MEMBERS
     AstVar*		m_varp;		// Variable this tracks
     bool		m_usedWhole;	// True if whole vector used
     bool		m_drivenWhole;	// True if whole vector driven
-    vector<bool>	m_flags;	// Used/Driven on each subbit
-
-    enum { FLAG_USED = 0, FLAG_DRIVEN = 1, FLAGS_PER_BIT = 2 };
+    int			m_width;	// Bits in variable
+    UndrivenRanges	m_used;		// Bits used
+    UndrivenRanges	m_driven;	// Bits driven
 
     static int debug() {
 	static int level = -1;
@@ -65,45 +113,64 @@ public:
 	m_varp = varp;
 	m_usedWhole = false;
 	m_drivenWhole = false;
-
-	m_flags.resize(varp->width()*FLAGS_PER_BIT);
-	for (int i=0; i<varp->width()*FLAGS_PER_BIT; i++) {
-	    m_flags[i] = false;
-	}
+	m_width = varp->width();
     }
     ~UndrivenVarEntry() {}
 
 private:
     // METHODS
-    inline bool bitNumOk(int bit) const { return bit>=0 && (bit*FLAGS_PER_BIT < (int)m_flags.size()); }
-    inline bool usedFlag(int bit) const { return m_usedWhole || m_flags[bit*FLAGS_PER_BIT + FLAG_USED]; }
-    inline bool drivenFlag(int bit) const { return m_drivenWhole || m_flags[bit*FLAGS_PER_BIT + FLAG_DRIVEN]; }
+    Segments segments(int bit, int width) const {
+	// Split bits [bit, bit+width) of the variable where their state changes,
+	// so the work is per range of bits, not per bit
+	int lsb = max(bit, 0);
+	int end = min(bit + width, m_width);
+	Segments segs;
+	if (lsb >= end) return segs;
+	vector<int> bounds;
+	bounds.push_back(lsb);
+	bounds.push_back(end);
+	m_used.addBounds(bounds);
+	m_driven.addBounds(bounds);
+	sort(bounds.begin(), bounds.end());
+	for (size_t i=0; i+1<bounds.size(); ++i) {
+	    if (bounds[i] < lsb || bounds[i+1] > end || bounds[i] == bounds[i+1]) continue;
+	    Segment seg;
+	    seg.m_lsb = bounds[i];
+	    seg.m_msb = bounds[i+1] - 1;
+	    seg.m_used = m_usedWhole || m_used.contains(seg.m_lsb);
+	    seg.m_driven = m_drivenWhole || m_driven.contains(seg.m_lsb);
+	    segs.push_back(seg);
+	}
+	return segs;
+    }
     enum BitNamesWhich { BN_UNUSED, BN_UNDRIVEN, BN_BOTH };
     string bitNames(BitNamesWhich which) {
 	string bits="";
-	bool prev = false;
-	int msb = 0;
-	// bit==-1 loops below; we do one extra iteration so end with prev=false
-	for (int bit=(m_flags.size()/FLAGS_PER_BIT)-1; bit >= -1; --bit) {
-	    if (bit>=0
-		&& ((which == BN_UNUSED && !usedFlag(bit) && drivenFlag(bit))
-		    || (which == BN_UNDRIVEN && usedFlag(bit) && !drivenFlag(bit))
-		    || (which == BN_BOTH && !usedFlag(bit) && !drivenFlag(bit)))) {
-		if (!prev) { prev=true; msb = bit; }
-	    } else if (prev) {
-		AstBasicDType* bdtypep = m_varp->basicp();
-		int lsb = bit+1;
-		if (bits != "") bits += ",";
-		if (lsb==msb) {
-		    bits += cvtToStr(lsb+bdtypep->lsb());
+	Segments segs = segments(0, m_width);
+	// Join adjacent matching segments, from the msb down
+	for (Segments::reverse_iterator it = segs.rbegin(); it != segs.rend(); ) {
+	    if (!((which == BN_UNUSED && !it->m_used && it->m_driven)
+		  || (which == BN_UNDRIVEN && it->m_used && !it->m_driven)
+		  || (which == BN_BOTH && !it->m_used && !it->m_driven))) {
+		++it;
+		continue;
+	    }
+	    int msb = it->m_msb;
+	    int lsb = it->m_lsb;
+	    for (++it; it != segs.rend() && it->m_used == (it-1)->m_used
+		     && it->m_driven == (it-1)->m_driven; ++it) {
+		lsb = it->m_lsb;
+	    }
+	    AstBasicDType* bdtypep = m_varp->basicp();
+	    if (bits != "") bits += ",";
+	    if (lsb==msb) {
+		bits += cvtToStr(lsb+bdtypep->lsb());
+	    } else {
+		if (bdtypep->littleEndian()) {
+		    bits += cvtToStr(lsb+bdtypep->lsb())+":"+cvtToStr(msb+bdtypep->lsb());
 		} else {
-		    if (bdtypep->littleEndian()) {
-			bits += cvtToStr(lsb+bdtypep->lsb())+":"+cvtToStr(msb+bdtypep->lsb());
-		    } else {
-			bits += cvtToStr(msb+bdtypep->lsb())+":"+cvtToStr(lsb+bdtypep->lsb());
-		    }
+		    bits += cvtToStr(msb+bdtypep->lsb())+":"+cvtToStr(lsb+bdtypep->lsb());
 		}
-		prev = false;
 	    }
 	}
 	return "["+bits+"]";
@@ -119,30 +186,22 @@ public:
     }
     void usedBit (int bit, int width) {
 	UINFO(9, "set u["<<(bit+width-1)<<":"<<bit<<"] "<<m_varp->name()<<endl);
-	for (int i=0; i<width; i++) {
-	    if (bitNumOk(bit+i)) {
-		m_flags[(bit+i)*FLAGS_PER_BIT + FLAG_USED] = true;
-	    }
-	}
+	m_used.add(max(bit, 0), min(bit + width, m_width));
     }
     void drivenBit (int bit, int width) {
 	UINFO(9, "set d["<<(bit+width-1)<<":"<<bit<<"] "<<m_varp->name()<<endl);
-	for (int i=0; i<width; i++) {
-	    if (bitNumOk(bit+i)) {
-		m_flags[(bit+i)*FLAGS_PER_BIT + FLAG_DRIVEN] = true;
-	    }
-	}
+	m_driven.add(max(bit, 0), min(bit + width, m_width));
     }
     bool isUsedNotDrivenBit (int bit, int width) const {
-	for (int i=0; i<width; i++) {
-	    if (bitNumOk(bit+i)
-		&& (m_usedWhole || m_flags[(bit+i)*FLAGS_PER_BIT + FLAG_USED])
-		&& !(m_drivenWhole || m_flags[(bit+i)*FLAGS_PER_BIT + FLAG_DRIVEN])) return true;
+	if (m_drivenWhole) return false;
+	Segments segs = segments(bit, width);
+	for (Segments::const_iterator it = segs.begin(); it != segs.end(); ++it) {
+	    if (it->m_used && !it->m_driven) return true;
 	}
 	return false;
     }
     bool isUsedNotDrivenAny () const {
-	return isUsedNotDrivenBit(0, m_flags.size()/FLAGS_PER_BIT);
+	return isUsedNotDrivenBit(0, m_width);
     }
     bool unusedMatch(AstVar* nodep) {
 	string regexp = v3Global.opt.unusedRegexp();
@@ -161,9 +220,10 @@ public:
 	    bool anyUnotD=false;
 	    bool anyDnotU=false;
 	    bool anynotDU=false;
-	    for (unsigned bit=0; bit<m_flags.size()/FLAGS_PER_BIT; bit++) {
-		bool used = usedFlag(bit);
-		bool driv = drivenFlag(bit);
+	    Segments segs = segments(0, m_width);
+	    for (Segments::const_iterator it = segs.begin(); it != segs.end(); ++it) {
+		bool used = it->m_used;
+		bool driv = it->m_driven;
 		allU &= used;
 		anyU |= used;
 		allD &= driv;
@@ -58,6 +58,7 @@ private:
 
     // STATE
     AstNodeModule*	m_modp;		// Current module
+    AstInitial*		m_xrandInitp;	// Initial setting this module's Vxrand's
     bool		m_constXCvt;	// Convert X's
     V3Double0		m_statUnkVars;	// Statistic tracking
     AstAssignW*		m_assignwp;	// Current assignment
@@ -150,9 +151,11 @@ private:
     virtual void visit(AstNodeModule* nodep) {
 	UINFO(4," MOD   "<<nodep<<endl);
 	m_modp = nodep;
+	m_xrandInitp = NULL;
 	m_constXCvt = true;
 	nodep->iterateChildren(*this);
 	m_modp = NULL;
+	m_xrandInitp = NULL;
     }
     virtual void visit(AstAssignDly* nodep) {
 	m_assigndlyp = nodep;
@@ -301,27 +304,32 @@ private:
 		nodep->unlinkFrBack(&replaceHandle);
 		AstNodeVarRef* newref1p = new AstVarRef(nodep->fileline(), newvarp, false);
 		replaceHandle.relink(newref1p);	    // Replace const with varref
-		AstInitial* newinitp
-		    = new AstInitial(
+		AstAssign* newassp
+		    = new AstAssign(
 			nodep->fileline(),
-			new AstAssign(
-			    nodep->fileline(),
-			    new AstVarRef(nodep->fileline(), newvarp, true),
-			    new AstOr(nodep->fileline(),
-				      new AstConst(nodep->fileline(),numb1),
-				      new AstAnd(nodep->fileline(),
-						 new AstConst(nodep->fileline(),numbx),
-						 new AstRand(nodep->fileline(),
-							     nodep->dtypep(), true)))));
-		// Add inits in front of other statement.
+			new AstVarRef(nodep->fileline(), newvarp, true),
+			new AstOr(nodep->fileline(),
+				  new AstConst(nodep->fileline(),numb1),
+				  new AstAnd(nodep->fileline(),
+					     new AstConst(nodep->fileline(),numbx),
+					     new AstRand(nodep->fileline(),
+							 nodep->dtypep(), true))));
+		// The value is computed once at initialization; the logic just reads the variable.
+		// All of a module's Xs share one initial, so there's one block to order.
 		// In the future, we should stuff the initp into the module's constructor.
 		AstNode* afterp = m_modp->stmtsp()->unlinkFrBackWithNext();
 		m_modp->addStmtp(newvarp);
-		m_modp->addStmtp(newinitp);
+		if (!m_xrandInitp) {
+		    // Add inits in front of other statement.
+		    m_xrandInitp = new AstInitial(nodep->fileline(), newassp);
+		    m_modp->addStmtp(m_xrandInitp);
+		} else {
+		    m_xrandInitp->bodysp()->addNext(newassp);
+		}
 		m_modp->addStmtp(afterp);
 		if (debug()>=9) newref1p->dumpTree(cout,"     _new: ");
 		if (debug()>=9) newvarp->dumpTree(cout,"     _new: ");
-		if (debug()>=9) newinitp->dumpTree(cout,"     _new: ");
+		if (debug()>=9) newassp->dumpTree(cout,"     _new: ");
 		nodep->deleteTree(); VL_DANGLING(nodep);
 	    }
 	}
@@ -461,6 +469,7 @@ public:
     // CONSTUCTORS
     explicit UnknownVisitor(AstNetlist* nodep) {
 	m_modp = NULL;
+	m_xrandInitp = NULL;
 	m_assigndlyp = NULL;
 	m_assignwp = NULL;
 	m_constXCvt = false;
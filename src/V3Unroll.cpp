@@ -42,6 +42,9 @@
 #include "V3Ast.h"
 #include "V3Simulate.h"
 
+// CONFIG
+static const int UNROLL_KEEP_MAX = 65536;	// Most iterations counted for --unroll-keep
+
 //######################################################################
 // Unroll state, as a visitor of each AstNode
 
@@ -59,6 +62,7 @@ private:
     string		m_beginName;		// What name to give begin iterations
     V3Double0		m_statLoops;		// Statistic tracking
     V3Double0		m_statIters;		// Statistic tracking
+    V3Double0		m_statKept;		// Statistic tracking
 
     // METHODS
     static int debug() {
@@ -161,9 +165,25 @@ private:
 	    if (!canSimulate(condp)) return cantUnroll(condp, "Unable to simulate condition");
 
 	    // Check whether to we actually want to try and unroll.
+	    // With --unroll-keep count further, to find loops to keep as counted loops
 	    int loops;
-	    if (!countLoops(initAssp, condp, incp, unrollCount(), loops))
+	    int keep = v3Global.opt.unrollKeep();
+	    int maxLoops = (keep > 0) ? max(unrollCount(), UNROLL_KEEP_MAX) : unrollCount();
+	    if (!countLoops(initAssp, condp, incp, maxLoops, loops))
 		return cantUnroll(nodep, "Unable to simulate loop");
+	    if (keep > 0 && loops >= keep) {
+		if (AstWhile* whilep = nodep->castWhile()) {
+		    if (!precondsp) {
+			// The condition depends only on the loop variable, which only the increment
+			// changes, so the condition is true for exactly this many iterations
+			UINFO(4,"   Keep loop, "<<loops<<" iterations: "<<nodep<<endl);
+			whilep->loops(loops);
+			++m_statKept;
+			return false;
+		    }
+		}
+	    }
+	    if (loops > unrollCount()) return cantUnroll(nodep, "Unable to simulate loop");
 
 	    // Less than 10 statements in the body?
 	    int bodySize = 0;
@@ -469,6 +489,7 @@ public:
     virtual ~UnrollVisitor() {
 	V3Stats::addStatSum("Optimizations, Unrolled Loops", m_statLoops);
 	V3Stats::addStatSum("Optimizations, Unrolled Iterations", m_statIters);
+	V3Stats::addStatSum("Optimizations, Loops kept counted", m_statKept);
     }
 };
 
@@ -155,12 +155,14 @@ ostream& operator<<(ostream& str, const WidthVP* vup) {
 class WidthClearVisitor {
     // Rather than a AstNVisitor, can just quickly touch every node
     void clearWidthRecurse(AstNode* nodep) {
-	nodep->didWidth(false);
-	if (nodep->op1p()) clearWidthRecurse(nodep->op1p());
-	if (nodep->op2p()) clearWidthRecurse(nodep->op2p());
-	if (nodep->op3p()) clearWidthRecurse(nodep->op3p());
-	if (nodep->op4p()) clearWidthRecurse(nodep->op4p());
-	if (nodep->nextp()) clearWidthRecurse(nodep->nextp());
+	// Loop over the list, so long statement lists don't recurse deeply
+	for (; nodep; nodep=nodep->nextp()) {
+	    nodep->didWidth(false);
+	    if (nodep->op1p()) clearWidthRecurse(nodep->op1p());
+	    if (nodep->op2p()) clearWidthRecurse(nodep->op2p());
+	    if (nodep->op3p()) clearWidthRecurse(nodep->op3p());
+	    if (nodep->op4p()) clearWidthRecurse(nodep->op4p());
+	}
     }
 public:
     // CONSTUCTORS
@@ -3662,8 +3664,7 @@ void V3Width::width(AstNetlist* nodep) {
     WidthClearVisitor cvisitor (nodep);
     WidthVisitor visitor (false, false);
     (void)visitor.mainAcceptEdit(nodep);
-    WidthRemoveVisitor rvisitor;
-    (void)rvisitor.mainAcceptEdit(nodep);
+    // $signed/$unsigned are removed by widthCommit
     V3Global::dumpCheckGlobalTree("width.tree", 0, v3Global.opt.dumpTreeLevel(__FILE__) >= 3);
 }
 
@@ -3674,7 +3675,7 @@ AstNode* V3Width::widthParamsEdit (AstNode* nodep) {
     // We should do it in bottom-up module order, but it works in any order.
     WidthVisitor visitor (true, false);
     nodep = visitor.mainAcceptEdit(nodep);
-    // No WidthRemoveVisitor, as don't want to drop $signed etc inside gen blocks
+    // No removal of $signed etc, as don't want to drop them inside gen blocks
     return nodep;
 }
 
@@ -3693,7 +3694,7 @@ AstNode* V3Width::widthGenerateParamsEdit(
     // We should do it in bottom-up module order, but it works in any order.
     WidthVisitor visitor (true, true);
     nodep = visitor.mainAcceptEdit(nodep);
-    // No WidthRemoveVisitor, as don't want to drop $signed etc inside gen blocks
+    // No removal of $signed etc, as don't want to drop them inside gen blocks
     return nodep;
 }
 
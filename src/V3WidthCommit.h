@@ -31,39 +31,11 @@
 
 //######################################################################
 
-/// Remove all $signed, $unsigned, we're done with them.
-/// This step is only called on real V3Width, not intermediate e.g. widthParams
-
-class WidthRemoveVisitor : public AstNVisitor {
-private:
-    // VISITORS
-    virtual void visit(AstSigned* nodep) {
-	replaceWithSignedVersion(nodep, nodep->lhsp()->unlinkFrBack()); VL_DANGLING(nodep);
-    }
-    virtual void visit(AstUnsigned* nodep) {
-	replaceWithSignedVersion(nodep, nodep->lhsp()->unlinkFrBack()); VL_DANGLING(nodep);
-    }
-    virtual void visit(AstNode* nodep) {
-	nodep->iterateChildren(*this);
-    }
-    void replaceWithSignedVersion(AstNode* nodep, AstNode* newp) {
-	UINFO(6," Replace "<<nodep<<" w/ "<<newp<<endl);
-	nodep->replaceWith(newp);
-	newp->dtypeFrom(nodep);
-	pushDeletep(nodep); VL_DANGLING(nodep);
-    }
-public:
-    // CONSTRUCTORS
-    WidthRemoveVisitor() {}
-    virtual ~WidthRemoveVisitor() {}
-    AstNode* mainAcceptEdit(AstNode* nodep) {
-	return nodep->iterateSubtreeReturnEdits(*this);
-    }
-};
-
 //######################################################################
 // Now that all widthing is complete,
 // Copy all width() to widthMin().  V3Const expects this
+// Also remove all $signed, $unsigned, we're done with them; done in this
+// walk rather than its own, as both touch every node.
 
 class WidthCommitVisitor : public AstNVisitor {
     // NODE STATE
@@ -111,7 +83,20 @@ private:
 	}
 	return nodep;
     }
+    void replaceWithSignedVersion(AstNode* nodep, AstNode* newp) {
+	UINFO(6," Replace "<<nodep<<" w/ "<<newp<<endl);
+	nodep->replaceWith(newp);
+	newp->dtypeFrom(nodep);
+	pushDeletep(nodep); VL_DANGLING(nodep);
+	// The iterator visits newp next, committing its dtype
+    }
     // VISITORS
+    virtual void visit(AstSigned* nodep) {
+	replaceWithSignedVersion(nodep, nodep->lhsp()->unlinkFrBack()); VL_DANGLING(nodep);
+    }
+    virtual void visit(AstUnsigned* nodep) {
+	replaceWithSignedVersion(nodep, nodep->lhsp()->unlinkFrBack()); VL_DANGLING(nodep);
+    }
     virtual void visit(AstConst* nodep) {
 	if (!nodep->dtypep()) nodep->v3fatalSrc("No dtype");
 	nodep->dtypep()->accept(*this);  // Do datatype first
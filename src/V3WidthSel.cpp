@@ -183,11 +183,9 @@ private:
 	} else {
 	    // Need a slice data type, which is an array of the extracted type, but with (presumably) different size
 	    VNumRange newRange (msb, lsb, nodep->declRange().littleEndian());
-	    AstNodeDType* vardtypep = new AstPackArrayDType(nodep->fileline(),
-							    nodep->subDTypep(), // Need to strip off array reference
-							    new AstRange(nodep->fileline(), newRange));
-	    v3Global.rootp()->typeTablep()->addTypesp(vardtypep);
-	    return vardtypep;
+	    return v3Global.rootp()->typeTablep()->findPackArrayDType(nodep->fileline(),
+								     nodep->subDTypep(), // Need to strip off array reference
+								     newRange);
 	}
     }
 
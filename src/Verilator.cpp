@@ -36,9 +36,11 @@
 #include "V3ClkGater.h"
 #include "V3Clock.h"
 #include "V3Combine.h"
+#include "V3Config.h"
 #include "V3Const.h"
 #include "V3Coverage.h"
 #include "V3CoverageJoin.h"
+#include "V3Cse.h"
 #include "V3CCtors.h"
 #include "V3Dead.h"
 #include "V3Delayed.h"
@@ -57,6 +59,7 @@
 #include "V3Graph.h"
 #include "V3Inline.h"
 #include "V3Inst.h"
+#include "V3Lane.h"
 #include "V3Life.h"
 #include "V3LifePost.h"
 #include "V3LinkCells.h"
@@ -76,9 +79,11 @@
 #include "V3PreShell.h"
 #include "V3Premit.h"
 #include "V3Scope.h"
+#include "V3SeqGate.h"
 #include "V3Slice.h"
 #include "V3Split.h"
 #include "V3SplitAs.h"
+#include "V3SplitVar.h"
 #include "V3Stats.h"
 #include "V3String.h"
 #include "V3Subst.h"
@@ -118,6 +123,17 @@ void V3Global::readFiles() {
     V3ParseSym parseSyms (v3Global.rootp());  // Symbol table must be common across all parsing
 
     V3Parse parser (v3Global.rootp(), &filter, &parseSyms);
+    // Read files from the command line in the background, in the order parsed below
+    for (V3StringList::const_iterator it = v3Global.opt.vFiles().begin();
+	 it != v3Global.opt.vFiles().end(); ++it) {
+	filter.readAhead(*it);
+    }
+    for (V3StringSet::const_iterator it = v3Global.opt.libraryFiles().begin();
+	 it != v3Global.opt.libraryFiles().end(); ++it) {
+	filter.readAhead(*it);
+    }
+    filter.readAheadStart();
+
     // Read top module
     const V3StringList& vFiles = v3Global.opt.vFiles();
     for (V3StringList::const_iterator it = vFiles.begin(); it != vFiles.end(); ++it) {
@@ -137,14 +153,19 @@ void V3Global::readFiles() {
     }
     //v3Global.rootp()->dumpTreeFile(v3Global.debugFilename("parse.tree"));
     V3Error::abortIfErrors();
+    V3Stats::statsPass("parse");
 
     if (!v3Global.opt.preprocOnly()) {
 	// Resolve all modules cells refer to
 	V3LinkCells::link(v3Global.rootp(), &filter, &parseSyms);
+	V3Stats::statsPass("linkcells");
     }
 }
 
 void V3Global::dumpCheckGlobalTree(const string& filename, int newNumber, bool doDump) {
+    // Called at the end of each pass, so also the place to time them
+    string::size_type pos = filename.rfind(".tree");
+    V3Stats::statsPass(pos == string::npos ? filename : filename.substr(0, pos));
     v3Global.rootp()->dumpTreeFile(v3Global.debugFilename(filename, newNumber), false, doDump);
 }
 
@@ -160,6 +181,7 @@ void process () {
     // Cross-link signal names
     // Cross-link dotted hierarchical references
     V3LinkDot::linkDotPrimary(v3Global.rootp());
+    V3Stats::statsPass("linkdot");
     v3Global.checkTree();  // Force a check, as link is most likely place for problems
     // Check if all parameters have been found
     v3Global.opt.checkParameters();
@@ -169,6 +191,8 @@ void process () {
     V3LinkLValue::linkLValue(v3Global.rootp());
     // Convert return/continue/disable to jumps
     V3LinkJump::linkJump(v3Global.rootp());
+    // Add watch points from configuration files
+    V3Config::applyWatches(v3Global.rootp());
     V3Error::abortIfErrors();
 
     if (v3Global.opt.stats()) V3Stats::statsStageAll(v3Global.rootp(), "Link");
@@ -177,6 +201,7 @@ void process () {
     //   This requires some width calculations and constant propagation
     V3Param::param(v3Global.rootp());
     V3LinkDot::linkDotParamed(v3Global.rootp());	// Cleanup as made new modules
+    V3Stats::statsPass("linkdotparamed");
     V3Error::abortIfErrors();
 
     // Remove any modules that were parameterized and are no longer referenced.
@@ -206,6 +231,7 @@ void process () {
     // Signal based lint checks, no change to structures
     // Must be before first constification pass drops dead code
     V3Undriven::undrivenAll(v3Global.rootp());
+    V3Stats::statsPass("undriven");
 
     // Assertion insertion
     //    After we've added block coverage, but before other nasty transforms
@@ -308,13 +334,13 @@ void process () {
 	// Push constants across variables and remove redundant assignments
 	V3Const::constifyAll(v3Global.rootp());
 
-	if (v3Global.opt.oLife()) {
+	if (!v3Global.opt.lintOnly() && v3Global.opt.oLife()) {
 	    V3Life::lifeAll(v3Global.rootp());
 	}
 
 	// Make large low-fanin logic blocks into lookup tables
 	// This should probably be done much later, once we have common logic elimination.
-	if (!v3Global.opt.lintOnly() && v3Global.opt.oTable()) {
+	if (!v3Global.opt.lintOnly() && v3Global.opt.oTable() && !v3Global.opt.lanes()) {
 	    V3Table::tableAll(v3Global.rootp());
 	}
 
@@ -340,7 +366,7 @@ void process () {
 	V3SplitAs::splitAsAll(v3Global.rootp());
 
 	// Create tracing sample points, before we start eliminating signals
-	if (v3Global.opt.trace()) {
+	if (!v3Global.opt.lintOnly() && v3Global.opt.trace()) {
 	    V3TraceDecl::traceDeclAll(v3Global.rootp());
 	}
 
@@ -354,7 +380,7 @@ void process () {
 	}
 
 	// Combine COVERINCs with duplicate terms
-	if (v3Global.opt.coverage()) {
+	if (!v3Global.opt.lintOnly() && v3Global.opt.coverage()) {
 	    V3CoverageJoin::coverageJoin(v3Global.rootp());
 	}
 
@@ -369,15 +395,32 @@ void process () {
 	    return;
 	}
 
+	// Split vectors and arrays whose bits form false combinational loops
+	if (v3Global.opt.splitLoopVars()) {
+	    V3SplitVar::splitVarAll(v3Global.rootp());
+	}
+
 	// Reorder assignments in pipelined blocks
-	if (v3Global.opt.oReorder()) {
+	if (!v3Global.opt.lintOnly() && v3Global.opt.oReorder()) {
 	    V3Split::splitReorderAll(v3Global.rootp());
 	}
 
+	// Skip sequential blocks whose inputs haven't changed
+	// Before V3Delayed, so each block's nonblocking assignments move under its check
+	if (!v3Global.opt.lintOnly() && v3Global.opt.seqGate()) {
+	    V3SeqGate::seqGateAll(v3Global.rootp());
+	}
+
 	// Create delayed assignments
 	// This creates lots of duplicate ACTIVES so ActiveTop needs to be after this step
 	V3Delayed::delayedAll(v3Global.rootp());
 
+	// Widen 1-bit logic to simulate many stimuli at once
+	// After V3Delayed, so masked nonblocking assignments blend with the __Vdly shadow
+	if (v3Global.opt.lanes()) {
+	    V3Lane::laneAll(v3Global.rootp());
+	}
+
 	// Make Active's on the top level
 	// Differs from V3Active, because identical clocks may be pushed down to a module and now be identical
 	V3ActiveTop::activeTopAll(v3Global.rootp());
@@ -390,16 +433,22 @@ void process () {
 	// Change generated clocks to look at delayed signals
 	V3GenClk::genClkAll(v3Global.rootp());
 
+	// Move same sensitivity actives together, so each sensitivity is tested fewer times
+	if (v3Global.opt.oActiveMerge()) {
+	    V3ActiveTop::mergeAll(v3Global.rootp());
+	}
+
 	// Convert sense lists into IF statements.
 	V3Clock::clockAll(v3Global.rootp());
 
 	// Cleanup any dly vars or other temps that are simple assignments
 	// Life must be done before Subst, as it assumes each CFunc under _eval is called only once.
-	if (v3Global.opt.oLife()) {
+	if (!v3Global.opt.lintOnly() && v3Global.opt.oLife()) {
 	    V3Const::constifyAll(v3Global.rootp());
 	    V3Life::lifeAll(v3Global.rootp());
 	}
-	if (v3Global.opt.oLifePost()) {
+	if (!v3Global.opt.lintOnly() && v3Global.opt.oLifePost()
+	    && !v3Global.opt.mtasks()) {  // Assumes _eval's statements execute serially
 	    V3LifePost::lifepostAll(v3Global.rootp());
 	}
 
@@ -413,10 +462,26 @@ void process () {
 	// Create tracing logic, since we ripped out some signals the user might want to trace
 	// Note past this point, we presume traced variables won't move between CFuncs
 	// (It's OK if untraced temporaries move around, or vars "effectively" activate the same way.)
-	if (v3Global.opt.trace()) {
+	if (!v3Global.opt.lintOnly() && v3Global.opt.trace()) {
 	    V3Trace::traceAll(v3Global.rootp());
 	}
 
+	// Skip combo logic whose inputs can't have changed
+	// After V3Life, as V3Life presumes each CFunc under _eval is always called
+	if (!v3Global.opt.lintOnly() && v3Global.opt.evalSparse()) {
+	    V3Clock::sparseAll(v3Global.rootp());
+	}
+
+	// Copy _eval for each input clock edge, skipping other clocks' blocks
+	// After V3Life, as it presumes each CFunc under _eval is called only once
+	if (!v3Global.opt.lintOnly() && v3Global.opt.evalDomains()) {
+	    V3Clock::domainsAll(v3Global.rootp());
+	}
+	// Check async resets once, ahead of the sensitivity IFs, after the domain copies
+	if (!v3Global.opt.lintOnly() && v3Global.opt.oResetFast()) {
+	    V3Clock::resetsAll(v3Global.rootp());
+	}
+
 	if (v3Global.opt.stats()) V3Stats::statsStageAll(v3Global.rootp(), "Scoped");
 
 	// Remove scopes; make varrefs/funccalls relative to current module
@@ -432,12 +497,12 @@ void process () {
 	}
 
 	// Move BLOCKTEMPS from class to local variables
-	if (v3Global.opt.oLocalize()) {
+	if (!v3Global.opt.lintOnly() && v3Global.opt.oLocalize()) {
 	    V3Localize::localizeAll(v3Global.rootp());
 	}
 
 	// Icache packing; combine common code in each module's functions into subroutines
-	if (v3Global.opt.oCombine()) {
+	if (!v3Global.opt.lintOnly() && v3Global.opt.oCombine()) {
 	    V3Combine::combineAll(v3Global.rootp());
 	}
     }
@@ -463,25 +528,41 @@ void process () {
     }
 
     // Expand macros and wide operators into C++ primitives
-    if (!v3Global.opt.xmlOnly()
+    // Here down, lint only needs the checks in V3EmitC, so skip optimizations
+    if (!v3Global.opt.lintOnly()
+	&& !v3Global.opt.xmlOnly()
 	&& v3Global.opt.oExpand()) {
 	V3Expand::expandAll(v3Global.rootp());
     }
 
     // Propagate constants across WORDSEL arrayed temporaries
-    if (!v3Global.opt.xmlOnly()
+    if (!v3Global.opt.lintOnly()
+	&& !v3Global.opt.xmlOnly()
 	&& v3Global.opt.oSubst()) {
 	// Constant folding of expanded stuff
 	V3Const::constifyCpp(v3Global.rootp());
 	V3Subst::substituteAll(v3Global.rootp());
     }
-    if (!v3Global.opt.xmlOnly()
+    if (!v3Global.opt.lintOnly()
+	&& !v3Global.opt.xmlOnly()
+	&& v3Global.opt.oCse()) {
+	// Compute repeated expressions once per function
+	V3Cse::cseAll(v3Global.rootp());
+    }
+    if (!v3Global.opt.lintOnly()
+	&& !v3Global.opt.xmlOnly()
 	&& v3Global.opt.oSubstConst()) {
 	// Constant folding of substitutions
 	V3Const::constifyCpp(v3Global.rootp());
 
 	V3Dead::deadifyAll(v3Global.rootp());
     }
+    if (!v3Global.opt.lintOnly()
+	&& !v3Global.opt.xmlOnly()
+	&& v3Global.opt.oTempReuse()) {
+	// Share wide temporaries whose lifetimes don't overlap, shrinking stack frames
+	V3Premit::reuseTempsAll(v3Global.rootp());
+    }
 
     if (!v3Global.opt.lintOnly()
 	&& !v3Global.opt.xmlOnly()) {
@@ -491,6 +572,7 @@ void process () {
 
 	// Branch prediction
 	V3Branch::branchAll(v3Global.rootp());
+	V3Stats::statsPass("branch");
 
 	// Add C casts when longs need to become long-long and vice-versa
 	// Note depth may insert something needing a cast, so this must be last.
@@ -501,6 +583,12 @@ void process () {
     if (!v3Global.opt.lintOnly()
 	&& !v3Global.opt.xmlOnly()) {
 	V3CCtors::cctorsAll();
+	V3Stats::statsPass("cctors");
+    }
+
+    // Statistics of the final tree, before V3EmitC frees function bodies as it goes
+    if (v3Global.opt.stats()) {
+	V3Stats::statsFinalAll(v3Global.rootp());
     }
 
     // Output the text
@@ -510,19 +598,21 @@ void process () {
 	V3EmitC::emitcInlines();
 	V3EmitC::emitcSyms();
 	V3EmitC::emitcTrace();
+	V3Stats::statsPass("emitcsyms");
     }
     if (!v3Global.opt.xmlOnly()) { // Unfortunately we have some lint checks in emitc.
 	V3EmitC::emitc();
+	V3Stats::statsPass("emitc");
     }
     if (v3Global.opt.xmlOnly()
 	// Check XML when debugging to make sure no missing node types
 	|| (v3Global.opt.debugCheck() && !v3Global.opt.lintOnly())) {
 	V3EmitXml::emitxml();
+	V3Stats::statsPass("emitxml");
     }
 
     // Statistics
     if (v3Global.opt.stats()) {
-	V3Stats::statsFinalAll(v3Global.rootp());
 	V3Stats::statsReport();
     }
 
@@ -563,6 +653,12 @@ int main(int argc, char** argv, char** env) {
 	&& !v3Global.opt.cdc()) {
 	v3fatal("verilator: Need --cc, --sc, --cdc, --lint-only, --xml_only or --E option");
     }
+    if (v3Global.opt.linkPorts() && v3Global.opt.systemC()) {
+	v3fatal("verilator: --link-ports is not supported with --sc");
+    }
+    if (v3Global.opt.lanes() && (v3Global.opt.systemC() || v3Global.opt.trace())) {
+	v3fatal("verilator: --lanes is not supported with --sc or --trace");
+    }
     // Check environment
     V3Options::getenvSYSTEMC();
     V3Options::getenvSYSTEMC_ARCH();
@@ -591,6 +687,7 @@ int main(int argc, char** argv, char** env) {
 
     // Cleanup
     V3Os::unlinkRegexp(v3Global.opt.makeDir(), v3Global.opt.prefix()+"_*.tree");
+    V3Os::unlinkRegexp(v3Global.opt.makeDir(), v3Global.opt.prefix()+"_*.treeb");
     V3Os::unlinkRegexp(v3Global.opt.makeDir(), v3Global.opt.prefix()+"_*.dot");
     V3Os::unlinkRegexp(v3Global.opt.makeDir(), v3Global.opt.prefix()+"_*.txt");
 
@@ -604,6 +701,7 @@ int main(int argc, char** argv, char** env) {
 
     // Final steps
     V3Global::dumpCheckGlobalTree("final.tree", 990, v3Global.opt.dumpTreeLevel(__FILE__) >= 3);
+    V3File::writeBehindFlush();
     V3Error::abortIfWarnings();
 
     if (!v3Global.opt.lintOnly() && !v3Global.opt.cdc()
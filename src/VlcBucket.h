@@ -24,43 +24,162 @@
 #include "config_build.h"
 #include "verilatedos.h"
 
+#include <algorithm>
+#include <vector>
+
+//********************************************************************
+// VlcBucketChunk - Coverage point hits for 64K consecutive points
+// Holds a sorted array of the low point bits while sparse, and a
+// bitmap once dense, so a test hitting few points stays small.
+
+class VlcBucketChunk {
+public:
+    enum { POINTS = 65536,		///< Points in a chunk
+	   WORDS = POINTS / 64,		///< Words in a bitmap chunk
+	   MAX_ARRAY = POINTS / 16 };	///< Array entries before a bitmap is smaller
+private:
+    // MEMBERS
+    vector<vluint16_t>	m_array;	///< Sorted points, when not m_bits
+    vector<vluint64_t>	m_bits;		///< Bitmap of points, or empty when sparse
+
+    static inline vluint64_t covBit(vluint64_t point) { return 1ULL<<(point & 63); }
+    void toBits() {
+	m_bits.assign(WORDS, 0);
+	for (vector<vluint16_t>::const_iterator it=m_array.begin(); it!=m_array.end(); ++it) {
+	    m_bits[*it/64] |= covBit(*it);
+	}
+	vector<vluint16_t>().swap(m_array);
+    }
+public:
+    // CONSTRUCTORS
+    VlcBucketChunk() {}
+    ~VlcBucketChunk() {}
+
+    // ACCESSORS
+    bool isBits() const { return !m_bits.empty(); }
+
+    // METHODS
+    void add(vluint16_t lo) {
+	if (isBits()) {
+	    m_bits[lo/64] |= covBit(lo);
+	} else {
+	    vector<vluint16_t>::iterator it = lower_bound(m_array.begin(), m_array.end(), lo);
+	    if (it == m_array.end() || *it != lo) {
+		m_array.insert(it, lo);
+		if (m_array.size() > MAX_ARRAY) toBits();
+	    }
+	}
+    }
+    void clear(vluint16_t lo) {
+	if (isBits()) {
+	    m_bits[lo/64] &= ~covBit(lo);
+	} else {
+	    vector<vluint16_t>::iterator it = lower_bound(m_array.begin(), m_array.end(), lo);
+	    if (it != m_array.end() && *it == lo) m_array.erase(it);
+	}
+    }
+    bool exists(vluint16_t lo) const {
+	if (isBits()) {
+	    return (m_bits[lo/64] & covBit(lo)) ? 1:0;
+	} else {
+	    return binary_search(m_array.begin(), m_array.end(), lo);
+	}
+    }
+    template <class Func> void forEach(Func& func, vluint64_t base) const {
+	if (isBits()) {
+	    for (vluint64_t i=0; i<POINTS; i++) {
+		if (m_bits[i/64] & covBit(i)) func(base + i);
+	    }
+	} else {
+	    for (vector<vluint16_t>::const_iterator it=m_array.begin(); it!=m_array.end(); ++it) {
+		func(base + *it);
+	    }
+	}
+    }
+    vluint64_t popCount(vluint64_t (*popCount64)(vluint64_t)) const {
+	if (!isBits()) return m_array.size();
+	vluint64_t pop = 0;
+	for (int w=0; w<WORDS; w++) pop += popCount64(m_bits[w]);
+	return pop;
+    }
+    vluint64_t andPopCount(const VlcBucketChunk& rhs, vluint64_t (*popCount64)(vluint64_t)) const {
+	// Number of points in both this and rhs
+	if (isBits() && rhs.isBits()) {
+	    vluint64_t pop = 0;
+	    for (int w=0; w<WORDS; w++) pop += popCount64(m_bits[w] & rhs.m_bits[w]);
+	    return pop;
+	}
+	const VlcBucketChunk& sparse = isBits() ? rhs : *this;
+	const VlcBucketChunk& other = isBits() ? *this : rhs;
+	vluint64_t pop = 0;
+	for (vector<vluint16_t>::const_iterator it=sparse.m_array.begin(); it!=sparse.m_array.end(); ++it) {
+	    if (other.exists(*it)) ++pop;
+	}
+	return pop;
+    }
+    void andNot(const VlcBucketChunk& rhs) {
+	// Clear any points rhs also has
+	if (isBits() && rhs.isBits()) {
+	    for (int w=0; w<WORDS; w++) m_bits[w] &= ~rhs.m_bits[w];
+	} else if (isBits()) {
+	    for (vector<vluint16_t>::const_iterator it=rhs.m_array.begin(); it!=rhs.m_array.end(); ++it) {
+		m_bits[*it/64] &= ~covBit(*it);
+	    }
+	} else {
+	    vector<vluint16_t> kept;
+	    for (vector<vluint16_t>::const_iterator it=m_array.begin(); it!=m_array.end(); ++it) {
+		if (!rhs.exists(*it)) kept.push_back(*it);
+	    }
+	    m_array.swap(kept);
+	}
+    }
+};
+
 //********************************************************************
 // VlcBuckets - Container of all coverage point hits for a given test
-// This is a bitmap array - we store a single bit to indicate a test
-// has hit that point with sufficient coverage.
+// This is a bitmap - we store a single bit to indicate a test has hit
+// that point with sufficient coverage.  It is split into chunks of 64K
+// points, each only allocated once hit, and compressed while sparse.
 
 class VlcBuckets {
 private:
     // MEMBERS
-    vluint64_t*		m_datap;		///< Pointer to first bucket (dynamically allocated)
-    vluint64_t		m_dataSize;		///< Current entries in m_datap
+    vector<VlcBucketChunk*>	m_chunks;		///< Chunk for each 64K points, or NULL if none hit
     vluint64_t		m_bucketsCovered;	///< Num buckets with sufficient coverage
 
 private:
-    static inline vluint64_t covBit(vluint64_t point) { return 1ULL<<(point & 63); }
-    inline vluint64_t allocSize() const { return sizeof(vluint64_t) * m_dataSize / 64; }
-    void allocate(vluint64_t point) {
-	vluint64_t oldsize = m_dataSize;
-	if (m_dataSize<point) m_dataSize=(point+64) & ~63ULL;  // Keep power of two
-	m_dataSize *= 2;
-	//UINFO(9, "Realloc "<<allocSize()<<" for "<<point<<"  "<<(void*)(m_datap)<<endl);
-	vluint64_t* newp = (vluint64_t*)realloc(m_datap, allocSize());
-	if (!newp) { free(m_datap); v3fatal("Out of memory increasing buckets"); }
-	m_datap = newp;
-	for (vluint64_t i=oldsize; i<m_dataSize; i+=64) m_datap[i/64] = 0;
+    VlcBuckets(const VlcBuckets&);	///< N/A, no copy constructor
+    VlcBuckets& operator=(const VlcBuckets&);	///< N/A, no assignment
+    static vluint64_t popCount64(vluint64_t word) {
+#ifdef __GNUC__
+	return __builtin_popcountll(word);
+#else
+	word = word - ((word >> 1) & VL_ULL(0x5555555555555555));
+	word = (word & VL_ULL(0x3333333333333333)) + ((word >> 2) & VL_ULL(0x3333333333333333));
+	word = (word + (word >> 4)) & VL_ULL(0x0f0f0f0f0f0f0f0f);
+	return (word * VL_ULL(0x0101010101010101)) >> 56;
+#endif
     }
+    static inline vluint64_t chunkNum(vluint64_t point) { return point / VlcBucketChunk::POINTS; }
+    static inline vluint16_t chunkLow(vluint64_t point) { return (vluint16_t)(point % VlcBucketChunk::POINTS); }
+    const VlcBucketChunk* chunkp(vluint64_t point) const {
+	vluint64_t c = chunkNum(point);
+	return (c < m_chunks.size()) ? m_chunks[c] : NULL;
+    }
+    struct DumpFunc {
+	void operator()(vluint64_t point) { cout<<","<<point; }
+    };
 
 public:
     // CONSTRUCTORS
     VlcBuckets() {
-	m_dataSize = 0;
-	m_datap = NULL;
 	m_bucketsCovered = 0;
-	allocate(1024);
     }
     ~VlcBuckets() {
-	m_dataSize = 0;
-	free(m_datap); m_datap=NULL;
+	for (vector<VlcBucketChunk*>::iterator it=m_chunks.begin(); it!=m_chunks.end(); ++it) {
+	    delete *it;
+	}
+	m_chunks.clear();
     }
 
     // ACCESSORS
@@ -70,59 +189,56 @@ public:
     // METHODS
     void addData(vluint64_t point, vluint64_t hits) {
 	if (hits >= sufficient()) {
-	    //UINFO(9,"     addData "<<point<<" "<<hits<<" size="<<m_dataSize<<endl);
-	    if (point >= m_dataSize) allocate(point);
-	    m_datap[point/64] |= covBit(point);
+	    //UINFO(9,"     addData "<<point<<" "<<hits<<endl);
+	    vluint64_t c = chunkNum(point);
+	    if (c >= m_chunks.size()) m_chunks.resize(c+1, NULL);
+	    if (!m_chunks[c]) m_chunks[c] = new VlcBucketChunk;
+	    m_chunks[c]->add(chunkLow(point));
 	    m_bucketsCovered++;
 	}
     }
     void clearHits(vluint64_t point) const {
-	if (point >= m_dataSize) {
-	    return;
-	} else {
-	    m_datap[point/64] &= ~covBit(point);
-	}
+	vluint64_t c = chunkNum(point);
+	if (c < m_chunks.size() && m_chunks[c]) m_chunks[c]->clear(chunkLow(point));
     }
     bool exists(vluint64_t point) const {
-	if (point >= m_dataSize) {
-	    return false;
-	} else {
-	    return (m_datap[point/64] & covBit(point)) ? 1:0;
-	}
+	const VlcBucketChunk* cp = chunkp(point);
+	return cp && cp->exists(chunkLow(point));
     }
     vluint64_t hits(vluint64_t point) const {
-	if (point >= m_dataSize) {
-	    return 0;
-	} else {
-	    return (m_datap[point/64] & covBit(point)) ? 1:0;
-	}
+	return exists(point) ? 1:0;
     }
+    // Below work a chunk of points at a time
     vluint64_t popCount() const {
 	vluint64_t pop = 0;
-	for (vluint64_t i=0; i<m_dataSize; i++) {
-	    if (hits(i)) pop++;
+	for (vector<VlcBucketChunk*>::const_iterator it=m_chunks.begin(); it!=m_chunks.end(); ++it) {
+	    if (*it) pop += (*it)->popCount(popCount64);
 	}
 	return pop;
     }
-    vluint64_t dataPopCount(const VlcBuckets& remaining) {
+    vluint64_t dataPopCount(const VlcBuckets& remaining) const {
 	vluint64_t pop = 0;
-	for (vluint64_t i=0; i<m_dataSize; i++) {
-	    if (hits(i) && remaining.hits(i)) pop++;
+	vluint64_t num = min(m_chunks.size(), remaining.m_chunks.size());
+	for (vluint64_t c=0; c<num; c++) {
+	    if (m_chunks[c] && remaining.m_chunks[c]) {
+		pop += m_chunks[c]->andPopCount(*remaining.m_chunks[c], popCount64);
+	    }
 	}
 	return pop;
     }
     void orData(const VlcBuckets& ordata) {
-	for (vluint64_t i=0; i<m_dataSize; i++) {
-	    if (hits(i) && ordata.hits(i)) {
-		clearHits(i);
-	    }
+	// Clear any hits that ordata also has
+	vluint64_t num = min(m_chunks.size(), ordata.m_chunks.size());
+	for (vluint64_t c=0; c<num; c++) {
+	    if (m_chunks[c] && ordata.m_chunks[c]) m_chunks[c]->andNot(*ordata.m_chunks[c]);
 	}
     }
 
     void dump() const {
 	cout<<"#     ";
-	for (vluint64_t i=0; i<m_dataSize; i++) {
-	    if (hits(i)) cout<<","<<i;
+	DumpFunc func;
+	for (vluint64_t c=0; c<m_chunks.size(); c++) {
+	    if (m_chunks[c]) m_chunks[c]->forEach(func, c * VlcBucketChunk::POINTS);
 	}
 	cout<<endl;
     }
@@ -34,22 +34,22 @@
 class VlcPoint {
 private:
     // MEMBERS
-    string		m_name;		//< Name of the point
+    const string*	m_namep;	//< Name of the point, the key in VlcPoints' map
     vluint64_t		m_pointNum;	//< Point number
     vluint64_t		m_testsCovering;//< Number tests with non-zero coverage of this point
     vluint64_t		m_count;	//< Count of hits across all tests
 
 public:
     // CONSTRUCTORS
-    VlcPoint(const string& name, int pointNum) {
-	m_name = name;
+    VlcPoint(const string* namep, int pointNum) {
+	m_namep = namep;
 	m_pointNum = pointNum;
 	m_testsCovering = 0;
 	m_count = 0;
     }
     ~VlcPoint() {}
     // ACCESSORS
-    const string& name() const { return m_name; }
+    const string& name() const { return *m_namep; }
     vluint64_t pointNum() const { return m_pointNum; }
     vluint64_t testsCovering() const { return m_testsCovering; }
     void countInc(vluint64_t inc) { m_count += inc; }
@@ -66,8 +66,7 @@ public:
     string keyExtract(const char* shortKey) const {
 	// Hot function
 	size_t shortLen = strlen(shortKey);
-	const string namestr = name();
-	for (const char* cp = namestr.c_str(); *cp; ++cp) {
+	for (const char* cp = name().c_str(); *cp; ++cp) {
 	    if (*cp == '\001') {
 		if (0==strncmp(cp+1, shortKey, shortLen)
 		    && cp[shortLen+1] == '\002') {
@@ -129,7 +128,12 @@ public:
     VlcPoint& pointNumber(vluint64_t num) {
 	return m_points[num];
     }
-    vluint64_t findAddPoint(const string& name, vluint64_t count) {
+    vluint64_t findAddPoint(const string& name, vluint64_t count, vluint64_t hint=~VL_ULL(0)) {
+	// Hint is the expected point number, checked before the name lookup
+	if (hint < m_numPoints && m_points[hint].name() == name) {
+	    m_points[hint].countInc(count);
+	    return hint;
+	}
 	vluint64_t pointnum;
 	NameMap::iterator iter = m_nameMap.find(name);
 	if (iter != m_nameMap.end()) {
@@ -138,10 +142,11 @@ public:
 	}
 	else {
 	    pointnum = m_numPoints++;
-	    VlcPoint point (name, pointnum);
+	    // The point refers to the map's key, so each name is stored once
+	    iter = m_nameMap.insert(make_pair(name, pointnum)).first;
+	    VlcPoint point (&iter->first, pointnum);
 	    point.countInc(count);
 	    m_points.push_back(point);
-	    m_nameMap.insert(make_pair(point.name(), point.pointNum()));
 	}
 	return pointnum;
     }
@@ -103,6 +103,23 @@ public:
 	VlcSourceCount& sc = cit->second;
 	sc.incCount(count,ok);
     }
+    vluint64_t pointsHash() const {
+	// Hash of every point's location, count and status; FNV-1a
+	vluint64_t hash = VL_ULL(14695981039346656037);
+	for (LinenoMap::const_iterator lit=m_lines.begin(); lit!=m_lines.end(); ++lit) {
+	    const ColumnMap& cmap = lit->second;
+	    for (ColumnMap::const_iterator cit=cmap.begin(); cit!=cmap.end(); ++cit) {
+		const VlcSourceCount& col = cit->second;
+		vluint64_t vals[4] = { (vluint64_t)col.lineno(), (vluint64_t)col.column(),
+				       col.count(), (vluint64_t)col.ok() };
+		for (int i=0; i<4; ++i) {
+		    hash ^= vals[i];
+		    hash *= VL_ULL(1099511628211);
+		}
+	    }
+	}
+	return hash;
+    }
 };
 
 //********************************************************************
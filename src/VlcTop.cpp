@@ -24,15 +24,17 @@
 #include "VlcTop.h"
 
 #include <sys/stat.h>
+#include <cstring>
 #include <fstream>
 #include <algorithm>
+#include <queue>
 
 //######################################################################
 
 void VlcTop::readCoverage(const string& filename, bool nonfatal) {
     UINFO(2,"readCoverage "<<filename<<endl);
 
-    ifstream is (filename.c_str());
+    ifstream is (filename.c_str(), ios::in | ios::binary);
     if (!is) {
 	if (!nonfatal) v3fatal("Can't read "<<filename);
 	return;
@@ -41,6 +43,20 @@ void VlcTop::readCoverage(const string& filename, bool nonfatal) {
     // Testrun and computrons argument unsupported as yet
     VlcTest* testp = tests().newTest(filename, 0, 0);
 
+    char magic[8];
+    if (is.read(magic, sizeof(magic)) && 0==memcmp(magic, VL_COV_BINARY_MAGIC, sizeof(magic))) {
+	readCoverageBinary(filename, is, testp);
+    } else {
+	is.clear();
+	is.seekg(0);
+	readCoverageText(is, testp);
+    }
+    // Files from one design usually list the same points in the same order
+    m_readOrder.swap(m_readNext);
+    m_readNext.clear();
+}
+
+void VlcTop::readCoverageText(istream& is, VlcTest* testp) {
     while (!is.eof()) {
 	string line;
 	getline(is, line);
@@ -53,15 +69,142 @@ void VlcTop::readCoverage(const string& filename, bool nonfatal) {
 	    string point = line.substr(3,secspace-3);
 	    vluint64_t hits = atoll(line.c_str()+secspace+1);
 	    //UINFO(9,"   point '"<<point<<"'"<<" "<<hits<<endl);
+	    addPoint(testp, point, hits);
+	}
+    }
+}
 
-	    vluint64_t pointnum = points().findAddPoint(point, hits);
-	    if (pointnum) {} // Prevent unused
-	    if (opt.rank()) {  // Only if ranking - uses a lot of memory
-		if (hits >= VlcBuckets::sufficient()) {
-		    points().pointNumber(pointnum).testsCoveringInc();
-		    testp->buckets().addData(pointnum, hits);
-		}
+static vluint32_t vlcReadU32(istream& is) {
+    vluint32_t value = 0;
+    is.read((char*)&value, sizeof(value));
+    return value;
+}
+static vluint32_t vlcReadVarU32(istream& is) {
+    vluint32_t value = 0;
+    for (int shift=0; shift<32; shift+=7) {
+	int c = is.get();
+	if (c == EOF) break;
+	value |= (vluint32_t)(c & 0x7f) << shift;
+	if (!(c & 0x80)) break;
+    }
+    return value;
+}
+
+void VlcTop::readCoverageBinary(const string& filename, istream& is, VlcTest* testp) {
+    // See VL_COV_BINARY_MAGIC for the layout.  Points are named, and their
+    // hierarchies combined, the same as VerilatedCov::write does.
+    if (vlcReadU32(is) != VL_COV_BINARY_ORDER) {
+	v3fatal("Coverage file written with a different byte order: "<<filename);
+	return;
+    }
+    vluint32_t numStrings = vlcReadU32(is);
+    vluint32_t numKeyTables = vlcReadU32(is);
+    vluint32_t numPoints = vlcReadU32(is);
+    vector<string> strings (numStrings);
+    for (vluint32_t i=1; i<numStrings && is; ++i) {
+	vluint32_t len = vlcReadVarU32(is);
+	strings[i].resize(len);
+	if (len) is.read(&strings[i][0], len);
+    }
+    vector<vector<vluint32_t> > keyTables (numKeyTables);
+    for (vluint32_t t=0; t<numKeyTables && is; ++t) {
+	keyTables[t].resize(vlcReadVarU32(is));
+	for (size_t i=0; i<keyTables[t].size(); ++i) {
+	    keyTables[t][i] = vlcReadVarU32(is);
+	    if (keyTables[t][i] >= numStrings) is.setstate(ios::failbit);
+	}
+    }
+    vector<vluint32_t> pointTables (numPoints);
+    vector<size_t> valStarts (numPoints);
+    vector<vluint32_t> vals;
+    for (vluint32_t p=0; p<numPoints && is; ++p) {
+	pointTables[p] = vlcReadVarU32(is);
+	valStarts[p] = vals.size();
+	if (pointTables[p] >= numKeyTables) { is.setstate(ios::failbit); break; }
+	for (size_t i=0; i<keyTables[pointTables[p]].size(); ++i) {
+	    vals.push_back(vlcReadVarU32(is));
+	    if (vals.back() >= numStrings) is.setstate(ios::failbit);
+	}
+    }
+    vector<vluint64_t> counts;
+    counts.reserve(numPoints);
+    while (is && counts.size() < numPoints) {
+	vluint32_t num = vlcReadU32(is);
+	vluint32_t bytes = vlcReadU32(is);
+	if (!is || num > numPoints - counts.size()) break;
+	if (bytes == sizeof(vluint32_t)) {
+	    vector<vluint32_t> run (num);
+	    if (num) is.read((char*)&run[0], num*bytes);
+	    counts.insert(counts.end(), run.begin(), run.end());
+	} else if (bytes == sizeof(vluint64_t)) {
+	    vector<vluint64_t> run (num);
+	    if (num) is.read((char*)&run[0], num*bytes);
+	    counts.insert(counts.end(), run.begin(), run.end());
+	} else {
+	    break;
+	}
+    }
+    if (!is || counts.size() != numPoints) {
+	v3fatal("Corrupt coverage file: "<<filename);
+	return;
+    }
+
+    // Short form of each key, computed once
+    vector<string> shortKeys (numStrings);
+    vector<bool> shortDone (numStrings);
+
+    typedef map<string,pair<string,vluint64_t> > EventMap;
+    EventMap eventCounts;
+    for (vluint32_t p=0; p<numPoints; ++p) {
+	string name;
+	string hier;
+	bool perInstance = false;
+	const vector<vluint32_t>& keys = keyTables[pointTables[p]];
+	for (size_t k=0; k<keys.size(); ++k) {
+	    vluint32_t keyIndex = keys[k];
+	    if (!shortDone[keyIndex]) {
+		shortKeys[keyIndex] = VerilatedCovKey::shortKey(strings[keyIndex]);
+		shortDone[keyIndex] = true;
+	    }
+	    const string& key = shortKeys[keyIndex];
+	    const string& val = strings[vals[valStarts[p]+k]];
+	    if (key == VL_CIK_PER_INSTANCE) {
+		if (val != "0") perInstance = true;
 	    }
+	    if (key == VL_CIK_HIER) {
+		hier = val;
+	    } else {
+		name += VerilatedCovKey::keyValueFormatter(key,val);
+	    }
+	}
+	if (perInstance) {  // Not collapsing hierarchies
+	    name += VerilatedCovKey::keyValueFormatter(VL_CIK_HIER,hier);
+	    hier = "";
+	}
+	EventMap::iterator cit = eventCounts.find(name);
+	if (cit != eventCounts.end()) {
+	    cit->second.second += counts[p];
+	    cit->second.first = VerilatedCovKey::combineHier(cit->second.first, hier);
+	} else {
+	    eventCounts.insert(make_pair(name, make_pair(hier,counts[p])));
+	}
+    }
+    for (EventMap::iterator it=eventCounts.begin(); it!=eventCounts.end(); ++it) {
+	string point = it->first;
+	if (it->second.first != "") point += VerilatedCovKey::keyValueFormatter(VL_CIK_HIER,it->second.first);
+	addPoint(testp, point, it->second.second);
+    }
+}
+
+void VlcTop::addPoint(VlcTest* testp, const string& point, vluint64_t hits) {
+    size_t pos = m_readNext.size();
+    vluint64_t hint = (pos < m_readOrder.size()) ? m_readOrder[pos] : ~VL_ULL(0);
+    vluint64_t pointnum = points().findAddPoint(point, hits, hint);
+    m_readNext.push_back(pointnum);
+    if (opt.rank()) {  // Only if ranking - uses a lot of memory
+	if (hits >= VlcBuckets::sufficient()) {
+	    points().pointNumber(pointnum).testsCoveringInc();
+	    testp->buckets().addData(pointnum, hits);
 	}
     }
 }
@@ -93,6 +236,23 @@ struct CmpComputrons {
     }
 };
 
+struct VlcRankEntry {
+    vluint64_t	m_remain;	///< Points this test would add, as of m_iter
+    vluint64_t	m_iter;		///< Rank iteration m_remain was counted in
+    size_t	m_order;	///< Position by computrons, earlier wins ties
+    VlcTest*	m_testp;
+    VlcRankEntry(vluint64_t remain, vluint64_t iter, size_t order, VlcTest* testp)
+	: m_remain(remain), m_iter(iter), m_order(order), m_testp(testp) {}
+};
+
+struct CmpRankEntry {
+    inline bool operator () (const VlcRankEntry& lhs, const VlcRankEntry& rhs) const {
+	// priority_queue puts the greatest first
+	if (lhs.m_remain != rhs.m_remain) return lhs.m_remain < rhs.m_remain;
+	return lhs.m_order > rhs.m_order;
+    }
+};
+
 void VlcTop::rank() {
     UINFO(2,"rank...\n");
     vluint64_t nextrank=1;
@@ -114,31 +274,31 @@ void VlcTop::rank() {
 	if (pointp->testsCovering()) { remaining.addData(pointp->pointNum(), 1); }
     }
 
-    // Additional Greedy algorithm
-    // O(n^2) Ouch.  Probably the thing to do is randomize the order of data
-    // then hierarchically solve a small subset of tests, and take resulting
-    // solution and move up to larger subset of tests.  (Aka quick sort.)
-    while (1) {
-	if (debug()) { UINFO(9,"Left on iter"<<nextrank<<": "); remaining.dump(); }
-	VlcTest* bestTestp = NULL;
-	vluint64_t bestRemain = 0;
-	for (vector<VlcTest*>::iterator it=bytime.begin(); it!=bytime.end(); ++it) {
-	    VlcTest* testp = *it;
-	    if (!testp->rank()) {
-		vluint64_t remain = testp->buckets().dataPopCount(remaining);
-		if (remain > bestRemain) {
-		    bestTestp = testp;
-		    bestRemain = remain;
-		}
-	    }
-	}
-	if (VlcTest* testp = bestTestp) {
-	    testp->rank(nextrank++);
-	    testp->rankPoints(bestRemain);
-	    remaining.orData(bestTestp->buckets());
-	} else {
-	    break;   // No test covering more stuff found
+    // Additional Greedy algorithm, done lazily.  The points a test would add
+    // only shrink as other tests are selected, so a count from an earlier
+    // iteration is an upper bound, and only the queue's top needs recounting.
+    // Once a recounted test stays on top it is the best, the same one
+    // (including ties, by computrons order) a full rescan would select.
+    priority_queue<VlcRankEntry, vector<VlcRankEntry>, CmpRankEntry> queue;
+    for (size_t i=0; i<bytime.size(); ++i) {
+	VlcTest* testp = bytime[i];
+	vluint64_t remain = testp->buckets().dataPopCount(remaining);
+	if (remain) queue.push(VlcRankEntry(remain, nextrank, i, testp));
+    }
+    if (debug()) { UINFO(9,"Left on iter"<<nextrank<<": "); remaining.dump(); }
+    while (!queue.empty()) {
+	VlcRankEntry entry = queue.top();  queue.pop();
+	if (entry.m_iter != nextrank) {  // Stale, recount and requeue
+	    entry.m_remain = entry.m_testp->buckets().dataPopCount(remaining);
+	    entry.m_iter = nextrank;
+	    if (entry.m_remain) queue.push(entry);  // Else can never help again
+	    continue;
 	}
+	VlcTest* testp = entry.m_testp;
+	testp->rank(nextrank++);
+	testp->rankPoints(entry.m_remain);
+	remaining.orData(testp->buckets());
+	if (debug()) { UINFO(9,"Left on iter"<<nextrank<<": "); remaining.dump(); }
     }
 }
 
@@ -201,6 +361,24 @@ void VlcTop::annotateOutputFiles(const string& dirname) {
 	string filename = source.name();
 	string outfilename = dirname+"/"+V3Os::filenameNonDir(filename);
 
+	// The header records what the output was made from, so a file
+	// whose source and coverage points haven't changed is left alone
+	vluint64_t hash = source.pointsHash();
+	struct stat sstat;
+	if (!stat(filename.c_str(), &sstat)) {
+	    hash ^= ((vluint64_t)sstat.st_mtime << 32) ^ (vluint64_t)sstat.st_size;
+	}
+	ostringstream header;
+	header<<"\t// verilator_coverage annotation, hash "<<hex<<hash;
+	{
+	    ifstream oldis (outfilename.c_str());
+	    string oldline;
+	    if (oldis && getline(oldis, oldline) && oldline == header.str()) {
+		UINFO(1,"annotateOutputFile "<<filename<<" unchanged"<<endl);
+		continue;
+	    }
+	}
+
 	UINFO(1,"annotateOutputFile "<<filename<<" -> "<<outfilename<<endl);
 
 	ifstream is (filename.c_str());
@@ -215,7 +393,7 @@ void VlcTop::annotateOutputFiles(const string& dirname) {
 	    return;
 	}
 
-	os << "\t// verilator_coverage annotation"<<endl;
+	os << header.str()<<"\n";
 
 	int lineno = 0;
 	while (!is.eof()) {
@@ -234,7 +412,7 @@ void VlcTop::annotateOutputFiles(const string& dirname) {
 		    //UINFO(0,"Source "<<source.name()<<" lineno="<<col.lineno()<<" col="<<col.column()<<endl);
 		    os<<(col.ok()?" ":"%")
 		      <<setfill('0')<<setw(6)<<col.count()
-		      <<"\t"<<line<<endl;
+		      <<"\t"<<line<<"\n";
 		    if (first) {
 			first = false;
 			// Multiple columns on same line; print line just once
@@ -248,7 +426,7 @@ void VlcTop::annotateOutputFiles(const string& dirname) {
 	    }
 
 	    if (first) {
-		os<<"\t"<<line<<endl;
+		os<<"\t"<<line<<"\n";
 	    }
 	}
     }
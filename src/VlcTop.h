@@ -40,12 +40,17 @@ private:
     VlcTests	m_tests;	//< List of all tests (all coverage files)
     VlcPoints	m_points;	//< List of all points
     VlcSources	m_sources;	//< List of all source files to annotate
+    vector<vluint64_t>	m_readOrder;	//< Point numbers in order of the last file read
+    vector<vluint64_t>	m_readNext;	//< Point numbers in order of the file being read
 
     // METHODS
     void createDir(const string& dirname);
     void annotateCalc();
     void annotateCalcNeeded();
     void annotateOutputFiles(const string& dirname);
+    void readCoverageText(istream& is, VlcTest* testp);
+    void readCoverageBinary(const string& filename, istream& is, VlcTest* testp);
+    void addPoint(VlcTest* testp, const string& point, vluint64_t hits);
 
 public:
     // CONSTRUCTORS
@@ -251,10 +251,14 @@ class AstSenTree;
 %token<fl>		yVLT_LINT_ON	  "lint_on"
 %token<fl>		yVLT_TRACING_OFF  "tracing_off"
 %token<fl>		yVLT_TRACING_ON   "tracing_on"
+%token<fl>		yVLT_WATCH	  "watch"
 
 %token<fl>		yVLT_D_FILE	"--file"
 %token<fl>		yVLT_D_LINES	"--lines"
+%token<fl>		yVLT_D_MODULE	"--module"
 %token<fl>		yVLT_D_MSG	"--msg"
+%token<fl>		yVLT_D_VALUE	"--value"
+%token<fl>		yVLT_D_VAR	"--var"
 
 %token<strp>		yaD_IGNORE	"${ignored-bbox-sys}"
 %token<strp>		yaD_DPI		"${dpi-sys}"
@@ -510,6 +514,7 @@ class AstSenTree;
 %token<fl>		yVL_NO_INLINE_TASK	"/*verilator no_inline_task*/"
 %token<fl>		yVL_SC_BV		"/*verilator sc_bv*/"
 %token<fl>		yVL_SFORMAT		"/*verilator sformat*/"
+%token<fl>		yVL_SPARSE		"/*verilator sparse*/"
 %token<fl>		yVL_PARALLEL_CASE	"/*verilator parallel_case*/"
 %token<fl>		yVL_PUBLIC		"/*verilator public*/"
 %token<fl>		yVL_PUBLIC_FLAT		"/*verilator public_flat*/"
@@ -1959,6 +1964,7 @@ sigAttr<nodep>:
 	|	yVL_ISOLATE_ASSIGNMENTS			{ $$ = new AstAttrOf($1,AstAttrType::VAR_ISOLATE_ASSIGNMENTS); }
 	|	yVL_SC_BV				{ $$ = new AstAttrOf($1,AstAttrType::VAR_SC_BV); }
 	|	yVL_SFORMAT				{ $$ = new AstAttrOf($1,AstAttrType::VAR_SFORMAT); }
+	|	yVL_SPARSE				{ $$ = new AstAttrOf($1,AstAttrType::VAR_SPARSE); }
 	;
 
 rangeListE<rangep>:		// IEEE: [{packed_dimension}]
@@ -3706,6 +3712,7 @@ vltItem:
 	|	vltOnFront yVLT_D_FILE yaSTRING		{ V3Config::addIgnore($1,true,*$3,0,0); }
 	|	vltOnFront yVLT_D_FILE yaSTRING yVLT_D_LINES yaINTNUM			{ V3Config::addIgnore($1,true,*$3,$5->toUInt(),$5->toUInt()+1); }
 	|	vltOnFront yVLT_D_FILE yaSTRING yVLT_D_LINES yaINTNUM '-' yaINTNUM	{ V3Config::addIgnore($1,true,*$3,$5->toUInt(),$7->toUInt()+1); }
+	|	yVLT_WATCH yVLT_D_MODULE yaSTRING yVLT_D_VAR yaSTRING yVLT_D_VALUE yaINTNUM	{ V3Config::addWatch($1,*$3,*$5,*$7); }
 	;
 
 vltOffFront<errcodeen>:
@@ -18,6 +18,7 @@ use Data::Dumper; $Data::Dumper::Sortkeys=1;
 use strict;
 use vars qw ($Debug %Vars $Driver $Fork);
 use POSIX qw(strftime);
+use Time::HiRes;
 use lib ".";
 
 $::Driver = 1;
@@ -130,6 +131,7 @@ mkdir "obj_dir";
 our $Log_Filename = "obj_dir/driver_".strftime("%Y%m%d_%H%M%S.log", localtime);
 my $LeftCnt=0; my $OkCnt=0; my $FailCnt=0; my $SkipCnt=0; my $UnsupCnt=0;
 my @fails;
+my @Benchmarks;
 
 foreach my $testpl (@opt_tests) {
     one_test(pl_filename => $testpl, atsim=>1) if $opt_atsim;
@@ -142,6 +144,7 @@ foreach my $testpl (@opt_tests) {
 }
 
 $Fork->wait_all();   # Wait for all children to finish
+bench_report(\@Benchmarks, "obj_dir/benchmark.json") if $opt_benchmark;
 
 sub one_test {
     my @params = @_;
@@ -175,6 +178,7 @@ sub one_test {
 	     $test->read_status;
 	     if ($test->ok) {
 		 $OkCnt++;
+		 push @Benchmarks, $test->bench_summary if $test->{bench_results};
 	     } elsif ($test->skips && !$test->errors) {
 		 $SkipCnt++;
 	     } elsif ($test->unsupporteds && !$test->errors) {
@@ -253,6 +257,36 @@ sub calc_jobs {
     return $ok + 1;
 }
 
+sub bench_report {
+    # Write benchmark results as JSON, so runs on different commits can be compared
+    my $benchmarks = shift;
+    my $filename = shift;
+    my $fh = IO::File->new(">$filename") or die "%Error: $! writing $filename,";
+    my $version = VTest::verilator_version();
+    $version =~ s/["\\]//g;
+    $fh->print("{\n");
+    $fh->print("  \"verilator\": \"$version\",\n");
+    $fh->print("  \"date\": \"",strftime("%Y-%m-%dT%H:%M:%S", localtime),"\",\n");
+    $fh->print("  \"cycles\": $opt_benchmark,\n");
+    $fh->print("  \"tests\": [");
+    my $sep = "";
+    foreach my $bench (sort {$a->{name} cmp $b->{name}} @$benchmarks) {
+	$fh->print("$sep\n    {");
+	my $keySep = "";
+	foreach my $key (sort keys %$bench) {
+	    my $value = $bench->{$key};
+	    $value = "\"$value\"" if $value !~ /^[0-9.]+$/;
+	    $fh->print("$keySep\"$key\": $value");
+	    $keySep = ", ";
+	}
+	$fh->print("}");
+	$sep = ",";
+    }
+    $fh->print("\n  ]\n}\n");
+    $fh->close;
+    print "Benchmark results in $filename\n";
+}
+
 sub report {
     my $fails = shift;
     my $filename = shift;
@@ -470,6 +504,17 @@ sub read {
     require $self->{pl_filename};
 }
 
+sub bench_summary {
+    # Return benchmark results of this test, for bench_report
+    my $self = shift;
+    my %summary = (name => $self->{name}, %{$self->{bench_results}});
+    if ($self->{cycles} && $summary{run_seconds}) {
+	$summary{cycles} = $self->{cycles};
+	$summary{cycles_per_second} = sprintf("%.1f", $self->{cycles} / $summary{run_seconds});
+    }
+    return \%summary;
+}
+
 sub write_status {
     my $self = shift;
     my $filename = $self->{status_filename};
@@ -505,6 +550,7 @@ sub compile_vlt_flags {
 			  @{$param{verilator_flags3}});
     $self->{sc} = 1 if ($checkflags =~ /-sc\b/);
     $self->{trace} = 1 if ($opt_trace || $checkflags =~ /-trace\b/);
+    $self->{trace_bin} = 1 if ($checkflags =~ /-trace-bin\b/);
     $self->{savable} = 1 if ($checkflags =~ /-savable\b/);
     $self->{coverage} = 1 if ($checkflags =~ /-coverage\b/);
 
@@ -670,6 +716,7 @@ sub compile {
 	}
 
 	$self->_run(logfile=>"$self->{obj_dir}/vlt_compile.log",
+		    bench_step=>"verilate",
 		    fails=>$param{fails},
 		    expect=>$param{expect},
 		    cmd=>\@cmdargs) if $::Opt_Verilation;
@@ -678,6 +725,7 @@ sub compile {
 	if (!$param{fails} && $param{verilator_make_gcc}) {
 	    $self->oprint("GCC\n");
 	    $self->_run(logfile=>"$self->{obj_dir}/vlt_gcc.log",
+			bench_step=>"build",
 			cmd=>["cd $self->{obj_dir} && ",
 			      "make", "-f".getcwd()."/Makefile_obj",
 			      "VM_PREFIX=$self->{VM_PREFIX}",
@@ -793,6 +841,7 @@ sub execute {
 	) {
 	$param{executable} ||= "$self->{obj_dir}/$param{VM_PREFIX}";
 	$self->_run(logfile=>"$self->{obj_dir}/vlt_sim.log",
+		    bench_step=>"run",
 		    cmd=>[($run_env
 			   .($opt_gdbsim ? ("gdb"||$ENV{VERILATOR_GDB})." " : "")
 			   .$param{executable}
@@ -913,7 +962,17 @@ sub _run {
     my %param = (tee=>1,
 		 @_);
     my $command = join(' ',@{$param{cmd}});
-    $command = "time $command" if $opt_benchmark && $command !~ /^cd /;
+    my $rssFilename;
+    if ($opt_benchmark && $command !~ /^cd /) {
+	if ($param{bench_step} && -x "/usr/bin/time") {
+	    # GNU time also reports peak memory
+	    $rssFilename = "$param{logfile}.rss";
+	    $command = "/usr/bin/time -o $rssFilename -f '%M' $command";
+	} else {
+	    $command = "time $command";
+	}
+    }
+    my $startTime = Time::HiRes::time();
     print "\t$command";
     print "   > $param{logfile}" if $param{logfile};
     print "\n";
@@ -962,6 +1021,17 @@ sub _run {
     flush STDOUT;
     flush STDERR;
 
+    if ($opt_benchmark && $param{bench_step} && !$status) {
+	my $step = $param{bench_step};
+	$self->{bench_results}{"${step}_seconds"} = sprintf("%.3f", Time::HiRes::time() - $startTime);
+	if ($rssFilename && (my $fh = IO::File->new("<$rssFilename"))) {
+	    while (defined(my $line = $fh->getline)) {
+		$self->{bench_results}{"${step}_max_rss_kb"} = $1 if $line =~ /^(\d+)\s*$/;
+	    }
+	    $fh->close;
+	}
+    }
+
     if (!$param{fails} && $status) {
 	$self->error("Exec of $param{cmd}[0] failed\n");
     }
@@ -1043,7 +1113,8 @@ sub _make_main {
     print $fh "// General headers\n";
     print $fh "#include \"verilated.h\"\n";
     print $fh "#include \"systemc.h\"\n" if $self->sc;
-    print $fh "#include \"verilated_vcd_c.h\"\n" if $self->{trace};
+    print $fh "#include \"verilated_vcd_c.h\"\n" if $self->{trace} && !$self->{trace_bin};
+    print $fh "#include \"verilated_bin_c.h\"\n" if $self->{trace_bin};
     print $fh "#include \"verilated_save.h\"\n" if $self->{savable};
 
     print $fh "$VM_PREFIX * topp;\n";
@@ -1104,9 +1175,15 @@ sub _make_main {
 	$fh->print("\n");
 	$fh->print("#if VM_TRACE\n");
 	$fh->print("    Verilated::traceEverOn(true);\n");
-	$fh->print("    VerilatedVcdC* tfp = new VerilatedVcdC;\n");
-	$fh->print("    topp->trace (tfp, 99);\n");
-	$fh->print("    tfp->open (\"$self->{obj_dir}/simx.vcd\");\n");
+	if ($self->{trace_bin}) {
+	    $fh->print("    VerilatedBinC* tfp = new VerilatedBinC;\n");
+	    $fh->print("    topp->trace (tfp, 99);\n");
+	    $fh->print("    tfp->open (\"$self->{obj_dir}/simx.vlt\");\n");
+	} else {
+	    $fh->print("    VerilatedVcdC* tfp = new VerilatedVcdC;\n");
+	    $fh->print("    topp->trace (tfp, 99);\n");
+	    $fh->print("    tfp->open (\"$self->{obj_dir}/simx.vcd\");\n");
+	}
 	if ($self->{trace} && !$self->sc) {
 	    $fh->print("	if (tfp) tfp->dump (main_time);\n");
 	}
@@ -1800,6 +1877,15 @@ Run using ATSIM simulator.
 Show execution times of each step.  If an optional number is given,
 specifies the number of simulation cycles (for tests that support it).
 
+The Verilation, C++ build and simulation time of each passing test, the
+peak memory of Verilation and simulation (when GNU time is installed as
+/usr/bin/time), and for tests that set $Self->{cycles} the simulated cycles
+per second, are written to obj_dir/benchmark.json, so runs on different
+commits can be compared.  The t_bench_* tests are intended for this, for
+example:
+
+    test_regress/driver.pl --benchmark 1000000 test_regress/t/t_bench_*.pl
+
 =item --debug
 
 Same as C<verilator --debug>: Use the debug version of Verilator which
@@ -0,0 +1,31 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+
+   input clk;
+   integer cyc = 0;
+   integer b = 0;
+
+   // With threads, each edge's pre, always and post logic are ordered in
+   // successive ranks, interleaved with the other edge's, so the actives
+   // for one edge are separated by independent ones for the other
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      // One negedge between each posedge
+      if (b != cyc) $stop;
+      if (cyc == 20) begin
+	 $write("*-* All Finished *-*\n");
+	 $finish;
+      end
+   end
+
+   always @ (negedge clk) begin
+      b <= b + 1;
+   end
+endmodule
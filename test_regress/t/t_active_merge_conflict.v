@@ -0,0 +1,29 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+
+   input clk;
+   integer cyc = 0;
+   integer b = 0;
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      if (b != cyc) $stop;
+      if (cyc == 20) begin
+	 $write("*-* All Finished *-*\n");
+	 $finish;
+      end
+   end
+
+   // Reads cyc and writes b, which the posedge block writes and reads, so
+   // the posedge actives can't be moved together past this one
+   always @ (negedge clk) begin
+      b = cyc;
+   end
+endmodule
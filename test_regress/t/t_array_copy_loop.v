@@ -0,0 +1,41 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer cyc=0;
+
+   reg [7:0]  mem_a [0:1023];
+   reg [7:0]  mem_b [0:1023];
+   reg [71:0] wide_a [511:0];
+   reg [71:0] wide_b [511:0];
+
+   integer    i;
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      if (cyc==0) begin
+	 for (i=0; i<1024; i=i+1) mem_b[i] = i[7:0] ^ 8'h5a;
+	 for (i=0; i<512; i=i+1) wide_b[i] = {i[7:0], 64'h0123_4567_89ab_cdef};
+      end
+      else if (cyc==1) begin
+	 mem_a = mem_b;
+	 wide_a = wide_b;
+      end
+      else if (cyc==2) begin
+	 if (mem_a[0] !== 8'h5a) $stop;
+	 if (mem_a[1] !== 8'h5b) $stop;
+	 if (mem_a[1023] !== 8'ha5) $stop;
+	 if (wide_a[0] !== {8'h00, 64'h0123_4567_89ab_cdef}) $stop;
+	 if (wide_a[511] !== {8'hff, 64'h0123_4567_89ab_cdef}) $stop;
+	 $write("*-* All Finished *-*\n");
+	 $finish;
+      end
+   end
+endmodule
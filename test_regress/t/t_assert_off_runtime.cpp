@@ -0,0 +1,31 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+#include <verilated.h>
+#include "Vt_assert_off_runtime.h"
+
+unsigned int main_time = 0;
+
+double sc_time_stamp () {
+    return main_time;
+}
+
+int main (int argc, char *argv[]) {
+    VM_PREFIX* topp = new VM_PREFIX;
+    Verilated::assertOn(false);
+    topp->clk = 0;
+    topp->eval();
+    while (!Verilated::gotFinish() && main_time < 100) {
+	topp->clk = !topp->clk;
+	topp->eval();
+	main_time++;
+    }
+    if (!Verilated::gotFinish()) vl_fatal(__FILE__,__LINE__,"main", "%Error: Timeout; never got a $finish");
+    topp->final();
+    delete topp; topp = NULL;
+    return 0;
+}
@@ -0,0 +1,33 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer cyc=0;
+   reg [1:0] sel;
+   reg [7:0] out;
+
+   always @* begin
+      out = 8'h0;
+      // Both branches match when sel==3, a violation reported only with assertions on
+      unique if (sel[0]) out = 8'h1;
+      else if (sel[1]) out = 8'h2;
+   end
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      if (cyc==1) sel <= 2'b11;
+      else if (cyc==3) begin
+	 // With assertions off at runtime, the if still executes
+	 if (out !== 8'h1) $stop;
+	 $write("*-* All Finished *-*\n");
+	 $finish;
+      end
+   end
+endmodule
@@ -0,0 +1,76 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+//
+// Benchmark: a small single-cycle CPU running a pseudo-random program,
+// with a register file and instruction and data memories.
+
+`ifndef SIM_CYCLES
+ `define SIM_CYCLES 100
+`endif
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer	cyc = 0;
+
+   reg [31:0]	imem [0:255];
+   reg [31:0]	dmem [0:255];
+   reg [31:0]	regs [0:15];
+   reg [7:0]	pc;
+
+   wire [31:0]	ir = imem[pc];
+   wire [3:0]	op = ir[31:28];
+   wire [3:0]	rd = ir[27:24];
+   wire [31:0]	a = regs[ir[23:20]];
+   wire [31:0]	b = regs[ir[19:16]];
+   wire [31:0]	simm = {{16{ir[15]}}, ir[15:0]};
+
+   integer	i;
+   integer	k;
+   reg [31:0]	seed;
+   reg [31:0]	sum;
+
+   initial begin
+      seed = 32'h12345678;
+      for (i=0; i<256; i=i+1) begin
+	 seed = seed * 32'd1103515245 + 32'd12345;
+	 imem[i] = seed;
+	 dmem[i] = ~seed;
+      end
+      for (i=0; i<16; i=i+1) regs[i] = i;
+      pc = 8'h0;
+   end
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      pc <= pc + 8'd1;
+      case (op)
+	4'h0: regs[rd] <= a + b;
+	4'h1: regs[rd] <= a - b;
+	4'h2: regs[rd] <= a ^ b;
+	4'h3: regs[rd] <= a & b;
+	4'h4: regs[rd] <= a | b;
+	4'h5: regs[rd] <= a << b[4:0];
+	4'h6: regs[rd] <= a >> b[4:0];
+	4'h7: regs[rd] <= a + simm;
+	4'h8: regs[rd] <= dmem[a[7:0] + ir[7:0]];
+	4'h9: dmem[a[7:0] + ir[7:0]] <= b;
+	4'ha: regs[rd] <= a * b;
+	4'hb: if (a == 32'h0) pc <= pc + ir[7:0];
+	4'hc: regs[rd] <= {ir[15:0], a[15:0]};
+	default: regs[rd] <= (a < b) ? 32'h1 : 32'h0;
+      endcase
+      if (cyc == `SIM_CYCLES) begin
+	 sum = 32'h0;
+	 for (k=0; k<16; k=k+1) sum = sum ^ regs[k];
+	 $write("[%0t] sum=%x\n", $time, sum);
+	 $write("*-* All Finished *-*\n");
+	 $finish;
+      end
+   end
+endmodule
@@ -0,0 +1,83 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+//
+// Benchmark: a pipelined add-rotate-xor block cipher style datapath.
+
+`ifndef SIM_CYCLES
+ `define SIM_CYCLES 100
+`endif
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   localparam N = 16;
+
+   integer	cyc = 0;
+   reg [127:0]	in;
+   reg [31:0]	sum;
+   wire [128*(N+1)-1:0] stages;
+
+   assign stages[127:0] = in;
+
+   genvar	g;
+   generate
+      for (g=0; g<N; g=g+1) begin : rounds
+	 round #(.K(32'h9e3779b9 + g))
+	 round (.clk(clk),
+		.in(stages[128*g +: 128]),
+		.out(stages[128*(g+1) +: 128]));
+      end
+   endgenerate
+
+   wire [127:0]	out = stages[128*N +: 128];
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      if (cyc == 0) begin
+	 in <= 128'h0123456789abcdef_fedcba9876543210;
+	 sum <= 32'h0;
+      end
+      else begin
+	 in <= {in[95:0], in[127:96] ^ out[31:0] ^ cyc};
+	 sum <= sum + out[31:0] + out[63:32] + out[95:64] + out[127:96];
+      end
+      if (cyc == `SIM_CYCLES) begin
+	 $write("[%0t] sum=%x\n", $time, sum);
+	 $write("*-* All Finished *-*\n");
+	 $finish;
+      end
+   end
+endmodule
+
+module round (/*AUTOARG*/
+   // Outputs
+   out,
+   // Inputs
+   clk, in
+   );
+   parameter K = 0;
+   input clk;
+   input [127:0] in;
+   output reg [127:0] out;
+
+   wire [31:0]	a = in[31:0];
+   wire [31:0]	b = in[63:32];
+   wire [31:0]	c = in[95:64];
+   wire [31:0]	d = in[127:96];
+
+   wire [31:0]	a1 = a + b;
+   wire [31:0]	dx = d ^ a1;
+   wire [31:0]	d1 = {dx[15:0], dx[31:16]};
+   wire [31:0]	c1 = c + d1 + K[31:0];
+   wire [31:0]	bx = b ^ c1;
+   wire [31:0]	b1 = {bx[19:0], bx[31:20]};
+
+   always @ (posedge clk) begin
+      out <= {d1, c1, b1, a1};
+   end
+endmodule
@@ -0,0 +1,86 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+//
+// Benchmark: a ring network-on-chip, each node injecting random packets
+// and consuming those addressed to it.
+
+`ifndef SIM_CYCLES
+ `define SIM_CYCLES 100
+`endif
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   localparam N = 16;
+
+   integer	cyc = 0;
+   reg		reset = 1'b1;
+   wire [37*N-1:0] links;
+   wire [32*N-1:0] csums;
+
+   genvar	g;
+   generate
+      for (g=0; g<N; g=g+1) begin : nodes
+	 node #(.ID(g))
+	 node (.clk(clk), .reset(reset),
+	       .pin(links[37*((g+N-1)%N) +: 37]),
+	       .pout(links[37*g +: 37]),
+	       .csum(csums[32*g +: 32]));
+      end
+   endgenerate
+
+   integer	i;
+   reg [31:0]	total;
+   always @* begin
+      total = 32'h0;
+      for (i=0; i<N; i=i+1) total = total + csums[32*i +: 32];
+   end
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      reset <= (cyc < 2);
+      if (cyc == `SIM_CYCLES) begin
+	 $write("[%0t] total=%x\n", $time, total);
+	 $write("*-* All Finished *-*\n");
+	 $finish;
+      end
+   end
+endmodule
+
+module node (/*AUTOARG*/
+   // Outputs
+   pout, csum,
+   // Inputs
+   clk, reset, pin
+   );
+   parameter ID = 0;
+   input clk;
+   input reset;
+   input [36:0] pin;	// {valid, dest[3:0], payload[31:0]}
+   output reg [36:0] pout;
+   output reg [31:0] csum;
+
+   reg [31:0]	lfsr;
+
+   wire		arrive = pin[36] && (pin[35:32] == ID[3:0]);
+   wire		pass = pin[36] && !arrive;
+
+   always @ (posedge clk) begin
+      if (reset) begin
+	 pout <= 37'h0;
+	 csum <= 32'h0;
+	 lfsr <= ID + 1;
+      end
+      else begin
+	 lfsr <= {lfsr[30:0], lfsr[31] ^ lfsr[21] ^ lfsr[1] ^ lfsr[0]};
+	 if (arrive) csum <= csum + pin[31:0];
+	 if (pass) pout <= pin;
+	 else pout <= {lfsr[0], lfsr[7:4], lfsr};
+      end
+   end
+endmodule
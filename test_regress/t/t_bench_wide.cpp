@@ -0,0 +1,102 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+//
+// Microbenchmark of the wide-word primitives in verilated.h, reporting ns/op
+
+#include <verilated.h>
+#include <ctime>
+#include <cstdlib>
+#include <cstring>
+
+#include "Vt_bench_wide.h"
+
+double sc_time_stamp() {
+    return 0;
+}
+
+#define MAX_WORDS VL_WORDS_I(4096)
+
+static const int s_widths[] = {33, 64, 65, 128, 256, 512, 1024, 2048, 4096, 0};
+
+static WData s_lw[MAX_WORDS];
+static WData s_rw[MAX_WORDS];
+static WData s_ow[MAX_WORDS];
+static IData s_sink = 0;  // Results feed back into inputs and here, so no call is optimized away
+static int s_iterations = 2000;
+
+enum Op { OP_ADD, OP_MULS, OP_DIV, OP_SHIFTR, OP_CONCAT, OP_REDXOR, OP_COUNTONES, OP_MAX };
+static const char* s_opNames[] = {"add", "muls", "div", "shiftr", "concat", "redxor", "countones"};
+
+static void fill(int bits, WDataOutP owp, IData seed) {
+    int words = VL_WORDS_I(bits);
+    for (int i=0; i<words; ++i) {
+	seed = seed * 1103515245 + 12345;
+	owp[i] = seed;
+    }
+    owp[words-1] &= VL_MASK_I(bits);
+}
+
+static double timeOp(Op op, int bits) {
+    int words = VL_WORDS_I(bits);
+    fill(bits, s_lw, bits);
+    fill(bits, s_rw, bits+1);
+    if (op == OP_DIV) {
+	// Divisor of about half the width, so the general long division path is used
+	for (int i=words/2+1; i<words; ++i) s_rw[i] = 0;
+	s_rw[words/2] |= 1;
+    }
+    clock_t start = clock();
+    for (int it=0; it<s_iterations; ++it) {
+	switch (op) {
+	case OP_ADD: VL_ADD_W(words, s_ow, s_lw, s_rw); break;
+	case OP_MULS: VL_MULS_WWW(bits, bits, bits, s_ow, s_lw, s_rw); break;
+	case OP_DIV: VL_DIV_WWW(bits, s_ow, s_lw, s_rw); break;
+	case OP_SHIFTR: VL_SHIFTR_WWI(bits, bits, 32, s_ow, s_lw, (IData)(it % bits)); break;
+	case OP_CONCAT: VL_CONCAT_WWW(bits, bits/2, bits-bits/2, s_ow, s_lw, s_rw); break;
+	case OP_REDXOR: s_ow[0] = VL_REDXOR_W(words, s_lw); break;
+	case OP_COUNTONES: s_ow[0] = VL_COUNTONES_W(words, s_lw); break;
+	default: break;
+	}
+	s_sink += s_ow[0];
+	s_lw[0] ^= (s_ow[0] & 0xff) + 1;
+    }
+    clock_t end = clock();
+    return ((double)(end - start) / CLOCKS_PER_SEC) * 1e9 / s_iterations;
+}
+
+int main(int argc, char** argv, char** env) {
+    Verilated::commandArgs(argc, argv);
+    const char* itersp = Verilated::commandArgsPlusMatch("iterations=");
+    if (itersp[0]) s_iterations = atoi(itersp + strlen("+iterations="));
+    if (s_iterations < 1) s_iterations = 1;
+
+    VM_PREFIX* topp = new VM_PREFIX("top");
+    topp->eval();
+
+    VL_PRINTF("%-8s", "Width");
+    for (int op=0; op<OP_MAX; ++op) VL_PRINTF("  %10s", s_opNames[op]);
+    VL_PRINTF("   (ns/op, %d iterations)\n", s_iterations);
+    for (int w=0; s_widths[w]; ++w) {
+	int bits = s_widths[w];
+	VL_PRINTF("%-8d", bits);
+	for (int op=0; op<OP_MAX; ++op) {
+	    // Signed multiply and division use VL_MULS_MAX_WORDS temporaries
+	    if ((op == OP_MULS || op == OP_DIV) && VL_WORDS_I(bits) > VL_MULS_MAX_WORDS) {
+		VL_PRINTF("  %10s", "-");
+	    } else {
+		VL_PRINTF("  %10.1f", timeOp((Op)op, bits));
+	    }
+	}
+	VL_PRINTF("\n");
+    }
+    VL_PRINTF("Checksum %08x\n", s_sink);
+
+    topp->final();
+    delete topp;
+    VL_PRINTF("*-* All Finished *-*\n");
+    return 0;
+}
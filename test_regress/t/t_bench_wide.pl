@@ -0,0 +1,28 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2017 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+$Self->{vlt} or $Self->skip("Verilator only test");
+
+$Self->{iterations} = $Self->{benchmark} ? $Self->{benchmark} : 100;
+
+compile (
+    make_top_shell => 0,
+    make_main => 0,
+    v_flags2 => ["--exe $Self->{t_dir}/$Self->{name}.cpp"],
+    );
+
+execute (
+    all_run_flags => ["+iterations=$Self->{iterations}"],
+    check_finished=>1,
+    );
+
+file_grep ($Self->{run_log_filename}, qr/^4096\s+[0-9.]+\s+-\s+-\s+[0-9.]+/m);
+
+ok(1);
+1;
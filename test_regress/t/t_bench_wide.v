@@ -0,0 +1,13 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+//
+// Top for t_bench_wide.cpp, which benchmarks the runtime library directly.
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+endmodule
@@ -0,0 +1,41 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+//
+// Benchmark: a wide memory with a random write and read each cycle.
+
+`ifndef SIM_CYCLES
+ `define SIM_CYCLES 100
+`endif
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer	cyc = 0;
+
+   reg [511:0]	mem [0:1023];
+   reg [63:0]	lfsr = 64'h1;
+   reg [511:0]	wdata = 512'h0;
+   reg [511:0]	rdata = 512'h0;
+   reg [63:0]	acc = 64'h0;
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      lfsr <= {lfsr[62:0], lfsr[63] ^ lfsr[62] ^ lfsr[60] ^ lfsr[59]};
+      wdata <= {8{lfsr}} ^ {wdata[510:0], wdata[511]};
+      mem[lfsr[9:0]] <= wdata;
+      mem[lfsr[29:20]][63:0] <= acc;
+      rdata <= mem[lfsr[19:10]];
+      acc <= acc ^ rdata[63:0] ^ rdata[127:64] ^ rdata[191:128] ^ rdata[255:192]
+	^ rdata[319:256] ^ rdata[383:320] ^ rdata[447:384] ^ rdata[511:448];
+      if (cyc == `SIM_CYCLES) begin
+	 $write("[%0t] acc=%x\n", $time, acc);
+	 $write("*-* All Finished *-*\n");
+	 $finish;
+      end
+   end
+endmodule
@@ -0,0 +1,82 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+#include <verilated.h>
+#include <verilated_board.h>
+#include "Vt_board.h"
+
+double sc_time_stamp () {
+    return 0;
+}
+
+bool fail = false;
+
+void check(int line, int got, int exp) {
+    if (got != exp) {
+	printf("%%Error: line %d: got %d, expected %d\n", line, got, exp);
+	fail = true;
+    }
+}
+
+int main (int argc, char *argv[]) {
+    // Chain added out of order, evaluated a, b, c in one pass
+    Vt_board* ap = new Vt_board("a");
+    Vt_board* bp = new Vt_board("b");
+    Vt_board* cp = new Vt_board("c");
+    VerilatedBoard chain;
+    chain.addModel(cp);
+    chain.addModel(bp);
+    chain.addModel(ap);
+    VL_BOARD_CONNECT(chain, ap, out, bp, in);
+    VL_BOARD_CONNECT(chain, bp, out, cp, in);
+    check(__LINE__, chain.groups(), 3);
+    ap->in = 3;
+    chain.eval();
+    check(__LINE__, cp->out, 6);
+    ap->in = 8;
+    chain.eval();
+    check(__LINE__, cp->out, 10);
+
+    // Loop, evaluated until stable
+    Vt_board* xp = new Vt_board("x");
+    Vt_board* yp = new Vt_board("y");
+    VerilatedBoard loop;
+    loop.addModel(xp);
+    loop.addModel(yp);
+    VL_BOARD_CONNECT(loop, xp, out, yp, in);
+    VL_BOARD_CONNECT(loop, yp, out, xp, in);
+    check(__LINE__, loop.groups(), 1);
+    loop.eval();
+    check(__LINE__, xp->out, 10);
+    check(__LINE__, yp->out, 10);
+
+    // Registered path across models on one clock, each flop sampling
+    // its input from before the edge
+    Vt_board* p0p = new Vt_board("p0");
+    Vt_board* p1p = new Vt_board("p1");
+    VerilatedBoard pipe;
+    pipe.addModel(p1p);
+    pipe.addModel(p0p);
+    VL_BOARD_CONNECT(pipe, p0p, q, p1p, in);
+    for (int cyc = 1; cyc <= 4; ++cyc) {
+	p0p->clk = p1p->clk = 0;
+	p0p->in = cyc * 2;
+	pipe.eval();
+	p0p->clk = p1p->clk = 1;
+	pipe.eval();
+	check(__LINE__, p0p->q, cyc * 2);
+	check(__LINE__, p1p->q, (cyc - 1) * 2);
+	check(__LINE__, p1p->out, cyc * 2 + 1);  // Combinational from p0's new q
+    }
+
+    ap->final(); bp->final(); cp->final(); xp->final(); yp->final();
+    p0p->final(); p1p->final();
+    if (!fail) printf("*-* All Finished *-*\n");
+    delete ap; delete bp; delete cp; delete xp; delete yp;
+    delete p0p; delete p1p;
+    return 0;
+}
@@ -0,0 +1,23 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+module t (/*AUTOARG*/
+   // Outputs
+   out, q,
+   // Inputs
+   clk, in
+   );
+
+   input clk;
+   input [7:0] in;
+   output [7:0] out;
+   output reg [7:0] q;
+
+   // Saturates, so models connected in a loop converge
+   assign out = (in < 8'd10) ? in + 8'd1 : 8'd10;
+
+   // Registered path, for models sharing a clock
+   always @ (posedge clk) q <= in;
+endmodule
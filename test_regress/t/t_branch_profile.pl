@@ -0,0 +1,33 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2017 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+$Self->{vlt} or $Self->skip("Verilator only test");
+
+# Counts as written by --profile-branches in an earlier run
+my $profile = "$Self->{obj_dir}/profile_branches.dat";
+write_wholefile($profile,
+		"VLPROFBRANCH 1\n"
+		."branch 13 87 $Self->{top_filename}:21\n"
+		."branch 12 75 $Self->{top_filename}:22\n"
+		."branch 74 1 $Self->{top_filename}:23\n"
+		."branch 1 99 $Self->{top_filename}:26\n");
+
+compile (
+    verilator_flags2 => ["--stats --branch-profile $profile"],
+    );
+
+file_grep ($Self->{stats}, qr/Optimizations, Cases ordered by profile\s+(\d+)/i, 1);
+file_grep ($Self->{stats}, qr/Optimizations, Branch hints from profile\s+[1-9]\d*/i);
+
+execute (
+    check_finished=>1,
+    );
+
+ok(1);
+1;
@@ -0,0 +1,32 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer cyc = 0;
+   reg [31:0] sel;
+   reg [31:0] sum = 0;
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      sel = (cyc % 8 == 0) ? 32'h100 : (cyc % 4 == 0) ? 32'h2000 : 32'h30000;
+      // Last item is most common, so with a profile it is tested first
+      case (sel)
+        32'h100: sum <= sum + 1;
+        32'h2000: sum <= sum + 2;
+        32'h30000: sum <= sum + 3;
+        default: sum <= sum + 7;
+      endcase
+      if (cyc == 99) begin
+         if (sum != 32'd259) $stop;
+         $write("*-* All Finished *-*\n");
+         $finish;
+      end
+   end
+endmodule
@@ -0,0 +1,41 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2017 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+$Self->{vlt} or $Self->skip("Verilator only test");
+
+top_filename("t/t_case_huge.v");
+
+compile (
+    verilator_flags2 => ["--stats --profile-counters"],
+    );
+
+if ($Self->{vlt}) {
+    file_grep ($Self->{stats}, qr/Optimizations, Tables created\s+(\d+)/i, 10);
+    file_grep ($Self->{stats}, qr/Optimizations, Combined CFuncs\s+(\d+)/i, 10);
+}
+
+my $prof_path = "$Self->{obj_dir}/profile_counters.dat";
+unlink $prof_path;
+
+execute (
+    all_run_flags => ["+verilator+prof+file+$prof_path"],
+    check_finished=>1,
+    );
+
+file_grep ($prof_path, qr/^cfunc \d+ \d+ \d+ \S+::_eval\(/m);
+file_grep ($prof_path, qr/^cfunc [1-9]\d* \d+ \d+ \S+__PROF__t_case_huge_sub__l\d+\(/m);
+
+$Self->_run(cmd=>["cd $Self->{obj_dir} && $ENV{VERILATOR_ROOT}/bin/verilator_profcfunc $prof_path > cfuncs.out"],
+	    check_finished=>0);
+
+file_grep ("$Self->{obj_dir}/cfuncs.out", qr/Overall summary by/);
+file_grep ("$Self->{obj_dir}/cfuncs.out", qr/VBlock    t_case_huge_sub:\d+/);
+
+ok(1);
+1;
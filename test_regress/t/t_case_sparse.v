@@ -0,0 +1,83 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// Wide sparse decoder, searched as a binary tree, checked against if/else.
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer cyc = 0;
+   reg [15:0] op;
+
+   function [7:0] decode_case (input [15:0] op);
+      case (op)
+	16'h0013: decode_case = 8'd1;
+	16'h0033: decode_case = 8'd2;
+	16'h0063, 16'h0067: decode_case = 8'd3;
+	16'h006f: decode_case = 8'd4;
+	16'h0103: decode_case = 8'd5;
+	16'h0123: decode_case = 8'd6;
+	16'h1000: decode_case = 8'd7;
+	16'h4033: decode_case = 8'd8;
+	16'h4033: decode_case = 8'd99;  // Overlap, never selected
+	16'h7fff: decode_case = 8'd9;
+	16'h8000: decode_case = 8'd3;
+	16'hc001: decode_case = 8'd10;
+	16'hfffe: decode_case = 8'd11;
+	16'hffff: decode_case = 8'd12;
+	default: decode_case = 8'd0;
+      endcase
+   endfunction
+
+   function [7:0] decode_if (input [15:0] op);
+      if (op == 16'h0013) decode_if = 8'd1;
+      else if (op == 16'h0033) decode_if = 8'd2;
+      else if (op == 16'h0063 || op == 16'h0067 || op == 16'h8000) decode_if = 8'd3;
+      else if (op == 16'h006f) decode_if = 8'd4;
+      else if (op == 16'h0103) decode_if = 8'd5;
+      else if (op == 16'h0123) decode_if = 8'd6;
+      else if (op == 16'h1000) decode_if = 8'd7;
+      else if (op == 16'h4033) decode_if = 8'd8;
+      else if (op == 16'h7fff) decode_if = 8'd9;
+      else if (op == 16'hc001) decode_if = 8'd10;
+      else if (op == 16'hfffe) decode_if = 8'd11;
+      else if (op == 16'hffff) decode_if = 8'd12;
+      else decode_if = 8'd0;
+   endfunction
+
+   wire [7:0] got = decode_case(op);
+   wire [7:0] exp = decode_if(op);
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      if (got != exp) begin
+	 $write("%%Error: op=%x got=%x exp=%x\n", op, got, exp);
+	 $stop;
+      end
+      // Walk each decoded value and its neighbors, then pseudo-random values
+      case (cyc)
+	0: op <= 16'h0012;
+	1: op <= 16'h0013;
+	2: op <= 16'h0014;
+	3: op <= 16'h0063;
+	4: op <= 16'h0067;
+	5: op <= 16'h4033;
+	6: op <= 16'h7fff;
+	7: op <= 16'h8000;
+	8: op <= 16'hc001;
+	9: op <= 16'hfffe;
+	10: op <= 16'hffff;
+	11: op <= 16'h0000;
+	default: op <= {op[14:0], op[15] ^ op[13] ^ op[12] ^ op[10]} ^ 16'h0001;
+      endcase
+      if (cyc == 99) begin
+	 $write("*-* All Finished *-*\n");
+	 $finish;
+      end
+   end
+endmodule
@@ -0,0 +1,46 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+//
+// Results whose upper bits must be zero need no cleaning mask.
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   // verilator lint_off WIDTH
+
+   integer	cyc = 0;
+   reg [6:0]	a = 7'h0;
+   reg [6:0]	b = 7'h0;
+   reg [5:0]	c = 6'h0;
+
+   wire [15:0]	sum = a + b;		// At most 8 bits
+   wire [15:0]	prod = a * c;		// At most 13 bits
+   wire [15:0]	shl = {9'h0, a} << 3;	// At most 10 bits
+   wire [9:0]	sum10 = a + b + c;	// At most 9 bits
+   wire [7:0]	wrap = a + b + 8'hff;	// Needs cleaning
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      a <= a + 7'd13;
+      b <= b + 7'd29;
+      c <= c + 6'd7;
+`ifdef TEST_VERBOSE
+      $write("[%0t] a=%x b=%x c=%x sum=%x prod=%x shl=%x sum10=%x wrap=%x\n",
+	     $time, a, b, c, sum, prod, shl, sum10, wrap);
+`endif
+      if (sum != ({8'h0, a} + {8'h0, b})) $stop;
+      if (prod != ({9'h0, a} * {10'h0, c})) $stop;
+      if (shl != {6'h0, a, 3'b0}) $stop;
+      if (sum10 != ({2'b0, a} + {2'b0, b} + {3'b0, c})) $stop;
+      if (wrap != ({1'b0, a} + {1'b0, b} - 8'h1)) $stop;
+      if (cyc == 99) begin
+	 $write("*-* All Finished *-*\n");
+	 $finish;
+      end
+   end
+endmodule
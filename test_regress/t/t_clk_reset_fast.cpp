@@ -0,0 +1,60 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+#include <verilated.h>
+#include "Vt_clk_reset_fast.h"
+
+unsigned int main_time = 0;
+
+double sc_time_stamp () {
+    return main_time;
+}
+
+VM_PREFIX* topp = NULL;
+bool fail = false;
+
+void step(int clk, int rst_n) {
+    topp->clk = clk;
+    topp->rst_n = rst_n;
+    topp->eval();
+    main_time++;
+}
+
+void check(int line, int cnt) {
+    if (topp->cnt != cnt) {
+	printf("%%Error: line %d: cnt = %d, expected %d\n", line, topp->cnt, cnt);
+	fail = true;
+    }
+}
+
+int main (int argc, char *argv[]) {
+    topp = new VM_PREFIX;
+    topp->total = 0;
+    step(0, 1);
+    step(0, 0);  // Reset without a clock
+    check(__LINE__, 0);
+    for (int i = 0; i < 3; i++) { step(1, 0); step(0, 0); }
+    check(__LINE__, 0);
+    step(0, 1);
+    for (int i = 0; i < 5; i++) { step(1, 1); step(0, 1); }
+    check(__LINE__, 5);
+    step(1, 1);
+    step(1, 0);  // Reset while the clock is high
+    check(__LINE__, 0);
+    step(0, 0);
+    step(0, 1);
+    for (int i = 0; i < 3; i++) { step(1, 1); step(0, 1); }
+    check(__LINE__, 3);
+    if (topp->total != 12) {
+	printf("%%Error: total = %d, expected 12\n", topp->total);
+	fail = true;
+    }
+    topp->final();
+    if (!fail) printf("*-* All Finished *-*\n");
+    delete topp; topp = NULL;
+    return 0;
+}
@@ -0,0 +1,27 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+module t (/*AUTOARG*/
+   // Outputs
+   cnt, total,
+   // Inputs
+   clk, rst_n
+   );
+
+   input clk;
+   input rst_n;
+   output reg [7:0] cnt;
+   output reg [7:0] total;
+
+   always @ (posedge clk or negedge rst_n) begin
+      if (!rst_n) cnt <= 8'd0;
+      else cnt <= cnt + 8'd1;
+   end
+
+   // Clock only, so still evaluated on the fast path
+   always @ (posedge clk) begin
+      total <= total + 8'd1;
+   end
+endmodule
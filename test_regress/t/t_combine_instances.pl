@@ -0,0 +1,26 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2017 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+$Self->{vlt} or $Self->skip("Verilator only test");
+
+top_filename("t/t_inst_array.v");
+
+compile (
+    v_flags2 => ['+define+NOUSE_INLINE',],
+    verilator_flags2 => ["--stats --combine-instances"],
+    );
+
+file_grep ($Self->{stats}, qr/Optimizations, Combine instance-relative CFuncs\s+(\d+)/i);
+
+execute (
+    check_finished=>1,
+    );
+
+ok(1);
+1;
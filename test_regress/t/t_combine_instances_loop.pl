@@ -0,0 +1,24 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2017 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+$Self->{vlt} or $Self->skip("Verilator only test");
+
+compile (
+    verilator_flags2 => ["--stats --combine-instances"],
+    );
+
+file_grep ($Self->{stats}, qr/Optimizations, Combine instance loops\s+[1-9]/i);
+file_grep ("$Self->{obj_dir}/$Self->{VM_PREFIX}.cpp", qr/__Vinsts\[__Vi\]/);
+
+execute (
+    check_finished=>1,
+    );
+
+ok(1);
+1;
@@ -0,0 +1,37 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer cyc; initial cyc=1;
+
+   wire [63:0] sums;
+
+   sub sub [7:0] (.clk(clk), .in(cyc[7:0]), .sum(sums));
+
+   always @ (posedge clk) begin
+      if (cyc!=0) begin
+	 cyc <= cyc + 1;
+	 if (cyc==10) begin
+	    // Each instance has summed 1..9
+	    if (sums !== {8{8'd45}}) $stop;
+	    $write("*-* All Finished *-*\n");
+	    $finish;
+	 end
+      end
+   end
+endmodule
+
+module sub (input clk, input [7:0] in, output reg [7:0] sum);
+   /*verilator no_inline_module*/
+   initial sum = 0;
+   always @ (posedge clk) begin
+      sum <= sum + in;
+   end
+endmodule
@@ -0,0 +1,57 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// Lookups with identical contents in different modules share one table
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer 	cyc=0;
+   wire [3:0]	sel = cyc[3:0];
+   wire [7:0]	outa;
+   wire [7:0]	outb;
+
+   SboxA sboxa (.sel(sel), .out(outa));
+   SboxB sboxb (.sel(sel), .out(outb));
+
+   always @ (posedge clk) begin
+`ifdef TEST_VERBOSE
+      $write("[%0t] cyc==%0d outa=%x outb=%x\n",$time, cyc, outa, outb);
+`endif
+      cyc <= cyc + 1;
+      if (outa !== outb) $stop;
+      if (cyc==5 && outa !== 8'h6b) $stop;
+      if (cyc==12 && outa !== 8'hfe) $stop;
+      if (cyc==20) begin
+	 $write("*-* All Finished *-*\n");
+	 $finish;
+      end
+   end
+endmodule
+
+module SboxA (input [3:0] sel, output reg [7:0] out);
+   always @* begin
+      case (sel)
+	4'h0: out = 8'h63;  4'h1: out = 8'h7c;  4'h2: out = 8'h77;  4'h3: out = 8'h7b;
+	4'h4: out = 8'hf2;  4'h5: out = 8'h6b;  4'h6: out = 8'h6f;  4'h7: out = 8'hc5;
+	4'h8: out = 8'h30;  4'h9: out = 8'h01;  4'ha: out = 8'h67;  4'hb: out = 8'h2b;
+	4'hc: out = 8'hfe;  4'hd: out = 8'hd7;  4'he: out = 8'hab;  default: out = 8'h76;
+      endcase
+   end
+endmodule
+
+module SboxB (input [3:0] sel, output reg [7:0] out);
+   always @* begin
+      case (sel)
+	4'h0: out = 8'h63;  4'h1: out = 8'h7c;  4'h2: out = 8'h77;  4'h3: out = 8'h7b;
+	4'h4: out = 8'hf2;  4'h5: out = 8'h6b;  4'h6: out = 8'h6f;  4'h7: out = 8'hc5;
+	4'h8: out = 8'h30;  4'h9: out = 8'h01;  4'ha: out = 8'h67;  4'hb: out = 8'h2b;
+	4'hc: out = 8'hfe;  4'hd: out = 8'hd7;  4'he: out = 8'hab;  default: out = 8'h76;
+      endcase
+   end
+endmodule
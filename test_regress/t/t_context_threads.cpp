@@ -0,0 +1,115 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+#include <verilated.h>
+
+#include "Vt_context_threads.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+// No sc_time_stamp(); with --time-context the model reads the context's time
+
+bool fail = false;
+
+void check(int line, int got, int exp) {
+    if (got != exp) {
+	VL_PRINTF("%%Error: %s:%d: GOT=%d EXP=%d\n", __FILE__, line, got, exp);
+	fail = true;
+    }
+}
+
+// Results of running one model to its $finish
+struct Run {
+    int		m_id;		// +ID= of the model, which finishes after 10*m_id cycles
+    std::string	m_filename;	// +FILE= the model writes
+    int		m_cyc;		// Model's cycles at $finish
+    int		m_fd;		// Model's $fopen descriptor
+    int		m_randSum;	// Model's XOR of $random each cycle
+    explicit Run(int id)
+	: m_id(id), m_cyc(0), m_fd(0), m_randSum(0) {
+	std::ostringstream os;
+	os<<"obj_dir/t_context_threads/out"<<id<<".log";
+	m_filename = os.str();
+    }
+};
+
+static void runModel(Run* runp) {
+    VerilatedContext context;
+    Verilated::threadContextp(&context);
+
+    std::ostringstream seed;  seed<<"+verilator+seed+"<<(100+runp->m_id);
+    std::ostringstream id;  id<<"+ID="<<runp->m_id;
+    std::string file = "+FILE="+runp->m_filename;
+    std::string seedArg = seed.str();  std::string idArg = id.str();
+    const char* argv[] = {"t_context_threads", seedArg.c_str(), idArg.c_str(), file.c_str()};
+    Verilated::commandArgs(4, argv);
+
+    Vt_context_threads* topp = new Vt_context_threads("top");
+    topp->clk = 0;
+    topp->eval();
+    while (context.time() < 1000 && !Verilated::gotFinish()) {
+	context.timeInc(5);
+	topp->clk = !topp->clk;
+	topp->eval();
+    }
+    runp->m_cyc = topp->cyc;
+    runp->m_fd = topp->fd;
+    runp->m_randSum = topp->rand_sum;
+    topp->final();
+    delete topp;
+    Verilated::threadContextp(NULL);
+}
+
+static void checkFile(int line, const Run& run) {
+    // Every line the model wrote, none from the other model
+    std::ifstream is(run.m_filename.c_str());
+    int lines = 0;
+    std::string text;
+    while (std::getline(is, text)) {
+	int id = -1;
+	if (sscanf(text.c_str(), "%*c %d", &id) != 1 || id != run.m_id) {
+	    VL_PRINTF("%%Error: %s:%d: %s: '%s'\n", __FILE__, line, run.m_filename.c_str(), text.c_str());
+	    fail = true;
+	}
+	++lines;
+    }
+    check(line, lines, 2*10*run.m_id);
+}
+
+int main(int argc, char** argv, char** env) {
+    // Each model alone, for the $random values expected of its seed
+    Run alone1 (1);  runModel(&alone1);
+    Run alone2 (2);  runModel(&alone2);
+
+    Run run1 (1);
+    Run run2 (2);
+    std::thread thread1 (runModel, &run1);
+    std::thread thread2 (runModel, &run2);
+    thread1.join();
+    thread2.join();
+
+    // Each finished on its own $finish
+    check(__LINE__, run1.m_cyc, 10+1);
+    check(__LINE__, run2.m_cyc, 20+1);
+    check(__LINE__, Verilated::defaultContextp()->gotFinish(), false);
+    // Each had its own descriptors, so both got the first
+    check(__LINE__, run1.m_fd, run2.m_fd);
+    checkFile(__LINE__, run1);
+    checkFile(__LINE__, run2);
+    // Each had its own random state
+    check(__LINE__, run1.m_randSum, alone1.m_randSum);
+    check(__LINE__, run2.m_randSum, alone2.m_randSum);
+
+    if (fail) {
+	vl_fatal(__FILE__, __LINE__, "main", "%Error: Contexts not independent");
+    }
+    VL_PRINTF("*-* All Finished *-*\n");
+    return 0;
+}
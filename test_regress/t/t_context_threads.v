@@ -0,0 +1,48 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// One of two models run on separate threads, each under its own context
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+module t (/*AUTOARG*/
+   // Outputs
+   id, fd, cyc, rand_sum,
+   // Inputs
+   clk
+   );
+   input clk;
+   output integer id;
+   output integer fd;
+   output integer cyc;
+   output integer rand_sum;
+
+   reg [8*64:1] filename;
+
+   initial begin
+      cyc = 0;
+      rand_sum = 0;
+      if (!$value$plusargs("ID=%d", id)) $stop;
+      if (!$value$plusargs("FILE=%s", filename)) $stop;
+      fd = $fopen(filename, "w");
+      if (fd == 0) $stop;
+   end
+
+   // Separate blocks, so with --threads some run on the pool's workers
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      if (cyc == 10*id) begin
+	 $fclose(fd);
+	 $finish;
+      end
+   end
+   always @ (posedge clk) begin
+      rand_sum <= rand_sum ^ $random;
+   end
+   always @ (posedge clk) begin
+      if (cyc < 10*id) $fwrite(fd, "a %0d %0d\n", id, cyc);
+   end
+   always @ (posedge clk) begin
+      if (cyc < 10*id) $fwrite(fd, "b %0d %0d\n", id, cyc);
+   end
+endmodule
@@ -0,0 +1,38 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+#include <verilated.h>
+#include <verilated_cov.h>
+#include "Vt_cover_binary.h"
+
+unsigned int main_time = 0;
+
+double sc_time_stamp () {
+    return main_time;
+}
+
+int main (int argc, char *argv[]) {
+    VM_PREFIX* topp = new VM_PREFIX;
+    Verilated::debug(0);
+
+    topp->clk = 0;
+    topp->eval();
+    while (!Verilated::gotFinish() && main_time < 1000) {
+	topp->clk = !topp->clk;
+	topp->eval();
+	main_time += 5;
+    }
+    if (!Verilated::gotFinish()) {
+	vl_fatal(__FILE__,__LINE__,"main", "%Error: Timeout; never got a $finish");
+    }
+    topp->final();
+
+    VerilatedCov::write("obj_dir/t_cover_binary/coverage_text.dat");
+    VerilatedCov::writeBinary("obj_dir/t_cover_binary/coverage_binary.dat");
+    delete topp; topp = NULL;
+    return 0;
+}
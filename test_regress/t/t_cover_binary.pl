@@ -0,0 +1,34 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2017 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+$Self->{vlt} or $Self->skip("Verilator only test");
+
+top_filename("t/t_cover_line.v");
+
+compile (
+    make_top_shell => 0,
+    make_main => 0,
+    verilator_flags2 => ["--cc --coverage --exe $Self->{t_dir}/$Self->{name}.cpp"],
+    );
+
+execute (
+    check_finished=>1,
+    );
+
+# Both forms must give the same points once read back by verilator_coverage
+foreach my $form ("text", "binary") {
+    $Self->_run(cmd=>["../bin/verilator_coverage",
+		      "--write", "$Self->{obj_dir}/coverage_${form}_out.dat",
+		      "$Self->{obj_dir}/coverage_${form}.dat",
+		],
+	);
+}
+ok(files_identical("$Self->{obj_dir}/coverage_binary_out.dat",
+		   "$Self->{obj_dir}/coverage_text_out.dat"));
+1;
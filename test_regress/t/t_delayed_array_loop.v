@@ -0,0 +1,67 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer cyc=0;
+
+   // Written in a loop too large to unroll, read by other logic
+   reg [15:0] 	mem [63:0];
+   // Read only before being written, by the writing block
+   reg [15:0] 	ram [15:0];
+   reg [15:0] 	rdata;
+
+   wire [15:0] 	mem_sum = mem[0] + mem[63];
+
+   integer 	i;
+   initial begin
+      for (i = 0; i < 64; i = i + 1) mem[i] = 16'h0;
+      for (i = 0; i < 16; i = i + 1) ram[i] = 16'h0;
+   end
+
+   always @ (posedge clk) begin
+      if (cyc == 1) begin
+	 for (i = 0; i < 64; i = i + 1) begin
+	    mem[i] <= i[15:0] + 16'h100;
+	 end
+	 // Readers in this cycle still see old values
+	 if (mem[0] == 16'h100) $stop;
+      end
+      else if (cyc == 2) begin
+	 if (mem[0] != 16'h100) $stop;
+	 if (mem[63] != 16'h13f) $stop;
+	 // Later writes to same address win
+	 for (i = 0; i < 32; i = i + 1) begin
+	    mem[i & 1] <= i[15:0];
+	 end
+      end
+   end
+
+   always @ (posedge clk) begin
+      rdata <= ram[cyc[3:0]];
+      if (cyc < 16) ram[cyc[3:0]] <= cyc[15:0] + 16'h10;
+   end
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      if (cyc == 2) begin
+	 if (mem_sum != 16'h23f) $stop;
+      end
+      else if (cyc == 3) begin
+	 if (mem[0] != 16'd30) $stop;
+	 if (mem[1] != 16'd31) $stop;
+      end
+      else if (cyc == 20) begin
+	 // ram[3] written at cyc 3, read at cyc 19
+	 if (rdata != 16'h13) $stop;
+	 $write("*-* All Finished *-*\n");
+	 $finish;
+      end
+   end
+endmodule
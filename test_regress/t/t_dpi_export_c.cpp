@@ -27,6 +27,7 @@
 
 #if defined(VERILATOR)
 # include "Vt_dpi_export__Dpi.h"
+# include "Vt_dpi_export.h"
 #elif defined(VCS)
 # include "../vc_hdrs.h"
 #elif defined(CADENCE)
@@ -89,6 +90,11 @@ static int check_sub(const char* name, int i) {
     CHECK_RESULT(svScope, svGetScope(), scope);
     int out = dpix_sub_inst(100*i);
     CHECK_RESULT(int, out, 100*i + i);
+#ifdef VERILATOR
+    VerilatedDpiExport bound ((const VerilatedScope*)scope, "dpix_sub_inst");
+    out = Vt_dpi_export::dpix_sub_inst__Vbound(bound, 200*i);
+    CHECK_RESULT(int, out, 200*i + i);
+#endif
 
     return 0; // OK
 }
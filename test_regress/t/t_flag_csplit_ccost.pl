@@ -0,0 +1,33 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2017 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+$Self->{vlt} or $Self->skip("Verilator only test");
+
+top_filename("t/t_flag_csplit.v");
+
+compile (
+    v_flags2 => ["--output-split-ccost 1"],
+    );
+
+execute (
+    check_finished=>1,
+    );
+
+# Every statement exceeds a cost of 1, so each gets its own function
+my $funcs = 0;
+foreach my $file (glob("$Self->{obj_dir}/*.cpp")) {
+    my $fh = IO::File->new("<$file") or $Self->error("$! $file");
+    while (defined (my $line = $fh->getline)) {
+	$funcs++ if $line =~ /^(VL_INLINE_OPT\s+)?void\s+.*::_(sequent|combo|settle)__/;
+    }
+}
+$funcs > 2 or $Self->error("Expected statements split into functions, got $funcs");
+
+ok(1);
+1;
@@ -0,0 +1,31 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2017 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+$Self->{vlt} or $Self->skip("Verilator only test");
+
+top_filename("t/t_EXAMPLE.v");
+
+compile (
+    verilator_flags2 => ["--dump-tree --dump-tree-binary"],
+    );
+
+execute (
+    check_finished=>1,
+    );
+
+my @trees = sort glob("$Self->{obj_dir}/*.treeb");
+@trees >= 2 or $Self->error("No .treeb files written");
+!glob("$Self->{obj_dir}/*.tree") or $Self->error("Text .tree files written with --dump-tree-binary");
+
+$Self->_run(cmd=>["../bin/verilator_difftree", $trees[0], $trees[-1]],
+	    logfile=>"$Self->{obj_dir}/difftree.log");
+file_grep ("$Self->{obj_dir}/difftree.log", qr/^@@ /m);
+
+ok(1);
+1;
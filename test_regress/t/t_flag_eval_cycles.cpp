@@ -0,0 +1,34 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+#include <verilated.h>
+#include "Vt_flag_eval_cycles.h"
+
+double sc_time_stamp () {
+    return 0;
+}
+
+static void setInputs(Vt_flag_eval_cycles* topp, vluint64_t cycle, void* userp) {
+    topp->in = (vluint32_t)cycle;
+    ++*(static_cast<int*>(userp));
+}
+
+int main (int argc, char *argv[]) {
+    Vt_flag_eval_cycles* topp = new Vt_flag_eval_cycles;
+    topp->clk = 0;
+    topp->in = 0;
+    topp->eval();
+    int calls = 0;
+    // Stops early at $finish, on the 21st rising edge
+    vluint64_t cycles = topp->evalCycles(100, setInputs, &calls);
+    if (cycles != 21 || calls != 21 || !Verilated::gotFinish()) {
+	vl_fatal(__FILE__,__LINE__,"top", "Unexpected evalCycles result");
+    }
+    topp->final();
+    delete topp;
+    return 0;
+}
@@ -0,0 +1,26 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk, in
+   );
+   input clk;
+   input [31:0] in;
+
+   integer cyc=0;
+   reg [31:0] sum = 0;
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      sum <= sum + in;
+      if (cyc==20) begin
+	 // Inputs were 0..19 on the first 20 edges
+	 if (sum !== 32'd190) $stop;
+	 $write("*-* All Finished *-*\n");
+	 $finish;
+      end
+   end
+endmodule
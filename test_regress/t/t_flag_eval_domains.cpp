@@ -0,0 +1,38 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+#include <verilated.h>
+#include "Vt_flag_eval_domains.h"
+
+double sc_time_stamp () {
+    return 0;
+}
+
+int main (int argc, char *argv[]) {
+    Vt_flag_eval_domains* topp = new Vt_flag_eval_domains;
+    topp->clka = 0;
+    topp->clkb = 0;
+    topp->eval();
+    vluint32_t countb = 0;
+    for (int cyc=0; cyc<10; ++cyc) {
+	topp->eval_posedge_clka();
+	topp->clka = 0;
+	topp->eval();
+	if (topp->counta != (vluint32_t)(cyc+1)) vl_fatal(__FILE__,__LINE__,"top", "Bad counta");
+	if (cyc & 1) {
+	    topp->eval_posedge_clkb();
+	    topp->clkb = 0;
+	    topp->eval();
+	    countb += 10 + topp->counta;
+	}
+	if (topp->countb != countb) vl_fatal(__FILE__,__LINE__,"top", "Bad countb");
+    }
+    topp->final();
+    delete topp;
+    printf("*-* All Finished *-*\n");
+    return 0;
+}
@@ -0,0 +1,25 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2017 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+$Self->{vlt} or $Self->skip("Verilator only test");
+
+compile (
+    make_top_shell => 0,
+    make_main => 0,
+    verilator_flags2 => ["--cc --stats --eval-domains --exe $Self->{t_dir}/$Self->{name}.cpp"],
+    );
+
+file_grep ($Self->{stats}, qr/Optimizations, Clock domain eval functions\s+2/i);
+
+execute (
+    check_finished=>1,
+    );
+
+ok(1);
+1;
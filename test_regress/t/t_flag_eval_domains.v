@@ -0,0 +1,19 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+module t (/*AUTOARG*/
+   // Outputs
+   counta, countb,
+   // Inputs
+   clka, clkb
+   );
+   input clka;
+   input clkb;
+   output reg [31:0] counta = 0;
+   output reg [31:0] countb = 0;
+
+   always @ (posedge clka) counta <= counta + 1;
+   always @ (posedge clkb) countb <= countb + 32'd10 + counta;
+endmodule
@@ -0,0 +1,35 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+#include <verilated.h>
+#include "Vt_flag_lazy_output.h"
+
+double sc_time_stamp () {
+    return 0;
+}
+
+int main (int argc, char *argv[]) {
+    Vt_flag_lazy_output* topp = new Vt_flag_lazy_output;
+    topp->clk = 0;
+    topp->eval();
+    for (int cyc=0; cyc<10; ++cyc) {
+	topp->clk = 1;
+	topp->eval();
+	topp->clk = 0;
+	topp->eval();
+	if (cyc & 1) {
+	    topp->evalLazy();
+	    vluint64_t count = topp->count;
+	    vluint64_t expect = (count * VL_ULL(1000003)) ^ ((count<<32) | count);
+	    if (topp->status != expect) vl_fatal(__FILE__,__LINE__,"top", "Bad status");
+	}
+    }
+    topp->final();
+    delete topp;
+    printf("*-* All Finished *-*\n");
+    return 0;
+}
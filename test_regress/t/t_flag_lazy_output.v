@@ -0,0 +1,22 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+module t (/*AUTOARG*/
+   // Outputs
+   count, status,
+   // Inputs
+   clk
+   );
+   input clk;
+   output reg [31:0] count;
+   output [63:0]     status;
+
+   initial count = 0;
+   always @ (posedge clk) count <= count + 1;
+
+   // Only read by status, so evaluated by evalLazy()
+   wire [63:0] 	     prod = {32'h0, count} * 64'd1000003;
+   assign status = prod ^ {count, count};
+endmodule
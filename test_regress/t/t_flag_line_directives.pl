@@ -0,0 +1,27 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2017 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+$Self->{vlt} or $Self->skip("Verilator only test");
+
+top_filename("t/t_branch_profile.v");
+
+compile (
+    verilator_flags2 => ["--line-directives"],
+    );
+
+# Statements are attributed to Verilog, then the function returns to the C++ lines
+file_grep ("$Self->{obj_dir}/$Self->{VM_PREFIX}.cpp", qr/^#line \d+ "\S*t_branch_profile.v"$/m);
+file_grep ("$Self->{obj_dir}/$Self->{VM_PREFIX}.cpp", qr/^#line \d+ "$Self->{VM_PREFIX}.cpp"$/m);
+
+execute (
+    check_finished=>1,
+    );
+
+ok(1);
+1;
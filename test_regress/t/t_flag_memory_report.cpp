@@ -0,0 +1,27 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+#include <verilated.h>
+#include "Vt_flag_memory_report.h"
+
+double sc_time_stamp () {
+    return 0;
+}
+
+int main (int argc, char *argv[]) {
+    Vt_flag_memory_report* topp = new Vt_flag_memory_report;
+    topp->clk = 0;
+    topp->eval();
+    while (!Verilated::gotFinish()) {
+	topp->clk = !topp->clk;
+	topp->eval();
+    }
+    topp->memoryReport();
+    topp->final();
+    delete topp;
+    return 0;
+}
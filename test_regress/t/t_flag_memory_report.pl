@@ -0,0 +1,30 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2017 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+$Self->{vlt} or $Self->skip("Verilator only test");
+
+compile (
+    make_top_shell => 0,
+    make_main => 0,
+    verilator_flags2 => ["--cc --stats --stats-vars --exe $Self->{t_dir}/$Self->{name}.cpp"],
+    );
+
+file_grep ($Self->{stats}, qr/Memory, TOTAL, bytes\s+[1-9]/i);
+file_grep ($Self->{stats}, qr/Memory, array sub.mem, bytes\s+2048/i);
+file_grep ($Self->{stats}, qr/Memory, shadow copies, bytes\s+[1-9]/i);
+
+execute (
+    check_finished=>1,
+    expect=>
+'- Memory:   array mem +1024 bytes
+- Memory: TOP\S*\.sub_b +\d+ bytes  \(arrays 1024, shadows \d+\)',
+    );
+
+ok(1);
+1;
@@ -0,0 +1,46 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer cyc; initial cyc=0;
+   wire [31:0] out_a;
+   wire [31:0] out_b;
+
+   sub sub_a (.clk(clk), .addr(cyc[7:0]), .out(out_a));
+   sub sub_b (.clk(clk), .addr(~cyc[7:0]), .out(out_b));
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      if (cyc==20) begin
+	 if (out_a == out_b) $stop;
+	 $write("*-* All Finished *-*\n");
+	 $finish;
+      end
+   end
+endmodule
+
+module sub (/*AUTOARG*/
+   // Outputs
+   out,
+   // Inputs
+   clk, addr
+   );
+   input clk;
+   input [7:0] addr;
+   output reg [31:0] out;
+   /*verilator no_inline_module*/
+
+   reg [31:0] mem [0:255];
+
+   always @ (posedge clk) begin
+      mem[addr] <= {24'h0, addr} + 32'h1;
+      out <= mem[addr - 8'h1];
+   end
+endmodule
@@ -0,0 +1,34 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2017 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+$Self->{vlt} or $Self->skip("Verilator only test");
+
+top_filename("t/t_case_huge.v");
+
+compile (
+    v_flags2 => ["--output-split 1000 --output-groups 3"],
+    );
+
+file_grep ("$Self->{obj_dir}/$Self->{VM_PREFIX}_classes.mk", qr/__Group2 /);
+
+# The driver's makefile builds its own way, so build the archive as users would
+$Self->_run(logfile=>"$Self->{obj_dir}/vlt_archive.log",
+	    cmd=>["cd $Self->{obj_dir} && make -f $Self->{VM_PREFIX}.mk",
+		  "VM_PCH=1 $Self->{VM_PREFIX}__ALL.a"]);
+-r "$Self->{obj_dir}/$Self->{VM_PREFIX}__Group1.o"
+    or $Self->error("Unity group was not compiled");
+-r "$Self->{obj_dir}/$Self->{VM_PREFIX}__Syms.h.fast.gch"
+    or $Self->error("Precompiled header was not built");
+
+execute (
+    check_finished=>1,
+    );
+
+ok(1);
+1;
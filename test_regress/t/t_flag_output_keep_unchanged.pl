@@ -0,0 +1,37 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2017 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+$Self->{vlt} or $Self->skip("Verilator only test");
+
+top_filename("t/t_EXAMPLE.v");
+
+my @flags = ("--stats", "--no-skip-identical", "--output-keep-unchanged");
+
+compile (
+    verilator_flags2 => [@flags],
+    );
+
+my $cppfile = "$Self->{obj_dir}/$Self->{VM_PREFIX}.cpp";
+my @firststat = stat($cppfile);
+sleep(2);
+
+compile (
+    verilator_flags2 => [@flags],
+    );
+
+file_grep ($Self->{stats}, qr/Output files, unchanged\s+[1-9]/i);
+my @secondstat = stat($cppfile);
+$firststat[9] == $secondstat[9] or $Self->error("Unchanged $cppfile was rewritten");
+
+execute (
+    check_finished=>1,
+    );
+
+ok(1);
+1;
@@ -0,0 +1,26 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2017 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+$Self->{vlt} or $Self->skip("Verilator only test");
+
+top_filename("t/t_case_huge.v");
+
+compile (
+    v_flags2 => ["--output-split 1000 --output-split-stable"],
+    );
+
+# Split files are named by a hash of their first function
+file_grep ("$Self->{obj_dir}/$Self->{VM_PREFIX}_classes.mk", qr/__[0-9a-f]{6} /);
+
+execute (
+    check_finished=>1,
+    );
+
+ok(1);
+1;
@@ -0,0 +1,32 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2017 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+$Self->{vlt} or $Self->skip("Verilator only test");
+
+top_filename("t/t_EXAMPLE.v");
+
+compile (
+    );
+
+# The driver's makefile builds its own way, so build the archive as users would
+my $rtdir = "$Self->{obj_dir}/runtime";
+foreach my $lib ("1", "shared") {
+    $Self->_run(logfile=>"$Self->{obj_dir}/vlt_archive_$lib.log",
+		cmd=>["cd $Self->{obj_dir} && make -f $Self->{VM_PREFIX}.mk",
+		      "VM_RUNTIME_LIB=$lib VM_RUNTIME_DIR=$rtdir $Self->{VM_PREFIX}__ALL.a"]);
+}
+my @libs = glob("$rtdir/libverilated-*");
+@libs == 2 or $Self->error("Expected static and shared runtime libraries, got: @libs");
+
+execute (
+    check_finished=>1,
+    );
+
+ok(1);
+1;
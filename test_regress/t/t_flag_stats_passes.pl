@@ -0,0 +1,33 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2017 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+$Self->{vlt} or $Self->skip("Verilator only test");
+
+top_filename("t/t_flag_stats.v");
+
+compile (
+    verilator_flags2 => ["--stats --stats-budget-memory 1"],
+    );
+
+file_grep ($Self->{stats}, qr/^Pass Statistics:/m);
+file_grep ($Self->{stats}, qr/^  \d+\s+gate\s+[0-9.]+\s+[0-9.]+/m);
+file_grep ($Self->{stats}, qr/^\s+Total\s+[0-9.]+\s+[0-9.]+/m);
+
+my $json = $Self->{stats};
+$json =~ s/__stats\.txt$/__stats.json/;
+file_grep ($json, qr/"passes": \[/);
+file_grep ($json, qr/\{"name": "gate", "wall": [0-9.]+, "cpu": [0-9.]+, "mem_bytes": \d+, "peak_bytes": \d+\}/);
+file_grep ($json, qr/\{"stage": "\*", "name": "[^"]+", "count": \d+\}/);
+
+execute (
+    check_finished=>1,
+    );
+
+ok(1);
+1;
@@ -0,0 +1,25 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2017 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+$Self->{vlt} or $Self->skip("Verilator only test");
+
+top_filename("t/t_EXAMPLE.v");
+
+compile (
+    );
+
+file_grep ("$Self->{obj_dir}/$Self->{VM_PREFIX}.cpp", qr/VL_ATTR_HOT void $Self->{VM_PREFIX}::_eval\(/);
+file_grep ("$Self->{obj_dir}/$Self->{VM_PREFIX}__Slow.cpp", qr/VL_ATTR_COLD void $Self->{VM_PREFIX}::_eval_initial\(/);
+
+execute (
+    check_finished=>1,
+    );
+
+ok(1);
+1;
@@ -0,0 +1,62 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer 	cyc=0;
+   reg [63:0] 	crc;
+   reg [63:0] 	sum;
+
+   // Called from several places, so with a small --inline-mult-task
+   // budget it is kept as a function rather than inlined at each call
+   function [15:0] mix;
+      input [15:0] a;
+      input [15:0] b;
+      reg [15:0]   t;
+      begin
+	 t = a ^ {b[7:0], b[15:8]};
+	 t = t + {t[3:0], t[15:4]};
+	 t = t ^ (a & ~b);
+	 t = t - {t[10:0], t[15:11]};
+	 mix = t ^ 16'h5a5a;
+      end
+   endfunction
+
+   wire [15:0] m0 = mix(crc[15:0], crc[31:16]);
+   wire [15:0] m1 = mix(crc[31:16], crc[47:32]);
+   wire [15:0] m2 = mix(crc[47:32], crc[63:48]);
+   wire [15:0] m3 = mix(crc[63:48], crc[15:0]);
+
+   wire [63:0] result = {m3, m2, m1, m0};
+
+   // Test loop
+   always @ (posedge clk) begin
+`ifdef TEST_VERBOSE
+      $write("[%0t] cyc==%0d crc=%x result=%x\n",$time, cyc, crc, result);
+`endif
+      cyc <= cyc + 1;
+      crc <= {crc[62:0], crc[63]^crc[2]^crc[0]};
+      sum <= result ^ {sum[62:0],sum[63]^sum[2]^sum[0]};
+      if (cyc==0) begin
+	 // Setup
+	 crc <= 64'h5aef0c8d_d70a4497;
+	 sum <= 64'h0;
+      end
+      else if (cyc<10) begin
+	 sum <= 64'h0;
+      end
+      else if (cyc==99) begin
+	 $write("[%0t] cyc==%0d crc=%x sum=%x\n",$time, cyc, crc, sum);
+	 if (crc !== 64'hc77bb9b3784ea091) $stop;
+	 $write("*-* All Finished *-*\n");
+	 $finish;
+      end
+   end
+
+endmodule
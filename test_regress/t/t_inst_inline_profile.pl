@@ -0,0 +1,34 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2017 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+$Self->{vlt} or $Self->skip("Verilator only test");
+
+# Counters as written by --profile-counters in an earlier run
+my $profile = "$Self->{obj_dir}/profile_counters.dat";
+write_wholefile($profile,
+		"VLPROF 1\n"
+		."ticks_per_sec 1000000\n"
+		."total_ticks 1000\n"
+		."cfunc 10 950 950 $Self->{VM_PREFIX}_hot::_sequent__TOP__t__h1__1($Self->{VM_PREFIX}__Syms* __restrict vlSymsp)\n"
+		."cfunc 10 5 5 $Self->{VM_PREFIX}_cold::_sequent__TOP__t__c1__1($Self->{VM_PREFIX}__Syms* __restrict vlSymsp)\n"
+		."cfunc 10 45 1000 $Self->{VM_PREFIX}::_eval($Self->{VM_PREFIX}__Syms* __restrict vlSymsp)\n");
+
+compile (
+    verilator_flags2 => ["--stats --inline-profile $profile"],
+    );
+
+file_grep ($Self->{stats}, qr/Optimizations, Inlined modules\s+\d+/i);
+file_grep ($Self->{stats}, qr/Optimizations, Inlined modules, hot\s+(\d+)/i, 1);
+
+execute (
+    check_finished=>1,
+    );
+
+ok(1);
+1;
@@ -0,0 +1,40 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer cyc = 0;
+   wire [7:0] hot1, hot2;
+   wire [7:0] cold1;
+
+   hot  h1 (.clk(clk), .in(cyc[7:0]), .out(hot1));
+   hot  h2 (.clk(clk), .in(~cyc[7:0]), .out(hot2));
+   cold c1 (.clk(clk), .in(cyc[7:0]), .out(cold1));
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      if (cyc > 2) begin
+	 if (hot1 !== (cyc[7:0] - 8'd1 + 8'd3)) $stop;
+	 if (hot2 !== (~(cyc[7:0] - 8'd1) + 8'd3)) $stop;
+	 if (cold1 !== ((cyc[7:0] - 8'd1) ^ 8'h5a)) $stop;
+      end
+      if (cyc == 10) begin
+	 $write("*-* All Finished *-*\n");
+	 $finish;
+      end
+   end
+endmodule
+
+module hot (input clk, input [7:0] in, output reg [7:0] out);
+   always @ (posedge clk) out <= in + 8'd3;
+endmodule
+
+module cold (input clk, input [7:0] in, output reg [7:0] out);
+   always @ (posedge clk) out <= in ^ 8'h5a;
+endmodule
@@ -0,0 +1,59 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+#include <verilated.h>
+
+#include "Vt_lane_basic.h"
+
+vluint64_t main_time = 0;
+double sc_time_stamp() {
+    return (double)main_time;
+}
+
+static vluint64_t s_seed = VL_ULL(0x12345678);
+static vluint64_t rand64() {
+    s_seed = s_seed * VL_ULL(6364136223846793005) + VL_ULL(1442695040888963407);
+    return s_seed ^ (s_seed >> 29);
+}
+
+int main(int argc, char **argv, char **env) {
+    Verilated::commandArgs(argc, argv);
+    VM_PREFIX* topp = new VM_PREFIX("top");
+
+    if (sizeof(topp->a) != 8 || sizeof(topp->q) != 8) {
+	vl_fatal(__FILE__,__LINE__,"main", "Signals not widened to 64 lanes");
+    }
+    topp->clk = 0;
+    topp->eval();
+    vluint64_t q = topp->q;
+    for (int cyc=0; cyc<100; ++cyc) {
+	vluint64_t a = rand64();
+	vluint64_t b = rand64();
+	vluint64_t en = rand64();
+	topp->a = a;
+	topp->b = b;
+	topp->en = en;
+	topp->clk = 0;
+	topp->eval();
+	// Each bit is an independent simulation
+	if (topp->c != ((a & ~b) | q)
+	    || topp->n != ((~(a ^ b) & en) | ((a ^ b) & ~q))) {
+	    vl_fatal(__FILE__,__LINE__,"main", "Combinational lane mismatch");
+	}
+	q = (en & (a ^ b)) | (~en & b & ~q) | (~en & ~b & q);
+	topp->clk = 1;
+	topp->eval();
+	if (topp->q != q) {
+	    vl_fatal(__FILE__,__LINE__,"main", "Sequential lane mismatch");
+	}
+	++main_time;
+    }
+    topp->final();
+    delete topp;
+    VL_PRINTF("*-* All Finished *-*\n");
+    return 0;
+}
@@ -0,0 +1,27 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+module t (/*AUTOARG*/
+   // Outputs
+   q, c, n,
+   // Inputs
+   clk, a, b, en
+   );
+   input clk;
+   input a;
+   input b;
+   input en;
+   output reg q;
+   output c;
+   output n;
+
+   assign c = (a & ~b) | q;
+   assign n = (a == b) ? en : !q;
+
+   always @ (posedge clk) begin
+      if (en) q <= a ^ b;
+      else if (b) q <= ~q;
+   end
+endmodule
@@ -0,0 +1,63 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+//
+// An assignment last in an if branch is dead when set again after the if.
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer	cyc = 0;
+   reg [7:0]	a = 8'h0;
+   reg [7:0]	b = 8'h0;
+   reg [7:0]	t1;
+   reg [7:0]	t2;
+   reg [7:0]	r1 = 8'h0;
+   reg [7:0]	r2 = 8'h0;
+   reg [7:0]	odd = 8'h0;
+
+   always @ (posedge clk) begin
+      if (a[0]) begin
+	 t1 = a + 8'd1;		// Dead
+	 odd <= odd + 8'd1;
+      end
+      t1 = b;
+      r1 <= t1;
+      if (a[1]) t2 = a;		// Used below, must remain
+      r2 <= t2;
+      t2 = b;
+   end
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      a <= a + 8'd3;
+      b <= b + 8'd5;
+`ifdef TEST_VERBOSE
+      $write("[%0t] a=%x b=%x r1=%x r2=%x\n", $time, a, b, r1, r2);
+`endif
+      if (cyc == 2) begin
+	 // Previous edge had a=3 b=5
+	 if (r1 !== 8'd5) $stop;
+	 if (r2 !== 8'd3) $stop;
+      end
+      if (cyc == 3) begin
+	 // Previous edge had a=6 b=10, a[1] set
+	 if (r1 !== 8'd10) $stop;
+	 if (r2 !== 8'd6) $stop;
+      end
+      if (cyc == 4) begin
+	 // Previous edge had a=9 b=15, a[1] clear so t2 held b from before
+	 if (r1 !== 8'd15) $stop;
+	 if (r2 !== 8'd10) $stop;
+	 if (odd !== 8'd2) $stop;
+      end
+      if (cyc == 9) begin
+	 $write("*-* All Finished *-*\n");
+	 $finish;
+      end
+   end
+endmodule
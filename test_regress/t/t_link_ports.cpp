@@ -0,0 +1,64 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+#include <verilated.h>
+#include <verilated_link.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "Vt_link_ports.h"
+
+double sc_time_stamp() {
+    return 0;
+}
+
+static const char* const filename = "obj_dir/t_link_ports/link.shm";
+
+static int reference() {
+    // As if another process's C++ model, driving and checking the Verilated model
+    CData in = 0;
+    SData out = 0;
+    VerilatedLink link;
+    link.addOutput(&in, sizeof(in));
+    link.addInput(&out, sizeof(out));
+    if (!link.open(filename, 1, 64)) return 1;
+    for (int cyc=0; cyc<20; ++cyc) {
+	in = (CData)(cyc * 7);
+	link.exchange();
+	// Outputs are from the model's evaluation of the previous cycle's input
+	CData prev = (CData)((cyc - 1) * 7);
+	if (cyc && out != (((SData)prev << 8) | (CData)~prev)) {
+	    VL_PRINTF("%%Error: cyc=%d out=%x\n", cyc, out);
+	    return 1;
+	}
+    }
+    link.close();
+    return 0;
+}
+
+int main(int argc, char **argv, char **env) {
+    unlink(filename);
+    pid_t pid = fork();
+    if (pid == 0) _exit(reference());
+
+    VM_PREFIX* top = new VM_PREFIX("top");
+    VerilatedLink link;
+    top->linkPorts(&link);
+    if (!link.open(filename, 0, 64)) return 1;
+    for (int cyc=0; cyc<20; ++cyc) {
+	link.exchange();
+	top->eval();
+    }
+    link.close();
+    int status = 0;
+    waitpid(pid, &status, 0);
+    top->final();
+    if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+	VL_PRINTF("*-* All Finished *-*\n");
+    }
+    return 0;
+}
@@ -0,0 +1,23 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2017 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+compile (
+    );
+
+if ($Self->{vlt}) {
+    file_grep_not ("$Self->{obj_dir}/$Self->{VM_PREFIX}.h", qr/__DOT__flow\b/);
+    file_grep ("$Self->{obj_dir}/$Self->{VM_PREFIX}.h", qr/__DOT__part\b/);
+}
+
+execute (
+    check_finished=>1,
+    );
+
+ok(1);
+1;
@@ -0,0 +1,52 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+//
+// Variables set on every path before being read become function locals.
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer	cyc = 0;
+   reg [31:0]	a = 32'h0;
+   reg [31:0]	b = 32'h0;
+   reg [31:0]	flow;		// Set in both branches, can be local
+   reg [31:0]	part;		// Set in one branch only, must stay a member
+   reg [31:0]	res1 = 32'h0;
+   reg [31:0]	res2 = 32'h0;
+
+   always @ (posedge clk) begin
+      if (a[0]) flow = a + b;
+      else flow = a - b;
+      if (a[1]) part = b;
+      res1 <= flow ^ 32'h5a5a5a5a;
+      res2 <= part;
+   end
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      a <= a + 32'd7;
+      b <= b + 32'd3;
+`ifdef TEST_VERBOSE
+      $write("[%0t] a=%x b=%x res1=%x res2=%x\n", $time, a, b, res1, res2);
+`endif
+      if (cyc == 3) begin
+	 // a=14 b=6 on the previous edge: bit 0 clear, bit 1 set
+	 if (res1 !== ((32'd14 - 32'd6) ^ 32'h5a5a5a5a)) $stop;
+	 if (res2 !== 32'd6) $stop;
+      end
+      if (cyc == 4) begin
+	 // a=21 b=9: bit 0 set, bit 1 clear, so part holds its old value
+	 if (res1 !== ((32'd21 + 32'd9) ^ 32'h5a5a5a5a)) $stop;
+	 if (res2 !== 32'd6) $stop;
+      end
+      if (cyc == 9) begin
+	 $write("*-* All Finished *-*\n");
+	 $finish;
+      end
+   end
+endmodule
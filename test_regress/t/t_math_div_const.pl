@@ -0,0 +1,28 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2017 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+compile (
+    );
+
+if ($Self->{vlt}) {
+    # Divisors that fit in a word are passed as literals
+    my $text = "";
+    foreach my $file (glob("$Self->{obj_dir}/*.cpp")) {
+	$text .= file_contents($file);
+    }
+    $text =~ /VL_DIV_WWI\(256,/ or $Self->error("No VL_DIV_WWI emitted");
+    $text =~ /VL_MODDIV_WWI\(256,/ or $Self->error("No VL_MODDIV_WWI emitted");
+}
+
+execute (
+    check_finished=>1,
+    );
+
+ok(1);
+1;
@@ -0,0 +1,50 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+//
+// Wide division by constants, checked against division by variables.
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer	cyc = 0;
+
+   reg [255:0]	a;
+   reg [255:0]	d7;
+   reg [255:0]	d64;
+   reg [255:0]	dbig;
+   reg [255:0]	d64bit;
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      if (cyc == 0) begin
+	 a <= 256'h0123456789abcdef_fedcba9876543210_deadbeefcafef00d_0f1e2d3c4b5a6978;
+	 d7 <= 256'd7;
+	 d64 <= 256'd64;
+	 dbig <= 256'd4294967291;
+	 d64bit <= 256'h1_0000_0000_0000_0061;
+      end
+      else begin
+	 a <= {a[254:0], a[255] ^ a[253] ^ a[250] ^ a[245]} ^ {224'h0, cyc};
+`ifdef TEST_VERBOSE
+	 $write("[%0t] a=%x a/7=%x a%%7=%x\n", $time, a, a / 256'd7, a % 256'd7);
+`endif
+	 if (a / 256'd7 != a / d7) $stop;
+	 if (a % 256'd7 != a % d7) $stop;
+	 if (a / 256'd64 != a / d64) $stop;
+	 if (a % 256'd64 != a % d64) $stop;
+	 if (a / 256'd4294967291 != a / dbig) $stop;
+	 if (a % 256'd4294967291 != a % dbig) $stop;
+	 if (a / 256'h1_0000_0000_0000_0061 != a / d64bit) $stop;
+	 if (a % 256'h1_0000_0000_0000_0061 != a % d64bit) $stop;
+	 if (cyc == 99) begin
+	    $write("*-* All Finished *-*\n");
+	    $finish;
+	 end
+      end
+   end
+endmodule
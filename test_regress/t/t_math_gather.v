@@ -0,0 +1,52 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer cyc; initial cyc=0;
+   reg [63:0] crc;
+
+   // Gathers of one signal's bits, in order
+   wire [5:0]  g8  = {crc[7], crc[5:3], crc[1:0]};
+   wire [9:0]  g32 = {crc[31:29], crc[20], crc[17:14], crc[9], crc[2]};
+   wire [15:0] g64 = {crc[63:60], crc[47:40], crc[33], crc[12], crc[5:4]};
+   // Out of order, so not a gather
+   wire [2:0]  swz = {crc[1], crc[6], crc[3]};
+
+   wire [63:0] result = {g8, g32, g64, swz};
+
+   // Aggregate outputs into a single result vector
+   reg [63:0]  sum;
+
+   always @ (posedge clk) begin
+`ifdef TEST_VERBOSE
+      $write("[%0t] cyc==%0d crc=%x result=%x\n",$time, cyc, crc, result);
+`endif
+      cyc <= cyc + 1;
+      crc <= {crc[62:0], crc[63]^crc[2]^crc[0]};
+      sum <= result ^ {sum[62:0],sum[63]^sum[2]^sum[0]};
+      if (cyc!=0) begin
+	 if ({2'b0,g8} != (((crc[7:0] & 8'h80) >> 2) | ((crc[7:0] & 8'h38) >> 1)
+			   | (crc[7:0] & 8'h03))) $stop;
+	 if (g64[3:0] != ((crc[33] ? 4'h8 : 4'h0) | (crc[12] ? 4'h4 : 4'h0)
+			  | ((crc[5:0] >> 4) & 4'h3))) $stop;
+      end
+      if (cyc==0) begin
+	 crc <= 64'h5aef0c8d_d70a4497;
+	 sum <= 64'h0;
+      end
+      else if (cyc==99) begin
+	 $write("[%0t] cyc==%0d crc=%x sum=%x\n",$time, cyc, crc, sum);
+	 if (crc !== 64'hc77bb9b3784ea091) $stop;
+	 $write("*-* All Finished *-*\n");
+	 $finish;
+      end
+   end
+
+endmodule
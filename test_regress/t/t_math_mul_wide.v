@@ -0,0 +1,53 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+//
+// Wide multiplies, including odd word counts and signed.
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer	cyc = 0;
+
+   reg [95:0]	a0;
+   reg [95:0]	b0;
+   reg [159:0]	a1;
+   reg [159:0]	b1;
+   reg [255:0]	a2;
+   reg [255:0]	b2;
+   reg [1055:0]	a3;
+   reg [1055:0]	b3;
+   reg signed [199:0]	a4;
+   reg signed [199:0]	b4;
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      if (cyc == 0) begin
+	 a0 <= 96'hbde5c0994164d8399f767c45;
+	 b0 <= 96'hb0c11fdecb91ce375bc8fbbc;
+	 a1 <= 160'hec1d7da0a6eb8c9ebd69fe29d76d4330f1446bea;
+	 b1 <= 160'hc6a5387777330bdbd7210dff076ce2ef87b0b125;
+	 a2 <= 256'h5f2dd97f1cfb10f62827688de6a16a3b0d464138a62332553fc1ea36f17fd374;
+	 b2 <= 256'h3fd4235992edcf451a1afe878b33e968617959ce3f1f65a8de5271007814e8a2;
+	 a3 <= 1056'h4a0fe75d2a9eba0cdf561d802a759159fb7ff337f5cae3bf3729c619c60a3cab359eeefb015c33b2df1461aaf8eb18b90074513021da8978206f5c6671e0c07e9e115e4b9e30691c238642ea126a1e48cc11d357c30d8b7628dbd25e63b229f1c4069545de11cc9dea959c212e9c82b1478c281d687c966c377b9aa2bb2edb20035b7399;
+	 b3 <= 1056'h9892139600ddb74d960d5a8f9a656aafd14125844d25deb354f46a6910acff0043892dfc254cb864ef901b932a7c18806a3753915c76f18a0585a01c4c7d6df0621aef57e4cc4132f7108e96f770c2263266aa3bb0cde917f7f35634f0e3cd972e81d66d346c6e2ba02fdaa1ad864c44e049548e8a0a8c9632ea6928f6236bf2504b74ba;
+	 a4 <= 200'hd15af84e6b4f59672710e6d8e6568068b9b52a43abad8d194a;
+	 b4 <= 200'h787b3120df2f4d4c8650d7d13fb24891917b121dc54e5a3a26;
+      end
+      else if (cyc == 1) begin
+	 if (a0 * b0 != 96'hc919db7f034c353ae3c2e9ac) $stop;
+	 if (a1 * b1 != 160'hca1610bda822a39df5c95b2241fdd44bc46062d2) $stop;
+	 if (a2 * b2 != 256'h7a4a97bef262363fe711a43e06aa30c533a0dd504132f9b3e1f4febb8f94ef68) $stop;
+	 if (a3 * b3 != 1056'hcf6500027d3138f7a7504355ae8b73e77062884f721cff145ba324359bda21b6fb701b2d600a5ff0c9cd207e4b478869e76557e251f86996311fc29c9bf4a8eea7102a357511d81b0e0c9519c74a2f3103855c1ceb467fcf21f3c537cb58ef6aaff092d51cc09eb94e663c4300bc561e28b69d60de36b98a4f153f69a87280548ea6512a) $stop;
+	 if (a4 * b4 != $signed(200'hd14b0a71c2146def152b43b6c68ff9f1d86f7cca0f2ab084fc)) $stop;
+      end
+      else if (cyc == 2) begin
+	 $write("*-* All Finished *-*\n");
+	 $finish;
+      end
+   end
+endmodule
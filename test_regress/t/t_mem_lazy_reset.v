@@ -0,0 +1,38 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer cyc=0;
+
+   // Large enough to be reset lazily
+   reg [31:0] mem [0:65535];
+   // Small, reset element by element
+   reg [31:0] small [0:15];
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      if (cyc==1) begin
+	 // Default Verilated::randReset is zeros
+	 if (mem[0] !== 32'h0) $stop;
+	 if (mem[100] !== 32'h0) $stop;
+	 if (mem[65535] !== 32'h0) $stop;
+	 if (small[15] !== 32'h0) $stop;
+	 mem[100] <= 32'h1234;
+	 mem[65535] <= 32'h5678;
+      end
+      else if (cyc==2) begin
+	 if (mem[100] !== 32'h1234) $stop;
+	 if (mem[65535] !== 32'h5678) $stop;
+	 if (mem[101] !== 32'h0) $stop;
+	 $write("*-* All Finished *-*\n");
+	 $finish;
+      end
+   end
+endmodule
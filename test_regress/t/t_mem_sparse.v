@@ -0,0 +1,47 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer cyc=0;
+
+   // Large enough to be sparse automatically (256MB dense)
+   reg [31:0] huge [0:(1<<26)-1];
+   // Sparse by request
+   reg [175:0] hex [0:15] /*verilator sparse*/;
+   // Dense
+   reg [31:0] small [0:15];
+
+   initial begin
+      $readmemh("t/t_sys_readmem_h.mem", hex, 0);
+      if (hex['h04] != 176'h400437654321276543211765432107654321abcdef10) $stop;
+      if (hex['h0a] != 176'h400a37654321276543211765432107654321abcdef11) $stop;
+      if (hex['h0c] != 176'h400c37654321276543211765432107654321abcdef13) $stop;
+   end
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      if (cyc==1) begin
+	 // Default Verilated::randReset is zeros, also for never touched pages
+	 if (huge[0] !== 32'h0) $stop;
+	 if (huge[12345678] !== 32'h0) $stop;
+	 huge[100] <= 32'h1234;
+	 huge[(1<<26)-1] <= 32'h5678;
+	 small[3] <= 32'h9abc;
+      end
+      else if (cyc==2) begin
+	 if (huge[100] !== 32'h1234) $stop;
+	 if (huge[(1<<26)-1] !== 32'h5678) $stop;
+	 if (huge[101] !== 32'h0) $stop;
+	 if (small[3] !== 32'h9abc) $stop;
+	 $write("*-* All Finished *-*\n");
+	 $finish;
+      end
+   end
+endmodule
@@ -0,0 +1,41 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2017 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+$Self->{vlt} or $Self->skip("Verilator only test");
+
+# Incremental constant folding must not change the generated model
+compile (
+    verilator_flags2 => ["-ON"],
+    );
+
+execute (
+    check_finished=>1,
+    );
+
+my $full_dir = "$Self->{obj_dir}_full";
+mkdir $full_dir;
+{
+    my @cmdargs = $Self->compile_vlt_flags
+	(verilator_flags => ["-cc", "-Mdir $full_dir", "-OD", "--debug-check"],
+	 verilator_flags2 => ["-On"],
+	);
+    $Self->_run(logfile=>"${full_dir}/vlt_compile.log",
+		cmd=>\@cmdargs);
+}
+
+my @files = glob("${full_dir}/$Self->{VM_PREFIX}*.cpp ${full_dir}/$Self->{VM_PREFIX}*.h");
+@files or $Self->error("No files Verilated into ${full_dir}");
+foreach my $file (@files) {
+    (my $incr = $file) =~ s!^\Q${full_dir}\E!$Self->{obj_dir}!;
+    files_identical($incr, $file)
+	or $Self->error("-ON changed the Verilated output, see $file");
+}
+
+ok(1);
+1;
@@ -0,0 +1,53 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// Constants that only become known in later passes, so incremental
+// constant folding must still revisit the statements that use them
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer 	cyc=0;
+   reg [63:0]	crc = 64'h5aef0c8d_d70a4497;
+
+   wire [7:0]	one = 8'd1;
+   wire [7:0]	two = one + one;
+   wire [7:0]	four = two << 1;
+   wire [7:0]	pub_k /*verilator public*/ = 8'h3c;
+
+   wire [7:0]	in = crc[7:0];
+   wire [7:0]	outa;
+   wire [7:0]	outb;
+
+   Sub suba (.in(in), .k(four), .out(outa));
+   Sub subb (.in(in), .k(pub_k), .out(outb));
+
+   always @ (posedge clk) begin
+`ifdef TEST_VERBOSE
+      $write("[%0t] cyc==%0d crc=%x outa=%x outb=%x\n",$time, cyc, crc, outa, outb);
+`endif
+      cyc <= cyc + 1;
+      crc <= {crc[62:0], crc[63]^crc[2]^crc[0]};
+      if (outa !== ((in & 8'h04) | (in >> 4'd4))) $stop;
+      if (outb !== ((in & 8'h3c) | (in >> 4'd4))) $stop;
+      if (cyc==20) begin
+	 $write("*-* All Finished *-*\n");
+	 $finish;
+      end
+   end
+endmodule
+
+module Sub (
+   input [7:0] in,
+   input [7:0] k,
+   output [7:0] out
+   );
+   wire [7:0] mask = k & 8'hff;
+   wire [3:0] shift = k[2] ? 4'd4 : 4'd0;
+   assign out = (in & mask) | (in >> shift);
+endmodule
@@ -0,0 +1,89 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+//
+// Repeated expressions are computed once, unless a variable they read
+// changed in between.
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer 	cyc=0;
+   reg [63:0] 	crc;
+   reg [63:0] 	sum;
+
+   /*AUTOWIRE*/
+   // Beginning of automatic wires (for undeclared instantiated-module outputs)
+   wire [63:0] 		out;			// From test of Test.v
+   // End of automatics
+
+   Test test (/*AUTOINST*/
+	      // Outputs
+	      .out			(out[63:0]),
+	      // Inputs
+	      .clk			(clk),
+	      .in			(crc[63:0]));
+
+   // Test loop
+   always @ (posedge clk) begin
+`ifdef TEST_VERBOSE
+      $write("[%0t] cyc==%0d crc=%x out=%x\n",$time, cyc, crc, out);
+`endif
+      cyc <= cyc + 1;
+      crc <= {crc[62:0], crc[63]^crc[2]^crc[0]};
+      sum <= out ^ {sum[62:0],sum[63]^sum[2]^sum[0]};
+      if (cyc==0) begin
+	 // Setup
+	 crc <= 64'h5aef0c8d_d70a4497;
+	 sum <= '0;
+      end
+      else if (cyc<10) begin
+	 sum <= '0;
+      end
+      else if (cyc<90) begin
+      end
+      else if (cyc==99) begin
+	 $write("[%0t] cyc==%0d crc=%x sum=%x\n",$time, cyc, crc, sum);
+	 if (crc !== 64'hc77bb9b3784ea091) $stop;
+	 // What checksum will we end up with (above print should match)
+`define EXPECTED_SUM 64'h0ceda40486b7e240
+	 if (sum !== `EXPECTED_SUM) $stop;
+	 $write("*-* All Finished *-*\n");
+	 $finish;
+      end
+   end
+
+endmodule
+
+module Test (/*AUTOARG*/
+   // Outputs
+   out,
+   // Inputs
+   clk, in
+   );
+   input clk;
+   input [63:0] in;
+   output reg [63:0] out;
+
+   wire [31:0] a = in[31:0];
+   wire [31:0] b = in[63:32];
+
+   reg [31:0]  r1, r2, r3, r4, r5;
+   reg [15:0]  m;
+
+   always @ (posedge clk) begin
+      r1 = ((a + b) ^ {b[15:0], a[31:16]}) & 32'h00ff00ff;
+      r2 = ((a + b) ^ {b[15:0], a[31:16]}) | 32'h1;  // Reused
+      m = a[15:0] + b[31:16];
+      r3 = {16'h0, m + {8'h0, a[7:0]}} * 32'd3;
+      m = m ^ 16'h5a5a;
+      r4 = {16'h0, m + {8'h0, a[7:0]}} * 32'd3;  // m changed, not reused
+      if (a[0]) r5 = (a + b) ^ 32'h12345678;
+      else r5 = ((a + b) ^ {b[15:0], a[31:16]}) - 32'd1;  // Reused in a branch
+      out <= {r1 ^ r2, r3 ^ r4 ^ r5};
+   end
+endmodule
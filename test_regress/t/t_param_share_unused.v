@@ -0,0 +1,37 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   wire [3:0] o1, o2, o3, o4;
+
+   // ID is never read, so with --param-share-unused these make two modules
+   sub #(.W(4), .ID(1))           s1 (.o(o1));
+   sub #(.W(4), .ID(2))           s2 (.o(o2));
+   sub #(.W(4), .ID(3), .R(2.5))  s3 (.o(o3));
+   sub #(.W(4), .ID(4), .R(2.5))  s4 (.o(o4));
+
+   always @ (posedge clk) begin
+      if (o1 !== 4'h1) $stop;
+      if (o2 !== 4'h1) $stop;
+      if (o3 !== 4'h2) $stop;
+      if (o4 !== 4'h2) $stop;
+      $write("*-* All Finished *-*\n");
+      $finish;
+   end
+endmodule
+
+module sub
+  #(parameter W = 8,
+    parameter ID = 0,
+    parameter real R = 1.5)
+   (output [W-1:0] o);
+   localparam integer I = $rtoi(R);
+   assign o = I[W-1:0];
+endmodule
@@ -0,0 +1,31 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer cyc = 0;
+   reg [127:0] a, b, r1, r2, r3;
+   reg [127:0] sum = 128'h0;
+
+   // Wide multiplies each need a temporary, used only within one statement
+   always @ (posedge clk) begin
+      a = {4{cyc}};
+      b = ~a;
+      r1 = (a * b) + (a * 128'h3);
+      r2 = (b * b) ^ (a * a);
+      r3 = (r1 * r2) - (a * 128'h5);
+      sum <= sum ^ r3;
+      cyc <= cyc + 1;
+      if (cyc == 10) begin
+	 if (sum !== 128'hfffec0b4ffff1944000003c100000040) $stop;
+	 $write("*-* All Finished *-*\n");
+	 $finish;
+      end
+   end
+endmodule
@@ -0,0 +1,34 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2017 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+$Self->{vlt} or $Self->skip("Verilator only test");
+
+my @flags = ("--stats", "--no-skip-identical", "-DPREDEF_COMMAND_LINE",
+	     "--preproc-cache $Self->{obj_dir}/ppcache");
+
+compile (
+    verilator_flags2 => [@flags],
+    );
+
+my $firststats = "$Self->{obj_dir}/first__stats.txt";
+rename($Self->{stats}, $firststats);
+file_grep ($firststats, qr/Preprocessor cache, misses\s+(\d+)/i, 1);
+
+compile (
+    verilator_flags2 => [@flags],
+    );
+
+file_grep ($Self->{stats}, qr/Preprocessor cache, hits\s+(\d+)/i, 1);
+
+execute (
+    check_finished=>1,
+    );
+
+ok(1);
+1;
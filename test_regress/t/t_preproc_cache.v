@@ -0,0 +1,19 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+`include "t_preproc_inc4.vh"
+
+module t;
+`ifndef T_PREPROC_INC4 `error "Include missing" `endif
+`ifndef PREDEF_COMMAND_LINE `error "Test setup error, PREDEF_COMMAND_LINE missing" `endif
+
+`define CACHE_VALUE 8'h12
+
+   initial begin
+      if (`CACHE_VALUE !== 8'h12) $stop;
+      $write("*-* All Finished *-*\n");
+      $finish;
+   end
+endmodule
@@ -0,0 +1,31 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2017 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+$Self->{vlt} or $Self->skip("Verilator only test");
+
+top_filename("t/t_branch_profile.v");
+
+compile (
+    verilator_flags2 => ["--profile-activity"],
+    );
+
+my $prof_path = "$Self->{obj_dir}/profile_activity.dat";
+unlink $prof_path;
+
+execute (
+    all_run_flags => ["+verilator+prof+activity+file+$prof_path"],
+    check_finished=>1,
+    );
+
+file_grep ($prof_path, qr/^VLPROFACTIVITY 1$/m);
+file_grep ($prof_path, qr/^block 100 \S+ \S+ \S*t_branch_profile.v:16$/m);
+file_grep ($prof_path, qr/^module [1-9]\d* \S+$/m);
+
+ok(1);
+1;
@@ -0,0 +1,31 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2017 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+$Self->{vlt} or $Self->skip("Verilator only test");
+
+top_filename("t/t_unopt_array.v");
+
+compile (
+    verilator_flags2 => ["-Wno-UNOPTFLAT --profile-converge"],
+    );
+
+my $prof_path = "$Self->{obj_dir}/profile_converge.dat";
+unlink $prof_path;
+
+execute (
+    all_run_flags => ["+verilator+prof+converge+file+$prof_path"],
+    check_finished=>1,
+    );
+
+file_grep ($prof_path, qr/^VLPROFCONVERGE 1$/m);
+file_grep ($prof_path, qr/^loops \d+\+? [1-9]\d*$/m);
+file_grep ($prof_path, qr/^change \d+ \S*stage \S*t_unopt_array.v:\d+$/m);
+
+ok(1);
+1;
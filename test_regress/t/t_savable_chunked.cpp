@@ -0,0 +1,58 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+#include <verilated.h>
+#include <verilated_save.h>
+
+#include "Vt_savable_chunked.h"
+
+vluint64_t main_time = 0;
+double sc_time_stamp() {
+    return (double)main_time;
+}
+
+int main(int argc, char **argv, char **env) {
+    Verilated::commandArgs(argc, argv);
+    VM_PREFIX* topp = new VM_PREFIX("top");
+    const char* filenamep = "obj_dir/t_savable_chunked/ckpt.vltch";
+#ifdef VL_THREADED
+    const int threads = 2;
+#else
+    const int threads = 1;
+#endif
+
+    topp->clk = 0;
+    while (main_time < 40) {
+	topp->clk = !topp->clk;
+	topp->eval();
+	++main_time;
+    }
+    {
+	VerilatedSaveChunked os;
+	os.threads(threads);
+	if (!os.save(filenamep, *topp)) vl_fatal(__FILE__,__LINE__,"main","Can't write checkpoint");
+    }
+    delete topp;
+
+    // Restore into a new model, and run to the end
+    topp = new VM_PREFIX("top");
+    VerilatedRestoreChunked rs;
+    rs.threads(threads);
+    if (!rs.restore(filenamep, *topp)) vl_fatal(__FILE__,__LINE__,"main","Can't read checkpoint");
+
+    while (!Verilated::gotFinish() && main_time < 1000) {
+	topp->clk = !topp->clk;
+	topp->eval();
+	++main_time;
+    }
+    if (!Verilated::gotFinish()) {
+	vl_fatal(__FILE__,__LINE__,"main","%Error: Timeout; never got a $finish");
+    }
+    topp->final();
+    delete topp; topp=NULL;
+    exit(0);
+}
@@ -0,0 +1,64 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+#include <verilated.h>
+#include <verilated_save.h>
+
+#include "Vt_savable_delta.h"
+
+vluint64_t main_time = 0;
+double sc_time_stamp() {
+    return (double)main_time;
+}
+
+static string ckptName(int n) {
+    return string("obj_dir/t_savable_delta/ckpt")+(char)('0'+n)+".vltsv";
+}
+
+int main(int argc, char **argv, char **env) {
+    Verilated::commandArgs(argc, argv);
+    VM_PREFIX* topp = new VM_PREFIX("top");
+
+    // Base at 20, deltas at 40 and 60
+    VerilatedSaveDelta os;
+    topp->clk = 0;
+    while (main_time < 60) {
+	topp->clk = !topp->clk;
+	topp->eval();
+	++main_time;
+	if (main_time % 20 == 0) {
+	    os.open(ckptName(main_time/20 - 1));
+	    os << main_time;
+	    os << *topp;
+	    os.close();
+	}
+    }
+    delete topp;
+
+    // Restore the last checkpoint into a new model, and run to the end
+    topp = new VM_PREFIX("top");
+    VerilatedRestoreDelta rs;
+    for (int n=0; n<3; ++n) rs.add(ckptName(n));
+    rs.open();
+    if (!rs.isOpen()) vl_fatal(__FILE__,__LINE__,"main","Can't open checkpoints");
+    rs >> main_time;
+    rs >> *topp;
+    rs.close();
+    if (main_time != 60) vl_fatal(__FILE__,__LINE__,"main","Restored wrong time");
+
+    while (!Verilated::gotFinish() && main_time < 1000) {
+	topp->clk = !topp->clk;
+	topp->eval();
+	++main_time;
+    }
+    if (!Verilated::gotFinish()) {
+	vl_fatal(__FILE__,__LINE__,"main","%Error: Timeout; never got a $finish");
+    }
+    topp->final();
+    delete topp; topp=NULL;
+    exit(0);
+}
@@ -0,0 +1,60 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+#include <verilated.h>
+#include <verilated_save.h>
+
+#include "Vt_savable_mem.h"
+
+vluint64_t main_time = 0;
+double sc_time_stamp() {
+    return (double)main_time;
+}
+
+int main(int argc, char **argv, char **env) {
+    Verilated::commandArgs(argc, argv);
+    VM_PREFIX* topp = new VM_PREFIX("top");
+
+    // Snapshot at 20
+    VerilatedSaveMem os;
+    topp->clk = 0;
+    while (main_time < 20) {
+	topp->clk = !topp->clk;
+	topp->eval();
+	++main_time;
+    }
+    os.open();
+    os << main_time;
+    os << *topp;
+    os.close();
+    delete topp;
+
+    // Restore the same snapshot several times, running each to the end
+    for (int run=0; run<3; ++run) {
+	topp = new VM_PREFIX("top");
+	VerilatedRestoreMem rs;
+	rs.open(os);
+	if (!rs.isOpen()) vl_fatal(__FILE__,__LINE__,"main","Can't open snapshot");
+	rs >> main_time;
+	rs >> *topp;
+	rs.close();
+	if (main_time != 20) vl_fatal(__FILE__,__LINE__,"main","Restored wrong time");
+
+	while (!Verilated::gotFinish() && main_time < 1000) {
+	    topp->clk = !topp->clk;
+	    topp->eval();
+	    ++main_time;
+	}
+	if (!Verilated::gotFinish()) {
+	    vl_fatal(__FILE__,__LINE__,"main","%Error: Timeout; never got a $finish");
+	}
+	topp->final();
+	delete topp; topp=NULL;
+	Verilated::gotFinish(false);
+    }
+    exit(0);
+}
@@ -0,0 +1,59 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// Pipeline stages idle most cycles, which --seq-gate skips.
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer cyc = 0;
+   reg [31:0] in;
+
+   // Stage inputs change only every 8th cycle
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      if (cyc[2:0] == 3'd0) in <= in * 32'd5 + 32'd3;
+   end
+
+   // Same inputs, so share one check
+   reg [31:0] s1a;
+   reg [31:0] s1b;
+   always @ (posedge clk) begin
+      s1a <= (in ^ {in[15:0], in[31:16]}) + 32'h1234;
+   end
+   always @ (posedge clk) begin
+      s1b <= (in << 3) - (in >> 2) + 32'h55;
+   end
+
+   // Reads its own output, so runs every cycle the output changes
+   reg [31:0] acc;
+   always @ (posedge clk) begin
+      if (s1a[0]) acc <= acc + s1b + 32'd7;
+      else acc <= acc ^ s1b ^ 32'd9;
+   end
+
+   // Has a side effect, so never gated
+   reg [31:0] seen;
+   always @ (posedge clk) begin
+      seen <= seen + {31'b0, (s1a != 0)};
+      if (cyc == 999) $write("");
+   end
+
+   always @ (posedge clk) begin
+      if (cyc == 0) begin
+	 in <= 32'h1;
+	 acc <= 32'h0;
+	 seen <= 32'h0;
+      end
+      else if (cyc == 99) begin
+	 $write("[%0t] in=%x s1a=%x s1b=%x acc=%x seen=%x\n", $time, in, s1a, s1b, acc, seen);
+	 $write("*-* All Finished *-*\n");
+	 $finish;
+      end
+   end
+endmodule
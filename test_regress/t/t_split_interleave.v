@@ -0,0 +1,48 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+
+   input clk;
+   integer cyc = 0;
+
+   reg [31:0] a1, a2, a3;
+   reg [31:0] b1, b2, b3;
+   reg [31:0] ra, rb;
+
+   // Two independent chains, written one after the other, that
+   // reordering may interleave
+   always @ (posedge clk) begin
+      if (cyc != 0) begin
+	 a1 = cyc + 32'd1;
+	 a2 = a1 * 32'd3;
+	 a3 = a2 ^ 32'h55;
+	 b1 = cyc + 32'd7;
+	 b2 = b1 * 32'd5;
+	 b3 = b2 ^ 32'haa;
+	 ra <= a3;
+	 rb <= b3;
+      end
+   end
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      if (cyc >= 2) begin
+`ifdef TEST_VERBOSE
+	 $write("[%0t] cyc=%0d ra=%x rb=%x\n", $time, cyc, ra, rb);
+`endif
+	 // Computed at the previous edge, from cyc-1
+	 if (ra != ((cyc * 32'd3) ^ 32'h55)) $stop;
+	 if (rb != (((cyc + 32'd6) * 32'd5) ^ 32'haa)) $stop;
+      end
+      if (cyc == 10) begin
+	 $write("*-* All Finished *-*\n");
+	 $finish;
+      end
+   end
+endmodule
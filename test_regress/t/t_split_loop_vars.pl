@@ -0,0 +1,25 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2017 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+$Self->{vlt} or $Self->skip("Verilator only test");
+
+# Would fail with UNOPTFLAT if the variables weren't split
+compile (
+    verilator_flags2 => ["--stats --split-loop-vars"],
+    );
+
+file_grep ($Self->{stats}, qr/Optimizations, Split loop variables\s+(\d+)/i, 2);
+file_grep ($Self->{stats}, qr/Optimizations, Split loop variable pieces\s+(\d+)/i, 7);
+
+execute (
+    check_finished=>1,
+    );
+
+ok(1);
+1;
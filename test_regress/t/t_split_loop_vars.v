@@ -0,0 +1,43 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// Bits and elements that depend on each other, which without
+// --split-loop-vars give UNOPTFLAT.
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer cyc = 0;
+   reg [7:0] in;
+
+   wire [7:0] x;
+   assign x[1:0] = in[1:0];
+   assign x[3:2] = x[1:0] + 2'd1;
+   assign x[7:4] = {x[3:2], x[1:0]} ^ 4'h5;
+
+   wire [7:0] arr [0:3];
+   assign arr[0] = in;
+   assign arr[1] = arr[0] + 8'd1;
+   assign arr[2] = arr[1] + arr[3];
+   assign arr[3] = arr[0] ^ 8'hff;
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      in <= cyc[7:0] * 8'd7;
+      if (cyc > 1) begin
+	 if (x[1:0] !== in[1:0]) $stop;
+	 if (x[3:2] !== in[1:0] + 2'd1) $stop;
+	 if (x[7:4] !== ({in[1:0] + 2'd1, in[1:0]} ^ 4'h5)) $stop;
+	 if (arr[2] !== (in + 8'd1) + (in ^ 8'hff)) $stop;
+      end
+      if (cyc == 10) begin
+	 $write("*-* All Finished *-*\n");
+	 $finish;
+      end
+   end
+endmodule
@@ -0,0 +1,40 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+`define checks(gotv,expv) do if ((gotv) !== (expv)) begin $write("%%Error: %s:%0d:  got=\"%s\" exp=\"%s\"\n", `__FILE__,`__LINE__, (gotv), (expv)); $stop; end while(0);
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer 	cyc=0;
+
+   string 	s;
+   string 	t;
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      // Appends and formats that may reuse the string's buffer
+      s = {s, "x"};
+      t = $sformatf("%0d:%s", cyc, t);
+      if (cyc==3) begin
+	 `checks(s, "xxxx");
+	 `checks(t, "3:2:1:0:");
+	 // Pieces that read the string being assigned
+	 s = {s, "-", s};
+	 `checks(s, "xxxx-xxxx");
+	 s = {s, s};
+	 `checks(s, "xxxx-xxxxxxxx-xxxx");
+	 s = {"<", s, ">"};
+	 `checks(s, "<xxxx-xxxxxxxx-xxxx>");
+	 s = $sformatf("%s%s", s, "!");
+	 `checks(s, "<xxxx-xxxxxxxx-xxxx>!");
+	 $write("*-* All Finished *-*\n");
+	 $finish;
+      end
+   end
+endmodule
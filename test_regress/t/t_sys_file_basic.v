@@ -147,6 +147,23 @@ module t;
 	 if (r != 0.2) $stop;
 	 if (letterq != 64'hfffffffffffc65a4) $stop;
 
+	 // Wide decimals keep all their digits
+	 chars = $sscanf("d=123456789012345678901234567890", "d=%d", letterw);
+	 if (`verbose) $write("c=%0d d=%x\n", chars, letterw);
+	 if (chars != 1) $stop;
+	 if (letterw != 128'h18ee90ff6c373e0ee4e3f0ad2) $stop;
+
+	 // Negative decimals sign extend to the target's width
+	 chars = $sscanf("-5", "%d", v_a);
+	 if (`verbose) $write("c=%0d d=%x\n", chars, v_a);
+	 if (chars != 1) $stop;
+	 if (v_a != 8'hfb) $stop;
+
+	 chars = $sscanf("-123456789012345678901234567890", "%d", letterw);
+	 if (`verbose) $write("c=%0d d=%x\n", chars, letterw);
+	 if (chars != 1) $stop;
+	 if (letterw != 128'hfffffffe7116f0093c8c1f11b1c0f52e) $stop;
+
 	 // $fscanf
 	 if ($fscanf(file,"")!=0) $stop;
 
@@ -210,6 +227,17 @@ module t;
 
 	 if ($fgetc(file) != "\n") $stop;
 
+	 // $fgets after $fscanf gets the character $fscanf read ahead
+	 if (!sync("*")) $stop;
+	 chars = $fscanf(file, "n=%d", letterq);
+	 if (`verbose) $write("c=%0d n=%0d\n", chars, letterq);
+	 if (chars != 1) $stop;
+	 if (letterq != 64'd42) $stop;
+	 chars = $fgets(letterz, file);
+	 if (`verbose) $write("c=%0d z=%s", chars, letterz); // Output includes newline
+	 if (chars != 14) $stop;
+	 if (letterz != "\0\0 rest of line\n") $stop;
+
 	 $fclose(file);
       end
 
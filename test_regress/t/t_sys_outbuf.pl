@@ -0,0 +1,34 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2017 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+$Self->{vlt} or $Self->skip("Verilator only test");
+
+unlink("$Self->{obj_dir}/t_sys_outbuf_test.log");
+
+compile (
+    );
+
+execute (
+    all_run_flags => ['+verilator+outbuf+1048576'],
+    check_finished=>1,
+    expect=>quotemeta(
+'[0] display 0
+[0] display 1
+[0] display 2
+'),
+    );
+
+file_grep ("$Self->{obj_dir}/t_sys_outbuf_test.log",
+qr/\[0\] line 0
+\[0\] line 1
+.*\[0\] line 999
+/s);
+
+ok(1);
+1;
@@ -0,0 +1,22 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+module t;
+   integer file;
+   integer i;
+
+   initial begin
+      file = $fopen("obj_dir/t_sys_outbuf/t_sys_outbuf_test.log","w");
+      for (i = 0; i < 1000; i = i + 1) begin
+	 $fwrite(file, "[%0t] line %0d\n", $time, i);
+      end
+      $fclose(file);
+      for (i = 0; i < 3; i = i + 1) begin
+	 $display("[%0t] display %0d", $time, i);
+      end
+      $write("*-* All Finished *-*\n");
+      $finish;
+   end
+endmodule
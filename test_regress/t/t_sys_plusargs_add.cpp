@@ -0,0 +1,52 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+#include <verilated.h>
+#include "Vt_sys_plusargs_add.h"
+
+double sc_time_stamp() {
+    return 0;
+}
+
+bool fail = false;
+
+void check(int line, int got, int exp) {
+    if (got != exp) {
+	VL_PRINTF("%%Error: line %d: got %d, expected %d\n", line, got, exp);
+	fail = true;
+    }
+}
+
+static void cycle(VM_PREFIX* topp) {
+    topp->clk = 0;
+    topp->eval();
+    topp->clk = 1;
+    topp->eval();
+}
+
+int main(int argc, char **argv, char **env) {
+    Verilated::commandArgs(argc, argv);
+    VM_PREFIX* topp = new VM_PREFIX("top");
+
+    // Not on the command line, so cached as missing
+    cycle(topp);
+    cycle(topp);
+    check(__LINE__, topp->found, 0);
+    check(__LINE__, topp->value, 0);
+
+    // Adding arguments must replace the cached results
+    static const char* addps[] = {"+LATER", "+LATEVAL=37"};
+    Verilated::commandArgsAdd(2, addps);
+    cycle(topp);
+    check(__LINE__, topp->found, 1);
+    check(__LINE__, topp->value, 37);
+
+    topp->final();
+    delete topp;
+    if (!fail) VL_PRINTF("*-* All Finished *-*\n");
+    return 0;
+}
@@ -0,0 +1,26 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+module t (/*AUTOARG*/
+   // Outputs
+   found, value,
+   // Inputs
+   clk
+   );
+
+   input clk;
+   output reg found;
+   output reg [31:0] value;
+
+   integer v;
+
+   // Tested every cycle, so the results are cached
+   always @ (posedge clk) begin
+      found <= ($test$plusargs("LATER") != 0);
+      v = 0;
+      if ($value$plusargs("LATEVAL=%d", v)) value <= v;
+      else value <= 32'd0;
+   end
+endmodule
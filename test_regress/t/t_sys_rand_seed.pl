@@ -0,0 +1,26 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2017 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+$Self->{vlt} or $Self->skip("Verilator only test");
+
+compile (
+    );
+
+execute (
+    all_run_flags => ['+verilator+seed+5'],
+    check_finished=>1,
+    expect=>quotemeta(
+'Random = 49d55178
+Random = 9a22115a
+Random = a648b1cc
+'),
+    );
+
+ok(1);
+1;
@@ -0,0 +1,21 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+module t;
+
+   reg [31:0] thisrand;
+   integer    i;
+
+   initial begin
+      // Driver passes +verilator+seed+, so the sequence is reproducible
+      for (i=0; i<3; i=i+1) begin
+	 thisrand = $random;
+	 $write("Random = %x\n", thisrand);
+      end
+      $write("*-* All Finished *-*\n");
+      $finish;
+   end
+
+endmodule
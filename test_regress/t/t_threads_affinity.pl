@@ -0,0 +1,38 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2017 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+$Self->{vlt} or $Self->skip("Verilator only test");
+
+top_filename("t/t_alw_split.v");
+
+compile (
+    verilator_flags2 => ["--threads 2"],
+    );
+
+execute (
+    all_run_flags => ["+verilator+threads+affinity+0"],
+    check_finished=>1,
+    );
+
+# CPUs a cpu_set_t can't hold, and huge ranges, are refused;
+# the valid start of the list is still used
+execute (
+    all_run_flags => ["+verilator+threads+affinity+0,1-2000000000"],
+    check_finished=>1,
+    expect=>quotemeta("%Warning: Ignoring bad +verilator+threads+affinity list at '1-2000000000'"),
+    );
+
+execute (
+    all_run_flags => ["+verilator+threads+affinity+0,70000"],
+    check_finished=>1,
+    expect=>quotemeta("%Warning: Ignoring bad +verilator+threads+affinity list at '70000'"),
+    );
+
+ok(1);
+1;
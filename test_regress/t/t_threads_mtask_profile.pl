@@ -0,0 +1,40 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2017 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+$Self->{vlt} or $Self->skip("Verilator only test");
+
+top_filename("t/t_alw_split.v");
+
+compile (
+    verilator_flags2 => ["--stats --threads 2 --profile-counters"],
+    );
+
+my $prof_path = "$Self->{obj_dir}/profile_counters.dat";
+unlink $prof_path;
+
+execute (
+    all_run_flags => ["+verilator+prof+file+$prof_path"],
+    check_finished=>1,
+    );
+
+file_grep ($prof_path, qr/^cfunc [1-9]\d* \d+ \d+ mtask_cluster \S+:\d+$/m);
+
+# Rebuild, balancing macro-tasks by the measured times
+compile (
+    verilator_flags2 => ["--stats --threads 2 --mtask-profile $prof_path"],
+    );
+
+file_grep ($Self->{stats}, qr/Order, MTask, profiled clusters\s+[1-9]\d*/i);
+
+execute (
+    check_finished=>1,
+    );
+
+ok(1);
+1;
@@ -0,0 +1,31 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+#include <verilated.h>
+
+#include "Vt_time_context.h"
+
+// No sc_time_stamp(); with --time-context the model reads the context's time
+
+int main(int argc, char **argv, char **env) {
+    VerilatedContext* contextp = Verilated::threadContextp();
+    VM_PREFIX* top = new VM_PREFIX("top");
+
+    top->clk = 0;
+    top->eval();
+    while (contextp->time() < 100 && !Verilated::gotFinish()) {
+	contextp->timeInc(5);
+	top->clk = !top->clk;
+	top->eval();
+    }
+    if (!Verilated::gotFinish()) {
+	vl_fatal(__FILE__,__LINE__,"main", "%Error: Timeout; never got a $finish");
+    }
+    top->final();
+    delete top;
+    exit(0);
+}
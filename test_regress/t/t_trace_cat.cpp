@@ -14,6 +14,10 @@
 # include "Vt_trace_cat_reopen.h"
 #elif defined(T_TRACE_CAT_RENEW)
 # include "Vt_trace_cat_renew.h"
+#elif defined(T_TRACE_CAT_ASYNC)
+# include "Vt_trace_cat_async.h"
+#elif defined(T_TRACE_CAT_COMPRESS)
+# include "Vt_trace_cat_compress.h"
 #else
 # error "Unknown test"
 #endif
@@ -31,6 +35,11 @@ const char* trace_name() {
     VL_SNPRINTF(name,1000,"obj_dir/t_trace_cat_reopen/simpart_%04d.vcd", (int)main_time);
 #elif defined(T_TRACE_CAT_RENEW)
     VL_SNPRINTF(name,1000,"obj_dir/t_trace_cat_renew/simpart_%04d.vcd", (int)main_time);
+#elif defined(T_TRACE_CAT_ASYNC)
+    VL_SNPRINTF(name,1000,"obj_dir/t_trace_cat_async/simpart_%04d.vcd", (int)main_time);
+#elif defined(T_TRACE_CAT_COMPRESS)
+    // Quote and semicolon, which the compress command must pass through intact
+    VL_SNPRINTF(name,1000,"obj_dir/t_trace_cat_compress/sim'part;_%04d.vcd", (int)main_time);
 #else
 # error "Unknown test"
 #endif
@@ -45,6 +54,11 @@ int main(int argc, char **argv, char **env) {
 
     VerilatedVcdC* tfp = new VerilatedVcdC;
     top->trace(tfp,99);
+#if defined(T_TRACE_CAT_ASYNC)
+    tfp->async(true);
+#elif defined(T_TRACE_CAT_COMPRESS)
+    tfp->compress("gzip", 1);  // One thread, so closing waits for it
+#endif
 
     tfp->open(trace_name());
 
@@ -55,7 +69,7 @@ int main(int argc, char **argv, char **env) {
 	top->eval();
 
 	if ((main_time % 100) == 0) {
-#if defined(T_TRACE_CAT)
+#if defined(T_TRACE_CAT) || defined(T_TRACE_CAT_ASYNC) || defined(T_TRACE_CAT_COMPRESS)
 	    tfp->openNext(true);
 #elif defined(T_TRACE_CAT_REOPEN)
 	    tfp->close();
@@ -0,0 +1,44 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2017 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+$Self->{vlt} or $Self->skip("Verilator only test");
+
+top_filename("t_trace_cat.v");
+
+compile (
+    make_top_shell => 0,
+    make_main => 0,
+    v_flags2 => ["--trace --exe $Self->{t_dir}/t_trace_cat.cpp",
+		 "-CFLAGS '-DVL_THREADED -std=gnu++11 -pthread' -LDFLAGS -pthread"],
+    );
+
+execute (
+    check_finished=>1,
+    );
+
+# close() waited for every segment, so none is left uncompressed
+my @vcds = glob("$Self->{obj_dir}/sim*.vcd");
+$Self->error("Uncompressed segments remain: @vcds") if $#vcds >= 0;
+my @gzs = sort glob("$Self->{obj_dir}/sim*.vcd.gz");
+$Self->error("Expected rolled over compressed segments, got @gzs") if $#gzs < 1;
+
+# Names are passed as arguments, not through a shell, as they have quotes
+open(my $outfh, ">", "$Self->{obj_dir}/simall.vcd") or die "%Error: $! simall.vcd,";
+foreach my $gz (@gzs) {
+    open(my $infh, "-|", "gzip", "-dc", $gz) or die "%Error: $! gzip -dc $gz,";
+    print $outfh $_ while (<$infh>);
+    close($infh) or $Self->error("gzip -dc failed on $gz");
+}
+close($outfh);
+
+vcd_identical ("$Self->{obj_dir}/simall.vcd",
+	       "t/t_trace_cat.out");
+
+ok(1);
+1;
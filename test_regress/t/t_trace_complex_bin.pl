@@ -0,0 +1,31 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2017 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+$Self->{vlt} or $Self->skip("Verilator only test");
+
+top_filename("t/t_trace_complex.v");
+
+compile (
+	 verilator_flags2 => ['--cc --trace-bin'],
+	 );
+
+execute (
+	 check_finished=>1,
+	 );
+
+$Self->_run(cmd=>["../bin/verilator_bin2vcd",
+		  "$Self->{obj_dir}/simx.vlt",
+		  "-o", "$Self->{obj_dir}/simx.vcd",
+	    ],
+    );
+
+vcd_identical ("$Self->{obj_dir}/simx.vcd", "t/t_trace_complex.out");
+
+ok(1);
+1;
@@ -0,0 +1,30 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2017 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+$Self->{vlt} or $Self->skip("Verilator only test");
+
+top_filename("t_trace_cat.v");
+
+compile (
+    make_top_shell => 0,
+    make_main => 0,
+    v_flags2 => ["--trace --exe $Self->{t_dir}/$Self->{name}.cpp"],
+    );
+
+execute (
+    check_finished=>1,
+    );
+
+# Only the segments covering the last 20 time units, from the keyframe at 75
+file_grep     ("$Self->{obj_dir}/simx.vcd", qr/enddefinitions \$end\n\n\n#75\nb00000000000000000000000000100110 #\n0\$\n#76\n/);
+file_grep     ("$Self->{obj_dir}/simx.vcd", qr/\n#99\n0\$\n$/);
+file_grep_not ("$Self->{obj_dir}/simx.vcd", qr/\n#(0|74)\n/);
+
+ok(1);
+1;
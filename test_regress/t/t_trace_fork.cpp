@@ -0,0 +1,65 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+#include <verilated.h>
+#include <verilated_vcd_c.h>
+#include <sys/wait.h>
+
+#include "Vt_trace_fork.h"
+
+unsigned long long main_time = 0;
+double sc_time_stamp() {
+    return (double)main_time;
+}
+
+int main(int argc, char **argv, char **env) {
+    VM_PREFIX* top = new VM_PREFIX("top");
+
+    Verilated::debug(0);
+    Verilated::traceEverOn(true);
+
+    VerilatedVcdC* tfp = new VerilatedVcdC;
+    top->trace(tfp,99);
+    tfp->open("obj_dir/t_trace_fork/simx.vcd");
+
+    top->clk = 0;
+    while (main_time < 100) {
+	top->clk   = ~top->clk;
+	top->eval();
+	tfp->dump((unsigned int)(main_time));
+	++main_time;
+    }
+
+    // Each child continues into its own simx_fork<n>.vcd
+    for (int n=0; n<2; ++n) {
+	int pid = Verilated::forkChild(n);
+	if (pid < 0) vl_fatal(__FILE__,__LINE__,"main","fork failed");
+	if (pid == 0) {
+	    if (Verilated::forkIndex() != n) vl_fatal(__FILE__,__LINE__,"main","Wrong forkIndex");
+	    while (main_time < 190) {
+		top->clk   = ~top->clk;
+		top->eval();
+		tfp->dump((unsigned int)(main_time));
+		++main_time;
+	    }
+	    tfp->close();
+	    top->final();
+	    exit(0);
+	}
+    }
+
+    int status = 0;
+    while (wait(&status) > 0) {
+	if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+	    vl_fatal(__FILE__,__LINE__,"main","Child failed");
+	}
+    }
+    tfp->close();
+    top->final();
+    printf ("*-* All Finished *-*\n");
+    return 0;
+}
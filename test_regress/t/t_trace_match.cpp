@@ -0,0 +1,58 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+#include <verilated.h>
+#include <verilated_vcd_c.h>
+
+#if defined(T_TRACE_MATCH)
+# include "Vt_trace_match.h"
+# define TRACE_NAME "obj_dir/t_trace_match/simx.vcd"
+#elif defined(T_TRACE_MATCH_MULTI)
+# include "Vt_trace_match_multi.h"
+# define TRACE_NAME "obj_dir/t_trace_match_multi/simx.vcd"
+#elif defined(T_TRACE_MATCH_ASYNC)
+# include "Vt_trace_match_async.h"
+# define TRACE_NAME "obj_dir/t_trace_match_async/simx.vcd"
+#else
+# error "Unknown test"
+#endif
+
+unsigned long long main_time = 0;
+double sc_time_stamp() {
+    return (double)main_time;
+}
+
+int main(int argc, char **argv, char **env) {
+    VM_PREFIX* top = new VM_PREFIX("top");
+
+    Verilated::debug(0);
+    Verilated::traceEverOn(true);
+
+    VerilatedVcdC* tfp = new VerilatedVcdC;
+    top->trace(tfp,99);
+    tfp->traceMatch("*.sub.*");
+#if defined(T_TRACE_MATCH_MULTI)
+    tfp->traceMatch("top.t.other.n?b");
+#elif defined(T_TRACE_MATCH_ASYNC)
+    tfp->async(true);
+#endif
+
+    tfp->open(TRACE_NAME);
+
+    top->clk = 0;
+
+    while (main_time < 40) {
+	top->clk   = ~top->clk;
+	top->eval();
+	tfp->dump((unsigned int)(main_time));
+	++main_time;
+    }
+    tfp->close();
+    top->final();
+    printf ("*-* All Finished *-*\n");
+    return 0;
+}
@@ -0,0 +1,45 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+module t
+  (
+   input wire clk
+   );
+
+   integer    cyc; initial cyc = 0;
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+   end
+
+   sub sub (.clk(clk), .cyc(cyc));
+   other other (.clk(clk), .cyc(cyc));
+endmodule
+
+module sub
+  (
+   input wire clk,
+   input wire [31:0] cyc
+   );
+
+   reg [7:0]  low; initial low = 0;
+
+   always @ (posedge clk) begin
+      low <= cyc[7:0] + 8'd1;
+   end
+endmodule
+
+module other
+  (
+   input wire clk,
+   input wire [31:0] cyc
+   );
+
+   reg [3:0]  nib; initial nib = 0;
+
+   always @ (posedge clk) begin
+      nib <= cyc[3:0];
+   end
+endmodule
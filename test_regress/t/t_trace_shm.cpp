@@ -0,0 +1,96 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+#include <verilated.h>
+#include <verilated_bin_c.h>
+#include <verilated_shm.h>
+#include <cstdio>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "Vt_trace_shm.h"
+
+unsigned long long main_time = 0;
+double sc_time_stamp() {
+    return (double)main_time;
+}
+
+static const char* const refname = "obj_dir/t_trace_shm/simx.vlt";
+static const char* const ringname = "obj_dir/t_trace_shm/ring.shm";
+static const size_t capacity = 256;  // Much smaller than the trace, so it wraps
+
+static void simulate(VerilatedBinC* tfp, const char* filename) {
+    VM_PREFIX* top = new VM_PREFIX("top");
+    top->trace(tfp, 99);
+    tfp->open(filename);
+    top->clk = 0;
+    for (main_time = 0; main_time < 400; ++main_time) {
+	top->clk = !top->clk;
+	top->eval();
+	tfp->dump((unsigned int)(main_time));
+    }
+    tfp->close();
+    top->final();
+    delete top;
+}
+
+static int reader() {
+    // As if a viewer in another process, reading the trace as it runs
+    VerilatedShmReader shm;
+    if (!shm.open(ringname)) return 1;
+    string got;
+    char buf[100];
+    while (size_t bytes = shm.read(buf, sizeof(buf))) got.append(buf, bytes);
+    // Still at end of stream once the writer has closed
+    const char* datap = NULL;
+    if (shm.peek(&datap)) { VL_PRINTF("%%Error: data after end of stream\n"); return 1; }
+    shm.close();
+
+    string exp;
+    FILE* fp = fopen(refname, "rb");
+    if (!fp) { VL_PRINTF("%%Error: can't read %s\n", refname); return 1; }
+    while (size_t bytes = fread(buf, 1, sizeof(buf), fp)) exp.append(buf, bytes);
+    fclose(fp);
+    if (exp.size() <= capacity) {
+	VL_PRINTF("%%Error: trace of %d bytes doesn't wrap the ring\n", (int)exp.size());
+	return 1;
+    }
+    if (got != exp) {
+	VL_PRINTF("%%Error: streamed %d bytes, differing from the %d byte file\n",
+		  (int)got.size(), (int)exp.size());
+	return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv, char **env) {
+    Verilated::debug(0);
+    Verilated::traceEverOn(true);
+
+    // Reference trace, written to a file
+    VerilatedBinC* tfp = new VerilatedBinC;
+    simulate(tfp, refname);
+    delete tfp;
+
+    // Same trace streamed through the ring; remove any previous run's ring,
+    // so the reader waits for this one
+    unlink(ringname);
+    pid_t pid = fork();
+    if (pid == 0) _exit(reader());
+
+    VerilatedShmFile shm (capacity);
+    tfp = new VerilatedBinC(&shm);
+    simulate(tfp, ringname);
+    delete tfp;
+    int status = 0;
+    waitpid(pid, &status, 0);
+    if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+	VL_PRINTF("*-* All Finished *-*\n");
+    }
+    return 0;
+}
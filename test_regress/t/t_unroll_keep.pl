@@ -0,0 +1,24 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2017 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+$Self->{vlt} or $Self->skip("Verilator only test");
+
+compile (
+    verilator_flags2 => ["--stats --unroll-keep 1000"],
+    );
+
+file_grep ($Self->{stats}, qr/Optimizations, Loops kept counted\s+(\d+)/i, 3);
+file_grep ($Self->{stats}, qr/Optimizations, Unrolled Loops\s+(\d+)/i, 1);
+
+execute (
+    check_finished=>1,
+    );
+
+ok(1);
+1;
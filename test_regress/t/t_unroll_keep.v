@@ -0,0 +1,45 @@
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+module t (/*AUTOARG*/
+   // Inputs
+   clk
+   );
+   input clk;
+
+   integer cyc = 0;
+   reg [31:0] regs [0:4095];
+   reg [31:0] sum;
+   integer    i;
+   integer    j;
+
+   always @ (posedge clk) begin
+      cyc <= cyc + 1;
+      if (cyc == 0) begin
+	 for (i = 0; i < 4096; i = i + 1) begin
+	    regs[i] = i * 3;
+	 end
+      end
+      else if (cyc == 1) begin
+	 // Strided, and with a shorter loop that is still unrolled
+	 for (i = 4095; i >= 0; i = i - 2) begin
+	    regs[i] = regs[i] + 32'd1;
+	 end
+	 for (j = 0; j < 4; j = j + 1) begin
+	    regs[j] = 32'd0;
+	 end
+      end
+      else if (cyc == 2) begin
+	 sum = 0;
+	 for (i = 0; i < 4096; i = i + 1) begin
+	    sum = sum + regs[i];
+	 end
+	 // 3*(0+..+4095) + 2048 odd entries incremented - entries 0..3 (0+ 4 + 6 + 10)
+	 if (sum !== 32'd25159680 + 32'd2048 - 32'd20) $stop;
+	 $write("*-* All Finished *-*\n");
+	 $finish;
+      end
+   end
+endmodule
@@ -0,0 +1,28 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2017 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+$Self->{vlt} or $Self->skip("Verilator only test");
+
+top_filename("t/t_var_pinsizes.v");
+
+compile (
+	 verilator_flags2 => ["-sc --pins-sc-biguint --pins-changed --sc-sensitive-clocks --exe $Self->{t_dir}/t_var_pinsizes.cpp"],
+	 make_main => 0,
+	 );
+
+if ($Self->{vlt}) {
+    file_grep ("$Self->{obj_dir}/$Self->{VM_PREFIX}.h", qr/sc_biguint<128>\s+__Vsclast__i128;/x);
+    file_grep ("$Self->{obj_dir}/$Self->{VM_PREFIX}.h", qr/sc_bv<513>\s+__Vsclast__i513;/x);
+    file_grep_not ("$Self->{obj_dir}/$Self->{VM_PREFIX}.cpp", qr/sensitive << i128;/);
+}
+
+execute();
+
+ok(1);
+1;
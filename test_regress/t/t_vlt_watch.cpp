@@ -0,0 +1,40 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//
+// DESCRIPTION: Verilator: Verilog Test module
+//
+// This file ONLY is placed into the Public Domain, for any use,
+// without warranty, 2017 by Wilson Snyder.
+
+#include <verilated.h>
+#include <cstring>
+#include "Vt_vlt_watch.h"
+
+unsigned int main_time = 0;
+int hits = 0;
+
+double sc_time_stamp () {
+    return main_time;
+}
+
+void watchCb(const char* namep, void* userp) {
+    if (0 != strcmp(namep, "sub.addr")) vl_fatal(__FILE__,__LINE__,"main", "%Error: Unexpected watch name");
+    if (userp != &hits) vl_fatal(__FILE__,__LINE__,"main", "%Error: Unexpected watch user data");
+    ++hits;
+}
+
+int main (int argc, char *argv[]) {
+    VM_PREFIX* topp = new VM_PREFIX;
+    Verilated::watchCb(&watchCb, &hits);
+    topp->clk = 0;
+    topp->eval();
+    while (!Verilated::gotFinish() && main_time < 100) {
+	topp->clk = !topp->clk;
+	topp->eval();
+	main_time++;
+    }
+    if (!Verilated::gotFinish()) vl_fatal(__FILE__,__LINE__,"main", "%Error: Timeout; never got a $finish");
+    if (!hits) vl_fatal(__FILE__,__LINE__,"main", "%Error: Watch never called");
+    topp->final();
+    delete topp; topp = NULL;
+    return 0;
+}
@@ -0,0 +1,153 @@
+// -*- mode: C++; c-file-style: "cc-mode" -*-
+//*************************************************************************
+//
+// Copyright 2017 by Wilson Snyder. This program is free software; you can
+// redistribute it and/or modify it under the terms of either the GNU
+// Lesser General Public License Version 3 or the Perl Artistic License.
+// Version 2.0.
+//
+// Verilator is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+//*************************************************************************
+
+#include "Vt_vpi_timed.h"
+#include "verilated.h"
+#include "verilated_vpi.h"
+
+#include <cstdio>
+#include <iostream>
+using namespace std;
+
+// __FILE__ is too long
+#define FILENM "t_vpi_timed.cpp"
+
+// Use cout to avoid issues with %d/%lx etc
+#define CHECK_RESULT(got, exp) \
+    if ((got) != (exp)) {			     \
+	cout<<dec<<"%Error: "<<FILENM<<":"<<__LINE__ \
+	   <<": GOT = "<<(got)<<"   EXP = "<<(exp)<<endl;	\
+	return __LINE__; \
+    }
+
+#define CHECK_RESULT_NZ(got) \
+    if (!(got)) { \
+	printf("%%Error: %s:%d: GOT = NULL  EXP = !NULL\n", FILENM,__LINE__); \
+	return __LINE__; \
+    }
+
+vluint64_t main_time = 0;
+double sc_time_stamp() {
+    return main_time;
+}
+
+//======================================================================
+
+// One cbAfterDelay callback, which removes itself when called
+struct Timed {
+    vpiHandle	m_cbh;		// Handle from vpi_register_cb
+    vluint64_t	m_calledTime;	// main_time when called
+    int		m_calls;	// Times called
+    int		m_addDelay;	// If nonnegative, register m_addp with this delay when called
+    Timed*	m_addp;
+    Timed() : m_cbh(NULL), m_calledTime(0), m_calls(0), m_addDelay(-1), m_addp(NULL) {}
+};
+
+static vpiHandle timedAdd(Timed* timedp, vluint64_t delay);
+
+static int timedCallback(p_cb_data cb_data) {
+    Timed* timedp = reinterpret_cast<Timed*>(cb_data->user_data);
+    if (!timedp->m_calls++) timedp->m_calledTime = main_time;
+    vpi_remove_cb(timedp->m_cbh);
+    if (timedp->m_addDelay >= 0) timedAdd(timedp->m_addp, timedp->m_addDelay);
+    return 0;
+}
+
+static vpiHandle timedAdd(Timed* timedp, vluint64_t delay) {
+    s_vpi_time t;
+    t.type = vpiSimTime;
+    t.high = (PLI_UINT32)(delay >> 32);
+    t.low = (PLI_UINT32)delay;
+    s_cb_data cb_data;
+    cb_data.reason = cbAfterDelay;
+    cb_data.cb_rtn = timedCallback;
+    cb_data.obj = NULL;
+    cb_data.time = &t;
+    cb_data.value = NULL;
+    cb_data.user_data = reinterpret_cast<PLI_BYTE8*>(timedp);
+    timedp->m_cbh = vpi_register_cb(&cb_data);
+    return timedp->m_cbh;
+}
+
+static void runTo(vluint64_t time) {
+    while (main_time < time) {
+	++main_time;
+	VerilatedVpi::callTimedCbs();
+    }
+}
+
+static int check() {
+    // Run from time 0, which has been evaluated
+    Timed near, edge, wheel, far, removed, parent, child, zero;
+    CHECK_RESULT_NZ(timedAdd(&near, 5));
+    CHECK_RESULT_NZ(timedAdd(&edge, 255));  // Last time in the wheel
+    CHECK_RESULT_NZ(timedAdd(&wheel, 256));  // First time beyond it
+    CHECK_RESULT_NZ(timedAdd(&far, 1000));
+    CHECK_RESULT_NZ(timedAdd(&removed, 100));
+    parent.m_addDelay = 300;  parent.m_addp = &child;
+    child.m_addDelay = 0;  child.m_addp = &zero;
+    CHECK_RESULT_NZ(timedAdd(&parent, 10));
+    CHECK_RESULT(VerilatedVpi::cbNextDeadline(), 5);
+
+    runTo(50);
+    CHECK_RESULT(near.m_calls, 1);  CHECK_RESULT(near.m_calledTime, 5);
+    CHECK_RESULT(parent.m_calls, 1);  CHECK_RESULT(parent.m_calledTime, 10);
+    CHECK_RESULT(VerilatedVpi::cbNextDeadline(), 100);
+    vpi_remove_cb(removed.m_cbh);
+    CHECK_RESULT(VerilatedVpi::cbNextDeadline(), 255);
+
+    runTo(1200);
+    CHECK_RESULT(removed.m_calls, 0);
+    CHECK_RESULT(edge.m_calls, 1);  CHECK_RESULT(edge.m_calledTime, 255);
+    CHECK_RESULT(wheel.m_calls, 1);  CHECK_RESULT(wheel.m_calledTime, 256);
+    CHECK_RESULT(far.m_calls, 1);  CHECK_RESULT(far.m_calledTime, 1000);
+    // Added from parent's callback, beyond the wheel from then
+    CHECK_RESULT(child.m_calls, 1);  CHECK_RESULT(child.m_calledTime, 310);
+    // Due at once, but as it was added from a callback, called next time
+    CHECK_RESULT(zero.m_calls, 1);  CHECK_RESULT(zero.m_calledTime, 311);
+    CHECK_RESULT(VerilatedVpi::cbNextDeadline(), ~VL_ULL(0));
+
+    // Winding time back must not call callbacks that are due only at
+    // times since passed
+    Timed before, after;
+    CHECK_RESULT_NZ(timedAdd(&before, 50));  // At 1250
+    main_time = 0;
+    CHECK_RESULT_NZ(timedAdd(&after, 20));  // At 20
+    CHECK_RESULT(VerilatedVpi::cbNextDeadline(), 20);
+    runTo(30);
+    CHECK_RESULT(after.m_calls, 1);  CHECK_RESULT(after.m_calledTime, 20);
+    CHECK_RESULT(before.m_calls, 0);
+    CHECK_RESULT(VerilatedVpi::cbNextDeadline(), 1250);
+    runTo(1250);
+    CHECK_RESULT(before.m_calls, 1);  CHECK_RESULT(before.m_calledTime, 1250);
+    return 0;
+}
+
+int main(int argc, char** argv, char** env) {
+    Verilated::commandArgs(argc, argv);
+    Verilated::debug(0);
+
+    VM_PREFIX* topp = new VM_PREFIX("");  // Note null name - we're flattening it out
+    topp->eval();
+
+    if (int line = check()) {
+	vl_fatal(FILENM, line, "main", "%Error: cbAfterDelay check failed");
+    }
+    topp->final();
+    delete topp; topp=NULL;
+
+    printf("*-* All Finished *-*\n");
+    exit(0L);
+}
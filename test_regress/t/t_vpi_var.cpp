@@ -235,6 +235,10 @@ int _mon_check_var() {
 
     TestVpiHandle vh3 = vpi_handle_by_name((PLI_BYTE8*)"onebit", vh2);
     CHECK_RESULT_NZ(vh3);
+    if (TestSimulator::is_verilator()) {
+	// Verilator shares one handle per variable
+	CHECK_RESULT_VH(vh3, vh1);
+    }
 
     // onebit attributes
     PLI_INT32 d;
@@ -377,6 +381,44 @@ int _mon_check_quad() {
     return 0;
 }
 
+#ifndef IS_VPI
+int _mon_check_batch() {
+    TestVpiHandle vh1 = VPI_HANDLE("text_byte");
+    CHECK_RESULT_NZ(vh1);
+    TestVpiHandle vh2 = VPI_HANDLE("text_long");
+    CHECK_RESULT_NZ(vh2);
+    TestVpiHandle vh3 = VPI_HANDLE("text");
+    CHECK_RESULT_NZ(vh3);
+
+    VerilatedVpiBatch batch;
+    CHECK_RESULT(batch.add(vh1), 0);
+    CHECK_RESULT(batch.add(vh2), 1);
+    CHECK_RESULT(batch.add(vh3), 3);
+    CHECK_RESULT(batch.words(), 19);
+
+    vluint32_t saved[19];
+    batch.get(saved);  // Restored below, for _mon_check_string
+
+    vluint32_t words[19];
+    for (int i=0; i<19; ++i) words[i] = 0x1234567 * (i+1);
+    batch.put(words);
+
+    s_vpi_value v;
+    v.format = vpiIntVal;
+    vpi_get_value(vh1, &v);
+    CHECK_RESULT(v.value.integer, 0x67);  // Masked to 8 bits
+
+    vluint32_t got[19];
+    batch.get(got);
+    CHECK_RESULT_HEX(got[0], 0x67);
+    for (int i=1; i<19; ++i) {
+	CHECK_RESULT_HEX(got[i], words[i]);
+    }
+    batch.put(saved);
+    return 0;
+}
+#endif
+
 int _mon_check_string() {
     static struct {
 	const char *name;
@@ -558,6 +600,9 @@ int mon_check() {
     if (int status = _mon_check_varlist()) return status;
     if (int status = _mon_check_getput()) return status;
     if (int status = _mon_check_quad()) return status;
+#ifndef IS_VPI
+    if (int status = _mon_check_batch()) return status;
+#endif
     if (int status = _mon_check_string()) return status;
     if (int status = _mon_check_putget_str(NULL)) return status;
     if (int status = _mon_check_vlog_info()) return status;
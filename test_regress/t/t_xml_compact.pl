@@ -0,0 +1,26 @@
+#!/usr/bin/perl
+if (!$::Driver) { use FindBin; exec("$FindBin::Bin/bootstrap.pl", @ARGV, $0); die; }
+# DESCRIPTION: Verilator: Verilog Test driver/expect definition
+#
+# Copyright 2017 by Wilson Snyder. This program is free software; you can
+# redistribute it and/or modify it under the terms of either the GNU
+# Lesser General Public License Version 3 or the Perl Artistic License
+# Version 2.0.
+
+$Self->{vlt} or $Self->skip("Verilator only test");
+
+top_filename("t/t_xml_first.v");
+
+my $out_filename = "$Self->{obj_dir}/V$Self->{name}.xml";
+
+compile (
+    verilator_flags2 => ['--xml-only', '--xml-compact'],
+    verilator_make_gcc => 0,
+    );
+
+file_grep ($out_filename, qr/<verilator_xml>/);
+file_grep ($out_filename, qr/^<module /m);
+file_grep_not ($out_filename, qr/^ +</m);
+ok(1);
+
+1;